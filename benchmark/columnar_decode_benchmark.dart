@@ -0,0 +1,130 @@
+// Compares decoding a getBinaryFileMetadataBatch reply in the columnar
+// encoding with the map per file that the plugins used to send, from the
+// bytes on the channel to BinaryFileMetadata objects. The batch is shaped
+// like the one in src/benchmark/columnar_batch_benchmark.cpp.
+//
+//   flutter test benchmark/columnar_decode_benchmark.dart
+//
+// Run it in profile-like conditions (no debugger attached); the numbers are
+// printed per file.
+
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:flutter/services.dart';
+import 'package:flutter_bin/models/binary_file_metadata.dart';
+import 'package:flutter_bin/models/columnar_metadata_list.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+const _codec = StandardMethodCodec();
+
+List<Map<String, String>> _makeBatch(int files) {
+  return [
+    for (var i = 0; i < files; i++)
+      () {
+        final company = 'Company ${i % 25}';
+        return {
+          'version': '10.0.${i % 200}.1',
+          'companyName': '$company Corporation',
+          'legalCopyright': 'Copyright (c) $company. All rights reserved.',
+          'productName': '$company Product ${i % 300}',
+          'fileDescription': 'Component ${i % 1000} of the product',
+          'originalFilename': 'module_$i.dll',
+        };
+      }(),
+  ];
+}
+
+/// Encodes [rows] the way src/columnar_batch.cpp does.
+Uint8List _columnarBatch(List<Map<String, String>> rows) {
+  final strings = <String>[];
+  final ids = <String, int>{};
+  int intern(String value) =>
+      ids.putIfAbsent(value, () => (strings..add(value)).length - 1);
+  final keys = <String>[for (final row in rows) ...row.keys].toSet().toList();
+  final keyIds = [for (final key in keys) intern(key)];
+  final columns = [
+    for (final key in keys)
+      [for (final row in rows) row.containsKey(key) ? intern(row[key]!) : -1],
+  ];
+  final encoded = [for (final string in strings) utf8.encode(string)];
+  final words = <int>[
+    0x42434246, 0, rows.length, keys.length, strings.length, 0, //
+    ...keyIds,
+    for (final column in columns) ...column,
+  ];
+  var offset = 0;
+  for (final bytes in encoded) {
+    words.add(offset);
+    offset += bytes.length;
+  }
+  words.add(offset);
+  final builder = BytesBuilder();
+  final header = ByteData(words.length * 4);
+  for (var i = 0; i < words.length; i++) {
+    header.setUint32(i * 4, words[i] & 0xFFFFFFFF, Endian.little);
+  }
+  builder.add(header.buffer.asUint8List());
+  encoded.forEach(builder.add);
+  final bytes = builder.takeBytes();
+  ByteData.sublistView(bytes).setUint32(4, bytes.length, Endian.little);
+  return bytes;
+}
+
+/// Decodes the reply as MethodChannelFlutterBin does.
+List<BinaryFileMetadata> _decode(ByteData envelope) {
+  final Object? result = _codec.decodeEnvelope(envelope);
+  if (result is Uint8List) {
+    return ColumnarMetadataList(result);
+  }
+  return (result as List)
+      .map((entry) => BinaryFileMetadata.fromJson(
+          Map<String, dynamic>.from(entry as Map)))
+      .toList();
+}
+
+/// Microseconds per file to decode [envelope] and read [readRows] rows.
+double _measure(ByteData envelope, int files, int readRows) {
+  var checksum = 0;
+  void run() {
+    final results = _decode(envelope);
+    for (var i = 0; i < readRows; i++) {
+      checksum += results[i].companyName?.length ?? 0;
+    }
+  }
+
+  // Warm up, then run for at least half a second.
+  for (var i = 0; i < 5; i++) {
+    run();
+  }
+  final stopwatch = Stopwatch()..start();
+  var iterations = 0;
+  while (stopwatch.elapsedMilliseconds < 500) {
+    run();
+    iterations++;
+  }
+  stopwatch.stop();
+  expect(checksum, greaterThan(0));
+  return stopwatch.elapsedMicroseconds / iterations / files;
+}
+
+void main() {
+  for (final files in [1000, 10000]) {
+    test('decode $files files', () {
+      final rows = _makeBatch(files);
+      final maps = _codec.encodeSuccessEnvelope(rows);
+      final columnar = _codec.encodeSuccessEnvelope(_columnarBatch(rows));
+      expect(_decode(columnar)[files - 1].originalFilename,
+          _decode(maps)[files - 1].originalFilename);
+
+      for (final readRows in [files, 20]) {
+        final mapTime = _measure(maps, files, readRows);
+        final columnarTime = _measure(columnar, files, readRows);
+        // ignore: avoid_print
+        print('$files files, $readRows read: '
+            'map per file ${mapTime.toStringAsFixed(3)} us/file, '
+            'columnar ${columnarTime.toStringAsFixed(3)} us/file');
+      }
+    });
+  }
+}
@@ -0,0 +1,15 @@
+//
+//  Generated file. Do not edit.
+//
+
+// clang-format off
+
+#include "generated_plugin_registrant.h"
+
+#include <flutter_bin/flutter_bin_plugin.h>
+
+void fl_register_plugins(FlPluginRegistry* registry) {
+  g_autoptr(FlPluginRegistrar) flutter_bin_registrar =
+      fl_plugin_registry_get_registrar_for_plugin(registry, "FlutterBinPlugin");
+  flutter_bin_plugin_register_with_registrar(flutter_bin_registrar);
+}
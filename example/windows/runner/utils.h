@@ -9,7 +9,8 @@
 void CreateAndAttachConsole();
 
 // Takes a null-terminated wchar_t* encoded in UTF-16 and returns a std::string
-// encoded in UTF-8. Returns an empty std::string on failure.
+// encoded in UTF-8, using the plugin's transcoder (src/unicode.h). Unpaired
+// surrogates become U+FFFD.
 std::string Utf8FromUtf16(const wchar_t* utf16_string);
 
 // Gets the command line arguments passed in as a std::vector<std::string>,
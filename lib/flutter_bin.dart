@@ -1,7 +1,27 @@
+import 'flutter_bin_ffi.dart';
 import 'flutter_bin_platform_interface.dart';
+import 'models/binary_dependencies.dart';
 import 'models/binary_file_metadata.dart';
+import 'models/cache_stats.dart';
+import 'models/cancel_token.dart';
+import 'models/hash_algorithm.dart';
+import 'models/metadata_field.dart';
+import 'models/perf_stats.dart';
+import 'models/request_priority.dart';
+import 'models/scan_result.dart';
+import 'models/watch_event.dart';
 
+export 'models/binary_dependencies.dart';
 export 'models/binary_file_metadata.dart';
+export 'models/cache_stats.dart';
+export 'models/cancel_token.dart';
+export 'models/code_signature.dart';
+export 'models/hash_algorithm.dart';
+export 'models/metadata_field.dart';
+export 'models/perf_stats.dart';
+export 'models/request_priority.dart';
+export 'models/scan_result.dart';
+export 'models/watch_event.dart';
 
 class FlutterBin {
   /// Gets the version of a binary file.
@@ -9,16 +29,292 @@ class FlutterBin {
   /// [filePath] is the absolute path to the binary file.
   /// Returns the version string of the file (e.g. '1.2.3.4').
   /// Returns null if the file doesn't exist or version information is not available.
-  Future<String?> getBinaryFileVersion(String filePath) {
-    return FlutterBinPlatform.instance.getBinaryFileVersion(filePath);
+  /// [cancelToken] can abandon the call; see [CancelToken].
+  /// Pass `useCache: false` to bypass the metadata cache and read the file.
+  /// [priority] defaults to [RequestPriority.interactive]; see [configure].
+  Future<String?> getBinaryFileVersion(
+    String filePath, {
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) {
+    return FlutterBinPlatform.instance.getBinaryFileVersion(filePath,
+        useCache: useCache, cancelToken: cancelToken, priority: priority);
   }
 
   /// Gets comprehensive metadata of a binary file.
   ///
   /// [filePath] is the absolute path to the binary file.
+  /// [customKeys] names additional version-resource strings to read (e.g.
+  /// `FileVersion`, `InternalName`, `PrivateBuild` on Windows, any
+  /// Info.plist key on macOS, ELF keys such as `buildId` and `needed` on
+  /// Linux, or Mach-O keys such as `uuid` and `minOS`); they are returned in
+  /// [BinaryFileMetadata.customFields].
+  /// [hashes] adds digests of the whole file, computed natively from the
+  /// same read, to [BinaryFileMetadata.hashes]. App bundles on macOS are not
+  /// hashed.
+  /// [signature] reads who signed the file and when from its embedded code
+  /// signature into [BinaryFileMetadata.signature]; nothing is verified.
+  /// [fields] limits the read to those fields (plus [customKeys], [hashes]
+  /// and [signature]) instead of [MetadataField.standard]; the others are
+  /// not decoded at all and come back null, which makes a table that only
+  /// shows the version and company name cheaper to fill.
+  /// [priority] defaults to [RequestPriority.interactive]; see [configure].
   /// Returns a [BinaryFileMetadata] object containing available metadata.
   /// Fields may be null if the corresponding information is not available.
-  Future<BinaryFileMetadata> getBinaryFileMetadata(String filePath) {
-    return FlutterBinPlatform.instance.getBinaryFileMetadata(filePath);
+  Future<BinaryFileMetadata> getBinaryFileMetadata(
+    String filePath, {
+    List<String> customKeys = const [],
+    List<HashAlgorithm> hashes = const [],
+    bool signature = false,
+    Set<MetadataField>? fields,
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) {
+    return FlutterBinPlatform.instance.getBinaryFileMetadata(filePath,
+        customKeys: customKeys,
+        hashes: hashes,
+        signature: signature,
+        fields: fields,
+        useCache: useCache,
+        cancelToken: cancelToken,
+        priority: priority);
+  }
+
+  /// Gets metadata for many binary files in one call.
+  ///
+  /// The files are read in parallel on the native side. [fields] restricts
+  /// the result to the given keys (e.g. `['version', 'companyName']`); names
+  /// that are not standard keys are read as custom version-resource keys,
+  /// except hash names such as `sha256`, which select digests, and signer
+  /// keys such as `signerName`, which select [BinaryFileMetadata.signature].
+  /// Returns one [BinaryFileMetadata] per path, in the order of [paths];
+  /// entries that could not be read have [BinaryFileMetadata.error] set.
+  /// [priority] defaults to [RequestPriority.bulk]; see [configure].
+  Future<List<BinaryFileMetadata>> getBinaryFileMetadataBatch(
+    List<String> paths, {
+    List<String>? fields,
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) {
+    return FlutterBinPlatform.instance.getBinaryFileMetadataBatch(paths,
+        fields: fields,
+        useCache: useCache,
+        cancelToken: cancelToken,
+        priority: priority);
+  }
+
+  /// Gets metadata of a binary file synchronously through dart:ffi.
+  ///
+  /// Skips the platform channel: the native reader writes a flat buffer
+  /// that is decoded in place, which suits hot lookups and background
+  /// isolates. [fields] works as in [getBinaryFileMetadataBatch]. The
+  /// metadata cache is not consulted, errors are reported in
+  /// [BinaryFileMetadata.error], and on macOS [filePath] must be the binary
+  /// itself rather than an app bundle. Throws an [UnsupportedError] where
+  /// the native library is not available.
+  BinaryFileMetadata getBinaryFileMetadataSync(
+    String filePath, {
+    List<String>? fields,
+  }) {
+    return _ffi.readMetadata(filePath, fields: fields);
+  }
+
+  /// Gets the version of a binary file synchronously through dart:ffi, or
+  /// null if it cannot be read; see [getBinaryFileMetadataSync].
+  String? getBinaryFileVersionSync(String filePath) {
+    return _ffi.readVersion(filePath);
+  }
+
+  FlutterBinFfi get _ffi {
+    final ffi = FlutterBinFfi.instance;
+    if (ffi == null) {
+      throw UnsupportedError('flutter_bin native library is not available');
+    }
+    return ffi;
+  }
+
+  /// Reads the imported DLLs and functions and the exported symbols of many
+  /// PE images in one call, for dependency analysis.
+  ///
+  /// The files are read in parallel on the native side. Names that repeat
+  /// across files (`KERNEL32.dll`, `GetProcAddress`) are interned natively
+  /// and cross the platform channel once, so the reply grows with the
+  /// number of distinct names rather than with the number of references.
+  /// Returns one [BinaryDependencies] per path, in the order of [paths];
+  /// files that are not PE images have [BinaryDependencies.error] set to
+  /// `UNSUPPORTED_FORMAT`. [priority] defaults to [RequestPriority.bulk];
+  /// see [configure]. Supported on Windows and Linux; elsewhere this throws
+  /// a `MissingPluginException`.
+  Future<List<BinaryDependencies>> getBinaryDependencies(
+    List<String> paths, {
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) {
+    return FlutterBinPlatform.instance.getBinaryDependencies(paths,
+        cancelToken: cancelToken, priority: priority);
+  }
+
+  /// Walks the directory tree under [root] and streams the executables in it.
+  ///
+  /// Files are recognized by their magic bytes (PE, ELF or Mach-O), so
+  /// [extensions] (e.g. `['exe', 'dll']`) only narrows which files are
+  /// probed. [maxDepth] limits how many levels below [root] are walked; 0
+  /// scans [root] alone. Symbolic links and junctions are skipped unless
+  /// [followLinks] is true. [fields] selects metadata as in
+  /// [getBinaryFileMetadataBatch].
+  ///
+  /// Results arrive in batches while the walk is running. The walk pauses
+  /// while the subscription is paused, and stops when it is cancelled. If
+  /// [root] cannot be read the stream fails with a `PlatformException` whose
+  /// code is `SCAN_FAILED`.
+  ///
+  /// Supported on Windows (with asynchronous execution, see [configure])
+  /// and Linux.
+  Stream<List<ScanResult>> scanDirectory(
+    String root, {
+    List<String>? extensions,
+    int? maxDepth,
+    bool followLinks = false,
+    List<String>? fields,
+    bool useCache = true,
+  }) {
+    return FlutterBinPlatform.instance.scanDirectory(root,
+        extensions: extensions,
+        maxDepth: maxDepth,
+        followLinks: followLinks,
+        fields: fields,
+        useCache: useCache);
+  }
+
+  /// Watches [paths] for changes and streams the binaries among them that
+  /// changed, instead of polling them with [getBinaryFileMetadata].
+  ///
+  /// Each path is a directory, watched with its subdirectories unless
+  /// [recursive] is false, or a file, which need not exist yet as long as
+  /// its directory does. [extensions] and [fields] are as in
+  /// [scanDirectory].
+  ///
+  /// Change notifications come from the OS (ReadDirectoryChangesW on
+  /// Windows, inotify on Linux) and are coalesced per file: a file is read
+  /// once it has had no writes for [settleDelay] (500 ms by default), so an
+  /// installer rewriting a DLL produces one [WatchChange.modified] with the
+  /// final metadata, and temporary files that come and go in between are
+  /// never reported. Files whose size and modification time did not change
+  /// are skipped. Nothing is read up front; list the current files with
+  /// [scanDirectory] if you need them.
+  ///
+  /// The stream fails with a `PlatformException` whose code is
+  /// `WATCH_FAILED` if none of [paths] can be watched; paths that cannot be
+  /// watched among others are skipped. A [WatchChange.overflow] event means
+  /// changes were lost and the path should be scanned again.
+  ///
+  /// Supported on Windows (with asynchronous execution, see [configure])
+  /// and Linux; elsewhere the stream fails with a `PlatformException` whose
+  /// code is `UNAVAILABLE`.
+  Stream<List<WatchEvent>> watch(
+    List<String> paths, {
+    List<String>? extensions,
+    bool recursive = true,
+    Duration? settleDelay,
+    List<String>? fields,
+    bool useCache = true,
+  }) {
+    return FlutterBinPlatform.instance.watch(paths,
+        extensions: extensions,
+        recursive: recursive,
+        settleDelay: settleDelay,
+        fields: fields,
+        useCache: useCache);
+  }
+
+  /// Changes how the native side handles requests.
+  ///
+  /// On Windows, calls run on background threads by default so slow disks
+  /// and network shares do not stall the UI; pass `asyncExecution: false` to
+  /// read files on the platform thread instead.
+  ///
+  /// Metadata is cached natively until the file's size, modification time or
+  /// identity changes. [cacheBudgetBytes] bounds the cache's memory use; 0
+  /// disables it.
+  ///
+  /// [indexPath] also keeps the cache on disk so that it survives restarts;
+  /// the index is stored in `<indexPath>.idx` and `<indexPath>.log`, whose
+  /// directory must exist. Pass an empty string to stop using it.
+  ///
+  /// [perfStats] times each phase of the native request handling (see
+  /// [getPerfStats]); it is off by default and costs next to nothing while
+  /// off. [perfTrace] also keeps the most recent phases for a Chrome trace.
+  ///
+  /// [ioByteBudget] and [ioDeadline] bound what reading one file may cost,
+  /// for slow volumes such as network shares: the version resource of a PE
+  /// image is then read with a few small positioned reads instead of a
+  /// mapping, and a file that needs more bytes or time than allowed is
+  /// reported with the error `BUDGET_EXCEEDED` or `TIMED_OUT`.
+  /// [BinaryFileMetadata.bytesRead] says what each read cost. Requests for
+  /// hashes or signatures, and ELF and Mach-O files, are read as usual. Pass
+  /// 0 or [Duration.zero] to lift a limit. Supported on Windows and Linux.
+  ///
+  /// Queued requests start in [RequestPriority] order, so a lookup of the
+  /// selected file does not wait behind an inventory of thousands.
+  /// [concurrencyLimits] caps how many requests of a class run at once (by
+  /// default bulk work gets half the worker threads, normal work all but
+  /// one, and interactive work is not capped); 0 lifts a cap. Whatever the
+  /// caps, normal and bulk work together leave one worker free for
+  /// interactive requests. A request
+  /// that has waited [priorityAging] (500 ms by default) is treated as one
+  /// class more urgent, and so on, so bulk work is never starved;
+  /// [Duration.zero] turns aging off. Latency per class is reported in
+  /// [PerfStats.priorities]. Supported on Windows (with asynchronous
+  /// execution) and Linux.
+  Future<void> configure({
+    bool? asyncExecution,
+    int? cacheBudgetBytes,
+    String? indexPath,
+    bool? perfStats,
+    bool? perfTrace,
+    int? ioByteBudget,
+    Duration? ioDeadline,
+    Map<RequestPriority, int>? concurrencyLimits,
+    Duration? priorityAging,
+  }) {
+    return FlutterBinPlatform.instance.configure(
+        asyncExecution: asyncExecution,
+        cacheBudgetBytes: cacheBudgetBytes,
+        indexPath: indexPath,
+        perfStats: perfStats,
+        perfTrace: perfTrace,
+        ioByteBudget: ioByteBudget,
+        ioDeadline: ioDeadline,
+        concurrencyLimits: concurrencyLimits,
+        priorityAging: priorityAging);
+  }
+
+  /// Drops every cached metadata entry.
+  Future<void> clearCache() {
+    return FlutterBinPlatform.instance.clearCache();
+  }
+
+  /// Returns the hit/miss counters and memory use of the metadata cache.
+  Future<CacheStats> getCacheStats() {
+    return FlutterBinPlatform.instance.getCacheStats();
+  }
+
+  /// Returns how long each phase of the native request handling took since
+  /// the last [resetPerfStats], as counts, totals and percentiles. Pass
+  /// [includeTrace] to also get the recent phases as Chrome trace JSON.
+  ///
+  /// Windows and Linux only; elsewhere this and [resetPerfStats] throw a
+  /// `MissingPluginException`.
+  Future<PerfStats> getPerfStats({bool includeTrace = false}) {
+    return FlutterBinPlatform.instance
+        .getPerfStats(includeTrace: includeTrace);
+  }
+
+  /// Starts the timings reported by [getPerfStats] over.
+  Future<void> resetPerfStats() {
+    return FlutterBinPlatform.instance.resetPerfStats();
   }
 }
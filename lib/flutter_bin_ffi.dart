@@ -0,0 +1,168 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import 'models/binary_file_metadata.dart';
+
+typedef _ReadMetadataNative = Int64 Function(
+    Pointer<Utf8> path,
+    Pointer<Pointer<Utf8>> fields,
+    Size fieldCount,
+    Pointer<Uint8> buffer,
+    Size capacity);
+typedef _ReadMetadata = int Function(Pointer<Utf8> path,
+    Pointer<Pointer<Utf8>> fields, int fieldCount, Pointer<Uint8> buffer,
+    int capacity);
+
+/// Synchronous metadata reads through the plugin's exported C function
+/// `FlutterBinReadMetadata`, without the method channel and its codec.
+///
+/// The native side writes each result into a buffer owned by this object
+/// (a header, an offset table and a string table) and it is decoded in
+/// place. Static state is per isolate, so every isolate gets its own reader
+/// and buffer and reads can run on background isolates.
+class FlutterBinFfi {
+  FlutterBinFfi._(this._read);
+
+  // Layout of the result buffer; see src/flat_metadata.h.
+  static const int _magic = 0x4D424C46;
+  static const int _headerSize = 24;
+  static const int _entrySize = 16;
+  static const int _initialCapacity = 4096;
+
+  static FlutterBinFfi? _instance;
+  static bool _opened = false;
+
+  /// The reader of the current isolate, or null when the plugin library or
+  /// its C entry point cannot be found (e.g. on mobile or the web).
+  static FlutterBinFfi? get instance {
+    if (!_opened) {
+      _opened = true;
+      _instance = _open();
+    }
+    return _instance;
+  }
+
+  static FlutterBinFfi? _open() {
+    try {
+      final DynamicLibrary library;
+      if (Platform.isWindows) {
+        library = DynamicLibrary.open('flutter_bin_plugin.dll');
+      } else if (Platform.isLinux) {
+        library = DynamicLibrary.open('libflutter_bin_plugin.so');
+      } else if (Platform.isMacOS) {
+        // The pod is linked into the app.
+        library = DynamicLibrary.process();
+      } else {
+        return null;
+      }
+      return FlutterBinFfi._(library.lookupFunction<_ReadMetadataNative,
+          _ReadMetadata>('FlutterBinReadMetadata'));
+    } on ArgumentError {
+      return null;
+    }
+  }
+
+  final _ReadMetadata _read;
+
+  // Reused for every call and kept for the life of the isolate.
+  Pointer<Uint8> _buffer = nullptr;
+  int _capacity = 0;
+
+  /// Reads the metadata of [filePath]: the standard fields, or exactly
+  /// [fields] (see `FlutterBin.getBinaryFileMetadataBatch`). Errors are
+  /// reported in [BinaryFileMetadata.error] rather than thrown.
+  BinaryFileMetadata readMetadata(String filePath, {List<String>? fields}) {
+    return decode(_call(filePath, fields ?? const []));
+  }
+
+  /// Reads only the version of [filePath], or null if the file cannot be
+  /// read or has no version.
+  String? readVersion(String filePath) {
+    String? version;
+    forEachField(_call(filePath, const ['version']), (key, value) {
+      if (key == BinaryFileMetadataJsonKey.version.key) {
+        version = value;
+      }
+    });
+    return version == null || version!.isEmpty ? null : version;
+  }
+
+  Uint8List _call(String filePath, List<String> fields) {
+    return using((arena) {
+      final path = filePath.toNativeUtf8(allocator: arena);
+      final names = arena<Pointer<Utf8>>(fields.isEmpty ? 1 : fields.length);
+      for (var i = 0; i < fields.length; i++) {
+        names[i] = fields[i].toNativeUtf8(allocator: arena);
+      }
+      if (_capacity == 0) {
+        _grow(_initialCapacity);
+      }
+      // A result that outgrows the buffer is read again with a bigger one;
+      // the file may change in between, so this can take more than one try.
+      for (var attempt = 0; attempt < 4; attempt++) {
+        final size = _read(path, names, fields.length, _buffer, _capacity);
+        if (size < 0) {
+          throw ArgumentError('Invalid path or field');
+        }
+        if (size <= _capacity) {
+          return _buffer.asTypedList(size);
+        }
+        _grow(size);
+      }
+      throw StateError('Metadata of $filePath kept growing while read');
+    });
+  }
+
+  void _grow(int size) {
+    if (_buffer != nullptr) {
+      malloc.free(_buffer);
+    }
+    _capacity = size > _capacity * 2 ? size : _capacity * 2;
+    _buffer = malloc<Uint8>(_capacity);
+  }
+
+  /// Decodes a result buffer into a [BinaryFileMetadata].
+  static BinaryFileMetadata decode(Uint8List bytes) {
+    final json = <String, dynamic>{};
+    final error = forEachField(bytes, (key, value) => json[key] = value);
+    if (error.isNotEmpty) {
+      json[BinaryFileMetadataJsonKey.error.key] = error;
+    }
+    return BinaryFileMetadata.fromJson(json);
+  }
+
+  /// Calls [visit] with every field of a result buffer and returns its
+  /// error code, or '' on success. Throws a [FormatException] if [bytes] is
+  /// not a well-formed result.
+  static String forEachField(
+      Uint8List bytes, void Function(String key, String value) visit) {
+    final data = ByteData.sublistView(bytes);
+    if (bytes.length < _headerSize ||
+        data.getUint32(0, Endian.little) != _magic ||
+        data.getUint32(4, Endian.little) != bytes.length) {
+      throw const FormatException('Not a flutter_bin metadata buffer');
+    }
+    String string(int at) {
+      final offset = data.getUint32(at, Endian.little);
+      final length = data.getUint32(at + 4, Endian.little);
+      if (offset + length > bytes.length) {
+        throw const FormatException('String outside the buffer');
+      }
+      return utf8.decode(Uint8List.sublistView(bytes, offset, offset + length));
+    }
+
+    final count = data.getUint32(8, Endian.little);
+    if (_headerSize + count * _entrySize > bytes.length) {
+      throw const FormatException('Entries outside the buffer');
+    }
+    for (var i = 0; i < count; i++) {
+      final entry = _headerSize + i * _entrySize;
+      visit(string(entry), string(entry + 8));
+    }
+    return string(12);
+  }
+}
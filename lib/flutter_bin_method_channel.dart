@@ -1,8 +1,20 @@
+import 'dart:async';
+
 import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 
 import 'flutter_bin_platform_interface.dart';
+import 'models/binary_dependencies.dart';
 import 'models/binary_file_metadata.dart';
+import 'models/cache_stats.dart';
+import 'models/cancel_token.dart';
+import 'models/columnar_metadata_list.dart';
+import 'models/hash_algorithm.dart';
+import 'models/metadata_field.dart';
+import 'models/perf_stats.dart';
+import 'models/request_priority.dart';
+import 'models/scan_result.dart';
+import 'models/watch_event.dart';
 
 /// An implementation of [FlutterBinPlatform] that uses method channels.
 class MethodChannelFlutterBin extends FlutterBinPlatform {
@@ -10,18 +22,64 @@ class MethodChannelFlutterBin extends FlutterBinPlatform {
   @visibleForTesting
   final methodChannel = const MethodChannel('flutter_bin');
 
+  /// The event channel that carries the batches of every running scan.
+  @visibleForTesting
+  final scanEventChannel = const EventChannel('flutter_bin/scan');
+
+  static int _nextScanId = 1;
+
+  final Map<int, _Scan> _scans = {};
+  StreamSubscription<dynamic>? _scanEvents;
+
+  /// The event channel that carries the changes of every running watch.
+  @visibleForTesting
+  final watchEventChannel = const EventChannel('flutter_bin/watch');
+
+  static int _nextWatchId = 1;
+
+  final Map<int, StreamController<List<WatchEvent>>> _watches = {};
+  StreamSubscription<dynamic>? _watchEvents;
+
   @override
-  Future<String?> getBinaryFileVersion(String filePath) async {
-    final version = await methodChannel
-        .invokeMethod<String?>('getBinaryFileVersion', {'filePath': filePath});
+  Future<String?> getBinaryFileVersion(
+    String filePath, {
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) async {
+    final version =
+        await methodChannel.invokeMethod<String?>('getBinaryFileVersion', {
+      'filePath': filePath,
+      if (!useCache) 'useCache': false,
+      if (cancelToken != null) 'requestId': cancelToken.id,
+      if (priority != null) 'priority': priority.key,
+    });
     return version;
   }
 
   @override
-  Future<BinaryFileMetadata> getBinaryFileMetadata(String filePath) async {
-    final Map<String, dynamic>? result = await methodChannel
-        .invokeMapMethod<String, dynamic>(
-            'getBinaryFileMetadata', {'filePath': filePath});
+  Future<BinaryFileMetadata> getBinaryFileMetadata(
+    String filePath, {
+    List<String> customKeys = const [],
+    List<HashAlgorithm> hashes = const [],
+    bool signature = false,
+    Set<MetadataField>? fields,
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) async {
+    final Map<String, dynamic>? result =
+        await methodChannel.invokeMapMethod<String, dynamic>(
+            'getBinaryFileMetadata', {
+      'filePath': filePath,
+      if (customKeys.isNotEmpty) 'customKeys': customKeys,
+      if (hashes.isNotEmpty) 'hashes': [for (final hash in hashes) hash.key],
+      if (signature) 'signature': true,
+      if (fields != null) 'fieldMask': MetadataField.maskOf(fields),
+      if (!useCache) 'useCache': false,
+      if (cancelToken != null) 'requestId': cancelToken.id,
+      if (priority != null) 'priority': priority.key,
+    });
 
     if (result == null) {
       return BinaryFileMetadata();
@@ -29,4 +87,320 @@ class MethodChannelFlutterBin extends FlutterBinPlatform {
 
     return BinaryFileMetadata.fromJson(result);
   }
+
+  @override
+  Future<List<BinaryFileMetadata>> getBinaryFileMetadataBatch(
+    List<String> paths, {
+    List<String>? fields,
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) async {
+    final Object? result = await methodChannel
+        .invokeMethod<Object?>('getBinaryFileMetadataBatch', {
+      'paths': paths,
+      if (fields != null) 'fields': fields,
+      if (!useCache) 'useCache': false,
+      // Plugins that know the columnar encoding reply with one Uint8List;
+      // the others ignore this and send a map per file.
+      'columnar': true,
+      if (cancelToken != null) 'requestId': cancelToken.id,
+      if (priority != null) 'priority': priority.key,
+    });
+
+    if (result is Uint8List) {
+      return ColumnarMetadataList(result);
+    }
+    if (result is! List) {
+      return [];
+    }
+
+    return result
+        .map((entry) => BinaryFileMetadata.fromJson(
+            Map<String, dynamic>.from(entry as Map)))
+        .toList();
+  }
+
+  @override
+  Future<List<BinaryDependencies>> getBinaryDependencies(
+    List<String> paths, {
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) async {
+    final Map<String, dynamic>? result = await methodChannel
+        .invokeMapMethod<String, dynamic>('getBinaryDependencies', {
+      'paths': paths,
+      if (cancelToken != null) 'requestId': cancelToken.id,
+      if (priority != null) 'priority': priority.key,
+    });
+
+    if (result == null) {
+      return [];
+    }
+
+    return BinaryDependencies.fromBatch(result);
+  }
+
+  @override
+  Stream<List<ScanResult>> scanDirectory(
+    String root, {
+    List<String>? extensions,
+    int? maxDepth,
+    bool followLinks = false,
+    List<String>? fields,
+    bool useCache = true,
+  }) {
+    final scanId = _nextScanId++;
+    late final _Scan scan;
+    final controller = StreamController<List<ScanResult>>(
+      onListen: () async {
+        _scans[scanId] = scan;
+        _scanEvents ??= scanEventChannel
+            .receiveBroadcastStream()
+            .listen(_onScanEvent, onError: _onScanEventError);
+        try {
+          await methodChannel.invokeMethod<void>('scanDirectory', {
+            'scanId': scanId,
+            'root': root,
+            if (extensions != null) 'extensions': extensions,
+            if (maxDepth != null) 'maxDepth': maxDepth,
+            if (followLinks) 'followLinks': true,
+            if (fields != null) 'fields': fields,
+            if (!useCache) 'useCache': false,
+          });
+        } on PlatformException catch (error) {
+          _finishScan(scanId)?.fail(error);
+        }
+      },
+      onResume: () => scan.acknowledgePending(),
+      onCancel: () async {
+        if (_finishScan(scanId) != null) {
+          await methodChannel
+              .invokeMethod<bool>('cancelScan', {'scanId': scanId});
+        }
+      },
+    );
+    scan = _Scan(scanId, controller, methodChannel);
+    return controller.stream;
+  }
+
+  void _onScanEvent(dynamic event) {
+    final map = Map<String, dynamic>.from(event as Map);
+    final scanId = map['scanId'] as int;
+    final done = map['done'] == true;
+    final scan = done ? _finishScan(scanId) : _scans[scanId];
+    if (scan == null) {
+      return;
+    }
+
+    final entries = (map['entries'] as List? ?? const [])
+        .map((entry) =>
+            ScanResult.fromJson(Map<String, dynamic>.from(entry as Map)))
+        .toList();
+    if (!done) {
+      scan.add(entries);
+    } else if (map['rootFailed'] == true) {
+      scan.fail(PlatformException(
+          code: 'SCAN_FAILED', message: 'The directory could not be read'));
+    } else {
+      scan.finish(entries);
+    }
+  }
+
+  void _onScanEventError(Object error) {
+    for (final scanId in _scans.keys.toList()) {
+      _finishScan(scanId)?.fail(error);
+    }
+  }
+
+  /// Forgets [scanId], releasing the event channel after the last scan.
+  _Scan? _finishScan(int scanId) {
+    final scan = _scans.remove(scanId);
+    if (_scans.isEmpty && _scanEvents != null) {
+      _scanEvents!.cancel();
+      _scanEvents = null;
+    }
+    return scan;
+  }
+
+  @override
+  Stream<List<WatchEvent>> watch(
+    List<String> paths, {
+    List<String>? extensions,
+    bool recursive = true,
+    Duration? settleDelay,
+    List<String>? fields,
+    bool useCache = true,
+  }) {
+    final watchId = _nextWatchId++;
+    late final StreamController<List<WatchEvent>> controller;
+    controller = StreamController<List<WatchEvent>>(
+      onListen: () async {
+        _watches[watchId] = controller;
+        _watchEvents ??= watchEventChannel
+            .receiveBroadcastStream()
+            .listen(_onWatchEvent, onError: _onWatchEventError);
+        try {
+          await methodChannel.invokeMethod<List<Object?>>('watch', {
+            'watchId': watchId,
+            'paths': paths,
+            if (extensions != null) 'extensions': extensions,
+            if (!recursive) 'recursive': false,
+            if (settleDelay != null) 'settleMs': settleDelay.inMilliseconds,
+            if (fields != null) 'fields': fields,
+            if (!useCache) 'useCache': false,
+          });
+        } on PlatformException catch (error) {
+          _finishWatch(watchId)
+            ?..addError(error)
+            ..close();
+        }
+      },
+      onCancel: () async {
+        if (_finishWatch(watchId) != null) {
+          await methodChannel
+              .invokeMethod<bool>('unwatch', {'watchId': watchId});
+        }
+      },
+    );
+    return controller.stream;
+  }
+
+  void _onWatchEvent(dynamic event) {
+    final map = Map<String, dynamic>.from(event as Map);
+    final watch = _watches[map['watchId'] as int];
+    if (watch == null) {
+      return;
+    }
+    final changes = (map['changes'] as List? ?? const [])
+        .map((change) =>
+            WatchEvent.fromJson(Map<String, dynamic>.from(change as Map)))
+        .toList();
+    if (changes.isNotEmpty) {
+      watch.add(changes);
+    }
+  }
+
+  void _onWatchEventError(Object error) {
+    for (final watchId in _watches.keys.toList()) {
+      _finishWatch(watchId)
+        ?..addError(error)
+        ..close();
+    }
+  }
+
+  /// Forgets [watchId], releasing the event channel after the last watch.
+  StreamController<List<WatchEvent>>? _finishWatch(int watchId) {
+    final watch = _watches.remove(watchId);
+    if (_watches.isEmpty && _watchEvents != null) {
+      _watchEvents!.cancel();
+      _watchEvents = null;
+    }
+    return watch;
+  }
+
+  @override
+  Future<bool> cancelRequest(int requestId) async {
+    final cancelled = await methodChannel
+        .invokeMethod<bool>('cancelRequest', {'requestId': requestId});
+    return cancelled ?? false;
+  }
+
+  @override
+  Future<void> configure({
+    bool? asyncExecution,
+    int? cacheBudgetBytes,
+    String? indexPath,
+    bool? perfStats,
+    bool? perfTrace,
+    int? ioByteBudget,
+    Duration? ioDeadline,
+    Map<RequestPriority, int>? concurrencyLimits,
+    Duration? priorityAging,
+  }) async {
+    await methodChannel.invokeMethod<void>('configure', {
+      if (asyncExecution != null) 'asyncExecution': asyncExecution,
+      if (cacheBudgetBytes != null) 'cacheBudgetBytes': cacheBudgetBytes,
+      if (indexPath != null) 'indexPath': indexPath,
+      if (perfStats != null) 'perfStats': perfStats,
+      if (perfTrace != null) 'perfTrace': perfTrace,
+      if (ioByteBudget != null) 'ioByteBudget': ioByteBudget,
+      if (ioDeadline != null) 'ioDeadlineMs': ioDeadline.inMilliseconds,
+      if (concurrencyLimits != null)
+        for (final entry in concurrencyLimits.entries)
+          '${entry.key.key}Concurrency': entry.value,
+      if (priorityAging != null)
+        'priorityAgingMs': priorityAging.inMilliseconds,
+    });
+  }
+
+  @override
+  Future<void> clearCache() async {
+    await methodChannel.invokeMethod<void>('clearCache');
+  }
+
+  @override
+  Future<CacheStats> getCacheStats() async {
+    final Map<String, dynamic>? result =
+        await methodChannel.invokeMapMethod<String, dynamic>('getCacheStats');
+    return result == null ? CacheStats() : CacheStats.fromJson(result);
+  }
+
+  @override
+  Future<PerfStats> getPerfStats({bool includeTrace = false}) async {
+    final Map<String, dynamic>? result = await methodChannel
+        .invokeMapMethod<String, dynamic>(
+            'getPerfStats', {'trace': includeTrace});
+    return result == null ? PerfStats() : PerfStats.fromJson(result);
+  }
+
+  @override
+  Future<void> resetPerfStats() async {
+    await methodChannel.invokeMethod<void>('resetPerfStats');
+  }
+}
+
+/// Dart side of one running scan.
+class _Scan {
+  _Scan(this.id, this.controller, this.methodChannel);
+
+  final int id;
+  final StreamController<List<ScanResult>> controller;
+  final MethodChannel methodChannel;
+
+  /// Batches received while the subscription was paused.
+  int _pending = 0;
+
+  void add(List<ScanResult> batch) {
+    if (batch.isNotEmpty) {
+      controller.add(batch);
+    }
+    if (controller.isPaused) {
+      _pending++;
+    } else {
+      _acknowledge();
+    }
+  }
+
+  void acknowledgePending() {
+    for (; _pending > 0; _pending--) {
+      _acknowledge();
+    }
+  }
+
+  void finish(List<ScanResult> batch) {
+    if (batch.isNotEmpty) {
+      controller.add(batch);
+    }
+    controller.close();
+  }
+
+  void fail(Object error) {
+    controller.addError(error);
+    controller.close();
+  }
+
+  void _acknowledge() {
+    methodChannel.invokeMethod<bool>('acknowledgeScanBatch', {'scanId': id});
+  }
 }
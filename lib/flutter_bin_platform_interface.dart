@@ -1,7 +1,16 @@
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
 import 'flutter_bin_method_channel.dart';
+import 'models/binary_dependencies.dart';
 import 'models/binary_file_metadata.dart';
+import 'models/cache_stats.dart';
+import 'models/cancel_token.dart';
+import 'models/hash_algorithm.dart';
+import 'models/metadata_field.dart';
+import 'models/perf_stats.dart';
+import 'models/request_priority.dart';
+import 'models/scan_result.dart';
+import 'models/watch_event.dart';
 
 abstract class FlutterBinPlatform extends PlatformInterface {
   /// Constructs a FlutterBinPlatform.
@@ -28,7 +37,13 @@ abstract class FlutterBinPlatform extends PlatformInterface {
   ///
   /// [filePath] is the absolute path to the binary file.
   /// Returns the version string of the file or null if not available.
-  Future<String?> getBinaryFileVersion(String filePath) {
+  /// [priority] orders the request among queued ones; see [configure].
+  Future<String?> getBinaryFileVersion(
+    String filePath, {
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) {
     throw UnimplementedError(
         'getBinaryFileVersion() has not been implemented.');
   }
@@ -36,9 +51,134 @@ abstract class FlutterBinPlatform extends PlatformInterface {
   /// Gets comprehensive metadata of a binary file.
   ///
   /// [filePath] is the absolute path to the binary file.
+  /// [customKeys] names additional version-resource strings to read.
+  /// [hashes] selects digests of the whole file.
+  /// [signature] reads the signer of the embedded code signature.
+  /// [fields] limits the read to those fields, plus [customKeys], [hashes]
+  /// and [signature].
   /// Returns a [BinaryFileMetadata] object containing available metadata.
-  Future<BinaryFileMetadata> getBinaryFileMetadata(String filePath) {
+  Future<BinaryFileMetadata> getBinaryFileMetadata(
+    String filePath, {
+    List<String> customKeys = const [],
+    List<HashAlgorithm> hashes = const [],
+    bool signature = false,
+    Set<MetadataField>? fields,
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) {
     throw UnimplementedError(
         'getBinaryFileMetadata() has not been implemented.');
   }
+
+  /// Gets metadata for many binary files in one call.
+  ///
+  /// [paths] are absolute paths to the binary files.
+  /// [fields] optionally restricts which metadata keys are read.
+  /// Returns one [BinaryFileMetadata] per path, in the same order.
+  Future<List<BinaryFileMetadata>> getBinaryFileMetadataBatch(
+    List<String> paths, {
+    List<String>? fields,
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) {
+    throw UnimplementedError(
+        'getBinaryFileMetadataBatch() has not been implemented.');
+  }
+
+  /// Reads the imports and exports of many PE images in one call.
+  ///
+  /// Returns one [BinaryDependencies] per path, in the order of [paths].
+  Future<List<BinaryDependencies>> getBinaryDependencies(
+    List<String> paths, {
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) {
+    throw UnimplementedError(
+        'getBinaryDependencies() has not been implemented.');
+  }
+
+  /// Walks the directory tree under [root] and streams the executables in it.
+  ///
+  /// [extensions] limits the files that are probed; [maxDepth] limits how
+  /// many levels below [root] are walked. [fields] is as in
+  /// [getBinaryFileMetadataBatch]. Cancelling the subscription stops the walk.
+  Stream<List<ScanResult>> scanDirectory(
+    String root, {
+    List<String>? extensions,
+    int? maxDepth,
+    bool followLinks = false,
+    List<String>? fields,
+    bool useCache = true,
+  }) {
+    throw UnimplementedError('scanDirectory() has not been implemented.');
+  }
+
+  /// Watches [paths] (files or directories) and streams the binaries among
+  /// them that change, once each change has settled for [settleDelay].
+  /// Cancelling the subscription stops the watch.
+  Stream<List<WatchEvent>> watch(
+    List<String> paths, {
+    List<String>? extensions,
+    bool recursive = true,
+    Duration? settleDelay,
+    List<String>? fields,
+    bool useCache = true,
+  }) {
+    throw UnimplementedError('watch() has not been implemented.');
+  }
+
+  /// Cancels the in-flight request identified by [requestId].
+  ///
+  /// Returns true if the request was still running.
+  Future<bool> cancelRequest(int requestId) {
+    throw UnimplementedError('cancelRequest() has not been implemented.');
+  }
+
+  /// Changes how the native side handles requests.
+  ///
+  /// [asyncExecution] moves file I/O off the platform thread where supported.
+  /// [cacheBudgetBytes] bounds the metadata cache; 0 disables it.
+  /// [indexPath] persists the cache in files starting with that path; an
+  /// empty string stops persisting it.
+  /// [perfStats] and [perfTrace] switch per-phase timing and trace capture.
+  /// [ioByteBudget] and [ioDeadline] bound the reads of one file; 0 lifts
+  /// the limit.
+  /// [concurrencyLimits] caps the requests of each [RequestPriority] that
+  /// run at once; 0 lifts a cap. [priorityAging] is how long a request
+  /// waits before it counts as one class more urgent; zero turns aging off.
+  Future<void> configure({
+    bool? asyncExecution,
+    int? cacheBudgetBytes,
+    String? indexPath,
+    bool? perfStats,
+    bool? perfTrace,
+    int? ioByteBudget,
+    Duration? ioDeadline,
+    Map<RequestPriority, int>? concurrencyLimits,
+    Duration? priorityAging,
+  }) {
+    throw UnimplementedError('configure() has not been implemented.');
+  }
+
+  /// Drops every cached metadata entry.
+  Future<void> clearCache() {
+    throw UnimplementedError('clearCache() has not been implemented.');
+  }
+
+  /// Returns the counters of the metadata cache.
+  Future<CacheStats> getCacheStats() {
+    throw UnimplementedError('getCacheStats() has not been implemented.');
+  }
+
+  /// Returns the per-phase timings, with the trace JSON if [includeTrace].
+  Future<PerfStats> getPerfStats({bool includeTrace = false}) {
+    throw UnimplementedError('getPerfStats() has not been implemented.');
+  }
+
+  /// Starts the per-phase timings and the trace over.
+  Future<void> resetPerfStats() {
+    throw UnimplementedError('resetPerfStats() has not been implemented.');
+  }
 }
@@ -0,0 +1,97 @@
+/// A DLL that a PE image imports functions from.
+class ImportedModule {
+  /// The module name as spelled in the image, e.g. `KERNEL32.dll`.
+  final String name;
+
+  /// Imported function names in import table order; functions imported by
+  /// ordinal are named `#<ordinal>`, e.g. `#17`.
+  final List<String> functions;
+
+  /// Whether the module is listed in the delay-load import table.
+  final bool delayLoaded;
+
+  ImportedModule({
+    required this.name,
+    this.functions = const [],
+    this.delayLoaded = false,
+  });
+}
+
+/// The imports and exports of one PE image.
+///
+/// Names are shared between all results of one `getBinaryDependencies`
+/// call: each distinct name is sent once and every file refers to the same
+/// [String].
+class BinaryDependencies {
+  /// Modules from the import table, then delay-loaded ones.
+  final List<ImportedModule> imports;
+
+  /// The DLL name recorded in the export directory, or null.
+  final String? exportName;
+
+  /// Exported names, then `#<ordinal>` for functions exported by ordinal
+  /// only.
+  final List<String> exports;
+
+  /// Error code when the file could not be read (e.g. `FILE_NOT_FOUND`, or
+  /// `UNSUPPORTED_FORMAT` for anything but a PE image), or null on success.
+  final String? error;
+
+  BinaryDependencies({
+    this.imports = const [],
+    this.exportName,
+    this.exports = const [],
+    this.error,
+  });
+
+  /// Decodes the reply of the `getBinaryDependencies` method: a `names`
+  /// table and, per file, lists of ids into it.
+  static List<BinaryDependencies> fromBatch(Map<String, dynamic> json) {
+    final names = (json['names'] as List? ?? const []).cast<String>();
+    final files = json['files'] as List? ?? const [];
+    return [
+      for (final file in files)
+        _fromIds(Map<String, dynamic>.from(file as Map), names),
+    ];
+  }
+
+  static BinaryDependencies _fromIds(
+      Map<String, dynamic> json, List<String> names) {
+    final exportName = json['exportName'];
+    return BinaryDependencies(
+      imports: [
+        ..._modules(json['imports'] as List?, names, false),
+        ..._modules(json['delayImports'] as List?, names, true),
+      ],
+      exportName: exportName is int ? names[exportName] : null,
+      exports: [
+        for (final id in (json['exports'] as List? ?? const []))
+          names[id as int],
+      ],
+      error: json['error'],
+    );
+  }
+
+  /// Decodes `[name, function count, function ids...]` runs.
+  static List<ImportedModule> _modules(
+      List? ids, List<String> names, bool delayLoaded) {
+    final modules = <ImportedModule>[];
+    if (ids == null) {
+      return modules;
+    }
+    var i = 0;
+    while (i + 1 < ids.length) {
+      final name = names[ids[i] as int];
+      final count = ids[i + 1] as int;
+      i += 2;
+      final end = i + count < ids.length ? i + count : ids.length;
+      modules.add(ImportedModule(
+        name: name,
+        functions: [for (final id in ids.sublist(i, end)) names[id as int]],
+        delayLoaded: delayLoaded,
+      ));
+      i = end;
+    }
+    return modules;
+  }
+}
@@ -1,3 +1,6 @@
+import 'code_signature.dart';
+import 'hash_algorithm.dart';
+
 enum BinaryFileMetadataJsonKey {
   version,
   productName,
@@ -5,11 +8,19 @@ enum BinaryFileMetadataJsonKey {
   legalCopyright,
   originalFilename,
   companyName,
+  error,
+  bytesRead,
   ;
 
   String get key {
     return toString().split('.').last;
   }
+
+  static final Set<String> _keys =
+      BinaryFileMetadataJsonKey.values.map((e) => e.key).toSet();
+
+  /// Whether [key] is one of the standard metadata keys.
+  static bool isStandardKey(String key) => _keys.contains(key);
 }
 
 /// Represents file metadata information
@@ -21,6 +32,28 @@ class BinaryFileMetadata {
   final String originalFilename;
   final String companyName;
 
+  /// Additional version-resource strings requested through `customKeys`,
+  /// keyed by the name they were requested with.
+  final Map<String, String> customFields;
+
+  /// Lowercase hex digests of the whole file, keyed by [HashAlgorithm.key]
+  /// (e.g. `sha256`), for the algorithms that were requested.
+  final Map<String, String> hashes;
+
+  /// The embedded code signature's signer, when `signature` was requested
+  /// and the file is signed.
+  final CodeSignature? signature;
+
+  /// Error code when the file could not be read in a batch request (e.g.
+  /// `FILE_NOT_FOUND`, `NO_VERSION_INFO`, or `BUDGET_EXCEEDED` and
+  /// `TIMED_OUT` under an I/O budget), or null on success.
+  final String? error;
+
+  /// Bytes fetched from disk when a byte budget or deadline is configured
+  /// (see `FlutterBin.configure`), or null when the file was mapped or the
+  /// result came from the cache.
+  final int? bytesRead;
+
   factory BinaryFileMetadata.fromJson(Map<String, dynamic> json) {
     return BinaryFileMetadata(
       version: json[BinaryFileMetadataJsonKey.version.key] ?? '',
@@ -31,6 +64,22 @@ class BinaryFileMetadata {
       originalFilename:
           json[BinaryFileMetadataJsonKey.originalFilename.key] ?? '',
       companyName: json[BinaryFileMetadataJsonKey.companyName.key] ?? '',
+      customFields: {
+        for (final entry in json.entries)
+          if (!BinaryFileMetadataJsonKey.isStandardKey(entry.key) &&
+              !HashAlgorithm.isHashKey(entry.key) &&
+              !CodeSignatureJsonKey.isSignerKey(entry.key) &&
+              entry.value is String)
+            entry.key: entry.value as String,
+      },
+      hashes: {
+        for (final entry in json.entries)
+          if (HashAlgorithm.isHashKey(entry.key) && entry.value is String)
+            entry.key: entry.value as String,
+      },
+      signature: CodeSignature.fromJson(json),
+      error: json[BinaryFileMetadataJsonKey.error.key],
+      bytesRead: json[BinaryFileMetadataJsonKey.bytesRead.key],
     );
   }
 
@@ -41,5 +90,10 @@ class BinaryFileMetadata {
     this.legalCopyright = '',
     this.originalFilename = '',
     this.companyName = '',
+    this.customFields = const {},
+    this.hashes = const {},
+    this.signature,
+    this.error,
+    this.bytesRead,
   });
 }
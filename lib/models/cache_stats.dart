@@ -0,0 +1,45 @@
+/// Counters of the native metadata cache.
+class CacheStats {
+  /// Lookups answered from the cache.
+  final int hits;
+
+  /// Lookups that had to read the file.
+  final int misses;
+
+  /// Entries dropped to stay within [budgetBytes].
+  final int evictions;
+
+  /// Misses in memory that were answered by the persistent index.
+  final int indexHits;
+
+  /// Entries currently cached.
+  final int entries;
+
+  /// Approximate memory used by the cached entries.
+  final int bytes;
+
+  /// Memory the cache may use; 0 when caching is disabled.
+  final int budgetBytes;
+
+  factory CacheStats.fromJson(Map<String, dynamic> json) {
+    return CacheStats(
+      hits: json['hits'] ?? 0,
+      misses: json['misses'] ?? 0,
+      evictions: json['evictions'] ?? 0,
+      indexHits: json['indexHits'] ?? 0,
+      entries: json['entries'] ?? 0,
+      bytes: json['bytes'] ?? 0,
+      budgetBytes: json['budgetBytes'] ?? 0,
+    );
+  }
+
+  CacheStats({
+    this.hits = 0,
+    this.misses = 0,
+    this.evictions = 0,
+    this.indexHits = 0,
+    this.entries = 0,
+    this.bytes = 0,
+    this.budgetBytes = 0,
+  });
+}
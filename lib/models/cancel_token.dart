@@ -0,0 +1,28 @@
+import '../flutter_bin_platform_interface.dart';
+
+/// Cancels in-flight native requests.
+///
+/// Pass a token to a [FlutterBin] call and call [cancel] to abandon it. The
+/// cancelled call completes with a `PlatformException` whose code is
+/// `CANCELLED`. Use a new token for each call.
+class CancelToken {
+  CancelToken() : id = _nextId++;
+
+  static int _nextId = 1;
+
+  /// Identifies the request made with this token on the native side.
+  final int id;
+
+  bool _isCancelled = false;
+
+  /// Whether [cancel] has been called.
+  bool get isCancelled => _isCancelled;
+
+  /// Cancels the request made with this token.
+  ///
+  /// Returns true if the request was still running on the native side.
+  Future<bool> cancel() {
+    _isCancelled = true;
+    return FlutterBinPlatform.instance.cancelRequest(id);
+  }
+}
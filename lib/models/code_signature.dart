@@ -0,0 +1,61 @@
+enum CodeSignatureJsonKey {
+  signerName,
+  signerIssuer,
+  signerSerial,
+  signingTime,
+  ;
+
+  String get key {
+    return toString().split('.').last;
+  }
+
+  static final Set<String> _keys =
+      CodeSignatureJsonKey.values.map((e) => e.key).toSet();
+
+  /// Whether [key] is one of the signer keys.
+  static bool isSignerKey(String key) => _keys.contains(key);
+}
+
+/// Who signed a file and when, as recorded in its embedded code signature
+/// (the Authenticode certificate table of a PE file or the CMS blob of a
+/// Mach-O LC_CODE_SIGNATURE).
+///
+/// The values are read as-is: the signature is not verified and the
+/// certificate chain is not validated.
+class CodeSignature {
+  /// Common name of the signing certificate's subject.
+  final String signerName;
+
+  /// Issuer of the signing certificate, e.g.
+  /// `CN=Example CA, O=Example, C=US`.
+  final String issuer;
+
+  /// Serial number of the signing certificate in lowercase hex.
+  final String serialNumber;
+
+  /// When the signature was timestamped, or null if it was not.
+  final DateTime? timestamp;
+
+  /// Reads the signer keys of a metadata map, or returns null if the file
+  /// has no signature.
+  static CodeSignature? fromJson(Map<String, dynamic> json) {
+    final signerName = json[CodeSignatureJsonKey.signerName.key];
+    if (signerName is! String) {
+      return null;
+    }
+    final signingTime = json[CodeSignatureJsonKey.signingTime.key];
+    return CodeSignature(
+      signerName: signerName,
+      issuer: json[CodeSignatureJsonKey.signerIssuer.key] ?? '',
+      serialNumber: json[CodeSignatureJsonKey.signerSerial.key] ?? '',
+      timestamp: signingTime is String ? DateTime.tryParse(signingTime) : null,
+    );
+  }
+
+  CodeSignature({
+    required this.signerName,
+    this.issuer = '',
+    this.serialNumber = '',
+    this.timestamp,
+  });
+}
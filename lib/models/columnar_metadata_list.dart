@@ -0,0 +1,118 @@
+import 'dart:collection';
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'binary_file_metadata.dart';
+
+/// A batch result in the columnar encoding of `getBinaryFileMetadataBatch`
+/// (see src/columnar_batch.h), decoded on access.
+///
+/// The payload holds one column of string ids per metadata key and a table
+/// in which every distinct key and value is stored once. Rows are decoded
+/// the first time they are read, and each string is decoded once and then
+/// shared by every row that uses it.
+class ColumnarMetadataList extends ListBase<BinaryFileMetadata> {
+  static const int _magic = 0x42434246;
+  static const int _headerSize = 24;
+  static const int _noValue = 0xFFFFFFFF;
+
+  final Uint8List _bytes;
+  final ByteData _data;
+  final int _rowCount;
+  final int _columnCount;
+  final int _stringCount;
+  final int _offsetsStart;
+  final int _stringsStart;
+  final List<String?> _strings;
+  final List<BinaryFileMetadata?> _rows;
+  List<String>? _keys;
+
+  ColumnarMetadataList._(this._bytes, this._data, this._rowCount,
+      this._columnCount, this._stringCount, this._offsetsStart)
+      : _stringsStart = _offsetsStart + (_stringCount + 1) * 4,
+        _strings = List<String?>.filled(_stringCount, null),
+        _rows = List<BinaryFileMetadata?>.filled(_rowCount, null);
+
+  /// Wraps [bytes] after checking that its header and tables fit. Throws a
+  /// [FormatException] otherwise.
+  factory ColumnarMetadataList(Uint8List bytes) {
+    final data = ByteData.sublistView(bytes);
+    if (bytes.length < _headerSize ||
+        data.getUint32(0, Endian.little) != _magic ||
+        data.getUint32(4, Endian.little) != bytes.length) {
+      throw const FormatException('Not a columnar metadata batch');
+    }
+    final rows = data.getUint32(8, Endian.little);
+    final columns = data.getUint32(12, Endian.little);
+    final strings = data.getUint32(16, Endian.little);
+    final offsets = _headerSize + columns * 4 * (1 + rows);
+    if (offsets + (strings + 1) * 4 > bytes.length) {
+      throw const FormatException('Columnar batch tables are truncated');
+    }
+    return ColumnarMetadataList._(bytes, data, rows, columns, strings, offsets);
+  }
+
+  @override
+  int get length => _rowCount;
+
+  @override
+  set length(int newLength) =>
+      throw UnsupportedError('Cannot change the length of a batch result');
+
+  @override
+  BinaryFileMetadata operator [](int index) {
+    RangeError.checkValidIndex(index, this);
+    return _rows[index] ??= _decodeRow(index);
+  }
+
+  @override
+  void operator []=(int index, BinaryFileMetadata value) =>
+      throw UnsupportedError('Cannot modify a batch result');
+
+  /// The value of [key] in row [index] without decoding the rest of the
+  /// row, or null if that file has no such field.
+  String? fieldAt(int index, String key) {
+    RangeError.checkValidIndex(index, this);
+    final column = _columnKeys.indexOf(key);
+    return column < 0 ? null : _value(column, index);
+  }
+
+  List<String> get _columnKeys => _keys ??= [
+        for (var c = 0; c < _columnCount; c++)
+          _string(_data.getUint32(_headerSize + c * 4, Endian.little)),
+      ];
+
+  BinaryFileMetadata _decodeRow(int index) {
+    final keys = _columnKeys;
+    final json = <String, dynamic>{};
+    for (var c = 0; c < keys.length; c++) {
+      final value = _value(c, index);
+      if (value != null) {
+        json[keys[c]] = value;
+      }
+    }
+    return BinaryFileMetadata.fromJson(json);
+  }
+
+  String? _value(int column, int row) {
+    final id = _data.getUint32(
+        _headerSize + (_columnCount + column * _rowCount + row) * 4,
+        Endian.little);
+    return id == _noValue ? null : _string(id);
+  }
+
+  String _string(int id) {
+    if (id >= _stringCount) {
+      throw FormatException('String id $id out of range');
+    }
+    return _strings[id] ??= () {
+      final at = _offsetsStart + id * 4;
+      final begin = _stringsStart + _data.getUint32(at, Endian.little);
+      final end = _stringsStart + _data.getUint32(at + 4, Endian.little);
+      if (begin > end || end > _bytes.length) {
+        throw const FormatException('String outside the batch');
+      }
+      return utf8.decode(Uint8List.sublistView(_bytes, begin, end));
+    }();
+  }
+}
@@ -0,0 +1,23 @@
+/// Digests that can be computed while a file's metadata is read.
+enum HashAlgorithm {
+  sha256,
+  blake3,
+
+  /// The Authenticode SHA-256 image digest of a PE file, which is what code
+  /// signatures and allow lists refer to and which does not change when the
+  /// file is signed. Only reported for PE files.
+  authenticode,
+  ;
+
+  /// The name used on the platform channel and in
+  /// [BinaryFileMetadata.hashes], e.g. `sha256`.
+  String get key {
+    return toString().split('.').last;
+  }
+
+  static final Set<String> _keys =
+      HashAlgorithm.values.map((e) => e.key).toSet();
+
+  /// Whether [key] names a hash algorithm.
+  static bool isHashKey(String key) => _keys.contains(key);
+}
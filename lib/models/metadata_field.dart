@@ -0,0 +1,36 @@
+/// A field [FlutterBin.getBinaryFileMetadata] can be limited to. Fields that
+/// are not requested are never decoded on the native side.
+enum MetadataField {
+  version,
+  productName,
+  fileDescription,
+  legalCopyright,
+  originalFilename,
+  companyName,
+  sha256,
+  blake3,
+  authenticode,
+
+  /// Everything in [BinaryFileMetadata.signature].
+  signature,
+  ;
+
+  /// The fields read when none are given.
+  static const Set<MetadataField> standard = {
+    version,
+    productName,
+    fileDescription,
+    legalCopyright,
+    originalFilename,
+    companyName,
+  };
+
+  /// The bit of this field in the mask sent on the platform channel.
+  int get bit => 1 << index;
+
+  /// The platform channel mask of [fields], e.g. `0x21` for [version] and
+  /// [companyName].
+  static int maskOf(Iterable<MetadataField> fields) {
+    return fields.fold(0, (mask, field) => mask | field.bit);
+  }
+}
@@ -0,0 +1,105 @@
+import 'request_priority.dart';
+
+/// Latency of one phase of the native request handling.
+class PhaseStats {
+  /// How many times the phase ran.
+  final int count;
+
+  /// Time spent in the phase, summed over every call and thread.
+  final int totalNanos;
+
+  /// Percentiles, rounded up to the native histogram's bucket bounds (within
+  /// 1/8 of the true value).
+  final int p50Nanos;
+  final int p90Nanos;
+  final int p99Nanos;
+  final int maxNanos;
+
+  factory PhaseStats.fromJson(Map<String, dynamic> json) {
+    return PhaseStats(
+      count: json['count'] ?? 0,
+      totalNanos: json['totalNanos'] ?? 0,
+      p50Nanos: json['p50Nanos'] ?? 0,
+      p90Nanos: json['p90Nanos'] ?? 0,
+      p99Nanos: json['p99Nanos'] ?? 0,
+      maxNanos: json['maxNanos'] ?? 0,
+    );
+  }
+
+  PhaseStats({
+    this.count = 0,
+    this.totalNanos = 0,
+    this.p50Nanos = 0,
+    this.p90Nanos = 0,
+    this.p99Nanos = 0,
+    this.maxNanos = 0,
+  });
+
+  Duration get total => Duration(microseconds: totalNanos ~/ 1000);
+
+  Duration get mean => count == 0
+      ? Duration.zero
+      : Duration(microseconds: totalNanos ~/ count ~/ 1000);
+
+  Duration get p50 => Duration(microseconds: p50Nanos ~/ 1000);
+  Duration get p90 => Duration(microseconds: p90Nanos ~/ 1000);
+  Duration get p99 => Duration(microseconds: p99Nanos ~/ 1000);
+  Duration get max => Duration(microseconds: maxNanos ~/ 1000);
+}
+
+/// Per-phase timings of the native side since the last reset.
+///
+/// Phases are keyed by name: `methodCall` (a whole call), `pathConversion`
+/// (Windows only), `attributeLookup` (the stat that validates a cache
+/// entry), `fileOpen`, `headerParse`, `resourceRead`, `stringDecode`, `hash`
+/// and `encode` (building the reply). Phases nest inside `methodCall`, and
+/// phases that never ran are absent.
+class PerfStats {
+  /// Whether timing is switched on; see `configure(perfStats:)`.
+  final bool enabled;
+
+  final Map<String, PhaseStats> phases;
+
+  /// Time from submission to completion of the requests of each
+  /// [RequestPriority], queueing included, while timing is on. Classes with
+  /// no completed requests are absent.
+  final Map<RequestPriority, PhaseStats> priorities;
+
+  /// Chrome trace event JSON of the most recent phases, when requested and
+  /// `configure(perfTrace:)` is on. Loads in chrome://tracing or Perfetto.
+  final String? trace;
+
+  factory PerfStats.fromJson(Map<String, dynamic> json) {
+    final phases = <String, PhaseStats>{};
+    final Map<dynamic, dynamic> raw = json['phases'] ?? const {};
+    raw.forEach((name, stats) {
+      phases[name as String] =
+          PhaseStats.fromJson(Map<String, dynamic>.from(stats as Map));
+    });
+    final priorities = <RequestPriority, PhaseStats>{};
+    final Map<dynamic, dynamic> rawPriorities = json['priorities'] ?? const {};
+    for (final priority in RequestPriority.values) {
+      final stats = rawPriorities[priority.key];
+      if (stats != null) {
+        priorities[priority] =
+            PhaseStats.fromJson(Map<String, dynamic>.from(stats as Map));
+      }
+    }
+    return PerfStats(
+      enabled: json['enabled'] ?? false,
+      phases: phases,
+      priorities: priorities,
+      trace: json['trace'],
+    );
+  }
+
+  PerfStats({
+    this.enabled = false,
+    this.phases = const {},
+    this.priorities = const {},
+    this.trace,
+  });
+
+  /// The stats of [phase], all zero if it never ran.
+  PhaseStats operator [](String phase) => phases[phase] ?? PhaseStats();
+}
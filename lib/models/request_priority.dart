@@ -0,0 +1,18 @@
+/// How urgently the native side should run a request relative to others
+/// queued at the same time.
+enum RequestPriority {
+  /// Something the user is waiting on, such as the file they selected.
+  /// Starts ahead of queued normal and bulk work.
+  interactive,
+  normal,
+
+  /// Background work such as inventories of many files, which is limited to
+  /// part of the worker threads so interactive requests find one free.
+  bulk,
+  ;
+
+  /// The name used on the platform channel, e.g. `bulk`.
+  String get key {
+    return toString().split('.').last;
+  }
+}
@@ -0,0 +1,33 @@
+import 'binary_file_metadata.dart';
+
+/// An executable found by `FlutterBin.scanDirectory`.
+class ScanResult {
+  /// Absolute path of the file.
+  final String path;
+
+  /// Executable format detected from the file's magic bytes: `pe`, `elf` or
+  /// `macho`.
+  final String format;
+
+  /// Metadata read from the file; [BinaryFileMetadata.error] is set when it
+  /// could not be read.
+  final BinaryFileMetadata metadata;
+
+  factory ScanResult.fromJson(Map<String, dynamic> json) {
+    return ScanResult(
+      path: json['path'] ?? '',
+      format: json['format'] ?? '',
+      metadata: BinaryFileMetadata.fromJson({
+        for (final entry in json.entries)
+          if (entry.key != 'path' && entry.key != 'format')
+            entry.key: entry.value,
+      }),
+    );
+  }
+
+  ScanResult({
+    required this.path,
+    required this.format,
+    required this.metadata,
+  });
+}
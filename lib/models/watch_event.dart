@@ -0,0 +1,64 @@
+import 'binary_file_metadata.dart';
+
+/// What happened to a file reported by `FlutterBin.watch`.
+enum WatchChange {
+  /// A binary appeared: it was created, moved in, or a file that was not a
+  /// binary became one.
+  added,
+
+  /// A binary changed.
+  modified,
+
+  /// A binary was deleted, moved out or replaced by something else.
+  removed,
+
+  /// The native side dropped notifications under [WatchEvent.path]; scan it
+  /// again to catch up.
+  overflow,
+}
+
+/// One settled change of a watched file.
+class WatchEvent {
+  /// Absolute path of the file, or of the watched path for
+  /// [WatchChange.overflow].
+  final String path;
+
+  final WatchChange change;
+
+  /// Executable format: `pe`, `elf` or `macho`. Null for removals of files
+  /// the watch never read, which may not have been binaries at all.
+  final String? format;
+
+  /// Metadata read after the change settled; only set for
+  /// [WatchChange.added] and [WatchChange.modified].
+  final BinaryFileMetadata? metadata;
+
+  factory WatchEvent.fromJson(Map<String, dynamic> json) {
+    final change = WatchChange.values.firstWhere(
+        (value) => value.name == json['change'],
+        orElse: () => WatchChange.modified);
+    final read =
+        change == WatchChange.added || change == WatchChange.modified;
+    return WatchEvent(
+      path: json['path'] ?? '',
+      change: change,
+      format: json['format'],
+      metadata: read
+          ? BinaryFileMetadata.fromJson({
+              for (final entry in json.entries)
+                if (entry.key != 'path' &&
+                    entry.key != 'change' &&
+                    entry.key != 'format')
+                  entry.key: entry.value,
+            })
+          : null,
+    );
+  }
+
+  WatchEvent({
+    required this.path,
+    required this.change,
+    this.format,
+    this.metadata,
+  });
+}
@@ -0,0 +1,1193 @@
+#include "include/flutter_bin/flutter_bin_plugin.h"
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "async_executor.h"
+#include "binary_metadata.h"
+#include "columnar_batch.h"
+#include "content_hash.h"
+#include "directory_scan.h"
+#include "file_head_reader.h"
+#include "file_watcher.h"
+#include "flat_metadata.h"
+#include "glib_dispatcher.h"
+#include "metadata_cache.h"
+#include "metadata_index.h"
+#include "perf_stats.h"
+#include "string_pool.h"
+#include "thread_pool.h"
+
+#define FLUTTER_BIN_PLUGIN(obj)                                     \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), flutter_bin_plugin_get_type(), \
+                              FlutterBinPlugin))
+
+namespace flutter_bin {
+
+namespace {
+
+using FlValuePtr = std::shared_ptr<FlValue>;
+
+FlValuePtr TakeValue(FlValue* value) {
+  return FlValuePtr(value, &fl_value_unref);
+}
+
+// Returns the member |key| of the map |arguments|, or null.
+FlValue* Lookup(FlValue* arguments, const char* key) {
+  if (arguments == nullptr || fl_value_get_type(arguments) != FL_VALUE_TYPE_MAP) {
+    return nullptr;
+  }
+  FlValue* value = fl_value_lookup_string(arguments, key);
+  return value != nullptr && fl_value_get_type(value) != FL_VALUE_TYPE_NULL
+             ? value
+             : nullptr;
+}
+
+// Reads an optional string argument. Returns false if |key| is present but
+// is not a string.
+bool GetStringArgument(FlValue* arguments, const char* key, std::string* out) {
+  FlValue* value = Lookup(arguments, key);
+  if (value == nullptr) {
+    return true;
+  }
+  if (fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+    return false;
+  }
+  *out = fl_value_get_string(value);
+  return true;
+}
+
+// Reads an optional list of strings argument. Returns false if |key| is
+// present but is not a list of strings.
+bool GetStringListArgument(FlValue* arguments, const char* key,
+                           std::vector<std::string>* out) {
+  FlValue* list = Lookup(arguments, key);
+  if (list == nullptr) {
+    return true;
+  }
+  if (fl_value_get_type(list) != FL_VALUE_TYPE_LIST) {
+    return false;
+  }
+  for (size_t i = 0; i < fl_value_get_length(list); ++i) {
+    FlValue* item = fl_value_get_list_value(list, i);
+    if (fl_value_get_type(item) != FL_VALUE_TYPE_STRING) {
+      return false;
+    }
+    out->push_back(fl_value_get_string(item));
+  }
+  return true;
+}
+
+// Reads the optional integer |key|.
+int64_t GetIntArgument(FlValue* arguments, const char* key,
+                       int64_t default_value) {
+  FlValue* value = Lookup(arguments, key);
+  return value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT
+             ? fl_value_get_int(value)
+             : default_value;
+}
+
+// Reads the optional "priority" argument, one of the RequestPriorityName()s,
+// into |priority|, which keeps its value if the argument is absent. Returns
+// false if it is present but not a known class.
+bool GetPriorityArgument(FlValue* arguments, RequestPriority* priority) {
+  std::string name;
+  if (!GetStringArgument(arguments, "priority", &name)) {
+    return false;
+  }
+  return name.empty() || ParseRequestPriority(name, priority);
+}
+
+// Reads the optional bool |key|.
+bool GetBoolArgument(FlValue* arguments, const char* key, bool default_value) {
+  FlValue* value = Lookup(arguments, key);
+  return value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL
+             ? fl_value_get_bool(value)
+             : default_value;
+}
+
+// Builds the request of a getBinaryFileMetadata call: the fields in the
+// optional "fieldMask" argument (the standard ones by default), so fields
+// Dart did not ask for are never decoded, plus |custom_keys|, |hashes| and
+// the signer if "signature" is set. Returns false for an invalid mask.
+bool GetMetadataRequest(FlValue* arguments,
+                        const std::vector<std::string>& custom_keys,
+                        const std::vector<HashAlgorithm>& hashes,
+                        MetadataRequest* request) {
+  int64_t mask = GetIntArgument(arguments, "fieldMask", kStandardFieldMask);
+  if (mask < 0 || mask > kAllFieldsMask ||
+      !MetadataRequest::FromMask(static_cast<uint32_t>(mask), custom_keys,
+                                 request)) {
+    return false;
+  }
+  for (HashAlgorithm hash : hashes) {
+    if (std::find(request->hashes.begin(), request->hashes.end(), hash) ==
+        request->hashes.end()) {
+      request->hashes.push_back(hash);
+    }
+  }
+  request->signature = request->signature ||
+                       GetBoolArgument(arguments, "signature", false);
+  return true;
+}
+
+FlValue* ToFlValue(const MetadataCacheStats& stats) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "hits",
+                           fl_value_new_int(static_cast<int64_t>(stats.hits)));
+  fl_value_set_string_take(map, "misses",
+                           fl_value_new_int(static_cast<int64_t>(stats.misses)));
+  fl_value_set_string_take(
+      map, "evictions", fl_value_new_int(static_cast<int64_t>(stats.evictions)));
+  fl_value_set_string_take(
+      map, "indexHits", fl_value_new_int(static_cast<int64_t>(stats.index_hits)));
+  fl_value_set_string_take(
+      map, "entries", fl_value_new_int(static_cast<int64_t>(stats.entries)));
+  fl_value_set_string_take(map, "bytes",
+                           fl_value_new_int(static_cast<int64_t>(stats.bytes)));
+  fl_value_set_string_take(
+      map, "budgetBytes", fl_value_new_int(static_cast<int64_t>(stats.budget)));
+  return map;
+}
+
+// Phases with no samples are left out.
+FlValue* ToFlValue(const PhaseStats& stats) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(
+      map, "count", fl_value_new_int(static_cast<int64_t>(stats.count)));
+  fl_value_set_string_take(
+      map, "totalNanos", fl_value_new_int(static_cast<int64_t>(stats.total_ns)));
+  fl_value_set_string_take(
+      map, "p50Nanos", fl_value_new_int(static_cast<int64_t>(stats.p50_ns)));
+  fl_value_set_string_take(
+      map, "p90Nanos", fl_value_new_int(static_cast<int64_t>(stats.p90_ns)));
+  fl_value_set_string_take(
+      map, "p99Nanos", fl_value_new_int(static_cast<int64_t>(stats.p99_ns)));
+  fl_value_set_string_take(
+      map, "maxNanos", fl_value_new_int(static_cast<int64_t>(stats.max_ns)));
+  return map;
+}
+
+FlValue* ToFlValue(const PerfSnapshot& snapshot) {
+  FlValue* phases = fl_value_new_map();
+  for (size_t i = 0; i < kPerfPhaseCount; ++i) {
+    const PhaseStats& stats = snapshot.phases[i];
+    if (stats.count == 0) {
+      continue;
+    }
+    fl_value_set_string_take(phases, PerfPhaseName(static_cast<PerfPhase>(i)),
+                             ToFlValue(stats));
+  }
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "enabled", fl_value_new_bool(snapshot.enabled));
+  fl_value_set_string_take(map, "phases", phases);
+  return map;
+}
+
+FlValue* ToFlValue(const BinaryMetadata& metadata, bool with_error) {
+  FlValue* map = fl_value_new_map();
+  for (const auto& pair : metadata.fields) {
+    fl_value_set_string_take(map, pair.first.c_str(),
+                             fl_value_new_string(pair.second.c_str()));
+  }
+  if (with_error && metadata.error != MetadataError::kNone) {
+    fl_value_set_string_take(
+        map, "error", fl_value_new_string(MetadataErrorCode(metadata.error)));
+  }
+  if (metadata.bytes_read != 0) {
+    fl_value_set_string_take(
+        map, "bytesRead",
+        fl_value_new_int(static_cast<int64_t>(metadata.bytes_read)));
+  }
+  return map;
+}
+
+// Encodes a dependency batch: every interned name once, then each file's
+// imports and exports as Int32Lists of ids into "names".
+FlValue* ToFlValue(const StringPool& pool,
+                   const std::vector<FlatDependencies>& batch) {
+  FlValue* names = fl_value_new_list();
+  for (size_t id = 0; id < pool.size(); ++id) {
+    std::string_view name = pool.Get(static_cast<uint32_t>(id));
+    fl_value_append_take(names,
+                         fl_value_new_string_sized(name.data(), name.size()));
+  }
+  FlValue* files = fl_value_new_list();
+  for (const FlatDependencies& entry : batch) {
+    FlValue* file = fl_value_new_map();
+    fl_value_set_string_take(
+        file, "imports",
+        fl_value_new_int32_list(entry.imports.data(), entry.imports.size()));
+    fl_value_set_string_take(
+        file, "delayImports",
+        fl_value_new_int32_list(entry.delay_imports.data(),
+                                entry.delay_imports.size()));
+    fl_value_set_string_take(
+        file, "exports",
+        fl_value_new_int32_list(entry.exports.data(), entry.exports.size()));
+    if (entry.export_name != StringPool::kNoString) {
+      fl_value_set_string_take(file, "exportName",
+                               fl_value_new_int(entry.export_name));
+    }
+    if (entry.error != MetadataError::kNone) {
+      fl_value_set_string_take(
+          file, "error", fl_value_new_string(MetadataErrorCode(entry.error)));
+    }
+    fl_value_append_take(files, file);
+  }
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "names", names);
+  fl_value_set_string_take(map, "files", files);
+  return map;
+}
+
+// Turns extensions as Dart passes them (".EXE") into the form the core
+// matches ("exe").
+void NormalizeExtensions(std::vector<std::string>* extensions) {
+  for (std::string& extension : *extensions) {
+    if (!extension.empty() && extension[0] == '.') {
+      extension.erase(0, 1);
+    }
+    for (char& c : extension) {
+      if (c >= 'A' && c <= 'Z') {
+        c = static_cast<char>(c - 'A' + 'a');
+      }
+    }
+  }
+}
+
+void Respond(FlMethodCall* method_call, FlMethodResponse* response) {
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to send method call response: %s", error->message);
+  }
+}
+
+void RespondError(FlMethodCall* method_call, const char* code,
+                  const std::string& message) {
+  g_autoptr(FlMethodResponse) response =
+      fl_method_error_response_new(code, message.c_str(), nullptr);
+  Respond(method_call, response);
+}
+
+void RespondSuccess(FlMethodCall* method_call, FlValue* value) {
+  g_autoptr(FlMethodResponse) response = fl_method_success_response_new(value);
+  Respond(method_call, response);
+}
+
+}  // namespace
+
+// The state behind the GObject: method call handling, the metadata cache and
+// the executor that keeps file I/O off the GTK main loop.
+class MethodHandler {
+ public:
+  MethodHandler() : dispatcher_(std::make_unique<GlibDispatcher>()) {}
+  ~MethodHandler();
+
+  // Disallow copy and assign.
+  MethodHandler(const MethodHandler&) = delete;
+  MethodHandler& operator=(const MethodHandler&) = delete;
+
+  void HandleMethodCall(FlMethodCall* method_call);
+
+  // Streams scan batches to |channel| while Dart listens to it.
+  void SetScanChannel(FlEventChannel* channel);
+
+  // Streams watch events to |channel| while Dart listens to it.
+  void SetWatchChannel(FlEventChannel* channel);
+
+ private:
+  // Produces a method call result; returns a new reference. May run on a
+  // worker thread.
+  using Work = std::function<FlValue*(const std::atomic<bool>& cancelled)>;
+
+  // Runs |work| on the executor, or inline when asynchronous execution is
+  // off, and responds to |method_call| with its result.
+  void Run(int64_t request_id, RequestPriority priority,
+           FlMethodCall* method_call, Work work);
+
+  // Creates the executor on first use.
+  AsyncExecutor* executor();
+
+  void Configure(FlMethodCall* method_call, FlValue* arguments);
+
+  // Opens the index at |index_path|, or none if it is empty, swaps it into
+  // |metadata_cache_| and then responds to the configure |method_call|.
+  // Opening reads the whole log and closing the old index waits for its
+  // compaction, so both run on the executor when execution is asynchronous.
+  void ReplaceIndex(FlMethodCall* method_call, const std::string& index_path);
+
+  // Starts a DirectoryScan that streams to the scan channel.
+  void StartScan(FlMethodCall* method_call, FlValue* arguments);
+
+  // Sends one scan batch to Dart. Runs on the platform thread.
+  void SendScanBatch(int64_t scan_id, const std::vector<ScanEntry>& batch,
+                     const ScanSummary* summary);
+
+  // Starts a FileWatcher that streams to the watch channel.
+  void StartWatch(FlMethodCall* method_call, FlValue* arguments);
+
+  // Sends the changes that settled together to Dart. Runs on the platform
+  // thread.
+  void SendWatchEvents(int64_t watch_id, const std::vector<WatchEvent>& events);
+
+  // Stops |watcher| and destroys it on the executor: its thread may be in
+  // the middle of a read, which the platform thread must not wait for.
+  void StopWatch(std::unique_ptr<FileWatcher> watcher);
+
+  ThreadPool* thread_pool();
+
+  std::string GetBinaryFileVersion(const std::string& file_path,
+                                   bool use_cache);
+  BinaryMetadata GetBinaryFileMetadata(const std::string& file_path,
+                                       const MetadataRequest& request,
+                                       bool use_cache);
+  // Reads |file_path| itself, bypassing the cache.
+  BinaryMetadata LoadBinaryFileMetadata(const std::string& file_path,
+                                        const MetadataRequest& request);
+  // LoadBinaryFileMetadata() for a file a watch reported, which may still be
+  // written to: read without mapping it, so truncation cannot fault.
+  BinaryMetadata LoadChangedFileMetadata(const std::string& file_path,
+                                         const MetadataRequest& request);
+  // Reads paths[i] into (*results)[i] for each i in |indices|, bypassing the
+  // cache. Without I/O limits the files are opened and their heads read
+  // together through a FileHeadReader.
+  void LoadBinaryFileMetadataBatch(const std::vector<std::string>& paths,
+                                   const std::vector<size_t>& indices,
+                                   const MetadataRequest& request,
+                                   const std::atomic<bool>& cancelled,
+                                   std::vector<BinaryMetadata>* results);
+  // An idle FileHeadReader, or a new one if every reader is busy; hand it
+  // back with ReleaseHeadReader(). Safe to call from any thread.
+  std::unique_ptr<FileHeadReader> AcquireHeadReader();
+  void ReleaseHeadReader(std::unique_ptr<FileHeadReader> reader);
+
+  std::unique_ptr<ThreadPool> thread_pool_;
+  // Readers kept between batches, so that each batch does not set up a
+  // ring and its buffers again. Batches may run side by side, and a reader
+  // serves one at a time.
+  std::mutex head_readers_mutex_;
+  std::vector<std::unique_ptr<FileHeadReader>> head_readers_;
+  MetadataCache metadata_cache_;
+  std::unique_ptr<Dispatcher> dispatcher_;
+  // Declared after the pool, cache and dispatcher so in-flight work finishes
+  // before they go away; the scans and watches below go first.
+  std::unique_ptr<AsyncExecutor> executor_;
+  bool async_execution_ = true;
+  // Limits of one file's reads, 0 for none; set by configure and read by
+  // the workers. Either one switches PE reads to ReadBinaryMetadataBounded.
+  std::atomic<uint64_t> io_byte_budget_{0};
+  std::atomic<int64_t> io_deadline_ms_{0};
+
+  FlEventChannel* scan_channel_ = nullptr;
+  bool scan_listening_ = false;
+  FlEventChannel* watch_channel_ = nullptr;
+  bool watch_listening_ = false;
+  // Running directory scans by id; only touched on the platform thread.
+  // Their tasks run on |thread_pool_| and post to |dispatcher_|.
+  std::map<int64_t, std::unique_ptr<DirectoryScan>> scans_;
+  // Running watches by id; only touched on the platform thread. Their
+  // threads read through |metadata_cache_| and post to |dispatcher_|, so
+  // they are declared last.
+  std::map<int64_t, std::unique_ptr<FileWatcher>> watches_;
+};
+
+MethodHandler::~MethodHandler() {
+  watches_.clear();
+  scans_.clear();
+  if (scan_channel_ != nullptr) {
+    fl_event_channel_set_stream_handlers(scan_channel_, nullptr, nullptr,
+                                         nullptr, nullptr);
+    g_object_unref(scan_channel_);
+  }
+  if (watch_channel_ != nullptr) {
+    fl_event_channel_set_stream_handlers(watch_channel_, nullptr, nullptr,
+                                         nullptr, nullptr);
+    g_object_unref(watch_channel_);
+  }
+}
+
+void MethodHandler::SetScanChannel(FlEventChannel* channel) {
+  scan_channel_ = FL_EVENT_CHANNEL(g_object_ref(channel));
+  fl_event_channel_set_stream_handlers(
+      channel,
+      [](FlEventChannel*, FlValue*, gpointer user_data) -> FlMethodErrorResponse* {
+        static_cast<MethodHandler*>(user_data)->scan_listening_ = true;
+        return nullptr;
+      },
+      [](FlEventChannel*, FlValue*, gpointer user_data) -> FlMethodErrorResponse* {
+        auto* handler = static_cast<MethodHandler*>(user_data);
+        handler->scan_listening_ = false;
+        // Nobody is left to acknowledge batches.
+        for (auto& scan : handler->scans_) {
+          scan.second->Cancel();
+        }
+        return nullptr;
+      },
+      this, nullptr);
+}
+
+void MethodHandler::SetWatchChannel(FlEventChannel* channel) {
+  watch_channel_ = FL_EVENT_CHANNEL(g_object_ref(channel));
+  fl_event_channel_set_stream_handlers(
+      channel,
+      [](FlEventChannel*, FlValue*, gpointer user_data) -> FlMethodErrorResponse* {
+        static_cast<MethodHandler*>(user_data)->watch_listening_ = true;
+        return nullptr;
+      },
+      [](FlEventChannel*, FlValue*, gpointer user_data) -> FlMethodErrorResponse* {
+        auto* handler = static_cast<MethodHandler*>(user_data);
+        handler->watch_listening_ = false;
+        // Nobody is left to receive the changes.
+        for (auto& watch : handler->watches_) {
+          handler->StopWatch(std::move(watch.second));
+        }
+        handler->watches_.clear();
+        return nullptr;
+      },
+      this, nullptr);
+}
+
+void MethodHandler::HandleMethodCall(FlMethodCall* method_call) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* arguments = fl_method_call_get_args(method_call);
+  int64_t request_id =
+      GetIntArgument(arguments, "requestId", AsyncExecutor::kNoRequestId);
+  bool use_cache = GetBoolArgument(arguments, "useCache", true);
+  // A single file is usually what the user is looking at; lists of files
+  // are background work unless the caller says otherwise.
+  bool single_file =
+      method == "getBinaryFileVersion" || method == "getBinaryFileMetadata";
+  RequestPriority priority =
+      single_file ? RequestPriority::kInteractive : RequestPriority::kBulk;
+  if (!GetPriorityArgument(arguments, &priority)) {
+    RespondError(method_call, "INVALID_ARGUMENT",
+                 "Argument 'priority' must be 'interactive', 'normal' or "
+                 "'bulk'");
+    return;
+  }
+
+  if (single_file) {
+    std::string file_path;
+    std::vector<std::string> custom_keys;
+    std::vector<std::string> hash_names;
+    std::vector<HashAlgorithm> hashes;
+    MetadataRequest request;
+    if (Lookup(arguments, "filePath") == nullptr ||
+        !GetStringArgument(arguments, "filePath", &file_path)) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'filePath' must be a string");
+    } else if (!GetStringListArgument(arguments, "customKeys", &custom_keys)) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'customKeys' must be a list of strings");
+    } else if (!GetStringListArgument(arguments, "hashes", &hash_names) ||
+               !ParseHashAlgorithms(hash_names, &hashes)) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'hashes' must be a list of hash algorithm names");
+    } else if (method == "getBinaryFileVersion") {
+      Run(request_id, priority, method_call,
+          [this, file_path, use_cache](const std::atomic<bool>&) {
+            std::string version = GetBinaryFileVersion(file_path, use_cache);
+            return version.empty() ? fl_value_new_null()
+                                   : fl_value_new_string(version.c_str());
+          });
+    } else if (!GetMetadataRequest(arguments, custom_keys, hashes, &request)) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'fieldMask' must be a combination of metadata "
+                   "field bits");
+    } else {
+      Run(request_id, priority, method_call,
+          [this, file_path, request, use_cache](const std::atomic<bool>&) {
+            BinaryMetadata metadata =
+                GetBinaryFileMetadata(file_path, request, use_cache);
+            ScopedPhaseTimer timer(PerfPhase::kEncode);
+            return ToFlValue(metadata, false);
+          });
+    }
+  } else if (method == "getBinaryFileMetadataBatch") {
+    std::vector<std::string> paths;
+    std::vector<std::string> fields;
+    if (Lookup(arguments, "paths") == nullptr ||
+        !GetStringListArgument(arguments, "paths", &paths)) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'paths' must be a list of strings");
+    } else if (!GetStringListArgument(arguments, "fields", &fields)) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'fields' must be a list of strings");
+    } else {
+      MetadataRequest request = fields.empty() ? MetadataRequest::Standard()
+                                               : MetadataRequest::Only(fields);
+      bool columnar = GetBoolArgument(arguments, "columnar", false);
+      Run(request_id, priority, method_call,
+          [this, paths, request, use_cache,
+           columnar](const std::atomic<bool>& cancelled) {
+            std::vector<BinaryMetadata> batch;
+            auto load = [&](const std::vector<size_t>& misses,
+                            std::vector<BinaryMetadata>* results) {
+              LoadBinaryFileMetadataBatch(paths, misses, request, cancelled,
+                                          results);
+              return !cancelled.load(std::memory_order_relaxed);
+            };
+            if (use_cache) {
+              metadata_cache_.GetBatch(paths, request, thread_pool(), load,
+                                       &batch);
+            } else {
+              std::vector<size_t> all(paths.size());
+              for (size_t i = 0; i < all.size(); ++i) {
+                all[i] = i;
+              }
+              batch.resize(paths.size());
+              load(all, &batch);
+            }
+            ScopedPhaseTimer timer(PerfPhase::kEncode);
+            if (columnar) {
+              std::vector<uint8_t> bytes = EncodeColumnarBatch(batch);
+              return fl_value_new_uint8_list(bytes.data(), bytes.size());
+            }
+            // Results keep the order of |paths|; failures carry an error code.
+            FlValue* list = fl_value_new_list();
+            for (const BinaryMetadata& metadata : batch) {
+              fl_value_append_take(list, ToFlValue(metadata, true));
+            }
+            return list;
+          });
+    }
+  } else if (method == "getBinaryDependencies") {
+    std::vector<std::string> paths;
+    if (Lookup(arguments, "paths") == nullptr ||
+        !GetStringListArgument(arguments, "paths", &paths)) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'paths' must be a list of strings");
+    } else {
+      Run(request_id, priority, method_call,
+          [this, paths](const std::atomic<bool>& cancelled) {
+            // One pool for the whole call, so each distinct name crosses
+            // the channel once however many files refer to it.
+            StringPool pool;
+            std::vector<FlatDependencies> batch(paths.size());
+            thread_pool()->ParallelFor(paths.size(), [&](size_t i) {
+              if (!cancelled.load(std::memory_order_relaxed)) {
+                batch[i] = ReadFlatDependencies(paths[i], &pool);
+              }
+            });
+            ScopedPhaseTimer timer(PerfPhase::kEncode);
+            return ToFlValue(pool, batch);
+          });
+    }
+  } else if (method == "cancelRequest") {
+    bool cancelled = executor_ && executor_->Cancel(request_id);
+    g_autoptr(FlValue) result = fl_value_new_bool(cancelled);
+    RespondSuccess(method_call, result);
+  } else if (method == "configure") {
+    Configure(method_call, arguments);
+  } else if (method == "clearCache") {
+    metadata_cache_.Clear();
+    RespondSuccess(method_call, nullptr);
+  } else if (method == "getCacheStats") {
+    g_autoptr(FlValue) result = ToFlValue(metadata_cache_.stats());
+    RespondSuccess(method_call, result);
+  } else if (method == "getPerfStats") {
+    g_autoptr(FlValue) result = ToFlValue(ReadPerfStats());
+    if (executor_) {
+      FlValue* priorities = fl_value_new_map();
+      for (size_t i = 0; i < kRequestPriorityCount; ++i) {
+        auto request_priority = static_cast<RequestPriority>(i);
+        PhaseStats stats = executor_->latency(request_priority);
+        if (stats.count != 0) {
+          fl_value_set_string_take(priorities,
+                                   RequestPriorityName(request_priority),
+                                   ToFlValue(stats));
+        }
+      }
+      fl_value_set_string_take(result, "priorities", priorities);
+    }
+    if (GetBoolArgument(arguments, "trace", false)) {
+      fl_value_set_string_take(result, "trace",
+                               fl_value_new_string(PerfTraceJson().c_str()));
+    }
+    RespondSuccess(method_call, result);
+  } else if (method == "resetPerfStats") {
+    ResetPerfStats();
+    if (executor_) {
+      executor_->ResetLatency();
+    }
+    RespondSuccess(method_call, nullptr);
+  } else if (method == "scanDirectory") {
+    StartScan(method_call, arguments);
+  } else if (method == "cancelScan" || method == "acknowledgeScanBatch") {
+    int64_t scan_id = GetIntArgument(arguments, "scanId", 0);
+    auto scan_it = scans_.find(scan_id);
+    if (scan_it != scans_.end()) {
+      if (method == "cancelScan") {
+        scan_it->second->Cancel();
+      } else {
+        scan_it->second->Acknowledge();
+      }
+    }
+    g_autoptr(FlValue) result = fl_value_new_bool(scan_it != scans_.end());
+    RespondSuccess(method_call, result);
+  } else if (method == "watch") {
+    StartWatch(method_call, arguments);
+  } else if (method == "unwatch") {
+    int64_t watch_id = GetIntArgument(arguments, "watchId", 0);
+    auto watch_it = watches_.find(watch_id);
+    bool found = watch_it != watches_.end();
+    if (found) {
+      StopWatch(std::move(watch_it->second));
+      watches_.erase(watch_it);
+    }
+    g_autoptr(FlValue) result = fl_value_new_bool(found);
+    RespondSuccess(method_call, result);
+  } else {
+    g_autoptr(FlMethodResponse) response =
+        fl_method_not_implemented_response_new();
+    Respond(method_call, response);
+  }
+}
+
+void MethodHandler::Configure(FlMethodCall* method_call, FlValue* arguments) {
+  FlValue* async_execution = Lookup(arguments, "asyncExecution");
+  if (async_execution != nullptr) {
+    if (fl_value_get_type(async_execution) != FL_VALUE_TYPE_BOOL) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'asyncExecution' must be a bool");
+      return;
+    }
+    async_execution_ = fl_value_get_bool(async_execution);
+  }
+  if (Lookup(arguments, "cacheBudgetBytes") != nullptr) {
+    int64_t budget = GetIntArgument(arguments, "cacheBudgetBytes", -1);
+    if (budget < 0) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'cacheBudgetBytes' must be a non-negative int");
+      return;
+    }
+    metadata_cache_.SetBudget(static_cast<size_t>(budget));
+  }
+  if (Lookup(arguments, "ioByteBudget") != nullptr) {
+    int64_t io_budget = GetIntArgument(arguments, "ioByteBudget", -1);
+    if (io_budget < 0) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'ioByteBudget' must be a non-negative int");
+      return;
+    }
+    io_byte_budget_ = static_cast<uint64_t>(io_budget);
+  }
+  if (Lookup(arguments, "ioDeadlineMs") != nullptr) {
+    int64_t io_deadline = GetIntArgument(arguments, "ioDeadlineMs", -1);
+    if (io_deadline < 0) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'ioDeadlineMs' must be a non-negative int");
+      return;
+    }
+    io_deadline_ms_ = io_deadline;
+  }
+  // Swapped in last, once every other argument has been applied.
+  bool replace_index = Lookup(arguments, "indexPath") != nullptr;
+  std::string index_path;
+  if (replace_index && !GetStringArgument(arguments, "indexPath", &index_path)) {
+    RespondError(method_call, "INVALID_ARGUMENT",
+                 "Argument 'indexPath' must be a string");
+    return;
+  }
+  for (size_t i = 0; i < kRequestPriorityCount; ++i) {
+    auto request_priority = static_cast<RequestPriority>(i);
+    std::string key =
+        std::string(RequestPriorityName(request_priority)) + "Concurrency";
+    if (Lookup(arguments, key.c_str()) != nullptr) {
+      int64_t limit = GetIntArgument(arguments, key.c_str(), -1);
+      if (limit < 0) {
+        RespondError(method_call, "INVALID_ARGUMENT",
+                     "Argument '" + key + "' must be a non-negative int");
+        return;
+      }
+      executor()->SetConcurrencyLimit(request_priority,
+                                      static_cast<size_t>(limit));
+    }
+  }
+  if (Lookup(arguments, "priorityAgingMs") != nullptr) {
+    int64_t aging_ms = GetIntArgument(arguments, "priorityAgingMs", -1);
+    if (aging_ms < 0) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'priorityAgingMs' must be a non-negative int");
+      return;
+    }
+    executor()->SetAgingInterval(std::chrono::milliseconds(aging_ms));
+  }
+  FlValue* perf_stats = Lookup(arguments, "perfStats");
+  if (perf_stats != nullptr) {
+    if (fl_value_get_type(perf_stats) != FL_VALUE_TYPE_BOOL) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'perfStats' must be a bool");
+      return;
+    }
+    SetPerfStatsEnabled(fl_value_get_bool(perf_stats));
+  }
+  FlValue* perf_trace = Lookup(arguments, "perfTrace");
+  if (perf_trace != nullptr) {
+    if (fl_value_get_type(perf_trace) != FL_VALUE_TYPE_BOOL) {
+      RespondError(method_call, "INVALID_ARGUMENT",
+                   "Argument 'perfTrace' must be a bool");
+      return;
+    }
+    SetPerfTraceEnabled(fl_value_get_bool(perf_trace));
+  }
+  if (replace_index) {
+    ReplaceIndex(method_call, index_path);
+    return;
+  }
+  g_autoptr(FlValue) result = fl_value_new_bool(async_execution_);
+  RespondSuccess(method_call, result);
+}
+
+void MethodHandler::ReplaceIndex(FlMethodCall* method_call,
+                                 const std::string& index_path) {
+  auto opened = std::make_shared<bool>(false);
+  auto open = [this, index_path, opened] {
+    std::shared_ptr<MetadataIndex> index;
+    if (!index_path.empty()) {
+      index = std::make_shared<MetadataIndex>();
+      if (!index->Open(index_path, thread_pool())) {
+        return;
+      }
+    }
+    // Work still holding the previous index keeps it open until it ends;
+    // otherwise it is closed here.
+    metadata_cache_.SetIndex(std::move(index));
+    *opened = true;
+  };
+  std::shared_ptr<FlMethodCall> call(
+      FL_METHOD_CALL(g_object_ref(method_call)), &g_object_unref);
+  auto respond = [this, index_path, opened, call] {
+    if (*opened) {
+      g_autoptr(FlValue) result = fl_value_new_bool(async_execution_);
+      RespondSuccess(call.get(), result);
+    } else {
+      RespondError(call.get(), "INDEX_OPEN_FAILED",
+                   "Could not open the metadata index at '" + index_path + "'");
+    }
+  };
+  if (!async_execution_) {
+    open();
+    respond();
+    return;
+  }
+  AsyncRequest request;
+  request.work = [open](const std::atomic<bool>&) { open(); };
+  request.complete = respond;
+  request.cancelled = [call] {
+    RespondError(call.get(), "CANCELLED", "The request was cancelled");
+  };
+  request.priority = RequestPriority::kInteractive;
+  executor()->Submit(AsyncExecutor::kNoRequestId, std::move(request));
+}
+
+AsyncExecutor* MethodHandler::executor() {
+  if (!executor_) {
+    executor_ = std::make_unique<AsyncExecutor>(thread_pool(), dispatcher_.get());
+  }
+  return executor_.get();
+}
+
+void MethodHandler::Run(int64_t request_id, RequestPriority priority,
+                        FlMethodCall* method_call, Work work) {
+  if (!async_execution_) {
+    std::atomic<bool> never_cancelled{false};
+    FlValuePtr value;
+    {
+      ScopedPhaseTimer timer(PerfPhase::kMethodCall);
+      value = TakeValue(work(never_cancelled));
+    }
+    RespondSuccess(method_call, value.get());
+    return;
+  }
+  // The method call is only responded to on the platform thread, from one of
+  // the completion callbacks below.
+  std::shared_ptr<FlMethodCall> call(
+      FL_METHOD_CALL(g_object_ref(method_call)), &g_object_unref);
+  auto value = std::make_shared<FlValuePtr>();
+  AsyncRequest request;
+  request.work = [work = std::move(work), value](
+                     const std::atomic<bool>& cancelled) {
+    ScopedPhaseTimer timer(PerfPhase::kMethodCall);
+    *value = TakeValue(work(cancelled));
+  };
+  request.complete = [call, value] { RespondSuccess(call.get(), value->get()); };
+  request.cancelled = [call] {
+    RespondError(call.get(), "CANCELLED", "The request was cancelled");
+  };
+  request.priority = priority;
+  executor()->Submit(request_id, std::move(request));
+}
+
+void MethodHandler::StartScan(FlMethodCall* method_call, FlValue* arguments) {
+  std::string root;
+  int64_t scan_id = GetIntArgument(arguments, "scanId", 0);
+  ScanOptions options;
+  std::vector<std::string> fields;
+  if (Lookup(arguments, "root") == nullptr ||
+      !GetStringArgument(arguments, "root", &root)) {
+    RespondError(method_call, "INVALID_ARGUMENT",
+                 "Argument 'root' must be a string");
+    return;
+  }
+  if (scan_id <= 0 || scans_.count(scan_id) != 0) {
+    RespondError(method_call, "INVALID_ARGUMENT",
+                 "Argument 'scanId' must be a new positive int");
+    return;
+  }
+  if (!GetStringListArgument(arguments, "extensions", &options.extensions) ||
+      !GetStringListArgument(arguments, "fields", &fields)) {
+    RespondError(method_call, "INVALID_ARGUMENT",
+                 "Arguments 'extensions' and 'fields' must be lists of strings");
+    return;
+  }
+
+  NormalizeExtensions(&options.extensions);
+  options.max_depth = static_cast<int>(GetIntArgument(arguments, "maxDepth", -1));
+  options.follow_links = GetBoolArgument(arguments, "followLinks", false);
+  MetadataRequest request =
+      fields.empty() ? MetadataRequest::Standard() : MetadataRequest::Only(fields);
+  bool use_cache = GetBoolArgument(arguments, "useCache", true);
+
+  // Batches go through |dispatcher_| whether or not requests run
+  // asynchronously, so scans work either way.
+  auto scan = std::make_unique<DirectoryScan>(
+      thread_pool(), options,
+      [this, request, use_cache](const std::string& path, BinaryFormat) {
+        return GetBinaryFileMetadata(path, request, use_cache);
+      },
+      [this, scan_id](std::vector<ScanEntry> batch, const ScanSummary* summary) {
+        auto shared_batch =
+            std::make_shared<std::vector<ScanEntry>>(std::move(batch));
+        std::shared_ptr<ScanSummary> shared_summary;
+        if (summary) {
+          shared_summary = std::make_shared<ScanSummary>(*summary);
+        }
+        dispatcher_->Post([this, scan_id, shared_batch, shared_summary] {
+          SendScanBatch(scan_id, *shared_batch, shared_summary.get());
+        });
+      });
+  DirectoryScan* scan_pointer = scan.get();
+  scans_[scan_id] = std::move(scan);
+  scan_pointer->Start(root);
+  RespondSuccess(method_call, nullptr);
+}
+
+void MethodHandler::SendScanBatch(int64_t scan_id,
+                                  const std::vector<ScanEntry>& batch,
+                                  const ScanSummary* summary) {
+  if (scan_listening_) {
+    g_autoptr(FlValue) entries = fl_value_new_list();
+    for (const ScanEntry& entry : batch) {
+      FlValue* map = ToFlValue(entry.metadata, true);
+      fl_value_set_string_take(map, "path",
+                               fl_value_new_string(entry.path.c_str()));
+      fl_value_set_string_take(
+          map, "format", fl_value_new_string(BinaryFormatName(entry.format)));
+      fl_value_append_take(entries, map);
+    }
+    g_autoptr(FlValue) event = fl_value_new_map();
+    fl_value_set_string_take(event, "scanId", fl_value_new_int(scan_id));
+    fl_value_set_string(event, "entries", entries);
+    fl_value_set_string_take(event, "done", fl_value_new_bool(summary != nullptr));
+    if (summary) {
+      fl_value_set_string_take(
+          event, "directories",
+          fl_value_new_int(static_cast<int64_t>(summary->directories)));
+      fl_value_set_string_take(
+          event, "files", fl_value_new_int(static_cast<int64_t>(summary->files)));
+      fl_value_set_string_take(
+          event, "binaries",
+          fl_value_new_int(static_cast<int64_t>(summary->binaries)));
+      fl_value_set_string_take(
+          event, "errors", fl_value_new_int(static_cast<int64_t>(summary->errors)));
+      fl_value_set_string_take(event, "cancelled",
+                               fl_value_new_bool(summary->cancelled));
+      fl_value_set_string_take(event, "rootFailed",
+                               fl_value_new_bool(summary->root_failed));
+    }
+    fl_event_channel_send(scan_channel_, event, nullptr, nullptr);
+  }
+  if (summary) {
+    // The scan's last task is returning; this waits for it.
+    scans_.erase(scan_id);
+  }
+}
+
+void MethodHandler::StartWatch(FlMethodCall* method_call, FlValue* arguments) {
+  int64_t watch_id = GetIntArgument(arguments, "watchId", 0);
+  std::vector<std::string> paths;
+  WatchOptions options;
+  std::vector<std::string> fields;
+  if (watch_id <= 0 || watches_.count(watch_id) != 0) {
+    RespondError(method_call, "INVALID_ARGUMENT",
+                 "Argument 'watchId' must be a new positive int");
+    return;
+  }
+  if (!GetStringListArgument(arguments, "paths", &paths) || paths.empty()) {
+    RespondError(method_call, "INVALID_ARGUMENT",
+                 "Argument 'paths' must be a non-empty list of strings");
+    return;
+  }
+  if (!GetStringListArgument(arguments, "extensions", &options.extensions) ||
+      !GetStringListArgument(arguments, "fields", &fields)) {
+    RespondError(method_call, "INVALID_ARGUMENT",
+                 "Arguments 'extensions' and 'fields' must be lists of strings");
+    return;
+  }
+
+  NormalizeExtensions(&options.extensions);
+  options.recursive = GetBoolArgument(arguments, "recursive", true);
+  int64_t settle_ms = GetIntArgument(arguments, "settleMs", -1);
+  if (settle_ms >= 0) {
+    options.settle_delay = std::chrono::milliseconds(settle_ms);
+  }
+  MetadataRequest request =
+      fields.empty() ? MetadataRequest::Standard() : MetadataRequest::Only(fields);
+  bool use_cache = GetBoolArgument(arguments, "useCache", true);
+
+  auto watcher = std::make_unique<FileWatcher>(
+      options,
+      [this, request, use_cache](const std::string& path, BinaryFormat) {
+        if (!use_cache) {
+          return LoadChangedFileMetadata(path, request);
+        }
+        return metadata_cache_.Get(
+            path, request,
+            [this](const std::string& changed_path,
+                   const MetadataRequest& path_request) {
+              return LoadChangedFileMetadata(changed_path, path_request);
+            });
+      },
+      [this, watch_id](std::vector<WatchEvent> events) {
+        auto shared_events =
+            std::make_shared<std::vector<WatchEvent>>(std::move(events));
+        dispatcher_->Post([this, watch_id, shared_events] {
+          SendWatchEvents(watch_id, *shared_events);
+        });
+      });
+  std::vector<std::string> failed;
+  if (!watcher->Start(paths, &failed)) {
+    RespondError(method_call, "WATCH_FAILED", "None of the paths can be watched");
+    return;
+  }
+  watches_[watch_id] = std::move(watcher);
+
+  g_autoptr(FlValue) result = fl_value_new_list();
+  for (const std::string& path : failed) {
+    fl_value_append_take(result, fl_value_new_string(path.c_str()));
+  }
+  RespondSuccess(method_call, result);
+}
+
+void MethodHandler::SendWatchEvents(int64_t watch_id,
+                                    const std::vector<WatchEvent>& events) {
+  // Changes posted before an unwatch are dropped.
+  if (!watch_listening_ || watches_.count(watch_id) == 0) {
+    return;
+  }
+  g_autoptr(FlValue) changes = fl_value_new_list();
+  for (const WatchEvent& event : events) {
+    bool read = event.change == WatchChange::kAdded ||
+                event.change == WatchChange::kModified;
+    FlValue* change =
+        read ? ToFlValue(event.metadata, true) : fl_value_new_map();
+    fl_value_set_string_take(change, "path",
+                             fl_value_new_string(event.path.c_str()));
+    fl_value_set_string_take(change, "change",
+                             fl_value_new_string(WatchChangeName(event.change)));
+    if (event.format != BinaryFormat::kUnknown) {
+      fl_value_set_string_take(
+          change, "format", fl_value_new_string(BinaryFormatName(event.format)));
+    }
+    fl_value_append_take(changes, change);
+  }
+  g_autoptr(FlValue) message = fl_value_new_map();
+  fl_value_set_string_take(message, "watchId", fl_value_new_int(watch_id));
+  fl_value_set_string(message, "changes", changes);
+  fl_event_channel_send(watch_channel_, message, nullptr, nullptr);
+}
+
+void MethodHandler::StopWatch(std::unique_ptr<FileWatcher> watcher) {
+  watcher->Stop();
+  AsyncRequest request;
+  request.work = [watcher = std::shared_ptr<FileWatcher>(std::move(watcher))](
+                     const std::atomic<bool>&) mutable {
+    // Joins the watcher thread.
+    watcher.reset();
+  };
+  request.priority = RequestPriority::kBulk;
+  executor()->Submit(AsyncExecutor::kNoRequestId, std::move(request));
+}
+
+ThreadPool* MethodHandler::thread_pool() {
+  if (!thread_pool_) {
+    thread_pool_ = std::make_unique<ThreadPool>(ThreadPool::DefaultThreadCount());
+  }
+  return thread_pool_.get();
+}
+
+std::string MethodHandler::GetBinaryFileVersion(const std::string& file_path,
+                                                bool use_cache) {
+  BinaryMetadata metadata = GetBinaryFileMetadata(
+      file_path, MetadataRequest::Only({kVersionKey}), use_cache);
+  auto version_it = metadata.fields.find(kVersionKey);
+  return version_it != metadata.fields.end() ? version_it->second : "";
+}
+
+BinaryMetadata MethodHandler::GetBinaryFileMetadata(
+    const std::string& file_path, const MetadataRequest& request,
+    bool use_cache) {
+  if (!use_cache) {
+    return LoadBinaryFileMetadata(file_path, request);
+  }
+  return metadata_cache_.Get(
+      file_path, request,
+      [this](const std::string& path, const MetadataRequest& path_request) {
+        return LoadBinaryFileMetadata(path, path_request);
+      });
+}
+
+BinaryMetadata MethodHandler::LoadBinaryFileMetadata(
+    const std::string& file_path, const MetadataRequest& request) {
+  ReadBudget budget;
+  budget.max_bytes = io_byte_budget_;
+  budget.timeout = std::chrono::milliseconds(io_deadline_ms_.load());
+  if (budget.max_bytes == 0 && budget.timeout.count() == 0) {
+    return ReadBinaryMetadata(file_path, request);
+  }
+  return ReadBinaryMetadataBounded(file_path, request, budget);
+}
+
+BinaryMetadata MethodHandler::LoadChangedFileMetadata(
+    const std::string& file_path, const MetadataRequest& request) {
+  ReadBudget budget;
+  budget.max_bytes = io_byte_budget_;
+  budget.timeout = std::chrono::milliseconds(io_deadline_ms_.load());
+  return ReadBinaryMetadataUnmapped(file_path, request, budget);
+}
+
+void MethodHandler::LoadBinaryFileMetadataBatch(
+    const std::vector<std::string>& paths, const std::vector<size_t>& indices,
+    const MetadataRequest& request, const std::atomic<bool>& cancelled,
+    std::vector<BinaryMetadata>* results) {
+  if (io_byte_budget_ != 0 || io_deadline_ms_ != 0) {
+    thread_pool()->ParallelFor(indices.size(), [&](size_t j) {
+      if (!cancelled.load(std::memory_order_relaxed)) {
+        (*results)[indices[j]] =
+            LoadBinaryFileMetadata(paths[indices[j]], request);
+      }
+    });
+    return;
+  }
+  std::vector<std::string> miss_paths;
+  miss_paths.reserve(indices.size());
+  for (size_t i : indices) {
+    miss_paths.push_back(paths[i]);
+  }
+  std::unique_ptr<FileHeadReader> reader = AcquireHeadReader();
+  reader->Read(
+      miss_paths,
+      [&](size_t j, FileHead* head) {
+        (*results)[indices[j]] = ReadBinaryMetadata(head, request);
+      },
+      &cancelled);
+  ReleaseHeadReader(std::move(reader));
+}
+
+std::unique_ptr<FileHeadReader> MethodHandler::AcquireHeadReader() {
+  {
+    std::lock_guard<std::mutex> lock(head_readers_mutex_);
+    if (!head_readers_.empty()) {
+      std::unique_ptr<FileHeadReader> reader = std::move(head_readers_.back());
+      head_readers_.pop_back();
+      return reader;
+    }
+  }
+  return std::make_unique<FileHeadReader>(thread_pool());
+}
+
+void MethodHandler::ReleaseHeadReader(std::unique_ptr<FileHeadReader> reader) {
+  // Enough for the few batches that run side by side.
+  constexpr size_t kMaxIdleHeadReaders = 4;
+  std::lock_guard<std::mutex> lock(head_readers_mutex_);
+  if (head_readers_.size() < kMaxIdleHeadReaders) {
+    head_readers_.push_back(std::move(reader));
+  }
+}
+
+}  // namespace flutter_bin
+
+struct _FlutterBinPlugin {
+  GObject parent_instance;
+  flutter_bin::MethodHandler* handler;
+};
+
+G_DEFINE_TYPE(FlutterBinPlugin, flutter_bin_plugin, g_object_get_type())
+
+static void flutter_bin_plugin_dispose(GObject* object) {
+  FlutterBinPlugin* self = FLUTTER_BIN_PLUGIN(object);
+  delete self->handler;
+  self->handler = nullptr;
+
+  G_OBJECT_CLASS(flutter_bin_plugin_parent_class)->dispose(object);
+}
+
+static void flutter_bin_plugin_class_init(FlutterBinPluginClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = flutter_bin_plugin_dispose;
+}
+
+static void flutter_bin_plugin_init(FlutterBinPlugin* self) {
+  self->handler = new flutter_bin::MethodHandler();
+}
+
+static void method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  FlutterBinPlugin* plugin = FLUTTER_BIN_PLUGIN(user_data);
+  plugin->handler->HandleMethodCall(method_call);
+}
+
+void flutter_bin_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
+  FlutterBinPlugin* plugin = FLUTTER_BIN_PLUGIN(
+      g_object_new(flutter_bin_plugin_get_type(), nullptr));
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  g_autoptr(FlMethodChannel) channel =
+      fl_method_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                            "flutter_bin", FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(channel, method_call_cb,
+                                            g_object_ref(plugin),
+                                            g_object_unref);
+
+  g_autoptr(FlEventChannel) scan_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "flutter_bin/scan", FL_METHOD_CODEC(codec));
+  plugin->handler->SetScanChannel(scan_channel);
+
+  g_autoptr(FlEventChannel) watch_channel =
+      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar),
+                           "flutter_bin/watch", FL_METHOD_CODEC(codec));
+  plugin->handler->SetWatchChannel(watch_channel);
+
+  g_object_unref(plugin);
+}
+
+int64_t FlutterBinReadMetadata(const char* utf8_path,
+                               const char* const* fields, size_t field_count,
+                               uint8_t* buffer, size_t capacity) {
+  return flutter_bin::ReadFlatMetadata(utf8_path, fields, field_count, buffer,
+                                       capacity);
+}
@@ -0,0 +1,67 @@
+#include "glib_dispatcher.h"
+
+#include <utility>
+
+namespace flutter_bin {
+
+namespace {
+
+void DeleteQueueReference(gpointer data) {
+  delete static_cast<std::shared_ptr<void>*>(data);
+}
+
+}  // namespace
+
+GlibDispatcher::GlibDispatcher()
+    : context_(g_main_context_ref_thread_default()),
+      queue_(std::make_shared<Queue>()) {}
+
+GlibDispatcher::~GlibDispatcher() {
+  {
+    std::lock_guard<std::mutex> lock(queue_->mutex);
+    queue_->closed = true;
+    queue_->tasks.clear();
+  }
+  g_main_context_unref(context_);
+}
+
+void GlibDispatcher::Post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(queue_->mutex);
+    if (queue_->closed) {
+      return;
+    }
+    queue_->tasks.push_back(std::move(task));
+    if (queue_->wake_pending) {
+      return;
+    }
+    queue_->wake_pending = true;
+  }
+  // An idle source rather than g_main_context_invoke(), which would run the
+  // tasks re-entrantly when called on the platform thread.
+  GSource* source = g_idle_source_new();
+  g_source_set_priority(source, G_PRIORITY_DEFAULT);
+  g_source_set_callback(source, &GlibDispatcher::RunTasks,
+                        new std::shared_ptr<void>(queue_),
+                        &DeleteQueueReference);
+  g_source_attach(source, context_);
+  g_source_unref(source);
+}
+
+// static
+gboolean GlibDispatcher::RunTasks(gpointer data) {
+  Queue* queue =
+      static_cast<Queue*>(static_cast<std::shared_ptr<void>*>(data)->get());
+  std::deque<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    tasks.swap(queue->tasks);
+    queue->wake_pending = false;
+  }
+  for (auto& task : tasks) {
+    task();
+  }
+  return G_SOURCE_REMOVE;
+}
+
+}  // namespace flutter_bin
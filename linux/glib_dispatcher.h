@@ -0,0 +1,53 @@
+#ifndef FLUTTER_PLUGIN_GLIB_DISPATCHER_H_
+#define FLUTTER_PLUGIN_GLIB_DISPATCHER_H_
+
+#include <glib.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "async_executor.h"
+
+namespace flutter_bin {
+
+// Runs tasks on the thread that created it through an idle source on that
+// thread's GMainContext, so they are picked up by the runner's main loop.
+//
+// Must be created and destroyed on the platform thread.
+class GlibDispatcher : public Dispatcher {
+ public:
+  GlibDispatcher();
+
+  // Drops tasks that have not run yet.
+  ~GlibDispatcher() override;
+
+  // Disallow copy and assign.
+  GlibDispatcher(const GlibDispatcher&) = delete;
+  GlibDispatcher& operator=(const GlibDispatcher&) = delete;
+
+  // Safe to call from any thread.
+  void Post(std::function<void()> task) override;
+
+ private:
+  // Shared with pending idle sources, which may fire after the dispatcher
+  // is gone.
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+    // True while an idle source is attached; guarded by mutex.
+    bool wake_pending = false;
+    bool closed = false;  // Guarded by mutex.
+  };
+
+  // Runs every queued task on the platform thread.
+  static gboolean RunTasks(gpointer data);
+
+  GMainContext* context_ = nullptr;
+  std::shared_ptr<Queue> queue_;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_PLUGIN_GLIB_DISPATCHER_H_
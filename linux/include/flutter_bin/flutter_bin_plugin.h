@@ -0,0 +1,39 @@
+#ifndef FLUTTER_PLUGIN_FLUTTER_BIN_PLUGIN_H_
+#define FLUTTER_PLUGIN_FLUTTER_BIN_PLUGIN_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <stddef.h>
+#include <stdint.h>
+
+G_BEGIN_DECLS
+
+#ifdef FLUTTER_PLUGIN_IMPL
+#define FLUTTER_PLUGIN_EXPORT __attribute__((visibility("default")))
+#else
+#define FLUTTER_PLUGIN_EXPORT
+#endif
+
+typedef struct _FlutterBinPlugin FlutterBinPlugin;
+typedef struct {
+  GObjectClass parent_class;
+} FlutterBinPluginClass;
+
+FLUTTER_PLUGIN_EXPORT GType flutter_bin_plugin_get_type();
+
+FLUTTER_PLUGIN_EXPORT void flutter_bin_plugin_register_with_registrar(
+    FlPluginRegistrar* registrar);
+
+// Reads the binary at |utf8_path| synchronously, for dart:ffi callers on
+// any thread or isolate. The result is written to |buffer| as a flat
+// header, offset table and string table (see src/flat_metadata.h). With
+// |field_count| zero the standard fields are read, otherwise exactly
+// |fields|. Returns the size of the result; when that is larger than
+// |capacity| nothing was written and the call can be repeated with a
+// bigger buffer. Returns -1 for a null path or field.
+FLUTTER_PLUGIN_EXPORT int64_t FlutterBinReadMetadata(
+    const char* utf8_path, const char* const* fields, size_t field_count,
+    uint8_t* buffer, size_t capacity);
+
+G_END_DECLS
+
+#endif  // FLUTTER_PLUGIN_FLUTTER_BIN_PLUGIN_H_
@@ -0,0 +1,75 @@
+#include "FlutterBinCore.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../src/binary_metadata.h"
+#include "../../src/flat_metadata.h"
+
+struct FlutterBinMetadata {
+  flutter_bin::BinaryMetadata result;
+  // Fields in key order, pointing into |result|.
+  std::vector<const std::pair<const std::string, std::string>*> fields;
+};
+
+namespace {
+
+flutter_bin::MetadataRequest MakeRequest(const char* const* keys,
+                                         size_t key_count, int only) {
+  std::vector<std::string> names(keys, keys + key_count);
+  return only ? flutter_bin::MetadataRequest::Only(names)
+              : flutter_bin::MetadataRequest::Standard(names);
+}
+
+FlutterBinMetadata* Wrap(flutter_bin::BinaryMetadata result) {
+  auto* metadata = new FlutterBinMetadata();
+  metadata->result = std::move(result);
+  for (const auto& field : metadata->result.fields) {
+    metadata->fields.push_back(&field);
+  }
+  return metadata;
+}
+
+}  // namespace
+
+FlutterBinMetadata* FlutterBinMetadataRead(const char* utf8_path,
+                                           const char* const* keys,
+                                           size_t key_count, int only) {
+  return Wrap(flutter_bin::ReadBinaryMetadata(
+      utf8_path, MakeRequest(keys, key_count, only)));
+}
+
+FlutterBinMetadata* FlutterBinInfoPlistRead(const char* utf8_plist_path,
+                                            const char* const* keys,
+                                            size_t key_count, int only) {
+  return Wrap(flutter_bin::ReadInfoPlistFile(
+      utf8_plist_path, MakeRequest(keys, key_count, only)));
+}
+
+const char* FlutterBinMetadataError(const FlutterBinMetadata* metadata) {
+  return flutter_bin::MetadataErrorCode(metadata->result.error);
+}
+
+size_t FlutterBinMetadataFieldCount(const FlutterBinMetadata* metadata) {
+  return metadata->fields.size();
+}
+
+const char* FlutterBinMetadataFieldKey(const FlutterBinMetadata* metadata,
+                                       size_t index) {
+  return metadata->fields[index]->first.c_str();
+}
+
+const char* FlutterBinMetadataFieldValue(const FlutterBinMetadata* metadata,
+                                         size_t index) {
+  return metadata->fields[index]->second.c_str();
+}
+
+void FlutterBinMetadataFree(FlutterBinMetadata* metadata) { delete metadata; }
+
+int64_t FlutterBinReadMetadata(const char* utf8_path,
+                               const char* const* fields, size_t field_count,
+                               uint8_t* buffer, size_t capacity) {
+  return flutter_bin::ReadFlatMetadata(utf8_path, fields, field_count, buffer,
+                                       capacity);
+}
@@ -0,0 +1,51 @@
+#ifndef FLUTTER_BIN_MACOS_FLUTTER_BIN_CORE_H_
+#define FLUTTER_BIN_MACOS_FLUTTER_BIN_CORE_H_
+
+// C entry points into the shared C++ core (src/) for the Swift plugin.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FlutterBinMetadata FlutterBinMetadata;
+
+// Reads the binary at |utf8_path|. With |only| set exactly |keys| are read,
+// otherwise the standard fields plus |keys| as custom keys. Never returns
+// null; release the result with FlutterBinMetadataFree().
+FlutterBinMetadata* FlutterBinMetadataRead(const char* utf8_path,
+                                           const char* const* keys,
+                                           size_t key_count, int only);
+
+// Same as FlutterBinMetadataRead() for the Info.plist of an app bundle,
+// binary or XML, at |utf8_plist_path|.
+FlutterBinMetadata* FlutterBinInfoPlistRead(const char* utf8_plist_path,
+                                            const char* const* keys,
+                                            size_t key_count, int only);
+
+// The channel error code, e.g. "FILE_NOT_FOUND", or "" on success.
+const char* FlutterBinMetadataError(const FlutterBinMetadata* metadata);
+
+size_t FlutterBinMetadataFieldCount(const FlutterBinMetadata* metadata);
+const char* FlutterBinMetadataFieldKey(const FlutterBinMetadata* metadata,
+                                       size_t index);
+const char* FlutterBinMetadataFieldValue(const FlutterBinMetadata* metadata,
+                                         size_t index);
+
+void FlutterBinMetadataFree(FlutterBinMetadata* metadata);
+
+// The dart:ffi entry point shared with the Windows and Linux plugins: reads
+// |utf8_path| into |buffer| as a flat result (see src/flat_metadata.h) and
+// returns its size, which exceeds |capacity| when nothing was written.
+// Kept visible and unstripped because only Dart refers to it.
+__attribute__((visibility("default"), used)) int64_t FlutterBinReadMetadata(
+    const char* utf8_path, const char* const* fields, size_t field_count,
+    uint8_t* buffer, size_t capacity);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // FLUTTER_BIN_MACOS_FLUTTER_BIN_CORE_H_
@@ -9,6 +9,59 @@ public class FlutterBinPlugin: NSObject, FlutterPlugin {
   }
 
   public func handle(_ call: FlutterMethodCall, result: @escaping FlutterResult) {
+    // Calls complete synchronously here, so there is never anything to cancel.
+    if call.method == "cancelRequest" {
+      result(false)
+      return
+    }
+    if call.method == "configure" {
+      result(false)
+      return
+    }
+    // Nothing is cached on macOS yet.
+    if call.method == "clearCache" {
+      result(nil)
+      return
+    }
+    if call.method == "getCacheStats" {
+      result([String: Int]())
+      return
+    }
+    if call.method == "scanDirectory" {
+      result(FlutterError(code: "UNAVAILABLE", message: "Directory scans are not supported on macOS", details: nil))
+      return
+    }
+    if call.method == "cancelScan" || call.method == "acknowledgeScanBatch" {
+      result(false)
+      return
+    }
+    // Reported like scans, as an error on the watch stream.
+    if call.method == "watch" {
+      result(FlutterError(code: "UNAVAILABLE", message: "Watches are not supported on macOS", details: nil))
+      return
+    }
+    if call.method == "unwatch" {
+      result(false)
+      return
+    }
+
+    if call.method == "getBinaryFileMetadataBatch" {
+      guard let args = call.arguments as? [String: Any],
+            let paths = args["paths"] as? [String] else {
+        result(FlutterError(code: "INVALID_ARGUMENT", message: "Missing or invalid 'paths'", details: nil))
+        return
+      }
+      result(getBinaryFileMetadataBatch(paths: paths, fields: args["fields"] as? [String]))
+      return
+    }
+
+    // Everything else (perf stats, dependencies) only exists on Windows and
+    // Linux, and must not be mistaken for a single-file call below.
+    if call.method != "getBinaryFileVersion" && call.method != "getBinaryFileMetadata" {
+      result(FlutterMethodNotImplemented)
+      return
+    }
+
     guard let args = call.arguments as? [String: Any],
           let filePath = args["filePath"] as? String else{
         result(FlutterError(code: "INVALID_ARGUMENT", message: "Missing or invalid 'filePath'", details: nil))
@@ -19,41 +72,91 @@ public class FlutterBinPlugin: NSObject, FlutterPlugin {
     case "getBinaryFileVersion":
       result(getBinaryFileVersion(filePath: filePath))
     case "getBinaryFileMetadata":
-      result(getBinaryFileMetadata(filePath: filePath))
+      let customKeys = args["customKeys"] as? [String] ?? []
+      let hashes = args["hashes"] as? [String] ?? []
+      let signature = args["signature"] as? Bool ?? false
+      let fieldMask = args["fieldMask"] as? Int
+      if let mask = fieldMask, mask < 0 || mask >= 1 << FlutterBinPlugin.fieldMaskKeys.count {
+        result(FlutterError(code: "INVALID_ARGUMENT", message: "Argument 'fieldMask' must be a combination of metadata field bits", details: nil))
+        return
+      }
+      result(getBinaryFileMetadata(filePath: filePath, customKeys: customKeys, hashes: hashes, signature: signature, fieldMask: fieldMask))
     default:
       result(FlutterMethodNotImplemented)
     }
   }
 
   private func getBinaryFileVersion(filePath: String) -> String? {
-    let infoPlistPath = resolveInfoPlistPath(from: filePath)
-    guard let infoPlist = NSDictionary(contentsOfFile: infoPlistPath),
-          let version = infoPlist["CFBundleShortVersionString"] as? String else {
-      return nil
-    }
-    return version
+    return readCoreMetadata(filePath: filePath, keys: ["version"], only: true)["version"]
   }
 
-  private func getBinaryFileMetadata(filePath: String) -> [String: String] {
-    var metadata: [String: String] = [:]
+  private static let standardKeys = [
+    "version", "productName", "fileDescription", "legalCopyright", "originalFilename", "companyName",
+  ]
 
-    let infoPlistPath = resolveInfoPlistPath(from: filePath)
-    guard let infoPlist = NSDictionary(contentsOfFile: infoPlistPath) else {
-      return metadata
+  /// The field named by each bit of a "fieldMask", lowest bit first.
+  private static let fieldMaskKeys = standardKeys + [
+    "sha256", "blake3", "authenticode", "signerName",
+  ]
+
+  private func getBinaryFileMetadata(filePath: String, customKeys: [String], hashes: [String], signature: Bool, fieldMask: Int?) -> [String: String] {
+    // Hash and signer names only select their fields in an explicit field list.
+    let extraKeys = hashes + (signature ? ["signerName"] : [])
+    if let mask = fieldMask {
+      // Only the masked fields are decoded.
+      let maskKeys = FlutterBinPlugin.fieldMaskKeys.enumerated()
+        .filter { mask & (1 << $0.offset) != 0 }
+        .map { $0.element }
+      let metadata = readCoreMetadata(filePath: filePath, keys: maskKeys + customKeys + extraKeys.filter { !maskKeys.contains($0) }, only: true)
+      return metadata["error"] == nil ? metadata : [:]
     }
+    let metadata = extraKeys.isEmpty
+      ? readCoreMetadata(filePath: filePath, keys: customKeys, only: false)
+      : readCoreMetadata(filePath: filePath, keys: FlutterBinPlugin.standardKeys + customKeys + extraKeys, only: true)
+    return metadata["error"] == nil ? metadata : [:]
+  }
 
-    metadata["version"] = infoPlist["CFBundleShortVersionString"] as? String ?? ""
-    metadata["productName"] = infoPlist["CFBundleName"] as? String ?? ""
-    metadata["fileDescription"] = infoPlist["CFBundleGetInfoString"] as? String ?? ""
-    metadata["legalCopyright"] = infoPlist["NSHumanReadableCopyright"] as? String ?? ""
-    metadata["originalFilename"] = infoPlist["CFBundleExecutable"] as? String ?? ""
-    metadata["companyName"] = "" // Not typically available in macOS
+  /// Reads a PE, ELF or Mach-O file, or the Info.plist of an app bundle,
+  /// through the shared C++ core. Only the requested plist keys are decoded.
+  /// Failures are reported under "error" with the channel error code.
+  private func readCoreMetadata(filePath: String, keys: [String], only: Bool) -> [String: String] {
+    let cKeys = keys.map { strdup($0) }
+    defer { cKeys.forEach { free($0) } }
+    let keyPointers: [UnsafePointer<CChar>?] = cKeys.map { UnsafePointer($0) }
+    let infoPlistPath = resolveInfoPlistPath(from: filePath)
+    let handle = keyPointers.withUnsafeBufferPointer { buffer in
+      infoPlistPath.map { FlutterBinInfoPlistRead($0, buffer.baseAddress, buffer.count, only ? 1 : 0) }
+        ?? FlutterBinMetadataRead(filePath, buffer.baseAddress, buffer.count, only ? 1 : 0)
+    }
+    defer { FlutterBinMetadataFree(handle) }
 
+    var metadata: [String: String] = [:]
+    let error = String(cString: FlutterBinMetadataError(handle))
+    if !error.isEmpty {
+      metadata["error"] = error
+      return metadata
+    }
+    for index in 0..<FlutterBinMetadataFieldCount(handle) {
+      let key = String(cString: FlutterBinMetadataFieldKey(handle, index))
+      metadata[key] = String(cString: FlutterBinMetadataFieldValue(handle, index))
+    }
     return metadata
   }
 
-  /// Resolves the actual Info.plist path based on input path type
-  private func resolveInfoPlistPath(from filePath: String) -> String {
+  /// Reads many files concurrently; results keep the order of `paths`
+  private func getBinaryFileMetadataBatch(paths: [String], fields: [String]?) -> [[String: String]] {
+    var results = [[String: String]](repeating: [:], count: paths.count)
+    results.withUnsafeMutableBufferPointer { buffer in
+      DispatchQueue.concurrentPerform(iterations: paths.count) { index in
+        buffer[index] = fields.map { readCoreMetadata(filePath: paths[index], keys: $0, only: true) }
+          ?? readCoreMetadata(filePath: paths[index], keys: [], only: false)
+      }
+    }
+    return results
+  }
+
+  /// Resolves the Info.plist of an app bundle, or nil for standalone binaries
+  private func resolveInfoPlistPath(from filePath: String) -> String? {
     let fileURL = URL(fileURLWithPath: filePath)
 
     // If it's a .app bundle, go to Contents/Info.plist
@@ -64,7 +167,7 @@ public class FlutterBinPlugin: NSObject, FlutterPlugin {
       return appPath.appendingPathComponent("Contents/Info.plist").path
     }
 
-    // Otherwise try to treat filePath as direct .plist for standalone binaries
-    return filePath + "/Contents/Info.plist"
+    // Standalone binaries carry their Info.plist, if any, in the Mach-O file
+    return nil
   }
 }
@@ -0,0 +1,2 @@
+// Relative import so the shared core in src/ is compiled into this pod.
+#include "../../../src/binary_metadata.cpp"
@@ -0,0 +1,41 @@
+#include "arena.h"
+
+namespace flutter_bin {
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size > 0 ? block_size : kDefaultBlockSize) {}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  uintptr_t cursor = reinterpret_cast<uintptr_t>(cursor_);
+  uintptr_t limit = reinterpret_cast<uintptr_t>(limit_);
+  uintptr_t aligned = (cursor + alignment - 1) & ~(alignment - 1);
+  if (cursor_ == nullptr || aligned < cursor || aligned > limit ||
+      size > limit - aligned) {
+    // Requests larger than a block get a block of their own.
+    if (size > SIZE_MAX - alignment) {
+      return nullptr;
+    }
+    size_t block_size =
+        size + alignment > block_size_ ? size + alignment : block_size_;
+    blocks_.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[block_size]),
+                       block_size});
+    cursor_ = blocks_.back().data.get();
+    limit_ = cursor_ + block_size;
+    cursor = reinterpret_cast<uintptr_t>(cursor_);
+    aligned = (cursor + alignment - 1) & ~(alignment - 1);
+  }
+  cursor_ += (aligned - cursor) + size;
+  bytes_allocated_ += size;
+  return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::Reset() {
+  if (!blocks_.empty()) {
+    blocks_.resize(1);
+    cursor_ = blocks_[0].data.get();
+    limit_ = cursor_ + blocks_[0].size;
+  }
+  bytes_allocated_ = 0;
+}
+
+}  // namespace flutter_bin
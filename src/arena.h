@@ -0,0 +1,76 @@
+#ifndef FLUTTER_BIN_ARENA_H_
+#define FLUTTER_BIN_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace flutter_bin {
+
+// A read-only array allocated from an Arena.
+template <typename T>
+struct ArenaSpan {
+  const T* data = nullptr;
+  size_t size = 0;
+
+  bool empty() const { return size == 0; }
+  const T* begin() const { return data; }
+  const T* end() const { return data + size; }
+  const T& operator[](size_t index) const { return data[index]; }
+};
+
+// A bump allocator for the short-lived, trivially destructible results of
+// one request, freed all at once.
+//
+// Allocations are carved out of blocks of |block_size| bytes (or larger for
+// big requests), so a request costs a handful of heap allocations however
+// many small arrays it produces. Not thread-safe: give each worker its own.
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 16 * 1024;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+
+  // Disallow copy and assign.
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns |size| uninitialized bytes aligned to |alignment|, a power of
+  // two, or null if |size| cannot be allocated.
+  void* Allocate(size_t size, size_t alignment);
+
+  // Returns |count| uninitialized elements, or null if the size overflows.
+  template <typename T>
+  T* AllocateArray(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Arena never runs destructors");
+    if (count > SIZE_MAX / sizeof(T)) {
+      return nullptr;
+    }
+    return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  // Frees everything allocated so far. The first block is kept for reuse.
+  void Reset();
+
+  // Bytes handed out since construction or the last Reset().
+  size_t bytes_allocated() const { return bytes_allocated_; }
+
+ private:
+  struct Block {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+
+  size_t block_size_;
+  std::vector<Block> blocks_;
+  uint8_t* cursor_ = nullptr;
+  uint8_t* limit_ = nullptr;
+  size_t bytes_allocated_ = 0;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_ARENA_H_
@@ -0,0 +1,223 @@
+#include "async_executor.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flutter_bin {
+
+const char* RequestPriorityName(RequestPriority priority) {
+  switch (priority) {
+    case RequestPriority::kInteractive:
+      return "interactive";
+    case RequestPriority::kNormal:
+      return "normal";
+    case RequestPriority::kBulk:
+      return "bulk";
+  }
+  return "";
+}
+
+bool ParseRequestPriority(const std::string& name, RequestPriority* priority) {
+  for (size_t i = 0; i < kRequestPriorityCount; ++i) {
+    if (name == RequestPriorityName(static_cast<RequestPriority>(i))) {
+      *priority = static_cast<RequestPriority>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+AsyncExecutor::AsyncExecutor(ThreadPool* pool, Dispatcher* dispatcher)
+    : pool_(pool),
+      dispatcher_(dispatcher),
+      aging_interval_(kDefaultAgingInterval) {
+  size_t workers = pool->thread_count();
+  limits_[static_cast<size_t>(RequestPriority::kInteractive)] = 0;
+  limits_[static_cast<size_t>(RequestPriority::kNormal)] =
+      std::max<size_t>(workers - 1, 1);
+  limits_[static_cast<size_t>(RequestPriority::kBulk)] =
+      std::max<size_t>(workers / 2, 1);
+}
+
+AsyncExecutor::~AsyncExecutor() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  shutting_down_ = true;
+  for (auto& pair : entries_) {
+    pair.second->cancelled = true;
+  }
+  // Queued requests never start; only the running ones are waited for.
+  for (auto& queue : queues_) {
+    queue.clear();
+  }
+  idle_.wait(lock, [this] { return running_ == 0; });
+}
+
+void AsyncExecutor::Submit(int64_t request_id, AsyncRequest request) {
+  auto entry = std::make_shared<Entry>();
+  entry->request = std::move(request);
+  entry->submitted = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  entry->key = request_id > kNoRequestId ? request_id : next_internal_key_--;
+  entries_[entry->key] = entry;
+  queues_[static_cast<size_t>(entry->request.priority)].push_back(entry);
+  Pump();
+}
+
+void AsyncExecutor::Pump() {
+  if (shutting_down_) {
+    return;
+  }
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  const size_t interactive = static_cast<size_t>(RequestPriority::kInteractive);
+  size_t total = 0;
+  for (size_t active : active_) {
+    total += active;
+  }
+  // Normal and bulk requests together leave one worker free, so that an
+  // interactive request never has to wait for them.
+  size_t lower = total - active_[interactive];
+  size_t lower_limit = std::max<size_t>(pool_->thread_count() - 1, 1);
+  while (total < pool_->thread_count()) {
+    // The front of each queue is its oldest request; pick the one with the
+    // most urgent class after aging, the longest waiting among equals.
+    size_t best = kRequestPriorityCount;
+    size_t best_rank = 0;
+    for (size_t priority = 0; priority < kRequestPriorityCount; ++priority) {
+      std::deque<std::shared_ptr<Entry>>& queue = queues_[priority];
+      // Cancelled requests have already been settled.
+      while (!queue.empty() && queue.front()->cancelled) {
+        queue.pop_front();
+      }
+      if (queue.empty() ||
+          (limits_[priority] != 0 && active_[priority] >= limits_[priority]) ||
+          (priority != interactive && lower >= lower_limit)) {
+        continue;
+      }
+      const Entry& entry = *queue.front();
+      size_t promotions =
+          aging_interval_.count() > 0
+              ? static_cast<size_t>((now - entry.submitted) / aging_interval_)
+              : 0;
+      size_t rank = priority - std::min(priority, promotions);
+      if (best == kRequestPriorityCount || rank < best_rank ||
+          (rank == best_rank &&
+           entry.submitted < queues_[best].front()->submitted)) {
+        best = priority;
+        best_rank = rank;
+      }
+    }
+    if (best == kRequestPriorityCount) {
+      return;
+    }
+
+    std::shared_ptr<Entry> entry = std::move(queues_[best].front());
+    queues_[best].pop_front();
+    ++active_[best];
+    ++total;
+    if (best != interactive) {
+      ++lower;
+    }
+    ++running_;
+    ThreadPool::Task task = [this, entry, best] {
+      if (!entry->cancelled) {
+        entry->request.work(entry->cancelled);
+      }
+      Settle(entry, entry->key, /*cancelled=*/false);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      --active_[best];
+      Pump();
+      if (--running_ == 0) {
+        idle_.notify_all();
+      }
+    };
+    if (best == interactive) {
+      pool_->PostFront(std::move(task));
+    } else {
+      pool_->Post(std::move(task));
+    }
+  }
+}
+
+bool AsyncExecutor::Cancel(int64_t request_id) {
+  if (request_id <= kNoRequestId) {
+    return false;
+  }
+  std::shared_ptr<Entry> entry;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(request_id);
+    if (it == entries_.end()) {
+      return false;
+    }
+    entry = it->second;
+  }
+  entry->cancelled = true;
+  return Settle(entry, request_id, /*cancelled=*/true);
+}
+
+size_t AsyncExecutor::in_flight() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void AsyncExecutor::SetConcurrencyLimit(RequestPriority priority,
+                                        size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  limits_[static_cast<size_t>(priority)] = limit;
+  Pump();
+}
+
+size_t AsyncExecutor::concurrency_limit(RequestPriority priority) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return limits_[static_cast<size_t>(priority)];
+}
+
+void AsyncExecutor::SetAgingInterval(std::chrono::milliseconds interval) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  aging_interval_ = interval;
+  Pump();
+}
+
+PhaseStats AsyncExecutor::latency(RequestPriority priority) const {
+  return latency_[static_cast<size_t>(priority)].Read();
+}
+
+void AsyncExecutor::ResetLatency() {
+  for (LatencyHistogram& histogram : latency_) {
+    histogram.Reset();
+  }
+}
+
+bool AsyncExecutor::Settle(const std::shared_ptr<Entry>& entry, int64_t key,
+                           bool cancelled) {
+  if (entry->settled.exchange(true)) {
+    return false;
+  }
+  if (!cancelled && PerfStatsEnabled()) {
+    auto elapsed = std::chrono::steady_clock::now() - entry->submitted;
+    latency_[static_cast<size_t>(entry->request.priority)].Record(
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second == entry) {
+      entries_.erase(it);
+    }
+    if (shutting_down_) {
+      return true;
+    }
+  }
+  std::function<void()> callback = cancelled
+                                        ? std::move(entry->request.cancelled)
+                                        : std::move(entry->request.complete);
+  if (callback) {
+    dispatcher_->Post(std::move(callback));
+  }
+  return true;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,163 @@
+#ifndef FLUTTER_BIN_ASYNC_EXECUTOR_H_
+#define FLUTTER_BIN_ASYNC_EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "perf_stats.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+
+// Runs closures on the thread that owns the method channel (the platform
+// thread). Implementations must be safe to call from any thread.
+class Dispatcher {
+ public:
+  virtual ~Dispatcher() = default;
+
+  virtual void Post(std::function<void()> task) = 0;
+};
+
+// How urgently a request should run, most urgent first.
+enum class RequestPriority {
+  // A user is waiting on it, e.g. the version of the row just clicked.
+  kInteractive,
+  kNormal,
+  // Batches, scans and other background inventory.
+  kBulk,
+};
+
+constexpr size_t kRequestPriorityCount = 3;
+
+// e.g. "interactive"; the name used on the method channel.
+const char* RequestPriorityName(RequestPriority priority);
+
+// Parses a RequestPriorityName(). Returns false for anything else.
+bool ParseRequestPriority(const std::string& name, RequestPriority* priority);
+
+// One unit of asynchronous work.
+struct AsyncRequest {
+  // Runs on a worker thread. Long-running work should poll |cancelled| and
+  // return early once it is set.
+  std::function<void(const std::atomic<bool>& cancelled)> work;
+
+  // Runs on the dispatcher thread once |work| has finished.
+  std::function<void()> complete;
+
+  // Runs on the dispatcher thread instead of |complete| if the request is
+  // cancelled before it completes.
+  std::function<void()> cancelled;
+  RequestPriority priority = RequestPriority::kNormal;
+};
+
+// Moves blocking work off the platform thread and marshals the completion
+// back through a Dispatcher.
+//
+// Exactly one of a request's |complete| or |cancelled| callbacks runs, and
+// always on the dispatcher thread, so method channel results are only ever
+// touched there.
+//
+// Requests wait in one FIFO queue per RequestPriority and at most one per
+// pool worker runs at a time. Whenever a worker frees up, the most urgent
+// queue whose class is under its concurrency limit goes next, so an
+// interactive request waits for one running request at most rather than
+// for every queued one; it is also posted ahead of the shards of running
+// batches. A request that has waited longer than the aging interval counts
+// as one class more urgent per interval, so bulk work still progresses
+// under a steady stream of interactive requests.
+class AsyncExecutor {
+ public:
+  // Requests submitted with an id <= kNoRequestId cannot be cancelled.
+  static constexpr int64_t kNoRequestId = 0;
+
+  static constexpr std::chrono::milliseconds kDefaultAgingInterval{500};
+
+  // |pool| and |dispatcher| must outlive the executor.
+  AsyncExecutor(ThreadPool* pool, Dispatcher* dispatcher);
+
+  // Cancels everything still in flight and waits for running work to return.
+  // Callbacks that have not been dispatched yet are dropped.
+  ~AsyncExecutor();
+
+  // Disallow copy and assign.
+  AsyncExecutor(const AsyncExecutor&) = delete;
+  AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+  // Queues |request|. |request_id| identifies it for Cancel(); ids must be
+  // unique among requests in flight.
+  void Submit(int64_t request_id, AsyncRequest request);
+
+  // Cancels the request with |request_id|. Returns false if it is unknown or
+  // has already completed.
+  bool Cancel(int64_t request_id);
+
+  // Number of requests that have been submitted but not yet settled.
+  size_t in_flight() const;
+
+  // Most requests of |priority| that run at once; 0 lifts the limit, leaving
+  // the pool size. By default bulk requests take at most half the workers
+  // and normal ones all but one. Whatever the limits, normal and bulk
+  // requests together take all but one worker of a larger pool, which stays
+  // free for interactive requests.
+  void SetConcurrencyLimit(RequestPriority priority, size_t limit);
+  size_t concurrency_limit(RequestPriority priority) const;
+
+  // 0 turns aging off.
+  void SetAgingInterval(std::chrono::milliseconds interval);
+
+  // Time from Submit() to the end of the work of the requests of |priority|
+  // that completed while perf stats were enabled (see perf_stats.h).
+  PhaseStats latency(RequestPriority priority) const;
+  void ResetLatency();
+
+ private:
+  struct Entry {
+    AsyncRequest request;
+    std::atomic<bool> cancelled{false};
+    // Set by whichever of completion or cancellation gets there first.
+    std::atomic<bool> settled{false};
+    int64_t key = 0;
+    std::chrono::steady_clock::time_point submitted;
+  };
+
+  // Starts queued requests while workers and their class limits allow.
+  // |mutex_| must be held.
+  void Pump();
+
+  // Settles |entry| once, dispatching the matching callback unless the
+  // executor is shutting down. Returns false if it was already settled.
+  bool Settle(const std::shared_ptr<Entry>& entry, int64_t key,
+              bool cancelled);
+
+  ThreadPool* pool_;
+  Dispatcher* dispatcher_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable idle_;
+  // Unsettled requests. Requests without a caller id get negative keys.
+  std::unordered_map<int64_t, std::shared_ptr<Entry>> entries_;
+  int64_t next_internal_key_ = -1;  // Guarded by mutex_.
+  size_t running_ = 0;  // Pool tasks not yet returned; guarded by mutex_.
+  bool shutting_down_ = false;  // Guarded by mutex_.
+
+  // Guarded by mutex_.
+  std::deque<std::shared_ptr<Entry>> queues_[kRequestPriorityCount];
+  size_t limits_[kRequestPriorityCount];
+  size_t active_[kRequestPriorityCount] = {};
+  std::chrono::steady_clock::duration aging_interval_;
+
+  LatencyHistogram latency_[kRequestPriorityCount];
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_ASYNC_EXECUTOR_H_
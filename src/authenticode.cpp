@@ -0,0 +1,96 @@
+#include "authenticode.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr size_t kChecksumSize = 4;
+constexpr size_t kDataDirectorySize = 8;
+
+// Hashes [begin, end) of |file| minus the part that overlaps [skip_begin,
+// skip_end).
+void UpdateExcluding(ByteView file, size_t begin, size_t end,
+                     size_t skip_begin, size_t skip_end,
+                     Sha256Hasher* hasher) {
+  skip_begin = std::min(std::max(skip_begin, begin), end);
+  skip_end = std::min(std::max(skip_end, skip_begin), end);
+  hasher->Update(ByteView(file.data + begin, skip_begin - begin));
+  hasher->Update(ByteView(file.data + skip_end, end - skip_end));
+}
+
+}  // namespace
+
+bool AuthenticodeSha256(const PeImage& image, Sha256Digest* digest) {
+  ByteView file = image.image();
+  size_t headers_end = image.size_of_headers();
+  size_t checksum = image.checksum_offset();
+  if (headers_end > file.size || checksum + kChecksumSize > headers_end) {
+    return false;
+  }
+
+  Sha256Hasher hasher;
+  hasher.Update(ByteView(file.data, checksum));
+  size_t after_checksum = checksum + kChecksumSize;
+  // Images with fewer than five data directories have no entry to skip.
+  if (image.data_directory_count() > kPeDirectorySecurity) {
+    size_t entry = image.data_directory_offset(kPeDirectorySecurity);
+    if (entry + kDataDirectorySize > headers_end) {
+      return false;
+    }
+    UpdateExcluding(file, after_checksum, headers_end, entry,
+                    entry + kDataDirectorySize, &hasher);
+  } else {
+    hasher.Update(ByteView(file.data + after_checksum,
+                           headers_end - after_checksum));
+  }
+
+  // Sections are hashed in the order of their data in the file, which need
+  // not be the order of the section table.
+  std::vector<PeSection> sections;
+  sections.reserve(image.section_count());
+  for (size_t i = 0; i < image.section_count(); ++i) {
+    PeSection section = image.section(i);
+    if (section.raw_size == 0) {
+      continue;
+    }
+    if (!file.Contains(section.raw_offset, section.raw_size)) {
+      return false;
+    }
+    sections.push_back(section);
+  }
+  std::stable_sort(sections.begin(), sections.end(),
+                   [](const PeSection& a, const PeSection& b) {
+                     return a.raw_offset < b.raw_offset;
+                   });
+  size_t data_end = headers_end;
+  for (const PeSection& section : sections) {
+    hasher.Update(file.Sub(section.raw_offset, section.raw_size));
+    data_end = std::max(data_end, static_cast<size_t>(section.raw_offset) +
+                                      section.raw_size);
+  }
+
+  // The security directory holds a file offset, not an RVA.
+  uint32_t table_offset = 0;
+  uint32_t table_size = 0;
+  size_t skip_begin = file.size;
+  size_t skip_end = file.size;
+  if (image.GetDataDirectory(kPeDirectorySecurity, &table_offset,
+                             &table_size)) {
+    if (!file.Contains(table_offset, table_size)) {
+      return false;
+    }
+    skip_begin = table_offset;
+    skip_end = skip_begin + table_size;
+  }
+  UpdateExcluding(file, data_end, file.size, skip_begin, skip_end, &hasher);
+
+  *digest = hasher.Finish();
+  return true;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,23 @@
+#ifndef FLUTTER_BIN_AUTHENTICODE_H_
+#define FLUTTER_BIN_AUTHENTICODE_H_
+
+#include "pe_image.h"
+#include "sha256.h"
+
+namespace flutter_bin {
+
+// Computes the Authenticode SHA-256 image digest of |image|: the value a
+// signature's SpcIndirectDataContent carries and allow lists key on, which
+// stays the same when the file is signed or re-signed.
+//
+// Covers the headers without the CheckSum field and the security directory
+// entry, then each section's raw data in file order, then whatever follows
+// the last section (overlays such as installer payloads) except the
+// certificate table. Every range lies at a higher offset than the one before,
+// so the mapping is read once, front to back. Returns false if the headers,
+// a section or the certificate table lie outside the file.
+bool AuthenticodeSha256(const PeImage& image, Sha256Digest* digest);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_AUTHENTICODE_H_
@@ -0,0 +1,234 @@
+// Per-file cost of the version and standard metadata reads over a
+// generated corpus (see testing/corpus.h), by format. Each iteration reads
+// one file, so the time per iteration is the per-file latency and
+// items_per_second is files/sec. Counters, per file:
+//   allocs      operator new calls on the reading thread
+//   faults      page faults taken while reading (Linux only). The mapping
+//               is the only I/O, so this is what the parsers read; the
+//               kernel maps up to 16 cached pages per fault, so one fault
+//               means the headers fit in the first 64 KiB
+//   file_bytes  size of the file, most of which is never read
+//
+//   build/flutter_bin_core_benchmark --benchmark_filter=ReadBinary
+//
+// The View variants read through ReadBinaryMetadataView() and the thread's
+// MetadataScratch instead of building a BinaryMetadata.
+//
+// BM_ReadBinaryFields reads the PE files for field masks of growing size
+// (the second argument, see MetadataRequest::FromMask()), with "fields"
+// the number of fields requested; BM_ReadBinaryFieldsGeneric reads the same
+// fields without the mask, through the decoder for arbitrary requests.
+//
+// FLUTTER_BIN_CORPUS_SEED picks another corpus of the same shape.
+
+#include <benchmark/benchmark.h>
+
+#include <bitset>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "testing/allocation_counter.h"
+#include "testing/corpus.h"
+#include "testing/pe_builder.h"
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+namespace flutter_bin {
+namespace {
+
+using testing::CorpusEntry;
+using testing::CorpusFormat;
+
+// Written on first use and removed at exit.
+class Corpus {
+ public:
+  Corpus() {
+    testing::CorpusOptions options;
+    options.files = 96;
+    if (const char* seed = std::getenv("FLUTTER_BIN_CORPUS_SEED")) {
+      options.seed = std::strtoull(seed, nullptr, 10);
+    }
+    ok_ = testing::WriteCorpus(testing::TempPath("corpus"), options,
+                               &entries_);
+  }
+  ~Corpus() { testing::RemoveCorpus(entries_); }
+
+  bool ok() const { return ok_; }
+
+  // The files of |format|, or all of them when |format| is negative.
+  std::vector<const CorpusEntry*> Files(int64_t format) const {
+    std::vector<const CorpusEntry*> files;
+    for (const CorpusEntry& entry : entries_) {
+      if (format < 0 || entry.format == static_cast<CorpusFormat>(format)) {
+        files.push_back(&entry);
+      }
+    }
+    return files;
+  }
+
+ private:
+  std::vector<CorpusEntry> entries_;
+  bool ok_ = false;
+};
+
+const Corpus& GetCorpus() {
+  static const Corpus corpus;
+  return corpus;
+}
+
+uint64_t PageFaults() {
+#if defined(__linux__)
+  rusage usage;
+  if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+    return static_cast<uint64_t>(usage.ru_minflt + usage.ru_majflt);
+  }
+#endif
+  return 0;
+}
+
+// Reads one file per iteration with |read|, which returns whether it failed.
+template <typename Read>
+void ReadCorpus(benchmark::State& state, Read read) {
+  const Corpus& corpus = GetCorpus();
+  if (!corpus.ok()) {
+    state.SkipWithError("could not write the corpus");
+    return;
+  }
+  std::vector<const CorpusEntry*> files = corpus.Files(state.range(0));
+  if (files.empty()) {
+    state.SkipWithError("no files of this format in the corpus");
+    return;
+  }
+  state.SetLabel(state.range(0) < 0
+                     ? "all"
+                     : testing::CorpusFormatName(
+                           static_cast<CorpusFormat>(state.range(0))));
+
+  size_t next = 0;
+  uint64_t file_bytes = 0;
+  uint64_t failures = 0;
+  uint64_t allocations = testing::ThreadAllocationCount();
+  uint64_t faults = PageFaults();
+  for (auto _ : state) {
+    const CorpusEntry& entry = *files[next];
+    next = next + 1 == files.size() ? 0 : next + 1;
+    failures += read(entry.path);
+    file_bytes += entry.size;
+  }
+  allocations = testing::ThreadAllocationCount() - allocations;
+  faults = PageFaults() - faults;
+  if (failures != 0) {
+    state.SkipWithError("corpus files failed to read");
+    return;
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["allocs"] = benchmark::Counter(
+      static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+  state.counters["file_bytes"] = benchmark::Counter(
+      static_cast<double>(file_bytes), benchmark::Counter::kAvgIterations);
+#if defined(__linux__)
+  state.counters["faults"] = benchmark::Counter(
+      static_cast<double>(faults), benchmark::Counter::kAvgIterations);
+#endif
+}
+
+void ReadCorpus(benchmark::State& state, const MetadataRequest& request) {
+  ReadCorpus(state, [&request](const std::string& path) {
+    BinaryMetadata metadata = ReadBinaryMetadata(path, request);
+    benchmark::DoNotOptimize(metadata);
+    return metadata.error != MetadataError::kNone;
+  });
+}
+
+void ReadCorpusView(benchmark::State& state, const MetadataRequest& request) {
+  MetadataScratch* scratch = MetadataScratch::ForCurrentThread();
+  ReadCorpus(state, [&request, scratch](const std::string& path) {
+    MetadataView metadata = ReadBinaryMetadataView(path, request, scratch);
+    benchmark::DoNotOptimize(metadata);
+    return metadata.error != MetadataError::kNone;
+  });
+}
+
+void BM_ReadBinaryVersion(benchmark::State& state) {
+  ReadCorpus(state, MetadataRequest::Only({kVersionKey}));
+}
+
+void BM_ReadBinaryMetadata(benchmark::State& state) {
+  ReadCorpus(state, MetadataRequest::Standard());
+}
+
+void BM_ReadBinaryVersionView(benchmark::State& state) {
+  ReadCorpusView(state, MetadataRequest::Only({kVersionKey}));
+}
+
+void BM_ReadBinaryMetadataView(benchmark::State& state) {
+  ReadCorpusView(state, MetadataRequest::Standard());
+}
+
+void ReadCorpusFields(benchmark::State& state, bool specialized) {
+  uint32_t mask = static_cast<uint32_t>(state.range(1));
+  MetadataRequest request;
+  if (!MetadataRequest::FromMask(mask, {}, &request)) {
+    state.SkipWithError("invalid field mask");
+    return;
+  }
+  if (!specialized) {
+    request.mask = 0;
+  }
+  ReadCorpus(state, request);
+  state.counters["fields"] =
+      static_cast<double>(std::bitset<32>(mask).count());
+}
+
+void BM_ReadBinaryFields(benchmark::State& state) {
+  ReadCorpusFields(state, /*specialized=*/true);
+}
+
+void BM_ReadBinaryFieldsGeneric(benchmark::State& state) {
+  ReadCorpusFields(state, /*specialized=*/false);
+}
+
+// The version alone, then the company name, the product name, the rest of
+// the standard fields, a content hash, and the Authenticode digest with the
+// signer.
+void FieldMasks(benchmark::internal::Benchmark* benchmark) {
+  constexpr uint32_t kCompanyName = StandardStringFieldBit(4);
+  constexpr uint32_t kProductName = StandardStringFieldBit(0);
+  for (uint32_t mask :
+       {kVersionFieldBit, kVersionFieldBit | kCompanyName,
+        kVersionFieldBit | kCompanyName | kProductName, kStandardFieldMask,
+        kStandardFieldMask | kSha256FieldBit,
+        kStandardFieldMask | kSha256FieldBit | kAuthenticodeFieldBit |
+            kSignatureFieldBit}) {
+    benchmark->Args({static_cast<int>(CorpusFormat::kPe),
+                     static_cast<int64_t>(mask)});
+  }
+}
+
+// -1 is the whole corpus, then one format at a time.
+BENCHMARK(BM_ReadBinaryVersion)
+    ->Arg(-1)
+    ->Arg(static_cast<int>(CorpusFormat::kPe))
+    ->Arg(static_cast<int>(CorpusFormat::kElf))
+    ->Arg(static_cast<int>(CorpusFormat::kMachO));
+BENCHMARK(BM_ReadBinaryMetadata)
+    ->Arg(-1)
+    ->Arg(static_cast<int>(CorpusFormat::kPe))
+    ->Arg(static_cast<int>(CorpusFormat::kElf))
+    ->Arg(static_cast<int>(CorpusFormat::kMachO));
+BENCHMARK(BM_ReadBinaryVersionView)
+    ->Arg(-1)
+    ->Arg(static_cast<int>(CorpusFormat::kPe));
+BENCHMARK(BM_ReadBinaryMetadataView)
+    ->Arg(-1)
+    ->Arg(static_cast<int>(CorpusFormat::kPe));
+BENCHMARK(BM_ReadBinaryFields)->Apply(FieldMasks);
+BENCHMARK(BM_ReadBinaryFieldsGeneric)->Apply(FieldMasks);
+
+}  // namespace
+}  // namespace flutter_bin
@@ -0,0 +1,124 @@
+// Compares the columnar batch encoding with the map per file that the
+// plugins used to send, serialized the way StandardMessageCodec writes it.
+// Reports the payload size per file as the "bytes/file" counter.
+//
+//   build/flutter_bin_core_benchmark --benchmark_filter=Batch
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "columnar_batch.h"
+
+namespace flutter_bin {
+namespace {
+
+// A batch shaped like a scan of an application directory: few companies
+// and copyright lines, more products, a file name per file.
+std::vector<BinaryMetadata> MakeBatch(size_t files) {
+  std::vector<BinaryMetadata> batch(files);
+  for (size_t i = 0; i < files; ++i) {
+    std::string company = "Company " + std::to_string(i % 25);
+    auto& fields = batch[i].fields;
+    fields["version"] = "10.0." + std::to_string(i % 200) + ".1";
+    fields["companyName"] = company + " Corporation";
+    fields["legalCopyright"] =
+        "Copyright (c) " + company + ". All rights reserved.";
+    fields["productName"] = company + " Product " + std::to_string(i % 300);
+    fields["fileDescription"] =
+        "Component " + std::to_string(i % 1000) + " of the product";
+    fields["originalFilename"] = "module_" + std::to_string(i) + ".dll";
+  }
+  return batch;
+}
+
+// StandardMessageCodec: a type byte, then a size, then the payload.
+class StandardCodecWriter {
+ public:
+  void WriteSize(size_t size) {
+    if (size < 254) {
+      bytes_.push_back(static_cast<uint8_t>(size));
+    } else if (size <= 0xFFFF) {
+      bytes_.push_back(254);
+      bytes_.push_back(static_cast<uint8_t>(size));
+      bytes_.push_back(static_cast<uint8_t>(size >> 8));
+    } else {
+      bytes_.push_back(255);
+      for (int shift = 0; shift < 32; shift += 8) {
+        bytes_.push_back(static_cast<uint8_t>(size >> shift));
+      }
+    }
+  }
+
+  void WriteString(const std::string& value) {
+    bytes_.push_back(7);
+    WriteSize(value.size());
+    bytes_.insert(bytes_.end(), value.begin(), value.end());
+  }
+
+  void BeginList(size_t size) {
+    bytes_.push_back(12);
+    WriteSize(size);
+  }
+
+  void BeginMap(size_t size) {
+    bytes_.push_back(13);
+    WriteSize(size);
+  }
+
+  void WriteBytes(const std::vector<uint8_t>& value) {
+    bytes_.push_back(8);
+    WriteSize(value.size());
+    bytes_.insert(bytes_.end(), value.begin(), value.end());
+  }
+
+  size_t size() const { return bytes_.size(); }
+
+ private:
+  std::vector<uint8_t> bytes_;
+};
+
+void BM_BatchMapPerFile(benchmark::State& state) {
+  std::vector<BinaryMetadata> batch =
+      MakeBatch(static_cast<size_t>(state.range(0)));
+  size_t size = 0;
+  for (auto _ : state) {
+    StandardCodecWriter writer;
+    writer.BeginList(batch.size());
+    for (const BinaryMetadata& metadata : batch) {
+      // The copy the plugin made into an EncodableMap.
+      std::vector<std::pair<std::string, std::string>> entry(
+          metadata.fields.begin(), metadata.fields.end());
+      writer.BeginMap(entry.size());
+      for (const auto& [key, value] : entry) {
+        writer.WriteString(key);
+        writer.WriteString(value);
+      }
+    }
+    size = writer.size();
+    benchmark::DoNotOptimize(size);
+  }
+  state.counters["bytes/file"] =
+      static_cast<double>(size) / static_cast<double>(batch.size());
+}
+BENCHMARK(BM_BatchMapPerFile)->Arg(1000)->Arg(10000);
+
+void BM_BatchColumnar(benchmark::State& state) {
+  std::vector<BinaryMetadata> batch =
+      MakeBatch(static_cast<size_t>(state.range(0)));
+  size_t size = 0;
+  for (auto _ : state) {
+    StandardCodecWriter writer;
+    writer.WriteBytes(EncodeColumnarBatch(batch));
+    size = writer.size();
+    benchmark::DoNotOptimize(size);
+  }
+  state.counters["bytes/file"] =
+      static_cast<double>(size) / static_cast<double>(batch.size());
+}
+BENCHMARK(BM_BatchColumnar)->Arg(1000)->Arg(10000);
+
+}  // namespace
+}  // namespace flutter_bin
@@ -0,0 +1,82 @@
+// Digest throughput per kernel; bytes_per_second is the figure to compare.
+//
+//   build/flutter_bin_core_benchmark --benchmark_filter=Hash
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "blake3.h"
+#include "sha256.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+namespace {
+
+const std::vector<uint8_t>& Input(size_t size) {
+  static std::vector<uint8_t> bytes;
+  if (bytes.size() < size) {
+    bytes.resize(size);
+    uint32_t state = 1;
+    for (uint8_t& byte : bytes) {
+      state = state * 1664525 + 1013904223;
+      byte = static_cast<uint8_t>(state >> 24);
+    }
+  }
+  return bytes;
+}
+
+void BM_HashSha256(benchmark::State& state) {
+  auto kernel = static_cast<Sha256Kernel>(state.range(0));
+  if (!Sha256KernelSupported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  state.SetLabel(Sha256KernelName(kernel));
+  ByteView data(Input(state.range(1)).data(), state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Sha256(data, kernel));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size);
+}
+
+void BM_HashBlake3(benchmark::State& state) {
+  auto kernel = static_cast<Blake3Kernel>(state.range(0));
+  if (!Blake3KernelSupported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  state.SetLabel(Blake3KernelName(kernel));
+  ByteView data(Input(state.range(1)).data(), state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Blake3(data, nullptr, kernel));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size);
+}
+
+// The default kernel with chunks spread over one worker per core.
+void BM_HashBlake3Parallel(benchmark::State& state) {
+  static ThreadPool pool(std::thread::hardware_concurrency());
+  ByteView data(Input(state.range(0)).data(), state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Blake3(data, &pool));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size);
+}
+
+// Kernel, input size.
+BENCHMARK(BM_HashSha256)
+    ->ArgsProduct({{static_cast<int>(Sha256Kernel::kPortable),
+                    static_cast<int>(Sha256Kernel::kShaNi)},
+                   {4 << 10, 1 << 20, 64 << 20}});
+BENCHMARK(BM_HashBlake3)
+    ->ArgsProduct({{static_cast<int>(Blake3Kernel::kPortable),
+                    static_cast<int>(Blake3Kernel::kSse41),
+                    static_cast<int>(Blake3Kernel::kAvx2)},
+                   {4 << 10, 1 << 20, 64 << 20}});
+BENCHMARK(BM_HashBlake3Parallel)->Arg(1 << 20)->Arg(64 << 20)->UseRealTime();
+
+}  // namespace
+}  // namespace flutter_bin
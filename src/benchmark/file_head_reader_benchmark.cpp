@@ -0,0 +1,145 @@
+// Files/sec of a whole-corpus inventory (see testing/corpus.h): the
+// per-file ReadBinaryMetadata() that getBinaryFileMetadata uses, the same
+// spread over a ThreadPool as batches did before, and FileHeadReader with
+// each backend this host supports. Each iteration reads every file once,
+// so items_per_second is files/sec. The corpus sits in the page cache, so
+// this measures system call and parsing cost, not the disk.
+//
+//   build/flutter_bin_core_benchmark --benchmark_filter=Inventory
+//
+// FLUTTER_BIN_CORPUS_SEED picks another corpus of the same shape.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "file_head_reader.h"
+#include "testing/corpus.h"
+#include "testing/pe_builder.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+namespace {
+
+using testing::CorpusEntry;
+
+// Written on first use and removed at exit.
+class InventoryCorpus {
+ public:
+  InventoryCorpus() {
+    testing::CorpusOptions options;
+    // Enough files for several groups, small enough to write quickly.
+    options.files = 512;
+    options.max_file_size = 256 << 10;
+    if (const char* seed = std::getenv("FLUTTER_BIN_CORPUS_SEED")) {
+      options.seed = std::strtoull(seed, nullptr, 10);
+    }
+    std::vector<CorpusEntry> entries;
+    ok_ = testing::WriteCorpus(testing::TempPath("inventory"), options,
+                               &entries);
+    for (const CorpusEntry& entry : entries) {
+      paths_.push_back(entry.path);
+    }
+    entries_ = std::move(entries);
+  }
+  ~InventoryCorpus() { testing::RemoveCorpus(entries_); }
+
+  bool ok() const { return ok_; }
+  const std::vector<std::string>& paths() const { return paths_; }
+
+ private:
+  std::vector<CorpusEntry> entries_;
+  std::vector<std::string> paths_;
+  bool ok_ = false;
+};
+
+const InventoryCorpus& GetInventoryCorpus() {
+  static const InventoryCorpus corpus;
+  return corpus;
+}
+
+// Runs |read| over the corpus once per iteration; it returns how many files
+// failed.
+template <typename Read>
+void Inventory(benchmark::State& state, Read read) {
+  const InventoryCorpus& corpus = GetInventoryCorpus();
+  if (!corpus.ok()) {
+    state.SkipWithError("could not write the corpus");
+    return;
+  }
+  size_t failures = 0;
+  for (auto _ : state) {
+    failures += read(corpus.paths());
+  }
+  if (failures != 0) {
+    state.SkipWithError("corpus files failed to read");
+    return;
+  }
+  state.SetItemsProcessed(state.iterations() * corpus.paths().size());
+}
+
+void BM_InventorySerial(benchmark::State& state) {
+  MetadataRequest request = MetadataRequest::Standard();
+  Inventory(state, [&](const std::vector<std::string>& paths) {
+    size_t failures = 0;
+    for (const std::string& path : paths) {
+      BinaryMetadata metadata = ReadBinaryMetadata(path, request);
+      failures += metadata.error != MetadataError::kNone;
+      benchmark::DoNotOptimize(metadata);
+    }
+    return failures;
+  });
+}
+
+void BM_InventoryThreadPool(benchmark::State& state) {
+  MetadataRequest request = MetadataRequest::Standard();
+  ThreadPool pool(ThreadPool::DefaultThreadCount());
+  Inventory(state, [&](const std::vector<std::string>& paths) {
+    std::vector<BinaryMetadata> results(paths.size());
+    pool.ParallelFor(paths.size(), [&](size_t i) {
+      results[i] = ReadBinaryMetadata(paths[i], request);
+    });
+    size_t failures = 0;
+    for (const BinaryMetadata& metadata : results) {
+      failures += metadata.error != MetadataError::kNone;
+    }
+    return failures;
+  });
+}
+
+void BM_InventoryFileHeadReader(benchmark::State& state) {
+  auto backend = static_cast<FileHeadBackend>(state.range(0));
+  if (!FileHeadBackendSupported(backend)) {
+    state.SkipWithError("backend not supported on this host");
+    return;
+  }
+  state.SetLabel(FileHeadBackendName(backend));
+  MetadataRequest request = MetadataRequest::Standard();
+  ThreadPool pool(ThreadPool::DefaultThreadCount());
+  FileHeadReader reader(&pool, backend);
+  Inventory(state, [&](const std::vector<std::string>& paths) {
+    std::vector<BinaryMetadata> results(paths.size());
+    reader.Read(paths, [&](size_t i, FileHead* head) {
+      results[i] = ReadBinaryMetadata(head, request);
+    });
+    size_t failures = 0;
+    for (const BinaryMetadata& metadata : results) {
+      failures += metadata.error != MetadataError::kNone;
+    }
+    return failures;
+  });
+}
+
+BENCHMARK(BM_InventorySerial)->UseRealTime();
+BENCHMARK(BM_InventoryThreadPool)->UseRealTime();
+BENCHMARK(BM_InventoryFileHeadReader)
+    ->Arg(static_cast<int>(FileHeadBackend::kThreadPool))
+    ->Arg(static_cast<int>(FileHeadBackend::kIoUring))
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace flutter_bin
@@ -0,0 +1,250 @@
+// Compares the key-selective plist reader with decoding the whole property
+// list into a tree first, which is what NSDictionary(contentsOfFile:) does.
+//
+//   build/flutter_bin_core_benchmark --benchmark_filter=Plist
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "plist_reader.h"
+#include "testing/plist_builder.h"
+
+namespace flutter_bin {
+namespace {
+
+const std::vector<std::string>& WantedKeys() {
+  static const std::vector<std::string> keys = {
+      "CFBundleShortVersionString", "CFBundleVersion", "CFBundleName",
+      "NSHumanReadableCopyright",   "CFBundleExecutable",
+  };
+  return keys;
+}
+
+// A fully decoded plist value.
+struct Node {
+  PlistType type = PlistType::kOther;
+  std::string text;
+  std::vector<std::unique_ptr<Node>> items;
+  std::map<std::string, std::unique_ptr<Node>> entries;
+};
+
+// Baseline bplist00 decoder: materializes every object reachable from the
+// root.
+class FullBinaryDecoder {
+ public:
+  explicit FullBinaryDecoder(const std::vector<uint8_t>& plist)
+      : data_(plist.data()) {
+    const uint8_t* trailer = data_ + plist.size() - 32;
+    offset_size_ = trailer[6];
+    ref_size_ = trailer[7];
+    table_ = data_ + LoadBeN(trailer + 24, 8);
+    top_ = LoadBeN(trailer + 16, 8);
+  }
+
+  std::unique_ptr<Node> Decode() { return Decode(top_); }
+
+ private:
+  static uint64_t LoadBeN(const uint8_t* p, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+      value = (value << 8) | p[i];
+    }
+    return value;
+  }
+
+  std::unique_ptr<Node> Decode(uint64_t index) {
+    const uint8_t* p =
+        data_ + LoadBeN(table_ + index * offset_size_, offset_size_);
+    uint8_t type = *p >> 4;
+    uint64_t count = *p & 0xF;
+    ++p;
+    if (count == 0xF && type >= 0x4) {
+      size_t size = size_t{1} << (*p & 0xF);
+      count = LoadBeN(p + 1, size);
+      p += 1 + size;
+    }
+    auto node = std::make_unique<Node>();
+    switch (type) {
+      case 0x0:
+        node->type = PlistType::kBoolean;
+        node->text = count == 9 ? "true" : "false";
+        break;
+      case 0x1:
+        node->type = PlistType::kInteger;
+        node->text = std::to_string(LoadBeN(p, size_t{1} << count));
+        break;
+      case 0x4:
+        node->type = PlistType::kData;
+        node->text.assign(reinterpret_cast<const char*>(p), count);
+        break;
+      case 0x5:
+        node->type = PlistType::kString;
+        node->text.assign(reinterpret_cast<const char*>(p), count);
+        break;
+      case 0x6:
+        node->type = PlistType::kString;
+        for (uint64_t i = 0; i < count; ++i) {
+          node->text.push_back(static_cast<char>(p[2 * i + 1]));
+        }
+        break;
+      case 0xA:
+        node->type = PlistType::kArray;
+        for (uint64_t i = 0; i < count; ++i) {
+          node->items.push_back(Decode(LoadBeN(p + i * ref_size_, ref_size_)));
+        }
+        break;
+      case 0xD:
+        node->type = PlistType::kDictionary;
+        for (uint64_t i = 0; i < count; ++i) {
+          std::unique_ptr<Node> key =
+              Decode(LoadBeN(p + i * ref_size_, ref_size_));
+          node->entries[key->text] =
+              Decode(LoadBeN(p + (count + i) * ref_size_, ref_size_));
+        }
+        break;
+      default:
+        break;
+    }
+    return node;
+  }
+
+  const uint8_t* data_;
+  const uint8_t* table_;
+  size_t offset_size_;
+  size_t ref_size_;
+  uint64_t top_;
+};
+
+// Baseline XML decoder: builds the whole element tree.
+class FullXmlDecoder {
+ public:
+  explicit FullXmlDecoder(const std::string& plist)
+      : p_(plist.data()), end_(plist.data() + plist.size()) {}
+
+  std::unique_ptr<Node> Decode() {
+    std::string name;
+    while (NextTag(&name) && (name[0] == '?' || name[0] == '!' ||
+                              name.compare(0, 5, "plist") == 0)) {
+    }
+    return DecodeElement(name);
+  }
+
+ private:
+  bool NextTag(std::string* name) {
+    const char* open =
+        static_cast<const char*>(std::memchr(p_, '<', end_ - p_));
+    if (open == nullptr) {
+      return false;
+    }
+    const char* close =
+        static_cast<const char*>(std::memchr(open, '>', end_ - open));
+    name->assign(open + 1, close);
+    p_ = close + 1;
+    return true;
+  }
+
+  std::string Text() {
+    const char* open =
+        static_cast<const char*>(std::memchr(p_, '<', end_ - p_));
+    std::string text(p_, open);
+    p_ = open;
+    std::string closing;
+    NextTag(&closing);
+    return text;
+  }
+
+  std::unique_ptr<Node> DecodeElement(const std::string& name) {
+    auto node = std::make_unique<Node>();
+    if (name == "dict") {
+      node->type = PlistType::kDictionary;
+      std::string tag;
+      while (NextTag(&tag) && tag == "key") {
+        std::string key = Text();
+        NextTag(&tag);
+        node->entries[key] = DecodeElement(tag);
+      }
+    } else if (name == "array") {
+      node->type = PlistType::kArray;
+      std::string tag;
+      while (NextTag(&tag) && tag != "/array") {
+        node->items.push_back(DecodeElement(tag));
+      }
+    } else if (name == "true/" || name == "false/") {
+      node->type = PlistType::kBoolean;
+      node->text = name.substr(0, name.size() - 1);
+    } else if (name.back() != '/') {
+      node->type = name == "string" ? PlistType::kString : PlistType::kOther;
+      node->text = Text();
+    }
+    return node;
+  }
+
+  const char* p_;
+  const char* end_;
+};
+
+template <typename Decoded>
+void LookUp(const Decoded& root) {
+  for (const std::string& key : WantedKeys()) {
+    auto it = root->entries.find(key);
+    if (it != root->entries.end()) {
+      benchmark::DoNotOptimize(it->second->text.data());
+    }
+  }
+}
+
+void BM_PlistSelectiveXml(benchmark::State& state) {
+  std::string plist = testing::ToXmlPlist(
+      testing::LargeInfoPlist(static_cast<size_t>(state.range(0))));
+  ByteView view(reinterpret_cast<const uint8_t*>(plist.data()), plist.size());
+  std::vector<PlistValue> values;
+  for (auto _ : state) {
+    ReadPlistValues(view, WantedKeys(), &values);
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetBytesProcessed(state.iterations() * plist.size());
+}
+
+void BM_PlistFullXml(benchmark::State& state) {
+  std::string plist = testing::ToXmlPlist(
+      testing::LargeInfoPlist(static_cast<size_t>(state.range(0))));
+  for (auto _ : state) {
+    LookUp(FullXmlDecoder(plist).Decode());
+  }
+  state.SetBytesProcessed(state.iterations() * plist.size());
+}
+
+void BM_PlistSelectiveBinary(benchmark::State& state) {
+  std::vector<uint8_t> plist = testing::ToBinaryPlist(
+      testing::LargeInfoPlist(static_cast<size_t>(state.range(0))));
+  ByteView view(plist.data(), plist.size());
+  std::vector<PlistValue> values;
+  for (auto _ : state) {
+    ReadPlistValues(view, WantedKeys(), &values);
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetBytesProcessed(state.iterations() * plist.size());
+}
+
+void BM_PlistFullBinary(benchmark::State& state) {
+  std::vector<uint8_t> plist = testing::ToBinaryPlist(
+      testing::LargeInfoPlist(static_cast<size_t>(state.range(0))));
+  for (auto _ : state) {
+    LookUp(FullBinaryDecoder(plist).Decode());
+  }
+  state.SetBytesProcessed(state.iterations() * plist.size());
+}
+
+// Scale is the number of document types, URL schemes and localizations.
+BENCHMARK(BM_PlistSelectiveXml)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_PlistFullXml)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_PlistSelectiveBinary)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_PlistFullBinary)->Arg(10)->Arg(100)->Arg(1000);
+
+}  // namespace
+}  // namespace flutter_bin
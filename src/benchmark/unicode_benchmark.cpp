@@ -0,0 +1,87 @@
+// Transcoding throughput per kernel on version-resource-like strings, all
+// ASCII or with a non-ASCII character every 8 code units;
+// bytes_per_second (of UTF-16 input or UTF-8 input) is the figure to compare.
+//
+//   build/flutter_bin_core_benchmark --benchmark_filter=Utf
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unicode.h"
+
+namespace flutter_bin {
+namespace {
+
+// 4096 code units of "Copyright (C) Example Corporation. " repeated, with
+// every |stride|th unit replaced by U+D55C when |stride| is not zero.
+std::u16string Text(int64_t stride) {
+  const std::u16string phrase = u"Copyright (C) Example Corporation. ";
+  std::u16string text;
+  while (text.size() < 4096) {
+    text += phrase;
+  }
+  text.resize(4096);
+  for (size_t i = 0; stride != 0 && i < text.size();
+       i += static_cast<size_t>(stride)) {
+    text[i] = u'\xD55C';
+  }
+  return text;
+}
+
+std::vector<uint8_t> Utf16Le(const std::u16string& text) {
+  std::vector<uint8_t> bytes;
+  for (char16_t unit : text) {
+    bytes.push_back(static_cast<uint8_t>(unit));
+    bytes.push_back(static_cast<uint8_t>(unit >> 8));
+  }
+  return bytes;
+}
+
+void BM_Utf16ToUtf8(benchmark::State& state) {
+  auto kernel = static_cast<UnicodeKernel>(state.range(0));
+  if (!UnicodeKernelSupported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  state.SetLabel(UnicodeKernelName(kernel));
+  std::u16string text = Text(state.range(1));
+  std::vector<uint8_t> bytes = Utf16Le(text);
+  std::string out(3 * text.size(), '\0');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        Utf16ToUtf8(Utf16View(bytes.data(), text.size()), &out[0], kernel));
+  }
+  state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+BENCHMARK(BM_Utf16ToUtf8)
+    ->ArgsProduct({{static_cast<int>(UnicodeKernel::kScalar),
+                    static_cast<int>(UnicodeKernel::kSse2),
+                    static_cast<int>(UnicodeKernel::kAvx2)},
+                   {0, 8}});
+
+void BM_Utf8ToUtf16(benchmark::State& state) {
+  auto kernel = static_cast<UnicodeKernel>(state.range(0));
+  if (!UnicodeKernelSupported(kernel)) {
+    state.SkipWithError("kernel not supported on this CPU");
+    return;
+  }
+  state.SetLabel(UnicodeKernelName(kernel));
+  std::vector<uint8_t> utf16 = Utf16Le(Text(state.range(1)));
+  std::string text = Utf16ToUtf8(Utf16View(utf16.data(), utf16.size() / 2));
+  std::u16string out(text.size(), u'\0');
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Utf8ToUtf16(text, &out[0], nullptr, kernel));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Utf8ToUtf16)
+    ->ArgsProduct({{static_cast<int>(UnicodeKernel::kScalar),
+                    static_cast<int>(UnicodeKernel::kSse2),
+                    static_cast<int>(UnicodeKernel::kAvx2)},
+                   {0, 8}});
+
+}  // namespace
+}  // namespace flutter_bin
@@ -0,0 +1,73 @@
+#include "binary_format.h"
+
+#include <cstdint>
+#include <cstdio>
+
+#include "file_io.h"
+
+namespace flutter_bin {
+
+namespace {
+
+// Java class files share the universal binary magic; their version number
+// sits where a fat header keeps its (small) architecture count.
+constexpr uint32_t kMaxFatArchitectures = 30;
+
+}  // namespace
+
+BinaryFormat DetectBinaryFormat(ByteView header) {
+  if (header.Contains(0, 2) && header.data[0] == 'M' && header.data[1] == 'Z') {
+    return BinaryFormat::kPe;
+  }
+  if (!header.Contains(0, 4)) {
+    return BinaryFormat::kUnknown;
+  }
+  uint32_t magic = LoadBe32(header.data);
+  switch (magic) {
+    case 0x7F454C46:  // "\x7F" "ELF"
+      return BinaryFormat::kElf;
+    case 0xFEEDFACE:  // MH_MAGIC, big-endian
+    case 0xFEEDFACF:  // MH_MAGIC_64, big-endian
+    case 0xCEFAEDFE:  // MH_MAGIC, little-endian
+    case 0xCFFAEDFE:  // MH_MAGIC_64, little-endian
+      return BinaryFormat::kMachO;
+    case 0xCAFEBABE:  // FAT_MAGIC
+    case 0xCAFEBABF:  // FAT_MAGIC_64
+      if (header.Contains(4, 4)) {
+        uint32_t count = LoadBe32(header.data + 4);
+        if (count != 0 && count <= kMaxFatArchitectures) {
+          return BinaryFormat::kMachO;
+        }
+      }
+      return BinaryFormat::kUnknown;
+    default:
+      return BinaryFormat::kUnknown;
+  }
+}
+
+BinaryFormat DetectFileFormat(const std::string& utf8_path) {
+  std::FILE* file = OpenFile(utf8_path, "rb");
+  if (file == nullptr) {
+    return BinaryFormat::kUnknown;
+  }
+  uint8_t header[kBinaryFormatHeaderSize];
+  size_t size = std::fread(header, 1, sizeof(header), file);
+  std::fclose(file);
+  return DetectBinaryFormat(ByteView(header, size));
+}
+
+const char* BinaryFormatName(BinaryFormat format) {
+  switch (format) {
+    case BinaryFormat::kPe:
+      return "pe";
+    case BinaryFormat::kElf:
+      return "elf";
+    case BinaryFormat::kMachO:
+      return "macho";
+    case BinaryFormat::kUnknown:
+      return "unknown";
+  }
+  return "unknown";
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,35 @@
+#ifndef FLUTTER_BIN_BINARY_FORMAT_H_
+#define FLUTTER_BIN_BINARY_FORMAT_H_
+
+#include <cstddef>
+#include <string>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+// Executable formats recognized by their leading magic bytes.
+enum class BinaryFormat {
+  kUnknown,
+  kPe,     // "MZ" DOS header, usually followed by a PE image.
+  kElf,
+  kMachO,  // Thin or universal (fat).
+};
+
+// How many leading bytes DetectBinaryFormat() looks at.
+constexpr size_t kBinaryFormatHeaderSize = 8;
+
+// Classifies a file from its first bytes. |header| may be shorter than
+// kBinaryFormatHeaderSize for tiny files.
+BinaryFormat DetectBinaryFormat(ByteView header);
+
+// Reads the first bytes of |utf8_path| and classifies them. Returns
+// kUnknown if the file cannot be read.
+BinaryFormat DetectFileFormat(const std::string& utf8_path);
+
+// Returns the name reported to Dart, e.g. "pe".
+const char* BinaryFormatName(BinaryFormat format);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_BINARY_FORMAT_H_
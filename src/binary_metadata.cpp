@@ -0,0 +1,726 @@
+#include "binary_metadata.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "authenticode.h"
+#include "code_signature.h"
+#include "elf_image.h"
+#include "elf_metadata.h"
+#include "file_head_reader.h"
+#include "macho_image.h"
+#include "macho_metadata.h"
+#include "mapped_file.h"
+#include "pe_image.h"
+#include "perf_stats.h"
+#include "positioned_file.h"
+#include "unicode.h"
+#include "version_resource.h"
+#include "version_string_index.h"
+
+namespace flutter_bin {
+
+const char kVersionKey[] = "version";
+
+namespace {
+
+constexpr uint16_t kDosSignature = 0x5A4D;  // "MZ"
+
+struct HashFieldBit {
+  uint32_t bit;
+  HashAlgorithm algorithm;
+};
+
+constexpr HashFieldBit kHashFieldBits[] = {
+    {kSha256FieldBit, HashAlgorithm::kSha256},
+    {kBlake3FieldBit, HashAlgorithm::kBlake3},
+    {kAuthenticodeFieldBit, HashAlgorithm::kAuthenticode},
+};
+
+MetadataError FromMappingError(MappedFile::Error error) {
+  switch (error) {
+    case MappedFile::Error::kNotFound:
+      return MetadataError::kFileNotFound;
+    case MappedFile::Error::kAccessDenied:
+      return MetadataError::kAccessDenied;
+    case MappedFile::Error::kNotRegularFile:
+      return MetadataError::kNotAFile;
+    case MappedFile::Error::kEmpty:
+      return MetadataError::kUnsupportedFormat;
+    default:
+      return MetadataError::kReadFailed;
+  }
+}
+
+MetadataError FromOpenError(PositionedFile::Error error) {
+  switch (error) {
+    case PositionedFile::Error::kNotFound:
+      return MetadataError::kFileNotFound;
+    case PositionedFile::Error::kAccessDenied:
+      return MetadataError::kAccessDenied;
+    case PositionedFile::Error::kNotRegularFile:
+      return MetadataError::kNotAFile;
+    case PositionedFile::Error::kEmpty:
+      return MetadataError::kUnsupportedFormat;
+    default:
+      return MetadataError::kReadFailed;
+  }
+}
+
+MetadataError FromReadError(BoundedReader::Error error) {
+  switch (error) {
+    case BoundedReader::Error::kNone:
+      return MetadataError::kNone;
+    case BoundedReader::Error::kBudgetExceeded:
+      return MetadataError::kBudgetExceeded;
+    case BoundedReader::Error::kTimedOut:
+      return MetadataError::kTimedOut;
+    default:
+      return MetadataError::kReadFailed;
+  }
+}
+
+// Puts decoded version fields into a BinaryMetadata.
+class FieldMapWriter {
+ public:
+  explicit FieldMapWriter(BinaryMetadata* metadata) : metadata_(metadata) {}
+
+  void AddVersion(const FixedFileInfoView& info) {
+    metadata_->fields[kVersionKey] = FormatFileVersion(info);
+  }
+  void AddString(std::string_view key, Utf16View value) {
+    AppendUtf8(value, &metadata_->fields[std::string(key)]);
+  }
+
+ private:
+  BinaryMetadata* metadata_;
+};
+
+// Puts decoded version fields into an arena, for a MetadataView.
+class FieldViewWriter {
+ public:
+  FieldViewWriter(Arena* arena, size_t capacity)
+      : arena_(arena),
+        fields_(arena->AllocateArray<MetadataField>(capacity)),
+        capacity_(capacity) {}
+
+  void AddVersion(const FixedFileInfoView& info) {
+    char* out = arena_->AllocateArray<char>(kMaxFileVersionLength);
+    Add(kVersionKey, std::string_view(out, FormatFileVersion(info, out)));
+  }
+  void AddString(std::string_view key, Utf16View value) {
+    // A key requested twice is reported once, as in a BinaryMetadata.
+    for (size_t i = 0; i < size_; ++i) {
+      if (fields_[i].key == key) {
+        return;
+      }
+    }
+    // The key is copied too, so the view does not refer to the request.
+    char* out = arena_->AllocateArray<char>(key.size() + 3 * value.length);
+    std::copy(key.begin(), key.end(), out);
+    size_t length = value.empty() ? 0 : Utf16ToUtf8(value, out + key.size());
+    Add(std::string_view(out, key.size()),
+        std::string_view(out + key.size(), length));
+  }
+
+  // Returns the fields sorted by key.
+  ArenaSpan<MetadataField> Finish() {
+    std::sort(fields_, fields_ + size_,
+              [](const MetadataField& a, const MetadataField& b) {
+                return a.key < b.key;
+              });
+    return {fields_, size_};
+  }
+
+ private:
+  void Add(std::string_view key, std::string_view value) {
+    if (size_ < capacity_) {
+      fields_[size_++] = {key, value};
+    }
+  }
+
+  Arena* arena_;
+  MetadataField* fields_;
+  size_t capacity_;
+  size_t size_ = 0;
+};
+
+constexpr size_t CountStringFields(uint32_t mask) {
+  size_t count = 0;
+  for (size_t i = 0; i < std::size(kStandardStringFields); ++i) {
+    count += (mask & StandardStringFieldBit(i)) != 0 ? 1 : 0;
+  }
+  return count;
+}
+
+// HashVersionKey() of every version resource key in |kMask|.
+template <uint32_t kMask>
+constexpr std::array<uint32_t, CountStringFields(kMask)> StringFieldHashes() {
+  std::array<uint32_t, CountStringFields(kMask)> hashes{};
+  size_t count = 0;
+  for (size_t i = 0; i < std::size(kStandardStringFields); ++i) {
+    if ((kMask & StandardStringFieldBit(i)) != 0) {
+      hashes[count++] = HashVersionKey(kStandardStringFields[i].version_key);
+    }
+  }
+  return hashes;
+}
+
+template <uint32_t kMask, size_t kIndex, typename Writer>
+void AddMaskedString(const VersionStringIndex& index, Writer* writer) {
+  if constexpr ((kMask & StandardStringFieldBit(kIndex)) != 0) {
+    constexpr StandardStringField kField = kStandardStringFields[kIndex];
+    constexpr uint32_t kHash = HashVersionKey(kField.version_key);
+    Utf16View value;
+    index.Find(kHash, kField.version_key, &value);
+    writer->AddString(kField.metadata_key, value);
+  }
+}
+
+template <uint32_t kMask, typename Writer, size_t... kIndices>
+void AddMaskedStrings(const VersionStringIndex& index, Writer* writer,
+                      std::index_sequence<kIndices...>) {
+  (AddMaskedString<kMask, kIndices>(index, writer), ...);
+}
+
+// ReadVersionFields() compiled for exactly the version fields in |kMask|.
+// Without a string field the StringFileInfo tree is never walked; with
+// some, only their keys, hashed at compile time, are indexed and looked up.
+template <uint32_t kMask, typename FindBlob, typename Writer>
+MetadataError ReadMaskedVersionFields(FindBlob& find_blob,
+                                      VersionStringIndex* index,
+                                      Writer* writer) {
+  VersionResource resource;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kResourceRead);
+    if (!resource.Parse(find_blob())) {
+      return MetadataError::kNoVersionInfo;
+    }
+    if constexpr (CountStringFields(kMask) != 0) {
+      static constexpr std::array<uint32_t, CountStringFields(kMask)>
+          kHashes = StringFieldHashes<kMask>();
+      index->Build(resource, kHashes.data(), kHashes.size());
+    }
+  }
+
+  ScopedPhaseTimer timer(PerfPhase::kStringDecode);
+  if constexpr ((kMask & kVersionFieldBit) != 0) {
+    if (resource.fixed_file_info().valid()) {
+      writer->AddVersion(resource.fixed_file_info());
+    }
+  }
+  AddMaskedStrings<kMask>(
+      *index, writer,
+      std::make_index_sequence<std::size(kStandardStringFields)>());
+  return MetadataError::kNone;
+}
+
+template <uint32_t... kMasks>
+struct MaskList {};
+
+// The version field masks with a ReadMaskedVersionFields(): the version
+// alone, the version and company name a file listing shows, the same with
+// the product name, and the standard fields.
+using SpecializedMasks =
+    MaskList<kVersionFieldBit, kVersionFieldBit | StandardStringFieldBit(4),
+             kVersionFieldBit | StandardStringFieldBit(0) |
+                 StandardStringFieldBit(4),
+             kStandardFieldMask>;
+
+// Runs the ReadMaskedVersionFields() for |request| into |error|. Returns
+// false if there is none, e.g. for a request with custom keys.
+template <typename FindBlob, typename Writer, uint32_t... kMasks>
+bool ReadSpecializedVersionFields(MaskList<kMasks...>, FindBlob& find_blob,
+                                  const MetadataRequest& request,
+                                  VersionStringIndex* index, Writer* writer,
+                                  MetadataError* error) {
+  uint32_t mask = request.mask & kStandardFieldMask;
+  // Custom keys, and requests built by hand, have fields the mask does not
+  // describe.
+  if (request.version != ((mask & kVersionFieldBit) != 0) ||
+      request.strings.size() != CountStringFields(mask)) {
+    return false;
+  }
+  return ((mask == kMasks &&
+           (*error = ReadMaskedVersionFields<kMasks>(find_blob, index, writer),
+            true)) ||
+          ...);
+}
+
+// Decodes the version fields of |request| from the VS_VERSIONINFO blob that
+// |find_blob| returns into |writer|, using |index| for the string lookups.
+template <typename FindBlob, typename Writer>
+MetadataError ReadVersionFields(FindBlob find_blob,
+                                const MetadataRequest& request,
+                                VersionStringIndex* index, Writer* writer) {
+  MetadataError error;
+  if (ReadSpecializedVersionFields(SpecializedMasks(), find_blob, request,
+                                   index, writer, &error)) {
+    return error;
+  }
+
+  VersionResource resource;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kResourceRead);
+    if (!resource.Parse(find_blob())) {
+      return MetadataError::kNoVersionInfo;
+    }
+    // One pass over the StringFileInfo tree answers every requested key.
+    if (!request.strings.empty()) {
+      index->Build(resource);
+    }
+  }
+
+  ScopedPhaseTimer timer(PerfPhase::kStringDecode);
+  if (request.version && resource.fixed_file_info().valid()) {
+    writer->AddVersion(resource.fixed_file_info());
+  }
+  for (const auto& field : request.strings) {
+    Utf16View value;
+    index->Find(field.second.c_str(), &value);
+    writer->AddString(field.first, value);
+  }
+  return MetadataError::kNone;
+}
+
+// ReadVersionFields() into |metadata|.
+template <typename FindBlob>
+void ReadVersionFields(FindBlob find_blob, const MetadataRequest& request,
+                       BinaryMetadata* metadata) {
+  VersionStringIndex index;
+  FieldMapWriter writer(metadata);
+  MetadataError error =
+      ReadVersionFields(find_blob, request, &index, &writer);
+  if (error != MetadataError::kNone) {
+    metadata->error = error;
+  }
+}
+
+void ReadPeMetadata(const PeImage& image, const MetadataRequest& request,
+                    BinaryMetadata* metadata) {
+  // Digest and signer are reported even without a version resource.
+  if (std::find(request.hashes.begin(), request.hashes.end(),
+                HashAlgorithm::kAuthenticode) != request.hashes.end()) {
+    ScopedPhaseTimer timer(PerfPhase::kHash);
+    Sha256Digest digest;
+    if (AuthenticodeSha256(image, &digest)) {
+      metadata->fields[HashAlgorithmName(HashAlgorithm::kAuthenticode)] =
+          ToHex(digest.data(), digest.size());
+    }
+  }
+  CodeSigner signer;
+  if (request.signature &&
+      ReadCodeSigner(FindPeSignedData(image), &signer)) {
+    AddCodeSignerFields(signer, &metadata->fields);
+  }
+
+  ReadVersionFields([&image] { return image.FindVersionResource(); },
+                    request, metadata);
+}
+
+// ReadBinaryMetadata() once the file is mapped at |view|.
+BinaryMetadata ReadMappedMetadata(ByteView view,
+                                  const MetadataRequest& request) {
+  BinaryMetadata metadata;
+  if (!request.hashes.empty()) {
+    ScopedPhaseTimer timer(PerfPhase::kHash);
+    AddContentHashes(view, request.hashes, &metadata.fields);
+  }
+
+  PeImage pe;
+  ElfImage elf;
+  std::vector<MachOSlice> slices;
+  bool is_pe = false;
+  bool is_elf = false;
+  bool is_macho = false;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kHeaderParse);
+    is_pe = pe.Parse(view);
+    is_elf = !is_pe && elf.Parse(view);
+    is_macho = !is_pe && !is_elf && ReadMachOSlices(view, &slices);
+  }
+
+  if (is_pe) {
+    ReadPeMetadata(pe, request, &metadata);
+  } else if (is_elf) {
+    // Notes and dynamic strings are decoded as they are found, so the
+    // whole read counts as the resource phase.
+    ScopedPhaseTimer timer(PerfPhase::kResourceRead);
+    ReadElfMetadata(elf, request, &metadata);
+  } else if (is_macho) {
+    ScopedPhaseTimer timer(PerfPhase::kResourceRead);
+    ReadMachOMetadata(slices, request, &metadata);
+  } else {
+    metadata.error = MetadataError::kUnsupportedFormat;
+  }
+  return metadata;
+}
+
+}  // namespace
+
+const char* MetadataErrorCode(MetadataError error) {
+  switch (error) {
+    case MetadataError::kNone:
+      return "";
+    case MetadataError::kFileNotFound:
+      return "FILE_NOT_FOUND";
+    case MetadataError::kAccessDenied:
+      return "ACCESS_DENIED";
+    case MetadataError::kNotAFile:
+      return "NOT_A_FILE";
+    case MetadataError::kUnsupportedFormat:
+      return "UNSUPPORTED_FORMAT";
+    case MetadataError::kNoVersionInfo:
+      return "NO_VERSION_INFO";
+    case MetadataError::kReadFailed:
+      return "READ_FAILED";
+    case MetadataError::kBudgetExceeded:
+      return "BUDGET_EXCEEDED";
+    case MetadataError::kTimedOut:
+      return "TIMED_OUT";
+  }
+  return "READ_FAILED";
+}
+
+// static
+MetadataRequest MetadataRequest::Standard(
+    const std::vector<std::string>& custom_keys) {
+  MetadataRequest request;
+  request.mask = kStandardFieldMask;
+  request.version = true;
+  for (const StandardStringField& field : kStandardStringFields) {
+    request.strings.emplace_back(field.metadata_key, field.version_key);
+  }
+  for (const std::string& key : custom_keys) {
+    request.strings.emplace_back(key, key);
+  }
+  return request;
+}
+
+// static
+MetadataRequest MetadataRequest::Only(const std::vector<std::string>& fields) {
+  MetadataRequest request;
+  for (const std::string& name : fields) {
+    HashAlgorithm algorithm;
+    if (name == kVersionKey) {
+      request.mask |= kVersionFieldBit;
+      request.version = true;
+      continue;
+    }
+    if (ParseHashAlgorithm(name, &algorithm)) {
+      for (const HashFieldBit& hash : kHashFieldBits) {
+        if (hash.algorithm == algorithm) {
+          request.mask |= hash.bit;
+        }
+      }
+      request.hashes.push_back(algorithm);
+      continue;
+    }
+    if (IsCodeSignerKey(name)) {
+      request.mask |= kSignatureFieldBit;
+      request.signature = true;
+      continue;
+    }
+    const char* version_key = name.c_str();
+    for (size_t i = 0; i < std::size(kStandardStringFields); ++i) {
+      if (name == kStandardStringFields[i].metadata_key) {
+        request.mask |= StandardStringFieldBit(i);
+        version_key = kStandardStringFields[i].version_key;
+        break;
+      }
+    }
+    request.strings.emplace_back(name, version_key);
+  }
+  return request;
+}
+
+// static
+bool MetadataRequest::FromMask(uint32_t mask,
+                               const std::vector<std::string>& custom_keys,
+                               MetadataRequest* request) {
+  if ((mask & ~kAllFieldsMask) != 0) {
+    return false;
+  }
+  MetadataRequest result;
+  result.mask = mask;
+  result.version = (mask & kVersionFieldBit) != 0;
+  for (size_t i = 0; i < std::size(kStandardStringFields); ++i) {
+    if ((mask & StandardStringFieldBit(i)) != 0) {
+      result.strings.emplace_back(kStandardStringFields[i].metadata_key,
+                                  kStandardStringFields[i].version_key);
+    }
+  }
+  for (const std::string& key : custom_keys) {
+    result.strings.emplace_back(key, key);
+  }
+  for (const HashFieldBit& hash : kHashFieldBits) {
+    if ((mask & hash.bit) != 0) {
+      result.hashes.push_back(hash.algorithm);
+    }
+  }
+  result.signature = (mask & kSignatureFieldBit) != 0;
+  *request = std::move(result);
+  return true;
+}
+
+BinaryMetadata ReadBinaryMetadata(const std::string& utf8_path,
+                                  const MetadataRequest& request) {
+  BinaryMetadata metadata;
+  MappedFile file;
+  bool opened;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kFileOpen);
+    opened = file.Open(utf8_path);
+  }
+  if (!opened) {
+    metadata.error = FromMappingError(file.error());
+    return metadata;
+  }
+  return ReadMappedMetadata(file.view(), request);
+}
+
+// static
+MetadataScratch* MetadataScratch::ForCurrentThread() {
+  thread_local MetadataScratch scratch;
+  return &scratch;
+}
+
+MetadataView MetadataScratch::Copy(const BinaryMetadata& metadata) {
+  MetadataView view;
+  view.error = metadata.error;
+  view.bytes_read = metadata.bytes_read;
+  MetadataField* fields =
+      arena_.AllocateArray<MetadataField>(metadata.fields.size());
+  size_t size = 0;
+  for (const auto& [key, value] : metadata.fields) {
+    char* out = arena_.AllocateArray<char>(key.size() + value.size());
+    std::copy(key.begin(), key.end(), out);
+    std::copy(value.begin(), value.end(), out + key.size());
+    fields[size++] = {std::string_view(out, key.size()),
+                      std::string_view(out + key.size(), value.size())};
+  }
+  view.fields = {fields, size};
+  return view;
+}
+
+MetadataView ReadBinaryMetadataView(const std::string& utf8_path,
+                                    const MetadataRequest& request,
+                                    MetadataScratch* scratch) {
+  scratch->arena_.Reset();
+  MetadataView view;
+  MappedFile file;
+  bool opened;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kFileOpen);
+    opened = file.Open(utf8_path);
+  }
+  if (!opened) {
+    view.error = FromMappingError(file.error());
+    return view;
+  }
+
+  if (request.hashes.empty() && !request.signature) {
+    PeImage pe;
+    bool is_pe;
+    {
+      ScopedPhaseTimer timer(PerfPhase::kHeaderParse);
+      is_pe = pe.Parse(file.view());
+    }
+    if (is_pe) {
+      FieldViewWriter writer(&scratch->arena_, request.strings.size() + 1);
+      view.error = ReadVersionFields([&pe] { return pe.FindVersionResource(); },
+                                     request, &scratch->index_, &writer);
+      view.fields = writer.Finish();
+      return view;
+    }
+  }
+  return scratch->Copy(ReadMappedMetadata(file.view(), request));
+}
+
+BinaryMetadata ReadBinaryMetadata(FileHead* file,
+                                  const MetadataRequest& request) {
+  BinaryMetadata metadata;
+  if (file->error() != PositionedFile::Error::kNone) {
+    metadata.error = FromOpenError(file->error());
+    return metadata;
+  }
+  // Version fields of a PE image come out of the head and a read or two
+  // past it; the rest needs the whole file.
+  ByteView head = file->head();
+  bool maybe_pe = head.size >= 2 && LoadLe16(head.data) == kDosSignature;
+  if (maybe_pe && request.hashes.empty() && !request.signature &&
+      ReadPeMetadataBounded(file, request, ReadBudget(), &metadata)) {
+    metadata.bytes_read = 0;
+    return metadata;
+  }
+  MappedFile mapped;
+  if (!mapped.Open(file->file())) {
+    metadata.error = FromMappingError(mapped.error());
+    return metadata;
+  }
+  return ReadMappedMetadata(mapped.view(), request);
+}
+
+BinaryMetadata ReadBinaryMetadataBounded(const std::string& utf8_path,
+                                         const MetadataRequest& request,
+                                         const ReadBudget& budget) {
+  if (!request.hashes.empty() || request.signature) {
+    return ReadBinaryMetadata(utf8_path, request);
+  }
+  BinaryMetadata metadata;
+  PositionedFile file;
+  bool opened;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kFileOpen);
+    opened = file.Open(utf8_path);
+  }
+  if (!opened) {
+    metadata.error = FromOpenError(file.error());
+    return metadata;
+  }
+  if (ReadPeMetadataBounded(&file, request, budget, &metadata)) {
+    return metadata;
+  }
+  file.Close();
+  return ReadBinaryMetadata(utf8_path, request);
+}
+
+BinaryMetadata ReadBinaryMetadataUnmapped(const std::string& utf8_path,
+                                          const MetadataRequest& request,
+                                          const ReadBudget& budget) {
+  BinaryMetadata metadata;
+  PositionedFile file;
+  bool opened;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kFileOpen);
+    opened = file.Open(utf8_path);
+  }
+  if (!opened) {
+    metadata.error = FromOpenError(file.error());
+    return metadata;
+  }
+  if (request.hashes.empty() && !request.signature &&
+      ReadPeMetadataBounded(&file, request, budget, &metadata)) {
+    return metadata;
+  }
+  // The copy is the whole file, so it always gets a byte limit.
+  ReadBudget copy_budget = budget;
+  if (copy_budget.max_bytes == 0) {
+    copy_budget.max_bytes = kDefaultUnmappedByteBudget;
+  }
+  BoundedReader reader(&file, copy_budget);
+  ByteView bytes = reader.Read(0, static_cast<size_t>(file.size()));
+  if (bytes.size != file.size()) {
+    metadata.error = reader.error() != BoundedReader::Error::kNone
+                         ? FromReadError(reader.error())
+                         : MetadataError::kReadFailed;
+    metadata.bytes_read = reader.bytes_read();
+    return metadata;
+  }
+  metadata = ReadMappedMetadata(bytes, request);
+  metadata.bytes_read = reader.bytes_read();
+  return metadata;
+}
+
+bool ReadPeMetadataBounded(RandomAccessSource* source,
+                           const MetadataRequest& request,
+                           const ReadBudget& budget, BinaryMetadata* metadata) {
+  BoundedReader reader(source, budget);
+  PeImage pe;
+  bool is_pe;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kHeaderParse);
+    // The headers and section table almost always fit in the first block.
+    // Otherwise e_lfanew and the file header say how far they reach.
+    ByteView headers = reader.Read(0, BoundedReader::kBlockSize);
+    is_pe = pe.Parse(headers);
+    if (!is_pe && headers.size >= 0x40 &&
+        LoadLe16(headers.data) == kDosSignature) {
+      uint32_t nt_offset = LoadLe32(headers.data + 0x3C);
+      ByteView nt = reader.Read(nt_offset, 24);
+      if (nt.size == 24) {
+        uint64_t end = uint64_t{nt_offset} + 24 + LoadLe16(nt.data + 20) +
+                       uint64_t{LoadLe16(nt.data + 6)} * 40;
+        is_pe = end > headers.size && end <= SIZE_MAX &&
+                pe.Parse(reader.Read(0, static_cast<size_t>(end)));
+      }
+    }
+  }
+  if (!is_pe && reader.error() == BoundedReader::Error::kNone) {
+    return false;
+  }
+
+  BinaryMetadata result;
+  if (is_pe) {
+    ReadVersionFields(
+        [&] {
+          PeImage::ByteSource read = [&reader](size_t offset, size_t length) {
+            return reader.Read(offset, length);
+          };
+          size_t offset = 0;
+          uint32_t size = 0;
+          if (!pe.LocateVersionResource(read, &offset, &size)) {
+            return ByteView();
+          }
+          ByteView blob = reader.Read(offset, size);
+          return blob.size == size ? blob : ByteView();
+        },
+        request, &result);
+  }
+  // Whatever was decoded before the budget ran out is incomplete.
+  if (reader.error() != BoundedReader::Error::kNone) {
+    result = BinaryMetadata();
+    result.error = FromReadError(reader.error());
+  }
+  result.bytes_read = reader.bytes_read();
+  *metadata = std::move(result);
+  return true;
+}
+
+MetadataError ReadBinaryDependencies(const std::string& utf8_path,
+                                     StringPool* pool, Arena* arena,
+                                     PeDependencies* dependencies) {
+  *dependencies = PeDependencies();
+  MappedFile file;
+  if (!file.Open(utf8_path)) {
+    return FromMappingError(file.error());
+  }
+  PeImage pe;
+  if (!pe.Parse(file.view())) {
+    return MetadataError::kUnsupportedFormat;
+  }
+  // Names are copied into the pool, so nothing refers to the mapping once
+  // it is closed.
+  ReadPeDependencies(pe, pool, arena, dependencies);
+  return MetadataError::kNone;
+}
+
+FlatDependencies ReadFlatDependencies(const std::string& utf8_path,
+                                      StringPool* pool) {
+  thread_local Arena arena;
+  arena.Reset();
+  FlatDependencies flat;
+  PeDependencies dependencies;
+  flat.error = ReadBinaryDependencies(utf8_path, pool, &arena, &dependencies);
+  flat.export_name = dependencies.export_name;
+  FlattenImports(dependencies, /*delay_loaded=*/false, &flat.imports);
+  FlattenImports(dependencies, /*delay_loaded=*/true, &flat.delay_imports);
+  flat.exports.assign(dependencies.exports.begin(),
+                      dependencies.exports.end());
+  return flat;
+}
+
+BinaryMetadata ReadInfoPlistFile(const std::string& utf8_path,
+                                 const MetadataRequest& request) {
+  BinaryMetadata metadata;
+  MappedFile file;
+  if (!file.Open(utf8_path)) {
+    metadata.error = FromMappingError(file.error());
+    return metadata;
+  }
+  ReadInfoPlistMetadata(file.view(), request, &metadata);
+  return metadata;
+}
+
+}  // namespace flutter_bin
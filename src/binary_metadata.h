@@ -0,0 +1,244 @@
+#ifndef FLUTTER_BIN_BINARY_METADATA_H_
+#define FLUTTER_BIN_BINARY_METADATA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+#include "bounded_reader.h"
+#include "content_hash.h"
+#include "pe_dependencies.h"
+#include "string_pool.h"
+#include "version_string_index.h"
+
+namespace flutter_bin {
+
+class FileHead;
+
+// Why metadata could not be read. Reported to Dart as an error code string.
+enum class MetadataError {
+  kNone,
+  kFileNotFound,
+  kAccessDenied,
+  kNotAFile,
+  kUnsupportedFormat,
+  kNoVersionInfo,
+  kReadFailed,
+  // A bounded read ran out of its ReadBudget.
+  kBudgetExceeded,
+  kTimedOut,
+};
+
+// Returns the channel error code for |error|, e.g. "FILE_NOT_FOUND".
+const char* MetadataErrorCode(MetadataError error);
+
+// The metadata keys reported to Dart and the version resource keys they are
+// read from, in the order the plugin has always returned them.
+struct StandardStringField {
+  const char* metadata_key;
+  const char* version_key;
+};
+inline constexpr StandardStringField kStandardStringFields[5] = {
+    {"productName", "ProductName"},
+    {"fileDescription", "FileDescription"},
+    {"legalCopyright", "LegalCopyright"},
+    {"originalFilename", "OriginalFilename"},
+    {"companyName", "CompanyName"},
+};
+
+// Metadata key of the formatted VS_FIXEDFILEINFO file version.
+extern const char kVersionKey[];
+
+// Bits of a field mask, the compact form of a MetadataRequest that Dart
+// sends as "fieldMask". The bit of kStandardStringFields[i] is
+// StandardStringFieldBit(i).
+constexpr uint32_t kVersionFieldBit = 1u << 0;
+constexpr uint32_t kSha256FieldBit = 1u << 6;
+constexpr uint32_t kBlake3FieldBit = 1u << 7;
+constexpr uint32_t kAuthenticodeFieldBit = 1u << 8;
+constexpr uint32_t kSignatureFieldBit = 1u << 9;
+
+constexpr uint32_t StandardStringFieldBit(size_t index) {
+  return 1u << (index + 1);
+}
+
+constexpr uint32_t kStandardStringFieldBits = 0x1Fu << 1;
+constexpr uint32_t kStandardFieldMask =
+    kVersionFieldBit | kStandardStringFieldBits;
+constexpr uint32_t kAllFieldsMask = (1u << 10) - 1;
+
+// Selects which metadata fields to decode.
+struct MetadataRequest {
+  // All standard fields plus |custom_keys|, which are reported under their
+  // own name (e.g. "FileVersion").
+  static MetadataRequest Standard(
+      const std::vector<std::string>& custom_keys = {});
+
+  // Only |fields|. Hash algorithm names ("sha256", "blake3",
+  // "authenticode") select digests and any signer key ("signerName", ...)
+  // selects the signer fields; other names that are not standard metadata
+  // keys are treated as custom version resource keys.
+  static MetadataRequest Only(const std::vector<std::string>& fields);
+
+  // The fields whose bits are set in |mask| plus |custom_keys|, as for
+  // Standard(). Returns false if |mask| has a bit outside kAllFieldsMask.
+  static bool FromMask(uint32_t mask,
+                       const std::vector<std::string>& custom_keys,
+                       MetadataRequest* request);
+
+  // Bits of the requested fields that have one; custom keys have none.
+  // Requests whose version fields are one of a few common masks are decoded
+  // by code specialized for that mask at compile time.
+  uint32_t mask = 0;
+  bool version = false;
+  // (metadata key, version resource key) pairs.
+  std::vector<std::pair<std::string, std::string>> strings;
+  // Digests of the file, reported under HashAlgorithmName().
+  std::vector<HashAlgorithm> hashes;
+  // Signer name, issuer, serial and timestamp of the embedded code
+  // signature (see code_signature.h), for PE and Mach-O files.
+  bool signature = false;
+};
+
+// The outcome of reading one file.
+struct BinaryMetadata {
+  MetadataError error = MetadataError::kNone;
+  std::map<std::string, std::string> fields;
+  // Bytes a bounded read fetched; 0 when the file was mapped instead.
+  uint64_t bytes_read = 0;
+};
+
+// One field of a MetadataView.
+struct MetadataField {
+  std::string_view key;
+  std::string_view value;
+};
+
+// A BinaryMetadata that owns nothing: the fields, sorted by key, point into
+// the MetadataScratch it was read with and stay valid until that scratch
+// reads the next file.
+struct MetadataView {
+  MetadataError error = MetadataError::kNone;
+  ArenaSpan<MetadataField> fields;
+  uint64_t bytes_read = 0;
+};
+
+// Buffers ReadBinaryMetadataView() reuses from one file to the next, so a
+// thread that keeps reading files stops allocating once they have grown to
+// fit. Not thread-safe: use one per thread, e.g. ForCurrentThread().
+class MetadataScratch {
+ public:
+  MetadataScratch() = default;
+
+  // Disallow copy and assign.
+  MetadataScratch(const MetadataScratch&) = delete;
+  MetadataScratch& operator=(const MetadataScratch&) = delete;
+
+  // The calling thread's scratch.
+  static MetadataScratch* ForCurrentThread();
+
+ private:
+  friend MetadataView ReadBinaryMetadataView(const std::string& utf8_path,
+                                             const MetadataRequest& request,
+                                             MetadataScratch* scratch);
+
+  // Copies |metadata| into the arena.
+  MetadataView Copy(const BinaryMetadata& metadata);
+
+  // Holds the strings and field array of the current view.
+  Arena arena_;
+  VersionStringIndex index_;
+};
+
+// Reads the metadata selected by |request| from the PE, ELF or Mach-O binary
+// at |utf8_path|. Requested hashes are computed from the same mapping, even
+// when the format is not recognized; the Authenticode digest is only
+// reported for PE images whose layout it can cover.
+// Safe to call from any number of threads at once.
+BinaryMetadata ReadBinaryMetadata(const std::string& utf8_path,
+                                  const MetadataRequest& request);
+
+// ReadBinaryMetadata() into |scratch|, invalidating the previous view read
+// with it. The version fields of a PE image are decoded straight into the
+// scratch without a heap allocation once it is warm; hashes, the signer and
+// other formats go through ReadBinaryMetadata() and are copied.
+MetadataView ReadBinaryMetadataView(const std::string& utf8_path,
+                                    const MetadataRequest& request,
+                                    MetadataScratch* scratch);
+
+// ReadBinaryMetadata() for a file FileHeadReader has opened: the version
+// fields of a PE image are parsed from its head and a few reads past it,
+// and anything else maps the already open file.
+BinaryMetadata ReadBinaryMetadata(FileHead* file,
+                                  const MetadataRequest& request);
+
+// ReadBinaryMetadata() for slow volumes: the version fields of a PE image
+// are read with a few positioned reads of its headers, section table,
+// resource directory and VS_VERSIONINFO blob, within |budget|, instead of
+// mapping the file. Requests for hashes or the signer need the whole file,
+// and other formats are parsed from a mapping, so those fall back to
+// ReadBinaryMetadata() and ignore the budget.
+BinaryMetadata ReadBinaryMetadataBounded(const std::string& utf8_path,
+                                         const MetadataRequest& request,
+                                         const ReadBudget& budget);
+
+// The most ReadBinaryMetadataUnmapped() copies into memory when |budget|
+// sets no byte limit.
+constexpr uint64_t kDefaultUnmappedByteBudget = 64 * 1024 * 1024;
+
+// ReadBinaryMetadata() for files that may still be written to, e.g. ones a
+// FileWatcher reports: nothing is mapped, so a file truncated during the
+// read comes out short (kReadFailed) instead of faulting the process. PE
+// version fields are read as in ReadBinaryMetadataBounded(); anything else
+// is copied into memory with positioned reads within |budget|, or within
+// kDefaultUnmappedByteBudget if it sets no byte limit, and parsed from
+// there. A larger file is reported as kBudgetExceeded without being read.
+BinaryMetadata ReadBinaryMetadataUnmapped(const std::string& utf8_path,
+                                          const MetadataRequest& request,
+                                          const ReadBudget& budget);
+
+// The bounded read of the PE image in |source|, for the version fields of
+// |request|. Returns false, leaving |metadata| untouched, if |source| holds
+// no PE image.
+bool ReadPeMetadataBounded(RandomAccessSource* source,
+                           const MetadataRequest& request,
+                           const ReadBudget& budget, BinaryMetadata* metadata);
+
+// Reads the imports and exports of the PE image at |utf8_path| into
+// |dependencies|, interning names into |pool| and allocating the lists from
+// |arena| (see pe_dependencies.h). Returns kUnsupportedFormat for anything
+// but a PE image. Safe to call from any number of threads at once as long
+// as each uses its own |arena|.
+MetadataError ReadBinaryDependencies(const std::string& utf8_path,
+                                     StringPool* pool, Arena* arena,
+                                     PeDependencies* dependencies);
+
+// The imports and exports of one file as flat id lists, the form the
+// plugins send to Dart.
+struct FlatDependencies {
+  MetadataError error = MetadataError::kNone;
+  uint32_t export_name = StringPool::kNoString;
+  // [name, function count, function ids...] runs; see FlattenImports().
+  std::vector<int32_t> imports;
+  std::vector<int32_t> delay_imports;
+  std::vector<int32_t> exports;
+};
+
+// ReadBinaryDependencies() with an arena owned by the calling thread and
+// reset for every file, so batch workers reuse the same blocks.
+FlatDependencies ReadFlatDependencies(const std::string& utf8_path,
+                                      StringPool* pool);
+
+// Reads the metadata selected by |request| from the Info.plist of an app
+// bundle at |utf8_path| (e.g. "Example.app/Contents/Info.plist").
+BinaryMetadata ReadInfoPlistFile(const std::string& utf8_path,
+                                 const MetadataRequest& request);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_BINARY_METADATA_H_
@@ -0,0 +1,607 @@
+#include "blake3.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <vector>
+
+#include "cpu_features.h"
+#include "thread_pool.h"
+
+#if defined(FLUTTER_BIN_X86)
+#include <immintrin.h>
+#endif
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr size_t kBlockSize = 64;
+constexpr size_t kChunkSize = 1024;
+constexpr size_t kBlocksPerChunk = kChunkSize / kBlockSize;
+constexpr size_t kCvSize = 32;
+
+enum : uint8_t {
+  kChunkStart = 1 << 0,
+  kChunkEnd = 1 << 1,
+  kParent = 1 << 2,
+  kRoot = 1 << 3,
+};
+
+constexpr uint32_t kIv[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+// Message word order for each of the seven rounds.
+constexpr uint8_t kSchedule[7][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+    {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+    {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+    {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+    {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+    {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+};
+
+// Whole chunks hashed and joined into one subtree before it goes on the
+// chaining value stack; enough to fill every lane of the widest kernel.
+constexpr size_t kBatchChunks = 16;
+
+// Inputs are only split across the pool in pieces of at least this many
+// chunks, so that waking the workers pays off.
+constexpr size_t kMinPieceChunks = 256;
+
+inline uint32_t RotateRight(uint32_t value, int bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+inline void Mix(uint32_t v[16], int a, int b, int c, int d, uint32_t x,
+                uint32_t y) {
+  v[a] = v[a] + v[b] + x;
+  v[d] = RotateRight(v[d] ^ v[a], 16);
+  v[c] = v[c] + v[d];
+  v[b] = RotateRight(v[b] ^ v[c], 12);
+  v[a] = v[a] + v[b] + y;
+  v[d] = RotateRight(v[d] ^ v[a], 8);
+  v[c] = v[c] + v[d];
+  v[b] = RotateRight(v[b] ^ v[c], 7);
+}
+
+// Compresses one block into |cv| in place.
+void CompressPortable(uint32_t cv[8], const uint8_t block[kBlockSize],
+                      uint32_t block_size, uint64_t counter, uint8_t flags) {
+  uint32_t m[16];
+  for (int i = 0; i < 16; ++i) {
+    m[i] = LoadLe32(block + 4 * i);
+  }
+  uint32_t v[16] = {
+      cv[0],    cv[1],    cv[2],    cv[3],
+      cv[4],    cv[5],    cv[6],    cv[7],
+      kIv[0],   kIv[1],   kIv[2],   kIv[3],
+      static_cast<uint32_t>(counter),
+      static_cast<uint32_t>(counter >> 32),
+      block_size, flags,
+  };
+  for (const uint8_t* s : kSchedule) {
+    Mix(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+    Mix(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+    Mix(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+    Mix(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+    Mix(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+    Mix(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+    Mix(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+    Mix(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+  }
+  for (int i = 0; i < 8; ++i) {
+    cv[i] = v[i] ^ v[i + 8];
+  }
+}
+
+void StoreCv(const uint32_t cv[8], uint8_t out[kCvSize]) {
+  for (int i = 0; i < 8; ++i) {
+    out[4 * i] = static_cast<uint8_t>(cv[i]);
+    out[4 * i + 1] = static_cast<uint8_t>(cv[i] >> 8);
+    out[4 * i + 2] = static_cast<uint8_t>(cv[i] >> 16);
+    out[4 * i + 3] = static_cast<uint8_t>(cv[i] >> 24);
+  }
+}
+
+// The arguments shared by every HashMany() implementation: each input is
+// |blocks| whole blocks, the first compressed with |flags_start| and the
+// last with |flags_end| added to |flags|. Input i uses |counter| + i when
+// |increment_counter| is set (chunks) and |counter| otherwise (parents).
+struct HashManyParams {
+  size_t blocks;
+  uint64_t counter;
+  bool increment_counter;
+  uint8_t flags;
+  uint8_t flags_start;
+  uint8_t flags_end;
+};
+
+void HashManyPortable(const uint8_t* const* inputs, size_t count,
+                      const HashManyParams& params, uint8_t* out) {
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t cv[8];
+    std::memcpy(cv, kIv, sizeof(cv));
+    uint64_t counter = params.counter + (params.increment_counter ? i : 0);
+    uint8_t flags = params.flags | params.flags_start;
+    for (size_t block = 0; block < params.blocks; ++block) {
+      if (block + 1 == params.blocks) {
+        flags |= params.flags_end;
+      }
+      CompressPortable(cv, inputs[i] + block * kBlockSize, kBlockSize,
+                       counter, flags);
+      flags = params.flags;
+    }
+    StoreCv(cv, out + i * kCvSize);
+  }
+}
+
+#if defined(FLUTTER_BIN_X86)
+
+// The SIMD kernels keep word j of every lane's state in vector j, so one
+// instruction advances 4 (SSE4.1) or 8 (AVX2) inputs at once.
+
+FLUTTER_BIN_TARGET("sse4.1")
+inline __m128i Rotate16(__m128i x) {
+  return _mm_shuffle_epi8(
+      x, _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+}
+
+FLUTTER_BIN_TARGET("sse4.1")
+inline __m128i Rotate8(__m128i x) {
+  return _mm_shuffle_epi8(
+      x, _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12));
+}
+
+FLUTTER_BIN_TARGET("sse4.1")
+inline void Mix(__m128i v[16], int a, int b, int c, int d, __m128i x,
+                __m128i y) {
+  v[a] = _mm_add_epi32(_mm_add_epi32(v[a], v[b]), x);
+  v[d] = Rotate16(_mm_xor_si128(v[d], v[a]));
+  v[c] = _mm_add_epi32(v[c], v[d]);
+  v[b] = _mm_xor_si128(v[b], v[c]);
+  v[b] = _mm_or_si128(_mm_srli_epi32(v[b], 12), _mm_slli_epi32(v[b], 20));
+  v[a] = _mm_add_epi32(_mm_add_epi32(v[a], v[b]), y);
+  v[d] = Rotate8(_mm_xor_si128(v[d], v[a]));
+  v[c] = _mm_add_epi32(v[c], v[d]);
+  v[b] = _mm_xor_si128(v[b], v[c]);
+  v[b] = _mm_or_si128(_mm_srli_epi32(v[b], 7), _mm_slli_epi32(v[b], 25));
+}
+
+FLUTTER_BIN_TARGET("sse4.1")
+inline void Transpose(__m128i* a, __m128i* b, __m128i* c, __m128i* d) {
+  __m128i ab_01 = _mm_unpacklo_epi32(*a, *b);
+  __m128i ab_23 = _mm_unpackhi_epi32(*a, *b);
+  __m128i cd_01 = _mm_unpacklo_epi32(*c, *d);
+  __m128i cd_23 = _mm_unpackhi_epi32(*c, *d);
+  *a = _mm_unpacklo_epi64(ab_01, cd_01);
+  *b = _mm_unpackhi_epi64(ab_01, cd_01);
+  *c = _mm_unpacklo_epi64(ab_23, cd_23);
+  *d = _mm_unpackhi_epi64(ab_23, cd_23);
+}
+
+FLUTTER_BIN_TARGET("sse4.1")
+void HashFourSse41(const uint8_t* const* inputs, const HashManyParams& params,
+                   uint8_t* out) {
+  __m128i h[8];
+  for (int i = 0; i < 8; ++i) {
+    h[i] = _mm_set1_epi32(static_cast<int>(kIv[i]));
+  }
+  uint32_t counter_low[4];
+  uint32_t counter_high[4];
+  for (int lane = 0; lane < 4; ++lane) {
+    uint64_t counter =
+        params.counter + (params.increment_counter ? lane : 0);
+    counter_low[lane] = static_cast<uint32_t>(counter);
+    counter_high[lane] = static_cast<uint32_t>(counter >> 32);
+  }
+
+  uint8_t flags = params.flags | params.flags_start;
+  for (size_t block = 0; block < params.blocks; ++block) {
+    if (block + 1 == params.blocks) {
+      flags |= params.flags_end;
+    }
+    __m128i m[16];
+    for (int group = 0; group < 4; ++group) {
+      for (int lane = 0; lane < 4; ++lane) {
+        m[4 * group + lane] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+            inputs[lane] + block * kBlockSize + 16 * group));
+      }
+      Transpose(&m[4 * group], &m[4 * group + 1], &m[4 * group + 2],
+                &m[4 * group + 3]);
+    }
+
+    __m128i v[16] = {
+        h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+        _mm_set1_epi32(static_cast<int>(kIv[0])),
+        _mm_set1_epi32(static_cast<int>(kIv[1])),
+        _mm_set1_epi32(static_cast<int>(kIv[2])),
+        _mm_set1_epi32(static_cast<int>(kIv[3])),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(counter_low)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(counter_high)),
+        _mm_set1_epi32(static_cast<int>(kBlockSize)),
+        _mm_set1_epi32(flags),
+    };
+    for (const uint8_t* s : kSchedule) {
+      Mix(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+      Mix(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+      Mix(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+      Mix(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+      Mix(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+      Mix(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+      Mix(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+      Mix(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+    for (int i = 0; i < 8; ++i) {
+      h[i] = _mm_xor_si128(v[i], v[i + 8]);
+    }
+    flags = params.flags;
+  }
+
+  Transpose(&h[0], &h[1], &h[2], &h[3]);
+  Transpose(&h[4], &h[5], &h[6], &h[7]);
+  for (int lane = 0; lane < 4; ++lane) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + lane * kCvSize),
+                     h[lane]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + lane * kCvSize + 16),
+                     h[4 + lane]);
+  }
+}
+
+FLUTTER_BIN_TARGET("avx2")
+inline __m256i Rotate16(__m256i x) {
+  return _mm256_shuffle_epi8(
+      x, _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12,
+                          13, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15,
+                          12, 13));
+}
+
+FLUTTER_BIN_TARGET("avx2")
+inline __m256i Rotate8(__m256i x) {
+  return _mm256_shuffle_epi8(
+      x, _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15,
+                          12, 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14,
+                          15, 12));
+}
+
+FLUTTER_BIN_TARGET("avx2")
+inline void Mix(__m256i v[16], int a, int b, int c, int d, __m256i x,
+                __m256i y) {
+  v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), x);
+  v[d] = Rotate16(_mm256_xor_si256(v[d], v[a]));
+  v[c] = _mm256_add_epi32(v[c], v[d]);
+  v[b] = _mm256_xor_si256(v[b], v[c]);
+  v[b] = _mm256_or_si256(_mm256_srli_epi32(v[b], 12),
+                         _mm256_slli_epi32(v[b], 20));
+  v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), y);
+  v[d] = Rotate8(_mm256_xor_si256(v[d], v[a]));
+  v[c] = _mm256_add_epi32(v[c], v[d]);
+  v[b] = _mm256_xor_si256(v[b], v[c]);
+  v[b] = _mm256_or_si256(_mm256_srli_epi32(v[b], 7),
+                         _mm256_slli_epi32(v[b], 25));
+}
+
+// Turns eight rows of eight words into eight columns.
+FLUTTER_BIN_TARGET("avx2")
+inline void Transpose(__m256i v[8]) {
+  __m256i ab_0145 = _mm256_unpacklo_epi32(v[0], v[1]);
+  __m256i ab_2367 = _mm256_unpackhi_epi32(v[0], v[1]);
+  __m256i cd_0145 = _mm256_unpacklo_epi32(v[2], v[3]);
+  __m256i cd_2367 = _mm256_unpackhi_epi32(v[2], v[3]);
+  __m256i ef_0145 = _mm256_unpacklo_epi32(v[4], v[5]);
+  __m256i ef_2367 = _mm256_unpackhi_epi32(v[4], v[5]);
+  __m256i gh_0145 = _mm256_unpacklo_epi32(v[6], v[7]);
+  __m256i gh_2367 = _mm256_unpackhi_epi32(v[6], v[7]);
+  __m256i abcd_04 = _mm256_unpacklo_epi64(ab_0145, cd_0145);
+  __m256i abcd_15 = _mm256_unpackhi_epi64(ab_0145, cd_0145);
+  __m256i abcd_26 = _mm256_unpacklo_epi64(ab_2367, cd_2367);
+  __m256i abcd_37 = _mm256_unpackhi_epi64(ab_2367, cd_2367);
+  __m256i efgh_04 = _mm256_unpacklo_epi64(ef_0145, gh_0145);
+  __m256i efgh_15 = _mm256_unpackhi_epi64(ef_0145, gh_0145);
+  __m256i efgh_26 = _mm256_unpacklo_epi64(ef_2367, gh_2367);
+  __m256i efgh_37 = _mm256_unpackhi_epi64(ef_2367, gh_2367);
+  v[0] = _mm256_permute2x128_si256(abcd_04, efgh_04, 0x20);
+  v[1] = _mm256_permute2x128_si256(abcd_15, efgh_15, 0x20);
+  v[2] = _mm256_permute2x128_si256(abcd_26, efgh_26, 0x20);
+  v[3] = _mm256_permute2x128_si256(abcd_37, efgh_37, 0x20);
+  v[4] = _mm256_permute2x128_si256(abcd_04, efgh_04, 0x31);
+  v[5] = _mm256_permute2x128_si256(abcd_15, efgh_15, 0x31);
+  v[6] = _mm256_permute2x128_si256(abcd_26, efgh_26, 0x31);
+  v[7] = _mm256_permute2x128_si256(abcd_37, efgh_37, 0x31);
+}
+
+FLUTTER_BIN_TARGET("avx2")
+void HashEightAvx2(const uint8_t* const* inputs, const HashManyParams& params,
+                   uint8_t* out) {
+  __m256i h[8];
+  for (int i = 0; i < 8; ++i) {
+    h[i] = _mm256_set1_epi32(static_cast<int>(kIv[i]));
+  }
+  uint32_t counter_low[8];
+  uint32_t counter_high[8];
+  for (int lane = 0; lane < 8; ++lane) {
+    uint64_t counter =
+        params.counter + (params.increment_counter ? lane : 0);
+    counter_low[lane] = static_cast<uint32_t>(counter);
+    counter_high[lane] = static_cast<uint32_t>(counter >> 32);
+  }
+
+  uint8_t flags = params.flags | params.flags_start;
+  for (size_t block = 0; block < params.blocks; ++block) {
+    if (block + 1 == params.blocks) {
+      flags |= params.flags_end;
+    }
+    __m256i m[16];
+    for (int lane = 0; lane < 8; ++lane) {
+      const uint8_t* p = inputs[lane] + block * kBlockSize;
+      m[lane] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      m[8 + lane] =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    }
+    Transpose(m);
+    Transpose(m + 8);
+
+    __m256i v[16] = {
+        h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+        _mm256_set1_epi32(static_cast<int>(kIv[0])),
+        _mm256_set1_epi32(static_cast<int>(kIv[1])),
+        _mm256_set1_epi32(static_cast<int>(kIv[2])),
+        _mm256_set1_epi32(static_cast<int>(kIv[3])),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counter_low)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counter_high)),
+        _mm256_set1_epi32(static_cast<int>(kBlockSize)),
+        _mm256_set1_epi32(flags),
+    };
+    for (const uint8_t* s : kSchedule) {
+      Mix(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+      Mix(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+      Mix(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+      Mix(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+      Mix(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+      Mix(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+      Mix(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+      Mix(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+    for (int i = 0; i < 8; ++i) {
+      h[i] = _mm256_xor_si256(v[i], v[i + 8]);
+    }
+    flags = params.flags;
+  }
+
+  Transpose(h);
+  for (int lane = 0; lane < 8; ++lane) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + lane * kCvSize),
+                        h[lane]);
+  }
+}
+
+#endif  // FLUTTER_BIN_X86
+
+// Hashes |count| equally long inputs into |count| chaining values, as many
+// at a time as |kernel| has lanes.
+void HashMany(Blake3Kernel kernel, const uint8_t* const* inputs, size_t count,
+              HashManyParams params, uint8_t* out) {
+#if defined(FLUTTER_BIN_X86)
+  size_t step = params.increment_counter ? 1 : 0;
+  if (kernel == Blake3Kernel::kAvx2) {
+    for (; count >= 8; count -= 8, inputs += 8, out += 8 * kCvSize) {
+      HashEightAvx2(inputs, params, out);
+      params.counter += 8 * step;
+    }
+  }
+  if (kernel == Blake3Kernel::kAvx2 || kernel == Blake3Kernel::kSse41) {
+    for (; count >= 4; count -= 4, inputs += 4, out += 4 * kCvSize) {
+      HashFourSse41(inputs, params, out);
+      params.counter += 4 * step;
+    }
+  }
+#else
+  (void)kernel;
+#endif
+  HashManyPortable(inputs, count, params, out);
+}
+
+// Hashes one chunk of up to kChunkSize bytes, the last of which may be
+// partial or (for empty input) missing.
+void HashChunk(const uint8_t* input, size_t size, uint64_t counter,
+               uint8_t extra_flags, uint8_t out[kCvSize]) {
+  uint32_t cv[8];
+  std::memcpy(cv, kIv, sizeof(cv));
+  size_t blocks = std::max<size_t>((size + kBlockSize - 1) / kBlockSize, 1);
+  uint8_t flags = kChunkStart;
+  for (size_t block = 0; block < blocks; ++block) {
+    uint8_t padded[kBlockSize] = {};
+    size_t block_size = std::min(size - block * kBlockSize, kBlockSize);
+    if (block_size > 0) {
+      std::memcpy(padded, input + block * kBlockSize, block_size);
+    }
+    if (block + 1 == blocks) {
+      flags |= kChunkEnd | extra_flags;
+    }
+    CompressPortable(cv, padded, static_cast<uint32_t>(block_size), counter,
+                     flags);
+    flags = 0;
+  }
+  StoreCv(cv, out);
+}
+
+void HashParent(const uint8_t left[kCvSize], const uint8_t right[kCvSize],
+                uint8_t extra_flags, uint8_t out[kCvSize]) {
+  uint8_t block[kBlockSize];
+  std::memcpy(block, left, kCvSize);
+  std::memcpy(block + kCvSize, right, kCvSize);
+  uint32_t cv[8];
+  std::memcpy(cv, kIv, sizeof(cv));
+  CompressPortable(cv, block, kBlockSize, 0, kParent | extra_flags);
+  StoreCv(cv, out);
+}
+
+// The chaining values of the complete subtrees seen so far, largest first.
+// Subtrees are only joined once the next one arrives, so that the last join
+// can be flagged as the root.
+class CvStack {
+ public:
+  // Pushes the chaining value of a subtree that starts |chunks_before|
+  // chunks into the input.
+  void Push(const uint8_t cv[kCvSize], uint64_t chunks_before) {
+    size_t complete = std::bitset<64>(chunks_before).count();
+    while (size_ > complete) {
+      HashParent(cvs_[size_ - 2], cvs_[size_ - 1], 0, cvs_[size_ - 2]);
+      --size_;
+    }
+    std::memcpy(cvs_[size_++], cv, kCvSize);
+  }
+
+  // Joins everything pushed into one chaining value, adding |flags| to the
+  // last join. At least two values must have been pushed if |flags| is
+  // kRoot.
+  void Finish(uint8_t flags, uint8_t out[kCvSize]) const {
+    std::memcpy(out, cvs_[size_ - 1], kCvSize);
+    for (size_t i = size_ - 1; i-- > 0;) {
+      HashParent(cvs_[i], out, i == 0 ? flags : 0, out);
+    }
+  }
+
+ private:
+  // Enough for 2^54 chunks.
+  uint8_t cvs_[54][kCvSize];
+  size_t size_ = 0;
+};
+
+// Hashes kBatchChunks whole chunks into the chaining value of their subtree.
+void HashBatch(Blake3Kernel kernel, const uint8_t* input, uint64_t counter,
+               uint8_t out[kCvSize]) {
+  const uint8_t* inputs[kBatchChunks];
+  uint8_t cvs[kBatchChunks * kCvSize];
+  for (size_t i = 0; i < kBatchChunks; ++i) {
+    inputs[i] = input + i * kChunkSize;
+  }
+  HashMany(kernel, inputs, kBatchChunks,
+           {kBlocksPerChunk, counter, true, 0, kChunkStart, kChunkEnd}, cvs);
+
+  // Each parent only reads the slots at or after its own.
+  for (size_t count = kBatchChunks / 2; count > 0; count /= 2) {
+    for (size_t i = 0; i < count; ++i) {
+      inputs[i] = cvs + 2 * i * kCvSize;
+    }
+    HashMany(kernel, inputs, count, {1, 0, false, kParent, 0, 0}, cvs);
+  }
+  std::memcpy(out, cvs, kCvSize);
+}
+
+// Pushes the chunks of |input|, which starts at chunk |counter|, onto
+// |stack|.
+void HashRegion(Blake3Kernel kernel, ByteView input, uint64_t counter,
+                CvStack* stack) {
+  size_t done = 0;
+  uint8_t cv[kCvSize];
+  // Batches followed by more input can never be the root.
+  while ((done + kBatchChunks) * kChunkSize < input.size) {
+    HashBatch(kernel, input.data + done * kChunkSize, counter + done, cv);
+    stack->Push(cv, done);
+    done += kBatchChunks;
+  }
+
+  size_t rest = input.size - done * kChunkSize;
+  size_t whole = rest / kChunkSize;
+  if (whole > 0) {
+    const uint8_t* inputs[kBatchChunks];
+    uint8_t cvs[kBatchChunks * kCvSize];
+    for (size_t i = 0; i < whole; ++i) {
+      inputs[i] = input.data + (done + i) * kChunkSize;
+    }
+    HashMany(kernel, inputs, whole,
+             {kBlocksPerChunk, counter + done, true, 0, kChunkStart,
+              kChunkEnd},
+             cvs);
+    for (size_t i = 0; i < whole; ++i) {
+      stack->Push(cvs + i * kCvSize, done + i);
+    }
+    done += whole;
+  }
+  if (rest % kChunkSize != 0) {
+    HashChunk(input.data + done * kChunkSize, rest % kChunkSize,
+              counter + done, 0, cv);
+    stack->Push(cv, done);
+  }
+}
+
+}  // namespace
+
+bool Blake3KernelSupported(Blake3Kernel kernel) {
+  switch (kernel) {
+    case Blake3Kernel::kPortable:
+      return true;
+    case Blake3Kernel::kSse41:
+      return GetCpuFeatures().sse41;
+    case Blake3Kernel::kAvx2:
+      return GetCpuFeatures().avx2;
+  }
+  return false;
+}
+
+Blake3Kernel DefaultBlake3Kernel() {
+  static const Blake3Kernel kernel =
+      Blake3KernelSupported(Blake3Kernel::kAvx2)    ? Blake3Kernel::kAvx2
+      : Blake3KernelSupported(Blake3Kernel::kSse41) ? Blake3Kernel::kSse41
+                                                    : Blake3Kernel::kPortable;
+  return kernel;
+}
+
+const char* Blake3KernelName(Blake3Kernel kernel) {
+  switch (kernel) {
+    case Blake3Kernel::kPortable:
+      return "portable";
+    case Blake3Kernel::kSse41:
+      return "sse4.1";
+    case Blake3Kernel::kAvx2:
+      return "avx2";
+  }
+  return "";
+}
+
+Blake3Digest Blake3(ByteView data, ThreadPool* pool, Blake3Kernel kernel) {
+  Blake3Digest digest;
+  if (data.size <= kChunkSize) {
+    HashChunk(data.data, data.size, 0, kRoot, digest.data());
+    return digest;
+  }
+
+  // Pieces of a power-of-two number of chunks are complete subtrees (the
+  // last may be smaller), so they can be hashed independently and joined.
+  size_t chunks = (data.size + kChunkSize - 1) / kChunkSize;
+  size_t piece_chunks = kMinPieceChunks;
+  if (pool != nullptr) {
+    while (piece_chunks * 2 * pool->thread_count() * 4 <= chunks) {
+      piece_chunks *= 2;
+    }
+  }
+  size_t pieces = (chunks + piece_chunks - 1) / piece_chunks;
+  CvStack stack;
+  if (pool == nullptr || pieces < 2) {
+    HashRegion(kernel, data, 0, &stack);
+    stack.Finish(kRoot, digest.data());
+    return digest;
+  }
+
+  std::vector<uint8_t> piece_cvs(pieces * kCvSize);
+  size_t piece_size = piece_chunks * kChunkSize;
+  pool->ParallelFor(pieces, [&](size_t i) {
+    size_t offset = i * piece_size;
+    CvStack piece_stack;
+    HashRegion(kernel,
+               data.Sub(offset, std::min(piece_size, data.size - offset)),
+               i * piece_chunks, &piece_stack);
+    piece_stack.Finish(0, piece_cvs.data() + i * kCvSize);
+  });
+  for (size_t i = 0; i < pieces; ++i) {
+    stack.Push(piece_cvs.data() + i * kCvSize, i * piece_chunks);
+  }
+  stack.Finish(kRoot, digest.data());
+  return digest;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,40 @@
+#ifndef FLUTTER_BIN_BLAKE3_H_
+#define FLUTTER_BIN_BLAKE3_H_
+
+#include <array>
+#include <cstdint>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+class ThreadPool;
+
+using Blake3Digest = std::array<uint8_t, 32>;
+
+// Implementations of the compression function, slowest first. The SIMD
+// kernels hash 4 or 8 chunks (or parent nodes) side by side, one per lane.
+enum class Blake3Kernel {
+  kPortable,
+  kSse41,
+  kAvx2,
+};
+
+// Whether |kernel| can run on this CPU.
+bool Blake3KernelSupported(Blake3Kernel kernel);
+
+// The fastest supported kernel; what Blake3() uses unless told otherwise.
+Blake3Kernel DefaultBlake3Kernel();
+
+// e.g. "portable", "avx2".
+const char* Blake3KernelName(Blake3Kernel kernel);
+
+// The 256-bit BLAKE3 hash of |data|. Large inputs are cut into subtrees of
+// whole chunks that are hashed on |pool|, when given, and then joined; the
+// result is the same either way. |kernel| must be supported.
+Blake3Digest Blake3(ByteView data, ThreadPool* pool = nullptr,
+                    Blake3Kernel kernel = DefaultBlake3Kernel());
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_BLAKE3_H_
@@ -0,0 +1,76 @@
+#include "bounded_reader.h"
+
+#include <algorithm>
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr uint64_t kBlockMask = BoundedReader::kBlockSize - 1;
+
+}  // namespace
+
+BoundedReader::BoundedReader(RandomAccessSource* source,
+                             const ReadBudget& budget)
+    : source_(source),
+      size_(source->size()),
+      max_bytes_(budget.max_bytes),
+      has_deadline_(budget.timeout.count() > 0),
+      deadline_(std::chrono::steady_clock::now() + budget.timeout),
+      // Most files need two or three blocks; keep them in one allocation.
+      arena_(4 * kBlockSize) {}
+
+ByteView BoundedReader::Read(uint64_t offset, size_t length) {
+  if (error_ != Error::kNone || offset >= size_ || length == 0) {
+    return ByteView();
+  }
+  length = static_cast<size_t>(std::min<uint64_t>(length, size_ - offset));
+
+  for (const Extent& extent : extents_) {
+    if (offset >= extent.offset &&
+        extent.bytes.Contains(static_cast<size_t>(offset - extent.offset),
+                              length)) {
+      return extent.bytes.Sub(static_cast<size_t>(offset - extent.offset),
+                              length);
+    }
+  }
+
+  // Widen to whole blocks unless that alone would break the budget.
+  uint64_t start = offset & ~kBlockMask;
+  uint64_t end = std::min(((offset + length) + kBlockMask) & ~kBlockMask,
+                          size_);
+  if (max_bytes_ != 0 && bytes_read_ + (end - start) > max_bytes_) {
+    start = offset;
+    end = offset + length;
+  }
+  ByteView bytes;
+  if (!Fetch(start, static_cast<size_t>(end - start), &bytes)) {
+    return ByteView();
+  }
+  return bytes.Sub(static_cast<size_t>(offset - start), length);
+}
+
+bool BoundedReader::Fetch(uint64_t offset, size_t length, ByteView* bytes) {
+  if (max_bytes_ != 0 && bytes_read_ + length > max_bytes_) {
+    error_ = Error::kBudgetExceeded;
+    return false;
+  }
+  if (has_deadline_ && std::chrono::steady_clock::now() >= deadline_) {
+    error_ = Error::kTimedOut;
+    return false;
+  }
+  uint8_t* buffer = static_cast<uint8_t*>(arena_.Allocate(length, 1));
+  size_t read = 0;
+  if (buffer == nullptr || !source_->ReadAt(offset, buffer, length, &read)) {
+    error_ = Error::kReadFailed;
+    return false;
+  }
+  ++read_count_;
+  bytes_read_ += read;
+  // A short read means the file shrank under us; keep what arrived.
+  *bytes = ByteView(buffer, read);
+  extents_.push_back({offset, *bytes});
+  return true;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,86 @@
+#ifndef FLUTTER_BIN_BOUNDED_READER_H_
+#define FLUTTER_BIN_BOUNDED_READER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "arena.h"
+#include "byte_view.h"
+#include "positioned_file.h"
+
+namespace flutter_bin {
+
+// Limits on what reading one file may cost.
+struct ReadBudget {
+  // Most bytes to read, 0 for no limit.
+  uint64_t max_bytes = 0;
+  // How long to keep reading, 0 for no limit. Checked before every read; a
+  // read that is already blocked is not interrupted.
+  std::chrono::milliseconds timeout{0};
+};
+
+// Reads ranges of a RandomAccessSource on demand, within a ReadBudget.
+//
+// Reads are widened to whole blocks so that the small, neighbouring ranges
+// a parser asks for (a directory, then its entries) cost one request, and
+// every block read is kept for the reader's lifetime so the returned views
+// stay valid and are never fetched twice. Once the budget runs out or a
+// read fails, every further Read() returns an empty view and error() says
+// why. Not thread-safe.
+class BoundedReader {
+ public:
+  enum class Error {
+    kNone,
+    kReadFailed,
+    kBudgetExceeded,
+    kTimedOut,
+  };
+
+  static constexpr size_t kBlockSize = 4096;
+
+  // |source| must outlive the reader.
+  BoundedReader(RandomAccessSource* source, const ReadBudget& budget);
+
+  // Disallow copy and assign.
+  BoundedReader(const BoundedReader&) = delete;
+  BoundedReader& operator=(const BoundedReader&) = delete;
+
+  // Returns the bytes of [offset, offset + length) that lie in the file:
+  // fewer at its end, none past it or once the reader has failed.
+  ByteView Read(uint64_t offset, size_t length);
+
+  uint64_t size() const { return size_; }
+  Error error() const { return error_; }
+
+  // Bytes fetched from the source so far, and in how many requests.
+  uint64_t bytes_read() const { return bytes_read_; }
+  size_t read_count() const { return read_count_; }
+
+ private:
+  // One range fetched from the source.
+  struct Extent {
+    uint64_t offset;
+    ByteView bytes;
+  };
+
+  // Fetches [offset, offset + length), which lies in the file.
+  bool Fetch(uint64_t offset, size_t length, ByteView* bytes);
+
+  RandomAccessSource* const source_;
+  const uint64_t size_;
+  const uint64_t max_bytes_;
+  const bool has_deadline_;
+  const std::chrono::steady_clock::time_point deadline_;
+
+  Arena arena_;
+  std::vector<Extent> extents_;
+  uint64_t bytes_read_ = 0;
+  size_t read_count_ = 0;
+  Error error_ = Error::kNone;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_BOUNDED_READER_H_
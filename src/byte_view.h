@@ -0,0 +1,92 @@
+#ifndef FLUTTER_BIN_BYTE_VIEW_H_
+#define FLUTTER_BIN_BYTE_VIEW_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter_bin {
+
+// A non-owning, bounds-checked window into a byte buffer (usually a file
+// mapping). Binary formats parsed by the plugin are read through these views
+// so that nothing is copied out of the mapping until a caller asks for it.
+struct ByteView {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+
+  ByteView() = default;
+  ByteView(const uint8_t* view_data, size_t view_size)
+      : data(view_data), size(view_size) {}
+
+  bool empty() const { return size == 0; }
+
+  // Returns true if [offset, offset + length) lies inside the view.
+  bool Contains(size_t offset, size_t length) const {
+    return offset <= size && length <= size - offset;
+  }
+
+  // Returns the sub-view [offset, offset + length), or an empty view when the
+  // range is out of bounds.
+  ByteView Sub(size_t offset, size_t length) const {
+    if (!Contains(offset, length)) {
+      return ByteView();
+    }
+    return ByteView(data + offset, length);
+  }
+
+  // Returns everything from |offset| to the end of the view.
+  ByteView From(size_t offset) const {
+    if (offset > size) {
+      return ByteView();
+    }
+    return ByteView(data + offset, size - offset);
+  }
+};
+
+// Little-endian loads that are safe on unaligned addresses.
+inline uint16_t LoadLe16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t LoadLe32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t LoadLe64(const uint8_t* p) {
+  return static_cast<uint64_t>(LoadLe32(p)) |
+         (static_cast<uint64_t>(LoadLe32(p + 4)) << 32);
+}
+
+// Big-endian counterparts, for ELF and Mach-O files of big-endian targets.
+inline uint16_t LoadBe16(const uint8_t* p) {
+  return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline uint32_t LoadBe32(const uint8_t* p) {
+  return (static_cast<uint32_t>(p[0]) << 24) |
+         (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline uint64_t LoadBe64(const uint8_t* p) {
+  return (static_cast<uint64_t>(LoadBe32(p)) << 32) |
+         static_cast<uint64_t>(LoadBe32(p + 4));
+}
+
+// Little-endian store, for the buffers the plugins hand to Dart.
+inline void StoreLe32(uint8_t* p, uint32_t value) {
+  p[0] = static_cast<uint8_t>(value);
+  p[1] = static_cast<uint8_t>(value >> 8);
+  p[2] = static_cast<uint8_t>(value >> 16);
+  p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+// Rounds |value| up to the next multiple of four.
+inline size_t AlignUp4(size_t value) {
+  return (value + 3) & ~static_cast<size_t>(3);
+}
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_BYTE_VIEW_H_
@@ -0,0 +1,516 @@
+#include "code_signature.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "content_hash.h"
+#include "unicode.h"
+
+namespace flutter_bin {
+
+const char kSignerNameKey[] = "signerName";
+const char kSignerIssuerKey[] = "signerIssuer";
+const char kSignerSerialKey[] = "signerSerial";
+const char kSigningTimeKey[] = "signingTime";
+
+namespace {
+
+// 1.2.840.113549.1.7.2
+constexpr uint8_t kOidSignedData[] = {0x2A, 0x86, 0x48, 0x86, 0xF7,
+                                      0x0D, 0x01, 0x07, 0x02};
+// 1.2.840.113549.1.9.5
+constexpr uint8_t kOidSigningTime[] = {0x2A, 0x86, 0x48, 0x86, 0xF7,
+                                       0x0D, 0x01, 0x09, 0x05};
+// 1.2.840.113549.1.9.6
+constexpr uint8_t kOidCountersignature[] = {0x2A, 0x86, 0x48, 0x86, 0xF7,
+                                            0x0D, 0x01, 0x09, 0x06};
+// 1.2.840.113549.1.9.16.2.14, CMS id-aa-timeStampToken.
+constexpr uint8_t kOidTimeStampToken[] = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D,
+                                          0x01, 0x09, 0x10, 0x02, 0x0E};
+// 1.3.6.1.4.1.311.3.3.1, where Authenticode keeps RFC 3161 timestamps.
+constexpr uint8_t kOidMsTimeStampToken[] = {0x2B, 0x06, 0x01, 0x04, 0x01,
+                                            0x82, 0x37, 0x03, 0x03, 0x01};
+
+// X.520 attribute types, 2.5.4.x, with their RFC 4514 short names.
+constexpr uint8_t kOidCommonName[] = {0x55, 0x04, 0x03};
+struct NameAttribute {
+  uint8_t oid[3];
+  const char* short_name;
+};
+constexpr NameAttribute kNameAttributes[] = {
+    {{0x55, 0x04, 0x03}, "CN"}, {{0x55, 0x04, 0x06}, "C"},
+    {{0x55, 0x04, 0x07}, "L"},  {{0x55, 0x04, 0x08}, "ST"},
+    {{0x55, 0x04, 0x0A}, "O"},  {{0x55, 0x04, 0x0B}, "OU"},
+};
+
+constexpr uint16_t kWinCertificateTypePkcsSignedData = 0x0002;
+constexpr size_t kWinCertificateHeaderSize = 8;
+
+// CSMAGIC_EMBEDDED_SIGNATURE, CSMAGIC_BLOBWRAPPER and CSSLOT_SIGNATURESLOT.
+constexpr uint32_t kSuperBlobMagic = 0xFADE0CC0;
+constexpr uint32_t kBlobWrapperMagic = 0xFADE0B01;
+constexpr uint32_t kSignatureSlot = 0x10000;
+constexpr size_t kBlobHeaderSize = 8;
+
+constexpr int kMaxNameComponents = 32;
+
+bool SameBytes(ByteView a, ByteView b) {
+  return a.size == b.size &&
+         (a.size == 0 || std::memcmp(a.data, b.data, a.size) == 0);
+}
+
+// Reads the SignedData SEQUENCE out of a ContentInfo.
+bool ReadSignedDataContent(ByteView content_info, DerReader* signed_data) {
+  DerReader outer(content_info);
+  DerElement element;
+  if (!outer.Next(kDerSequence, &element)) {
+    return false;
+  }
+  DerReader info(element.contents);
+  if (!info.Next(&element) || !DerOidEquals(element, kOidSignedData) ||
+      !info.Next(DerContextTag(0), &element)) {
+    return false;
+  }
+  DerReader wrapper(element.contents);
+  if (!wrapper.Next(kDerSequence, &element)) {
+    return false;
+  }
+  *signed_data = DerReader(element.contents);
+  return true;
+}
+
+// Returns the subject of the certificate in |certificates| with |issuer| and
+// |serial|, or an empty view.
+ByteView FindSubject(ByteView certificates, ByteView issuer, ByteView serial) {
+  DerReader reader(certificates);
+  DerElement certificate;
+  while (reader.Next(&certificate)) {
+    if (certificate.tag != kDerSequence) {
+      continue;  // Attribute certificates and the like.
+    }
+    DerReader fields(certificate.contents);
+    DerElement tbs;
+    if (!fields.Next(kDerSequence, &tbs)) {
+      continue;
+    }
+    DerReader tbs_fields(tbs.contents);
+    tbs_fields.SkipContext(0);  // version
+    DerElement serial_number, algorithm, issuer_name, validity, subject;
+    if (tbs_fields.Next(kDerInteger, &serial_number) &&
+        SameBytes(serial_number.contents, serial) &&
+        tbs_fields.Next(kDerSequence, &algorithm) &&
+        tbs_fields.Next(kDerSequence, &issuer_name) &&
+        SameBytes(issuer_name.contents, issuer) &&
+        tbs_fields.Next(kDerSequence, &validity) &&
+        tbs_fields.Next(kDerSequence, &subject)) {
+      return subject.contents;
+    }
+  }
+  return ByteView();
+}
+
+// Finds the signingTime attribute among SignerInfo |attributes|.
+bool FindSigningTime(ByteView attributes, DerElement* time) {
+  DerReader reader(attributes);
+  DerElement attribute;
+  while (reader.Next(kDerSequence, &attribute)) {
+    DerReader fields(attribute.contents);
+    DerElement type, values;
+    if (fields.Next(&type) && DerOidEquals(type, kOidSigningTime) &&
+        fields.Next(kDerSet, &values)) {
+      return DerReader(values.contents).Next(time) &&
+             (time->tag == kDerUtcTime || time->tag == kDerGeneralizedTime);
+    }
+  }
+  return false;
+}
+
+// Reads the signingTime of a PKCS#9 countersignature, which is itself a
+// SignerInfo.
+bool ReadCountersignatureTime(ByteView signer_info, DerElement* time) {
+  DerReader fields(signer_info);
+  DerElement element;
+  // version, sid, digestAlgorithm, then the signed attributes.
+  if (!fields.Next(kDerInteger, &element) || !fields.Next(&element) ||
+      !fields.Next(kDerSequence, &element) ||
+      !fields.Next(DerContextTag(0), &element)) {
+    return false;
+  }
+  return FindSigningTime(element.contents, time);
+}
+
+// Reads genTime from the TSTInfo inside an RFC 3161 timestamp token.
+bool ReadTimeStampTokenTime(ByteView content_info, DerElement* time) {
+  DerReader signed_data;
+  DerElement element;
+  if (!ReadSignedDataContent(content_info, &signed_data) ||
+      !signed_data.Next(kDerInteger, &element) ||
+      !signed_data.Next(kDerSet, &element) ||
+      !signed_data.Next(kDerSequence, &element)) {
+    return false;
+  }
+  DerReader encapsulated(element.contents);
+  if (!encapsulated.Next(kDerOid, &element) ||
+      !encapsulated.Next(DerContextTag(0), &element)) {
+    return false;
+  }
+  DerReader wrapper(element.contents);
+  DerElement content;
+  if (!wrapper.Next(&content)) {
+    return false;
+  }
+  // BER encoders may split the OCTET STRING; TSTInfo fits in the first
+  // chunk in practice.
+  if (content.tag == (kDerOctetString | kDerConstructed) &&
+      !DerReader(content.contents).Next(kDerOctetString, &content)) {
+    return false;
+  }
+  if (content.tag != kDerOctetString) {
+    return false;
+  }
+  DerReader outer(content.contents);
+  DerElement tst_info;
+  if (!outer.Next(kDerSequence, &tst_info)) {
+    return false;
+  }
+  // version, policy, messageImprint, serialNumber, genTime.
+  DerReader fields(tst_info.contents);
+  return fields.Next(kDerInteger, &element) &&
+         fields.Next(kDerOid, &element) &&
+         fields.Next(kDerSequence, &element) &&
+         fields.Next(kDerInteger, &element) &&
+         fields.Next(kDerGeneralizedTime, time);
+}
+
+// Finds the countersignature or timestamp token among the unsigned
+// attributes of the signer. Leaves |time| alone if there is none.
+void FindTimestamp(ByteView attributes, DerElement* time) {
+  DerReader reader(attributes);
+  DerElement attribute;
+  while (reader.Next(kDerSequence, &attribute)) {
+    DerReader fields(attribute.contents);
+    DerElement type, values, value, found;
+    if (!fields.Next(kDerOid, &type) || !fields.Next(kDerSet, &values) ||
+        !DerReader(values.contents).Next(kDerSequence, &value)) {
+      continue;
+    }
+    // A timestamp token is a ContentInfo, the first value in the set.
+    bool ok = DerOidEquals(type, kOidCountersignature)
+                  ? ReadCountersignatureTime(value.contents, &found)
+              : DerOidEquals(type, kOidTimeStampToken) ||
+                      DerOidEquals(type, kOidMsTimeStampToken)
+                  ? ReadTimeStampTokenTime(values.contents, &found)
+                  : false;
+    if (ok) {
+      *time = found;
+      return;
+    }
+  }
+}
+
+// Appends the string value of a directory attribute as UTF-8.
+void AppendDirectoryString(const DerElement& value, std::string* out) {
+  const ByteView& text = value.contents;
+  switch (value.tag) {
+    case kDerUtf8String:
+    case kDerPrintableString:
+    case kDerIa5String:
+      out->append(reinterpret_cast<const char*>(text.data), text.size);
+      break;
+    case kDerTeletexString:
+      // Treated as Latin-1, as most decoders do.
+      for (size_t i = 0; i < text.size; ++i) {
+        AppendCodePoint(text.data[i], out);
+      }
+      break;
+    case kDerBmpString:
+      for (size_t i = 0; i + 1 < text.size; i += 2) {
+        AppendCodePoint(LoadBe16(text.data + i), out);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// Appends |value| escaped as an RFC 4514 attribute value.
+void AppendEscaped(const DerElement& value, std::string* out) {
+  std::string text;
+  AppendDirectoryString(value, &text);
+  for (size_t i = 0; i < text.size(); ++i) {
+    char c = text[i];
+    bool special = std::strchr(",+\"\\<>;", c) != nullptr ||
+                   (i == 0 && (c == '#' || c == ' ')) ||
+                   (i + 1 == text.size() && c == ' ');
+    if (special) {
+      out->push_back('\\');
+    }
+    out->push_back(c);
+  }
+}
+
+// Appends one RelativeDistinguishedName, e.g. "CN=Example".
+void AppendRdn(ByteView rdn, std::string* out) {
+  DerReader reader(rdn);
+  DerElement attribute;
+  bool first = true;
+  while (reader.Next(kDerSequence, &attribute)) {
+    DerReader fields(attribute.contents);
+    DerElement type, value;
+    if (!fields.Next(kDerOid, &type) || !fields.Next(&value)) {
+      continue;
+    }
+    const char* short_name = nullptr;
+    for (const NameAttribute& known : kNameAttributes) {
+      if (DerOidEquals(type, known.oid)) {
+        short_name = known.short_name;
+        break;
+      }
+    }
+    if (short_name == nullptr) {
+      continue;  // Emails, serial numbers and the like are left out.
+    }
+    if (!first) {
+      out->push_back('+');
+    }
+    first = false;
+    out->append(short_name);
+    out->push_back('=');
+    AppendEscaped(value, out);
+  }
+}
+
+// Appends the RDNs left in |reader| most specific first, as RFC 4514
+// writes them. Recursion reverses the order without a buffer.
+void AppendNameReversed(DerReader* reader, int depth, std::string* out) {
+  DerElement rdn;
+  if (depth >= kMaxNameComponents || !reader->Next(kDerSet, &rdn)) {
+    return;
+  }
+  AppendNameReversed(reader, depth + 1, out);
+  size_t before = out->size();
+  if (!out->empty()) {
+    out->append(", ");
+  }
+  size_t start = out->size();
+  AppendRdn(rdn.contents, out);
+  if (out->size() == start) {
+    out->resize(before);
+  }
+}
+
+// The last (most specific) common name in an RDNSequence.
+bool FindCommonName(ByteView name, DerElement* common_name) {
+  bool found = false;
+  DerReader rdns(name);
+  DerElement rdn;
+  while (rdns.Next(kDerSet, &rdn)) {
+    DerReader attributes(rdn.contents);
+    DerElement attribute;
+    while (attributes.Next(kDerSequence, &attribute)) {
+      DerReader fields(attribute.contents);
+      DerElement type, value;
+      if (fields.Next(kDerOid, &type) && DerOidEquals(type, kOidCommonName) &&
+          fields.Next(&value)) {
+        *common_name = value;
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+bool AllDigits(const uint8_t* p, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (p[i] < '0' || p[i] > '9') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Formats a UTCTime or GeneralizedTime in UTC as ISO 8601, dropping
+// fractional seconds. Returns false for other forms, e.g. local times.
+bool FormatTime(const DerElement& time, std::string* out) {
+  const uint8_t* p = time.contents.data;
+  size_t size = time.contents.size;
+  char year[5];
+  if (time.tag == kDerUtcTime) {
+    // YYMMDDHHMMSSZ; years 50-99 are 19xx.
+    if (size != 13 || !AllDigits(p, 12) || p[12] != 'Z') {
+      return false;
+    }
+    bool nineteenth = p[0] >= '5';
+    year[0] = nineteenth ? '1' : '2';
+    year[1] = nineteenth ? '9' : '0';
+    year[2] = static_cast<char>(p[0]);
+    year[3] = static_cast<char>(p[1]);
+    p += 2;
+  } else if (time.tag == kDerGeneralizedTime) {
+    // YYYYMMDDHHMMSS[.fff]Z
+    if (size < 15 || !AllDigits(p, 14) || p[size - 1] != 'Z' ||
+        (size > 15 && p[14] != '.')) {
+      return false;
+    }
+    std::memcpy(year, p, 4);
+    p += 4;
+  } else {
+    return false;
+  }
+  year[4] = '\0';
+  char text[] = "0000-00-00T00:00:00Z";
+  std::memcpy(text, year, 4);
+  const size_t kPositions[] = {5, 8, 11, 14, 17};
+  for (size_t i = 0; i < 5; ++i) {
+    text[kPositions[i]] = static_cast<char>(p[2 * i]);
+    text[kPositions[i] + 1] = static_cast<char>(p[2 * i + 1]);
+  }
+  out->assign(text);
+  return true;
+}
+
+}  // namespace
+
+bool IsCodeSignerKey(const std::string& key) {
+  return key == kSignerNameKey || key == kSignerIssuerKey ||
+         key == kSignerSerialKey || key == kSigningTimeKey;
+}
+
+bool ReadCodeSigner(ByteView content_info, CodeSigner* signer) {
+  *signer = CodeSigner();
+  DerReader signed_data;
+  DerElement element;
+  // version, digestAlgorithms, encapContentInfo.
+  if (!ReadSignedDataContent(content_info, &signed_data) ||
+      !signed_data.Next(kDerInteger, &element) ||
+      !signed_data.Next(kDerSet, &element) ||
+      !signed_data.Next(kDerSequence, &element)) {
+    return false;
+  }
+  // Then [0] certificates and [1] crls, both optional, and the signers.
+  ByteView certificates;
+  DerElement signer_infos;
+  while (true) {
+    if (!signed_data.Next(&signer_infos)) {
+      return false;
+    }
+    if (signer_infos.tag == kDerSet) {
+      break;
+    }
+    if (signer_infos.tag == DerContextTag(0)) {
+      certificates = signer_infos.contents;
+    }
+  }
+
+  DerElement signer_info;
+  if (!DerReader(signer_infos.contents).Next(kDerSequence, &signer_info)) {
+    return false;
+  }
+  DerReader fields(signer_info.contents);
+  DerElement sid;
+  if (!fields.Next(kDerInteger, &element) || !fields.Next(&sid)) {
+    return false;
+  }
+  // IssuerAndSerialNumber; signers named by subject key identifier instead
+  // ([0]) report no certificate fields.
+  if (sid.tag == kDerSequence) {
+    DerReader id(sid.contents);
+    DerElement issuer, serial;
+    if (id.Next(kDerSequence, &issuer) && id.Next(kDerInteger, &serial)) {
+      signer->issuer = issuer.contents;
+      signer->serial = serial.contents;
+      signer->subject =
+          FindSubject(certificates, issuer.contents, serial.contents);
+    }
+  }
+  // The unsigned attributes ([1]) come last.
+  while (fields.Next(&element)) {
+    if (element.tag == DerContextTag(1)) {
+      FindTimestamp(element.contents, &signer->timestamp);
+    }
+  }
+  return true;
+}
+
+ByteView FindPeSignedData(const PeImage& image) {
+  uint32_t offset = 0;
+  uint32_t size = 0;
+  if (!image.GetDataDirectory(kPeDirectorySecurity, &offset, &size)) {
+    return ByteView();
+  }
+  // The security directory holds a file offset, not an RVA.
+  ByteView table = image.image().Sub(offset, size);
+  size_t position = 0;
+  while (table.Contains(position, kWinCertificateHeaderSize)) {
+    uint32_t length = LoadLe32(table.data + position);
+    uint16_t type = LoadLe16(table.data + position + 6);
+    if (length < kWinCertificateHeaderSize ||
+        !table.Contains(position, length)) {
+      break;
+    }
+    if (type == kWinCertificateTypePkcsSignedData) {
+      return table.Sub(position + kWinCertificateHeaderSize,
+                       length - kWinCertificateHeaderSize);
+    }
+    // Entries are 8-byte aligned.
+    position += (static_cast<size_t>(length) + 7) & ~size_t{7};
+  }
+  return ByteView();
+}
+
+ByteView FindMachOSignedData(ByteView super_blob) {
+  // Code signing structures are big-endian whatever the image's byte order.
+  if (!super_blob.Contains(0, 12) ||
+      LoadBe32(super_blob.data) != kSuperBlobMagic) {
+    return ByteView();
+  }
+  uint32_t count = LoadBe32(super_blob.data + 8);
+  for (uint32_t i = 0; i < count; ++i) {
+    size_t entry = 12 + static_cast<size_t>(i) * 8;
+    if (!super_blob.Contains(entry, 8)) {
+      break;
+    }
+    if (LoadBe32(super_blob.data + entry) != kSignatureSlot) {
+      continue;
+    }
+    uint32_t offset = LoadBe32(super_blob.data + entry + 4);
+    if (!super_blob.Contains(offset, kBlobHeaderSize) ||
+        LoadBe32(super_blob.data + offset) != kBlobWrapperMagic) {
+      return ByteView();
+    }
+    uint32_t length = LoadBe32(super_blob.data + offset + 4);
+    if (length < kBlobHeaderSize) {
+      return ByteView();
+    }
+    return super_blob.Sub(offset + kBlobHeaderSize,
+                          length - kBlobHeaderSize);
+  }
+  return ByteView();
+}
+
+void AddCodeSignerFields(const CodeSigner& signer,
+                         std::map<std::string, std::string>* fields) {
+  DerElement common_name;
+  if (FindCommonName(signer.subject, &common_name)) {
+    AppendDirectoryString(common_name, &(*fields)[kSignerNameKey]);
+  }
+  if (!signer.issuer.empty()) {
+    DerReader issuer(signer.issuer);
+    AppendNameReversed(&issuer, 0, &(*fields)[kSignerIssuerKey]);
+  }
+  if (!signer.serial.empty()) {
+    // DER prepends a zero byte to positive serials with the top bit set.
+    ByteView serial = signer.serial;
+    if (serial.size > 1 && serial.data[0] == 0) {
+      serial = serial.From(1);
+    }
+    (*fields)[kSignerSerialKey] = ToHex(serial.data, serial.size);
+  }
+  std::string time;
+  if (FormatTime(signer.timestamp, &time)) {
+    (*fields)[kSigningTimeKey] = std::move(time);
+  }
+}
+
+}  // namespace flutter_bin
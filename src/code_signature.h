@@ -0,0 +1,56 @@
+#ifndef FLUTTER_BIN_CODE_SIGNATURE_H_
+#define FLUTTER_BIN_CODE_SIGNATURE_H_
+
+#include <map>
+#include <string>
+
+#include "byte_view.h"
+#include "der.h"
+#include "pe_image.h"
+
+namespace flutter_bin {
+
+// Metadata keys of the signer fields.
+extern const char kSignerNameKey[];    // Subject common name.
+extern const char kSignerIssuerKey[];  // e.g. "CN=Example CA, O=Example, C=US"
+extern const char kSignerSerialKey[];  // Lowercase hex.
+extern const char kSigningTimeKey[];   // e.g. "2024-01-02T03:04:05Z"
+
+// Whether |key| is one of the signer field keys above.
+bool IsCodeSignerKey(const std::string& key);
+
+// What a code signature says about who signed a file and when. The views
+// point into the signature and are only decoded by AddCodeSignerFields().
+struct CodeSigner {
+  // RDNSequence contents of the signing certificate's subject and issuer.
+  ByteView subject;
+  ByteView issuer;
+  // INTEGER contents of the certificate serial number.
+  ByteView serial;
+  // UTCTime or GeneralizedTime from the countersignature or RFC 3161
+  // timestamp; tag 0 if the signature is not timestamped.
+  DerElement timestamp;
+};
+
+// Reads the first signer of a PKCS#7 / CMS SignedData ContentInfo. Walks
+// only the elements on the way to the signer's issuer and serial number,
+// the matching certificate's subject and the timestamp; certificates are
+// neither fully decoded nor validated, and the signature is not verified.
+// Returns false if |content_info| is not SignedData.
+bool ReadCodeSigner(ByteView content_info, CodeSigner* signer);
+
+// The PKCS#7 SignedData in the certificate table of |image| (the first
+// WIN_CERTIFICATE of type PKCS_SIGNED_DATA), or an empty view.
+ByteView FindPeSignedData(const PeImage& image);
+
+// The CMS SignedData in an LC_CODE_SIGNATURE SuperBlob, or an empty view.
+// Ad-hoc signatures carry none.
+ByteView FindMachOSignedData(ByteView super_blob);
+
+// Adds the signer fields that |signer| has to |fields|.
+void AddCodeSignerFields(const CodeSigner& signer,
+                         std::map<std::string, std::string>* fields);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_CODE_SIGNATURE_H_
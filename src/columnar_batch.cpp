@@ -0,0 +1,133 @@
+#include "columnar_batch.h"
+
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr char kErrorKey[] = "error";
+
+// One column under construction: the key's string id and a value id for
+// every row seen so far.
+struct Column {
+  uint32_t key;
+  std::vector<uint32_t> values;
+};
+
+class ColumnBuilder {
+ public:
+  explicit ColumnBuilder(size_t rows) : rows_(rows) {}
+
+  void Add(size_t row, std::string_view key, std::string_view value) {
+    size_t column = FindColumn(row, key);
+    std::vector<uint32_t>& values = columns_[column].values;
+    values.resize(row, kColumnarNoValue);
+    values.push_back(Intern(value));
+  }
+
+  std::vector<uint8_t> Finish() {
+    size_t string_count = strings_.size();
+    size_t offsets_start = kColumnarBatchHeaderSize +
+                           columns_.size() * 4 * (1 + rows_);
+    size_t strings_start = offsets_start + (string_count + 1) * 4;
+    std::vector<uint8_t> buffer(strings_start + string_bytes_);
+    uint8_t* p = buffer.data();
+
+    StoreLe32(p, kColumnarBatchMagic);
+    StoreLe32(p + 4, static_cast<uint32_t>(buffer.size()));
+    StoreLe32(p + 8, static_cast<uint32_t>(rows_));
+    StoreLe32(p + 12, static_cast<uint32_t>(columns_.size()));
+    StoreLe32(p + 16, static_cast<uint32_t>(string_count));
+    p += kColumnarBatchHeaderSize;
+    for (const Column& column : columns_) {
+      StoreLe32(p, column.key);
+      p += 4;
+    }
+    for (Column& column : columns_) {
+      column.values.resize(rows_, kColumnarNoValue);
+      for (uint32_t value : column.values) {
+        StoreLe32(p, value);
+        p += 4;
+      }
+    }
+    uint8_t* strings = buffer.data() + strings_start;
+    uint32_t offset = 0;
+    for (std::string_view string : strings_) {
+      StoreLe32(p, offset);
+      p += 4;
+      if (!string.empty()) {
+        std::memcpy(strings + offset, string.data(), string.size());
+      }
+      offset += static_cast<uint32_t>(string.size());
+    }
+    StoreLe32(p, offset);
+    return buffer;
+  }
+
+ private:
+  // Rows list their keys in the same order, so the column after the last
+  // one used is nearly always the right one and the key is not hashed.
+  size_t FindColumn(size_t row, std::string_view key) {
+    if (row != hint_row_) {
+      hint_row_ = row;
+      hint_ = 0;
+    }
+    if (hint_ < columns_.size() && strings_[columns_[hint_].key] == key) {
+      return hint_++;
+    }
+    uint32_t key_id = Intern(key);
+    auto [it, inserted] = index_.emplace(key_id, columns_.size());
+    if (inserted) {
+      columns_.push_back(Column{key_id, {}});
+      columns_.back().values.reserve(rows_);
+    }
+    hint_ = it->second + 1;
+    return it->second;
+  }
+
+  // The strings are views into the batch, which outlives the builder, so
+  // unlike StringPool nothing is copied or locked.
+  uint32_t Intern(std::string_view string) {
+    auto [it, inserted] =
+        ids_.emplace(string, static_cast<uint32_t>(strings_.size()));
+    if (inserted) {
+      strings_.push_back(string);
+      string_bytes_ += string.size();
+    }
+    return it->second;
+  }
+
+  size_t rows_;
+  std::unordered_map<std::string_view, uint32_t> ids_;
+  std::vector<std::string_view> strings_;
+  size_t string_bytes_ = 0;
+  std::vector<Column> columns_;
+  // Column index by key id.
+  std::unordered_map<uint32_t, size_t> index_;
+  size_t hint_row_ = 0;
+  size_t hint_ = 0;
+};
+
+}  // namespace
+
+std::vector<uint8_t> EncodeColumnarBatch(
+    const std::vector<BinaryMetadata>& batch) {
+  ColumnBuilder builder(batch.size());
+  for (size_t row = 0; row < batch.size(); ++row) {
+    const BinaryMetadata& metadata = batch[row];
+    for (const auto& [key, value] : metadata.fields) {
+      builder.Add(row, key, value);
+    }
+    if (metadata.error != MetadataError::kNone) {
+      builder.Add(row, kErrorKey, MetadataErrorCode(metadata.error));
+    }
+  }
+  return builder.Finish();
+}
+
+}  // namespace flutter_bin
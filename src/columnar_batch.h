@@ -0,0 +1,38 @@
+#ifndef FLUTTER_BIN_COLUMNAR_BATCH_H_
+#define FLUTTER_BIN_COLUMNAR_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "binary_metadata.h"
+
+namespace flutter_bin {
+
+// A batch of BinaryMetadata as one byte buffer for the channel: a column
+// per metadata key holding a string id per file, and a table in which each
+// distinct key and value is stored once. Company names, copyright lines and
+// the keys themselves repeat across thousands of files, so this is much
+// smaller than a map per file and Dart can decode rows and strings lazily.
+// Every integer is a little-endian uint32:
+//
+//   header   magic, size, row count (R), column count (C), string count (S),
+//            reserved
+//   keys     C string ids, the metadata key of each column
+//   columns  C x R string ids, column by column; kColumnarNoValue where a
+//            file has no such field
+//   offsets  S + 1 offsets of the strings into the string bytes
+//   strings  UTF-8, not NUL-terminated
+//
+// Errors are a column named "error" holding the error code.
+constexpr uint32_t kColumnarBatchMagic = 0x42434246;  // "FBCB"
+constexpr size_t kColumnarBatchHeaderSize = 24;
+constexpr uint32_t kColumnarNoValue = 0xFFFFFFFF;
+
+// Encodes |batch|, one row per file in order, as described above.
+std::vector<uint8_t> EncodeColumnarBatch(
+    const std::vector<BinaryMetadata>& batch);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_COLUMNAR_BATCH_H_
@@ -0,0 +1,101 @@
+#include "content_hash.h"
+
+#include <thread>
+
+#include "blake3.h"
+#include "sha256.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+
+namespace {
+
+// Below this, handing BLAKE3 chunks to other threads costs more than it
+// saves.
+constexpr size_t kParallelHashThreshold = 4 * 1024 * 1024;
+
+// Shared by every caller, including batch workers, so that hashing never
+// waits on the pool it runs on. Deliberately leaked: joining workers from a
+// static destructor can deadlock while a plugin DLL is being unloaded.
+ThreadPool* HashThreadPool() {
+  static ThreadPool* pool = new ThreadPool(std::thread::hardware_concurrency());
+  return pool;
+}
+
+}  // namespace
+
+const char* HashAlgorithmName(HashAlgorithm algorithm) {
+  switch (algorithm) {
+    case HashAlgorithm::kSha256:
+      return "sha256";
+    case HashAlgorithm::kBlake3:
+      return "blake3";
+    case HashAlgorithm::kAuthenticode:
+      return "authenticode";
+  }
+  return "";
+}
+
+bool ParseHashAlgorithm(const std::string& name, HashAlgorithm* algorithm) {
+  for (HashAlgorithm candidate :
+       {HashAlgorithm::kSha256, HashAlgorithm::kBlake3,
+        HashAlgorithm::kAuthenticode}) {
+    if (name == HashAlgorithmName(candidate)) {
+      *algorithm = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ParseHashAlgorithms(const std::vector<std::string>& names,
+                         std::vector<HashAlgorithm>* algorithms) {
+  for (const std::string& name : names) {
+    HashAlgorithm algorithm;
+    if (!ParseHashAlgorithm(name, &algorithm)) {
+      return false;
+    }
+    algorithms->push_back(algorithm);
+  }
+  return true;
+}
+
+std::string ToHex(const uint8_t* data, size_t size) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex(2 * size, '0');
+  for (size_t i = 0; i < size; ++i) {
+    hex[2 * i] = kDigits[data[i] >> 4];
+    hex[2 * i + 1] = kDigits[data[i] & 0xF];
+  }
+  return hex;
+}
+
+void AddContentHashes(ByteView content,
+                      const std::vector<HashAlgorithm>& algorithms,
+                      std::map<std::string, std::string>* fields) {
+  for (HashAlgorithm algorithm : algorithms) {
+    if (algorithm == HashAlgorithm::kAuthenticode) {
+      continue;
+    }
+    std::string& out = (*fields)[HashAlgorithmName(algorithm)];
+    switch (algorithm) {
+      case HashAlgorithm::kSha256: {
+        Sha256Digest digest = Sha256(content);
+        out = ToHex(digest.data(), digest.size());
+        break;
+      }
+      case HashAlgorithm::kBlake3: {
+        ThreadPool* pool = content.size >= kParallelHashThreshold
+                               ? HashThreadPool()
+                               : nullptr;
+        Blake3Digest digest = Blake3(content, pool);
+        out = ToHex(digest.data(), digest.size());
+        break;
+      }
+      case HashAlgorithm::kAuthenticode:
+        break;
+    }
+  }
+}
+
+}  // namespace flutter_bin
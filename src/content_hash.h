@@ -0,0 +1,46 @@
+#ifndef FLUTTER_BIN_CONTENT_HASH_H_
+#define FLUTTER_BIN_CONTENT_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+// Digests that can be requested along with a file's metadata.
+enum class HashAlgorithm {
+  kSha256,
+  kBlake3,
+  // Authenticode SHA-256 image digest; PE images only.
+  kAuthenticode,
+};
+
+// The field name a digest is reported under, e.g. "sha256", "authenticode".
+const char* HashAlgorithmName(HashAlgorithm algorithm);
+
+// Maps a field name back to its algorithm. Returns false for other names.
+bool ParseHashAlgorithm(const std::string& name, HashAlgorithm* algorithm);
+
+// Appends the algorithms named by |names| to |algorithms|. Returns false if
+// any name is unknown.
+bool ParseHashAlgorithms(const std::vector<std::string>& names,
+                         std::vector<HashAlgorithm>* algorithms);
+
+// Lowercase hex, two digits per byte.
+std::string ToHex(const uint8_t* data, size_t size);
+
+// Adds the digest of |content| for each of |algorithms| to |fields| as
+// lowercase hex, using the fastest kernels the CPU supports. Large inputs
+// are hashed with BLAKE3 on a shared pool of worker threads. kAuthenticode
+// needs the parsed image and is left to the PE reader.
+void AddContentHashes(ByteView content,
+                      const std::vector<HashAlgorithm>& algorithms,
+                      std::map<std::string, std::string>* fields);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_CONTENT_HASH_H_
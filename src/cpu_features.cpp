@@ -0,0 +1,83 @@
+#include "cpu_features.h"
+
+#include <cstdint>
+
+#if defined(FLUTTER_BIN_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace flutter_bin {
+
+namespace {
+
+#if defined(FLUTTER_BIN_X86)
+
+void Cpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4]) {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+  for (int i = 0; i < 4; ++i) {
+    registers[i] = static_cast<uint32_t>(info[i]);
+  }
+#else
+  __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2],
+                registers[3]);
+#endif
+}
+
+// XCR0: which register files the OS saves on a context switch.
+uint64_t ReadXcr0() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t eax = 0;
+  uint32_t edx = 0;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+CpuFeatures Detect() {
+  CpuFeatures features;
+  uint32_t registers[4];
+  Cpuid(0, 0, registers);
+  uint32_t max_leaf = registers[0];
+  if (max_leaf < 1) {
+    return features;
+  }
+
+  Cpuid(1, 0, registers);
+  uint32_t ecx = registers[2];
+  features.sse2 = (registers[3] & (1u << 26)) != 0;
+  features.sse41 = (ecx & (1u << 19)) != 0;
+  // AVX registers are only usable if the OS preserves XMM and YMM state.
+  bool ymm_enabled = (ecx & (1u << 27)) != 0 && (ecx & (1u << 28)) != 0 &&
+                     (ReadXcr0() & 0x6) == 0x6;
+
+  if (max_leaf >= 7) {
+    Cpuid(7, 0, registers);
+    uint32_t ebx = registers[1];
+    features.avx2 = ymm_enabled && (ebx & (1u << 5)) != 0;
+    features.sha = features.sse41 && (ebx & (1u << 29)) != 0;
+  }
+  return features;
+}
+
+#else
+
+CpuFeatures Detect() { return CpuFeatures(); }
+
+#endif
+
+}  // namespace
+
+const CpuFeatures& GetCpuFeatures() {
+  static const CpuFeatures features = Detect();
+  return features;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,33 @@
+#ifndef FLUTTER_BIN_CPU_FEATURES_H_
+#define FLUTTER_BIN_CPU_FEATURES_H_
+
+namespace flutter_bin {
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#define FLUTTER_BIN_X86 1
+#endif
+
+// Lets GCC and Clang compile one function for an instruction set the rest of
+// the build does not assume; MSVC always accepts the intrinsics.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define FLUTTER_BIN_TARGET(features)
+#else
+#define FLUTTER_BIN_TARGET(features) __attribute__((target(features)))
+#endif
+
+// The instruction set extensions the SIMD kernels use, as reported by the CPU
+// and enabled by the OS. All false on CPUs other than x86.
+struct CpuFeatures {
+  bool sse2 = false;  // Always present on x86-64.
+  bool sse41 = false;
+  bool avx2 = false;
+  bool sha = false;  // SHA-NI.
+};
+
+// Detected on first use.
+const CpuFeatures& GetCpuFeatures();
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_CPU_FEATURES_H_
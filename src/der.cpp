@@ -0,0 +1,102 @@
+#include "der.h"
+
+#include <cstring>
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr uint8_t kHighTagNumber = 0x1F;
+constexpr uint8_t kIndefiniteLength = 0x80;
+// Nested indefinite lengths are resolved recursively; real signatures nest
+// a handful of levels.
+constexpr int kMaxDepth = 32;
+
+// Reads the element at |*offset| of |data| and advances past it.
+bool ReadElement(ByteView data, size_t* offset, DerElement* element,
+                 int depth) {
+  if (depth > kMaxDepth || !data.Contains(*offset, 2)) {
+    return false;
+  }
+  const uint8_t* header = data.data + *offset;
+  uint8_t tag = header[0];
+  if ((tag & kHighTagNumber) == kHighTagNumber) {
+    return false;
+  }
+  size_t position = *offset + 2;
+  uint8_t first = header[1];
+
+  if (first == kIndefiniteLength) {
+    // Only constructed values may have one; they end at two zero octets.
+    if ((tag & kDerConstructed) == 0) {
+      return false;
+    }
+    size_t start = position;
+    while (true) {
+      if (!data.Contains(position, 2)) {
+        return false;
+      }
+      if (data.data[position] == 0 && data.data[position + 1] == 0) {
+        element->tag = tag;
+        element->contents = data.Sub(start, position - start);
+        *offset = position + 2;
+        return true;
+      }
+      DerElement child;
+      if (!ReadElement(data, &position, &child, depth + 1)) {
+        return false;
+      }
+    }
+  }
+
+  size_t length = first;
+  if (first & 0x80) {
+    size_t octets = first & 0x7F;
+    if (octets > 4 || !data.Contains(position, octets)) {
+      return false;
+    }
+    length = 0;
+    for (size_t i = 0; i < octets; ++i) {
+      length = (length << 8) | data.data[position + i];
+    }
+    position += octets;
+  }
+  if (!data.Contains(position, length)) {
+    return false;
+  }
+  element->tag = tag;
+  element->contents = data.Sub(position, length);
+  *offset = position + length;
+  return true;
+}
+
+}  // namespace
+
+bool DerReader::Next(DerElement* element) {
+  if (ReadElement(data_, &offset_, element, 0)) {
+    return true;
+  }
+  offset_ = data_.size;
+  return false;
+}
+
+bool DerReader::Next(uint8_t tag, DerElement* element) {
+  return Next(element) && element->tag == tag;
+}
+
+void DerReader::SkipContext(uint8_t number) {
+  if (offset_ < data_.size &&
+      (data_.data[offset_] & ~kDerConstructed) ==
+          (kDerContextSpecific | number)) {
+    DerElement skipped;
+    Next(&skipped);
+  }
+}
+
+bool DerOidEquals(const DerElement& element, const uint8_t* oid,
+                  size_t size) {
+  return element.tag == kDerOid && element.contents.size == size &&
+         std::memcmp(element.contents.data, oid, size) == 0;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,80 @@
+#ifndef FLUTTER_BIN_DER_H_
+#define FLUTTER_BIN_DER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+// Identifier octets of the ASN.1 types code signatures use.
+enum DerTag : uint8_t {
+  kDerInteger = 0x02,
+  kDerOctetString = 0x04,
+  kDerOid = 0x06,
+  kDerUtf8String = 0x0C,
+  kDerPrintableString = 0x13,
+  kDerTeletexString = 0x14,
+  kDerIa5String = 0x16,
+  kDerUtcTime = 0x17,
+  kDerGeneralizedTime = 0x18,
+  kDerBmpString = 0x1E,
+  kDerSequence = 0x30,
+  kDerSet = 0x31,
+  kDerConstructed = 0x20,
+  kDerContextSpecific = 0x80,
+};
+
+// The tag of [|number|] with constructed contents, e.g. the EXPLICIT
+// wrapper of an optional field.
+constexpr uint8_t DerContextTag(uint8_t number) {
+  return static_cast<uint8_t>(kDerContextSpecific | kDerConstructed | number);
+}
+
+// One encoded value: its identifier octet and its contents.
+struct DerElement {
+  uint8_t tag = 0;
+  ByteView contents;
+};
+
+// Walks the elements of a constructed value one at a time.
+//
+// Accepts DER and the BER subset signing tools emit: indefinite lengths
+// (Apple's CMS blobs use them) but only low tag numbers. Nothing is copied
+// or allocated; elements point into the buffer given to the constructor, and
+// the contents of an element are only looked at when a reader is made for
+// them.
+class DerReader {
+ public:
+  DerReader() = default;
+  explicit DerReader(ByteView data) : data_(data) {}
+
+  // Reads the next element. Returns false at the end of the data or if the
+  // element is malformed, after which the reader stays at the end.
+  bool Next(DerElement* element);
+
+  // Like Next(), but also returns false if the element is not a |tag|.
+  bool Next(uint8_t tag, DerElement* element);
+
+  // Skips optional element [|number|] if it comes next.
+  void SkipContext(uint8_t number);
+
+  bool empty() const { return offset_ >= data_.size; }
+
+ private:
+  ByteView data_;
+  size_t offset_ = 0;
+};
+
+// Whether |element| is an OBJECT IDENTIFIER encoded as |oid|.
+bool DerOidEquals(const DerElement& element, const uint8_t* oid, size_t size);
+
+template <size_t N>
+bool DerOidEquals(const DerElement& element, const uint8_t (&oid)[N]) {
+  return DerOidEquals(element, oid, N);
+}
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_DER_H_
@@ -0,0 +1,200 @@
+#include "directory_list.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+#include <cwchar>
+
+#include "unicode.h"
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace flutter_bin {
+
+#if defined(_WIN32)
+
+namespace {
+
+constexpr char kSeparator = '\\';
+
+EntryType TypeFromAttributes(DWORD attributes) {
+  if (attributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+    return EntryType::kLink;
+  }
+  if (attributes & FILE_ATTRIBUTE_DIRECTORY) {
+    return EntryType::kDirectory;
+  }
+  if (attributes & FILE_ATTRIBUTE_DEVICE) {
+    return EntryType::kOther;
+  }
+  return EntryType::kFile;
+}
+
+// Opens |utf8_path| for attribute queries only; directories included.
+HANDLE OpenForQuery(const std::string& utf8_path) {
+  return CreateFileW(Utf8ToWide(utf8_path).c_str(), 0,
+                     FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                     nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS,
+                     nullptr);
+}
+
+}  // namespace
+
+bool ListDirectory(const std::string& utf8_path,
+                   std::vector<DirectoryEntry>* entries) {
+  std::wstring pattern = Utf8ToWide(JoinPath(utf8_path, "*"));
+  WIN32_FIND_DATAW find_data;
+  // The basic info level skips short names, and large fetches cut round
+  // trips on network shares.
+  HANDLE find = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &find_data,
+                                 FindExSearchNameMatch, nullptr,
+                                 FIND_FIRST_EX_LARGE_FETCH);
+  if (find == INVALID_HANDLE_VALUE) {
+    return GetLastError() == ERROR_FILE_NOT_FOUND;
+  }
+  do {
+    const wchar_t* name = find_data.cFileName;
+    if (wcscmp(name, L".") == 0 || wcscmp(name, L"..") == 0) {
+      continue;
+    }
+    DirectoryEntry entry;
+    entry.name = Utf16ToUtf8(
+        Utf16View(reinterpret_cast<const uint8_t*>(name), wcslen(name)));
+    entry.type = TypeFromAttributes(find_data.dwFileAttributes);
+    entries->push_back(std::move(entry));
+  } while (FindNextFileW(find, &find_data));
+  FindClose(find);
+  return true;
+}
+
+bool ResolveEntryType(const std::string& utf8_path, EntryType* type) {
+  HANDLE file = OpenForQuery(utf8_path);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  BY_HANDLE_FILE_INFORMATION info;
+  bool ok = GetFileInformationByHandle(file, &info) != 0;
+  CloseHandle(file);
+  if (ok) {
+    // The handle is of the link target, so this never reports kLink.
+    *type = TypeFromAttributes(info.dwFileAttributes &
+                               ~static_cast<DWORD>(FILE_ATTRIBUTE_REPARSE_POINT));
+  }
+  return ok;
+}
+
+bool ReadDirectoryId(const std::string& utf8_path, uint64_t* volume,
+                     uint64_t* id) {
+  HANDLE file = OpenForQuery(utf8_path);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  BY_HANDLE_FILE_INFORMATION info;
+  bool ok = GetFileInformationByHandle(file, &info) != 0;
+  CloseHandle(file);
+  if (ok) {
+    *volume = info.dwVolumeSerialNumber;
+    *id = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) |
+          info.nFileIndexLow;
+  }
+  return ok;
+}
+
+#else
+
+namespace {
+
+constexpr char kSeparator = '/';
+
+EntryType TypeFromMode(mode_t mode) {
+  if (S_ISLNK(mode)) {
+    return EntryType::kLink;
+  }
+  if (S_ISDIR(mode)) {
+    return EntryType::kDirectory;
+  }
+  if (S_ISREG(mode)) {
+    return EntryType::kFile;
+  }
+  return EntryType::kOther;
+}
+
+}  // namespace
+
+bool ListDirectory(const std::string& utf8_path,
+                   std::vector<DirectoryEntry>* entries) {
+  DIR* dir = ::opendir(utf8_path.c_str());
+  if (dir == nullptr) {
+    return false;
+  }
+  while (struct dirent* item = ::readdir(dir)) {
+    const char* name = item->d_name;
+    if (name[0] == '.' &&
+        (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+      continue;
+    }
+    DirectoryEntry entry;
+    entry.name = name;
+    switch (item->d_type) {
+      case DT_REG:
+        entry.type = EntryType::kFile;
+        break;
+      case DT_DIR:
+        entry.type = EntryType::kDirectory;
+        break;
+      case DT_LNK:
+        entry.type = EntryType::kLink;
+        break;
+      case DT_UNKNOWN: {
+        // Some file systems do not fill in d_type.
+        struct stat entry_stat;
+        std::string path = JoinPath(utf8_path, entry.name);
+        entry.type = ::lstat(path.c_str(), &entry_stat) == 0
+                         ? TypeFromMode(entry_stat.st_mode)
+                         : EntryType::kOther;
+        break;
+      }
+      default:
+        entry.type = EntryType::kOther;
+        break;
+    }
+    entries->push_back(std::move(entry));
+  }
+  ::closedir(dir);
+  return true;
+}
+
+bool ResolveEntryType(const std::string& utf8_path, EntryType* type) {
+  struct stat entry_stat;
+  if (::stat(utf8_path.c_str(), &entry_stat) != 0) {
+    return false;
+  }
+  *type = TypeFromMode(entry_stat.st_mode);
+  return true;
+}
+
+bool ReadDirectoryId(const std::string& utf8_path, uint64_t* volume,
+                     uint64_t* id) {
+  struct stat entry_stat;
+  if (::stat(utf8_path.c_str(), &entry_stat) != 0) {
+    return false;
+  }
+  *volume = static_cast<uint64_t>(entry_stat.st_dev);
+  *id = static_cast<uint64_t>(entry_stat.st_ino);
+  return true;
+}
+
+#endif
+
+std::string JoinPath(const std::string& directory, const std::string& name) {
+  std::string path = directory;
+  if (!path.empty() && path.back() != '/' && path.back() != kSeparator) {
+    path += kSeparator;
+  }
+  path += name;
+  return path;
+}
+
+}  // namespace flutter_bin
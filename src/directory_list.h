@@ -0,0 +1,42 @@
+#ifndef FLUTTER_BIN_DIRECTORY_LIST_H_
+#define FLUTTER_BIN_DIRECTORY_LIST_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_bin {
+
+enum class EntryType {
+  kFile,
+  kDirectory,
+  // A symbolic link or, on Windows, any reparse point (junctions included).
+  kLink,
+  kOther,
+};
+
+struct DirectoryEntry {
+  std::string name;
+  EntryType type = EntryType::kOther;
+};
+
+// Appends the entries of the directory at |utf8_path| to |entries|, without
+// "." and "..". Links are reported as kLink, not followed. Returns false if
+// the directory cannot be read.
+bool ListDirectory(const std::string& utf8_path,
+                   std::vector<DirectoryEntry>* entries);
+
+// Returns the type of what |utf8_path| refers to after following links.
+bool ResolveEntryType(const std::string& utf8_path, EntryType* type);
+
+// Identifies the directory at |utf8_path| (following links), so that walks
+// can detect cycles.
+bool ReadDirectoryId(const std::string& utf8_path, uint64_t* volume,
+                     uint64_t* id);
+
+// Appends |name| to the directory path |directory|.
+std::string JoinPath(const std::string& directory, const std::string& name);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_DIRECTORY_LIST_H_
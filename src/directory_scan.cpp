@@ -0,0 +1,284 @@
+#include "directory_scan.h"
+
+#include <algorithm>
+
+#include "directory_list.h"
+
+namespace flutter_bin {
+
+bool MatchesExtension(const std::string& name,
+                      const std::vector<std::string>& extensions) {
+  if (extensions.empty()) {
+    return true;
+  }
+  size_t dot = name.rfind('.');
+  if (dot == std::string::npos) {
+    return false;
+  }
+  std::string extension = name.substr(dot + 1);
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](char c) {
+                   return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a')
+                                               : c;
+                 });
+  return std::find(extensions.begin(), extensions.end(), extension) !=
+         extensions.end();
+}
+
+DirectoryScan::DirectoryScan(ThreadPool* pool, ScanOptions options,
+                             Reader read, Sink sink)
+    : pool_(pool),
+      options_(std::move(options)),
+      read_(std::move(read)),
+      sink_(std::move(sink)),
+      parallelism_(options_.parallelism != 0
+                       ? options_.parallelism
+                       : std::max<size_t>(pool->thread_count() / 2, 1)) {}
+
+DirectoryScan::~DirectoryScan() {
+  Cancel();
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return running_tasks_ == 0; });
+  }
+  if (flusher_.joinable()) {
+    flusher_.join();
+  }
+}
+
+void DirectoryScan::Start(const std::string& root) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t volume = 0;
+  uint64_t id = 0;
+  if (options_.follow_links && ReadDirectoryId(root, &volume, &id)) {
+    visited_.emplace(volume, id);
+  }
+  pending_directories_.push_back({root, 0, nullptr});
+  flusher_ = std::thread([this] { FlushOnDeadline(); });
+  Pump();
+}
+
+void DirectoryScan::Cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cancelled_ || finished_) {
+    return;
+  }
+  cancelled_ = true;
+  pending_directories_.clear();
+  if (running_tasks_ == 0) {
+    // Nothing is left to deliver the final batch, e.g. the walk is paused.
+    ++running_tasks_;
+    pool_->Post([this] { FinishTask(); });
+  }
+}
+
+void DirectoryScan::Acknowledge() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (unacknowledged_ > 0) {
+    --unacknowledged_;
+  }
+  Pump();
+}
+
+void DirectoryScan::Pump() {
+  while (!cancelled_ && !finished_ && !pending_directories_.empty() &&
+         running_tasks_ < parallelism_ &&
+         unacknowledged_ < options_.max_unacknowledged_batches) {
+    Directory directory = std::move(pending_directories_.back());
+    pending_directories_.pop_back();
+    ++running_tasks_;
+    pool_->Post([this, directory = std::move(directory)]() mutable {
+      ReadDirectory(std::move(directory));
+      FinishTask();
+    });
+  }
+}
+
+void DirectoryScan::ReadDirectory(Directory directory) {
+  std::shared_ptr<Progress> progress = std::move(directory.progress);
+  if (!progress) {
+    progress = std::make_shared<Progress>();
+    if (!ListDirectory(directory.path, &progress->entries)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++summary_.errors;
+      summary_.root_failed = summary_.root_failed || directory.depth == 0;
+      return;
+    }
+  }
+
+  bool descend = options_.max_depth < 0 || directory.depth < options_.max_depth;
+  while (progress->next_entry < progress->entries.size()) {
+    {
+      // A large directory can fill many batches on its own, so the credit
+      // is checked per entry and not only before the directory is picked.
+      // Out of credit, the rest of the directory goes back on the stack
+      // rather than holding the worker; Acknowledge() picks it up again.
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (cancelled_) {
+        break;
+      }
+      if (unacknowledged_ >= options_.max_unacknowledged_batches) {
+        directory.progress = std::move(progress);
+        pending_directories_.push_back(std::move(directory));
+        return;
+      }
+    }
+    const DirectoryEntry& entry = progress->entries[progress->next_entry++];
+    std::string path = JoinPath(directory.path, entry.name);
+    EntryType type = entry.type;
+    if (type == EntryType::kLink &&
+        (!options_.follow_links || !ResolveEntryType(path, &type))) {
+      continue;
+    }
+
+    if (type == EntryType::kDirectory) {
+      if (!descend) {
+        continue;
+      }
+      if (options_.follow_links) {
+        // Links can lead back to a directory already walked.
+        uint64_t volume = 0;
+        uint64_t id = 0;
+        if (!ReadDirectoryId(path, &volume, &id)) {
+          continue;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!visited_.emplace(volume, id).second) {
+          continue;
+        }
+      }
+      progress->subdirectories.push_back(
+          {std::move(path), directory.depth + 1, nullptr});
+      continue;
+    }
+    if (type != EntryType::kFile) {
+      continue;
+    }
+
+    ++progress->files;
+    if (!MatchesExtension(entry.name, options_.extensions)) {
+      continue;
+    }
+    BinaryFormat format = DetectFileFormat(path);
+    if (format == BinaryFormat::kUnknown) {
+      continue;
+    }
+    ++progress->binaries;
+    ScanEntry scan_entry;
+    scan_entry.metadata = read_(path, format);
+    scan_entry.path = std::move(path);
+    scan_entry.format = format;
+
+    std::vector<ScanEntry> due;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (batch_.empty()) {
+        batch_started_ = std::chrono::steady_clock::now();
+        batch_changed_.notify_all();
+      }
+      batch_.push_back(std::move(scan_entry));
+      TakeDueBatch(&due);
+    }
+    if (!due.empty()) {
+      Deliver(std::move(due));
+    }
+  }
+
+  std::vector<ScanEntry> due;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++summary_.directories;
+    summary_.files += progress->files;
+    summary_.binaries += progress->binaries;
+    if (!cancelled_) {
+      // Pushed in reverse so that they are walked in listing order.
+      for (auto it = progress->subdirectories.rbegin();
+           it != progress->subdirectories.rend(); ++it) {
+        pending_directories_.push_back(std::move(*it));
+      }
+    }
+    TakeDueBatch(&due);
+  }
+  if (!due.empty()) {
+    Deliver(std::move(due));
+  }
+}
+
+void DirectoryScan::FlushOnDeadline() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!finished_) {
+    if (batch_.empty()) {
+      batch_changed_.wait(lock);
+      continue;
+    }
+    // The readers only check the age when they add a binary or finish a
+    // directory, which a long run of other files or a slow read delays.
+    std::chrono::steady_clock::time_point deadline =
+        batch_started_ + options_.batch_interval;
+    if (std::chrono::steady_clock::now() < deadline) {
+      batch_changed_.wait_until(lock, deadline);
+      continue;
+    }
+    std::vector<ScanEntry> due;
+    if (!TakeDueBatch(&due)) {
+      continue;
+    }
+    // Delivered from the pool like every other batch, and counted as a task
+    // so that the final batch still comes last.
+    ++running_tasks_;
+    pool_->Post([this, due = std::move(due)]() mutable {
+      Deliver(std::move(due));
+      FinishTask();
+    });
+  }
+}
+
+bool DirectoryScan::TakeDueBatch(std::vector<ScanEntry>* due) {
+  if (batch_.empty()) {
+    return false;
+  }
+  if (batch_.size() < options_.batch_size &&
+      std::chrono::steady_clock::now() - batch_started_ <
+          options_.batch_interval) {
+    return false;
+  }
+  due->swap(batch_);
+  ++unacknowledged_;
+  return true;
+}
+
+void DirectoryScan::Deliver(std::vector<ScanEntry> batch) {
+  std::lock_guard<std::mutex> lock(sink_mutex_);
+  sink_(std::move(batch), nullptr);
+}
+
+void DirectoryScan::FinishTask() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool last = running_tasks_ == 1 && !finished_ &&
+              (pending_directories_.empty() || cancelled_);
+  if (!last) {
+    --running_tasks_;
+    Pump();
+    if (running_tasks_ == 0) {
+      idle_.notify_all();
+    }
+    return;
+  }
+
+  finished_ = true;
+  batch_changed_.notify_all();
+  std::vector<ScanEntry> batch;
+  batch.swap(batch_);
+  ScanSummary summary = summary_;
+  summary.cancelled = cancelled_;
+  lock.unlock();
+  {
+    std::lock_guard<std::mutex> sink_lock(sink_mutex_);
+    sink_(std::move(batch), &summary);
+  }
+  lock.lock();
+  --running_tasks_;
+  idle_.notify_all();
+}
+
+}  // namespace flutter_bin
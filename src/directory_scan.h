@@ -0,0 +1,177 @@
+#ifndef FLUTTER_BIN_DIRECTORY_SCAN_H_
+#define FLUTTER_BIN_DIRECTORY_SCAN_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "binary_format.h"
+#include "binary_metadata.h"
+#include "directory_list.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+
+struct ScanOptions {
+  // Lower-case extensions without the dot (e.g. "exe"). Empty scans every
+  // file; either way only files with executable magic bytes are reported.
+  std::vector<std::string> extensions;
+  // Levels below the root to descend into; negative means unlimited.
+  int max_depth = -1;
+  bool follow_links = false;
+  // A batch is delivered once it holds |batch_size| entries or its first
+  // entry is |batch_interval| old, whichever comes first.
+  size_t batch_size = 256;
+  std::chrono::milliseconds batch_interval{50};
+  // Delivered batches that have not been acknowledged yet. The walk pauses
+  // while this many are outstanding, also in the middle of a directory.
+  // Must be at least 1.
+  size_t max_unacknowledged_batches = 4;
+  // Directories read at once; 0 uses half the pool threads.
+  size_t parallelism = 0;
+};
+
+struct ScanEntry {
+  std::string path;
+  BinaryFormat format = BinaryFormat::kUnknown;
+  BinaryMetadata metadata;
+};
+
+struct ScanSummary {
+  uint64_t directories = 0;
+  uint64_t files = 0;
+  uint64_t binaries = 0;
+  // Directories that could not be read.
+  uint64_t errors = 0;
+  bool cancelled = false;
+  // The root itself could not be read.
+  bool root_failed = false;
+};
+
+// Whether the file |name| has one of |extensions| (lower-case, without the
+// dot), compared case-insensitively. An empty list matches every name.
+bool MatchesExtension(const std::string& name,
+                      const std::vector<std::string>& extensions);
+
+// Walks a directory tree on a ThreadPool and reports the executables in it
+// in batches.
+//
+// Directories are read in parallel, but never more than |parallelism| at a
+// time, so a scan leaves room in the pool for other requests and its memory
+// use does not grow with the size of the tree. Batches go to a sink on the
+// pool threads; the consumer acknowledges each one, and while too many are
+// outstanding the walk stops picking up new directories and the running
+// ones set their unread entries aside, returning their threads to the pool
+// until an acknowledgement lets them go on. A thread of the scan's own
+// watches the age of the pending batch, so it goes out on time even while
+// no binary is being added to it.
+class DirectoryScan {
+ public:
+  // Reads the metadata of one detected binary.
+  using Reader =
+      std::function<BinaryMetadata(const std::string& path, BinaryFormat format)>;
+
+  // Receives each batch. |summary| is null except on the final call, which
+  // comes exactly once, after every other call has returned, and may carry
+  // an empty batch. Calls never overlap.
+  using Sink = std::function<void(std::vector<ScanEntry> batch,
+                                  const ScanSummary* summary)>;
+
+  // |pool| must outlive the scan.
+  DirectoryScan(ThreadPool* pool, ScanOptions options, Reader read, Sink sink);
+
+  // Cancels the walk and waits for running work, including the final sink
+  // call.
+  ~DirectoryScan();
+
+  // Disallow copy and assign.
+  DirectoryScan(const DirectoryScan&) = delete;
+  DirectoryScan& operator=(const DirectoryScan&) = delete;
+
+  // Starts walking |root|. Call once.
+  void Start(const std::string& root);
+
+  // Stops picking up new directories; the final batch follows soon after.
+  void Cancel();
+
+  // Marks one delivered batch as consumed, letting a paused walk resume.
+  void Acknowledge();
+
+ private:
+  struct Progress;
+
+  struct Directory {
+    std::string path;
+    int depth = 0;
+    // Set when a read paused for credit part way through the directory.
+    std::shared_ptr<Progress> progress;
+  };
+
+  // What a paused read had listed and found so far.
+  struct Progress {
+    std::vector<DirectoryEntry> entries;
+    size_t next_entry = 0;
+    std::vector<Directory> subdirectories;
+    uint64_t files = 0;
+    uint64_t binaries = 0;
+  };
+
+  // Posts directory tasks while there is work, capacity and credit.
+  // |mutex_| must be held.
+  void Pump();
+
+  void ReadDirectory(Directory directory);
+
+  // Runs on |flusher_|: delivers the pending batch once it is
+  // |batch_interval| old, until the scan has finished.
+  void FlushOnDeadline();
+
+  // Takes the pending batch out if it is full or old enough, counting it as
+  // unacknowledged. |mutex_| must be held.
+  bool TakeDueBatch(std::vector<ScanEntry>* due);
+
+  void Deliver(std::vector<ScanEntry> batch);
+
+  // Ends a task: delivers the final batch if it was the last one.
+  void FinishTask();
+
+  ThreadPool* pool_;
+  const ScanOptions options_;
+  const Reader read_;
+  const Sink sink_;
+  size_t parallelism_;
+
+  std::mutex mutex_;
+  std::condition_variable idle_;
+  // Walked depth-first; a paused directory goes back on top.
+  std::vector<Directory> pending_directories_;
+  std::set<std::pair<uint64_t, uint64_t>> visited_;  // With follow_links.
+  size_t running_tasks_ = 0;
+  size_t unacknowledged_ = 0;
+  bool cancelled_ = false;
+  bool finished_ = false;
+  std::vector<ScanEntry> batch_;
+  std::chrono::steady_clock::time_point batch_started_;
+  // Signalled when the pending batch gets its first entry and when the scan
+  // finishes.
+  std::condition_variable batch_changed_;
+  ScanSummary summary_;
+
+  // Serializes sink calls.
+  std::mutex sink_mutex_;
+
+  std::thread flusher_;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_DIRECTORY_SCAN_H_
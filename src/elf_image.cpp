@@ -0,0 +1,468 @@
+#include "elf_image.h"
+
+#include <cstring>
+#include <limits>
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr size_t kIdentClass = 4;
+constexpr size_t kIdentData = 5;
+constexpr uint8_t kClass32 = 1;
+constexpr uint8_t kClass64 = 2;
+constexpr uint8_t kDataLittleEndian = 1;
+constexpr uint8_t kDataBigEndian = 2;
+
+constexpr size_t kHeaderSize32 = 52;
+constexpr size_t kHeaderSize64 = 64;
+constexpr size_t kSectionHeaderSize32 = 40;
+constexpr size_t kSectionHeaderSize64 = 64;
+constexpr size_t kProgramHeaderSize32 = 32;
+constexpr size_t kProgramHeaderSize64 = 56;
+// Real images have a few dozen; this only bounds hostile headers.
+constexpr size_t kMaxSections = 0x10000;
+
+constexpr uint16_t kSectionIndexExtended = 0xFFFF;  // SHN_XINDEX
+
+constexpr uint32_t kSectionTypeNote = 7;    // SHT_NOTE
+constexpr uint32_t kSectionTypeNoBits = 8;  // SHT_NOBITS
+constexpr uint32_t kSegmentTypeLoad = 1;     // PT_LOAD
+constexpr uint32_t kSegmentTypeDynamic = 2;  // PT_DYNAMIC
+constexpr uint32_t kSegmentTypeNote = 4;     // PT_NOTE
+
+constexpr uint32_t kNoteGnuBuildId = 3;  // NT_GNU_BUILD_ID
+
+constexpr uint64_t kDynamicNull = 0;
+constexpr uint64_t kDynamicNeeded = 1;
+constexpr uint64_t kDynamicStringTable = 5;
+constexpr uint64_t kDynamicStringTableSize = 10;
+constexpr uint64_t kDynamicSoname = 14;
+constexpr uint64_t kDynamicFlags1 = 0x6FFFFFFB;
+constexpr uint64_t kDynamicVersionDefinitions = 0x6FFFFFFC;
+constexpr uint64_t kDynamicVersionDefinitionCount = 0x6FFFFFFD;
+constexpr uint64_t kDynamicFlag1Pie = 0x08000000;  // DF_1_PIE
+
+constexpr size_t kVersionDefinitionSize = 20;  // Elf{32,64}_Verdef
+constexpr size_t kVersionAuxSize = 8;          // Elf{32,64}_Verdaux
+constexpr uint16_t kVersionFlagBase = 1;       // VER_FLG_BASE
+constexpr size_t kMaxVersionDefinitions = 4096;
+
+bool ViewEquals(ByteView view, const char* text) {
+  size_t length = std::strlen(text);
+  return view.size == length && std::memcmp(view.data, text, length) == 0;
+}
+
+// Narrows a 64-bit file offset or size, failing on 32-bit hosts when it
+// cannot possibly lie inside a mapping.
+bool ToSize(uint64_t value, size_t* out) {
+  if (value > std::numeric_limits<size_t>::max()) {
+    return false;
+  }
+  *out = static_cast<size_t>(value);
+  return true;
+}
+
+}  // namespace
+
+bool ElfImage::Parse(ByteView image) {
+  *this = ElfImage();
+  if (!image.Contains(0, kHeaderSize32) || image.data[0] != 0x7F ||
+      image.data[1] != 'E' || image.data[2] != 'L' || image.data[3] != 'F') {
+    return false;
+  }
+  uint8_t elf_class = image.data[kIdentClass];
+  uint8_t data = image.data[kIdentData];
+  if ((elf_class != kClass32 && elf_class != kClass64) ||
+      (data != kDataLittleEndian && data != kDataBigEndian)) {
+    return false;
+  }
+  is_64bit_ = elf_class == kClass64;
+  big_endian_ = data == kDataBigEndian;
+  if (is_64bit_ && !image.Contains(0, kHeaderSize64)) {
+    return false;
+  }
+  image_ = image;
+
+  const uint8_t* header = image.data;
+  type_ = Load16(header + 16);
+  machine_ = Load16(header + 18);
+  uint64_t segment_offset = is_64bit_ ? Load64(header + 32) : Load32(header + 28);
+  uint64_t section_offset = is_64bit_ ? Load64(header + 40) : Load32(header + 32);
+  const uint8_t* counts = header + (is_64bit_ ? 54 : 42);
+  size_t segment_entry_size = Load16(counts);
+  size_t segment_count = Load16(counts + 2);
+  size_t section_entry_size = Load16(counts + 4);
+  size_t section_count = Load16(counts + 6);
+  size_t section_names_index = Load16(counts + 8);
+
+  // Tables that are missing or malformed are ignored rather than rejected:
+  // the ELF header alone still identifies the image.
+  if (segment_count != 0 &&
+      segment_entry_size >= (is_64bit_ ? kProgramHeaderSize64
+                                       : kProgramHeaderSize32) &&
+      ToSize(segment_offset, &segment_table_offset_) &&
+      image.Contains(segment_table_offset_,
+                     segment_count * segment_entry_size)) {
+    segment_entry_size_ = segment_entry_size;
+    segment_count_ = segment_count;
+  }
+
+  if (section_offset == 0 ||
+      section_entry_size < (is_64bit_ ? kSectionHeaderSize64
+                                      : kSectionHeaderSize32) ||
+      !ToSize(section_offset, &section_table_offset_) ||
+      !image.Contains(section_table_offset_, section_entry_size)) {
+    section_table_offset_ = 0;
+    return true;
+  }
+  section_entry_size_ = section_entry_size;
+  section_count_ = 1;
+  // With more than 0xFF00 sections the real count and name table index are
+  // kept in section 0.
+  ElfSection first = section(0);
+  if (section_count == 0 && !ToSize(first.size, &section_count)) {
+    section_count = 0;
+  }
+  if (section_names_index == kSectionIndexExtended) {
+    section_names_index = first.link;
+  }
+  if (section_count == 0 || section_count > kMaxSections ||
+      !image.Contains(section_table_offset_,
+                      section_count * section_entry_size)) {
+    section_count_ = 0;
+    return true;
+  }
+  section_count_ = section_count;
+  section_names_index_ = section_names_index;
+  return true;
+}
+
+ElfSection ElfImage::section(size_t index) const {
+  ElfSection result;
+  if (index >= section_count_) {
+    return result;
+  }
+  const uint8_t* entry =
+      image_.data + section_table_offset_ + index * section_entry_size_;
+  result.name = Load32(entry);
+  result.type = Load32(entry + 4);
+  if (is_64bit_) {
+    result.offset = Load64(entry + 24);
+    result.size = Load64(entry + 32);
+    result.link = Load32(entry + 40);
+    result.alignment = Load64(entry + 48);
+  } else {
+    result.offset = Load32(entry + 16);
+    result.size = Load32(entry + 20);
+    result.link = Load32(entry + 24);
+    result.alignment = Load32(entry + 32);
+  }
+  return result;
+}
+
+ByteView ElfImage::SectionName(const ElfSection& section) const {
+  if (section_names_index_ == 0 || section_names_index_ >= section_count_) {
+    return ByteView();
+  }
+  return StringAt(SectionData(this->section(section_names_index_)),
+                  section.name);
+}
+
+bool ElfImage::FindSection(const char* name, ElfSection* section) const {
+  for (size_t i = 1; i < section_count_; ++i) {
+    ElfSection candidate = this->section(i);
+    if (ViewEquals(SectionName(candidate), name)) {
+      *section = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+ByteView ElfImage::SectionData(const ElfSection& section) const {
+  size_t offset = 0;
+  size_t size = 0;
+  if (section.type == kSectionTypeNoBits || !ToSize(section.offset, &offset) ||
+      !ToSize(section.size, &size)) {
+    return ByteView();
+  }
+  return image_.Sub(offset, size);
+}
+
+ElfSegment ElfImage::segment(size_t index) const {
+  ElfSegment result;
+  if (index >= segment_count_) {
+    return result;
+  }
+  const uint8_t* entry =
+      image_.data + segment_table_offset_ + index * segment_entry_size_;
+  result.type = Load32(entry);
+  if (is_64bit_) {
+    result.offset = Load64(entry + 8);
+    result.virtual_address = Load64(entry + 16);
+    result.file_size = Load64(entry + 32);
+    result.alignment = Load64(entry + 48);
+  } else {
+    result.offset = Load32(entry + 4);
+    result.virtual_address = Load32(entry + 8);
+    result.file_size = Load32(entry + 16);
+    result.alignment = Load32(entry + 28);
+  }
+  return result;
+}
+
+bool ElfImage::AddressToOffset(uint64_t address, size_t* offset) const {
+  for (size_t i = 0; i < segment_count_; ++i) {
+    ElfSegment load = segment(i);
+    if (load.type == kSegmentTypeLoad && address >= load.virtual_address &&
+        address - load.virtual_address < load.file_size) {
+      return ToSize(load.offset + (address - load.virtual_address), offset);
+    }
+  }
+  return false;
+}
+
+ByteView ElfImage::FindBuildId() const {
+  return FindNote("GNU", kNoteGnuBuildId);
+}
+
+ByteView ElfImage::FindNote(const char* owner, uint32_t type) const {
+  for (size_t i = 1; i < section_count_; ++i) {
+    ElfSection candidate = section(i);
+    if (candidate.type != kSectionTypeNote) {
+      continue;
+    }
+    ByteView found =
+        FindNoteIn(SectionData(candidate), candidate.alignment, owner, type);
+    if (!found.empty()) {
+      return found;
+    }
+  }
+  for (size_t i = 0; i < segment_count_; ++i) {
+    ElfSegment candidate = segment(i);
+    size_t offset = 0;
+    size_t size = 0;
+    if (candidate.type != kSegmentTypeNote ||
+        !ToSize(candidate.offset, &offset) ||
+        !ToSize(candidate.file_size, &size)) {
+      continue;
+    }
+    ByteView found = FindNoteIn(image_.Sub(offset, size), candidate.alignment,
+                                owner, type);
+    if (!found.empty()) {
+      return found;
+    }
+  }
+  return ByteView();
+}
+
+ByteView ElfImage::FindNoteIn(ByteView notes, uint64_t alignment,
+                              const char* owner, uint32_t type) const {
+  // Notes are 4-byte aligned, except in the few 8-byte aligned sections such
+  // as .note.gnu.property.
+  size_t align = alignment == 8 ? 8 : 4;
+  auto pad = [align](size_t value) { return (value + align - 1) & ~(align - 1); };
+  size_t owner_length = std::strlen(owner) + 1;
+  size_t offset = 0;
+  while (notes.Contains(offset, 12)) {
+    size_t name_size = Load32(notes.data + offset);
+    size_t descriptor_size = Load32(notes.data + offset + 4);
+    uint32_t note_type = Load32(notes.data + offset + 8);
+    size_t name_offset = offset + 12;
+    if (!notes.Contains(name_offset, name_size)) {
+      break;
+    }
+    size_t descriptor_offset = pad(name_offset + name_size);
+    if (!notes.Contains(descriptor_offset, descriptor_size)) {
+      break;
+    }
+    if (note_type == type && name_size == owner_length &&
+        std::memcmp(notes.data + name_offset, owner, owner_length) == 0) {
+      return notes.Sub(descriptor_offset, descriptor_size);
+    }
+    offset = pad(descriptor_offset + descriptor_size);
+  }
+  return ByteView();
+}
+
+bool ElfImage::ReadDynamic(ElfDynamicInfo* info) const {
+  ByteView dynamic;
+  for (size_t i = 0; i < segment_count_; ++i) {
+    ElfSegment candidate = segment(i);
+    size_t offset = 0;
+    size_t size = 0;
+    if (candidate.type == kSegmentTypeDynamic &&
+        ToSize(candidate.offset, &offset) &&
+        ToSize(candidate.file_size, &size)) {
+      dynamic = image_.Sub(offset, size);
+      break;
+    }
+  }
+  if (dynamic.empty()) {
+    return false;
+  }
+
+  uint64_t string_table_address = 0;
+  uint64_t string_table_size = 0;
+  uint64_t soname = 0;
+  bool has_soname = false;
+  std::vector<uint64_t> needed;
+  uint64_t version_definitions = 0;
+  uint64_t version_definition_count = 0;
+  size_t entry_size = is_64bit_ ? 16 : 8;
+  size_t word_size = entry_size / 2;
+  for (size_t offset = 0; dynamic.Contains(offset, entry_size);
+       offset += entry_size) {
+    uint64_t tag = LoadWord(dynamic.data + offset);
+    uint64_t value = LoadWord(dynamic.data + offset + word_size);
+    if (tag == kDynamicNull) {
+      break;
+    }
+    switch (tag) {
+      case kDynamicNeeded:
+        needed.push_back(value);
+        break;
+      case kDynamicStringTable:
+        string_table_address = value;
+        break;
+      case kDynamicStringTableSize:
+        string_table_size = value;
+        break;
+      case kDynamicSoname:
+        soname = value;
+        has_soname = true;
+        break;
+      case kDynamicFlags1:
+        info->position_independent_executable =
+            (value & kDynamicFlag1Pie) != 0;
+        break;
+      case kDynamicVersionDefinitions:
+        version_definitions = value;
+        break;
+      case kDynamicVersionDefinitionCount:
+        version_definition_count = value;
+        break;
+      default:
+        break;
+    }
+  }
+
+  size_t string_table_offset = 0;
+  size_t size = 0;
+  ByteView strings;
+  if (AddressToOffset(string_table_address, &string_table_offset)) {
+    strings = ToSize(string_table_size, &size) && size != 0
+                  ? image_.Sub(string_table_offset, size)
+                  : image_.From(string_table_offset);
+  }
+  if (has_soname) {
+    info->soname = StringAt(strings, soname);
+  }
+  for (uint64_t name : needed) {
+    ByteView library = StringAt(strings, name);
+    if (!library.empty()) {
+      info->needed.push_back(library);
+    }
+  }
+
+  size_t definition_offset = 0;
+  if (version_definition_count != 0 &&
+      AddressToOffset(version_definitions, &definition_offset)) {
+    for (uint64_t i = 0; i < version_definition_count &&
+                         i < kMaxVersionDefinitions &&
+                         image_.Contains(definition_offset, kVersionDefinitionSize);
+         ++i) {
+      const uint8_t* definition = image_.data + definition_offset;
+      uint16_t flags = Load16(definition + 2);
+      uint32_t aux = Load32(definition + 12);
+      uint32_t next = Load32(definition + 16);
+      if ((flags & kVersionFlagBase) == 0 &&
+          image_.Contains(definition_offset + aux, kVersionAuxSize)) {
+        ByteView name =
+            StringAt(strings, Load32(image_.data + definition_offset + aux));
+        if (!name.empty()) {
+          info->version_definitions.push_back(name);
+        }
+      }
+      if (next == 0) {
+        break;
+      }
+      definition_offset += next;
+    }
+  }
+  return true;
+}
+
+void ElfImage::ReadComments(std::vector<ByteView>* comments) const {
+  ElfSection section;
+  if (!FindSection(".comment", &section)) {
+    return;
+  }
+  ByteView data = SectionData(section);
+  size_t offset = 0;
+  while (offset < data.size) {
+    ByteView comment = StringAt(data, offset);
+    if (comment.data == nullptr) {
+      break;
+    }
+    offset += comment.size + 1;
+    if (comment.empty()) {
+      continue;
+    }
+    bool seen = false;
+    for (const ByteView& other : *comments) {
+      if (other.size == comment.size &&
+          std::memcmp(other.data, comment.data, comment.size) == 0) {
+        seen = true;
+        break;
+      }
+    }
+    if (!seen) {
+      comments->push_back(comment);
+    }
+  }
+}
+
+// static
+ByteView ElfImage::StringAt(ByteView table, uint64_t offset) {
+  if (offset >= table.size) {
+    return ByteView();
+  }
+  size_t start = static_cast<size_t>(offset);
+  const void* end = std::memchr(table.data + start, 0, table.size - start);
+  if (end == nullptr) {
+    return ByteView();
+  }
+  return ByteView(table.data + start,
+                  static_cast<const uint8_t*>(end) - (table.data + start));
+}
+
+const char* ElfMachineName(uint16_t machine) {
+  switch (machine) {
+    case 3:
+      return "x86";
+    case 8:
+      return "MIPS";
+    case 20:
+      return "PowerPC";
+    case 21:
+      return "PowerPC64";
+    case 22:
+      return "S/390";
+    case 40:
+      return "ARM";
+    case 62:
+      return "x86-64";
+    case 183:
+      return "AArch64";
+    case 243:
+      return "RISC-V";
+    case 258:
+      return "LoongArch";
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace flutter_bin
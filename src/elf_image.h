@@ -0,0 +1,148 @@
+#ifndef FLUTTER_BIN_ELF_IMAGE_H_
+#define FLUTTER_BIN_ELF_IMAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+// e_type values.
+enum ElfType : uint16_t {
+  kElfTypeRelocatable = 1,
+  kElfTypeExecutable = 2,
+  kElfTypeShared = 3,
+  kElfTypeCore = 4,
+};
+
+// Decoded copy of one section header.
+struct ElfSection {
+  uint32_t name = 0;
+  uint32_t type = 0;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  uint32_t link = 0;
+  uint64_t alignment = 0;
+};
+
+// Decoded copy of one program header.
+struct ElfSegment {
+  uint32_t type = 0;
+  uint64_t offset = 0;
+  uint64_t virtual_address = 0;
+  uint64_t file_size = 0;
+  uint64_t alignment = 0;
+};
+
+// What the dynamic section says about the image. Strings point into the
+// image and exclude their terminating NUL.
+struct ElfDynamicInfo {
+  ByteView soname;
+  std::vector<ByteView> needed;
+  // Names of the non-base symbol versions the image defines, in order, e.g.
+  // "LIBFOO_1.0", "LIBFOO_1.2" (DT_VERDEF).
+  std::vector<ByteView> version_definitions;
+  // DF_1_PIE is set: an ET_DYN image that is really an executable.
+  bool position_independent_executable = false;
+};
+
+// Reader for ELF images of either class and byte order.
+//
+// Like PeImage it parses an image held in memory without copying it; all
+// returned views point into the buffer passed to Parse(), which must outlive
+// this object. Only the headers and the sections a caller asks about are
+// touched, so a mapped file faults in a handful of pages.
+class ElfImage {
+ public:
+  ElfImage() = default;
+
+  // Validates the ELF header of |image|. Returns false if it is not ELF.
+  bool Parse(ByteView image);
+
+  ByteView image() const { return image_; }
+  bool is_64bit() const { return is_64bit_; }
+  bool is_big_endian() const { return big_endian_; }
+  uint16_t type() const { return type_; }
+  uint16_t machine() const { return machine_; }
+
+  size_t section_count() const { return section_count_; }
+  ElfSection section(size_t index) const;
+
+  // Returns the name of |section| from the section name table.
+  ByteView SectionName(const ElfSection& section) const;
+
+  // Finds the first section called |name|.
+  bool FindSection(const char* name, ElfSection* section) const;
+
+  // Returns the file bytes of |section|; empty for SHT_NOBITS sections.
+  ByteView SectionData(const ElfSection& section) const;
+
+  size_t segment_count() const { return segment_count_; }
+  ElfSegment segment(size_t index) const;
+
+  // Translates a virtual address into a file offset through the PT_LOAD
+  // segments. Returns false if no segment maps it from the file.
+  bool AddressToOffset(uint64_t address, size_t* offset) const;
+
+  // Returns the GNU build-id (NT_GNU_BUILD_ID) bytes, or an empty view.
+  ByteView FindBuildId() const;
+
+  // Returns the descriptor of the first note of |type| owned by |owner|
+  // (e.g. "GNU"), looking at note sections first and PT_NOTE segments when
+  // the section table has been stripped.
+  ByteView FindNote(const char* owner, uint32_t type) const;
+
+  // Reads SONAME, DT_NEEDED and version definitions from PT_DYNAMIC.
+  // Returns false if the image is not dynamically linked.
+  bool ReadDynamic(ElfDynamicInfo* info) const;
+
+  // Appends each distinct NUL-terminated string of the .comment section
+  // (compiler and linker identification) to |comments|.
+  void ReadComments(std::vector<ByteView>* comments) const;
+
+ private:
+  uint16_t Load16(const uint8_t* p) const {
+    return big_endian_ ? LoadBe16(p) : LoadLe16(p);
+  }
+  uint32_t Load32(const uint8_t* p) const {
+    return big_endian_ ? LoadBe32(p) : LoadLe32(p);
+  }
+  uint64_t Load64(const uint8_t* p) const {
+    return big_endian_ ? LoadBe64(p) : LoadLe64(p);
+  }
+  // Loads a word of the image's class: 8 bytes for ELF64, 4 for ELF32.
+  uint64_t LoadWord(const uint8_t* p) const {
+    return is_64bit_ ? Load64(p) : Load32(p);
+  }
+
+  // Searches the notes in |notes| for |owner| and |type|.
+  ByteView FindNoteIn(ByteView notes, uint64_t alignment, const char* owner,
+                      uint32_t type) const;
+
+  // Returns the NUL-terminated string at |offset| of |table|, or an empty
+  // view if it is unterminated.
+  static ByteView StringAt(ByteView table, uint64_t offset);
+
+  ByteView image_;
+  bool is_64bit_ = false;
+  bool big_endian_ = false;
+  uint16_t type_ = 0;
+  uint16_t machine_ = 0;
+  size_t section_table_offset_ = 0;
+  size_t section_entry_size_ = 0;
+  size_t section_count_ = 0;
+  size_t section_names_index_ = 0;
+  size_t segment_table_offset_ = 0;
+  size_t segment_entry_size_ = 0;
+  size_t segment_count_ = 0;
+};
+
+// Returns the conventional name of an e_machine value, e.g. "x86-64", or
+// null for machines it does not know.
+const char* ElfMachineName(uint16_t machine);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_ELF_IMAGE_H_
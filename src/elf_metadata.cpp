@@ -0,0 +1,252 @@
+#include "elf_metadata.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flutter_bin {
+
+namespace {
+
+// NT_FDO_PACKAGING_METADATA, see https://systemd.io/ELF_PACKAGE_METADATA/
+constexpr uint32_t kNotePackagingMetadata = 0xCAFE1A7E;
+
+void Append(ByteView text, std::string* out) {
+  out->append(reinterpret_cast<const char*>(text.data), text.size);
+}
+
+bool IsDigit(uint8_t c) { return c >= '0' && c <= '9'; }
+
+// Reads the string member |key| of the flat JSON object in |json|. Only the
+// escapes that can appear in names and version numbers are decoded.
+bool ReadJsonString(ByteView json, const char* key, std::string* out) {
+  std::string quoted = std::string("\"") + key + "\"";
+  const char* begin = reinterpret_cast<const char*>(json.data);
+  const char* end = begin + json.size;
+  for (const char* p = begin; p + quoted.size() <= end; ++p) {
+    if (std::memcmp(p, quoted.data(), quoted.size()) != 0) {
+      continue;
+    }
+    const char* q = p + quoted.size();
+    while (q < end && (*q == ' ' || *q == '\t' || *q == '\n' || *q == '\r')) {
+      ++q;
+    }
+    if (q == end || *q != ':') {
+      continue;
+    }
+    ++q;
+    while (q < end && (*q == ' ' || *q == '\t' || *q == '\n' || *q == '\r')) {
+      ++q;
+    }
+    if (q == end || *q != '"') {
+      continue;
+    }
+    std::string value;
+    for (++q; q < end && *q != '"'; ++q) {
+      if (*q == '\\' && q + 1 < end) {
+        ++q;
+      }
+      value.push_back(*q);
+    }
+    if (q == end) {
+      return false;
+    }
+    *out = std::move(value);
+    return true;
+  }
+  return false;
+}
+
+// Splits "LIBFOO_1.2" into "LIBFOO" and "1.2". Returns false for names such
+// as "GLIBC_PRIVATE" that do not end in a version number.
+bool SplitDefinition(ByteView name, ByteView* prefix, ByteView* version) {
+  for (size_t i = name.size; i > 0; --i) {
+    if (name.data[i - 1] == '_') {
+      *prefix = name.Sub(0, i - 1);
+      *version = name.From(i);
+      return !version->empty() && IsDigit(version->data[0]);
+    }
+  }
+  return false;
+}
+
+// Returns the version of the newest definition in the family of the first
+// versioned one, e.g. "2.38" from GLIBC_2.2.5 ... GLIBC_2.38, GLIBC_PRIVATE.
+// Linkers keep definitions in version script order, oldest first.
+ByteView VersionOfDefinitions(const std::vector<ByteView>& definitions) {
+  ByteView family;
+  ByteView latest;
+  for (const ByteView& definition : definitions) {
+    ByteView prefix;
+    ByteView version;
+    if (!SplitDefinition(definition, &prefix, &version)) {
+      continue;
+    }
+    if (family.data == nullptr) {
+      family = prefix;
+    }
+    if (prefix.size == family.size &&
+        std::memcmp(prefix.data, family.data, prefix.size) == 0) {
+      latest = version;
+    }
+  }
+  return latest;
+}
+
+// "libfoo.so.1.2" -> "1.2"
+ByteView VersionOfSoname(ByteView soname) {
+  static const char kSuffix[] = ".so.";
+  constexpr size_t kSuffixLength = sizeof(kSuffix) - 1;
+  for (size_t i = 0; i + kSuffixLength < soname.size; ++i) {
+    if (std::memcmp(soname.data + i, kSuffix, kSuffixLength) == 0 &&
+        IsDigit(soname.data[i + kSuffixLength])) {
+      return soname.From(i + kSuffixLength);
+    }
+  }
+  return ByteView();
+}
+
+const char* TypeName(const ElfImage& image, bool pie) {
+  switch (image.type()) {
+    case kElfTypeRelocatable:
+      return "relocatable";
+    case kElfTypeExecutable:
+      return "executable";
+    case kElfTypeShared:
+      return pie ? "executable" : "shared object";
+    case kElfTypeCore:
+      return "core";
+    default:
+      return "unknown";
+  }
+}
+
+// Answers field lookups for one image, reading each part of it at most once
+// and only when a requested field needs it.
+class ElfFields {
+ public:
+  explicit ElfFields(const ElfImage& image) : image_(image) {}
+
+  // Appends the value of |key| to |out|. Returns false for unknown keys.
+  bool Get(const std::string& key, std::string* out) {
+    if (key == kVersionKey) {
+      AppendVersion(out);
+    } else if (key == "productName") {
+      ReadPackage();
+      *out += package_name_;
+    } else if (key == "fileDescription") {
+      *out += image_.is_64bit() ? "ELF 64-bit " : "ELF 32-bit ";
+      AppendMachine(out);
+      *out += ' ';
+      *out += TypeName(image_, dynamic().position_independent_executable);
+    } else if (key == "originalFilename" || key == "soname") {
+      Append(dynamic().soname, out);
+    } else if (key == "companyName" || key == "legalCopyright") {
+      // No ELF counterpart.
+    } else if (key == "buildId") {
+      static const char kHex[] = "0123456789abcdef";
+      ByteView id = image_.FindBuildId();
+      for (size_t i = 0; i < id.size; ++i) {
+        out->push_back(kHex[id.data[i] >> 4]);
+        out->push_back(kHex[id.data[i] & 0xF]);
+      }
+    } else if (key == "needed") {
+      const std::vector<ByteView>& needed = dynamic().needed;
+      for (size_t i = 0; i < needed.size(); ++i) {
+        if (i != 0) {
+          out->push_back(',');
+        }
+        Append(needed[i], out);
+      }
+    } else if (key == "comment") {
+      std::vector<ByteView> comments;
+      image_.ReadComments(&comments);
+      for (size_t i = 0; i < comments.size(); ++i) {
+        if (i != 0) {
+          out->push_back('\n');
+        }
+        Append(comments[i], out);
+      }
+    } else if (key == "elfClass") {
+      *out += image_.is_64bit() ? "ELF64" : "ELF32";
+    } else if (key == "machine") {
+      AppendMachine(out);
+    } else if (key == "elfType") {
+      *out += TypeName(image_, dynamic().position_independent_executable);
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  const ElfDynamicInfo& dynamic() {
+    if (!dynamic_read_) {
+      image_.ReadDynamic(&dynamic_);
+      dynamic_read_ = true;
+    }
+    return dynamic_;
+  }
+
+  void ReadPackage() {
+    if (package_read_) {
+      return;
+    }
+    package_read_ = true;
+    ByteView note = image_.FindNote("FDO", kNotePackagingMetadata);
+    if (!note.empty()) {
+      ReadJsonString(note, "name", &package_name_);
+      ReadJsonString(note, "version", &package_version_);
+    }
+  }
+
+  void AppendVersion(std::string* out) {
+    ReadPackage();
+    if (!package_version_.empty()) {
+      *out += package_version_;
+      return;
+    }
+    ByteView version = VersionOfDefinitions(dynamic().version_definitions);
+    if (version.empty()) {
+      version = VersionOfSoname(dynamic().soname);
+    }
+    Append(version, out);
+  }
+
+  void AppendMachine(std::string* out) {
+    const char* name = ElfMachineName(image_.machine());
+    if (name != nullptr) {
+      *out += name;
+    } else {
+      *out += "EM_" + std::to_string(image_.machine());
+    }
+  }
+
+  const ElfImage& image_;
+  ElfDynamicInfo dynamic_;
+  bool dynamic_read_ = false;
+  std::string package_name_;
+  std::string package_version_;
+  bool package_read_ = false;
+};
+
+}  // namespace
+
+void ReadElfMetadata(const ElfImage& image, const MetadataRequest& request,
+                     BinaryMetadata* metadata) {
+  ElfFields fields(image);
+  if (request.version) {
+    std::string version;
+    fields.Get(kVersionKey, &version);
+    if (!version.empty()) {
+      metadata->fields[kVersionKey] = std::move(version);
+    }
+  }
+  for (const auto& field : request.strings) {
+    // Unknown keys are reported empty, like missing version resource keys.
+    fields.Get(field.first, &metadata->fields[field.first]);
+  }
+}
+
+}  // namespace flutter_bin
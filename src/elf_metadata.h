@@ -0,0 +1,34 @@
+#ifndef FLUTTER_BIN_ELF_METADATA_H_
+#define FLUTTER_BIN_ELF_METADATA_H_
+
+#include "binary_metadata.h"
+#include "elf_image.h"
+
+namespace flutter_bin {
+
+// Fills the fields selected by |request| from an ELF image.
+//
+// The standard fields are mapped as follows:
+//   version           "version" of the .note.package packaging note, else
+//                     the newest symbol version the image defines (e.g.
+//                     "1.2" after "LIBFOO_1.0", "LIBFOO_1.2"), else the
+//                     SONAME suffix
+//   productName       "name" of the .note.package packaging note
+//   fileDescription   e.g. "ELF 64-bit x86-64 shared object"
+//   originalFilename  DT_SONAME
+// companyName and legalCopyright have no ELF counterpart and stay empty.
+//
+// ELF images also answer these custom keys:
+//   buildId   GNU build-id as lower-case hex
+//   soname    DT_SONAME
+//   needed    DT_NEEDED entries, comma-separated, in link order
+//   comment   .comment strings (compiler and linker), newline-separated
+//   elfClass  "ELF32" or "ELF64"
+//   machine   e.g. "x86-64", "AArch64"
+//   elfType   "executable", "shared object", "relocatable" or "core"
+void ReadElfMetadata(const ElfImage& image, const MetadataRequest& request,
+                     BinaryMetadata* metadata);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_ELF_METADATA_H_
@@ -0,0 +1,571 @@
+#include "file_head_reader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace flutter_bin {
+
+namespace {
+
+// Opens |path| into |file| and reads its first bytes into |buffer|.
+void OpenHead(const std::string& path, PositionedFile* file,
+              PositionedFile::Error* error, uint8_t* buffer,
+              size_t* head_size) {
+  if (!file->Open(path)) {
+    *error = file->error();
+    return;
+  }
+  size_t length = file->size() < FileHead::kSize
+                      ? static_cast<size_t>(file->size())
+                      : FileHead::kSize;
+  size_t read = 0;
+  // A failed read leaves the head empty; parsing then reads the file itself
+  // and reports the failure.
+  if (file->ReadAt(0, buffer, length, &read)) {
+    *head_size = read;
+  }
+}
+
+#if defined(__linux__)
+
+// What each submission did, in the low bits of its user_data.
+enum RingOp : uint64_t {
+  kOpOpen = 0,
+  kOpStat = 1,
+  kOpRead = 2,
+  kOpClose = 3,
+};
+
+uint64_t Tag(size_t slot, RingOp op) {
+  return (static_cast<uint64_t>(slot) << 2) | op;
+}
+
+PositionedFile::Error FromErrno(int error) {
+  return (error == EACCES || error == EPERM)
+             ? PositionedFile::Error::kAccessDenied
+             : PositionedFile::Error::kNotFound;
+}
+
+bool ProbeIoUring() {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  int fd = static_cast<int>(::syscall(__NR_io_uring_setup, 1, &params));
+  if (fd < 0) {
+    return false;
+  }
+  constexpr unsigned kProbeOps = 64;
+  std::vector<uint8_t> buffer(sizeof(io_uring_probe) +
+                              kProbeOps * sizeof(io_uring_probe_op));
+  auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+  bool probed = ::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE,
+                          probe, kProbeOps) == 0;
+  ::close(fd);
+  if (!probed) {
+    return false;
+  }
+  for (uint8_t op : {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ,
+                     IORING_OP_CLOSE}) {
+    if (op > probe->last_op ||
+        (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#endif
+
+}  // namespace
+
+bool FileHeadBackendSupported(FileHeadBackend backend) {
+  switch (backend) {
+    case FileHeadBackend::kThreadPool:
+      return true;
+    case FileHeadBackend::kIoUring: {
+#if defined(__linux__)
+      static const bool supported = ProbeIoUring();
+      return supported;
+#else
+      return false;
+#endif
+    }
+  }
+  return false;
+}
+
+FileHeadBackend DefaultFileHeadBackend() {
+  return FileHeadBackendSupported(FileHeadBackend::kIoUring)
+             ? FileHeadBackend::kIoUring
+             : FileHeadBackend::kThreadPool;
+}
+
+const char* FileHeadBackendName(FileHeadBackend backend) {
+  switch (backend) {
+    case FileHeadBackend::kThreadPool:
+      return "thread-pool";
+    case FileHeadBackend::kIoUring:
+      return "io-uring";
+  }
+  return "";
+}
+
+bool FileHead::ReadAt(uint64_t offset, void* buffer, size_t length,
+                      size_t* read) {
+  if (offset <= head_size_ && length <= head_size_ - offset) {
+    std::memcpy(buffer, head_ + offset, length);
+    *read = length;
+    return true;
+  }
+  return file_.ReadAt(offset, buffer, length, read);
+}
+
+#if defined(__linux__)
+
+// A minimal io_uring over the raw system calls: one submission queue and
+// one completion queue, both used by a single thread.
+class FileHeadReader::Ring {
+ public:
+  // Room for a group's opens and stats next to the previous group's
+  // closes; the completion queue is twice as large.
+  static constexpr unsigned kEntries = 4 * kGroupSize;
+
+  // Returns null if the ring cannot be set up.
+  static std::unique_ptr<Ring> Create() {
+    std::unique_ptr<Ring> ring(new Ring());
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring->fd_ =
+        static_cast<int>(::syscall(__NR_io_uring_setup, kEntries, &params));
+    if (ring->fd_ < 0) {
+      return nullptr;
+    }
+
+    ring->sq_map_size_ =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_map_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_map) {
+      ring->sq_map_size_ = ring->cq_map_size_ =
+          std::max(ring->sq_map_size_, ring->cq_map_size_);
+    }
+    ring->sq_map_ = ::mmap(nullptr, ring->sq_map_size_,
+                           PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring->fd_, IORING_OFF_SQ_RING);
+    if (ring->sq_map_ == MAP_FAILED) {
+      return nullptr;
+    }
+    ring->cq_map_ = single_map
+                        ? ring->sq_map_
+                        : ::mmap(nullptr, ring->cq_map_size_,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, ring->fd_,
+                                 IORING_OFF_CQ_RING);
+    if (ring->cq_map_ == MAP_FAILED) {
+      return nullptr;
+    }
+    ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd_,
+                        IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+      return nullptr;
+    }
+    ring->sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq = static_cast<uint8_t*>(ring->sq_map_);
+    ring->sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring->sq_entries_ = params.sq_entries;
+    ring->sq_local_tail_ = *ring->sq_tail_;
+    auto* cq = static_cast<uint8_t*>(ring->cq_map_);
+    ring->cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    ring->stats_.reset(new struct statx[2 * kGroupSize]);
+    return ring;
+  }
+
+  ~Ring() {
+    if (sqes_ != nullptr) {
+      ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_map_ != MAP_FAILED && cq_map_ != sq_map_) {
+      ::munmap(cq_map_, cq_map_size_);
+    }
+    if (sq_map_ != MAP_FAILED) {
+      ::munmap(sq_map_, sq_map_size_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  // Returns a cleared submission tagged with |user_data|, or null if the
+  // queue is full.
+  io_uring_sqe* Next(uint64_t user_data) {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ - head >= sq_entries_) {
+      return nullptr;
+    }
+    unsigned index = sq_local_tail_ & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    ++sq_local_tail_;
+    ++queued_;
+    return sqe;
+  }
+
+  // Hands every queued submission to the kernel without waiting.
+  bool Submit() {
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    while (queued_ > 0) {
+      long submitted =
+          ::syscall(__NR_io_uring_enter, fd_, queued_, 0, 0, nullptr, 0);
+      if (submitted < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      queued_ -= static_cast<unsigned>(submitted);
+      in_flight_ += static_cast<unsigned>(submitted);
+    }
+    return true;
+  }
+
+  // Takes one completion, waiting for it if none is ready.
+  bool Wait(uint64_t* user_data, int32_t* result) {
+    for (;;) {
+      unsigned head = *cq_head_;
+      if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        *user_data = cqe.user_data;
+        *result = cqe.res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        --in_flight_;
+        return true;
+      }
+      if (::syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS,
+                    nullptr, 0) < 0 &&
+          errno != EINTR) {
+        return false;
+      }
+    }
+  }
+
+  // Submissions the kernel has taken but not completed.
+  unsigned in_flight() const { return in_flight_; }
+
+  // Scratch for the statx of each slot.
+  struct statx* stats() { return stats_.get(); }
+
+ private:
+  Ring() = default;
+
+  int fd_ = -1;
+  void* sq_map_ = MAP_FAILED;
+  size_t sq_map_size_ = 0;
+  void* cq_map_ = MAP_FAILED;
+  size_t cq_map_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned sq_local_tail_ = 0;
+  unsigned queued_ = 0;
+  unsigned in_flight_ = 0;
+
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  std::unique_ptr<struct statx[]> stats_;
+};
+
+#else
+
+class FileHeadReader::Ring {};
+
+#endif
+
+FileHeadReader::FileHeadReader(ThreadPool* pool, FileHeadBackend backend)
+    : pool_(pool), backend_(backend) {
+#if defined(__linux__)
+  if (backend_ == FileHeadBackend::kIoUring) {
+    ring_ = Ring::Create();
+  }
+#endif
+  if (ring_) {
+    heads_.reset(new FileHead[2 * kGroupSize]);
+  } else {
+    backend_ = FileHeadBackend::kThreadPool;
+  }
+}
+
+FileHeadReader::~FileHeadReader() = default;
+
+void FileHeadReader::Read(const std::vector<std::string>& paths,
+                          const Consumer& consume,
+                          const std::atomic<bool>* cancelled) {
+  if (backend_ == FileHeadBackend::kIoUring) {
+    ReadWithRing(paths, consume, cancelled);
+  } else {
+    ReadWithPool(paths, 0, consume, cancelled);
+  }
+}
+
+void FileHeadReader::ReadWithPool(const std::vector<std::string>& paths,
+                                  size_t begin, const Consumer& consume,
+                                  const std::atomic<bool>* cancelled) {
+  if (begin >= paths.size()) {
+    return;
+  }
+  pool_->ParallelFor(paths.size() - begin, [&](size_t i) {
+    if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed)) {
+      return;
+    }
+    FileHead head;
+    OpenHead(paths[begin + i], &head.file_, &head.error_, head.head_,
+             &head.head_size_);
+    consume(begin + i, &head);
+  });
+}
+
+#if defined(__linux__)
+
+void FileHeadReader::ReadWithRing(const std::vector<std::string>& paths,
+                                  const Consumer& consume,
+                                  const std::atomic<bool>* cancelled) {
+  Ring& ring = *ring_;
+  int32_t open_results[2 * kGroupSize];
+  // Negative while a slot holds no descriptor of its own: before its open
+  // completes and once its head has adopted the file.
+  std::fill(open_results, open_results + 2 * kGroupSize, -ECANCELED);
+  int32_t stat_results[2 * kGroupSize];
+  size_t opens_pending = 0;
+  size_t reads_pending = 0;
+  size_t closes_pending = 0;
+  bool ok = true;
+
+  // Takes one completion; false if the ring cannot wait.
+  auto collect = [&] {
+    uint64_t user_data = 0;
+    int32_t result = 0;
+    if (!ring.Wait(&user_data, &result)) {
+      return false;
+    }
+    size_t slot = static_cast<size_t>(user_data >> 2);
+    switch (static_cast<RingOp>(user_data & 3)) {
+      case kOpOpen:
+        open_results[slot] = result;
+        --opens_pending;
+        break;
+      case kOpStat:
+        stat_results[slot] = result;
+        --opens_pending;
+        break;
+      case kOpRead:
+        heads_[slot].head_size_ =
+            result > 0 ? static_cast<size_t>(result) : 0;
+        --reads_pending;
+        break;
+      case kOpClose:
+        --closes_pending;
+        break;
+    }
+    return true;
+  };
+
+  // Takes completions until |*pending| drops to zero.
+  auto await = [&](size_t* pending) {
+    while (ok && *pending > 0) {
+      ok = collect();
+    }
+  };
+
+  auto close_slot = [&](size_t slot) {
+    int fd = heads_[slot].file_.Release();
+    io_uring_sqe* sqe = ring.Next(Tag(slot, kOpClose));
+    if (sqe == nullptr) {
+      ::close(fd);
+      return;
+    }
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = fd;
+    ++closes_pending;
+  };
+
+  // Opens and stats the group starting at |begin| into the slots from
+  // |base|, without waiting.
+  auto submit_opens = [&](size_t begin, size_t count, size_t base) {
+    for (size_t i = 0; i < count; ++i) {
+      size_t slot = base + i;
+      FileHead& head = heads_[slot];
+      head.error_ = PositionedFile::Error::kNone;
+      head.head_size_ = 0;
+      const char* path = paths[begin + i].c_str();
+      io_uring_sqe* open = ring.Next(Tag(slot, kOpOpen));
+      io_uring_sqe* stat = ring.Next(Tag(slot, kOpStat));
+      if (open == nullptr || stat == nullptr) {
+        ok = false;
+        return;
+      }
+      open->opcode = IORING_OP_OPENAT;
+      open->fd = AT_FDCWD;
+      open->addr = reinterpret_cast<uintptr_t>(path);
+      open->open_flags = O_RDONLY | O_CLOEXEC;
+      stat->opcode = IORING_OP_STATX;
+      stat->fd = AT_FDCWD;
+      stat->addr = reinterpret_cast<uintptr_t>(path);
+      stat->len = STATX_TYPE | STATX_SIZE;
+      stat->off = reinterpret_cast<uintptr_t>(&ring.stats()[slot]);
+      stat->statx_flags = AT_STATX_SYNC_AS_STAT;
+      opens_pending += 2;
+    }
+    ok = ok && ring.Submit();
+  };
+
+  // Checks what the opens found and reads the heads of the files that are
+  // worth reading, then waits for them.
+  auto read_heads = [&](size_t count, size_t base) {
+    await(&opens_pending);
+    for (size_t i = 0; ok && i < count; ++i) {
+      size_t slot = base + i;
+      FileHead& head = heads_[slot];
+      const struct statx& stat = ring.stats()[slot];
+      if (open_results[slot] < 0) {
+        head.error_ = FromErrno(-open_results[slot]);
+        continue;
+      }
+      head.file_.Adopt(open_results[slot], stat.stx_size);
+      open_results[slot] = -ECANCELED;
+      if (stat_results[slot] < 0) {
+        head.error_ = FromErrno(-stat_results[slot]);
+      } else if (!S_ISREG(stat.stx_mode)) {
+        head.error_ = PositionedFile::Error::kNotRegularFile;
+      } else if (stat.stx_size == 0) {
+        head.error_ = PositionedFile::Error::kEmpty;
+      }
+      if (head.error_ != PositionedFile::Error::kNone) {
+        close_slot(slot);
+        continue;
+      }
+      io_uring_sqe* read = ring.Next(Tag(slot, kOpRead));
+      if (read == nullptr) {
+        ok = false;
+        break;
+      }
+      read->opcode = IORING_OP_READ;
+      read->fd = head.file_.descriptor();
+      read->addr = reinterpret_cast<uintptr_t>(head.head_);
+      read->len = static_cast<uint32_t>(
+          stat.stx_size < FileHead::kSize ? stat.stx_size : FileHead::kSize);
+      read->off = 0;
+      ++reads_pending;
+    }
+    ok = ok && ring.Submit();
+    await(&reads_pending);
+  };
+
+  auto is_cancelled = [cancelled] {
+    return cancelled != nullptr && cancelled->load(std::memory_order_relaxed);
+  };
+
+  size_t begin = 0;
+  size_t count = std::min(kGroupSize, paths.size());
+  size_t base = 0;
+  if (count > 0 && !is_cancelled()) {
+    submit_opens(begin, count, base);
+    read_heads(count, base);
+  } else {
+    count = 0;
+  }
+  while (ok && count > 0) {
+    // Open the next group while this one is parsed.
+    size_t next_begin = begin + count;
+    size_t next_count = 0;
+    size_t next_base = kGroupSize - base;
+    if (next_begin < paths.size() && !is_cancelled()) {
+      next_count = std::min(kGroupSize, paths.size() - next_begin);
+      submit_opens(next_begin, next_count, next_base);
+    }
+
+    pool_->ParallelFor(count, [&](size_t i) {
+      consume(begin + i, &heads_[base + i]);
+    });
+    for (size_t i = 0; i < count; ++i) {
+      if (heads_[base + i].file_.is_open()) {
+        close_slot(base + i);
+      }
+    }
+    ok = ok && ring.Submit();
+
+    if (next_count > 0) {
+      read_heads(next_count, next_base);
+    }
+    begin = next_begin;
+    count = next_count;
+    base = next_base;
+  }
+  await(&closes_pending);
+
+  if (!ok) {
+    // The ring broke down. The kernel may still be writing into the heads
+    // and stats, so wait for everything it took, then close the files it
+    // opened before giving the ring up; the files not yet handed out are
+    // read the plain way.
+    bool drained = true;
+    while (drained && ring.in_flight() > 0) {
+      drained = collect();
+    }
+    for (size_t slot = 0; slot < 2 * kGroupSize; ++slot) {
+      if (open_results[slot] >= 0) {
+        ::close(open_results[slot]);
+      }
+      heads_[slot].file_.Close();
+    }
+    if (drained) {
+      ring_.reset();
+      heads_.reset();
+    } else {
+      // Nothing says when the kernel is done with them.
+      ring_.release();
+      heads_.release();
+    }
+    backend_ = FileHeadBackend::kThreadPool;
+    ReadWithPool(paths, begin, consume, cancelled);
+  }
+}
+
+#else
+
+void FileHeadReader::ReadWithRing(const std::vector<std::string>& paths,
+                                  const Consumer& consume,
+                                  const std::atomic<bool>* cancelled) {
+  ReadWithPool(paths, 0, consume, cancelled);
+}
+
+#endif
+
+}  // namespace flutter_bin
@@ -0,0 +1,119 @@
+#ifndef FLUTTER_BIN_FILE_HEAD_READER_H_
+#define FLUTTER_BIN_FILE_HEAD_READER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "byte_view.h"
+#include "positioned_file.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+
+// How FileHeadReader opens files and reads their heads.
+enum class FileHeadBackend {
+  // open, fstat and pread per file on the pool's workers.
+  kThreadPool,
+  // openat and statx for a whole group of files in one submission, then
+  // their reads in a second and their closes in a third (Linux 5.6+).
+  kIoUring,
+};
+
+// Whether |backend| can run here: io_uring needs a Linux kernel that
+// supports the operations and does not forbid rings (io_uring_disabled,
+// container seccomp profiles).
+bool FileHeadBackendSupported(FileHeadBackend backend);
+
+// io_uring where supported, the thread pool otherwise.
+FileHeadBackend DefaultFileHeadBackend();
+
+// e.g. "thread-pool", "io-uring".
+const char* FileHeadBackendName(FileHeadBackend backend);
+
+// An open file whose first kSize bytes have been read ahead of parsing.
+// Reads inside them are answered from memory; the rest go to the file.
+class FileHead : public RandomAccessSource {
+ public:
+  static constexpr size_t kSize = 4096;
+
+  FileHead() = default;
+
+  // Why the file could not be opened, or kNone.
+  PositionedFile::Error error() const { return error_; }
+
+  const PositionedFile& file() const { return file_; }
+  ByteView head() const { return ByteView(head_, head_size_); }
+
+  uint64_t size() const override { return file_.size(); }
+  bool ReadAt(uint64_t offset, void* buffer, size_t length,
+              size_t* read) override;
+
+ private:
+  friend class FileHeadReader;
+
+  PositionedFile file_;
+  PositionedFile::Error error_ = PositionedFile::Error::kNone;
+  uint8_t head_[kSize];
+  size_t head_size_ = 0;
+};
+
+// Opens many files and reads their heads with few system calls, for
+// inventories of whole volumes where the per-file open, read and close cost
+// more than parsing does.
+//
+// Files are handled in groups of kGroupSize. With io_uring the next group
+// is opened while the workers parse the current one, so the calling thread
+// makes three submissions per group instead of four or more system calls
+// per file, and the kernel runs the opens in parallel.
+class FileHeadReader {
+ public:
+  // Called on one of the pool's workers for each file, which is closed once
+  // it returns.
+  using Consumer = std::function<void(size_t index, FileHead* head)>;
+
+  static constexpr size_t kGroupSize = 64;
+
+  // |backend| must be supported. |pool| must outlive the reader.
+  explicit FileHeadReader(ThreadPool* pool,
+                          FileHeadBackend backend = DefaultFileHeadBackend());
+  ~FileHeadReader();
+
+  // Disallow copy and assign.
+  FileHeadReader(const FileHeadReader&) = delete;
+  FileHeadReader& operator=(const FileHeadReader&) = delete;
+
+  FileHeadBackend backend() const { return backend_; }
+
+  // Calls |consume| with the head of each of |paths|, or with its open
+  // error. Files not yet opened when |cancelled| is set are skipped. Call
+  // from one thread at a time.
+  void Read(const std::vector<std::string>& paths, const Consumer& consume,
+            const std::atomic<bool>* cancelled = nullptr);
+
+ private:
+  // The io_uring submission and completion queues; defined in the .cpp.
+  class Ring;
+
+  // Reads |paths| from index |begin| on.
+  void ReadWithPool(const std::vector<std::string>& paths, size_t begin,
+                    const Consumer& consume,
+                    const std::atomic<bool>* cancelled);
+  void ReadWithRing(const std::vector<std::string>& paths,
+                    const Consumer& consume,
+                    const std::atomic<bool>* cancelled);
+
+  ThreadPool* const pool_;
+  FileHeadBackend backend_;
+  std::unique_ptr<Ring> ring_;
+  // Two groups' worth: one being parsed while the next is opened.
+  std::unique_ptr<FileHead[]> heads_;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_FILE_HEAD_READER_H_
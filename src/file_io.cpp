@@ -0,0 +1,65 @@
+#include "file_io.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <io.h>
+
+#include "unicode.h"
+#else
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+namespace flutter_bin {
+
+#if defined(_WIN32)
+
+std::FILE* OpenFile(const std::string& utf8_path, const char* mode) {
+  std::wstring wide_mode;
+  for (const char* c = mode; *c; ++c) {
+    wide_mode += static_cast<wchar_t>(*c);
+  }
+  std::FILE* file = nullptr;
+  if (_wfopen_s(&file, Utf8ToWide(utf8_path).c_str(), wide_mode.c_str()) !=
+      0) {
+    return nullptr;
+  }
+  return file;
+}
+
+bool SyncFile(std::FILE* file) {
+  return std::fflush(file) == 0 && _commit(_fileno(file)) == 0;
+}
+
+bool ReplaceFile(const std::string& utf8_from, const std::string& utf8_to) {
+  return MoveFileExW(Utf8ToWide(utf8_from).c_str(),
+                     Utf8ToWide(utf8_to).c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+bool RemoveFile(const std::string& utf8_path) {
+  return DeleteFileW(Utf8ToWide(utf8_path).c_str()) != 0 ||
+         GetLastError() == ERROR_FILE_NOT_FOUND;
+}
+
+#else
+
+std::FILE* OpenFile(const std::string& utf8_path, const char* mode) {
+  return std::fopen(utf8_path.c_str(), mode);
+}
+
+bool SyncFile(std::FILE* file) {
+  return std::fflush(file) == 0 && ::fsync(::fileno(file)) == 0;
+}
+
+bool ReplaceFile(const std::string& utf8_from, const std::string& utf8_to) {
+  return std::rename(utf8_from.c_str(), utf8_to.c_str()) == 0;
+}
+
+bool RemoveFile(const std::string& utf8_path) {
+  return ::unlink(utf8_path.c_str()) == 0 || errno == ENOENT;
+}
+
+#endif
+
+}  // namespace flutter_bin
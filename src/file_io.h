@@ -0,0 +1,25 @@
+#ifndef FLUTTER_BIN_FILE_IO_H_
+#define FLUTTER_BIN_FILE_IO_H_
+
+#include <cstdio>
+#include <string>
+
+namespace flutter_bin {
+
+// Small wrappers over the C runtime that take UTF-8 paths on every host.
+
+// fopen() with a UTF-8 path. |mode| is an ASCII fopen mode such as "rb".
+std::FILE* OpenFile(const std::string& utf8_path, const char* mode);
+
+// Flushes |file| through to the disk. Returns false on failure.
+bool SyncFile(std::FILE* file);
+
+// Atomically replaces |to| with |from|.
+bool ReplaceFile(const std::string& utf8_from, const std::string& utf8_to);
+
+// Deletes the file. Returns true if it is gone afterwards.
+bool RemoveFile(const std::string& utf8_path);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_FILE_IO_H_
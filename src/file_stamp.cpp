@@ -0,0 +1,89 @@
+#include "file_stamp.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+#include "perf_stats.h"
+#include "unicode.h"
+#else
+#include <sys/stat.h>
+#endif
+
+namespace flutter_bin {
+
+#if defined(_WIN32)
+
+bool ReadFileStamp(const std::string& utf8_path, FileStamp* stamp) {
+  // Kept per thread so that its capacity is reused from call to call.
+  thread_local std::wstring wide_path;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kPathConversion);
+    Utf8ToWide(utf8_path, &wide_path);
+  }
+
+  // No data access is requested, so this works on files that are locked or
+  // that we may not read; only the attributes are touched.
+  HANDLE file = CreateFileW(
+      wide_path.c_str(), 0,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  BY_HANDLE_FILE_INFORMATION info;
+  bool ok = GetFileInformationByHandle(file, &info) != 0 &&
+            !(info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY);
+  CloseHandle(file);
+  if (!ok) {
+    return false;
+  }
+
+  stamp->size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) |
+                info.nFileSizeLow;
+  stamp->modified =
+      (static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) |
+      info.ftLastWriteTime.dwLowDateTime;
+  stamp->volume = info.dwVolumeSerialNumber;
+  stamp->file_id = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) |
+                   info.nFileIndexLow;
+  return true;
+}
+
+std::string NormalizePath(const std::string& utf8_path) {
+  std::string normalized = utf8_path;
+  for (char& c : normalized) {
+    if (c == '/') {
+      c = '\\';
+    } else if (c >= 'A' && c <= 'Z') {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+  }
+  return normalized;
+}
+
+#else
+
+bool ReadFileStamp(const std::string& utf8_path, FileStamp* stamp) {
+  struct stat file_stat;
+  if (::stat(utf8_path.c_str(), &file_stat) != 0 ||
+      !S_ISREG(file_stat.st_mode)) {
+    return false;
+  }
+  stamp->size = static_cast<uint64_t>(file_stat.st_size);
+#if defined(__APPLE__)
+  const struct timespec& modified = file_stat.st_mtimespec;
+#else
+  const struct timespec& modified = file_stat.st_mtim;
+#endif
+  stamp->modified = static_cast<uint64_t>(modified.tv_sec) * 1000000000u +
+                    static_cast<uint64_t>(modified.tv_nsec);
+  stamp->volume = static_cast<uint64_t>(file_stat.st_dev);
+  stamp->file_id = static_cast<uint64_t>(file_stat.st_ino);
+  return true;
+}
+
+std::string NormalizePath(const std::string& utf8_path) { return utf8_path; }
+
+#endif
+
+}  // namespace flutter_bin
@@ -0,0 +1,39 @@
+#ifndef FLUTTER_BIN_FILE_STAMP_H_
+#define FLUTTER_BIN_FILE_STAMP_H_
+
+#include <cstdint>
+#include <string>
+
+namespace flutter_bin {
+
+// Identifies one version of one file: if any of these change, anything
+// derived from the file's contents must be read again.
+struct FileStamp {
+  uint64_t size = 0;
+  // Last write time in the platform's native units (FILETIME ticks or
+  // nanoseconds since the epoch).
+  uint64_t modified = 0;
+  // Volume serial number or st_dev.
+  uint64_t volume = 0;
+  // NTFS file index or inode number.
+  uint64_t file_id = 0;
+
+  bool operator==(const FileStamp& other) const {
+    return size == other.size && modified == other.modified &&
+           volume == other.volume && file_id == other.file_id;
+  }
+  bool operator!=(const FileStamp& other) const { return !(*this == other); }
+};
+
+// Reads the stamp of the regular file at |utf8_path| without opening its
+// contents. Returns false if it does not exist or is not a regular file.
+bool ReadFileStamp(const std::string& utf8_path, FileStamp* stamp);
+
+// Returns |utf8_path| in a form where spellings of the same path compare
+// equal: on Windows separators are unified and ASCII letters folded, since
+// the file system is case-insensitive. Other hosts return it unchanged.
+std::string NormalizePath(const std::string& utf8_path);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_FILE_STAMP_H_
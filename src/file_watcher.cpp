@@ -0,0 +1,636 @@
+#include "file_watcher.h"
+
+#include <algorithm>
+
+#include "directory_list.h"
+#include "directory_scan.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+#include "unicode.h"
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace flutter_bin {
+
+namespace {
+
+#if defined(_WIN32)
+constexpr const char* kSeparators = "\\/";
+#else
+constexpr const char* kSeparators = "/";
+#endif
+
+bool IsSeparator(char c) {
+  for (const char* separator = kSeparators; *separator; ++separator) {
+    if (c == *separator) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string TrimSeparators(std::string path) {
+  while (path.size() > 1 && IsSeparator(path.back())) {
+    path.pop_back();
+  }
+  return path;
+}
+
+// The directory holding |path|; "." for a bare file name.
+std::string ParentDirectory(const std::string& path) {
+  size_t separator = path.find_last_of(kSeparators);
+  if (separator == std::string::npos) {
+    return ".";
+  }
+  std::string parent = path.substr(0, separator == 0 ? 1 : separator);
+  if (!parent.empty() && parent.back() == ':') {
+    parent += kSeparators[0];  // "C:" alone means the drive's current dir.
+  }
+  return parent;
+}
+
+// One notification, before coalescing.
+struct RawChange {
+  std::string path;
+  WatchChange change;
+};
+
+}  // namespace
+
+#if defined(__linux__)
+
+// inotify watches every directory of a tree separately, so recursive
+// watches add the subdirectories they find, and the ones created later.
+class ChangeSource {
+ public:
+  ChangeSource()
+      : inotify_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+        wake_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+
+  ~ChangeSource() {
+    if (inotify_ >= 0) {
+      close(inotify_);
+    }
+    if (wake_ >= 0) {
+      close(wake_);
+    }
+  }
+
+  bool valid() const { return inotify_ >= 0 && wake_ >= 0; }
+
+  bool AddDirectory(const std::string& path, bool recursive) {
+    int watch = inotify_add_watch(inotify_, path.c_str(), kMask | IN_ONLYDIR);
+    if (watch < 0) {
+      return false;
+    }
+    // Adding a directory again returns the same descriptor.
+    Directory& directory = directories_[watch];
+    directory.path = path;
+    directory.recursive = directory.recursive || recursive;
+    if (recursive) {
+      std::vector<DirectoryEntry> entries;
+      if (ListDirectory(path, &entries)) {
+        for (const DirectoryEntry& entry : entries) {
+          if (entry.type == EntryType::kDirectory) {
+            AddDirectory(JoinPath(path, entry.name), true);
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  // Waits up to |timeout_ms|, or indefinitely if negative, and appends
+  // whatever arrived.
+  void Wait(int timeout_ms, std::vector<RawChange>* changes) {
+    pollfd fds[2] = {{inotify_, POLLIN, 0}, {wake_, POLLIN, 0}};
+    if (poll(fds, 2, timeout_ms) <= 0) {
+      return;
+    }
+    if (fds[1].revents & POLLIN) {
+      uint64_t count = 0;
+      (void)!read(wake_, &count, sizeof(count));
+    }
+    for (;;) {
+      ssize_t length = read(inotify_, buffer_, sizeof(buffer_));
+      if (length <= 0) {
+        break;  // Drained.
+      }
+      for (ssize_t offset = 0; offset < length;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(buffer_ + offset);
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        Translate(*event, changes);
+      }
+    }
+  }
+
+  // Makes the current or next Wait() return. Safe to call from any thread.
+  void Wake() {
+    uint64_t one = 1;
+    (void)!write(wake_, &one, sizeof(one));
+  }
+
+ private:
+  static constexpr uint32_t kMask =
+      IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+      IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+      IN_EXCL_UNLINK;
+
+  struct Directory {
+    std::string path;
+    bool recursive = false;
+  };
+
+  void Translate(const inotify_event& event, std::vector<RawChange>* changes) {
+    if (event.mask & IN_Q_OVERFLOW) {
+      changes->push_back({std::string(), WatchChange::kOverflow});
+      return;
+    }
+    auto directory_it = directories_.find(event.wd);
+    if (directory_it == directories_.end()) {
+      return;
+    }
+    if (event.mask & IN_IGNORED) {
+      directories_.erase(directory_it);
+      return;
+    }
+    const Directory directory = directory_it->second;
+    if (event.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+      // A moved directory keeps its watch, under a path we no longer know.
+      if (event.mask & IN_MOVE_SELF) {
+        inotify_rm_watch(inotify_, event.wd);
+      }
+      changes->push_back({directory.path, WatchChange::kRemoved});
+      return;
+    }
+    if (event.len == 0) {
+      return;
+    }
+
+    std::string path = JoinPath(directory.path, event.name);
+    bool is_directory = (event.mask & IN_ISDIR) != 0;
+    if (event.mask & (IN_CREATE | IN_MOVED_TO)) {
+      // Watched before anything is written into it; files that beat us to
+      // it are found when the directory settles.
+      if (is_directory && directory.recursive) {
+        AddDirectory(path, true);
+      }
+      changes->push_back({std::move(path), WatchChange::kAdded});
+    } else if (event.mask & (IN_DELETE | IN_MOVED_FROM)) {
+      changes->push_back({std::move(path), WatchChange::kRemoved});
+    } else if (!is_directory) {
+      changes->push_back({std::move(path), WatchChange::kModified});
+    }
+  }
+
+  static constexpr size_t kBufferSize = 64 * 1024;
+
+  int inotify_;
+  int wake_;
+  std::map<int, Directory> directories_;
+  alignas(inotify_event) char buffer_[kBufferSize];
+};
+
+#elif defined(_WIN32)
+
+// One overlapped ReadDirectoryChangesW per directory, all completing on one
+// I/O completion port. Subtrees are watched natively.
+class ChangeSource {
+ public:
+  ChangeSource()
+      : port_(CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1)) {}
+
+  ~ChangeSource() {
+    size_t pending = 0;
+    for (const auto& directory : directories_) {
+      if (directory->pending) {
+        CancelIoEx(directory->handle, &directory->overlapped);
+        ++pending;
+      }
+    }
+    // The buffers are in use until each cancelled read has completed.
+    while (pending > 0) {
+      DWORD bytes = 0;
+      ULONG_PTR key = 0;
+      OVERLAPPED* overlapped = nullptr;
+      GetQueuedCompletionStatus(port_, &bytes, &key, &overlapped, INFINITE);
+      if (overlapped != nullptr) {
+        --pending;
+      }
+    }
+    for (const auto& directory : directories_) {
+      CloseHandle(directory->handle);
+    }
+    if (port_ != nullptr) {
+      CloseHandle(port_);
+    }
+  }
+
+  bool valid() const { return port_ != nullptr; }
+
+  bool AddDirectory(const std::string& path, bool recursive) {
+    auto directory = std::make_unique<Directory>();
+    directory->path = path;
+    directory->recursive = recursive;
+    directory->handle = CreateFileW(
+        Utf8ToWide(path).c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+        nullptr);
+    if (directory->handle == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    if (CreateIoCompletionPort(directory->handle, port_,
+                               reinterpret_cast<ULONG_PTR>(directory.get()),
+                               0) == nullptr ||
+        !Read(directory.get())) {
+      CloseHandle(directory->handle);
+      return false;
+    }
+    directories_.push_back(std::move(directory));
+    return true;
+  }
+
+  // Waits up to |timeout_ms|, or indefinitely if negative, and appends
+  // whatever arrived.
+  void Wait(int timeout_ms, std::vector<RawChange>* changes) {
+    DWORD wait = timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms);
+    for (;; wait = 0) {
+      DWORD bytes = 0;
+      ULONG_PTR key = 0;
+      OVERLAPPED* overlapped = nullptr;
+      BOOL ok = GetQueuedCompletionStatus(port_, &bytes, &key, &overlapped, wait);
+      if (overlapped == nullptr) {
+        return;  // Timed out, drained or woken.
+      }
+      auto* directory = reinterpret_cast<Directory*>(key);
+      directory->pending = false;
+      if (!ok) {
+        // The directory itself is gone.
+        changes->push_back({directory->path, WatchChange::kRemoved});
+        continue;
+      }
+      if (bytes == 0) {
+        changes->push_back({directory->path, WatchChange::kOverflow});
+      } else {
+        Translate(*directory, changes);
+      }
+      if (!Read(directory)) {
+        changes->push_back({directory->path, WatchChange::kRemoved});
+      }
+    }
+  }
+
+  // Makes the current or next Wait() return. Safe to call from any thread.
+  void Wake() { PostQueuedCompletionStatus(port_, 0, 0, nullptr); }
+
+ private:
+  static constexpr DWORD kFilter =
+      FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME |
+      FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE |
+      FILE_NOTIFY_CHANGE_CREATION;
+
+  // Larger buffers fail on network shares.
+  static constexpr size_t kBufferSize = 64 * 1024;
+
+  struct Directory {
+    std::string path;
+    bool recursive = false;
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped = {};
+    bool pending = false;
+    DWORD buffer[kBufferSize / sizeof(DWORD)];  // Must be DWORD-aligned.
+  };
+
+  static bool Read(Directory* directory) {
+    directory->overlapped = OVERLAPPED();
+    directory->pending =
+        ReadDirectoryChangesW(directory->handle, directory->buffer,
+                              sizeof(directory->buffer), directory->recursive,
+                              kFilter, nullptr, &directory->overlapped,
+                              nullptr) != 0;
+    return directory->pending;
+  }
+
+  static void Translate(const Directory& directory,
+                        std::vector<RawChange>* changes) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(directory.buffer);
+    for (DWORD offset = 0;;) {
+      const auto* info =
+          reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(bytes + offset);
+      std::string path = JoinPath(
+          directory.path,
+          WideToUtf8(info->FileName, info->FileNameLength / sizeof(wchar_t)));
+      switch (info->Action) {
+        case FILE_ACTION_ADDED:
+        case FILE_ACTION_RENAMED_NEW_NAME:
+          changes->push_back({std::move(path), WatchChange::kAdded});
+          break;
+        case FILE_ACTION_REMOVED:
+        case FILE_ACTION_RENAMED_OLD_NAME:
+          changes->push_back({std::move(path), WatchChange::kRemoved});
+          break;
+        default:
+          changes->push_back({std::move(path), WatchChange::kModified});
+          break;
+      }
+      if (info->NextEntryOffset == 0) {
+        break;
+      }
+      offset += info->NextEntryOffset;
+    }
+  }
+
+  HANDLE port_;
+  std::vector<std::unique_ptr<Directory>> directories_;
+};
+
+#else
+
+// No backend on this host; FileWatcher::Start() fails.
+class ChangeSource {
+ public:
+  bool valid() const { return false; }
+  bool AddDirectory(const std::string&, bool) { return false; }
+  void Wait(int, std::vector<RawChange>*) {}
+  void Wake() {}
+};
+
+#endif
+
+const char* WatchChangeName(WatchChange change) {
+  switch (change) {
+    case WatchChange::kAdded:
+      return "added";
+    case WatchChange::kModified:
+      return "modified";
+    case WatchChange::kRemoved:
+      return "removed";
+    case WatchChange::kOverflow:
+      return "overflow";
+  }
+  return "";
+}
+
+FileWatcher::FileWatcher(WatchOptions options, Reader read, Sink sink)
+    : options_(std::move(options)),
+      read_(std::move(read)),
+      sink_(std::move(sink)) {}
+
+FileWatcher::~FileWatcher() {
+  if (thread_.joinable()) {
+    Stop();
+    thread_.join();
+  }
+}
+
+void FileWatcher::Stop() {
+  if (thread_.joinable() && !stopping_.exchange(true)) {
+    source_->Wake();
+  }
+}
+
+// static
+bool FileWatcher::Supported() {
+#if defined(_WIN32) || defined(__linux__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool FileWatcher::Start(const std::vector<std::string>& paths,
+                        std::vector<std::string>* failed) {
+  source_ = std::make_unique<ChangeSource>();
+  if (!source_->valid()) {
+    failed->insert(failed->end(), paths.begin(), paths.end());
+    return false;
+  }
+  for (const std::string& path : paths) {
+    Target target;
+    target.path = TrimSeparators(path);
+    target.normalized = NormalizePath(target.path);
+    EntryType type = EntryType::kOther;
+    bool exists = ResolveEntryType(target.path, &type);
+    target.directory = exists && type == EntryType::kDirectory;
+    bool watched = false;
+    if (target.directory) {
+      watched = source_->AddDirectory(target.path, options_.recursive);
+    } else if (!exists || type == EntryType::kFile) {
+      watched = source_->AddDirectory(ParentDirectory(target.path), false);
+    }
+    if (watched) {
+      targets_.push_back(std::move(target));
+    } else {
+      failed->push_back(path);
+    }
+  }
+  if (targets_.empty()) {
+    return false;
+  }
+  thread_ = std::thread([this] { Run(); });
+  return true;
+}
+
+void FileWatcher::Run() {
+  using Clock = std::chrono::steady_clock;
+  std::vector<RawChange> changes;
+  while (!stopping_.load()) {
+    // Sleep until the next pending path is due.
+    int timeout_ms = -1;
+    Clock::time_point now = Clock::now();
+    for (const auto& entry : pending_) {
+      Clock::time_point due =
+          std::min(entry.second.last + options_.settle_delay,
+                   entry.second.first + options_.max_delay);
+      auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - now);
+      int wait_ms = static_cast<int>(std::max<int64_t>(wait.count() + 1, 0));
+      timeout_ms = timeout_ms < 0 ? wait_ms : std::min(timeout_ms, wait_ms);
+    }
+    changes.clear();
+    source_->Wait(timeout_ms, &changes);
+    if (stopping_.load()) {
+      break;
+    }
+
+    now = Clock::now();
+    std::vector<WatchEvent> events;
+    bool overflowed = false;
+    for (RawChange& change : changes) {
+      if (change.change == WatchChange::kOverflow) {
+        overflowed = true;
+        continue;
+      }
+      if (!Covers(change.path)) {
+        continue;
+      }
+      auto inserted = pending_.emplace(
+          std::move(change.path),
+          Pending{now, now, change.change == WatchChange::kAdded});
+      if (!inserted.second) {
+        inserted.first->second.last = now;
+      }
+    }
+    if (overflowed) {
+      // Which paths were lost is unknown, so every target needs a rescan.
+      for (const Target& target : targets_) {
+        WatchEvent event;
+        event.path = target.path;
+        event.change = WatchChange::kOverflow;
+        events.push_back(std::move(event));
+      }
+    }
+    for (auto it = pending_.begin();
+         it != pending_.end() && !stopping_.load();) {
+      if (now - it->second.last >= options_.settle_delay ||
+          now - it->second.first >= options_.max_delay) {
+        Settle(it->first, it->second.created, &events);
+        it = pending_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (!events.empty() && !stopping_.load()) {
+      sink_(std::move(events));
+    }
+  }
+}
+
+bool FileWatcher::Covers(const std::string& path) const {
+  std::string normalized = NormalizePath(path);
+  for (const Target& target : targets_) {
+    const std::string& root = target.normalized;
+    if (normalized == root) {
+      return true;
+    }
+    if (!target.directory || normalized.size() <= root.size() ||
+        normalized.compare(0, root.size(), root) != 0) {
+      continue;
+    }
+    // "/a/bc" is not inside "/a/b"; a root like "/" ends in a separator.
+    size_t name_start = root.size();
+    if (!IsSeparator(root.back())) {
+      if (!IsSeparator(normalized[name_start])) {
+        continue;
+      }
+      ++name_start;
+    }
+    if (options_.recursive ||
+        normalized.find_first_of(kSeparators, name_start) == std::string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FileWatcher::Settle(const std::string& path, bool created,
+                         std::vector<WatchEvent>* events) {
+  FileStamp stamp;
+  if (!ReadFileStamp(path, &stamp)) {
+    EntryType type = EntryType::kOther;
+    if (ResolveEntryType(path, &type)) {
+      // Only new directories are walked; Windows also reports a directory
+      // as modified whenever its entries change.
+      if (type == EntryType::kDirectory && created && options_.recursive) {
+        SettleDirectory(path, events);
+      }
+      return;
+    }
+    SettleRemoval(path, created, events);
+    return;
+  }
+  if (!MatchesExtension(path, options_.extensions)) {
+    return;
+  }
+
+  auto known_it = known_.find(path);
+  bool seen = known_it != known_.end();
+  if (seen && known_it->second.stamp == stamp) {
+    return;  // Touched, but not rewritten.
+  }
+  bool reported = seen && known_it->second.format != BinaryFormat::kUnknown;
+  BinaryFormat format = DetectFileFormat(path);
+  if (format == BinaryFormat::kUnknown) {
+    // Kept so that it is reported as added once it does become a binary,
+    // e.g. when it settled while still empty.
+    if (reported) {
+      WatchEvent event;
+      event.path = path;
+      event.change = WatchChange::kRemoved;
+      event.format = known_it->second.format;
+      events->push_back(std::move(event));
+    }
+    known_[path] = Known{stamp, BinaryFormat::kUnknown};
+    return;
+  }
+
+  WatchEvent event;
+  event.path = path;
+  event.change = reported || (!seen && !created) ? WatchChange::kModified
+                                                 : WatchChange::kAdded;
+  event.format = format;
+  event.metadata = read_(path, format);
+  known_[path] = Known{stamp, format};
+  events->push_back(std::move(event));
+}
+
+void FileWatcher::SettleRemoval(const std::string& path, bool created,
+                                std::vector<WatchEvent>* events) {
+  auto report = [events](const std::string& removed, BinaryFormat format) {
+    WatchEvent event;
+    event.path = removed;
+    event.change = WatchChange::kRemoved;
+    event.format = format;
+    events->push_back(std::move(event));
+  };
+
+  // A removed directory takes the files below it along, which not every
+  // host reports one by one (e.g. when it is moved out).
+  std::string prefix = JoinPath(path, "");
+  bool directory = false;
+  for (auto it = known_.lower_bound(prefix);
+       it != known_.end() && it->first.compare(0, prefix.size(), prefix) == 0;) {
+    directory = true;
+    if (it->second.format != BinaryFormat::kUnknown) {
+      report(it->first, it->second.format);
+    }
+    it = known_.erase(it);
+  }
+
+  auto known_it = known_.find(path);
+  if (known_it != known_.end()) {
+    if (known_it->second.format != BinaryFormat::kUnknown) {
+      report(path, known_it->second.format);
+    }
+    known_.erase(known_it);
+  } else if (!created && !directory &&
+             MatchesExtension(path, options_.extensions)) {
+    // It predates the watch, so whether it was a binary is unknown. Files
+    // created and deleted between reads are never reported.
+    report(path, BinaryFormat::kUnknown);
+  }
+}
+
+void FileWatcher::SettleDirectory(const std::string& path,
+                                  std::vector<WatchEvent>* events) {
+  std::vector<DirectoryEntry> entries;
+  if (!ListDirectory(path, &entries)) {
+    return;
+  }
+  for (const DirectoryEntry& entry : entries) {
+    std::string child = JoinPath(path, entry.name);
+    if (entry.type == EntryType::kDirectory) {
+      SettleDirectory(child, events);
+    } else if (entry.type == EntryType::kFile) {
+      Settle(child, true, events);
+    }
+  }
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,157 @@
+#ifndef FLUTTER_BIN_FILE_WATCHER_H_
+#define FLUTTER_BIN_FILE_WATCHER_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "binary_format.h"
+#include "binary_metadata.h"
+#include "file_stamp.h"
+
+namespace flutter_bin {
+
+enum class WatchChange {
+  // A binary appeared: created, moved in, or written into a file that was
+  // not one before.
+  kAdded,
+  // A binary reported before, or one that existed before the watch, changed.
+  kModified,
+  // A binary was deleted, moved out or overwritten with something else.
+  kRemoved,
+  // The host dropped notifications; anything under the path may have
+  // changed and should be scanned again.
+  kOverflow,
+};
+
+// Returns the name reported to Dart, e.g. "modified".
+const char* WatchChangeName(WatchChange change);
+
+struct WatchOptions {
+  // Lower-case extensions without the dot, as in ScanOptions. Only files
+  // with executable magic bytes are reported either way.
+  std::vector<std::string> extensions;
+  // Whether watched directories include their subdirectories.
+  bool recursive = true;
+  // A changed file is read once it has had no events for |settle_delay|,
+  // or |max_delay| after its first event if writes never pause.
+  std::chrono::milliseconds settle_delay{500};
+  std::chrono::milliseconds max_delay{10000};
+};
+
+struct WatchEvent {
+  std::string path;
+  WatchChange change = WatchChange::kModified;
+  // kUnknown for removals of files this watcher never read.
+  BinaryFormat format = BinaryFormat::kUnknown;
+  // Set for kAdded and kModified.
+  BinaryMetadata metadata;
+};
+
+// The host's change notifications; defined per platform in the .cpp.
+class ChangeSource;
+
+// Watches files and directories for changes and reports the binaries among
+// them as they settle.
+//
+// Notifications come from inotify on Linux and ReadDirectoryChangesW on
+// Windows, on a thread of the watcher's own. Events are coalesced per path:
+// the burst of writes an installer makes to one file becomes one read once
+// the file is quiet, files created and deleted again within the settle
+// delay are never read, and files whose stamp did not change (e.g. only
+// their attributes did) are skipped. Nothing is read up front, so the cost
+// of a watch follows the number of changes, not the number of files.
+class FileWatcher {
+ public:
+  // Reads the metadata of one changed binary, on the watcher's thread.
+  using Reader =
+      std::function<BinaryMetadata(const std::string& path, BinaryFormat format)>;
+
+  // Receives the changes that settled together, on the watcher's thread.
+  using Sink = std::function<void(std::vector<WatchEvent> events)>;
+
+  FileWatcher(WatchOptions options, Reader read, Sink sink);
+
+  // Stops the watcher thread; no sink call is running once it returns.
+  ~FileWatcher();
+
+  // Disallow copy and assign.
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  // Whether this host has a notification backend.
+  static bool Supported();
+
+  // Starts watching |paths|, each a directory or a file. A file that does
+  // not exist yet is watched through its parent directory. Paths that
+  // cannot be watched are appended to |failed|. Returns false if nothing
+  // could be watched, in which case the watcher stays idle. Call once.
+  bool Start(const std::vector<std::string>& paths,
+             std::vector<std::string>* failed);
+
+  // Asks the watcher thread to stop without waiting for it: a read that is
+  // under way finishes, but nothing more is read or sent to the sink. The
+  // destructor, which joins the thread, can then run where blocking is
+  // fine.
+  void Stop();
+
+ private:
+  struct Target {
+    std::string path;        // As given, without trailing separators.
+    std::string normalized;  // NormalizePath(path), for matching.
+    bool directory = false;
+  };
+
+  // Events seen for one path since it was last read.
+  struct Pending {
+    std::chrono::steady_clock::time_point first;
+    std::chrono::steady_clock::time_point last;
+    // The first event created or moved the path in.
+    bool created = false;
+  };
+
+  // What the last read of a path found.
+  struct Known {
+    FileStamp stamp;
+    BinaryFormat format = BinaryFormat::kUnknown;
+  };
+
+  void Run();
+
+  // Whether |path| lies in what the targets cover.
+  bool Covers(const std::string& path) const;
+
+  // Reads |path| now that it has settled, appending what changed.
+  void Settle(const std::string& path, bool created,
+              std::vector<WatchEvent>* events);
+
+  // Reports |path| gone, along with any file known below it.
+  void SettleRemoval(const std::string& path, bool created,
+                     std::vector<WatchEvent>* events);
+
+  // Reads every file below a directory that appeared.
+  void SettleDirectory(const std::string& path,
+                       std::vector<WatchEvent>* events);
+
+  const WatchOptions options_;
+  const Reader read_;
+  const Sink sink_;
+
+  std::unique_ptr<ChangeSource> source_;
+  std::vector<Target> targets_;
+  // Only touched by the watcher thread.
+  std::map<std::string, Pending> pending_;
+  std::map<std::string, Known> known_;
+
+  std::atomic<bool> stopping_{false};
+  std::thread thread_;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_FILE_WATCHER_H_
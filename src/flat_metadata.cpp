@@ -0,0 +1,126 @@
+#include "flat_metadata.h"
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+namespace {
+
+// Appends strings after the entries and returns their offsets.
+class StringWriter {
+ public:
+  StringWriter(uint8_t* buffer, size_t offset)
+      : buffer_(buffer), offset_(offset) {}
+
+  uint32_t Write(const char* data, size_t size) {
+    uint32_t offset = static_cast<uint32_t>(offset_);
+    if (size > 0) {
+      std::memcpy(buffer_ + offset_, data, size);
+    }
+    offset_ += size;
+    return offset;
+  }
+
+ private:
+  uint8_t* buffer_;
+  size_t offset_;
+};
+
+// WriteFlatMetadata() for a BinaryMetadata or a MetadataView, whose fields
+// are (key, value) pairs of strings or string views.
+template <typename Metadata>
+size_t WriteFlat(const Metadata& metadata, uint8_t* buffer, size_t capacity) {
+  const char* error = metadata.error == MetadataError::kNone
+                          ? ""
+                          : MetadataErrorCode(metadata.error);
+  size_t error_length = std::strlen(error);
+  size_t field_count = 0;
+  size_t size = kFlatMetadataHeaderSize + error_length;
+  for (const auto& [key, value] : metadata.fields) {
+    size += kFlatMetadataEntrySize + key.size() + value.size();
+    ++field_count;
+  }
+  // Offsets are 32-bit; nothing a version resource holds comes close.
+  if (buffer == nullptr || size > capacity ||
+      size > std::numeric_limits<uint32_t>::max()) {
+    return size;
+  }
+
+  StringWriter strings(buffer, kFlatMetadataHeaderSize +
+                                   field_count * kFlatMetadataEntrySize);
+  uint8_t* entry = buffer + kFlatMetadataHeaderSize;
+  for (const auto& [key, value] : metadata.fields) {
+    StoreLe32(entry, strings.Write(key.data(), key.size()));
+    StoreLe32(entry + 4, static_cast<uint32_t>(key.size()));
+    StoreLe32(entry + 8, strings.Write(value.data(), value.size()));
+    StoreLe32(entry + 12, static_cast<uint32_t>(value.size()));
+    entry += kFlatMetadataEntrySize;
+  }
+  StoreLe32(buffer, kFlatMetadataMagic);
+  StoreLe32(buffer + 4, static_cast<uint32_t>(size));
+  StoreLe32(buffer + 8, static_cast<uint32_t>(field_count));
+  StoreLe32(buffer + 12, strings.Write(error, error_length));
+  StoreLe32(buffer + 16, static_cast<uint32_t>(error_length));
+  StoreLe32(buffer + 20, 0);
+  return size;
+}
+
+// The request for |fields| (see ReadFlatMetadata()), rebuilt only when the
+// calling thread asks for different fields than last time.
+const MetadataRequest& RequestFor(const char* const* fields,
+                                  size_t field_count) {
+  static const MetadataRequest standard = MetadataRequest::Standard();
+  if (field_count == 0) {
+    return standard;
+  }
+  thread_local std::vector<std::string> last_fields;
+  thread_local MetadataRequest last_request;
+  bool same = last_fields.size() == field_count;
+  for (size_t i = 0; same && i < field_count; ++i) {
+    same = last_fields[i] == fields[i];
+  }
+  if (!same) {
+    last_fields.assign(fields, fields + field_count);
+    last_request = MetadataRequest::Only(last_fields);
+  }
+  return last_request;
+}
+
+}  // namespace
+
+size_t WriteFlatMetadata(const BinaryMetadata& metadata, uint8_t* buffer,
+                         size_t capacity) {
+  return WriteFlat(metadata, buffer, capacity);
+}
+
+size_t WriteFlatMetadata(const MetadataView& metadata, uint8_t* buffer,
+                         size_t capacity) {
+  return WriteFlat(metadata, buffer, capacity);
+}
+
+int64_t ReadFlatMetadata(const char* utf8_path, const char* const* fields,
+                         size_t field_count, uint8_t* buffer,
+                         size_t capacity) {
+  if (utf8_path == nullptr || (field_count > 0 && fields == nullptr)) {
+    return -1;
+  }
+  for (size_t i = 0; i < field_count; ++i) {
+    if (fields[i] == nullptr) {
+      return -1;
+    }
+  }
+  // The path is copied into a buffer that keeps its capacity.
+  thread_local std::string path;
+  path.assign(utf8_path);
+  MetadataView metadata =
+      ReadBinaryMetadataView(path, RequestFor(fields, field_count),
+                             MetadataScratch::ForCurrentThread());
+  return static_cast<int64_t>(WriteFlatMetadata(metadata, buffer, capacity));
+}
+
+}  // namespace flutter_bin
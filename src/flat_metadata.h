@@ -0,0 +1,48 @@
+#ifndef FLUTTER_BIN_FLAT_METADATA_H_
+#define FLUTTER_BIN_FLAT_METADATA_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "binary_metadata.h"
+
+namespace flutter_bin {
+
+// A BinaryMetadata serialized into one caller-provided buffer, so a dart:ffi
+// caller can read it in place without a codec or any intermediate map.
+// Every integer is a little-endian uint32 and every offset is from the start
+// of the buffer:
+//
+//   header   magic, size, field count, error offset, error length, reserved
+//   entries  field count x (key offset, key length, value offset,
+//            value length)
+//   strings  the UTF-8 keys, values and error code, not NUL-terminated
+//
+// The error code (e.g. "FILE_NOT_FOUND") is empty on success.
+constexpr uint32_t kFlatMetadataMagic = 0x4D424C46;  // "FLBM"
+constexpr size_t kFlatMetadataHeaderSize = 24;
+constexpr size_t kFlatMetadataEntrySize = 16;
+
+// Returns the number of bytes |metadata| needs. Writes it to |buffer| only
+// when |capacity| is at least that, so a caller with a buffer that is too
+// small can grow it and try again.
+size_t WriteFlatMetadata(const BinaryMetadata& metadata, uint8_t* buffer,
+                         size_t capacity);
+size_t WriteFlatMetadata(const MetadataView& metadata, uint8_t* buffer,
+                         size_t capacity);
+
+// Reads the binary at |utf8_path| and writes the result as above. With
+// |field_count| zero the standard fields are read, otherwise exactly
+// |fields| (see MetadataRequest::Only()). Returns the size of the result,
+// which is larger than |capacity| when nothing was written, or -1 for a
+// null path or field. Safe to call from any number of threads at once.
+// Reads go through the calling thread's MetadataScratch, and the request is
+// kept while the same fields are asked for, so a thread reading PE version
+// fields into a large enough buffer allocates nothing once warm.
+int64_t ReadFlatMetadata(const char* utf8_path, const char* const* fields,
+                         size_t field_count, uint8_t* buffer,
+                         size_t capacity);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_FLAT_METADATA_H_
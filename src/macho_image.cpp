@@ -0,0 +1,352 @@
+#include "macho_image.h"
+
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr uint32_t kMagic32 = 0xFEEDFACE;      // MH_MAGIC
+constexpr uint32_t kMagic64 = 0xFEEDFACF;      // MH_MAGIC_64
+constexpr uint32_t kMagic32Swapped = 0xCEFAEDFE;
+constexpr uint32_t kMagic64Swapped = 0xCFFAEDFE;
+constexpr uint32_t kFatMagic = 0xCAFEBABE;     // FAT_MAGIC, always big-endian
+constexpr uint32_t kFatMagic64 = 0xCAFEBABF;   // FAT_MAGIC_64
+
+constexpr size_t kHeaderSize32 = 28;
+constexpr size_t kHeaderSize64 = 32;
+constexpr size_t kFatHeaderSize = 8;
+constexpr size_t kFatArchSize = 20;
+constexpr size_t kFatArchSize64 = 32;
+// Java class files share FAT_MAGIC; their major version (45 and up) lands
+// where nfat_arch would be. Real universal binaries have a handful of slices.
+constexpr uint32_t kMaxFatArchitectures = 30;
+
+constexpr size_t kLoadCommandSize = 8;
+constexpr uint32_t kCommandSegment = 0x1;             // LC_SEGMENT
+constexpr uint32_t kCommandIdDylib = 0xD;             // LC_ID_DYLIB
+constexpr uint32_t kCommandSegment64 = 0x19;          // LC_SEGMENT_64
+constexpr uint32_t kCommandUuid = 0x1B;               // LC_UUID
+constexpr uint32_t kCommandCodeSignature = 0x1D;      // LC_CODE_SIGNATURE
+constexpr uint32_t kCommandVersionMinMacOS = 0x24;    // LC_VERSION_MIN_MACOSX
+constexpr uint32_t kCommandVersionMinIOS = 0x25;      // LC_VERSION_MIN_IPHONEOS
+constexpr uint32_t kCommandVersionMinTvOS = 0x2F;     // LC_VERSION_MIN_TVOS
+constexpr uint32_t kCommandVersionMinWatchOS = 0x30;  // LC_VERSION_MIN_WATCHOS
+constexpr uint32_t kCommandBuildVersion = 0x32;       // LC_BUILD_VERSION
+
+constexpr size_t kSegmentCommandSize32 = 56;
+constexpr size_t kSegmentCommandSize64 = 72;
+constexpr size_t kSectionSize32 = 68;
+constexpr size_t kSectionSize64 = 80;
+constexpr size_t kNameSize = 16;  // sectname and segname
+
+constexpr uint32_t kCpuArch64 = 0x01000000;     // CPU_ARCH_ABI64
+constexpr uint32_t kCpuArch64_32 = 0x02000000;  // CPU_ARCH_ABI64_32
+constexpr uint32_t kCpuPowerPC = 18;
+constexpr uint32_t kCpuSubtypeMask = 0x00FFFFFF;
+
+// Compares a fixed-size, NUL-padded Mach-O name with |name|.
+bool NameEquals(const uint8_t* field, const char* name) {
+  size_t length = std::strlen(name);
+  return std::memcmp(field, name, length) == 0 &&
+         (length == kNameSize || field[length] == 0);
+}
+
+bool ToSize(uint64_t value, size_t* out) {
+  if (value > std::numeric_limits<size_t>::max()) {
+    return false;
+  }
+  *out = static_cast<size_t>(value);
+  return true;
+}
+
+}  // namespace
+
+bool ReadMachOSlices(ByteView file, std::vector<MachOSlice>* slices) {
+  slices->clear();
+  if (file.size < 4) {
+    return false;
+  }
+  uint32_t magic = LoadBe32(file.data);
+  if (magic != kFatMagic && magic != kFatMagic64) {
+    MachOImage image;
+    if (!image.Parse(file)) {
+      return false;
+    }
+    slices->push_back({image.cpu_type(), image.cpu_subtype(), file});
+    return true;
+  }
+
+  if (!file.Contains(0, kFatHeaderSize)) {
+    return false;
+  }
+  uint32_t count = LoadBe32(file.data + 4);
+  size_t arch_size = magic == kFatMagic64 ? kFatArchSize64 : kFatArchSize;
+  if (count == 0 || count > kMaxFatArchitectures ||
+      !file.Contains(kFatHeaderSize, count * arch_size)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint8_t* arch = file.data + kFatHeaderSize + i * arch_size;
+    uint64_t offset;
+    uint64_t size;
+    if (magic == kFatMagic64) {
+      offset = LoadBe64(arch + 8);
+      size = LoadBe64(arch + 16);
+    } else {
+      offset = LoadBe32(arch + 8);
+      size = LoadBe32(arch + 12);
+    }
+    size_t slice_offset;
+    size_t slice_size;
+    if (!ToSize(offset, &slice_offset) || !ToSize(size, &slice_size) ||
+        !file.Contains(slice_offset, slice_size)) {
+      continue;
+    }
+    slices->push_back({LoadBe32(arch), LoadBe32(arch + 4),
+                       file.Sub(slice_offset, slice_size)});
+  }
+  return !slices->empty();
+}
+
+const MachOSlice& PreferredMachOSlice(const std::vector<MachOSlice>& slices) {
+  for (uint32_t cpu_type : {kMachOCpuArm64, kMachOCpuX86_64}) {
+    for (const MachOSlice& slice : slices) {
+      if (slice.cpu_type == cpu_type) {
+        return slice;
+      }
+    }
+  }
+  return slices.front();
+}
+
+bool MachOImage::Parse(ByteView image) {
+  *this = MachOImage();
+  if (!image.Contains(0, kHeaderSize32)) {
+    return false;
+  }
+  switch (LoadLe32(image.data)) {
+    case kMagic32:
+      break;
+    case kMagic64:
+      is_64bit_ = true;
+      break;
+    case kMagic32Swapped:
+      big_endian_ = true;
+      break;
+    case kMagic64Swapped:
+      is_64bit_ = true;
+      big_endian_ = true;
+      break;
+    default:
+      return false;
+  }
+  size_t header_size = is_64bit_ ? kHeaderSize64 : kHeaderSize32;
+  if (!image.Contains(0, header_size)) {
+    return false;
+  }
+  image_ = image;
+  cpu_type_ = Load32(image.data + 4);
+  cpu_subtype_ = Load32(image.data + 8);
+  file_type_ = Load32(image.data + 12);
+  uint32_t command_count = Load32(image.data + 16);
+  uint32_t commands_size = Load32(image.data + 20);
+
+  // Everything this reader needs is in the load command region; a truncated
+  // one is read as far as it goes.
+  ByteView commands = image.Sub(header_size, commands_size);
+  if (commands.empty()) {
+    commands = image.From(header_size);
+  }
+  size_t offset = 0;
+  for (uint32_t i = 0; i < command_count; ++i) {
+    if (!commands.Contains(offset, kLoadCommandSize)) {
+      break;
+    }
+    uint32_t type = Load32(commands.data + offset);
+    uint32_t size = Load32(commands.data + offset + 4);
+    if (size < kLoadCommandSize || !commands.Contains(offset, size)) {
+      break;
+    }
+    ReadCommand(type, commands.Sub(offset, size));
+    offset += size;
+  }
+  return true;
+}
+
+void MachOImage::ReadCommand(uint32_t type, ByteView command) {
+  switch (type) {
+    case kCommandUuid:
+      if (command.size >= kLoadCommandSize + 16) {
+        uuid_ = command.Sub(kLoadCommandSize, 16);
+      }
+      break;
+    case kCommandBuildVersion:
+      if (command.size >= 24) {
+        build_version_.platform = Load32(command.data + 8);
+        build_version_.min_os = Load32(command.data + 12);
+        build_version_.sdk = Load32(command.data + 16);
+        has_build_version_ = true;
+      }
+      break;
+    case kCommandVersionMinMacOS:
+    case kCommandVersionMinIOS:
+    case kCommandVersionMinTvOS:
+    case kCommandVersionMinWatchOS:
+      // LC_BUILD_VERSION supersedes these when both are present.
+      if (command.size >= 16 && !has_build_version_) {
+        build_version_.platform =
+            type == kCommandVersionMinMacOS  ? kPlatformMacOS
+            : type == kCommandVersionMinIOS  ? kPlatformIOS
+            : type == kCommandVersionMinTvOS ? kPlatformTvOS
+                                             : kPlatformWatchOS;
+        build_version_.min_os = Load32(command.data + 8);
+        build_version_.sdk = Load32(command.data + 12);
+        has_build_version_ = true;
+      }
+      break;
+    case kCommandIdDylib:
+      if (command.size >= 24) {
+        uint32_t name_offset = Load32(command.data + 8);
+        ByteView name = command.From(name_offset);
+        if (name_offset >= 24 && !name.empty()) {
+          const void* end = std::memchr(name.data, 0, name.size);
+          if (end != nullptr) {
+            dylib_id_.install_name =
+                name.Sub(0, static_cast<const uint8_t*>(end) - name.data);
+          }
+        }
+        dylib_id_.current_version = Load32(command.data + 16);
+        dylib_id_.compatibility_version = Load32(command.data + 20);
+        has_dylib_id_ = true;
+      }
+      break;
+    case kCommandCodeSignature:
+      // linkedit_data_command; the offset is relative to this slice.
+      if (command.size >= 16) {
+        code_signature_ =
+            image_.Sub(Load32(command.data + 8), Load32(command.data + 12));
+      }
+      break;
+    case kCommandSegment:
+    case kCommandSegment64:
+      if (info_plist_.empty()) {
+        ReadSegment(command);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void MachOImage::ReadSegment(ByteView command) {
+  size_t command_size =
+      is_64bit_ ? kSegmentCommandSize64 : kSegmentCommandSize32;
+  size_t section_size = is_64bit_ ? kSectionSize64 : kSectionSize32;
+  if (command.size < command_size ||
+      !NameEquals(command.data + kLoadCommandSize, "__TEXT")) {
+    return;
+  }
+  uint32_t section_count = Load32(command.data + command_size - 8);
+  if (section_count > (command.size - command_size) / section_size) {
+    section_count =
+        static_cast<uint32_t>((command.size - command_size) / section_size);
+  }
+  for (uint32_t i = 0; i < section_count; ++i) {
+    const uint8_t* section = command.data + command_size + i * section_size;
+    if (!NameEquals(section, "__info_plist")) {
+      continue;
+    }
+    uint64_t size = is_64bit_ ? Load64(section + 40) : Load32(section + 36);
+    uint32_t offset = Load32(section + (is_64bit_ ? 48 : 40));
+    size_t plist_size;
+    if (ToSize(size, &plist_size)) {
+      info_plist_ = image_.Sub(offset, plist_size);
+    }
+    return;
+  }
+}
+
+bool MachOImage::GetBuildVersion(MachOBuildVersion* version) const {
+  if (!has_build_version_) {
+    return false;
+  }
+  *version = build_version_;
+  return true;
+}
+
+bool MachOImage::GetDylibId(MachODylibId* id) const {
+  if (!has_dylib_id_) {
+    return false;
+  }
+  *id = dylib_id_;
+  return true;
+}
+
+const char* MachOArchitectureName(uint32_t cpu_type, uint32_t cpu_subtype) {
+  cpu_subtype &= kCpuSubtypeMask;
+  switch (cpu_type) {
+    case kMachOCpuX86:
+      return "i386";
+    case kMachOCpuX86_64:
+      return cpu_subtype == 8 ? "x86_64h" : "x86_64";
+    case kMachOCpuArm:
+      switch (cpu_subtype) {
+        case 6:
+          return "armv6";
+        case 9:
+          return "armv7";
+        case 11:
+          return "armv7s";
+        case 12:
+          return "armv7k";
+        default:
+          return "arm";
+      }
+    case kMachOCpuArm64:
+      return cpu_subtype == 2 ? "arm64e" : "arm64";
+    case kCpuArch64_32 | kMachOCpuArm:
+      return "arm64_32";
+    case kCpuPowerPC:
+      return "ppc";
+    case kCpuArch64 | kCpuPowerPC:
+      return "ppc64";
+    default:
+      return nullptr;
+  }
+}
+
+const char* MachOPlatformName(uint32_t platform) {
+  static const char* const kNames[] = {
+      nullptr,
+      "macOS",
+      "iOS",
+      "tvOS",
+      "watchOS",
+      "bridgeOS",
+      "Mac Catalyst",
+      "iOS Simulator",
+      "tvOS Simulator",
+      "watchOS Simulator",
+      "DriverKit",
+      "visionOS",
+      "visionOS Simulator",
+  };
+  if (platform >= sizeof(kNames) / sizeof(kNames[0])) {
+    return nullptr;
+  }
+  return kNames[platform];
+}
+
+std::string FormatMachOVersion(uint32_t version) {
+  std::string text = std::to_string(version >> 16) + '.' +
+                     std::to_string((version >> 8) & 0xFF);
+  if ((version & 0xFF) != 0) {
+    text += '.' + std::to_string(version & 0xFF);
+  }
+  return text;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,144 @@
+#ifndef FLUTTER_BIN_MACHO_IMAGE_H_
+#define FLUTTER_BIN_MACHO_IMAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+// cputype values.
+constexpr uint32_t kMachOCpuX86 = 7;
+constexpr uint32_t kMachOCpuX86_64 = 0x01000007;
+constexpr uint32_t kMachOCpuArm = 12;
+constexpr uint32_t kMachOCpuArm64 = 0x0100000C;
+
+// filetype values.
+enum MachOFileType : uint32_t {
+  kMachOTypeObject = 1,
+  kMachOTypeExecutable = 2,
+  kMachOTypeDylib = 6,
+  kMachOTypeBundle = 8,
+};
+
+// One architecture of a universal binary, or the whole file when it is thin.
+struct MachOSlice {
+  uint32_t cpu_type = 0;
+  uint32_t cpu_subtype = 0;
+  ByteView image;
+};
+
+// Splits |file| into its slices. Returns false if it is neither a thin nor
+// a universal (fat) Mach-O file. Slices that lie outside |file| are dropped.
+bool ReadMachOSlices(ByteView file, std::vector<MachOSlice>* slices);
+
+// Returns the slice a Mac would load: arm64, then x86_64, then the first.
+// |slices| must not be empty.
+const MachOSlice& PreferredMachOSlice(const std::vector<MachOSlice>& slices);
+
+// Minimum OS and SDK from LC_BUILD_VERSION or LC_VERSION_MIN_*. Versions
+// are packed as X.Y.Z in 16.8.8 bits; see FormatMachOVersion().
+struct MachOBuildVersion {
+  uint32_t platform = 0;
+  uint32_t min_os = 0;
+  uint32_t sdk = 0;
+};
+
+// LC_ID_DYLIB of a dynamic library. Versions are packed like
+// MachOBuildVersion's.
+struct MachODylibId {
+  ByteView install_name;
+  uint32_t current_version = 0;
+  uint32_t compatibility_version = 0;
+};
+
+// Reader for one thin Mach-O image.
+//
+// Like PeImage and ElfImage it parses an image held in memory without
+// copying it; all returned views point into the buffer passed to Parse(),
+// which must outlive this object. Parse() walks the load commands once and
+// never looks past them, except for the embedded Info.plist and code
+// signature whose bytes are only touched when a caller reads them.
+class MachOImage {
+ public:
+  // LC_BUILD_VERSION platform values.
+  enum Platform : uint32_t {
+    kPlatformMacOS = 1,
+    kPlatformIOS = 2,
+    kPlatformTvOS = 3,
+    kPlatformWatchOS = 4,
+  };
+
+  MachOImage() = default;
+
+  // Validates the header of |image| and reads its load commands. Returns
+  // false if it is not a thin Mach-O image.
+  bool Parse(ByteView image);
+
+  bool is_64bit() const { return is_64bit_; }
+  bool is_big_endian() const { return big_endian_; }
+  uint32_t cpu_type() const { return cpu_type_; }
+  uint32_t cpu_subtype() const { return cpu_subtype_; }
+  uint32_t file_type() const { return file_type_; }
+
+  // The LC_UUID bytes, or an empty view.
+  ByteView uuid() const { return uuid_; }
+
+  // Returns false if the image has no build version load command.
+  bool GetBuildVersion(MachOBuildVersion* version) const;
+
+  // Returns false if the image is not a dylib with LC_ID_DYLIB.
+  bool GetDylibId(MachODylibId* id) const;
+
+  // The contents of the __TEXT,__info_plist section, or an empty view.
+  // Command-line tools embed their Info.plist here.
+  ByteView info_plist() const { return info_plist_; }
+
+  // The LC_CODE_SIGNATURE SuperBlob, or an empty view. Like the Info.plist
+  // it is only located by Parse(), not read.
+  ByteView code_signature() const { return code_signature_; }
+
+ private:
+  uint32_t Load32(const uint8_t* p) const {
+    return big_endian_ ? LoadBe32(p) : LoadLe32(p);
+  }
+  uint64_t Load64(const uint8_t* p) const {
+    return big_endian_ ? LoadBe64(p) : LoadLe64(p);
+  }
+
+  // Records what the load command |command| of type |type| carries.
+  void ReadCommand(uint32_t type, ByteView command);
+  // Looks for __TEXT,__info_plist in an LC_SEGMENT or LC_SEGMENT_64.
+  void ReadSegment(ByteView command);
+
+  ByteView image_;
+  bool is_64bit_ = false;
+  bool big_endian_ = false;
+  uint32_t cpu_type_ = 0;
+  uint32_t cpu_subtype_ = 0;
+  uint32_t file_type_ = 0;
+  ByteView uuid_;
+  bool has_build_version_ = false;
+  MachOBuildVersion build_version_;
+  bool has_dylib_id_ = false;
+  MachODylibId dylib_id_;
+  ByteView info_plist_;
+  ByteView code_signature_;
+};
+
+// Returns the conventional name of a cputype/cpusubtype pair, e.g. "arm64",
+// or null for ones it does not know.
+const char* MachOArchitectureName(uint32_t cpu_type, uint32_t cpu_subtype);
+
+// Returns the name of an LC_BUILD_VERSION platform, e.g. "macOS", or null.
+const char* MachOPlatformName(uint32_t platform);
+
+// Formats a packed X.Y.Z version, leaving out a zero Z: "14.2", "1.2.3".
+std::string FormatMachOVersion(uint32_t version);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_MACHO_IMAGE_H_
@@ -0,0 +1,293 @@
+#include "macho_metadata.h"
+
+#include <string>
+#include <utility>
+
+#include "code_signature.h"
+#include "plist_reader.h"
+
+namespace flutter_bin {
+
+namespace {
+
+void Append(ByteView text, std::string* out) {
+  out->append(reinterpret_cast<const char*>(text.data), text.size);
+}
+
+// Mach-O keys answered from the load commands rather than the Info.plist.
+bool IsLoadCommandKey(const std::string& key) {
+  static const char* const kKeys[] = {
+      "fileDescription", "companyName", "uuid",
+      "architectures",   "platform",    "minOS",
+      "sdk",             "installName", "currentVersion",
+      "compatibilityVersion",
+  };
+  for (const char* name : kKeys) {
+    if (key == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The Info.plist values a request needs, read in a single pass.
+class InfoPlist {
+ public:
+  // Collects the plist keys behind the fields of |request|. For bundles
+  // fileDescription comes from CFBundleGetInfoString; for Mach-O files it is
+  // derived from the header instead.
+  InfoPlist(ByteView plist, const MetadataRequest& request, bool bundle) {
+    if (request.version) {
+      keys_.push_back("CFBundleShortVersionString");
+      keys_.push_back("CFBundleVersion");
+    }
+    for (const auto& field : request.strings) {
+      const std::string& key = field.first;
+      if (key == "productName") {
+        keys_.push_back("CFBundleName");
+      } else if (key == "legalCopyright") {
+        keys_.push_back("NSHumanReadableCopyright");
+      } else if (key == "originalFilename") {
+        keys_.push_back("CFBundleExecutable");
+      } else if (key == "fileDescription" && bundle) {
+        keys_.push_back("CFBundleGetInfoString");
+      } else if (key == kVersionKey) {
+        keys_.push_back("CFBundleShortVersionString");
+        keys_.push_back("CFBundleVersion");
+      } else if (!IsLoadCommandKey(key)) {
+        keys_.push_back(key);
+      }
+    }
+    valid_ = !keys_.empty() && ReadPlistValues(plist, keys_, &values_);
+  }
+
+  bool valid() const { return valid_; }
+
+  // Appends the scalar value of |key| to |out|. Returns false if the plist
+  // does not have one.
+  bool Get(const std::string& key, std::string* out) const {
+    for (size_t i = 0; i < values_.size(); ++i) {
+      const PlistValue& value = values_[i];
+      if (keys_[i] == key && value.found && !value.text.empty()) {
+        *out += value.text;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The version as the plugin has always reported it for bundles.
+  bool GetVersion(std::string* out) const {
+    return Get("CFBundleShortVersionString", out) ||
+           Get("CFBundleVersion", out);
+  }
+
+ private:
+  std::vector<std::string> keys_;
+  std::vector<PlistValue> values_;
+  bool valid_ = false;
+};
+
+// Answers field lookups for one Mach-O file from its preferred slice.
+class MachOFields {
+ public:
+  MachOFields(const std::vector<MachOSlice>& slices, const MachOImage& image,
+              const InfoPlist& plist)
+      : slices_(slices), image_(image), plist_(plist) {
+    image_.GetDylibId(&dylib_id_);
+  }
+
+  // Appends the value of |key| to |out|. Returns false if the file does not
+  // have it.
+  bool Get(const std::string& key, std::string* out) {
+    if (key == kVersionKey) {
+      if (plist_.GetVersion(out)) {
+        return true;
+      }
+      if (dylib_id_.current_version == 0) {
+        return false;
+      }
+      *out += FormatMachOVersion(dylib_id_.current_version);
+    } else if (key == "productName") {
+      return plist_.Get("CFBundleName", out);
+    } else if (key == "fileDescription") {
+      AppendDescription(out);
+    } else if (key == "legalCopyright") {
+      return plist_.Get("NSHumanReadableCopyright", out);
+    } else if (key == "originalFilename") {
+      if (plist_.Get("CFBundleExecutable", out)) {
+        return true;
+      }
+      ByteView name = dylib_id_.install_name;
+      for (size_t i = name.size; i > 0; --i) {
+        if (name.data[i - 1] == '/') {
+          name = name.From(i);
+          break;
+        }
+      }
+      Append(name, out);
+    } else if (key == "companyName") {
+      // No Mach-O counterpart.
+    } else if (key == "uuid") {
+      AppendUuid(out);
+    } else if (key == "architectures") {
+      for (size_t i = 0; i < slices_.size(); ++i) {
+        if (i != 0) {
+          out->push_back(',');
+        }
+        AppendArchitecture(slices_[i].cpu_type, slices_[i].cpu_subtype, out);
+      }
+    } else if (key == "platform" || key == "minOS" || key == "sdk") {
+      MachOBuildVersion version;
+      if (!image_.GetBuildVersion(&version)) {
+        return false;
+      }
+      if (key == "platform") {
+        const char* name = MachOPlatformName(version.platform);
+        if (name != nullptr) {
+          *out += name;
+        } else {
+          *out += "platform " + std::to_string(version.platform);
+        }
+      } else {
+        *out += FormatMachOVersion(key == "sdk" ? version.sdk : version.min_os);
+      }
+    } else if (key == "installName") {
+      Append(dylib_id_.install_name, out);
+    } else if (key == "currentVersion" || key == "compatibilityVersion") {
+      if (dylib_id_.install_name.empty()) {
+        return false;
+      }
+      *out += FormatMachOVersion(key == "currentVersion"
+                                     ? dylib_id_.current_version
+                                     : dylib_id_.compatibility_version);
+    } else {
+      return plist_.Get(key, out);
+    }
+    return true;
+  }
+
+ private:
+  static void AppendArchitecture(uint32_t cpu_type, uint32_t cpu_subtype,
+                                 std::string* out) {
+    const char* name = MachOArchitectureName(cpu_type, cpu_subtype);
+    if (name != nullptr) {
+      *out += name;
+    } else {
+      *out += "cpu " + std::to_string(cpu_type);
+    }
+  }
+
+  void AppendDescription(std::string* out) {
+    if (slices_.size() > 1) {
+      *out += "Mach-O universal binary (";
+      for (size_t i = 0; i < slices_.size(); ++i) {
+        if (i != 0) {
+          *out += ", ";
+        }
+        AppendArchitecture(slices_[i].cpu_type, slices_[i].cpu_subtype, out);
+      }
+      out->push_back(')');
+      return;
+    }
+    *out += image_.is_64bit() ? "Mach-O 64-bit " : "Mach-O ";
+    AppendArchitecture(image_.cpu_type(), image_.cpu_subtype(), out);
+    switch (image_.file_type()) {
+      case kMachOTypeObject:
+        *out += " object";
+        break;
+      case kMachOTypeExecutable:
+        *out += " executable";
+        break;
+      case kMachOTypeDylib:
+        *out += " dynamic library";
+        break;
+      case kMachOTypeBundle:
+        *out += " bundle";
+        break;
+      default:
+        *out += " file";
+        break;
+    }
+  }
+
+  void AppendUuid(std::string* out) {
+    static const char kHex[] = "0123456789ABCDEF";
+    ByteView uuid = image_.uuid();
+    for (size_t i = 0; i < uuid.size; ++i) {
+      if (i == 4 || i == 6 || i == 8 || i == 10) {
+        out->push_back('-');
+      }
+      out->push_back(kHex[uuid.data[i] >> 4]);
+      out->push_back(kHex[uuid.data[i] & 0xF]);
+    }
+  }
+
+  const std::vector<MachOSlice>& slices_;
+  const MachOImage& image_;
+  const InfoPlist& plist_;
+  MachODylibId dylib_id_;
+};
+
+}  // namespace
+
+void ReadMachOMetadata(const std::vector<MachOSlice>& slices,
+                       const MetadataRequest& request,
+                       BinaryMetadata* metadata) {
+  MachOImage image;
+  if (slices.empty() || !image.Parse(PreferredMachOSlice(slices).image)) {
+    metadata->error = MetadataError::kUnsupportedFormat;
+    return;
+  }
+  InfoPlist plist(image.info_plist(), request, /*bundle=*/false);
+  MachOFields fields(slices, image, plist);
+  if (request.version) {
+    std::string version;
+    if (fields.Get(kVersionKey, &version) && !version.empty()) {
+      metadata->fields[kVersionKey] = std::move(version);
+    }
+  }
+  for (const auto& field : request.strings) {
+    // Unknown keys are reported empty, like missing version resource keys.
+    fields.Get(field.first, &metadata->fields[field.first]);
+  }
+  CodeSigner signer;
+  if (request.signature &&
+      ReadCodeSigner(FindMachOSignedData(image.code_signature()), &signer)) {
+    AddCodeSignerFields(signer, &metadata->fields);
+  }
+}
+
+void ReadInfoPlistMetadata(ByteView plist, const MetadataRequest& request,
+                           BinaryMetadata* metadata) {
+  if (DetectPlistFormat(plist) == PlistFormat::kUnknown) {
+    metadata->error = MetadataError::kUnsupportedFormat;
+    return;
+  }
+  InfoPlist values(plist, request, /*bundle=*/true);
+  if (request.version) {
+    std::string version;
+    if (values.GetVersion(&version)) {
+      metadata->fields[kVersionKey] = std::move(version);
+    }
+  }
+  for (const auto& field : request.strings) {
+    const std::string& key = field.first;
+    std::string& out = metadata->fields[key];
+    if (key == kVersionKey) {
+      values.GetVersion(&out);
+    } else if (key == "productName") {
+      values.Get("CFBundleName", &out);
+    } else if (key == "fileDescription") {
+      values.Get("CFBundleGetInfoString", &out);
+    } else if (key == "legalCopyright") {
+      values.Get("NSHumanReadableCopyright", &out);
+    } else if (key == "originalFilename") {
+      values.Get("CFBundleExecutable", &out);
+    } else {
+      values.Get(key, &out);
+    }
+  }
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,49 @@
+#ifndef FLUTTER_BIN_MACHO_METADATA_H_
+#define FLUTTER_BIN_MACHO_METADATA_H_
+
+#include <vector>
+
+#include "binary_metadata.h"
+#include "macho_image.h"
+
+namespace flutter_bin {
+
+// Fills the fields selected by |request| from a thin or universal Mach-O
+// file split into |slices| by ReadMachOSlices(). Fields come from the slice
+// PreferredMachOSlice() picks and its embedded __TEXT,__info_plist.
+//
+// The standard fields are mapped as follows:
+//   version           CFBundleShortVersionString, else CFBundleVersion, else
+//                     the LC_ID_DYLIB current version
+//   productName       CFBundleName
+//   fileDescription   e.g. "Mach-O 64-bit arm64 executable" or
+//                     "Mach-O universal binary (x86_64, arm64)"
+//   legalCopyright    NSHumanReadableCopyright
+//   originalFilename  CFBundleExecutable, else the install name's file name
+// companyName has no Mach-O counterpart and stays empty.
+//
+// Mach-O files also answer these custom keys:
+//   uuid                  LC_UUID, e.g. "1A2B3C4D-..."
+//   architectures         every slice, comma-separated, e.g. "x86_64,arm64"
+//   platform              e.g. "macOS", "iOS Simulator"
+//   minOS, sdk            from LC_BUILD_VERSION or LC_VERSION_MIN_*
+//   installName           LC_ID_DYLIB install name
+//   currentVersion        LC_ID_DYLIB current version
+//   compatibilityVersion  LC_ID_DYLIB compatibility version
+// Any other key is looked up in the embedded Info.plist, e.g.
+// "CFBundleIdentifier".
+// The signer fields come from the CMS signature in LC_CODE_SIGNATURE.
+void ReadMachOMetadata(const std::vector<MachOSlice>& slices,
+                       const MetadataRequest& request,
+                       BinaryMetadata* metadata);
+
+// Fills the fields selected by |request| from the Info.plist of an app
+// bundle, binary or XML. The standard fields map as for Mach-O files except
+// fileDescription, which is CFBundleGetInfoString; custom keys are plist
+// keys. Only the requested keys are decoded.
+void ReadInfoPlistMetadata(ByteView plist, const MetadataRequest& request,
+                           BinaryMetadata* metadata);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_MACHO_METADATA_H_
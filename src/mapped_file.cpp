@@ -0,0 +1,203 @@
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+#include "perf_stats.h"
+#include "unicode.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace flutter_bin {
+
+MappedFile::~MappedFile() { Close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Close();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    error_ = std::exchange(other.error_, Error::kNone);
+#if defined(_WIN32)
+    mapping_handle_ = std::exchange(other.mapping_handle_, nullptr);
+#endif
+  }
+  return *this;
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const std::string& utf8_path) {
+  Close();
+
+  // Kept per thread so that its capacity is reused from call to call.
+  thread_local std::wstring wide_path;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kPathConversion);
+    Utf8ToWide(utf8_path, &wide_path);
+  }
+
+  // Share everything so that we never block installers or running images.
+  HANDLE file = CreateFileW(
+      wide_path.c_str(), GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    DWORD error = GetLastError();
+    if (error == ERROR_ACCESS_DENIED || error == ERROR_SHARING_VIOLATION) {
+      // Directories also land here because we don't ask for backup semantics.
+      DWORD attributes = GetFileAttributesW(wide_path.c_str());
+      error_ = (attributes != INVALID_FILE_ATTRIBUTES &&
+                (attributes & FILE_ATTRIBUTE_DIRECTORY))
+                   ? Error::kNotRegularFile
+                   : Error::kAccessDenied;
+    } else {
+      error_ = Error::kNotFound;
+    }
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0 ||
+      static_cast<unsigned long long>(file_size.QuadPart) > SIZE_MAX) {
+    CloseHandle(file);
+    error_ = Error::kEmpty;
+    return false;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  // The mapping keeps its own reference to the file.
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    error_ = Error::kMapFailed;
+    return false;
+  }
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    CloseHandle(mapping);
+    error_ = Error::kMapFailed;
+    return false;
+  }
+
+  data_ = static_cast<const uint8_t*>(view);
+  size_ = static_cast<size_t>(file_size.QuadPart);
+  mapping_handle_ = mapping;
+  return true;
+}
+
+bool MappedFile::Open(const PositionedFile& file) {
+  Close();
+  if (file.size() > SIZE_MAX) {
+    error_ = Error::kMapFailed;
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingW(file.handle(), nullptr, PAGE_READONLY,
+                                      0, 0, nullptr);
+  if (mapping == nullptr) {
+    error_ = Error::kMapFailed;
+    return false;
+  }
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    CloseHandle(mapping);
+    error_ = Error::kMapFailed;
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>(view);
+  size_ = static_cast<size_t>(file.size());
+  mapping_handle_ = mapping;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_handle_ != nullptr) {
+    CloseHandle(mapping_handle_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  error_ = Error::kNone;
+  mapping_handle_ = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& utf8_path) {
+  Close();
+
+  int fd = ::open(utf8_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    error_ = (errno == EACCES || errno == EPERM) ? Error::kAccessDenied
+                                                 : Error::kNotFound;
+    return false;
+  }
+
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+    ::close(fd);
+    error_ = Error::kNotRegularFile;
+    return false;
+  }
+  if (file_stat.st_size <= 0) {
+    ::close(fd);
+    error_ = Error::kEmpty;
+    return false;
+  }
+
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  void* view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file.
+  ::close(fd);
+  if (view == MAP_FAILED) {
+    error_ = Error::kMapFailed;
+    return false;
+  }
+
+  data_ = static_cast<const uint8_t*>(view);
+  size_ = size;
+  return true;
+}
+
+bool MappedFile::Open(const PositionedFile& file) {
+  Close();
+  if (file.size() > SIZE_MAX) {
+    error_ = Error::kMapFailed;
+    return false;
+  }
+  size_t size = static_cast<size_t>(file.size());
+  void* view =
+      ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.descriptor(), 0);
+  if (view == MAP_FAILED) {
+    error_ = Error::kMapFailed;
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>(view);
+  size_ = size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<uint8_t*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  error_ = Error::kNone;
+}
+
+#endif
+
+}  // namespace flutter_bin
@@ -0,0 +1,67 @@
+#ifndef FLUTTER_BIN_MAPPED_FILE_H_
+#define FLUTTER_BIN_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "byte_view.h"
+#include "positioned_file.h"
+
+namespace flutter_bin {
+
+// A read-only memory mapping of a whole file.
+//
+// The mapping is shared with the page cache, so parsers only fault in the
+// pages they actually touch (headers, section table, resource directory).
+class MappedFile {
+ public:
+  // Why the last Open() failed.
+  enum class Error {
+    kNone,
+    kNotFound,
+    kAccessDenied,
+    kNotRegularFile,
+    kEmpty,
+    kMapFailed,
+  };
+
+  MappedFile() = default;
+  ~MappedFile();
+
+  // Disallow copy and assign.
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  // Maps the file at |utf8_path|. Returns false if the file cannot be opened,
+  // is empty, or cannot be mapped. Any previous mapping is released first.
+  bool Open(const std::string& utf8_path);
+
+  // Maps the whole of |file|, which must be open, without opening it again.
+  // |file| may be closed once this returns.
+  bool Open(const PositionedFile& file);
+
+  // Releases the mapping.
+  void Close();
+
+  bool is_open() const { return data_ != nullptr; }
+  Error error() const { return error_; }
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+  ByteView view() const { return ByteView(data_, size_); }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  Error error_ = Error::kNone;
+#if defined(_WIN32)
+  void* mapping_handle_ = nullptr;
+#endif
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_MAPPED_FILE_H_
@@ -0,0 +1,269 @@
+#include "metadata_cache.h"
+
+#include "perf_stats.h"
+
+namespace flutter_bin {
+
+namespace {
+
+// Rough per-entry cost of the list node, hash node and map nodes beyond the
+// string payloads.
+constexpr size_t kEntryOverhead = 128;
+constexpr size_t kFieldOverhead = 64;
+
+// Separates the path from the request in cache keys; cannot occur in either.
+constexpr char kKeySeparator = '\0';
+
+size_t Charge(const std::string& key, const BinaryMetadata& metadata) {
+  size_t charge = kEntryOverhead + key.size();
+  for (const auto& field : metadata.fields) {
+    charge += kFieldOverhead + field.first.size() + field.second.size();
+  }
+  return charge;
+}
+
+// Results that depend only on the file's contents; anything else may change
+// without the stamp changing (permissions, transient I/O errors).
+bool IsCacheable(MetadataError error) {
+  return error == MetadataError::kNone ||
+         error == MetadataError::kNoVersionInfo ||
+         error == MetadataError::kUnsupportedFormat;
+}
+
+}  // namespace
+
+std::string MetadataCacheKey(const std::string& path,
+                             const MetadataRequest& request) {
+  std::string key = NormalizePath(path);
+  key += kKeySeparator;
+  key += request.version ? 'v' : '-';
+  for (const auto& field : request.strings) {
+    key += kKeySeparator;
+    key += field.first;
+    key += '=';
+    key += field.second;
+  }
+  for (HashAlgorithm algorithm : request.hashes) {
+    key += kKeySeparator;
+    key += '#';
+    key += HashAlgorithmName(algorithm);
+  }
+  if (request.signature) {
+    key += kKeySeparator;
+    key += '!';
+  }
+  return key;
+}
+
+MetadataCache::MetadataCache(size_t budget)
+    : shards_(new Shard[kShardCount]), budget_(budget) {}
+
+MetadataCache::Shard& MetadataCache::ShardFor(const std::string& key) {
+  return shards_[std::hash<std::string>()(key) % kShardCount];
+}
+
+BinaryMetadata MetadataCache::Get(const std::string& path,
+                                  const MetadataRequest& request,
+                                  const Reader& read) {
+  // Stamp first: if the file changes while it is read, the entry is stored
+  // under the old stamp and the next lookup misses.
+  std::shared_ptr<MetadataIndex> index = this->index();
+  FileStamp stamp;
+  bool stamped = false;
+  if (budget_.load(std::memory_order_relaxed) != 0 || index) {
+    ScopedPhaseTimer timer(PerfPhase::kAttributeLookup);
+    stamped = ReadFileStamp(path, &stamp);
+  }
+  if (!stamped) {
+    return read(path, request);
+  }
+  std::string key = MetadataCacheKey(path, request);
+  BinaryMetadata metadata;
+  if (LookupKey(key, stamp, &metadata)) {
+    return metadata;
+  }
+  if (index && index->Lookup(key, stamp, &metadata)) {
+    index_hits_.fetch_add(1, std::memory_order_relaxed);
+    InsertKey(std::move(key), stamp, metadata);
+    return metadata;
+  }
+  metadata = read(path, request);
+  if (index && IsCacheable(metadata.error)) {
+    index->Append(key, stamp, metadata);
+  }
+  InsertKey(std::move(key), stamp, metadata);
+  return metadata;
+}
+
+void MetadataCache::GetBatch(const std::vector<std::string>& paths,
+                             const MetadataRequest& request, ThreadPool* pool,
+                             const BatchReader& read,
+                             std::vector<BinaryMetadata>* results) {
+  results->assign(paths.size(), BinaryMetadata());
+  std::shared_ptr<MetadataIndex> index = this->index();
+  bool enabled = budget_.load(std::memory_order_relaxed) != 0 || index;
+  std::vector<FileStamp> stamps(paths.size());
+  // Empty for files that could not be stamped, which are read but not kept.
+  std::vector<std::string> keys(paths.size());
+  std::vector<char> found(paths.size(), 0);
+  if (enabled) {
+    pool->ParallelFor(paths.size(), [&](size_t i) {
+      {
+        ScopedPhaseTimer timer(PerfPhase::kAttributeLookup);
+        if (!ReadFileStamp(paths[i], &stamps[i])) {
+          return;
+        }
+      }
+      keys[i] = MetadataCacheKey(paths[i], request);
+      BinaryMetadata* metadata = &(*results)[i];
+      if (LookupKey(keys[i], stamps[i], metadata)) {
+        found[i] = 1;
+      } else if (index && index->Lookup(keys[i], stamps[i], metadata)) {
+        index_hits_.fetch_add(1, std::memory_order_relaxed);
+        InsertKey(keys[i], stamps[i], *metadata);
+        found[i] = 1;
+      }
+    });
+  }
+
+  std::vector<size_t> misses;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    if (!found[i]) {
+      misses.push_back(i);
+    }
+  }
+  if (misses.empty()) {
+    return;
+  }
+  if (!read(misses, results)) {
+    return;
+  }
+  pool->ParallelFor(misses.size(), [&](size_t j) {
+    size_t i = misses[j];
+    if (keys[i].empty()) {
+      return;
+    }
+    const BinaryMetadata& metadata = (*results)[i];
+    if (index && IsCacheable(metadata.error)) {
+      index->Append(keys[i], stamps[i], metadata);
+    }
+    InsertKey(std::move(keys[i]), stamps[i], metadata);
+  });
+}
+
+bool MetadataCache::Lookup(const std::string& path, const FileStamp& stamp,
+                           const MetadataRequest& request,
+                           BinaryMetadata* metadata) {
+  return LookupKey(MetadataCacheKey(path, request), stamp, metadata);
+}
+
+bool MetadataCache::LookupKey(const std::string& key, const FileStamp& stamp,
+                              BinaryMetadata* metadata) {
+  Shard& shard = ShardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(key);
+  if (it == shard.index.end()) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (it->second->stamp != stamp) {
+    // The file has changed; the entry can never hit again.
+    shard.bytes -= it->second->charge;
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+  *metadata = it->second->metadata;
+  // A hit reads nothing from the file.
+  metadata->bytes_read = 0;
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void MetadataCache::Insert(const std::string& path, const FileStamp& stamp,
+                           const MetadataRequest& request,
+                           const BinaryMetadata& metadata) {
+  InsertKey(MetadataCacheKey(path, request), stamp, metadata);
+}
+
+void MetadataCache::InsertKey(std::string key, const FileStamp& stamp,
+                              const BinaryMetadata& metadata) {
+  if (!IsCacheable(metadata.error)) {
+    return;
+  }
+  size_t shard_budget = budget_.load(std::memory_order_relaxed) / kShardCount;
+  size_t charge = Charge(key, metadata);
+  if (charge > shard_budget) {
+    return;
+  }
+
+  Shard& shard = ShardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(key);
+  if (it != shard.index.end()) {
+    shard.bytes -= it->second->charge;
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+  }
+  shard.lru.push_front(Node{key, stamp, metadata, charge});
+  shard.index.emplace(std::move(key), shard.lru.begin());
+  shard.bytes += charge;
+  Trim(&shard, shard_budget);
+}
+
+void MetadataCache::Trim(Shard* shard, size_t shard_budget) {
+  while (shard->bytes > shard_budget && !shard->lru.empty()) {
+    Node& coldest = shard->lru.back();
+    shard->bytes -= coldest.charge;
+    shard->index.erase(coldest.key);
+    shard->lru.pop_back();
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void MetadataCache::SetIndex(std::shared_ptr<MetadataIndex> index) {
+  std::atomic_store(&index_, std::move(index));
+}
+
+std::shared_ptr<MetadataIndex> MetadataCache::index() const {
+  return std::atomic_load(&index_);
+}
+
+void MetadataCache::Clear() {
+  if (std::shared_ptr<MetadataIndex> index = this->index()) {
+    index->Clear();
+  }
+  for (size_t i = 0; i < kShardCount; ++i) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    shards_[i].lru.clear();
+    shards_[i].index.clear();
+    shards_[i].bytes = 0;
+  }
+}
+
+void MetadataCache::SetBudget(size_t budget) {
+  budget_.store(budget, std::memory_order_relaxed);
+  for (size_t i = 0; i < kShardCount; ++i) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    Trim(&shards_[i], budget / kShardCount);
+  }
+}
+
+MetadataCacheStats MetadataCache::stats() const {
+  MetadataCacheStats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.evictions = evictions_.load(std::memory_order_relaxed);
+  stats.index_hits = index_hits_.load(std::memory_order_relaxed);
+  stats.budget = budget_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kShardCount; ++i) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    stats.entries += shards_[i].index.size();
+    stats.bytes += shards_[i].bytes;
+  }
+  return stats;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,137 @@
+#ifndef FLUTTER_BIN_METADATA_CACHE_H_
+#define FLUTTER_BIN_METADATA_CACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "file_stamp.h"
+#include "metadata_index.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+
+struct MetadataCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  // Misses in memory that were answered by the persistent index.
+  uint64_t index_hits = 0;
+  size_t entries = 0;
+  size_t bytes = 0;
+  size_t budget = 0;
+};
+
+// Remembers what ReadBinaryMetadata() returned for a file until the file
+// changes, so that repeated lookups cost a stat and a hash probe. With a
+// MetadataIndex attached, what is read also survives restarts.
+//
+// Entries are keyed by the normalized path and the request, and are only
+// returned while the file's FileStamp still matches. The cache is split into
+// independently locked LRU shards so that batch workers rarely contend.
+class MetadataCache {
+ public:
+  using Reader = std::function<BinaryMetadata(const std::string& path,
+                                              const MetadataRequest& request)>;
+  // Fills in (*results)[i] for each i in |misses|. Returns false if it
+  // stopped early, in which case nothing it read is cached.
+  using BatchReader =
+      std::function<bool(const std::vector<size_t>& misses,
+                         std::vector<BinaryMetadata>* results)>;
+
+  static constexpr size_t kDefaultBudget = 8 * 1024 * 1024;
+
+  // |budget| bounds the approximate memory used by entries; 0 disables the
+  // cache.
+  explicit MetadataCache(size_t budget = kDefaultBudget);
+
+  // Disallow copy and assign.
+  MetadataCache(const MetadataCache&) = delete;
+  MetadataCache& operator=(const MetadataCache&) = delete;
+
+  // Returns the cached metadata for |path| if the file is unchanged, or
+  // calls |read| and caches what it returns. Safe to call from any thread.
+  BinaryMetadata Get(const std::string& path, const MetadataRequest& request,
+                     const Reader& read);
+
+  // Get() for every path in |paths| at once: the stamps and lookups run on
+  // |pool|, and whatever is left is handed to |read| in one call so that it
+  // can read the files together. |results| ends up parallel to |paths|.
+  void GetBatch(const std::vector<std::string>& paths,
+                const MetadataRequest& request, ThreadPool* pool,
+                const BatchReader& read, std::vector<BinaryMetadata>* results);
+
+  // Lower-level halves of Get().
+  bool Lookup(const std::string& path, const FileStamp& stamp,
+              const MetadataRequest& request, BinaryMetadata* metadata);
+  void Insert(const std::string& path, const FileStamp& stamp,
+              const MetadataRequest& request, const BinaryMetadata& metadata);
+
+  // Backs the cache with |index|, or detaches it if null. Safe to call while
+  // other threads use the cache.
+  void SetIndex(std::shared_ptr<MetadataIndex> index);
+  std::shared_ptr<MetadataIndex> index() const;
+
+  // Drops every entry, including those in the index. Counters are kept.
+  void Clear();
+
+  // Changes the budget, evicting entries as needed.
+  void SetBudget(size_t budget);
+
+  MetadataCacheStats stats() const;
+
+ private:
+  static constexpr size_t kShardCount = 16;
+
+  struct Node {
+    std::string key;
+    FileStamp stamp;
+    BinaryMetadata metadata;
+    size_t charge = 0;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    // Most recently used first.
+    std::list<Node> lru;
+    std::unordered_map<std::string, std::list<Node>::iterator> index;
+    size_t bytes = 0;
+  };
+
+  Shard& ShardFor(const std::string& key);
+
+  bool LookupKey(const std::string& key, const FileStamp& stamp,
+                 BinaryMetadata* metadata);
+  void InsertKey(std::string key, const FileStamp& stamp,
+                 const BinaryMetadata& metadata);
+
+  // Evicts from the cold end of |shard| until it fits |shard_budget|.
+  // |shard| must be locked.
+  void Trim(Shard* shard, size_t shard_budget);
+
+  std::unique_ptr<Shard[]> shards_;
+  std::atomic<size_t> budget_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> index_hits_{0};
+  // Accessed with std::atomic_load/std::atomic_store.
+  std::shared_ptr<MetadataIndex> index_;
+};
+
+// The key MetadataCache files |path| and |request| under: the normalized path,
+// a NUL, then the selected fields.
+std::string MetadataCacheKey(const std::string& path,
+                             const MetadataRequest& request);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_METADATA_CACHE_H_
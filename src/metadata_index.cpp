@@ -0,0 +1,594 @@
+#include "metadata_index.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "byte_view.h"
+#include "file_io.h"
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr char kTableMagic[8] = {'F', 'B', 'I', 'N', 'I', 'D', 'X', '\0'};
+constexpr char kLogMagic[8] = {'F', 'B', 'I', 'N', 'L', 'O', 'G', '\0'};
+
+// Table: magic, version, bucket count, entry count, reserved; then the
+// buckets, then the records they point at.
+constexpr size_t kTableHeaderSize = 32;
+// Bucket: key hash, file offset of the record (0 if empty).
+constexpr size_t kBucketSize = 16;
+// Log: magic, version, reserved; then records.
+constexpr size_t kLogHeaderSize = 16;
+// Record: payload size, CRC-32 of the payload, payload.
+constexpr size_t kRecordHeaderSize = 8;
+
+// The log is folded into the table once it holds this many entries, or a
+// quarter of the table, whichever is more.
+constexpr size_t kMinCompactionEntries = 256;
+
+uint64_t HashKey(const char* data, size_t size) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+uint32_t Crc32(const uint8_t* data, size_t size) {
+  static const auto* table = [] {
+    auto* crcs = new uint32_t[256];
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320u : 0u);
+      }
+      crcs[i] = crc;
+    }
+    return crcs;
+  }();
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+void PutLe32(uint32_t value, std::string* out) {
+  for (int i = 0; i < 4; ++i) {
+    out->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+void PutLe64(uint64_t value, std::string* out) {
+  PutLe32(static_cast<uint32_t>(value), out);
+  PutLe32(static_cast<uint32_t>(value >> 32), out);
+}
+
+void PutString(const std::string& value, std::string* out) {
+  PutLe32(static_cast<uint32_t>(value.size()), out);
+  out->append(value);
+}
+
+// Appends one checksummed record to |out|.
+void EncodeRecord(const std::string& key, const FileStamp& stamp,
+                  const BinaryMetadata& metadata, std::string* out) {
+  std::string payload;
+  PutString(key, &payload);
+  PutLe64(stamp.size, &payload);
+  PutLe64(stamp.modified, &payload);
+  PutLe64(stamp.volume, &payload);
+  PutLe64(stamp.file_id, &payload);
+  PutLe32(static_cast<uint32_t>(metadata.error), &payload);
+  PutLe32(static_cast<uint32_t>(metadata.fields.size()), &payload);
+  for (const auto& field : metadata.fields) {
+    PutString(field.first, &payload);
+    PutString(field.second, &payload);
+  }
+  PutLe32(static_cast<uint32_t>(payload.size()), out);
+  PutLe32(Crc32(reinterpret_cast<const uint8_t*>(payload.data()),
+                payload.size()),
+          out);
+  out->append(payload);
+}
+
+// Returns the checksummed payload of the record at |offset| in |data|, and
+// where the next record starts. Fails on truncated or corrupt records.
+bool ReadRecord(ByteView data, size_t offset, ByteView* payload,
+                size_t* next) {
+  if (!data.Contains(offset, kRecordHeaderSize)) {
+    return false;
+  }
+  uint32_t size = LoadLe32(data.data + offset);
+  uint32_t crc = LoadLe32(data.data + offset + 4);
+  ByteView body = data.Sub(offset + kRecordHeaderSize, size);
+  if (body.size != size || Crc32(body.data, body.size) != crc) {
+    return false;
+  }
+  *payload = body;
+  *next = offset + kRecordHeaderSize + size;
+  return true;
+}
+
+// Sequential reader over a record payload.
+class PayloadReader {
+ public:
+  explicit PayloadReader(ByteView payload) : payload_(payload) {}
+
+  bool ReadLe32(uint32_t* value) {
+    if (!payload_.Contains(offset_, 4)) {
+      return false;
+    }
+    *value = LoadLe32(payload_.data + offset_);
+    offset_ += 4;
+    return true;
+  }
+
+  bool ReadLe64(uint64_t* value) {
+    if (!payload_.Contains(offset_, 8)) {
+      return false;
+    }
+    *value = LoadLe64(payload_.data + offset_);
+    offset_ += 8;
+    return true;
+  }
+
+  bool ReadBytes(ByteView* bytes) {
+    uint32_t size = 0;
+    if (!ReadLe32(&size) || !payload_.Contains(offset_, size)) {
+      return false;
+    }
+    *bytes = payload_.Sub(offset_, size);
+    offset_ += size;
+    return true;
+  }
+
+  bool ReadString(std::string* value) {
+    ByteView bytes;
+    if (!ReadBytes(&bytes)) {
+      return false;
+    }
+    value->assign(reinterpret_cast<const char*>(bytes.data), bytes.size);
+    return true;
+  }
+
+ private:
+  ByteView payload_;
+  size_t offset_ = 0;
+};
+
+bool ReadStamp(PayloadReader* reader, FileStamp* stamp) {
+  return reader->ReadLe64(&stamp->size) && reader->ReadLe64(&stamp->modified) &&
+         reader->ReadLe64(&stamp->volume) && reader->ReadLe64(&stamp->file_id);
+}
+
+bool ReadMetadata(PayloadReader* reader, BinaryMetadata* metadata) {
+  uint32_t error = 0;
+  uint32_t field_count = 0;
+  if (!reader->ReadLe32(&error) ||
+      error > static_cast<uint32_t>(MetadataError::kReadFailed) ||
+      !reader->ReadLe32(&field_count)) {
+    return false;
+  }
+  metadata->error = static_cast<MetadataError>(error);
+  metadata->fields.clear();
+  for (uint32_t i = 0; i < field_count; ++i) {
+    std::string name;
+    std::string value;
+    if (!reader->ReadString(&name) || !reader->ReadString(&value)) {
+      return false;
+    }
+    metadata->fields.emplace(std::move(name), std::move(value));
+  }
+  return true;
+}
+
+bool HasHeader(ByteView data, const char (&magic)[8], size_t header_size) {
+  return data.Contains(0, header_size) &&
+         std::memcmp(data.data, magic, sizeof(magic)) == 0 &&
+         LoadLe32(data.data + 8) == MetadataIndex::kFormatVersion;
+}
+
+void PutHeader(const char (&magic)[8], std::string* out) {
+  out->append(magic, sizeof(magic));
+  PutLe32(MetadataIndex::kFormatVersion, out);
+}
+
+// Writes |contents| to |path| and syncs it to the disk.
+bool WriteSyncedFile(const std::string& path, const std::string& contents) {
+  std::FILE* file = OpenFile(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool written =
+      std::fwrite(contents.data(), 1, contents.size(), file) ==
+          contents.size() &&
+      SyncFile(file);
+  written = std::fclose(file) == 0 && written;
+  if (!written) {
+    RemoveFile(path);
+  }
+  return written;
+}
+
+// Writes |contents| to |path| through a temporary file, so that a crash
+// leaves either the old or the new file in place.
+bool WriteFileAtomically(const std::string& path, const std::string& contents) {
+  std::string temp_path = path + ".tmp";
+  if (!WriteSyncedFile(temp_path, contents)) {
+    return false;
+  }
+  if (!ReplaceFile(temp_path, path)) {
+    RemoveFile(temp_path);
+    return false;
+  }
+  return true;
+}
+
+// The file a key was built from; see MetadataCache.
+std::string PathOfKey(const std::string& key) {
+  return key.substr(0, key.find('\0'));
+}
+
+}  // namespace
+
+MetadataIndex::~MetadataIndex() { Close(); }
+
+bool MetadataIndex::Open(const std::string& utf8_base_path, ThreadPool* pool) {
+  Close();
+  table_path_ = utf8_base_path + ".idx";
+  log_path_ = utf8_base_path + ".log";
+  {
+    std::lock_guard<std::mutex> lock(compaction_mutex_);
+    pool_ = pool;
+  }
+
+  {
+    std::unique_lock<std::shared_mutex> lock(table_mutex_);
+    LoadTable();
+  }
+  std::lock_guard<std::mutex> lock(log_mutex_);
+  // A torn tail or a log from another format version is rewritten from what
+  // could be read, so new records never follow garbage.
+  return LoadLog() || RewriteLog();
+}
+
+void MetadataIndex::Close() {
+  {
+    // Nothing new is scheduled once the pool is gone.
+    std::lock_guard<std::mutex> lock(compaction_mutex_);
+    pool_ = nullptr;
+  }
+  WaitForCompaction();
+  std::lock_guard<std::mutex> maintenance(maintenance_mutex_);
+  std::unique_lock<std::shared_mutex> table_lock(table_mutex_);
+  std::lock_guard<std::mutex> log_lock(log_mutex_);
+  table_.Close();
+  bucket_count_ = 0;
+  table_entries_ = 0;
+  if (log_file_ != nullptr) {
+    std::fclose(log_file_);
+    log_file_ = nullptr;
+  }
+  log_.clear();
+}
+
+bool MetadataIndex::is_open() const {
+  std::lock_guard<std::mutex> lock(log_mutex_);
+  return log_file_ != nullptr;
+}
+
+void MetadataIndex::LoadTable() {
+  table_.Close();
+  bucket_count_ = 0;
+  table_entries_ = 0;
+  if (!table_.Open(table_path_)) {
+    return;
+  }
+  ByteView data = table_.view();
+  if (!HasHeader(data, kTableMagic, kTableHeaderSize)) {
+    table_.Close();
+    return;
+  }
+  uint32_t bucket_count = LoadLe32(data.data + 12);
+  bool power_of_two = bucket_count != 0 && (bucket_count & (bucket_count - 1)) == 0;
+  if (!power_of_two ||
+      !data.Contains(kTableHeaderSize,
+                     static_cast<size_t>(bucket_count) * kBucketSize)) {
+    table_.Close();
+    return;
+  }
+  bucket_count_ = bucket_count;
+  table_entries_ = LoadLe64(data.data + 16);
+}
+
+bool MetadataIndex::LoadLog() {
+  log_.clear();
+  next_sequence_ = 0;
+  MappedFile file;
+  if (!file.Open(log_path_)) {
+    return false;
+  }
+  ByteView data = file.view();
+  if (!HasHeader(data, kLogMagic, kLogHeaderSize)) {
+    return false;
+  }
+  size_t offset = kLogHeaderSize;
+  while (offset < data.size) {
+    ByteView payload;
+    size_t next = 0;
+    if (!ReadRecord(data, offset, &payload, &next)) {
+      return false;
+    }
+    PayloadReader reader(payload);
+    std::string key;
+    LogEntry entry;
+    if (!reader.ReadString(&key) || !ReadStamp(&reader, &entry.stamp) ||
+        !ReadMetadata(&reader, &entry.metadata)) {
+      return false;
+    }
+    entry.sequence = next_sequence_++;
+    log_[std::move(key)] = std::move(entry);
+    offset = next;
+  }
+  // Reopen for appending; the mapping is released when |file| goes away.
+  log_file_ = OpenFile(log_path_, "ab");
+  return log_file_ != nullptr;
+}
+
+bool MetadataIndex::RewriteLog() {
+  if (log_file_ != nullptr) {
+    std::fclose(log_file_);
+    log_file_ = nullptr;
+  }
+  std::string contents;
+  PutHeader(kLogMagic, &contents);
+  PutLe32(0, &contents);
+  for (const auto& entry : log_) {
+    EncodeRecord(entry.first, entry.second.stamp, entry.second.metadata,
+                 &contents);
+  }
+  bool written = WriteFileAtomically(log_path_, contents);
+  log_file_ = OpenFile(log_path_, "ab");
+  return written && log_file_ != nullptr;
+}
+
+bool MetadataIndex::Lookup(const std::string& key, const FileStamp& stamp,
+                           BinaryMetadata* metadata) const {
+  {
+    std::lock_guard<std::mutex> lock(log_mutex_);
+    auto it = log_.find(key);
+    if (it != log_.end()) {
+      // Anything in the table for this key is older still.
+      if (it->second.stamp != stamp) {
+        return false;
+      }
+      *metadata = it->second.metadata;
+      return true;
+    }
+  }
+
+  std::shared_lock<std::shared_mutex> lock(table_mutex_);
+  if (bucket_count_ == 0) {
+    return false;
+  }
+  ByteView data = table_.view();
+  uint64_t hash = HashKey(key.data(), key.size());
+  uint32_t mask = bucket_count_ - 1;
+  for (uint32_t probe = 0, i = static_cast<uint32_t>(hash) & mask;
+       probe < bucket_count_; ++probe, i = (i + 1) & mask) {
+    const uint8_t* bucket = data.data + kTableHeaderSize + i * kBucketSize;
+    uint64_t offset = LoadLe64(bucket + 8);
+    if (offset == 0) {
+      return false;
+    }
+    if (LoadLe64(bucket) != hash) {
+      continue;
+    }
+    ByteView payload;
+    size_t next = 0;
+    if (offset > data.size ||
+        !ReadRecord(data, static_cast<size_t>(offset), &payload, &next)) {
+      continue;
+    }
+    PayloadReader reader(payload);
+    ByteView stored_key;
+    if (!reader.ReadBytes(&stored_key) || stored_key.size != key.size() ||
+        std::memcmp(stored_key.data, key.data(), key.size()) != 0) {
+      continue;
+    }
+    FileStamp stored_stamp;
+    return ReadStamp(&reader, &stored_stamp) && stored_stamp == stamp &&
+           ReadMetadata(&reader, metadata);
+  }
+  return false;
+}
+
+void MetadataIndex::Append(const std::string& key, const FileStamp& stamp,
+                           const BinaryMetadata& metadata) {
+  size_t log_size = 0;
+  {
+    std::lock_guard<std::mutex> lock(log_mutex_);
+    if (log_file_ == nullptr) {
+      return;
+    }
+    std::string record;
+    EncodeRecord(key, stamp, metadata, &record);
+    // No sync per record: a torn tail is detected and dropped on Open().
+    if (std::fwrite(record.data(), 1, record.size(), log_file_) !=
+            record.size() ||
+        std::fflush(log_file_) != 0) {
+      return;
+    }
+    LogEntry& entry = log_[key];
+    entry.stamp = stamp;
+    entry.metadata = metadata;
+    entry.sequence = next_sequence_++;
+    log_size = log_.size();
+  }
+
+  size_t table_entries = 0;
+  {
+    std::shared_lock<std::shared_mutex> lock(table_mutex_);
+    table_entries = static_cast<size_t>(table_entries_);
+  }
+  if (log_size >= kMinCompactionEntries && log_size >= table_entries / 4) {
+    ScheduleCompaction();
+  }
+}
+
+bool MetadataIndex::Compact() {
+  std::lock_guard<std::mutex> maintenance(maintenance_mutex_);
+
+  // Everything logged so far; later appends stay in the log.
+  std::unordered_map<std::string, LogEntry> merged;
+  uint64_t folded_sequence = 0;
+  {
+    std::lock_guard<std::mutex> lock(log_mutex_);
+    if (log_file_ == nullptr) {
+      return false;
+    }
+    merged = log_;
+    folded_sequence = next_sequence_;
+  }
+  {
+    std::shared_lock<std::shared_mutex> lock(table_mutex_);
+    ByteView data = table_.view();
+    for (uint32_t i = 0; i < bucket_count_; ++i) {
+      const uint8_t* bucket = data.data + kTableHeaderSize + i * kBucketSize;
+      uint64_t offset = LoadLe64(bucket + 8);
+      ByteView payload;
+      size_t next = 0;
+      if (offset == 0 || offset > data.size ||
+          !ReadRecord(data, static_cast<size_t>(offset), &payload, &next)) {
+        continue;
+      }
+      PayloadReader reader(payload);
+      std::string key;
+      LogEntry entry;
+      if (reader.ReadString(&key) && merged.find(key) == merged.end() &&
+          ReadStamp(&reader, &entry.stamp) &&
+          ReadMetadata(&reader, &entry.metadata)) {
+        merged.emplace(std::move(key), std::move(entry));
+      }
+    }
+  }
+
+  // Entries for files that have changed or gone can never hit again.
+  for (auto it = merged.begin(); it != merged.end();) {
+    FileStamp stamp;
+    if (!ReadFileStamp(PathOfKey(it->first), &stamp) ||
+        stamp != it->second.stamp) {
+      it = merged.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // Keep the table at most half full so probes stay short.
+  uint32_t bucket_count = 16;
+  while (bucket_count < merged.size() * 2) {
+    bucket_count *= 2;
+  }
+  std::string buckets(static_cast<size_t>(bucket_count) * kBucketSize, '\0');
+  std::string records;
+  size_t records_offset = kTableHeaderSize + buckets.size();
+  for (const auto& entry : merged) {
+    uint64_t hash = HashKey(entry.first.data(), entry.first.size());
+    uint32_t i = static_cast<uint32_t>(hash) & (bucket_count - 1);
+    while (LoadLe64(reinterpret_cast<const uint8_t*>(buckets.data()) +
+                    static_cast<size_t>(i) * kBucketSize + 8) != 0) {
+      i = (i + 1) & (bucket_count - 1);
+    }
+    std::string bucket;
+    PutLe64(hash, &bucket);
+    PutLe64(records_offset + records.size(), &bucket);
+    buckets.replace(static_cast<size_t>(i) * kBucketSize, kBucketSize, bucket);
+    EncodeRecord(entry.first, entry.second.stamp, entry.second.metadata,
+                 &records);
+  }
+  std::string contents;
+  PutHeader(kTableMagic, &contents);
+  PutLe32(bucket_count, &contents);
+  PutLe64(merged.size(), &contents);
+  PutLe64(0, &contents);
+  contents += buckets;
+  contents += records;
+
+  std::string temp_path = table_path_ + ".tmp";
+  if (!WriteSyncedFile(temp_path, contents)) {
+    return false;
+  }
+  std::unique_lock<std::shared_mutex> table_lock(table_mutex_);
+  // The table must not be mapped while it is replaced on Windows.
+  table_.Close();
+  bool replaced = ReplaceFile(temp_path, table_path_);
+  LoadTable();
+  if (!replaced) {
+    RemoveFile(temp_path);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> log_lock(log_mutex_);
+  for (auto it = log_.begin(); it != log_.end();) {
+    if (it->second.sequence < folded_sequence) {
+      it = log_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // If this fails the log still holds everything, which is merely redundant.
+  RewriteLog();
+  return true;
+}
+
+void MetadataIndex::Clear() {
+  std::lock_guard<std::mutex> maintenance(maintenance_mutex_);
+  std::unique_lock<std::shared_mutex> table_lock(table_mutex_);
+  std::lock_guard<std::mutex> log_lock(log_mutex_);
+  table_.Close();
+  bucket_count_ = 0;
+  table_entries_ = 0;
+  RemoveFile(table_path_);
+  if (log_file_ != nullptr) {
+    log_.clear();
+    RewriteLog();
+  }
+}
+
+size_t MetadataIndex::table_entries() const {
+  std::shared_lock<std::shared_mutex> lock(table_mutex_);
+  return static_cast<size_t>(table_entries_);
+}
+
+size_t MetadataIndex::log_entries() const {
+  std::lock_guard<std::mutex> lock(log_mutex_);
+  return log_.size();
+}
+
+void MetadataIndex::ScheduleCompaction() {
+  ThreadPool* pool;
+  {
+    std::lock_guard<std::mutex> lock(compaction_mutex_);
+    if (pool_ == nullptr || compaction_scheduled_) {
+      return;
+    }
+    compaction_scheduled_ = true;
+    pool = pool_;
+  }
+  pool->Post([this] {
+    Compact();
+    std::lock_guard<std::mutex> lock(compaction_mutex_);
+    compaction_scheduled_ = false;
+    compaction_done_.notify_all();
+  });
+}
+
+void MetadataIndex::WaitForCompaction() {
+  std::unique_lock<std::mutex> lock(compaction_mutex_);
+  compaction_done_.wait(lock, [this] { return !compaction_scheduled_; });
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,128 @@
+#ifndef FLUTTER_BIN_METADATA_INDEX_H_
+#define FLUTTER_BIN_METADATA_INDEX_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "binary_metadata.h"
+#include "file_stamp.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+
+// Keeps metadata on disk between runs, keyed like MetadataCache entries (the
+// file's path, a NUL, then the request) and tagged with the FileStamp it was
+// read at.
+//
+// The index is two files:
+//  * <base>.idx, an open-addressing hash table that is memory-mapped and
+//    probed in place. It is only ever replaced whole, by renaming a freshly
+//    written table over it.
+//  * <base>.log, the entries appended since the table was built. It is read
+//    into memory by Open() and takes precedence over the table.
+// Every record carries a CRC-32 that is checked when the record is used, so
+// torn writes and stale formats read as misses, never as wrong metadata.
+// Once the log grows past a fraction of the table it is folded into a new
+// table on the thread pool, dropping entries whose files have changed.
+//
+// One process should own a given index at a time.
+class MetadataIndex {
+ public:
+  // Bumped whenever the file layout changes; older files are discarded.
+  static constexpr uint32_t kFormatVersion = 1;
+
+  MetadataIndex() = default;
+
+  // Waits for a running compaction.
+  ~MetadataIndex();
+
+  // Disallow copy and assign.
+  MetadataIndex(const MetadataIndex&) = delete;
+  MetadataIndex& operator=(const MetadataIndex&) = delete;
+
+  // Opens or creates the index at |utf8_base_path|; its directory must
+  // exist. Compactions run on |pool| if it is not null. Returns false if the
+  // log cannot be written. Reads the whole log, so keep it off UI threads.
+  bool Open(const std::string& utf8_base_path, ThreadPool* pool);
+
+  // Waits for a running compaction, which stamps every entry and syncs the
+  // new table, so like Open() this may block for a while.
+  void Close();
+
+  bool is_open() const;
+
+  // Finds the metadata stored for |key|. Misses if it was stored with a
+  // different |stamp|. Safe to call from any thread.
+  bool Lookup(const std::string& key, const FileStamp& stamp,
+              BinaryMetadata* metadata) const;
+
+  // Records |metadata| for |key|, replacing any earlier entry. Safe to call
+  // from any thread.
+  void Append(const std::string& key, const FileStamp& stamp,
+              const BinaryMetadata& metadata);
+
+  // Folds the log into a new table now. Returns false if the table could not
+  // be written; the index stays usable either way.
+  bool Compact();
+
+  // Drops every entry.
+  void Clear();
+
+  size_t table_entries() const;
+  size_t log_entries() const;
+
+ private:
+  struct LogEntry {
+    FileStamp stamp;
+    BinaryMetadata metadata;
+    // Order of appends, so compaction knows which entries it has folded.
+    uint64_t sequence = 0;
+  };
+
+  // Maps the table and checks its header. |table_mutex_| must be held
+  // exclusively.
+  void LoadTable();
+
+  // Reads the log into |log_|. Returns false if it ended in a torn record.
+  bool LoadLog();
+
+  // Writes |log_| to a new log file and reopens it for appending.
+  // |log_mutex_| must be held.
+  bool RewriteLog();
+
+  void ScheduleCompaction();
+  void WaitForCompaction();
+
+  std::string table_path_;
+  std::string log_path_;
+
+  // Serializes Compact(), Clear() and Close().
+  std::mutex maintenance_mutex_;
+
+  mutable std::shared_mutex table_mutex_;
+  MappedFile table_;  // Closed if there is no valid table.
+  uint32_t bucket_count_ = 0;
+  uint64_t table_entries_ = 0;
+
+  mutable std::mutex log_mutex_;
+  std::FILE* log_file_ = nullptr;
+  std::unordered_map<std::string, LogEntry> log_;
+  uint64_t next_sequence_ = 0;
+
+  std::mutex compaction_mutex_;
+  std::condition_variable compaction_done_;
+  // Guarded by compaction_mutex_. Compactions are only scheduled while
+  // |pool_| is set.
+  ThreadPool* pool_ = nullptr;
+  bool compaction_scheduled_ = false;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_METADATA_INDEX_H_
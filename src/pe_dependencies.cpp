@@ -0,0 +1,290 @@
+#include "pe_dependencies.h"
+
+#include <charconv>
+#include <cstring>
+#include <new>
+#include <string_view>
+
+namespace flutter_bin {
+
+namespace {
+
+// Bounds on what one image may declare, so a corrupt table cannot make a
+// request walk or allocate without limit.
+constexpr size_t kMaxModules = 4096;
+constexpr size_t kMaxFunctionsPerModule = 0x10000;
+constexpr size_t kMaxExports = 0x10000;
+constexpr size_t kMaxNameLength = 4096;
+
+constexpr size_t kImportDescriptorSize = 20;
+constexpr size_t kDelayImportDescriptorSize = 32;
+constexpr size_t kExportDirectorySize = 40;
+// ImgDelayDescr::grAttrs bit set when the descriptor holds RVAs; older
+// linkers wrote virtual addresses instead.
+constexpr uint32_t kDelayAttributeRva = 1;
+
+// The file bytes from |rva| to the end of the image, or an empty view.
+ByteView TailAtRva(const PeImage& image, uint32_t rva) {
+  size_t offset = 0;
+  if (!image.RvaToOffset(rva, &offset)) {
+    return ByteView();
+  }
+  return image.image().From(offset);
+}
+
+// The NUL-terminated string at |rva|, or an empty view if it is unmapped or
+// unterminated.
+std::string_view StringAtRva(const PeImage& image, uint32_t rva) {
+  ByteView tail = TailAtRva(image, rva);
+  size_t limit = tail.size < kMaxNameLength ? tail.size : kMaxNameLength;
+  const void* end = limit > 0 ? std::memchr(tail.data, 0, limit) : nullptr;
+  if (end == nullptr) {
+    return std::string_view();
+  }
+  return std::string_view(
+      reinterpret_cast<const char*>(tail.data),
+      static_cast<const uint8_t*>(end) - tail.data);
+}
+
+uint32_t InternOrdinal(uint32_t ordinal, StringPool* pool) {
+  char buffer[16] = {'#'};
+  auto result = std::to_chars(buffer + 1, buffer + sizeof(buffer), ordinal);
+  return pool->Intern(std::string_view(buffer, result.ptr - buffer));
+}
+
+// A module's import lookup table: an array of thunks ending in zero.
+class ThunkTable {
+ public:
+  ThunkTable(const PeImage& image, uint32_t rva)
+      : image_(image), thunk_size_(image.is_pe32_plus() ? 8 : 4) {
+    ByteView tail = TailAtRva(image, rva);
+    size_t capacity = tail.size / thunk_size_;
+    if (capacity > kMaxFunctionsPerModule) {
+      capacity = kMaxFunctionsPerModule;
+    }
+    while (count_ < capacity && Thunk(tail, count_) != 0) {
+      ++count_;
+    }
+    thunks_ = tail;
+  }
+
+  size_t count() const { return count_; }
+
+  // Interns the names of the thunks into |ids|, which has room for count()
+  // entries. Returns how many were readable.
+  size_t Intern(StringPool* pool, uint32_t* ids) const {
+    const uint64_t ordinal_flag = thunk_size_ == 8 ? uint64_t{1} << 63
+                                                   : uint64_t{1} << 31;
+    size_t written = 0;
+    for (size_t i = 0; i < count_; ++i) {
+      uint64_t thunk = Thunk(thunks_, i);
+      uint32_t id = StringPool::kNoString;
+      if (thunk & ordinal_flag) {
+        id = InternOrdinal(static_cast<uint16_t>(thunk), pool);
+      } else {
+        // IMAGE_IMPORT_BY_NAME: a 16-bit hint, then the name.
+        std::string_view name =
+            StringAtRva(image_, static_cast<uint32_t>(thunk) + 2);
+        if (!name.empty()) {
+          id = pool->Intern(name);
+        }
+      }
+      if (id != StringPool::kNoString) {
+        ids[written++] = id;
+      }
+    }
+    return written;
+  }
+
+ private:
+  uint64_t Thunk(ByteView table, size_t index) const {
+    const uint8_t* p = table.data + index * thunk_size_;
+    return thunk_size_ == 8 ? LoadLe64(p) : LoadLe32(p);
+  }
+
+  const PeImage& image_;
+  size_t thunk_size_;
+  ByteView thunks_;
+  size_t count_ = 0;
+};
+
+// Where one module's name and lookup table live, from either kind of
+// import descriptor.
+struct ModuleEntry {
+  uint32_t name_rva;
+  uint32_t lookup_rva;
+  bool delay_loaded;
+};
+
+// Calls |visit| for every usable descriptor of both import directories, up
+// to kMaxModules in total.
+template <typename Visit>
+void ForEachImportDescriptor(const PeImage& image, Visit visit) {
+  size_t visited = 0;
+  uint32_t rva = 0;
+  uint32_t size = 0;
+  if (image.GetDataDirectory(kPeDirectoryImport, &rva, &size)) {
+    ByteView table = TailAtRva(image, rva);
+    for (size_t offset = 0; visited < kMaxModules &&
+                            table.Contains(offset, kImportDescriptorSize);
+         offset += kImportDescriptorSize) {
+      const uint8_t* descriptor = table.data + offset;
+      uint32_t lookup_rva = LoadLe32(descriptor);       // OriginalFirstThunk
+      uint32_t name_rva = LoadLe32(descriptor + 12);
+      uint32_t address_rva = LoadLe32(descriptor + 16);  // FirstThunk
+      if (name_rva == 0 || address_rva == 0) {
+        break;
+      }
+      // Without a lookup table the unbound address table holds the names.
+      visit(ModuleEntry{name_rva, lookup_rva != 0 ? lookup_rva : address_rva,
+                        false});
+      ++visited;
+    }
+  }
+  if (image.GetDataDirectory(kPeDirectoryDelayImport, &rva, &size)) {
+    ByteView table = TailAtRva(image, rva);
+    for (size_t offset = 0; visited < kMaxModules &&
+                            table.Contains(offset, kDelayImportDescriptorSize);
+         offset += kDelayImportDescriptorSize) {
+      const uint8_t* descriptor = table.data + offset;
+      uint32_t name_rva = LoadLe32(descriptor + 4);
+      if (name_rva == 0) {
+        break;
+      }
+      if (LoadLe32(descriptor) & kDelayAttributeRva) {
+        visit(ModuleEntry{name_rva, LoadLe32(descriptor + 16), true});
+        ++visited;
+      }
+    }
+  }
+}
+
+void ReadImports(const PeImage& image, StringPool* pool, Arena* arena,
+                 PeDependencies* dependencies) {
+  size_t count = 0;
+  ForEachImportDescriptor(image, [&count](const ModuleEntry&) { ++count; });
+  PeImportedModule* modules = arena->AllocateArray<PeImportedModule>(count);
+  if (modules == nullptr) {
+    return;
+  }
+
+  size_t written = 0;
+  ForEachImportDescriptor(image, [&](const ModuleEntry& entry) {
+    std::string_view name = StringAtRva(image, entry.name_rva);
+    uint32_t name_id =
+        name.empty() ? StringPool::kNoString : pool->Intern(name);
+    if (name_id == StringPool::kNoString) {
+      return;
+    }
+    PeImportedModule* module = new (&modules[written++]) PeImportedModule();
+    module->name = name_id;
+    module->delay_loaded = entry.delay_loaded;
+    ThunkTable thunks(image, entry.lookup_rva);
+    uint32_t* functions = arena->AllocateArray<uint32_t>(thunks.count());
+    if (functions != nullptr) {
+      module->functions.data = functions;
+      module->functions.size = thunks.Intern(pool, functions);
+    }
+  });
+  dependencies->imports.data = modules;
+  dependencies->imports.size = written;
+}
+
+void ReadExports(const PeImage& image, StringPool* pool, Arena* arena,
+                 PeDependencies* dependencies) {
+  uint32_t rva = 0;
+  uint32_t size = 0;
+  if (!image.GetDataDirectory(kPeDirectoryExport, &rva, &size)) {
+    return;
+  }
+  ByteView directory = image.ViewAtRva(rva, kExportDirectorySize);
+  if (directory.empty()) {
+    return;
+  }
+  std::string_view module_name =
+      StringAtRva(image, LoadLe32(directory.data + 12));
+  if (!module_name.empty()) {
+    dependencies->export_name = pool->Intern(module_name);
+  }
+
+  uint32_t base = LoadLe32(directory.data + 16);
+  size_t function_count = LoadLe32(directory.data + 20);
+  size_t name_count = LoadLe32(directory.data + 24);
+  if (function_count > kMaxExports) {
+    function_count = kMaxExports;
+  }
+  if (name_count > kMaxExports) {
+    name_count = kMaxExports;
+  }
+  ByteView functions = image.ViewAtRva(
+      LoadLe32(directory.data + 28), static_cast<uint32_t>(function_count * 4));
+  ByteView names = image.ViewAtRva(LoadLe32(directory.data + 32),
+                                   static_cast<uint32_t>(name_count * 4));
+  ByteView ordinals = image.ViewAtRva(LoadLe32(directory.data + 36),
+                                      static_cast<uint32_t>(name_count * 2));
+  if (functions.empty()) {
+    function_count = 0;
+  }
+  if (names.empty() || ordinals.empty()) {
+    name_count = 0;
+  }
+
+  uint32_t* exports = arena->AllocateArray<uint32_t>(name_count +
+                                                     function_count);
+  uint8_t* named = arena->AllocateArray<uint8_t>(function_count);
+  if (exports == nullptr || named == nullptr) {
+    return;
+  }
+  if (function_count > 0) {
+    std::memset(named, 0, function_count);
+  }
+
+  size_t written = 0;
+  for (size_t i = 0; i < name_count; ++i) {
+    uint16_t index = LoadLe16(ordinals.data + i * 2);
+    if (index < function_count) {
+      named[index] = 1;
+    }
+    std::string_view name = StringAtRva(image, LoadLe32(names.data + i * 4));
+    uint32_t id = name.empty() ? StringPool::kNoString : pool->Intern(name);
+    if (id != StringPool::kNoString) {
+      exports[written++] = id;
+    }
+  }
+  // Unused slots in the address table are zero.
+  for (size_t i = 0; i < function_count; ++i) {
+    if (!named[i] && LoadLe32(functions.data + i * 4) != 0) {
+      uint32_t id = InternOrdinal(base + static_cast<uint32_t>(i), pool);
+      if (id != StringPool::kNoString) {
+        exports[written++] = id;
+      }
+    }
+  }
+  dependencies->exports.data = exports;
+  dependencies->exports.size = written;
+}
+
+}  // namespace
+
+void ReadPeDependencies(const PeImage& image, StringPool* pool, Arena* arena,
+                        PeDependencies* dependencies) {
+  *dependencies = PeDependencies();
+  ReadImports(image, pool, arena, dependencies);
+  ReadExports(image, pool, arena, dependencies);
+}
+
+void FlattenImports(const PeDependencies& dependencies, bool delay_loaded,
+                    std::vector<int32_t>* out) {
+  for (const PeImportedModule& module : dependencies.imports) {
+    if (module.delay_loaded != delay_loaded) {
+      continue;
+    }
+    out->push_back(static_cast<int32_t>(module.name));
+    out->push_back(static_cast<int32_t>(module.functions.size));
+    for (uint32_t function : module.functions) {
+      out->push_back(static_cast<int32_t>(function));
+    }
+  }
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,51 @@
+#ifndef FLUTTER_BIN_PE_DEPENDENCIES_H_
+#define FLUTTER_BIN_PE_DEPENDENCIES_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "arena.h"
+#include "pe_image.h"
+#include "string_pool.h"
+
+namespace flutter_bin {
+
+// One DLL an image imports from.
+struct PeImportedModule {
+  // e.g. "KERNEL32.dll", as spelled in the image.
+  uint32_t name = StringPool::kNoString;
+  // Imported function names in thunk order; imports by ordinal are named
+  // "#<ordinal>", e.g. "#17".
+  ArenaSpan<uint32_t> functions;
+  // Listed in the delay-load directory rather than the import directory.
+  bool delay_loaded = false;
+};
+
+// The imports and exports of a PE image as ids into a StringPool, so that
+// memory grows with the number of distinct names rather than references.
+struct PeDependencies {
+  // Import directory modules in table order, then delay-loaded ones.
+  ArenaSpan<PeImportedModule> imports;
+  // The DLL name recorded in the export directory, or kNoString.
+  uint32_t export_name = StringPool::kNoString;
+  // Exported names in export name table order (sorted by the linker), then
+  // "#<ordinal>" for functions exported by ordinal only.
+  ArenaSpan<uint32_t> exports;
+};
+
+// Walks the import, delay-load import and export directories of |image|,
+// interning every name into |pool| and allocating the lists from |arena|.
+// Tables that point outside the file are skipped or cut short; nothing
+// here fails outright.
+void ReadPeDependencies(const PeImage& image, StringPool* pool, Arena* arena,
+                        PeDependencies* dependencies);
+
+// Appends the modules of |dependencies| whose delay_loaded flag matches
+// |delay_loaded| to |out| as [name, function count, function ids...] runs,
+// the form the plugins send to Dart.
+void FlattenImports(const PeDependencies& dependencies, bool delay_loaded,
+                    std::vector<int32_t>* out);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_PE_DEPENDENCIES_H_
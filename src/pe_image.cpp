@@ -0,0 +1,278 @@
+#include "pe_image.h"
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr uint16_t kDosSignature = 0x5A4D;        // "MZ"
+constexpr uint32_t kNtSignature = 0x00004550;     // "PE\0\0"
+constexpr uint16_t kPe32Magic = 0x10B;
+constexpr uint16_t kPe32PlusMagic = 0x20B;
+constexpr size_t kFileHeaderSize = 20;
+constexpr size_t kSectionHeaderSize = 40;
+constexpr size_t kMaxSections = 96;
+
+constexpr size_t kResourceDirectorySize = 16;
+constexpr size_t kResourceEntrySize = 8;
+constexpr uint32_t kResourceSubdirectoryFlag = 0x80000000u;
+
+constexpr uint32_t kLangNeutral = 0x0000;
+constexpr uint32_t kLangEnglishUs = 0x0409;
+
+// One IMAGE_RESOURCE_DIRECTORY_ENTRY.
+struct ResourceEntry {
+  uint32_t name = 0;
+  uint32_t offset = 0;
+  bool is_named() const { return (name & kResourceSubdirectoryFlag) != 0; }
+  bool is_directory() const {
+    return (offset & kResourceSubdirectoryFlag) != 0;
+  }
+  uint32_t target() const { return offset & ~kResourceSubdirectoryFlag; }
+};
+
+// Where the resource tree starts in the file and how to read it. Offsets
+// inside the tree are relative to its start.
+struct ResourceTree {
+  const PeImage::ByteSource& read;
+  size_t base;
+
+  ByteView Read(uint32_t offset, size_t length) const {
+    if (offset > SIZE_MAX - base) {
+      return ByteView();
+    }
+    ByteView bytes = read(base + offset, length);
+    return bytes.size == length ? bytes : ByteView();
+  }
+};
+
+// Returns the entries of the directory at |offset| in |tree|, or an empty
+// view if the directory is malformed.
+ByteView ReadDirectory(const ResourceTree& tree, uint32_t offset) {
+  ByteView dir = tree.Read(offset, kResourceDirectorySize);
+  if (dir.empty()) {
+    return ByteView();
+  }
+  size_t count = static_cast<size_t>(LoadLe16(dir.data + 12)) +
+                 LoadLe16(dir.data + 14);
+  if (count == 0 || offset > UINT32_MAX - kResourceDirectorySize) {
+    return ByteView();
+  }
+  return tree.Read(offset + static_cast<uint32_t>(kResourceDirectorySize),
+                   count * kResourceEntrySize);
+}
+
+ResourceEntry ReadEntry(ByteView entries, size_t index) {
+  const uint8_t* entry = entries.data + index * kResourceEntrySize;
+  ResourceEntry result;
+  result.name = LoadLe32(entry);
+  result.offset = LoadLe32(entry + 4);
+  return result;
+}
+
+// Finds the entry with integer id |id| in the directory at |offset|.
+bool FindEntryById(const ResourceTree& tree, uint32_t offset, uint32_t id,
+                   ResourceEntry* out) {
+  ByteView entries = ReadDirectory(tree, offset);
+  size_t count = entries.size / kResourceEntrySize;
+  for (size_t i = 0; i < count; ++i) {
+    ResourceEntry entry = ReadEntry(entries, i);
+    if (!entry.is_named() && entry.name == id) {
+      *out = entry;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the first entry of the directory at |offset|.
+bool FirstEntry(const ResourceTree& tree, uint32_t offset,
+                ResourceEntry* out) {
+  ByteView entries = ReadDirectory(tree, offset);
+  if (entries.empty()) {
+    return false;
+  }
+  *out = ReadEntry(entries, 0);
+  return true;
+}
+
+}  // namespace
+
+bool PeImage::Parse(ByteView image) {
+  *this = PeImage();
+
+  if (!image.Contains(0, 0x40) || LoadLe16(image.data) != kDosSignature) {
+    return false;
+  }
+  size_t nt_offset = LoadLe32(image.data + 0x3C);
+  if (!image.Contains(nt_offset, 4 + kFileHeaderSize) ||
+      LoadLe32(image.data + nt_offset) != kNtSignature) {
+    return false;
+  }
+
+  const uint8_t* file_header = image.data + nt_offset + 4;
+  uint16_t machine = LoadLe16(file_header);
+  size_t section_count = LoadLe16(file_header + 2);
+  size_t optional_header_size = LoadLe16(file_header + 16);
+  size_t optional_header_offset = nt_offset + 4 + kFileHeaderSize;
+  if (section_count > kMaxSections ||
+      !image.Contains(optional_header_offset, optional_header_size) ||
+      optional_header_size < 2) {
+    return false;
+  }
+
+  const uint8_t* optional_header = image.data + optional_header_offset;
+  uint16_t magic = LoadLe16(optional_header);
+  size_t directory_count_offset = 0;
+  if (magic == kPe32Magic) {
+    directory_count_offset = 92;
+  } else if (magic == kPe32PlusMagic) {
+    directory_count_offset = 108;
+  } else {
+    return false;
+  }
+  if (optional_header_size < directory_count_offset + 4) {
+    return false;
+  }
+
+  // Only trust as many directories as the optional header really holds.
+  uint32_t directory_count = LoadLe32(optional_header + directory_count_offset);
+  size_t directory_capacity =
+      (optional_header_size - directory_count_offset - 4) / 8;
+  if (directory_count > directory_capacity) {
+    directory_count = static_cast<uint32_t>(directory_capacity);
+  }
+
+  size_t section_table_offset = optional_header_offset + optional_header_size;
+  if (!image.Contains(section_table_offset,
+                      section_count * kSectionHeaderSize)) {
+    return false;
+  }
+
+  image_ = image;
+  pe32_plus_ = magic == kPe32PlusMagic;
+  machine_ = machine;
+  size_of_headers_ = LoadLe32(optional_header + 60);
+  data_directory_count_ = directory_count;
+  optional_header_offset_ = optional_header_offset;
+  data_directory_offset_ = optional_header_offset + directory_count_offset + 4;
+  section_table_offset_ = section_table_offset;
+  section_count_ = section_count;
+  return true;
+}
+
+PeSection PeImage::section(size_t index) const {
+  PeSection result;
+  if (index >= section_count_) {
+    return result;
+  }
+  const uint8_t* header =
+      image_.data + section_table_offset_ + index * kSectionHeaderSize;
+  result.virtual_size = LoadLe32(header + 8);
+  result.virtual_address = LoadLe32(header + 12);
+  result.raw_size = LoadLe32(header + 16);
+  result.raw_offset = LoadLe32(header + 20);
+  return result;
+}
+
+bool PeImage::GetDataDirectory(uint32_t index, uint32_t* rva,
+                               uint32_t* size) const {
+  if (index >= data_directory_count_) {
+    return false;
+  }
+  const uint8_t* entry = image_.data + data_directory_offset(index);
+  *rva = LoadLe32(entry);
+  *size = LoadLe32(entry + 4);
+  return *rva != 0 && *size != 0;
+}
+
+bool PeImage::RvaToOffset(uint32_t rva, size_t* offset) const {
+  if (rva < size_of_headers_) {
+    *offset = rva;
+    return true;
+  }
+  for (size_t i = 0; i < section_count_; ++i) {
+    PeSection s = section(i);
+    uint32_t extent = s.virtual_size > s.raw_size ? s.virtual_size : s.raw_size;
+    if (rva < s.virtual_address || rva - s.virtual_address >= extent) {
+      continue;
+    }
+    uint32_t delta = rva - s.virtual_address;
+    if (delta >= s.raw_size) {
+      return false;
+    }
+    // The loader rounds raw offsets down to the 512-byte sector size.
+    *offset = static_cast<size_t>(s.raw_offset & ~0x1FFu) + delta;
+    return true;
+  }
+  return false;
+}
+
+ByteView PeImage::ViewAtRva(uint32_t rva, uint32_t size) const {
+  size_t offset = 0;
+  if (!RvaToOffset(rva, &offset)) {
+    return ByteView();
+  }
+  return image_.Sub(offset, size);
+}
+
+ByteView PeImage::FindVersionResource() const {
+  size_t offset = 0;
+  uint32_t size = 0;
+  ByteSource read = [this](size_t at, size_t length) {
+    // Clamp to the file rather than trusting the declared directory size.
+    return image_.Sub(at, length);
+  };
+  if (!LocateVersionResource(read, &offset, &size)) {
+    return ByteView();
+  }
+  return image_.Sub(offset, size);
+}
+
+bool PeImage::LocateVersionResource(const ByteSource& read, size_t* offset,
+                                    uint32_t* size) const {
+  uint32_t rsrc_rva = 0;
+  uint32_t rsrc_size = 0;
+  if (!GetDataDirectory(kPeDirectoryResource, &rsrc_rva, &rsrc_size)) {
+    return false;
+  }
+  size_t rsrc_offset = 0;
+  if (!RvaToOffset(rsrc_rva, &rsrc_offset)) {
+    return false;
+  }
+  ResourceTree tree{read, rsrc_offset};
+
+  // Level 1: resource type.
+  ResourceEntry type_entry;
+  if (!FindEntryById(tree, 0, kPeResourceTypeVersion, &type_entry) ||
+      !type_entry.is_directory()) {
+    return false;
+  }
+
+  // Level 2: resource name. Images carry a single VS_VERSION_INFO (id 1).
+  ResourceEntry name_entry;
+  if (!FirstEntry(tree, type_entry.target(), &name_entry) ||
+      !name_entry.is_directory()) {
+    return false;
+  }
+
+  // Level 3: language.
+  ResourceEntry lang_entry;
+  if (!FindEntryById(tree, name_entry.target(), kLangNeutral, &lang_entry) &&
+      !FindEntryById(tree, name_entry.target(), kLangEnglishUs, &lang_entry) &&
+      !FirstEntry(tree, name_entry.target(), &lang_entry)) {
+    return false;
+  }
+  if (lang_entry.is_directory()) {
+    return false;
+  }
+  ByteView data_entry = tree.Read(lang_entry.target(), 16);
+  if (data_entry.empty()) {
+    return false;
+  }
+
+  // IMAGE_RESOURCE_DATA_ENTRY holds an RVA, not a tree-relative offset.
+  *size = LoadLe32(data_entry.data + 4);
+  return RvaToOffset(LoadLe32(data_entry.data), offset);
+}
+
+}  // namespace flutter_bin
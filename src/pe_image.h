@@ -0,0 +1,100 @@
+#ifndef FLUTTER_BIN_PE_IMAGE_H_
+#define FLUTTER_BIN_PE_IMAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+// Indices into the optional header data directory table.
+enum PeDataDirectory : uint32_t {
+  kPeDirectoryExport = 0,
+  kPeDirectoryImport = 1,
+  kPeDirectoryResource = 2,
+  kPeDirectorySecurity = 4,
+  kPeDirectoryDelayImport = 13,
+};
+
+// Resource type id of VS_VERSIONINFO resources (RT_VERSION).
+constexpr uint32_t kPeResourceTypeVersion = 16;
+
+// Decoded copy of one IMAGE_SECTION_HEADER.
+struct PeSection {
+  uint32_t virtual_address = 0;
+  uint32_t virtual_size = 0;
+  uint32_t raw_offset = 0;
+  uint32_t raw_size = 0;
+};
+
+// Reader for the on-disk layout of a PE/COFF image.
+//
+// Parses the DOS and NT headers of an image held in memory (normally a
+// MappedFile) without copying it and without any dependency on the Win32
+// loader, so it behaves identically on every host. All returned views point
+// into the buffer passed to Parse(), which must outlive this object.
+class PeImage {
+ public:
+  // Returns the |length| bytes at file offset |offset|; a shorter view means
+  // they are not all there.
+  using ByteSource = std::function<ByteView(size_t offset, size_t length)>;
+
+  PeImage() = default;
+
+  // Validates the headers of |image|. Returns false if it is not a PE image.
+  bool Parse(ByteView image);
+
+  ByteView image() const { return image_; }
+  bool is_pe32_plus() const { return pe32_plus_; }
+  uint16_t machine() const { return machine_; }
+  uint32_t size_of_headers() const { return size_of_headers_; }
+
+  // File offsets of the optional header fields that Authenticode excludes.
+  size_t checksum_offset() const { return optional_header_offset_ + 64; }
+  size_t data_directory_offset(uint32_t index) const {
+    return data_directory_offset_ + static_cast<size_t>(index) * 8;
+  }
+
+  uint32_t data_directory_count() const { return data_directory_count_; }
+  size_t section_count() const { return section_count_; }
+  PeSection section(size_t index) const;
+
+  // Reads data directory |index|. Returns false if it is absent or empty.
+  bool GetDataDirectory(uint32_t index, uint32_t* rva, uint32_t* size) const;
+
+  // Translates |rva| into a file offset. Returns false when the address is
+  // not backed by file data (e.g. it lies in uninitialized data).
+  bool RvaToOffset(uint32_t rva, size_t* offset) const;
+
+  // Returns the file bytes backing [rva, rva + size), or an empty view.
+  ByteView ViewAtRva(uint32_t rva, uint32_t size) const;
+
+  // Walks the resource directory straight to the RT_VERSION leaf and returns
+  // the raw VS_VERSIONINFO blob, or an empty view if there is none. When
+  // several languages exist the neutral and en-US entries are preferred,
+  // mirroring the loader's lookup order.
+  ByteView FindVersionResource() const;
+
+  // The same walk for an image whose Parse() view held only the headers:
+  // the resource directory is read through |read|, and the file offset and
+  // size of the VS_VERSIONINFO blob are stored instead of a view of it.
+  bool LocateVersionResource(const ByteSource& read, size_t* offset,
+                             uint32_t* size) const;
+
+ private:
+  ByteView image_;
+  bool pe32_plus_ = false;
+  uint16_t machine_ = 0;
+  uint32_t size_of_headers_ = 0;
+  uint32_t data_directory_count_ = 0;
+  size_t optional_header_offset_ = 0;
+  size_t data_directory_offset_ = 0;
+  size_t section_table_offset_ = 0;
+  size_t section_count_ = 0;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_PE_IMAGE_H_
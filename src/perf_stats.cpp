@@ -0,0 +1,353 @@
+#include "perf_stats.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace flutter_bin {
+
+namespace internal {
+std::atomic<bool> perf_stats_enabled{false};
+}  // namespace internal
+
+namespace {
+
+// Log-linear buckets: exact below 8 ns, then 8 per power of two, up to
+// 2^40 ns (18 minutes).
+constexpr int kSubBucketBits = 3;
+constexpr uint64_t kSubBuckets = 1 << kSubBucketBits;
+constexpr int kMaxBit = 39;
+constexpr size_t kBucketCount = kSubBuckets * (kMaxBit - kSubBucketBits + 2);
+
+int HighestBit(uint64_t value) {
+  int bit = 0;
+  for (int shift = 32; shift > 0; shift /= 2) {
+    if (value >> shift) {
+      value >>= shift;
+      bit += shift;
+    }
+  }
+  return bit;
+}
+
+size_t BucketOf(uint64_t ns) {
+  if (ns < kSubBuckets) {
+    return static_cast<size_t>(ns);
+  }
+  ns = std::min<uint64_t>(ns, (uint64_t{1} << (kMaxBit + 1)) - 1);
+  int bit = HighestBit(ns);
+  uint64_t sub = (ns >> (bit - kSubBucketBits)) & (kSubBuckets - 1);
+  return static_cast<size_t>(kSubBuckets * (bit - kSubBucketBits + 1) + sub);
+}
+
+// The largest value that falls in |bucket|.
+uint64_t BucketLimit(size_t bucket) {
+  if (bucket < kSubBuckets) {
+    return bucket;
+  }
+  int shift = static_cast<int>(bucket / kSubBuckets) - 1;
+  uint64_t low = (kSubBuckets + bucket % kSubBuckets) << shift;
+  return low + (uint64_t{1} << shift) - 1;
+}
+
+struct PhaseCounters {
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> total_ns{0};
+  std::atomic<uint64_t> buckets[kBucketCount] = {};
+};
+
+// Plain totals, used for the baseline and while merging.
+struct PhaseTotals {
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+  uint64_t buckets[kBucketCount] = {};
+};
+
+struct TraceEvent {
+  PerfPhase phase;
+  int64_t start_ns;
+  int64_t end_ns;
+};
+
+// Everything one thread records. Counters have a single writer, so they
+// are bumped with a load and a store instead of a locked add.
+struct ThreadStats {
+  explicit ThreadStats(uint32_t thread_id) : id(thread_id) {}
+
+  const uint32_t id;
+  std::atomic<bool> in_use{true};
+  PhaseCounters phases[kPerfPhaseCount];
+
+  // Only taken while tracing.
+  std::mutex trace_mutex;
+  std::vector<TraceEvent> trace;
+  size_t trace_next = 0;
+};
+
+void Bump(std::atomic<uint64_t>* counter, uint64_t amount) {
+  counter->store(counter->load(std::memory_order_relaxed) + amount,
+                 std::memory_order_relaxed);
+}
+
+std::atomic<bool> trace_enabled{false};
+
+// Blocks outlive their threads and are handed to the next thread that
+// starts, so nothing recorded is lost and the block count stays at the
+// peak number of threads. Never destroyed, as threads may record during
+// static destruction.
+class Registry {
+ public:
+  static Registry& Get() {
+    static Registry* registry = new Registry();
+    return *registry;
+  }
+
+  ThreadStats* Acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& stats : threads_) {
+      if (!stats->in_use.load(std::memory_order_relaxed)) {
+        stats->in_use.store(true, std::memory_order_relaxed);
+        return stats.get();
+      }
+    }
+    threads_.push_back(
+        std::make_unique<ThreadStats>(static_cast<uint32_t>(threads_.size() + 1)));
+    return threads_.back().get();
+  }
+
+  // Sums every thread's counters minus the baseline into |totals|.
+  void Read(PhaseTotals* totals) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Sum(totals);
+    for (size_t phase = 0; phase < kPerfPhaseCount; ++phase) {
+      totals[phase].count -= baseline_[phase].count;
+      totals[phase].total_ns -= baseline_[phase].total_ns;
+      for (size_t i = 0; i < kBucketCount; ++i) {
+        totals[phase].buckets[i] -= baseline_[phase].buckets[i];
+      }
+    }
+  }
+
+  // Counters only ever grow; a reset moves the baseline up to them.
+  void Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Sum(baseline_);
+    for (const auto& stats : threads_) {
+      std::lock_guard<std::mutex> trace_lock(stats->trace_mutex);
+      stats->trace.clear();
+      stats->trace_next = 0;
+    }
+  }
+
+  // Calls |visit| with each thread's id and retained events, oldest first.
+  template <typename Visit>
+  void ForEachTrace(Visit visit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& stats : threads_) {
+      std::lock_guard<std::mutex> trace_lock(stats->trace_mutex);
+      const std::vector<TraceEvent>& trace = stats->trace;
+      for (size_t i = 0; i < trace.size(); ++i) {
+        visit(stats->id, trace[(stats->trace_next + i) % trace.size()]);
+      }
+    }
+  }
+
+ private:
+  void Sum(PhaseTotals* totals) {
+    for (size_t phase = 0; phase < kPerfPhaseCount; ++phase) {
+      totals[phase] = PhaseTotals();
+      for (const auto& stats : threads_) {
+        const PhaseCounters& counters = stats->phases[phase];
+        totals[phase].count += counters.count.load(std::memory_order_relaxed);
+        totals[phase].total_ns +=
+            counters.total_ns.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < kBucketCount; ++i) {
+          totals[phase].buckets[i] +=
+              counters.buckets[i].load(std::memory_order_relaxed);
+        }
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadStats>> threads_;
+  PhaseTotals baseline_[kPerfPhaseCount];
+};
+
+// Releases the calling thread's block when the thread exits.
+class ThreadSlot {
+ public:
+  ~ThreadSlot() {
+    if (stats_ != nullptr) {
+      stats_->in_use.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  ThreadStats* stats() {
+    if (stats_ == nullptr) {
+      stats_ = Registry::Get().Acquire();
+    }
+    return stats_;
+  }
+
+ private:
+  ThreadStats* stats_ = nullptr;
+};
+
+thread_local ThreadSlot thread_slot;
+
+// The smallest bucket limit at or above the |fraction| quantile.
+uint64_t Quantile(const PhaseTotals& totals, double fraction) {
+  if (totals.count == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(fraction * (totals.count - 1)) + 1;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    seen += totals.buckets[i];
+    if (seen >= rank) {
+      return BucketLimit(i);
+    }
+  }
+  return BucketLimit(kBucketCount - 1);
+}
+
+PhaseStats ToPhaseStats(const PhaseTotals& totals) {
+  PhaseStats stats;
+  stats.count = totals.count;
+  stats.total_ns = totals.total_ns;
+  stats.p50_ns = Quantile(totals, 0.5);
+  stats.p90_ns = Quantile(totals, 0.9);
+  stats.p99_ns = Quantile(totals, 0.99);
+  stats.max_ns = Quantile(totals, 1.0);
+  return stats;
+}
+
+}  // namespace
+
+namespace internal {
+
+void RecordPhase(PerfPhase phase, int64_t start_ns, int64_t end_ns) {
+  ThreadStats* stats = thread_slot.stats();
+  uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(end_ns - start_ns, 0));
+  PhaseCounters& counters = stats->phases[static_cast<size_t>(phase)];
+  Bump(&counters.count, 1);
+  Bump(&counters.total_ns, ns);
+  Bump(&counters.buckets[BucketOf(ns)], 1);
+
+  if (trace_enabled.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(stats->trace_mutex);
+    TraceEvent event{phase, start_ns, end_ns};
+    if (stats->trace.size() < kMaxPerfTraceEvents) {
+      stats->trace.push_back(event);
+    } else {
+      stats->trace[stats->trace_next] = event;
+      stats->trace_next = (stats->trace_next + 1) % kMaxPerfTraceEvents;
+    }
+  }
+}
+
+}  // namespace internal
+
+const char* PerfPhaseName(PerfPhase phase) {
+  switch (phase) {
+    case PerfPhase::kMethodCall:
+      return "methodCall";
+    case PerfPhase::kPathConversion:
+      return "pathConversion";
+    case PerfPhase::kAttributeLookup:
+      return "attributeLookup";
+    case PerfPhase::kFileOpen:
+      return "fileOpen";
+    case PerfPhase::kHeaderParse:
+      return "headerParse";
+    case PerfPhase::kResourceRead:
+      return "resourceRead";
+    case PerfPhase::kStringDecode:
+      return "stringDecode";
+    case PerfPhase::kHash:
+      return "hash";
+    case PerfPhase::kEncode:
+      return "encode";
+  }
+  return "";
+}
+
+struct LatencyHistogram::Counters : PhaseCounters {};
+
+LatencyHistogram::LatencyHistogram() : counters_(new Counters()) {}
+
+LatencyHistogram::~LatencyHistogram() = default;
+
+void LatencyHistogram::Record(uint64_t ns) {
+  // Several threads record into one histogram, unlike the phase counters.
+  counters_->count.fetch_add(1, std::memory_order_relaxed);
+  counters_->total_ns.fetch_add(ns, std::memory_order_relaxed);
+  counters_->buckets[BucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+PhaseStats LatencyHistogram::Read() const {
+  auto totals = std::make_unique<PhaseTotals>();
+  totals->count = counters_->count.load(std::memory_order_relaxed);
+  totals->total_ns = counters_->total_ns.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    totals->buckets[i] =
+        counters_->buckets[i].load(std::memory_order_relaxed);
+  }
+  return ToPhaseStats(*totals);
+}
+
+void LatencyHistogram::Reset() {
+  counters_->count.store(0, std::memory_order_relaxed);
+  counters_->total_ns.store(0, std::memory_order_relaxed);
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    counters_->buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void SetPerfStatsEnabled(bool enabled) {
+  internal::perf_stats_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void SetPerfTraceEnabled(bool enabled) {
+  trace_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+PerfSnapshot ReadPerfStats() {
+  PerfSnapshot snapshot;
+  snapshot.enabled = PerfStatsEnabled();
+  auto totals = std::make_unique<PhaseTotals[]>(kPerfPhaseCount);
+  Registry::Get().Read(totals.get());
+  for (size_t phase = 0; phase < kPerfPhaseCount; ++phase) {
+    snapshot.phases[phase] = ToPhaseStats(totals[phase]);
+  }
+  return snapshot;
+}
+
+void ResetPerfStats() { Registry::Get().Reset(); }
+
+std::string PerfTraceJson() {
+  std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  char event[160];
+  Registry::Get().ForEachTrace([&](uint32_t thread_id, const TraceEvent& trace) {
+    // Complete ("X") events in microseconds, as the format requires.
+    int length = std::snprintf(
+        event, sizeof(event),
+        "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu32
+        ",\"ts\":%" PRId64 ".%03" PRId64 ",\"dur\":%" PRId64 ".%03" PRId64 "}",
+        first ? "" : ",", PerfPhaseName(trace.phase), thread_id,
+        trace.start_ns / 1000, trace.start_ns % 1000,
+        (trace.end_ns - trace.start_ns) / 1000,
+        (trace.end_ns - trace.start_ns) % 1000);
+    json.append(event, static_cast<size_t>(length));
+    first = false;
+  });
+  json += "]}";
+  return json;
+}
+
+}  // namespace flutter_bin
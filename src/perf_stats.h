@@ -0,0 +1,131 @@
+#ifndef FLUTTER_BIN_PERF_STATS_H_
+#define FLUTTER_BIN_PERF_STATS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace flutter_bin {
+
+// The steps of a metadata request that are timed separately.
+enum class PerfPhase {
+  // A whole method call, from the start of its work to its reply value.
+  kMethodCall,
+  // UTF-8 paths converted to the host's wide paths.
+  kPathConversion,
+  // The size/time/identity stat that validates a cache entry.
+  kAttributeLookup,
+  // Opening and mapping the file.
+  kFileOpen,
+  // Recognizing the format and parsing the headers.
+  kHeaderParse,
+  // Finding and parsing the version resource, notes or Info.plist.
+  kResourceRead,
+  // Looking up and transcoding the requested strings.
+  kStringDecode,
+  // Content digests and the Authenticode digest.
+  kHash,
+  // Building the reply for the method channel codec.
+  kEncode,
+};
+
+constexpr size_t kPerfPhaseCount = 9;
+
+// e.g. "fileOpen"; the key the phase is reported under.
+const char* PerfPhaseName(PerfPhase phase);
+
+// Timing is off until enabled; a disabled timer costs one relaxed load.
+void SetPerfStatsEnabled(bool enabled);
+
+// Also keeps the last kMaxPerfTraceEvents timed phases of every thread for
+// PerfTraceJson(). Only has an effect while stats are enabled.
+void SetPerfTraceEnabled(bool enabled);
+constexpr size_t kMaxPerfTraceEvents = 1 << 14;
+
+namespace internal {
+extern std::atomic<bool> perf_stats_enabled;
+void RecordPhase(PerfPhase phase, int64_t start_ns, int64_t end_ns);
+inline int64_t PerfNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace internal
+
+inline bool PerfStatsEnabled() {
+  return internal::perf_stats_enabled.load(std::memory_order_relaxed);
+}
+
+// Times its scope as |phase| when stats are enabled. Samples go to a
+// histogram owned by the calling thread, so recording takes no lock.
+class ScopedPhaseTimer {
+ public:
+  explicit ScopedPhaseTimer(PerfPhase phase)
+      : phase_(phase), start_(PerfStatsEnabled() ? internal::PerfNow() : -1) {}
+  ~ScopedPhaseTimer() {
+    if (start_ >= 0) {
+      internal::RecordPhase(phase_, start_, internal::PerfNow());
+    }
+  }
+
+  // Disallow copy and assign.
+  ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+  ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+ private:
+  PerfPhase phase_;
+  int64_t start_;
+};
+
+// Latency of one phase since the last reset, summed over every thread.
+// Percentiles are histogram bucket bounds, within 1/8 of the true value.
+struct PhaseStats {
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+  uint64_t p50_ns = 0;
+  uint64_t p90_ns = 0;
+  uint64_t p99_ns = 0;
+  uint64_t max_ns = 0;
+};
+
+// Latencies recorded outside the phase timings, e.g. per request class,
+// with the same buckets. Safe to record and read from any thread.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+  ~LatencyHistogram();
+
+  // Disallow copy and assign.
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void Record(uint64_t ns);
+  PhaseStats Read() const;
+  void Reset();
+
+ private:
+  struct Counters;
+  std::unique_ptr<Counters> counters_;
+};
+
+struct PerfSnapshot {
+  bool enabled = false;
+  PhaseStats phases[kPerfPhaseCount];
+};
+
+// Merges the per-thread histograms. Safe to call while other threads record.
+PerfSnapshot ReadPerfStats();
+
+// Starts the counters and the trace over.
+void ResetPerfStats();
+
+// The retained trace events as Chrome trace event JSON, loadable in
+// chrome://tracing or Perfetto.
+std::string PerfTraceJson();
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_PERF_STATS_H_
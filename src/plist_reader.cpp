@@ -0,0 +1,720 @@
+#include "plist_reader.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace flutter_bin {
+
+namespace {
+
+const char kBinaryMagic[] = "bplist00";
+constexpr size_t kBinaryMagicSize = 8;
+constexpr size_t kTrailerSize = 32;
+
+// Object markers; the low nibble holds a count or size.
+constexpr uint8_t kMarkerFalse = 0x08;
+constexpr uint8_t kMarkerTrue = 0x09;
+constexpr uint8_t kTypeSimple = 0x0;
+constexpr uint8_t kTypeInteger = 0x1;
+constexpr uint8_t kTypeReal = 0x2;
+constexpr uint8_t kMarkerDate = 0x33;
+constexpr uint8_t kTypeData = 0x4;
+constexpr uint8_t kTypeAsciiString = 0x5;
+constexpr uint8_t kTypeUtf16String = 0x6;
+constexpr uint8_t kTypeArray = 0xA;
+constexpr uint8_t kTypeDictionary = 0xD;
+
+// Seconds from 1970-01-01 to 2001-01-01, the epoch of plist dates.
+constexpr double kPlistEpoch = 978307200.0;
+
+uint64_t LoadBeN(const uint8_t* p, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; ++i) {
+    value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+void AppendCodePoint(uint32_t code_point, std::string* out) {
+  if (code_point < 0x80) {
+    out->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x110000) {
+    out->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+// Appends |length| UTF-16BE code units. Unpaired surrogates become U+FFFD.
+void AppendUtf16Be(const uint8_t* data, size_t length, std::string* out) {
+  for (size_t i = 0; i < length; ++i) {
+    uint32_t unit = LoadBe16(data + 2 * i);
+    if (unit >= 0xD800 && unit < 0xDC00 && i + 1 < length) {
+      uint32_t low = LoadBe16(data + 2 * (i + 1));
+      if (low >= 0xDC00 && low < 0xE000) {
+        AppendCodePoint(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00),
+                        out);
+        ++i;
+        continue;
+      }
+    }
+    AppendCodePoint(unit >= 0xD800 && unit < 0xE000 ? 0xFFFD : unit, out);
+  }
+}
+
+// Shortest decimal text that reads back as |value|.
+void AppendReal(double value, std::string* out) {
+  char buffer[32];
+  for (int precision = 1; precision <= 17; ++precision) {
+    std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+    if (std::strtod(buffer, nullptr) == value) {
+      break;
+    }
+  }
+  *out += buffer;
+}
+
+// Formats seconds since the plist epoch as an ISO 8601 UTC timestamp.
+void AppendDate(double seconds, std::string* out) {
+  double unix_seconds = std::floor(seconds + kPlistEpoch);
+  if (!(unix_seconds > -1e15 && unix_seconds < 1e15)) {
+    return;
+  }
+  int64_t total = static_cast<int64_t>(unix_seconds);
+  int64_t days = total / 86400;
+  int64_t second_of_day = total % 86400;
+  if (second_of_day < 0) {
+    second_of_day += 86400;
+    --days;
+  }
+  // civil_from_days, http://howardhinnant.github.io/date_algorithms.html
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  int64_t day_of_era = days - era * 146097;
+  int64_t year_of_era = (day_of_era - day_of_era / 1460 +
+                         day_of_era / 36524 - day_of_era / 146096) /
+                        365;
+  int64_t day_of_year =
+      day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  int64_t month_index = (5 * day_of_year + 2) / 153;
+  int64_t day = day_of_year - (153 * month_index + 2) / 5 + 1;
+  int64_t month = month_index < 10 ? month_index + 3 : month_index - 9;
+  int64_t year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+
+  char buffer[128];
+  std::snprintf(buffer, sizeof(buffer),
+                "%04lld-%02lld-%02lldT%02lld:%02lld:%02lldZ",
+                static_cast<long long>(year), static_cast<long long>(month),
+                static_cast<long long>(day),
+                static_cast<long long>(second_of_day / 3600),
+                static_cast<long long>(second_of_day / 60 % 60),
+                static_cast<long long>(second_of_day % 60));
+  *out += buffer;
+}
+
+// Number of keys in |keys| whose value has not been found yet.
+class Pending {
+ public:
+  explicit Pending(size_t count) : count_(count) {}
+  bool done() const { return count_ == 0; }
+  void Found() { --count_; }
+
+ private:
+  size_t count_;
+};
+
+// Reader for the bplist00 format, see CFBinaryPList.c. Every offset and
+// count is checked against the buffer, so hostile files only fail lookups.
+class BinaryPlist {
+ public:
+  bool Parse(ByteView plist) {
+    if (!plist.Contains(0, kBinaryMagicSize + kTrailerSize) ||
+        std::memcmp(plist.data, kBinaryMagic, kBinaryMagicSize) != 0) {
+      return false;
+    }
+    const uint8_t* trailer = plist.data + plist.size - kTrailerSize;
+    offset_size_ = trailer[6];
+    ref_size_ = trailer[7];
+    uint64_t object_count = LoadBe64(trailer + 8);
+    uint64_t top_object = LoadBe64(trailer + 16);
+    uint64_t table_offset = LoadBe64(trailer + 24);
+    size_t objects_end = plist.size - kTrailerSize;
+    if (offset_size_ < 1 || offset_size_ > 8 || ref_size_ < 1 ||
+        ref_size_ > 8 || top_object >= object_count ||
+        table_offset > objects_end ||
+        object_count > (objects_end - table_offset) / offset_size_) {
+      return false;
+    }
+    plist_ = plist.Sub(0, static_cast<size_t>(table_offset));
+    offset_table_ = plist.data + table_offset;
+    object_count_ = object_count;
+    top_object_ = top_object;
+    return true;
+  }
+
+  void Lookup(const std::vector<std::string>& keys,
+              std::vector<PlistValue>* values, bool* is_dictionary) {
+    *is_dictionary = false;
+    size_t offset;
+    uint8_t type;
+    uint64_t count;
+    if (!ReadObject(top_object_, &offset, &type, &count) ||
+        type != kTypeDictionary ||
+        count > (plist_.size - offset) / ref_size_ / 2) {
+      return;
+    }
+    *is_dictionary = true;
+    size_t entries = static_cast<size_t>(count);
+    const uint8_t* key_refs = plist_.data + offset;
+    const uint8_t* value_refs = key_refs + entries * ref_size_;
+
+    Pending pending(keys.size());
+    std::string decoded_key;
+    for (size_t i = 0; i < entries && !pending.done(); ++i) {
+      ByteView ascii;
+      bool is_ascii;
+      if (!ReadKey(LoadBeN(key_refs + i * ref_size_, ref_size_), &ascii,
+                   &decoded_key, &is_ascii)) {
+        continue;
+      }
+      for (size_t k = 0; k < keys.size(); ++k) {
+        PlistValue& value = (*values)[k];
+        if (value.found) {
+          continue;
+        }
+        const std::string& key = keys[k];
+        bool match = is_ascii ? key.size() == ascii.size &&
+                                    std::memcmp(key.data(), ascii.data,
+                                                ascii.size) == 0
+                              : key == decoded_key;
+        if (match) {
+          ReadValue(LoadBeN(value_refs + i * ref_size_, ref_size_), &value);
+          pending.Found();
+        }
+      }
+    }
+  }
+
+ private:
+  // Locates object |index|: its payload starts at |offset|, |type| is the
+  // high nibble of its marker and |count| the decoded low nibble.
+  bool ReadObject(uint64_t index, size_t* offset, uint8_t* type,
+                  uint64_t* count) const {
+    if (index >= object_count_) {
+      return false;
+    }
+    uint64_t object_offset =
+        LoadBeN(offset_table_ + index * offset_size_, offset_size_);
+    if (object_offset >= plist_.size) {
+      return false;
+    }
+    size_t p = static_cast<size_t>(object_offset);
+    uint8_t marker = plist_.data[p++];
+    *type = marker >> 4;
+    *count = marker & 0xF;
+    if (*count == 0xF && *type != kTypeSimple && *type != kTypeInteger &&
+        *type != kTypeReal) {
+      // The real count follows as an integer object.
+      if (p >= plist_.size || (plist_.data[p] >> 4) != kTypeInteger) {
+        return false;
+      }
+      size_t size = size_t{1} << (plist_.data[p] & 0xF);
+      if (size > 8 || !plist_.Contains(p + 1, size)) {
+        return false;
+      }
+      *count = LoadBeN(plist_.data + p + 1, size);
+      p += 1 + size;
+    }
+    *offset = p;
+    return true;
+  }
+
+  // Reads a dictionary key. ASCII keys are returned as a view of the file;
+  // UTF-16 keys are decoded into |decoded|.
+  bool ReadKey(uint64_t index, ByteView* ascii, std::string* decoded,
+               bool* is_ascii) const {
+    size_t offset;
+    uint8_t type;
+    uint64_t count;
+    if (!ReadObject(index, &offset, &type, &count)) {
+      return false;
+    }
+    if (type == kTypeAsciiString) {
+      *is_ascii = true;
+      if (count > plist_.size - offset) {
+        return false;
+      }
+      *ascii = plist_.Sub(offset, static_cast<size_t>(count));
+      return true;
+    }
+    if (type == kTypeUtf16String) {
+      *is_ascii = false;
+      if (count > (plist_.size - offset) / 2) {
+        return false;
+      }
+      decoded->clear();
+      AppendUtf16Be(plist_.data + offset, static_cast<size_t>(count), decoded);
+      return true;
+    }
+    return false;
+  }
+
+  void ReadValue(uint64_t index, PlistValue* value) const {
+    size_t offset;
+    uint8_t type;
+    uint64_t count;
+    if (!ReadObject(index, &offset, &type, &count)) {
+      return;
+    }
+    uint8_t marker = static_cast<uint8_t>(
+        (type << 4) | (count < 0xF ? count : 0xF));
+    size_t remaining = plist_.size - offset;
+    value->found = true;
+    switch (type) {
+      case kTypeSimple:
+        if (marker == kMarkerFalse || marker == kMarkerTrue) {
+          value->type = PlistType::kBoolean;
+          value->text = marker == kMarkerTrue ? "true" : "false";
+        }
+        return;
+      case kTypeInteger: {
+        // 1, 2 and 4 byte integers are unsigned, 8 byte ones signed and
+        // 16 byte ones hold values beyond INT64_MAX in their low half.
+        size_t size = size_t{1} << count;
+        if (count > 4 || size > remaining) {
+          break;
+        }
+        value->type = PlistType::kInteger;
+        const uint8_t* p = plist_.data + offset;
+        if (size == 16) {
+          value->text = std::to_string(LoadBe64(p + 8));
+        } else if (size == 8) {
+          value->text = std::to_string(static_cast<int64_t>(LoadBe64(p)));
+        } else {
+          value->text = std::to_string(LoadBeN(p, size));
+        }
+        return;
+      }
+      case kTypeReal: {
+        size_t size = size_t{1} << count;
+        if ((size != 4 && size != 8) || size > remaining) {
+          break;
+        }
+        value->type = PlistType::kReal;
+        const uint8_t* p = plist_.data + offset;
+        if (size == 4) {
+          uint32_t bits = LoadBe32(p);
+          float real;
+          std::memcpy(&real, &bits, sizeof(real));
+          AppendReal(real, &value->text);
+        } else {
+          uint64_t bits = LoadBe64(p);
+          double real;
+          std::memcpy(&real, &bits, sizeof(real));
+          AppendReal(real, &value->text);
+        }
+        return;
+      }
+      case kMarkerDate >> 4:
+        if (marker != kMarkerDate || remaining < 8) {
+          break;
+        }
+        {
+          uint64_t bits = LoadBe64(plist_.data + offset);
+          double seconds;
+          std::memcpy(&seconds, &bits, sizeof(seconds));
+          value->type = PlistType::kDate;
+          AppendDate(seconds, &value->text);
+        }
+        return;
+      case kTypeData:
+        value->type = PlistType::kData;
+        return;
+      case kTypeAsciiString:
+        if (count > remaining) {
+          break;
+        }
+        value->type = PlistType::kString;
+        value->text.assign(
+            reinterpret_cast<const char*>(plist_.data + offset),
+            static_cast<size_t>(count));
+        return;
+      case kTypeUtf16String:
+        if (count > remaining / 2) {
+          break;
+        }
+        value->type = PlistType::kString;
+        AppendUtf16Be(plist_.data + offset, static_cast<size_t>(count),
+                      &value->text);
+        return;
+      case kTypeArray:
+        value->type = PlistType::kArray;
+        return;
+      case kTypeDictionary:
+        value->type = PlistType::kDictionary;
+        return;
+      default:
+        return;
+    }
+    // Truncated object.
+    value->found = false;
+    value->type = PlistType::kOther;
+  }
+
+  ByteView plist_;  // Everything before the offset table.
+  const uint8_t* offset_table_ = nullptr;
+  size_t offset_size_ = 0;
+  size_t ref_size_ = 0;
+  uint64_t object_count_ = 0;
+  uint64_t top_object_ = 0;
+};
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Appends XML character data with the predefined and numeric entities
+// decoded. Unknown entities are kept verbatim.
+void AppendXmlText(const char* begin, const char* end, std::string* out) {
+  static const struct {
+    const char* name;
+    char value;
+  } kEntities[] = {{"amp;", '&'}, {"lt;", '<'},   {"gt;", '>'},
+                   {"quot;", '"'}, {"apos;", '\''}};
+  for (const char* p = begin; p < end; ++p) {
+    if (*p != '&') {
+      const char* amp = static_cast<const char*>(
+          std::memchr(p, '&', static_cast<size_t>(end - p)));
+      const char* run_end = amp != nullptr ? amp : end;
+      out->append(p, run_end);
+      p = run_end - 1;
+      continue;
+    }
+    const char* semicolon = static_cast<const char*>(
+        std::memchr(p, ';', static_cast<size_t>(end - p)));
+    if (semicolon == nullptr) {
+      out->push_back(*p);
+      continue;
+    }
+    bool decoded = false;
+    if (p + 1 < semicolon && p[1] == '#') {
+      bool hex = p + 2 < semicolon && (p[2] == 'x' || p[2] == 'X');
+      uint32_t code_point = 0;
+      const char* digit = p + (hex ? 3 : 2);
+      decoded = digit < semicolon;
+      for (; digit < semicolon && decoded; ++digit) {
+        char c = *digit;
+        uint32_t value;
+        if (c >= '0' && c <= '9') {
+          value = static_cast<uint32_t>(c - '0');
+        } else if (hex && c >= 'a' && c <= 'f') {
+          value = static_cast<uint32_t>(c - 'a' + 10);
+        } else if (hex && c >= 'A' && c <= 'F') {
+          value = static_cast<uint32_t>(c - 'A' + 10);
+        } else {
+          decoded = false;
+          break;
+        }
+        code_point = code_point * (hex ? 16 : 10) + value;
+        decoded = code_point < 0x110000;
+      }
+      if (decoded) {
+        AppendCodePoint(code_point, out);
+      }
+    } else {
+      for (const auto& entity : kEntities) {
+        size_t length = std::strlen(entity.name);
+        if (static_cast<size_t>(semicolon - p) == length &&
+            std::memcmp(p + 1, entity.name, length) == 0) {
+          out->push_back(entity.value);
+          decoded = true;
+          break;
+        }
+      }
+    }
+    if (decoded) {
+      p = semicolon;
+    } else {
+      out->push_back(*p);
+    }
+  }
+}
+
+// One element tag of an XML property list.
+struct XmlTag {
+  const char* name = nullptr;
+  size_t name_size = 0;
+  bool closing = false;
+  bool self_closing = false;
+  const char* end = nullptr;  // Just past '>'.
+
+  bool Is(const char* other) const {
+    return std::strlen(other) == name_size &&
+           std::memcmp(name, other, name_size) == 0;
+  }
+};
+
+// Scans an XML property list tag by tag without building a tree.
+class XmlPlist {
+ public:
+  explicit XmlPlist(ByteView plist)
+      : p_(reinterpret_cast<const char*>(plist.data)),
+        end_(p_ + plist.size) {}
+
+  void Lookup(const std::vector<std::string>& keys,
+              std::vector<PlistValue>* values, bool* is_dictionary) {
+    *is_dictionary = false;
+    XmlTag tag;
+    // The root element inside <plist>.
+    while (NextTag(&tag) && tag.Is("plist")) {
+    }
+    if (tag.name == nullptr || !tag.Is("dict") || tag.closing) {
+      return;
+    }
+    *is_dictionary = true;
+    if (tag.self_closing) {
+      return;
+    }
+
+    Pending pending(keys.size());
+    std::string decoded_key;
+    int depth = 1;
+    while (!pending.done() && NextTag(&tag)) {
+      if (tag.Is("dict") || tag.Is("array")) {
+        if (tag.closing) {
+          if (--depth == 0) {
+            return;
+          }
+        } else if (!tag.self_closing) {
+          ++depth;
+        }
+        continue;
+      }
+      if (!tag.Is("key") || tag.closing || tag.self_closing || depth != 1) {
+        continue;
+      }
+      const char* key_end = FindClosingTag(p_, "key", 3);
+      if (key_end == nullptr) {
+        return;
+      }
+      const char* key = p_;
+      size_t key_size = static_cast<size_t>(key_end - p_);
+      p_ = key_end + 6;
+      if (std::memchr(key, '&', key_size) != nullptr) {
+        decoded_key.clear();
+        AppendXmlText(key, key_end, &decoded_key);
+        key = decoded_key.data();
+        key_size = decoded_key.size();
+      }
+      PlistValue* value = nullptr;
+      for (size_t k = 0; k < keys.size(); ++k) {
+        if (!(*values)[k].found && keys[k].size() == key_size &&
+            std::memcmp(keys[k].data(), key, key_size) == 0) {
+          value = &(*values)[k];
+          break;
+        }
+      }
+      if (value == nullptr) {
+        continue;
+      }
+      pending.Found();
+      bool opened_container = false;
+      if (!ReadValue(value, &opened_container)) {
+        return;
+      }
+      if (opened_container) {
+        ++depth;
+      }
+      // Keys listed twice get the same value.
+      for (size_t k = 0; k < keys.size(); ++k) {
+        PlistValue& other = (*values)[k];
+        if (&other != value && !other.found && keys[k].size() == key_size &&
+            std::memcmp(keys[k].data(), key, key_size) == 0) {
+          other = *value;
+          pending.Found();
+        }
+      }
+    }
+  }
+
+  // Reads the element after a matched key. Containers are only typed; the
+  // scan then continues inside them, which |opened_container| reports.
+  bool ReadValue(PlistValue* value, bool* opened_container) {
+    XmlTag tag;
+    if (!NextTag(&tag) || tag.closing) {
+      return false;
+    }
+    value->found = true;
+    if (tag.Is("true") || tag.Is("false")) {
+      value->type = PlistType::kBoolean;
+      value->text.assign(tag.name, tag.name_size);
+      if (!tag.self_closing) {
+        SkipPast(tag);
+      }
+      return true;
+    }
+    if (tag.Is("dict") || tag.Is("array")) {
+      value->type =
+          tag.Is("dict") ? PlistType::kDictionary : PlistType::kArray;
+      *opened_container = !tag.self_closing;
+      return true;
+    }
+    PlistType type;
+    if (tag.Is("string")) {
+      type = PlistType::kString;
+    } else if (tag.Is("integer")) {
+      type = PlistType::kInteger;
+    } else if (tag.Is("real")) {
+      type = PlistType::kReal;
+    } else if (tag.Is("date")) {
+      type = PlistType::kDate;
+    } else if (tag.Is("data")) {
+      type = PlistType::kData;
+    } else {
+      type = PlistType::kOther;
+    }
+    value->type = type;
+    if (tag.self_closing) {
+      return true;
+    }
+    const char* value_end = FindClosingTag(p_, tag.name, tag.name_size);
+    if (value_end == nullptr) {
+      return false;
+    }
+    if (type != PlistType::kData && type != PlistType::kOther) {
+      AppendXmlText(p_, value_end, &value->text);
+    }
+    p_ = value_end + tag.name_size + 3;
+    return true;
+  }
+
+  void SkipPast(const XmlTag& tag) {
+    const char* close = FindClosingTag(p_, tag.name, tag.name_size);
+    if (close != nullptr) {
+      p_ = close + tag.name_size + 3;
+    }
+  }
+
+  // Reads the next element tag, skipping the XML declaration, DOCTYPE and
+  // comments.
+  bool NextTag(XmlTag* tag) {
+    while (true) {
+      const char* p = static_cast<const char*>(
+          std::memchr(p_, '<', static_cast<size_t>(end_ - p_)));
+      if (p == nullptr || p + 1 >= end_) {
+        return false;
+      }
+      if (p[1] == '!' && end_ - p >= 4 && std::memcmp(p, "<!--", 4) == 0) {
+        const char* close = nullptr;
+        for (const char* q = p + 4; q + 3 <= end_; ++q) {
+          if (q[0] == '-' && std::memcmp(q, "-->", 3) == 0) {
+            close = q + 3;
+            break;
+          }
+        }
+        if (close == nullptr) {
+          return false;
+        }
+        p_ = close;
+        continue;
+      }
+      const char* close = static_cast<const char*>(
+          std::memchr(p, '>', static_cast<size_t>(end_ - p)));
+      if (close == nullptr) {
+        return false;
+      }
+      p_ = close + 1;
+      if (p[1] == '?' || p[1] == '!') {
+        continue;
+      }
+      const char* name = p + 1;
+      tag->closing = *name == '/';
+      if (tag->closing) {
+        ++name;
+      }
+      const char* name_end = name;
+      while (name_end < close && !IsSpace(*name_end) && *name_end != '/') {
+        ++name_end;
+      }
+      tag->name = name;
+      tag->name_size = static_cast<size_t>(name_end - name);
+      tag->self_closing = close[-1] == '/';
+      tag->end = p_;
+      return true;
+    }
+  }
+
+  // Returns the start of "</name>" at or after |p|, or null.
+  const char* FindClosingTag(const char* p, const char* name,
+                             size_t name_size) const {
+    while (true) {
+      p = static_cast<const char*>(
+          std::memchr(p, '<', static_cast<size_t>(end_ - p)));
+      if (p == nullptr || static_cast<size_t>(end_ - p) < name_size + 3) {
+        return nullptr;
+      }
+      if (p[1] == '/' && std::memcmp(p + 2, name, name_size) == 0 &&
+          p[2 + name_size] == '>') {
+        return p;
+      }
+      ++p;
+    }
+  }
+
+  const char* p_;
+  const char* end_;
+};
+
+}  // namespace
+
+PlistFormat DetectPlistFormat(ByteView plist) {
+  if (plist.size >= kBinaryMagicSize &&
+      std::memcmp(plist.data, kBinaryMagic, kBinaryMagicSize) == 0) {
+    return PlistFormat::kBinary;
+  }
+  size_t i = 0;
+  if (plist.size >= 3 && plist.data[0] == 0xEF && plist.data[1] == 0xBB &&
+      plist.data[2] == 0xBF) {
+    i = 3;  // UTF-8 byte order mark
+  }
+  while (i < plist.size && IsSpace(static_cast<char>(plist.data[i]))) {
+    ++i;
+  }
+  if (i < plist.size && plist.data[i] == '<') {
+    return PlistFormat::kXml;
+  }
+  return PlistFormat::kUnknown;
+}
+
+bool ReadPlistValues(ByteView plist, const std::vector<std::string>& keys,
+                     std::vector<PlistValue>* values) {
+  values->assign(keys.size(), PlistValue());
+  bool is_dictionary = false;
+  switch (DetectPlistFormat(plist)) {
+    case PlistFormat::kBinary: {
+      BinaryPlist binary;
+      if (binary.Parse(plist)) {
+        binary.Lookup(keys, values, &is_dictionary);
+      }
+      break;
+    }
+    case PlistFormat::kXml:
+      XmlPlist(plist).Lookup(keys, values, &is_dictionary);
+      break;
+    case PlistFormat::kUnknown:
+      break;
+  }
+  return is_dictionary;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,55 @@
+#ifndef FLUTTER_BIN_PLIST_READER_H_
+#define FLUTTER_BIN_PLIST_READER_H_
+
+#include <string>
+#include <vector>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+enum class PlistFormat {
+  kUnknown,
+  kBinary,  // bplist00
+  kXml,
+};
+
+// Sniffs the format of a property list from its first bytes.
+PlistFormat DetectPlistFormat(ByteView plist);
+
+enum class PlistType {
+  kString,
+  kInteger,
+  kReal,
+  kBoolean,
+  kDate,
+  kData,
+  kArray,
+  kDictionary,
+  kOther,  // null, UID and fill objects
+};
+
+// One looked-up value of a property list.
+struct PlistValue {
+  bool found = false;
+  PlistType type = PlistType::kOther;
+  // Scalars as text: strings in UTF-8, integers and reals in decimal,
+  // booleans as "true" or "false", dates in ISO 8601 ("2024-01-31T12:00:00Z").
+  // Empty for data, arrays and dictionaries.
+  std::string text;
+};
+
+// Looks up |keys| in the top-level dictionary of |plist|, a binary (bplist00)
+// or XML property list, and stores the value of keys[i] in (*values)[i].
+//
+// Nothing but the wanted values is decoded. Binary plists are read through
+// their offset table: only the root dictionary's keys are compared and only
+// matching values are touched. XML plists are scanned once without building
+// a tree, stopping as soon as every key has been seen. Returns false if
+// |plist| is not a property list with a dictionary at its root.
+bool ReadPlistValues(ByteView plist, const std::vector<std::string>& keys,
+                     std::vector<PlistValue>* values);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_PLIST_READER_H_
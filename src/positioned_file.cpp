@@ -0,0 +1,185 @@
+#include "positioned_file.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+#include "perf_stats.h"
+#include "unicode.h"
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+namespace flutter_bin {
+
+PositionedFile::~PositionedFile() { Close(); }
+
+#if defined(_WIN32)
+
+bool PositionedFile::Open(const std::string& utf8_path) {
+  Close();
+
+  // Kept per thread so that its capacity is reused from call to call.
+  thread_local std::wstring wide_path;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kPathConversion);
+    Utf8ToWide(utf8_path, &wide_path);
+  }
+
+  // FILE_FLAG_RANDOM_ACCESS keeps the cache manager from reading ahead of
+  // the few ranges we ask for.
+  HANDLE file = CreateFileW(
+      wide_path.c_str(), GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    DWORD error = GetLastError();
+    if (error == ERROR_ACCESS_DENIED || error == ERROR_SHARING_VIOLATION) {
+      DWORD attributes = GetFileAttributesW(wide_path.c_str());
+      error_ = (attributes != INVALID_FILE_ATTRIBUTES &&
+                (attributes & FILE_ATTRIBUTE_DIRECTORY))
+                   ? Error::kNotRegularFile
+                   : Error::kAccessDenied;
+    } else {
+      error_ = Error::kNotFound;
+    }
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+    CloseHandle(file);
+    error_ = Error::kEmpty;
+    return false;
+  }
+
+  handle_ = file;
+  size_ = static_cast<uint64_t>(file_size.QuadPart);
+  return true;
+}
+
+void PositionedFile::Close() {
+  if (handle_ != nullptr) {
+    CloseHandle(handle_);
+  }
+  handle_ = nullptr;
+  size_ = 0;
+  error_ = Error::kNone;
+}
+
+bool PositionedFile::is_open() const { return handle_ != nullptr; }
+
+bool PositionedFile::ReadAt(uint64_t offset, void* buffer, size_t length,
+                            size_t* read) {
+  *read = 0;
+  uint8_t* out = static_cast<uint8_t*>(buffer);
+  while (*read < length) {
+    // The handle is synchronous; the OVERLAPPED only carries the offset, so
+    // concurrent reads never race on a shared file position.
+    OVERLAPPED overlapped = {};
+    uint64_t position = offset + *read;
+    overlapped.Offset = static_cast<DWORD>(position);
+    overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+    DWORD chunk = static_cast<DWORD>(
+        std::min<size_t>(length - *read, 0x40000000u));
+    DWORD transferred = 0;
+    if (!ReadFile(handle_, out + *read, chunk, &transferred, &overlapped)) {
+      return GetLastError() == ERROR_HANDLE_EOF;
+    }
+    if (transferred == 0) {
+      break;
+    }
+    *read += transferred;
+  }
+  return true;
+}
+
+#else
+
+bool PositionedFile::Open(const std::string& utf8_path) {
+  Close();
+
+  int fd = ::open(utf8_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    error_ = (errno == EACCES || errno == EPERM) ? Error::kAccessDenied
+                                                 : Error::kNotFound;
+    return false;
+  }
+
+  struct stat file_stat;
+  if (::fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+    ::close(fd);
+    error_ = Error::kNotRegularFile;
+    return false;
+  }
+  if (file_stat.st_size <= 0) {
+    ::close(fd);
+    error_ = Error::kEmpty;
+    return false;
+  }
+
+  // Without this the kernel turns every small read into a read-ahead window
+  // of 128 KiB or more, which is most of the cost on a slow volume.
+#if defined(__APPLE__)
+  ::fcntl(fd, F_RDAHEAD, 0);
+#else
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+#endif
+
+  fd_ = fd;
+  size_ = static_cast<uint64_t>(file_stat.st_size);
+  return true;
+}
+
+void PositionedFile::Close() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+  fd_ = -1;
+  size_ = 0;
+  error_ = Error::kNone;
+}
+
+void PositionedFile::Adopt(int fd, uint64_t size) {
+  Close();
+  fd_ = fd;
+  size_ = size;
+}
+
+int PositionedFile::Release() {
+  int fd = fd_;
+  fd_ = -1;
+  size_ = 0;
+  return fd;
+}
+
+bool PositionedFile::is_open() const { return fd_ >= 0; }
+
+bool PositionedFile::ReadAt(uint64_t offset, void* buffer, size_t length,
+                            size_t* read) {
+  *read = 0;
+  uint8_t* out = static_cast<uint8_t*>(buffer);
+  while (*read < length) {
+    ssize_t result = ::pread(fd_, out + *read, length - *read,
+                             static_cast<off_t>(offset + *read));
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (result == 0) {
+      break;
+    }
+    *read += static_cast<size_t>(result);
+  }
+  return true;
+}
+
+#endif
+
+}  // namespace flutter_bin
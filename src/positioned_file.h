@@ -0,0 +1,87 @@
+#ifndef FLUTTER_BIN_POSITIONED_FILE_H_
+#define FLUTTER_BIN_POSITIONED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace flutter_bin {
+
+// Bytes that can be read at any offset, without a file position to share.
+class RandomAccessSource {
+ public:
+  virtual ~RandomAccessSource() = default;
+
+  virtual uint64_t size() const = 0;
+
+  // Reads up to |length| bytes at |offset| into |buffer| and stores how many
+  // were read in |*read|, which is short only at the end of the file.
+  // Returns false on an I/O error. Safe to call from several threads.
+  virtual bool ReadAt(uint64_t offset, void* buffer, size_t length,
+                      size_t* read) = 0;
+};
+
+// A file opened for positioned reads (pread / ReadFile at an offset).
+//
+// Unlike MappedFile, nothing is read that is not asked for: the host's
+// read-ahead is switched off where it can be, so on a network share or a
+// slow removable volume reading the headers of a large image costs a few
+// small requests rather than a mapping's fault-around and read-ahead
+// windows.
+class PositionedFile : public RandomAccessSource {
+ public:
+  // Why the last Open() failed.
+  enum class Error {
+    kNone,
+    kNotFound,
+    kAccessDenied,
+    kNotRegularFile,
+    kEmpty,
+  };
+
+  PositionedFile() = default;
+  ~PositionedFile() override;
+
+  // Disallow copy and assign.
+  PositionedFile(const PositionedFile&) = delete;
+  PositionedFile& operator=(const PositionedFile&) = delete;
+
+  // Opens the file at |utf8_path|. Returns false if it cannot be opened or
+  // is empty. Any previously opened file is closed first.
+  bool Open(const std::string& utf8_path);
+
+  void Close();
+
+#if !defined(_WIN32)
+  // Takes ownership of |fd|, an open regular file of |size| bytes, e.g. one
+  // opened through io_uring. Any previously opened file is closed first.
+  void Adopt(int fd, uint64_t size);
+
+  // Gives up the descriptor without closing it, leaving this closed.
+  int Release();
+
+  int descriptor() const { return fd_; }
+#else
+  void* handle() const { return handle_; }
+#endif
+
+  bool is_open() const;
+  Error error() const { return error_; }
+
+  uint64_t size() const override { return size_; }
+  bool ReadAt(uint64_t offset, void* buffer, size_t length,
+              size_t* read) override;
+
+ private:
+#if defined(_WIN32)
+  void* handle_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+  uint64_t size_ = 0;
+  Error error_ = Error::kNone;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_POSITIONED_FILE_H_
@@ -0,0 +1,249 @@
+#include "sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "cpu_features.h"
+
+#if defined(FLUTTER_BIN_X86)
+#include <immintrin.h>
+#endif
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr size_t kBlockSize = 64;
+
+alignas(16) constexpr uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr uint32_t kInitialState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+inline uint32_t RotateRight(uint32_t value, int bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+void CompressPortable(uint32_t state[8], const uint8_t* blocks,
+                      size_t count) {
+  for (; count > 0; --count, blocks += kBlockSize) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = LoadBe32(blocks + 4 * i);
+    }
+    for (int i = 16; i < 64; ++i) {
+      uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^
+                    (w[i - 15] >> 3);
+      uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^
+                    (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; ++i) {
+      uint32_t s1 =
+          RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+      uint32_t choose = (e & f) ^ (~e & g);
+      uint32_t t1 = h + s1 + choose + kRoundConstants[i] + w[i];
+      uint32_t s0 =
+          RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+      uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t t2 = s0 + majority;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+#if defined(FLUTTER_BIN_X86)
+
+// Four rounds per step; the SHA extensions keep the state as ABEF/CDGH.
+FLUTTER_BIN_TARGET("sha,sse4.1")
+void CompressShaNi(uint32_t state[8], const uint8_t* blocks, size_t count) {
+  const __m128i byte_swap =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+  __m128i hgfe =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+  __m128i cdab = _mm_shuffle_epi32(dcba, 0xB1);
+  __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+  __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+  __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+  for (; count > 0; --count, blocks += kBlockSize) {
+    __m128i abef_start = abef;
+    __m128i cdgh_start = cdgh;
+    __m128i w[4];
+    for (int step = 0; step < 16; ++step) {
+      __m128i& words = w[step % 4];
+      if (step < 4) {
+        words = _mm_shuffle_epi8(
+            _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(blocks + 16 * step)),
+            byte_swap);
+      } else {
+        // W[t] = s1(W[t-2]) + W[t-7] + s0(W[t-15]) + W[t-16].
+        const __m128i& prev1 = w[(step + 3) % 4];
+        const __m128i& prev2 = w[(step + 2) % 4];
+        words = _mm_sha256msg1_epu32(words, w[(step + 1) % 4]);
+        words = _mm_add_epi32(words, _mm_alignr_epi8(prev1, prev2, 4));
+        words = _mm_sha256msg2_epu32(words, prev1);
+      }
+      __m128i message = _mm_add_epi32(
+          words, _mm_load_si128(reinterpret_cast<const __m128i*>(
+                     kRoundConstants + 4 * step)));
+      cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+      abef = _mm_sha256rnds2_epu32(abef, cdgh,
+                                   _mm_shuffle_epi32(message, 0x0E));
+    }
+    abef = _mm_add_epi32(abef, abef_start);
+    cdgh = _mm_add_epi32(cdgh, cdgh_start);
+  }
+
+  __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+  __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+  dcba = _mm_blend_epi16(feba, dchg, 0xF0);
+  hgfe = _mm_alignr_epi8(dchg, feba, 8);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), dcba);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), hgfe);
+}
+
+#endif
+
+void Compress(Sha256Kernel kernel, uint32_t state[8], const uint8_t* blocks,
+              size_t count) {
+#if defined(FLUTTER_BIN_X86)
+  if (kernel == Sha256Kernel::kShaNi) {
+    CompressShaNi(state, blocks, count);
+    return;
+  }
+#else
+  (void)kernel;
+#endif
+  CompressPortable(state, blocks, count);
+}
+
+}  // namespace
+
+bool Sha256KernelSupported(Sha256Kernel kernel) {
+  switch (kernel) {
+    case Sha256Kernel::kPortable:
+      return true;
+    case Sha256Kernel::kShaNi:
+      return GetCpuFeatures().sha;
+  }
+  return false;
+}
+
+Sha256Kernel DefaultSha256Kernel() {
+  static const Sha256Kernel kernel =
+      Sha256KernelSupported(Sha256Kernel::kShaNi) ? Sha256Kernel::kShaNi
+                                                  : Sha256Kernel::kPortable;
+  return kernel;
+}
+
+const char* Sha256KernelName(Sha256Kernel kernel) {
+  switch (kernel) {
+    case Sha256Kernel::kPortable:
+      return "portable";
+    case Sha256Kernel::kShaNi:
+      return "sha-ni";
+  }
+  return "";
+}
+
+Sha256Hasher::Sha256Hasher(Sha256Kernel kernel) : kernel_(kernel) {
+  std::memcpy(state_, kInitialState, sizeof(state_));
+}
+
+void Sha256Hasher::Update(ByteView data) {
+  length_ += data.size;
+  const uint8_t* p = data.data;
+  size_t size = data.size;
+  if (pending_size_ > 0) {
+    size_t take = std::min(size, kBlockSize - pending_size_);
+    std::memcpy(pending_ + pending_size_, p, take);
+    pending_size_ += take;
+    p += take;
+    size -= take;
+    if (pending_size_ < kBlockSize) {
+      return;
+    }
+    Compress(kernel_, state_, pending_, 1);
+    pending_size_ = 0;
+  }
+
+  size_t full_blocks = size / kBlockSize;
+  if (full_blocks > 0) {
+    Compress(kernel_, state_, p, full_blocks);
+    p += full_blocks * kBlockSize;
+    size -= full_blocks * kBlockSize;
+  }
+  if (size > 0) {
+    std::memcpy(pending_, p, size);
+    pending_size_ = size;
+  }
+}
+
+Sha256Digest Sha256Hasher::Finish() {
+  // The tail, the 0x80 terminator and the bit length: one or two blocks.
+  uint8_t tail[2 * kBlockSize] = {};
+  if (pending_size_ > 0) {
+    std::memcpy(tail, pending_, pending_size_);
+  }
+  tail[pending_size_] = 0x80;
+  size_t tail_blocks = pending_size_ + 9 <= kBlockSize ? 1 : 2;
+  uint64_t bit_length = length_ * 8;
+  for (int i = 0; i < 8; ++i) {
+    tail[tail_blocks * kBlockSize - 1 - i] =
+        static_cast<uint8_t>(bit_length >> (8 * i));
+  }
+  Compress(kernel_, state_, tail, tail_blocks);
+
+  Sha256Digest digest;
+  for (int i = 0; i < 8; ++i) {
+    digest[4 * i] = static_cast<uint8_t>(state_[i] >> 24);
+    digest[4 * i + 1] = static_cast<uint8_t>(state_[i] >> 16);
+    digest[4 * i + 2] = static_cast<uint8_t>(state_[i] >> 8);
+    digest[4 * i + 3] = static_cast<uint8_t>(state_[i]);
+  }
+  return digest;
+}
+
+Sha256Digest Sha256(ByteView data, Sha256Kernel kernel) {
+  Sha256Hasher hasher(kernel);
+  hasher.Update(data);
+  return hasher.Finish();
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,56 @@
+#ifndef FLUTTER_BIN_SHA256_H_
+#define FLUTTER_BIN_SHA256_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+using Sha256Digest = std::array<uint8_t, 32>;
+
+// Block compression implementations, slowest first.
+enum class Sha256Kernel {
+  kPortable,
+  kShaNi,  // x86 SHA extensions.
+};
+
+// Whether |kernel| can run on this CPU.
+bool Sha256KernelSupported(Sha256Kernel kernel);
+
+// The fastest supported kernel; what Sha256() uses unless told otherwise.
+Sha256Kernel DefaultSha256Kernel();
+
+// e.g. "portable", "sha-ni".
+const char* Sha256KernelName(Sha256Kernel kernel);
+
+// SHA-256 of |data|. |kernel| must be supported.
+Sha256Digest Sha256(ByteView data,
+                    Sha256Kernel kernel = DefaultSha256Kernel());
+
+// SHA-256 of input that arrives in pieces, e.g. the non-contiguous ranges of
+// a file that a signature covers. Whole blocks are compressed straight from
+// the caller's buffer; only a partial block is copied.
+class Sha256Hasher {
+ public:
+  explicit Sha256Hasher(Sha256Kernel kernel = DefaultSha256Kernel());
+
+  void Update(ByteView data);
+
+  // Pads the input and returns the digest. The hasher must not be updated
+  // afterwards.
+  Sha256Digest Finish();
+
+ private:
+  Sha256Kernel kernel_;
+  uint32_t state_[8];
+  uint8_t pending_[64];
+  size_t pending_size_ = 0;
+  uint64_t length_ = 0;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_SHA256_H_
@@ -0,0 +1,77 @@
+#include "string_pool.h"
+
+#include <cstring>
+#include <functional>
+
+namespace flutter_bin {
+
+StringPool::StringPool()
+    : chunks_(new std::atomic<std::string_view*>[kChunkCount]) {
+  for (size_t i = 0; i < kChunkCount; ++i) {
+    chunks_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+StringPool::~StringPool() {
+  for (size_t i = 0; i < kChunkCount; ++i) {
+    delete[] chunks_[i].load(std::memory_order_relaxed);
+  }
+}
+
+uint32_t StringPool::Intern(std::string_view value) {
+  size_t hash = std::hash<std::string_view>()(value);
+  // The map buckets by the low bits; pick the shard from the high ones.
+  Shard& shard = shards_[(hash >> (sizeof(size_t) * 8 - 4)) % kShardCount];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.ids.find(value);
+  if (it != shard.ids.end()) {
+    return it->second;
+  }
+
+  uint32_t id = next_id_.load(std::memory_order_relaxed);
+  do {
+    if (id >= kMaxStrings) {
+      return kNoString;
+    }
+  } while (!next_id_.compare_exchange_weak(id, id + 1,
+                                           std::memory_order_relaxed));
+
+  char* copy = shard.storage.AllocateArray<char>(value.size());
+  if (!value.empty()) {
+    std::memcpy(copy, value.data(), value.size());
+  }
+  std::string_view stored(copy, value.size());
+  Publish(id, stored);
+  shard.ids.emplace(stored, id);
+  bytes_.fetch_add(value.size(), std::memory_order_relaxed);
+  return id;
+}
+
+std::string_view StringPool::Get(uint32_t id) const {
+  if (id >= kMaxStrings) {
+    return std::string_view();
+  }
+  const std::string_view* chunk =
+      chunks_[id >> kChunkBits].load(std::memory_order_acquire);
+  return chunk != nullptr ? chunk[id & (kChunkSize - 1)] : std::string_view();
+}
+
+size_t StringPool::size() const {
+  return next_id_.load(std::memory_order_relaxed);
+}
+
+void StringPool::Publish(uint32_t id, std::string_view value) {
+  std::atomic<std::string_view*>& slot = chunks_[id >> kChunkBits];
+  std::string_view* chunk = slot.load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    std::lock_guard<std::mutex> lock(chunk_mutex_);
+    chunk = slot.load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+      chunk = new std::string_view[kChunkSize];
+      slot.store(chunk, std::memory_order_release);
+    }
+  }
+  chunk[id & (kChunkSize - 1)] = value;
+}
+
+}  // namespace flutter_bin
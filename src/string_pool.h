@@ -0,0 +1,79 @@
+#ifndef FLUTTER_BIN_STRING_POOL_H_
+#define FLUTTER_BIN_STRING_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include "arena.h"
+
+namespace flutter_bin {
+
+// A set of unique strings, each named by a small dense id, shared by the
+// workers of a batch so that names repeated across thousands of files
+// ("KERNEL32.dll", "GetProcAddress") are stored once.
+//
+// Intern() is safe to call from any number of threads. Lookups are split
+// across independently locked shards; the id -> string table is lock-free.
+// Strings are never removed, so views returned by Get() stay valid until
+// the pool is destroyed.
+class StringPool {
+ public:
+  static constexpr uint32_t kNoString = 0xFFFFFFFF;
+  // Ids are capped so the id -> string table is a fixed array of chunks.
+  static constexpr size_t kMaxStrings = size_t{1} << 24;
+
+  StringPool();
+  ~StringPool();
+
+  // Disallow copy and assign.
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  // Returns the id of |value|, adding it if it is new. Ids are handed out
+  // from 0 in the order strings are first seen. Returns kNoString once the
+  // pool holds kMaxStrings strings.
+  uint32_t Intern(std::string_view value);
+
+  // The string interned as |id|. The id must have been returned by Intern()
+  // on this thread or before some synchronization with the interning one
+  // (e.g. the end of a ThreadPool::ParallelFor()).
+  std::string_view Get(uint32_t id) const;
+
+  // Number of strings interned; their ids are [0, size()).
+  size_t size() const;
+
+  // Bytes of string data held.
+  size_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
+ private:
+  static constexpr size_t kShardCount = 16;
+  static constexpr size_t kChunkBits = 12;
+  static constexpr size_t kChunkSize = size_t{1} << kChunkBits;
+  static constexpr size_t kChunkCount = kMaxStrings / kChunkSize;
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::string_view, uint32_t> ids;
+    // Owns the bytes the keys of |ids| point to.
+    Arena storage;
+  };
+
+  // Records |value| as the string for |id|.
+  void Publish(uint32_t id, std::string_view value);
+
+  Shard shards_[kShardCount];
+  std::atomic<uint32_t> next_id_{0};
+  std::atomic<size_t> bytes_{0};
+  // kChunkCount lazily allocated chunks of kChunkSize strings.
+  std::unique_ptr<std::atomic<std::string_view*>[]> chunks_;
+  std::mutex chunk_mutex_;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_STRING_POOL_H_
@@ -0,0 +1,344 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_executor.h"
+#include "perf_stats.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+// Stands in for the platform thread: queues tasks until the test runs them.
+class FakeDispatcher : public Dispatcher {
+ public:
+  void Post(std::function<void()> task) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+    posted_.notify_all();
+  }
+
+  // Waits until |count| tasks are queued, then runs them all on this thread.
+  void RunUntil(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ASSERT_TRUE(posted_.wait_for(lock, std::chrono::seconds(5),
+                                 [&] { return tasks_.size() >= count; }));
+    std::deque<std::function<void()>> tasks;
+    tasks.swap(tasks_);
+    lock.unlock();
+    for (auto& task : tasks) {
+      task();
+    }
+  }
+
+  size_t queued() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable posted_;
+  std::deque<std::function<void()>> tasks_;
+};
+
+// A latch the test uses to hold work on a worker thread.
+class Gate {
+ public:
+  void Open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_ = true;
+    cv_.notify_all();
+  }
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return open_; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool open_ = false;
+};
+
+}  // namespace
+
+TEST(AsyncExecutor, CompletesOnDispatcherThread) {
+  ThreadPool pool(2);
+  FakeDispatcher dispatcher;
+  AsyncExecutor executor(&pool, &dispatcher);
+
+  std::thread::id worker_thread;
+  std::thread::id completion_thread;
+  executor.Submit(AsyncExecutor::kNoRequestId,
+                  {[&](const std::atomic<bool>&) {
+                     worker_thread = std::this_thread::get_id();
+                   },
+                   [&] { completion_thread = std::this_thread::get_id(); },
+                   [] { FAIL() << "not cancelled"; }});
+
+  dispatcher.RunUntil(1);
+  EXPECT_NE(worker_thread, std::this_thread::get_id());
+  EXPECT_EQ(completion_thread, std::this_thread::get_id());
+  EXPECT_EQ(executor.in_flight(), 0u);
+}
+
+TEST(AsyncExecutor, CancelSettlesImmediatelyAndOnce) {
+  ThreadPool pool(1);
+  FakeDispatcher dispatcher;
+  AsyncExecutor executor(&pool, &dispatcher);
+
+  Gate gate;
+  std::atomic<bool> started{false};
+  std::atomic<bool> saw_cancel{false};
+  std::vector<std::string> outcomes;
+  executor.Submit(42, {[&](const std::atomic<bool>& cancelled) {
+                         started = true;
+                         gate.Wait();
+                         saw_cancel = cancelled.load();
+                       },
+                       [&] { outcomes.push_back("complete"); },
+                       [&] { outcomes.push_back("cancelled"); }});
+
+  while (!started) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(executor.in_flight(), 1u);
+  EXPECT_TRUE(executor.Cancel(42));
+  EXPECT_FALSE(executor.Cancel(42));
+  dispatcher.RunUntil(1);
+  EXPECT_EQ(outcomes, std::vector<std::string>{"cancelled"});
+
+  // The work notices the flag; its completion must not be dispatched.
+  gate.Open();
+  while (!saw_cancel) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(dispatcher.queued(), 0u);
+  EXPECT_TRUE(saw_cancel.load());
+}
+
+TEST(AsyncExecutor, CancelAfterCompletionFails) {
+  ThreadPool pool(1);
+  FakeDispatcher dispatcher;
+  AsyncExecutor executor(&pool, &dispatcher);
+
+  bool completed = false;
+  executor.Submit(7, {[](const std::atomic<bool>&) {},
+                      [&] { completed = true; }, [] {}});
+  dispatcher.RunUntil(1);
+  EXPECT_TRUE(completed);
+  EXPECT_FALSE(executor.Cancel(7));
+  EXPECT_FALSE(executor.Cancel(AsyncExecutor::kNoRequestId));
+}
+
+TEST(AsyncExecutor, QueuedWorkIsSkippedOnceCancelled) {
+  ThreadPool pool(1);
+  FakeDispatcher dispatcher;
+  AsyncExecutor executor(&pool, &dispatcher);
+
+  Gate gate;
+  executor.Submit(1, {[&](const std::atomic<bool>&) { gate.Wait(); }, [] {},
+                      [] {}});
+  bool ran = false;
+  executor.Submit(2, {[&](const std::atomic<bool>&) { ran = true; }, [] {},
+                      [] {}});
+  EXPECT_TRUE(executor.Cancel(2));
+  gate.Open();
+  dispatcher.RunUntil(2);
+  EXPECT_FALSE(ran);
+}
+
+TEST(AsyncExecutor, DestructorDropsPendingCallbacks) {
+  ThreadPool pool(2);
+  FakeDispatcher dispatcher;
+  // The executor may drop the work before it starts, so the opener can
+  // outlive this test.
+  auto gate = std::make_shared<Gate>();
+  {
+    AsyncExecutor executor(&pool, &dispatcher);
+    executor.Submit(5, {[gate](const std::atomic<bool>&) { gate->Wait(); },
+                        [] { FAIL(); }, [] { FAIL(); }});
+    std::thread opener([gate] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      gate->Open();
+    });
+    opener.detach();
+  }
+  EXPECT_EQ(dispatcher.queued(), 0u);
+}
+
+TEST(AsyncExecutor, InteractiveRequestsOvertakeQueuedBulkWork) {
+  ThreadPool pool(2);
+  FakeDispatcher dispatcher;
+  AsyncExecutor executor(&pool, &dispatcher);
+  ASSERT_EQ(executor.concurrency_limit(RequestPriority::kBulk), 1u);
+
+  Gate gate;
+  std::atomic<int> bulk_started{0};
+  for (int i = 0; i < 3; ++i) {
+    AsyncRequest bulk{[&](const std::atomic<bool>&) {
+                        ++bulk_started;
+                        gate.Wait();
+                      },
+                      [] {}, [] {}, RequestPriority::kBulk};
+    executor.Submit(AsyncExecutor::kNoRequestId, std::move(bulk));
+  }
+  // The second worker is kept free of bulk work, so the click runs while
+  // the inventory is still stuck.
+  bool clicked = false;
+  executor.Submit(AsyncExecutor::kNoRequestId,
+                  {[](const std::atomic<bool>&) {}, [&] { clicked = true; },
+                   [] {}, RequestPriority::kInteractive});
+  dispatcher.RunUntil(1);
+  EXPECT_TRUE(clicked);
+  EXPECT_EQ(bulk_started.load(), 1);
+  gate.Open();
+  dispatcher.RunUntil(3);
+  EXPECT_EQ(bulk_started.load(), 3);
+}
+
+TEST(AsyncExecutor, KeepsAWorkerForInteractiveRequests) {
+  ThreadPool pool(4);
+  FakeDispatcher dispatcher;
+  AsyncExecutor executor(&pool, &dispatcher);
+
+  // Bulk fills its half of the pool, and normal work alone could take
+  // three workers; together they must still leave one free.
+  Gate gate;
+  std::atomic<int> started{0};
+  auto blocked = [&](RequestPriority priority) {
+    return AsyncRequest{[&](const std::atomic<bool>&) {
+                          ++started;
+                          gate.Wait();
+                        },
+                        [] {}, [] {}, priority};
+  };
+  for (int i = 0; i < 2; ++i) {
+    executor.Submit(AsyncExecutor::kNoRequestId,
+                    blocked(RequestPriority::kBulk));
+  }
+  for (int i = 0; i < 3; ++i) {
+    executor.Submit(AsyncExecutor::kNoRequestId,
+                    blocked(RequestPriority::kNormal));
+  }
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (started.load() < 3 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bool clicked = false;
+  executor.Submit(AsyncExecutor::kNoRequestId,
+                  {[](const std::atomic<bool>&) {}, [&] { clicked = true; },
+                   [] {}, RequestPriority::kInteractive});
+  dispatcher.RunUntil(1);
+  EXPECT_TRUE(clicked);
+  EXPECT_EQ(started.load(), 3);
+  gate.Open();
+  dispatcher.RunUntil(5);
+  EXPECT_EQ(started.load(), 5);
+}
+
+TEST(AsyncExecutor, CapsEachClass) {
+  ThreadPool pool(4);
+  FakeDispatcher dispatcher;
+  AsyncExecutor executor(&pool, &dispatcher);
+  executor.SetConcurrencyLimit(RequestPriority::kNormal, 2);
+
+  std::mutex mutex;
+  int running = 0;
+  int peak = 0;
+  for (int i = 0; i < 8; ++i) {
+    executor.Submit(AsyncExecutor::kNoRequestId,
+                    {[&](const std::atomic<bool>&) {
+                       {
+                         std::lock_guard<std::mutex> lock(mutex);
+                         peak = std::max(peak, ++running);
+                       }
+                       std::this_thread::sleep_for(
+                           std::chrono::milliseconds(5));
+                       std::lock_guard<std::mutex> lock(mutex);
+                       --running;
+                     },
+                     [] {}, [] {}});
+  }
+  dispatcher.RunUntil(8);
+  EXPECT_EQ(peak, 2);
+}
+
+TEST(AsyncExecutor, AgingKeepsBulkWorkFromStarving) {
+  for (bool aging : {false, true}) {
+    SCOPED_TRACE(aging ? "aging" : "strict");
+    ThreadPool pool(1);
+    FakeDispatcher dispatcher;
+    AsyncExecutor executor(&pool, &dispatcher);
+    executor.SetAgingInterval(aging ? std::chrono::milliseconds(10)
+                                    : std::chrono::milliseconds(0));
+
+    Gate gate;
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&](const char* name) {
+      return [&, name](const std::atomic<bool>&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(name);
+      };
+    };
+    executor.Submit(AsyncExecutor::kNoRequestId,
+                    {[&](const std::atomic<bool>&) { gate.Wait(); }, [] {},
+                     [] {}});
+    executor.Submit(AsyncExecutor::kNoRequestId,
+                    {record("bulk"), [] {}, [] {}, RequestPriority::kBulk});
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    executor.Submit(AsyncExecutor::kNoRequestId,
+                    {record("normal"), [] {}, [] {}});
+    gate.Open();
+    dispatcher.RunUntil(3);
+
+    // Three intervals make the bulk request as urgent as the normal one,
+    // and it has waited longer.
+    ASSERT_EQ(order.size(), 2u);
+    EXPECT_EQ(order[0], aging ? "bulk" : "normal");
+  }
+}
+
+TEST(AsyncExecutor, ReportsLatencyPerClass) {
+  ThreadPool pool(2);
+  FakeDispatcher dispatcher;
+  AsyncExecutor executor(&pool, &dispatcher);
+  SetPerfStatsEnabled(true);
+  executor.Submit(AsyncExecutor::kNoRequestId,
+                  {[](const std::atomic<bool>&) {
+                     std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                   },
+                   [] {}, [] {}, RequestPriority::kInteractive});
+  dispatcher.RunUntil(1);
+  SetPerfStatsEnabled(false);
+
+  PhaseStats interactive = executor.latency(RequestPriority::kInteractive);
+  EXPECT_EQ(interactive.count, 1u);
+  EXPECT_GE(interactive.p99_ns, 2000000u);
+  EXPECT_EQ(executor.latency(RequestPriority::kBulk).count, 0u);
+  executor.ResetLatency();
+  EXPECT_EQ(executor.latency(RequestPriority::kInteractive).count, 0u);
+
+  RequestPriority priority;
+  ASSERT_TRUE(ParseRequestPriority("bulk", &priority));
+  EXPECT_EQ(priority, RequestPriority::kBulk);
+  EXPECT_FALSE(ParseRequestPriority("urgent", &priority));
+}
+
+}  // namespace test
+}  // namespace flutter_bin
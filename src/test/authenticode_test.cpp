@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "authenticode.h"
+#include "binary_metadata.h"
+#include "content_hash.h"
+#include "pe_image.h"
+#include "testing/elf_builder.h"
+#include "testing/pe_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+
+constexpr size_t kSectionHeaderSize = 40;
+
+std::string Hex(const Sha256Digest& digest) {
+  return ToHex(digest.data(), digest.size());
+}
+
+// Digest of |bytes| parsed as a PE image, or "" if it cannot be computed.
+std::string Authenticode(const std::vector<uint8_t>& bytes) {
+  PeImage image;
+  Sha256Digest digest;
+  if (!image.Parse(ByteView(bytes.data(), bytes.size())) ||
+      !AuthenticodeSha256(image, &digest)) {
+    return "";
+  }
+  return Hex(digest);
+}
+
+// SHA-256 of |bytes| with the given [offset, offset + size) ranges removed.
+std::string Sha256Without(std::vector<uint8_t> bytes,
+                          std::vector<std::pair<size_t, size_t>> ranges) {
+  std::sort(ranges.rbegin(), ranges.rend());
+  for (const auto& range : ranges) {
+    bytes.erase(bytes.begin() + range.first,
+                bytes.begin() + range.first + range.second);
+  }
+  return Hex(Sha256(ByteView(bytes.data(), bytes.size())));
+}
+
+// The builder writes 16 data directories followed by the section table.
+size_t SectionTableOffset(const std::vector<uint8_t>& bytes) {
+  PeImage image;
+  image.Parse(ByteView(bytes.data(), bytes.size()));
+  return image.data_directory_offset(16);
+}
+
+}  // namespace
+
+TEST(Authenticode, SkipsChecksumSecurityEntryAndCertificateTable) {
+  for (bool pe32_plus : {false, true}) {
+    SCOPED_TRACE(pe32_plus);
+    std::vector<uint8_t> bytes = PeBuilder()
+                                     .SetPe32Plus(pe32_plus)
+                                     .AddSection(".data", 0x300)
+                                     .SetOverlaySize(0x123)
+                                     .SetCertificateTableSize(0x88)
+                                     .Build();
+    PeImage image;
+    ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+    uint32_t table_offset = 0;
+    uint32_t table_size = 0;
+    ASSERT_TRUE(image.GetDataDirectory(kPeDirectorySecurity, &table_offset,
+                                       &table_size));
+    EXPECT_EQ(table_offset + table_size, bytes.size());
+
+    // Sections are laid out in table order, so this is the whole file with
+    // the excluded ranges cut out; the alignment padding stays in.
+    EXPECT_EQ(Authenticode(bytes),
+              Sha256Without(bytes,
+                            {{image.checksum_offset(), 4},
+                             {image.data_directory_offset(4), 8},
+                             {table_offset, table_size}}));
+  }
+}
+
+TEST(Authenticode, IsUnchangedBySigning) {
+  PeBuilder builder;
+  builder.AddSection(".data", 0x300).SetOverlaySize(0x200);
+  std::vector<uint8_t> unsigned_image = builder.Build();
+  std::vector<uint8_t> signed_image =
+      builder.SetCertificateTableSize(0x400).Build();
+  ASSERT_NE(unsigned_image, signed_image);
+
+  // Signing tools also rewrite the checksum.
+  PeImage image;
+  ASSERT_TRUE(image.Parse(ByteView(signed_image.data(), signed_image.size())));
+  signed_image[image.checksum_offset()] = 0x5A;
+
+  EXPECT_EQ(Authenticode(signed_image), Authenticode(unsigned_image));
+  EXPECT_NE(Authenticode(unsigned_image),
+            Authenticode(PeBuilder().AddSection(".data", 0x300).Build()));
+}
+
+TEST(Authenticode, HashesSectionsInFileOrder) {
+  std::vector<uint8_t> bytes = PeBuilder()
+                                   .AddSection(".data", 0x300)
+                                   .AddSection(".tls", 0x200)
+                                   .Build();
+
+  // Reverse the section table; the section data stays where it is. Hashing
+  // in table order would no longer match the file read front to back.
+  size_t table = SectionTableOffset(bytes);
+  std::vector<uint8_t> headers(bytes.begin() + table,
+                               bytes.begin() + table + 3 * kSectionHeaderSize);
+  for (size_t i = 0; i < 3; ++i) {
+    std::copy(headers.begin() + (2 - i) * kSectionHeaderSize,
+              headers.begin() + (3 - i) * kSectionHeaderSize,
+              bytes.begin() + table + i * kSectionHeaderSize);
+  }
+  PeImage image;
+  ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  ASSERT_GT(image.section(0).raw_offset, image.section(2).raw_offset);
+  EXPECT_EQ(Authenticode(bytes),
+            Sha256Without(bytes, {{image.checksum_offset(), 4},
+                                  {image.data_directory_offset(4), 8}}));
+}
+
+TEST(Authenticode, RejectsRangesOutsideTheFile) {
+  std::vector<uint8_t> bytes = PeBuilder()
+                                   .AddSection(".data", 0x300)
+                                   .SetCertificateTableSize(0x40)
+                                   .Build();
+  ASSERT_FALSE(Authenticode(bytes).empty());
+
+  std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 0x20);
+  EXPECT_EQ(Authenticode(truncated), "");
+
+  // Cut into the last section as well.
+  truncated.resize(truncated.size() - 0x100);
+  EXPECT_EQ(Authenticode(truncated), "");
+}
+
+TEST(Authenticode, ReportedForPeImagesOnly) {
+  std::string pe = testing::TempPath("authenticode.exe");
+  std::vector<uint8_t> bytes =
+      PeBuilder().SetOverlaySize(0x200).SetCertificateTableSize(0x40).Build();
+  ASSERT_TRUE(testing::WriteFile(pe, bytes));
+  BinaryMetadata metadata =
+      ReadBinaryMetadata(pe, MetadataRequest::Only({"authenticode"}));
+  // The builder adds no version resource; the digest is reported anyway.
+  EXPECT_EQ(metadata.error, MetadataError::kNoVersionInfo);
+  EXPECT_EQ(metadata.fields["authenticode"], Authenticode(bytes));
+  EXPECT_EQ(metadata.fields.count("sha256"), 0u);
+  std::remove(pe.c_str());
+
+  std::string elf = testing::TempPath("authenticode.so");
+  ASSERT_TRUE(testing::WriteFile(elf, testing::ElfBuilder().Build()));
+  metadata = ReadBinaryMetadata(elf, MetadataRequest::Only(
+                                         {"authenticode", "sha256"}));
+  EXPECT_EQ(metadata.fields.count("authenticode"), 0u);
+  EXPECT_EQ(metadata.fields.count("sha256"), 1u);
+  std::remove(elf.c_str());
+}
+
+}  // namespace test
+}  // namespace flutter_bin
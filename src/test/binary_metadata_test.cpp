@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <bitset>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "testing/allocation_counter.h"
+#include "testing/elf_builder.h"
+#include "testing/pe_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+using testing::VersionInfoBuilder;
+
+std::string WriteFixture(const std::string& name) {
+  std::string path = testing::TempPath(name);
+  PeBuilder()
+      .AddVersionResource(
+          VersionInfoBuilder()
+              .SetFileVersion(2, 5, 0, 17)
+              .AddStringTable(0x040904B0,
+                              {{u"ProductName", u"Fixture Product"},
+                               {u"CompanyName", u"Fixture Inc."},
+                               {u"InternalName", u"fixture"}})
+              .AddTranslation(0x040904B0)
+              .Build())
+      .WriteTo(path);
+  return path;
+}
+
+std::map<std::string, std::string> ToMap(const MetadataView& view) {
+  std::map<std::string, std::string> fields;
+  for (const MetadataField& field : view.fields) {
+    fields.emplace(field.key, field.value);
+  }
+  return fields;
+}
+
+}  // namespace
+
+TEST(BinaryMetadata, ReadsStandardFields) {
+  std::string path = WriteFixture("standard.exe");
+  BinaryMetadata metadata = ReadBinaryMetadata(path, MetadataRequest::Standard());
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  EXPECT_EQ(metadata.fields.size(), 6u);
+  EXPECT_EQ(metadata.fields["version"], "2.5.0.17");
+  EXPECT_EQ(metadata.fields["productName"], "Fixture Product");
+  EXPECT_EQ(metadata.fields["companyName"], "Fixture Inc.");
+  EXPECT_EQ(metadata.fields["legalCopyright"], "");
+  std::remove(path.c_str());
+}
+
+TEST(BinaryMetadata, ReadsOnlyRequestedFields) {
+  std::string path = WriteFixture("only.exe");
+  BinaryMetadata metadata = ReadBinaryMetadata(
+      path, MetadataRequest::Only({"companyName", "InternalName"}));
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  ASSERT_EQ(metadata.fields.size(), 2u);
+  EXPECT_EQ(metadata.fields["companyName"], "Fixture Inc.");
+  EXPECT_EQ(metadata.fields["InternalName"], "fixture");
+  std::remove(path.c_str());
+}
+
+TEST(BinaryMetadata, FieldMaskSelectsTheNamedFields) {
+  const char* names[] = {"version",        "productName",
+                         "fileDescription", "legalCopyright",
+                         "originalFilename", "companyName",
+                         "sha256",         "blake3",
+                         "authenticode",   "signerName"};
+  for (uint32_t mask = 0; mask <= kAllFieldsMask; ++mask) {
+    std::vector<std::string> fields;
+    for (uint32_t bit = 0; bit < 10; ++bit) {
+      if ((mask & (1u << bit)) != 0) {
+        fields.push_back(names[bit]);
+      }
+    }
+    MetadataRequest expected = MetadataRequest::Only(fields);
+    MetadataRequest request;
+    ASSERT_TRUE(MetadataRequest::FromMask(mask, {}, &request));
+    EXPECT_EQ(request.mask, mask);
+    EXPECT_EQ(expected.mask, mask);
+    EXPECT_EQ(request.version, expected.version) << mask;
+    EXPECT_EQ(request.strings, expected.strings) << mask;
+    EXPECT_EQ(request.hashes, expected.hashes) << mask;
+    EXPECT_EQ(request.signature, expected.signature) << mask;
+  }
+
+  MetadataRequest request;
+  ASSERT_TRUE(MetadataRequest::FromMask(kStandardFieldMask, {"InternalName"},
+                                        &request));
+  MetadataRequest standard = MetadataRequest::Standard({"InternalName"});
+  EXPECT_EQ(request.mask, standard.mask);
+  EXPECT_EQ(request.strings, standard.strings);
+  EXPECT_FALSE(MetadataRequest::FromMask(kAllFieldsMask + 1, {}, &request));
+  EXPECT_EQ(request.mask, kStandardFieldMask);
+}
+
+TEST(BinaryMetadata, EveryFieldMaskReadsAsTheGenericPath) {
+  std::string path = WriteFixture("masks.exe");
+  MetadataScratch scratch;
+  for (uint32_t mask = 0; mask <= kStandardFieldMask; ++mask) {
+    MetadataRequest request;
+    ASSERT_TRUE(MetadataRequest::FromMask(mask, {}, &request));
+    // Without its mask the request takes the decoder for any fields.
+    MetadataRequest generic = request;
+    generic.mask = 0;
+    BinaryMetadata expected = ReadBinaryMetadata(path, generic);
+    EXPECT_EQ(expected.fields.size(), std::bitset<32>(mask).count());
+    BinaryMetadata metadata = ReadBinaryMetadata(path, request);
+    EXPECT_EQ(metadata.error, expected.error) << mask;
+    EXPECT_EQ(metadata.fields, expected.fields) << mask;
+    EXPECT_EQ(ToMap(ReadBinaryMetadataView(path, request, &scratch)),
+              expected.fields)
+        << mask;
+  }
+  std::remove(path.c_str());
+}
+
+TEST(BinaryMetadata, ReportsErrors) {
+  EXPECT_EQ(ReadBinaryMetadata(testing::TempPath("missing.exe"),
+                               MetadataRequest::Standard())
+                .error,
+            MetadataError::kFileNotFound);
+
+  std::string text = testing::TempPath("notes.txt");
+  testing::WriteFile(text, {'h', 'e', 'l', 'l', 'o'});
+  EXPECT_EQ(ReadBinaryMetadata(text, MetadataRequest::Standard()).error,
+            MetadataError::kUnsupportedFormat);
+  std::remove(text.c_str());
+
+  std::string bare = testing::TempPath("bare.exe");
+  PeBuilder().WriteTo(bare);
+  BinaryMetadata metadata = ReadBinaryMetadata(bare, MetadataRequest::Standard());
+  EXPECT_EQ(metadata.error, MetadataError::kNoVersionInfo);
+  EXPECT_TRUE(metadata.fields.empty());
+  EXPECT_STREQ(MetadataErrorCode(metadata.error), "NO_VERSION_INFO");
+  std::remove(bare.c_str());
+}
+
+TEST(BinaryMetadata, ViewMatchesTheOwningRead) {
+  std::string pe = WriteFixture("view.exe");
+  std::string elf = testing::TempPath("view.so");
+  testing::WriteFile(elf,
+                     testing::ElfBuilder().SetSoname("libview.so.2").Build());
+  std::string bare = testing::TempPath("view_bare.exe");
+  PeBuilder().WriteTo(bare);
+  MetadataScratch scratch;
+  for (const std::string& path :
+       {pe, elf, bare, testing::TempPath("view_missing.exe")}) {
+    for (const MetadataRequest& request :
+         {MetadataRequest::Standard({"InternalName"}),
+          MetadataRequest::Only({"version"}),
+          MetadataRequest::Only({"companyName", "sha256"})}) {
+      BinaryMetadata expected = ReadBinaryMetadata(path, request);
+      MetadataView view = ReadBinaryMetadataView(path, request, &scratch);
+      EXPECT_EQ(view.error, expected.error) << path;
+      EXPECT_EQ(ToMap(view), expected.fields) << path;
+      EXPECT_EQ(view.fields.size, expected.fields.size()) << path;
+    }
+  }
+  std::remove(pe.c_str());
+  std::remove(elf.c_str());
+  std::remove(bare.c_str());
+}
+
+TEST(BinaryMetadata, ViewReadsAllocateNothingOnceWarm) {
+  std::string path = WriteFixture("warm.exe");
+  MetadataRequest request = MetadataRequest::Standard({"InternalName"});
+  MetadataScratch* scratch = MetadataScratch::ForCurrentThread();
+  ReadBinaryMetadataView(path, request, scratch);
+
+  uint64_t allocations = testing::ThreadAllocationCount();
+  for (int i = 0; i < 100; ++i) {
+    MetadataView view = ReadBinaryMetadataView(path, request, scratch);
+    ASSERT_EQ(view.error, MetadataError::kNone);
+    ASSERT_EQ(view.fields.size, 7u);
+  }
+  EXPECT_EQ(testing::ThreadAllocationCount() - allocations, 0u);
+
+  MetadataView view = ReadBinaryMetadataView(path, request, scratch);
+  EXPECT_EQ(ToMap(view)["version"], "2.5.0.17");
+  EXPECT_EQ(ToMap(view)["InternalName"], "fixture");
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace flutter_bin
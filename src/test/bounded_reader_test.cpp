@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "bounded_reader.h"
+#include "positioned_file.h"
+#include "testing/elf_builder.h"
+#include "testing/pe_builder.h"
+#include "testing/throttled_source.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+using testing::VersionInfoBuilder;
+
+constexpr size_t kOverlaySize = 8 * 1024 * 1024;
+
+// An installer-sized image: the version resource sits in the first pages,
+// followed by megabytes of payload nothing here should touch.
+std::string WriteLargeImage(const std::string& name) {
+  std::string path = testing::TempPath(name);
+  PeBuilder()
+      .AddSection(".text", 4096)
+      .AddVersionResource(
+          VersionInfoBuilder()
+              .SetFileVersion(7, 1, 2, 3)
+              .AddStringTable(0x040904B0,
+                              {{u"ProductName", u"Bounded Product"},
+                               {u"CompanyName", u"Bounded Inc."},
+                               {u"InternalName", u"bounded"}})
+              .AddTranslation(0x040904B0)
+              .Build())
+      .SetOverlaySize(kOverlaySize)
+      .WriteTo(path);
+  return path;
+}
+
+}  // namespace
+
+TEST(BoundedReader, ReadsWholeBlocksOnce) {
+  std::string path = testing::TempPath("blocks.bin");
+  std::vector<uint8_t> bytes(3 * BoundedReader::kBlockSize + 100);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 7);
+  }
+  ASSERT_TRUE(testing::WriteFile(path, bytes));
+  PositionedFile file;
+  ASSERT_TRUE(file.Open(path));
+  EXPECT_EQ(file.size(), bytes.size());
+
+  BoundedReader reader(&file, ReadBudget());
+  ByteView view = reader.Read(10, 20);
+  ASSERT_EQ(view.size, 20u);
+  EXPECT_EQ(view.data[0], bytes[10]);
+  EXPECT_EQ(reader.read_count(), 1u);
+  EXPECT_EQ(reader.bytes_read(), BoundedReader::kBlockSize);
+
+  // Anything else in the block is already there.
+  EXPECT_EQ(reader.Read(4000, 96).data[95], bytes[4095]);
+  EXPECT_EQ(reader.read_count(), 1u);
+
+  // The last block is short, reads are clamped to the file, and nothing
+  // past its end is read at all.
+  view = reader.Read(bytes.size() - 50, 200);
+  ASSERT_EQ(view.size, 50u);
+  EXPECT_EQ(view.data[49], bytes.back());
+  EXPECT_EQ(reader.bytes_read(), BoundedReader::kBlockSize + 100);
+  EXPECT_TRUE(reader.Read(bytes.size(), 1).empty());
+  EXPECT_EQ(reader.read_count(), 2u);
+  EXPECT_EQ(reader.error(), BoundedReader::Error::kNone);
+
+  file.Close();
+  std::remove(path.c_str());
+}
+
+TEST(BoundedReader, StopsAtTheBudget) {
+  std::string path = testing::TempPath("budget.bin");
+  ASSERT_TRUE(testing::WriteFile(
+      path, std::vector<uint8_t>(4 * BoundedReader::kBlockSize)));
+  PositionedFile file;
+  ASSERT_TRUE(file.Open(path));
+
+  ReadBudget budget;
+  budget.max_bytes = BoundedReader::kBlockSize + 64;
+  BoundedReader reader(&file, budget);
+  EXPECT_EQ(reader.Read(0, 16).size, 16u);
+  // A whole block would not fit any more; the exact range still does.
+  EXPECT_EQ(reader.Read(2 * BoundedReader::kBlockSize, 64).size, 64u);
+  EXPECT_EQ(reader.bytes_read(), budget.max_bytes);
+  EXPECT_TRUE(reader.Read(3 * BoundedReader::kBlockSize, 1).empty());
+  EXPECT_EQ(reader.error(), BoundedReader::Error::kBudgetExceeded);
+  // Failures stick, even for bytes that were already read.
+  EXPECT_TRUE(reader.Read(0, 16).empty());
+
+  file.Close();
+  std::remove(path.c_str());
+}
+
+TEST(BoundedMetadata, MatchesTheMappedReadFromAFewPages) {
+  std::string path = WriteLargeImage("large.exe");
+  MetadataRequest request = MetadataRequest::Standard({"InternalName"});
+  BinaryMetadata mapped = ReadBinaryMetadata(path, request);
+  BinaryMetadata bounded =
+      ReadBinaryMetadataBounded(path, request, ReadBudget());
+  EXPECT_EQ(bounded.error, MetadataError::kNone);
+  EXPECT_EQ(bounded.fields, mapped.fields);
+  EXPECT_EQ(bounded.fields["version"], "7.1.2.3");
+  EXPECT_EQ(bounded.fields["InternalName"], "bounded");
+  EXPECT_GT(bounded.bytes_read, 0u);
+  EXPECT_LE(bounded.bytes_read, 4 * BoundedReader::kBlockSize);
+  EXPECT_EQ(mapped.bytes_read, 0u);
+  std::remove(path.c_str());
+}
+
+TEST(BoundedMetadata, ReportsAnExhaustedBudget) {
+  std::string path = WriteLargeImage("tight.exe");
+  ReadBudget budget;
+  budget.max_bytes = BoundedReader::kBlockSize;
+  BinaryMetadata metadata =
+      ReadBinaryMetadataBounded(path, MetadataRequest::Standard(), budget);
+  EXPECT_EQ(metadata.error, MetadataError::kBudgetExceeded);
+  EXPECT_STREQ(MetadataErrorCode(metadata.error), "BUDGET_EXCEEDED");
+  EXPECT_TRUE(metadata.fields.empty());
+  EXPECT_EQ(metadata.bytes_read, BoundedReader::kBlockSize);
+  std::remove(path.c_str());
+}
+
+TEST(BoundedMetadata, GivesUpOnASlowVolume) {
+  std::string path = WriteLargeImage("slow.exe");
+  PositionedFile file;
+  ASSERT_TRUE(file.Open(path));
+  testing::ThrottledSource slow(&file, std::chrono::milliseconds(100));
+
+  // Every request takes longer than the whole deadline, so the header read
+  // is the only one made.
+  ReadBudget budget;
+  budget.timeout = std::chrono::milliseconds(50);
+  BinaryMetadata metadata;
+  ASSERT_TRUE(ReadPeMetadataBounded(&slow, MetadataRequest::Standard(), budget,
+                                    &metadata));
+  EXPECT_EQ(metadata.error, MetadataError::kTimedOut);
+  EXPECT_STREQ(MetadataErrorCode(metadata.error), "TIMED_OUT");
+  EXPECT_EQ(slow.read_count(), 1u);
+
+  // A generous deadline on a slow but not stalled volume still succeeds,
+  // at a cost set by the pages read rather than the file size.
+  testing::ThrottledSource narrow(&file, std::chrono::milliseconds(1),
+                                  /*bytes_per_second=*/1024 * 1024);
+  budget.timeout = std::chrono::seconds(10);
+  ASSERT_TRUE(ReadPeMetadataBounded(&narrow, MetadataRequest::Standard(),
+                                    budget, &metadata));
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  EXPECT_EQ(metadata.fields["productName"], "Bounded Product");
+  EXPECT_EQ(metadata.bytes_read, narrow.bytes_read());
+  EXPECT_LE(narrow.read_count(), 3u);
+
+  file.Close();
+  std::remove(path.c_str());
+}
+
+TEST(BoundedMetadata, FallsBackToTheMappedRead) {
+  std::string elf = testing::TempPath("bounded.so");
+  ASSERT_TRUE(testing::WriteFile(
+      elf, testing::ElfBuilder().SetSoname("libbounded.so.1").Build()));
+  MetadataRequest request = MetadataRequest::Standard();
+  BinaryMetadata metadata =
+      ReadBinaryMetadataBounded(elf, request, ReadBudget());
+  EXPECT_EQ(metadata.fields, ReadBinaryMetadata(elf, request).fields);
+  EXPECT_EQ(metadata.bytes_read, 0u);
+  std::remove(elf.c_str());
+
+  // Digests need every byte, whatever the budget.
+  std::string pe = WriteLargeImage("hashed.exe");
+  ReadBudget budget;
+  budget.max_bytes = 1;
+  metadata = ReadBinaryMetadataBounded(pe, MetadataRequest::Only({"sha256"}),
+                                       budget);
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  EXPECT_EQ(metadata.fields.count("sha256"), 1u);
+  std::remove(pe.c_str());
+
+  EXPECT_EQ(ReadBinaryMetadataBounded(testing::TempPath("missing.exe"),
+                                      request, ReadBudget())
+                .error,
+            MetadataError::kFileNotFound);
+}
+
+TEST(UnmappedMetadata, CopiesWhatTheBoundedReadWouldMap) {
+  std::string elf = testing::TempPath("unmapped.so");
+  std::vector<uint8_t> bytes =
+      testing::ElfBuilder().SetSoname("libunmapped.so.1").Build();
+  ASSERT_TRUE(testing::WriteFile(elf, bytes));
+  MetadataRequest request = MetadataRequest::Standard();
+  BinaryMetadata metadata =
+      ReadBinaryMetadataUnmapped(elf, request, ReadBudget());
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  EXPECT_EQ(metadata.fields, ReadBinaryMetadata(elf, request).fields);
+  EXPECT_EQ(metadata.bytes_read, bytes.size());
+
+  // The copy is subject to the budget too.
+  ReadBudget budget;
+  budget.max_bytes = bytes.size() - 1;
+  metadata = ReadBinaryMetadataUnmapped(elf, request, budget);
+  EXPECT_EQ(metadata.error, MetadataError::kBudgetExceeded);
+  EXPECT_TRUE(metadata.fields.empty());
+
+  // Without a byte limit, a file too large to copy is not read at all.
+  {
+    std::FILE* file = std::fopen(elf.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    std::fseek(file, static_cast<long>(kDefaultUnmappedByteBudget), SEEK_SET);
+    std::fputc(0, file);
+    std::fclose(file);
+  }
+  metadata = ReadBinaryMetadataUnmapped(elf, request, ReadBudget());
+  EXPECT_EQ(metadata.error, MetadataError::kBudgetExceeded);
+  EXPECT_EQ(metadata.bytes_read, 0u);
+  std::remove(elf.c_str());
+
+  // Digests of a PE image come from the copy, not a mapping.
+  std::string pe = WriteLargeImage("unmapped.exe");
+  request = MetadataRequest::Only({"version", "sha256"});
+  metadata = ReadBinaryMetadataUnmapped(pe, request, ReadBudget());
+  EXPECT_EQ(metadata.fields, ReadBinaryMetadata(pe, request).fields);
+  EXPECT_GT(metadata.bytes_read, kOverlaySize);
+
+  // Version fields alone take the few-page read.
+  metadata = ReadBinaryMetadataUnmapped(pe, MetadataRequest::Standard(),
+                                        ReadBudget());
+  EXPECT_EQ(metadata.fields["version"], "7.1.2.3");
+  EXPECT_LE(metadata.bytes_read, 4 * BoundedReader::kBlockSize);
+  std::remove(pe.c_str());
+
+  EXPECT_EQ(ReadBinaryMetadataUnmapped(testing::TempPath("missing.so"),
+                                       request, ReadBudget())
+                .error,
+            MetadataError::kFileNotFound);
+}
+
+}  // namespace test
+}  // namespace flutter_bin
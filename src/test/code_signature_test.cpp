@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "code_signature.h"
+#include "der.h"
+#include "pe_image.h"
+#include "testing/macho_builder.h"
+#include "testing/pe_builder.h"
+#include "testing/signature_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::SignatureSpec;
+
+SignatureSpec ExampleSpec(SignatureSpec::Timestamp timestamp,
+                          const std::string& time) {
+  SignatureSpec spec;
+  spec.issuer = {{"C", "US"}, {"O", "Example, Inc."}, {"CN", "Example CA"}};
+  spec.subject = {{"C", "KR"}, {"O", "Example"}, {"CN", "Example Signer"}};
+  spec.serial = {0x00, 0x9A, 0xBC};
+  spec.timestamp = timestamp;
+  spec.time = time;
+  return spec;
+}
+
+std::map<std::string, std::string> SignerFields(
+    const std::vector<uint8_t>& signed_data) {
+  std::map<std::string, std::string> fields;
+  CodeSigner signer;
+  if (ReadCodeSigner(ByteView(signed_data.data(), signed_data.size()),
+                     &signer)) {
+    AddCodeSignerFields(signer, &fields);
+  }
+  return fields;
+}
+
+}  // namespace
+
+TEST(CodeSignature, ReadsAuthenticodeSignerFromCertificateTable) {
+  std::vector<uint8_t> signed_data = testing::BuildSignedData(ExampleSpec(
+      SignatureSpec::Timestamp::kCountersignature, "230405060708Z"));
+  std::vector<uint8_t> bytes =
+      testing::PeBuilder()
+          .SetCertificateTable(testing::BuildWinCertificate(signed_data))
+          .Build();
+  PeImage image;
+  ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  ByteView found = FindPeSignedData(image);
+  ASSERT_EQ(found.size, signed_data.size());
+
+  std::map<std::string, std::string> fields = SignerFields(signed_data);
+  EXPECT_EQ(fields[kSignerNameKey], "Example Signer");
+  EXPECT_EQ(fields[kSignerIssuerKey],
+            "CN=Example CA, O=Example\\, Inc., C=US");
+  EXPECT_EQ(fields[kSignerSerialKey], "9abc");
+  EXPECT_EQ(fields[kSigningTimeKey], "2023-04-05T06:07:08Z");
+}
+
+TEST(CodeSignature, ReadsRfc3161Timestamps) {
+  std::map<std::string, std::string> fields =
+      SignerFields(testing::BuildSignedData(
+          ExampleSpec(SignatureSpec::Timestamp::kAuthenticodeRfc3161,
+                      "20240102030405.123Z")));
+  EXPECT_EQ(fields[kSignerNameKey], "Example Signer");
+  EXPECT_EQ(fields[kSigningTimeKey], "2024-01-02T03:04:05Z");
+
+  // Two-digit UTCTime years before 50 are 20xx, the rest 19xx.
+  fields = SignerFields(testing::BuildSignedData(ExampleSpec(
+      SignatureSpec::Timestamp::kCountersignature, "991231235959Z")));
+  EXPECT_EQ(fields[kSigningTimeKey], "1999-12-31T23:59:59Z");
+
+  fields = SignerFields(testing::BuildSignedData(
+      ExampleSpec(SignatureSpec::Timestamp::kNone, "")));
+  EXPECT_EQ(fields[kSignerNameKey], "Example Signer");
+  EXPECT_EQ(fields.count(kSigningTimeKey), 0u);
+}
+
+TEST(CodeSignature, ReadsIndefiniteLengthCmsFromMachO) {
+  SignatureSpec spec = ExampleSpec(SignatureSpec::Timestamp::kCmsRfc3161,
+                                   "20250607080910Z");
+  spec.indefinite_lengths = true;
+  std::string path = testing::TempPath("signed.dylib");
+  ASSERT_TRUE(testing::WriteFile(
+      path, testing::MachOBuilder()
+                .SetCodeSignature(testing::BuildCodeSignatureSuperBlob(
+                    testing::BuildSignedData(spec)))
+                .Build()));
+
+  // Any one signer key selects all of them.
+  BinaryMetadata metadata =
+      ReadBinaryMetadata(path, MetadataRequest::Only({kSignerNameKey}));
+  EXPECT_EQ(metadata.fields[kSignerNameKey], "Example Signer");
+  EXPECT_EQ(metadata.fields[kSignerIssuerKey],
+            "CN=Example CA, O=Example\\, Inc., C=US");
+  EXPECT_EQ(metadata.fields[kSignerSerialKey], "9abc");
+  EXPECT_EQ(metadata.fields[kSigningTimeKey], "2025-06-07T08:09:10Z");
+  std::remove(path.c_str());
+
+  // Ad-hoc signatures have a code directory but no CMS blob.
+  std::vector<uint8_t> ad_hoc = testing::BuildCodeSignatureSuperBlob({});
+  EXPECT_TRUE(
+      FindMachOSignedData(ByteView(ad_hoc.data(), ad_hoc.size())).empty());
+}
+
+TEST(CodeSignature, OnlyReportedWhenRequested) {
+  std::string path = testing::TempPath("signed.exe");
+  ASSERT_TRUE(testing::PeBuilder()
+                  .SetCertificateTable(testing::BuildWinCertificate(
+                      testing::BuildSignedData(ExampleSpec(
+                          SignatureSpec::Timestamp::kNone, ""))))
+                  .WriteTo(path));
+  BinaryMetadata metadata = ReadBinaryMetadata(path, MetadataRequest::Only({}));
+  EXPECT_TRUE(metadata.fields.empty());
+
+  MetadataRequest request = MetadataRequest::Standard();
+  request.signature = true;
+  metadata = ReadBinaryMetadata(path, request);
+  EXPECT_EQ(metadata.fields[kSignerNameKey], "Example Signer");
+  std::remove(path.c_str());
+
+  // Unsigned images report no signer fields rather than empty ones.
+  ASSERT_TRUE(testing::PeBuilder().WriteTo(path));
+  metadata = ReadBinaryMetadata(path, request);
+  EXPECT_EQ(metadata.fields.count(kSignerNameKey), 0u);
+  EXPECT_EQ(metadata.fields.count(kSignerSerialKey), 0u);
+  std::remove(path.c_str());
+}
+
+TEST(CodeSignature, SurvivesTruncatedSignatures) {
+  for (bool indefinite : {false, true}) {
+    SignatureSpec spec = ExampleSpec(
+        SignatureSpec::Timestamp::kAuthenticodeRfc3161, "20240102030405Z");
+    spec.indefinite_lengths = indefinite;
+    std::vector<uint8_t> signed_data = testing::BuildSignedData(spec);
+    // Every prefix must be rejected or partially read without reading past
+    // its end; the sanitizer builds check the latter.
+    for (size_t size = 0; size < signed_data.size(); ++size) {
+      std::vector<uint8_t> prefix(signed_data.begin(),
+                                  signed_data.begin() + size);
+      SignerFields(prefix);
+    }
+    EXPECT_EQ(SignerFields(signed_data)[kSigningTimeKey],
+              "2024-01-02T03:04:05Z");
+  }
+}
+
+TEST(DerReader, WalksDefiniteAndIndefiniteLengths) {
+  // SEQUENCE (indefinite) { INTEGER 5, OCTET STRING (long form) "ab" },
+  // then a truncated INTEGER.
+  const std::vector<uint8_t> bytes = {0x30, 0x80, 0x02, 0x01, 0x05, 0x04,
+                                      0x81, 0x02, 'a',  'b',  0x00, 0x00,
+                                      0x02, 0x05, 0x01};
+  DerReader reader(ByteView(bytes.data(), bytes.size()));
+  DerElement sequence;
+  ASSERT_TRUE(reader.Next(kDerSequence, &sequence));
+  EXPECT_EQ(sequence.contents.size, 8u);
+
+  DerReader children(sequence.contents);
+  DerElement element;
+  ASSERT_TRUE(children.Next(kDerInteger, &element));
+  EXPECT_EQ(element.contents.data[0], 5);
+  ASSERT_TRUE(children.Next(kDerOctetString, &element));
+  EXPECT_EQ(element.contents.size, 2u);
+  EXPECT_TRUE(children.empty());
+
+  EXPECT_FALSE(reader.Next(&element));
+  EXPECT_TRUE(reader.empty());
+}
+
+}  // namespace test
+}  // namespace flutter_bin
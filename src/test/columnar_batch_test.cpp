@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "byte_view.h"
+#include "columnar_batch.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using Row = std::map<std::string, std::string>;
+
+// Decodes every row back into maps, checking every range on the way.
+bool Decode(const std::vector<uint8_t>& buffer, std::vector<Row>* rows,
+            size_t* string_count) {
+  ByteView view(buffer.data(), buffer.size());
+  if (!view.Contains(0, kColumnarBatchHeaderSize) ||
+      LoadLe32(view.data) != kColumnarBatchMagic ||
+      LoadLe32(view.data + 4) != buffer.size()) {
+    return false;
+  }
+  size_t row_count = LoadLe32(view.data + 8);
+  size_t column_count = LoadLe32(view.data + 12);
+  *string_count = LoadLe32(view.data + 16);
+  size_t offsets = kColumnarBatchHeaderSize + column_count * 4 * (1 + row_count);
+  size_t strings = offsets + (*string_count + 1) * 4;
+  if (!view.Contains(0, strings)) {
+    return false;
+  }
+  auto string = [&](uint32_t id, std::string* out) {
+    if (id >= *string_count) {
+      return false;
+    }
+    uint32_t begin = LoadLe32(view.data + offsets + id * 4);
+    uint32_t end = LoadLe32(view.data + offsets + id * 4 + 4);
+    ByteView bytes = view.From(strings).Sub(begin, end - begin);
+    if (end < begin || (bytes.data == nullptr && end != begin)) {
+      return false;
+    }
+    out->assign(reinterpret_cast<const char*>(bytes.data), bytes.size);
+    return true;
+  };
+  rows->assign(row_count, Row());
+  for (size_t c = 0; c < column_count; ++c) {
+    std::string key;
+    if (!string(LoadLe32(view.data + kColumnarBatchHeaderSize + c * 4),
+                &key)) {
+      return false;
+    }
+    const uint8_t* column = view.data + kColumnarBatchHeaderSize +
+                            column_count * 4 + c * row_count * 4;
+    for (size_t r = 0; r < row_count; ++r) {
+      uint32_t id = LoadLe32(column + r * 4);
+      if (id != kColumnarNoValue && !string(id, &(*rows)[r][key])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(ColumnarBatch, RoundTripsSparseRowsAndErrors) {
+  std::vector<BinaryMetadata> batch(4);
+  batch[0].fields = {{"version", "1.0.0.0"}, {"companyName", "Example Inc."}};
+  batch[1].error = MetadataError::kFileNotFound;
+  batch[2].fields = {{"companyName", "Example Inc."}, {"buildId", "abc"}};
+  batch[3].fields = {{"version", ""}};
+
+  std::vector<Row> rows;
+  size_t string_count = 0;
+  ASSERT_TRUE(Decode(EncodeColumnarBatch(batch), &rows, &string_count));
+  ASSERT_EQ(rows.size(), 4u);
+  EXPECT_EQ(rows[0], batch[0].fields);
+  EXPECT_EQ(rows[1], (Row{{"error", "FILE_NOT_FOUND"}}));
+  EXPECT_EQ(rows[2], batch[2].fields);
+  EXPECT_EQ(rows[3], batch[3].fields);
+  // companyName, version, 1.0.0.0, Example Inc., error, FILE_NOT_FOUND,
+  // buildId, abc and the empty string.
+  EXPECT_EQ(string_count, 9u);
+}
+
+TEST(ColumnarBatch, StoresRepeatedStringsOnce) {
+  std::vector<BinaryMetadata> batch(1000);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    batch[i].fields = {{"companyName", i % 2 ? "Contoso" : "Fabrikam"},
+                       {"legalCopyright", "(c) All rights reserved."},
+                       {"version", "1.0." + std::to_string(i % 10)}};
+  }
+  std::vector<uint8_t> buffer = EncodeColumnarBatch(batch);
+  std::vector<Row> rows;
+  size_t string_count = 0;
+  ASSERT_TRUE(Decode(buffer, &rows, &string_count));
+  EXPECT_EQ(rows[999]["companyName"], "Contoso");
+  EXPECT_EQ(rows[42]["version"], "1.0.2");
+  // 3 keys, 2 companies, 1 copyright line and 10 versions.
+  EXPECT_EQ(string_count, 16u);
+  // Dominated by the id columns: 4 bytes per field.
+  EXPECT_LT(buffer.size(), 3 * 4 * batch.size() + 512);
+}
+
+TEST(ColumnarBatch, EncodesAnEmptyBatch) {
+  std::vector<Row> rows;
+  size_t string_count = 0;
+  std::vector<uint8_t> buffer = EncodeColumnarBatch({});
+  ASSERT_TRUE(Decode(buffer, &rows, &string_count));
+  EXPECT_TRUE(rows.empty());
+  EXPECT_EQ(string_count, 0u);
+  EXPECT_EQ(buffer.size(), kColumnarBatchHeaderSize + 4);
+}
+
+}  // namespace test
+}  // namespace flutter_bin
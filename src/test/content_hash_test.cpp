@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "blake3.h"
+#include "content_hash.h"
+#include "sha256.h"
+#include "testing/pe_builder.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+ByteView View(const std::string& text) {
+  return ByteView(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+ByteView View(const std::vector<uint8_t>& bytes) {
+  return ByteView(bytes.data(), bytes.size());
+}
+
+// The input of the official BLAKE3 test vectors.
+std::vector<uint8_t> CountingBytes(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (size_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<uint8_t>(i % 251);
+  }
+  return bytes;
+}
+
+template <typename Digest>
+std::string Hex(const Digest& digest) {
+  return ToHex(digest.data(), digest.size());
+}
+
+std::vector<Sha256Kernel> Sha256Kernels() {
+  std::vector<Sha256Kernel> kernels;
+  for (Sha256Kernel kernel : {Sha256Kernel::kPortable, Sha256Kernel::kShaNi}) {
+    if (Sha256KernelSupported(kernel)) {
+      kernels.push_back(kernel);
+    }
+  }
+  return kernels;
+}
+
+std::vector<Blake3Kernel> Blake3Kernels() {
+  std::vector<Blake3Kernel> kernels;
+  for (Blake3Kernel kernel : {Blake3Kernel::kPortable, Blake3Kernel::kSse41,
+                              Blake3Kernel::kAvx2}) {
+    if (Blake3KernelSupported(kernel)) {
+      kernels.push_back(kernel);
+    }
+  }
+  return kernels;
+}
+
+}  // namespace
+
+TEST(ContentHash, Sha256MatchesKnownDigests) {
+  std::string million(1000000, 'a');
+  for (Sha256Kernel kernel : Sha256Kernels()) {
+    SCOPED_TRACE(Sha256KernelName(kernel));
+    EXPECT_EQ(Hex(Sha256(View(std::string()), kernel)),
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    EXPECT_EQ(Hex(Sha256(View(std::string("abc")), kernel)),
+              "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(
+        Hex(Sha256(View(std::string("abcdbcdecdefdefgefghfghighijhijkijkljklm"
+                                    "klmnlmnomnopnopq")),
+                   kernel)),
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    EXPECT_EQ(Hex(Sha256(View(million), kernel)),
+              "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+  }
+
+  // Every tail length around the one- and two-block padding cases.
+  std::vector<uint8_t> bytes = CountingBytes(200);
+  for (size_t size = 0; size <= bytes.size(); ++size) {
+    ByteView view(bytes.data(), size);
+    for (Sha256Kernel kernel : Sha256Kernels()) {
+      EXPECT_EQ(Sha256(view, kernel), Sha256(view, Sha256Kernel::kPortable))
+          << size;
+    }
+  }
+}
+
+TEST(ContentHash, IncrementalSha256MatchesOneShot) {
+  std::vector<uint8_t> bytes = CountingBytes(1000);
+  Sha256Digest expected = Sha256(View(bytes));
+  for (size_t piece : {size_t{1}, size_t{7}, size_t{63}, size_t{64},
+                       size_t{65}, size_t{200}}) {
+    for (Sha256Kernel kernel : Sha256Kernels()) {
+      Sha256Hasher hasher(kernel);
+      for (size_t offset = 0; offset < bytes.size(); offset += piece) {
+        hasher.Update(
+            ByteView(bytes.data() + offset,
+                     std::min(piece, bytes.size() - offset)));
+      }
+      EXPECT_EQ(hasher.Finish(), expected) << piece;
+    }
+  }
+}
+
+TEST(ContentHash, Blake3MatchesKnownDigests) {
+  const std::pair<size_t, const char*> kVectors[] = {
+      {0, "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262"},
+      {1, "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213"},
+      {1023,
+       "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11"},
+      {1024,
+       "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7"},
+      {1025,
+       "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444"},
+      {2048,
+       "e776b6028c7cd22a4d0ba182a8bf62205d2ef576467e838ed6f2529b85fba24a"},
+      {3073,
+       "7124b49501012f81cc7f11ca069ec9226cecb8a2c850cfe644e327d22d3e1cd3"},
+      {8193,
+       "bab6c09cb8ce8cf459261398d2e7aef35700bf488116ceb94a36d0f5f1b7bc3b"},
+      {16384,
+       "f875d6646de28985646f34ee13be9a576fd515f76b5b0a26bb324735041ddde4"},
+      {31744,
+       "62b6960e1a44bcc1eb1a611a8d6235b6b4b78f32e7abc4fb4c6cdcce94895c47"},
+      {102400,
+       "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085"},
+  };
+  std::vector<uint8_t> bytes = CountingBytes(102400);
+  for (Blake3Kernel kernel : Blake3Kernels()) {
+    SCOPED_TRACE(Blake3KernelName(kernel));
+    for (const auto& vector : kVectors) {
+      EXPECT_EQ(Hex(Blake3(ByteView(bytes.data(), vector.first), nullptr,
+                           kernel)),
+                vector.second)
+          << vector.first;
+    }
+  }
+}
+
+TEST(ContentHash, ParallelBlake3MatchesSerial) {
+  std::vector<uint8_t> bytes = CountingBytes(300000);
+  ThreadPool pool(3);
+  EXPECT_EQ(Hex(Blake3(View(bytes), &pool)),
+            "6cc9dce05d4cff8c5bef5c5a24681e42b13f03e34a0bc5e66f65a91d48c944fa");
+
+  // Piece boundaries at every position relative to the chunk tree.
+  bytes = CountingBytes(3 * 1024 * 1024 + 7);
+  for (size_t size : {size_t{256 * 1024}, size_t{256 * 1024 + 1},
+                      size_t{512 * 1024}, size_t{1000 * 1024 + 17},
+                      bytes.size()}) {
+    ByteView view(bytes.data(), size);
+    for (Blake3Kernel kernel : Blake3Kernels()) {
+      EXPECT_EQ(Blake3(view, &pool, kernel), Blake3(view, nullptr, kernel))
+          << size;
+    }
+  }
+}
+
+TEST(ContentHash, ReportsRequestedHashesWithMetadata) {
+  std::string path = testing::TempPath("hashed.exe");
+  std::vector<uint8_t> image =
+      testing::PeBuilder().SetOverlaySize(5000).Build();
+  ASSERT_TRUE(testing::WriteFile(path, image));
+
+  BinaryMetadata metadata =
+      ReadBinaryMetadata(path, MetadataRequest::Only({"sha256", "blake3"}));
+  EXPECT_EQ(metadata.fields["sha256"], Hex(Sha256(View(image))));
+  EXPECT_EQ(metadata.fields["blake3"], Hex(Blake3(View(image))));
+  std::remove(path.c_str());
+
+  // Hashes do not depend on the format being recognized.
+  std::string text = testing::TempPath("hashed.txt");
+  ASSERT_TRUE(testing::WriteFile(text, {'h', 'e', 'l', 'l', 'o'}));
+  MetadataRequest request = MetadataRequest::Standard();
+  request.hashes = {HashAlgorithm::kBlake3, HashAlgorithm::kSha256};
+  metadata = ReadBinaryMetadata(text, request);
+  EXPECT_EQ(metadata.error, MetadataError::kUnsupportedFormat);
+  EXPECT_EQ(metadata.fields["sha256"],
+            "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824");
+  EXPECT_EQ(metadata.fields["blake3"],
+            "ea8f163db38682925e4491c5e58d4bb3506ef8c14eb78a86e908c5624a67200f");
+  std::remove(text.c_str());
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "testing/corpus.h"
+#include "testing/pe_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::CorpusEntry;
+using testing::CorpusFormat;
+using testing::CorpusOptions;
+
+CorpusOptions SmallCorpus(uint64_t seed) {
+  CorpusOptions options;
+  options.seed = seed;
+  options.files = 60;
+  options.max_file_size = 64 << 10;
+  return options;
+}
+
+}  // namespace
+
+TEST(Corpus, IsDeterministic) {
+  CorpusEntry first;
+  CorpusEntry second;
+  for (size_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(testing::BuildCorpusFile(SmallCorpus(7), i, &first),
+              testing::BuildCorpusFile(SmallCorpus(7), i, &second));
+    EXPECT_EQ(first.version, second.version);
+  }
+  EXPECT_NE(testing::BuildCorpusFile(SmallCorpus(7), 0, &first),
+            testing::BuildCorpusFile(SmallCorpus(8), 0, &second));
+}
+
+TEST(Corpus, VariesShapes) {
+  std::set<CorpusFormat> formats;
+  std::set<size_t> sections;
+  std::set<size_t> resource_types;
+  std::set<size_t> translations;
+  std::set<size_t> sizes;
+  CorpusOptions options = SmallCorpus(1);
+  for (size_t i = 0; i < options.files; ++i) {
+    CorpusEntry entry;
+    std::vector<uint8_t> bytes = testing::BuildCorpusFile(options, i, &entry);
+    EXPECT_EQ(bytes.size(), entry.size);
+    formats.insert(entry.format);
+    if (entry.format == CorpusFormat::kPe) {
+      sections.insert(entry.sections);
+      resource_types.insert(entry.resource_types);
+      translations.insert(entry.translations);
+    }
+    sizes.insert(entry.size);
+  }
+  EXPECT_EQ(formats.size(), 3u);
+  EXPECT_GT(sections.size(), 5u);
+  EXPECT_GT(resource_types.size(), 5u);
+  EXPECT_EQ(translations.size(), 4u);
+  EXPECT_GT(sizes.size(), 1u);
+}
+
+TEST(Corpus, EveryFileReads) {
+  std::vector<CorpusEntry> entries;
+  ASSERT_TRUE(testing::WriteCorpus(testing::TempPath("corpus"),
+                                   SmallCorpus(3), &entries));
+  for (const CorpusEntry& entry : entries) {
+    SCOPED_TRACE(entry.path);
+    BinaryMetadata metadata =
+        ReadBinaryMetadata(entry.path, MetadataRequest::Standard());
+    EXPECT_EQ(metadata.error, MetadataError::kNone);
+    EXPECT_EQ(metadata.fields[kVersionKey], entry.version);
+    if (entry.format == CorpusFormat::kPe) {
+      EXPECT_EQ(metadata.fields["originalFilename"].rfind("module_", 0), 0u);
+    }
+  }
+  testing::RemoveCorpus(entries);
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,387 @@
+#include <gtest/gtest.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "binary_format.h"
+#include "directory_list.h"
+#include "directory_scan.h"
+#include "testing/pe_builder.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+
+// Collects batches and acknowledges them on request.
+class Collector {
+ public:
+  DirectoryScan::Sink sink() {
+    return [this](std::vector<ScanEntry> batch, const ScanSummary* summary) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++batches_;
+      for (ScanEntry& entry : batch) {
+        paths_.insert(entry.path);
+        formats_.push_back(entry.format);
+      }
+      if (summary) {
+        summary_ = *summary;
+        done_ = true;
+      }
+      changed_.notify_all();
+    };
+  }
+
+  // Waits for the final batch.
+  ScanSummary WaitForSummary() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    EXPECT_TRUE(changed_.wait_for(lock, std::chrono::seconds(10),
+                                  [this] { return done_; }));
+    return summary_;
+  }
+
+  // Waits until |count| batches have arrived.
+  void WaitForBatches(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    EXPECT_TRUE(changed_.wait_for(lock, std::chrono::seconds(10),
+                                  [&] { return batches_ >= count; }));
+  }
+
+  size_t batches() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batches_;
+  }
+
+  std::set<std::string> paths() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return paths_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  size_t batches_ = 0;
+  std::set<std::string> paths_;
+  std::vector<BinaryFormat> formats_;
+  ScanSummary summary_;
+  bool done_ = false;
+};
+
+DirectoryScan::Reader CountingReader(std::atomic<int>* reads) {
+  return [reads](const std::string&, BinaryFormat) {
+    ++*reads;
+    return BinaryMetadata();
+  };
+}
+
+// A tree of |directories| folders, each holding one PE, one ELF header and
+// one text file.
+class Tree {
+ public:
+  explicit Tree(int directories) : root_(testing::TempPath("tree")) {
+    MakeDirectory(root_);
+    std::string parent = root_;
+    for (int i = 0; i < directories; ++i) {
+      std::string dir = JoinPath(parent, "d" + std::to_string(i));
+      MakeDirectory(dir);
+      AddFile(JoinPath(dir, "app" + std::to_string(i) + ".EXE"),
+              PeBuilder().Build());
+      AddFile(JoinPath(dir, "lib" + std::to_string(i) + ".so"),
+              {0x7F, 'E', 'L', 'F', 2, 1, 1, 0});
+      AddFile(JoinPath(dir, "readme.txt"), {'h', 'i'});
+      // Alternate between deep and wide.
+      parent = i % 2 == 0 ? dir : root_;
+    }
+  }
+
+  ~Tree() {
+    for (auto it = files_.rbegin(); it != files_.rend(); ++it) {
+      std::remove(it->c_str());
+    }
+  }
+
+  // Adds |count| ELF headers directly under the root.
+  void AddBinaries(int count) {
+    for (int i = 0; i < count; ++i) {
+      AddFile(JoinPath(root_, "bin" + std::to_string(i) + ".so"),
+              {0x7F, 'E', 'L', 'F', 2, 1, 1, 0});
+    }
+  }
+
+  const std::string& root() const { return root_; }
+
+ private:
+  void MakeDirectory(const std::string& path) {
+#if defined(_WIN32)
+    _mkdir(path.c_str());
+#else
+    ::mkdir(path.c_str(), 0700);
+#endif
+    files_.push_back(path);
+  }
+
+  void AddFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    testing::WriteFile(path, bytes);
+    files_.push_back(path);
+  }
+
+  std::string root_;
+  std::vector<std::string> files_;  // In creation order.
+};
+
+}  // namespace
+
+TEST(BinaryFormat, DetectsMagicBytes) {
+  auto detect = [](std::vector<uint8_t> bytes) {
+    return DetectBinaryFormat(ByteView(bytes.data(), bytes.size()));
+  };
+  EXPECT_EQ(detect({'M', 'Z', 0x90, 0}), BinaryFormat::kPe);
+  EXPECT_EQ(detect({0x7F, 'E', 'L', 'F', 2}), BinaryFormat::kElf);
+  EXPECT_EQ(detect({0xCF, 0xFA, 0xED, 0xFE, 7, 0, 0, 1}),
+            BinaryFormat::kMachO);
+  EXPECT_EQ(detect({0xCA, 0xFE, 0xBA, 0xBE, 0, 0, 0, 2}),
+            BinaryFormat::kMachO);
+  // A Java class file, not a universal binary.
+  EXPECT_EQ(detect({0xCA, 0xFE, 0xBA, 0xBE, 0, 0, 0, 52}),
+            BinaryFormat::kUnknown);
+  EXPECT_EQ(detect({'#', '!'}), BinaryFormat::kUnknown);
+  EXPECT_EQ(detect({}), BinaryFormat::kUnknown);
+}
+
+TEST(DirectoryScan, ReportsBinariesByMagicBytes) {
+  Tree tree(12);
+  ThreadPool pool(4);
+  Collector collector;
+  std::atomic<int> reads{0};
+  ScanOptions options;
+  options.batch_size = 5;
+  options.max_unacknowledged_batches = 1000;
+  DirectoryScan scan(&pool, options, CountingReader(&reads), collector.sink());
+  scan.Start(tree.root());
+
+  ScanSummary summary = collector.WaitForSummary();
+  EXPECT_EQ(summary.directories, 13u);
+  EXPECT_EQ(summary.files, 36u);
+  EXPECT_EQ(summary.binaries, 24u);
+  EXPECT_EQ(summary.errors, 0u);
+  EXPECT_FALSE(summary.cancelled);
+  EXPECT_EQ(collector.paths().size(), 24u);
+  EXPECT_EQ(reads, 24);
+  EXPECT_GE(collector.batches(), 5u);
+}
+
+TEST(DirectoryScan, FiltersByExtensionAndDepth) {
+  Tree tree(6);
+  ThreadPool pool(2);
+  Collector collector;
+  std::atomic<int> reads{0};
+  ScanOptions options;
+  options.extensions = {"exe"};
+  options.max_depth = 1;
+  DirectoryScan scan(&pool, options, CountingReader(&reads), collector.sink());
+  scan.Start(tree.root());
+
+  collector.WaitForSummary();
+  // d0, d2, d4 hang off the root; d1, d3, d5 are one level deeper.
+  std::set<std::string> paths = collector.paths();
+  EXPECT_EQ(paths.size(), 3u);
+  for (const std::string& path : paths) {
+    EXPECT_NE(path.find(".EXE"), std::string::npos) << path;
+  }
+}
+
+TEST(DirectoryScan, PausesUntilBatchesAreAcknowledged) {
+  Tree tree(20);
+  ThreadPool pool(2);
+  Collector collector;
+  std::atomic<int> reads{0};
+  ScanOptions options;
+  options.batch_size = 1;
+  options.max_unacknowledged_batches = 2;
+  options.parallelism = 1;
+  DirectoryScan scan(&pool, options, CountingReader(&reads), collector.sink());
+  scan.Start(tree.root());
+
+  // One directory yields two single-entry batches, which uses up the credit.
+  collector.WaitForBatches(2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(collector.batches(), 2u);
+
+  for (int i = 0; i < 200 && collector.batches() < 41; ++i) {
+    scan.Acknowledge();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ScanSummary summary = collector.WaitForSummary();
+  EXPECT_EQ(summary.binaries, 40u);
+  EXPECT_EQ(collector.paths().size(), 40u);
+}
+
+TEST(DirectoryScan, PausesInsideALargeDirectory) {
+  Tree tree(0);
+  tree.AddBinaries(100);
+  ThreadPool pool(2);
+  Collector collector;
+  std::atomic<int> reads{0};
+  ScanOptions options;
+  options.batch_size = 1;
+  options.max_unacknowledged_batches = 2;
+  DirectoryScan scan(&pool, options, CountingReader(&reads), collector.sink());
+  scan.Start(tree.root());
+
+  // The root alone holds enough for 100 batches; only the credit is read.
+  collector.WaitForBatches(2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(collector.batches(), 2u);
+  EXPECT_EQ(reads, 2);
+
+  scan.Acknowledge();
+  collector.WaitForBatches(3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(collector.batches(), 3u);
+  EXPECT_EQ(reads, 3);
+
+  for (int i = 0; i < 1000 && collector.batches() < 101; ++i) {
+    scan.Acknowledge();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ScanSummary summary = collector.WaitForSummary();
+  EXPECT_EQ(summary.binaries, 100u);
+  EXPECT_EQ(collector.paths().size(), 100u);
+}
+
+TEST(DirectoryScan, PausedScanLeavesThePoolFree) {
+  Tree tree(0);
+  tree.AddBinaries(20);
+  ThreadPool pool(1);
+  Collector collector;
+  std::atomic<int> reads{0};
+  ScanOptions options;
+  options.batch_size = 1;
+  options.max_unacknowledged_batches = 1;
+  DirectoryScan scan(&pool, options, CountingReader(&reads), collector.sink());
+  scan.Start(tree.root());
+  collector.WaitForBatches(1);
+
+  // The only worker is not held while the scan waits for credit.
+  std::mutex mutex;
+  std::condition_variable ran_changed;
+  bool ran = false;
+  pool.Post([&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    ran = true;
+    ran_changed.notify_all();
+  });
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_TRUE(ran_changed.wait_for(lock, std::chrono::seconds(5),
+                                     [&] { return ran; }));
+  }
+  EXPECT_EQ(reads, 1);
+
+  for (int i = 0; i < 1000 && collector.batches() < 21; ++i) {
+    scan.Acknowledge();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ScanSummary summary = collector.WaitForSummary();
+  EXPECT_EQ(summary.binaries, 20u);
+  EXPECT_EQ(summary.files, 20u);
+  EXPECT_EQ(collector.paths().size(), 20u);
+}
+
+TEST(DirectoryScan, CancelResumesAScanPausedInsideADirectory) {
+  Tree tree(0);
+  tree.AddBinaries(20);
+  ThreadPool pool(1);
+  Collector collector;
+  std::atomic<int> reads{0};
+  ScanOptions options;
+  options.batch_size = 1;
+  options.max_unacknowledged_batches = 1;
+  DirectoryScan scan(&pool, options, CountingReader(&reads), collector.sink());
+  scan.Start(tree.root());
+  collector.WaitForBatches(1);
+
+  scan.Cancel();
+  ScanSummary summary = collector.WaitForSummary();
+  EXPECT_TRUE(summary.cancelled);
+  EXPECT_EQ(reads, 1);
+}
+
+TEST(DirectoryScan, DeliversABatchOnceItsIntervalPasses) {
+  Tree tree(0);
+  tree.AddBinaries(2);
+  ThreadPool pool(2);
+  Collector collector;
+  std::atomic<int> reads{0};
+  ScanOptions options;
+  options.batch_interval = std::chrono::milliseconds(10);
+  // The second read only returns once the first binary has been delivered
+  // on its own, long before the walk can end.
+  DirectoryScan scan(
+      &pool, options,
+      [&](const std::string&, BinaryFormat) {
+        if (reads++ > 0) {
+          collector.WaitForBatches(1);
+        }
+        return BinaryMetadata();
+      },
+      collector.sink());
+  auto started = std::chrono::steady_clock::now();
+  scan.Start(tree.root());
+
+  ScanSummary summary = collector.WaitForSummary();
+  EXPECT_LT(std::chrono::steady_clock::now() - started,
+            std::chrono::seconds(5));
+  EXPECT_EQ(summary.binaries, 2u);
+  EXPECT_GE(collector.batches(), 2u);
+  EXPECT_EQ(collector.paths().size(), 2u);
+}
+
+TEST(DirectoryScan, CancelDeliversFinalSummary) {
+  Tree tree(10);
+  ThreadPool pool(2);
+  Collector collector;
+  std::atomic<int> reads{0};
+  ScanOptions options;
+  options.batch_size = 1;
+  options.max_unacknowledged_batches = 1;
+  DirectoryScan scan(&pool, options, CountingReader(&reads), collector.sink());
+  scan.Start(tree.root());
+  collector.WaitForBatches(1);
+
+  scan.Cancel();
+  ScanSummary summary = collector.WaitForSummary();
+  EXPECT_TRUE(summary.cancelled);
+  EXPECT_LT(summary.binaries, 20u);
+}
+
+TEST(DirectoryScan, ReportsUnreadableRoot) {
+  ThreadPool pool(1);
+  Collector collector;
+  std::atomic<int> reads{0};
+  DirectoryScan scan(&pool, ScanOptions(), CountingReader(&reads),
+                     collector.sink());
+  scan.Start(testing::TempPath("no_such_directory"));
+  ScanSummary summary = collector.WaitForSummary();
+  EXPECT_TRUE(summary.root_failed);
+  EXPECT_EQ(summary.errors, 1u);
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "elf_image.h"
+#include "elf_metadata.h"
+#include "testing/elf_builder.h"
+#include "testing/pe_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::ElfBuilder;
+
+std::string ToString(ByteView view) {
+  return std::string(reinterpret_cast<const char*>(view.data), view.size);
+}
+
+ElfBuilder LibraryBuilder() {
+  return ElfBuilder()
+      .SetBuildId({0xDE, 0xAD, 0xBE, 0xEF, 0x01, 0x02})
+      .SetSoname("libfixture.so.3")
+      .AddNeeded("libc.so.6")
+      .AddNeeded("libm.so.6")
+      .AddVersionDefinition("FIXTURE_3.0")
+      .AddVersionDefinition("FIXTURE_3.1")
+      .AddVersionDefinition("FIXTURE_PRIVATE")
+      .AddComment("GCC: (GNU) 12.2.0")
+      .AddComment("clang version 17.0.6")
+      .AddComment("GCC: (GNU) 12.2.0");
+}
+
+BinaryMetadata ReadFields(const std::vector<uint8_t>& bytes,
+                          const std::vector<std::string>& fields) {
+  ElfImage image;
+  BinaryMetadata metadata;
+  if (image.Parse(ByteView(bytes.data(), bytes.size()))) {
+    ReadElfMetadata(image, MetadataRequest::Only(fields), &metadata);
+  }
+  return metadata;
+}
+
+}  // namespace
+
+TEST(ElfImage, RejectsNonElfInput) {
+  std::vector<uint8_t> bytes(64, 0);
+  ElfImage image;
+  EXPECT_FALSE(image.Parse(ByteView(bytes.data(), bytes.size())));
+
+  bytes[0] = 0x7F;
+  bytes[1] = 'E';
+  bytes[2] = 'L';
+  bytes[3] = 'F';
+  bytes[4] = 3;  // No such class.
+  bytes[5] = 1;
+  EXPECT_FALSE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  EXPECT_FALSE(image.Parse(ByteView(bytes.data(), 16)));
+}
+
+TEST(ElfImage, ReadsEveryClassAndByteOrder) {
+  for (bool is_64bit : {false, true}) {
+    for (bool big_endian : {false, true}) {
+      std::vector<uint8_t> bytes = LibraryBuilder()
+                                       .Set64Bit(is_64bit)
+                                       .SetBigEndian(big_endian)
+                                       .SetMachine(183)
+                                       .Build();
+      ElfImage image;
+      ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+      EXPECT_EQ(image.is_64bit(), is_64bit);
+      EXPECT_EQ(image.is_big_endian(), big_endian);
+      EXPECT_EQ(image.type(), kElfTypeShared);
+      EXPECT_EQ(image.machine(), 183);
+
+      ByteView build_id = image.FindBuildId();
+      ASSERT_EQ(build_id.size, 6u);
+      EXPECT_EQ(build_id.data[0], 0xDE);
+
+      ElfDynamicInfo dynamic;
+      ASSERT_TRUE(image.ReadDynamic(&dynamic));
+      EXPECT_EQ(ToString(dynamic.soname), "libfixture.so.3");
+      ASSERT_EQ(dynamic.needed.size(), 2u);
+      EXPECT_EQ(ToString(dynamic.needed[0]), "libc.so.6");
+      EXPECT_EQ(ToString(dynamic.needed[1]), "libm.so.6");
+      ASSERT_EQ(dynamic.version_definitions.size(), 3u);
+      EXPECT_EQ(ToString(dynamic.version_definitions[1]), "FIXTURE_3.1");
+      EXPECT_FALSE(dynamic.position_independent_executable);
+
+      std::vector<ByteView> comments;
+      image.ReadComments(&comments);
+      ASSERT_EQ(comments.size(), 2u);
+      EXPECT_EQ(ToString(comments[1]), "clang version 17.0.6");
+    }
+  }
+}
+
+TEST(ElfImage, FallsBackToSegmentsWithoutSectionTable) {
+  std::vector<uint8_t> bytes = LibraryBuilder().StripSectionTable().Build();
+  ElfImage image;
+  ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  EXPECT_EQ(image.section_count(), 0u);
+  EXPECT_EQ(image.FindBuildId().size, 6u);
+
+  ElfDynamicInfo dynamic;
+  ASSERT_TRUE(image.ReadDynamic(&dynamic));
+  EXPECT_EQ(ToString(dynamic.soname), "libfixture.so.3");
+
+  std::vector<ByteView> comments;
+  image.ReadComments(&comments);
+  EXPECT_TRUE(comments.empty());
+}
+
+TEST(ElfImage, ToleratesTruncatedTables) {
+  std::vector<uint8_t> bytes = LibraryBuilder().Build();
+  for (size_t size = 0; size < bytes.size(); size += 7) {
+    ElfImage image;
+    if (!image.Parse(ByteView(bytes.data(), size))) {
+      continue;
+    }
+    ElfDynamicInfo dynamic;
+    image.ReadDynamic(&dynamic);
+    std::vector<ByteView> comments;
+    image.ReadComments(&comments);
+    image.FindBuildId();
+  }
+}
+
+TEST(ElfMetadata, MapsStandardAndElfFields) {
+  BinaryMetadata metadata = ReadFields(
+      LibraryBuilder().Build(),
+      {"version", "originalFilename", "fileDescription", "companyName",
+       "buildId", "needed", "comment", "elfClass", "machine", "elfType"});
+
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  EXPECT_EQ(metadata.fields["version"], "3.1");
+  EXPECT_EQ(metadata.fields["originalFilename"], "libfixture.so.3");
+  EXPECT_EQ(metadata.fields["fileDescription"], "ELF 64-bit x86-64 shared object");
+  EXPECT_EQ(metadata.fields["companyName"], "");
+  EXPECT_EQ(metadata.fields["buildId"], "deadbeef0102");
+  EXPECT_EQ(metadata.fields["needed"], "libc.so.6,libm.so.6");
+  EXPECT_EQ(metadata.fields["comment"],
+            "GCC: (GNU) 12.2.0\nclang version 17.0.6");
+  EXPECT_EQ(metadata.fields["elfClass"], "ELF64");
+  EXPECT_EQ(metadata.fields["machine"], "x86-64");
+  EXPECT_EQ(metadata.fields["elfType"], "shared object");
+}
+
+TEST(ElfMetadata, PrefersPackageMetadataForVersion) {
+  BinaryMetadata metadata = ReadFields(
+      LibraryBuilder()
+          .SetPackageMetadata(
+              R"({"type":"deb","name":"fixture","version":"3.1.4-1"})")
+          .Build(),
+      {"version", "productName"});
+  EXPECT_EQ(metadata.fields["version"], "3.1.4-1");
+  EXPECT_EQ(metadata.fields["productName"], "fixture");
+
+  metadata = ReadFields(ElfBuilder().SetSoname("libplain.so.2.5").Build(),
+                        {"version"});
+  EXPECT_EQ(metadata.fields["version"], "2.5");
+
+  metadata = ReadFields(ElfBuilder().SetSoname("libplain.so").Build(),
+                        {"version"});
+  EXPECT_EQ(metadata.fields.count("version"), 0u);
+}
+
+TEST(ElfMetadata, DescribesPositionIndependentExecutables) {
+  BinaryMetadata metadata = ReadFields(
+      ElfBuilder().SetPie(true).Set64Bit(false).SetMachine(40).Build(),
+      {"fileDescription", "elfType"});
+  EXPECT_EQ(metadata.fields["fileDescription"], "ELF 32-bit ARM executable");
+  EXPECT_EQ(metadata.fields["elfType"], "executable");
+}
+
+TEST(ElfMetadata, ReadsFilesFromDisk) {
+  std::string path = testing::TempPath("fixture.so");
+  ASSERT_TRUE(testing::WriteFile(path, LibraryBuilder().Build()));
+
+  BinaryMetadata metadata =
+      ReadBinaryMetadata(path, MetadataRequest::Standard({"buildId"}));
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  EXPECT_EQ(metadata.fields["version"], "3.1");
+  EXPECT_EQ(metadata.fields["originalFilename"], "libfixture.so.3");
+  EXPECT_EQ(metadata.fields["buildId"], "deadbeef0102");
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace flutter_bin
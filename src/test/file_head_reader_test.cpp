@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "file_head_reader.h"
+#include "testing/elf_builder.h"
+#include "testing/pe_builder.h"
+#include "thread_pool.h"
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+using testing::VersionInfoBuilder;
+
+// More than two groups of every kind of file the readers tell apart.
+class MixedFiles {
+ public:
+  MixedFiles() {
+    directory_ = testing::TempPath("heads.dir");
+#if defined(_WIN32)
+    _mkdir(directory_.c_str());
+#else
+    mkdir(directory_.c_str(), 0700);
+#endif
+    for (size_t i = 0; i < 3 * FileHeadReader::kGroupSize; ++i) {
+      std::string path =
+          testing::TempPath("heads_" + std::to_string(i) + ".bin");
+      switch (i % 6) {
+        case 0:
+        case 1:
+          PeBuilder()
+              .AddSection(".text", 512)
+              .AddVersionResource(
+                  VersionInfoBuilder()
+                      .SetFileVersion(1, 2, 3, static_cast<uint16_t>(i))
+                      .AddStringTable(0x040904B0,
+                                      {{u"ProductName", u"Heads"}})
+                      .AddTranslation(0x040904B0)
+                      .Build())
+              // Some resources end past the first page.
+              .SetOverlaySize(i % 12 == 0 ? 64 * 1024 : 0)
+              .WriteTo(path);
+          break;
+        case 2:
+          testing::WriteFile(
+              path, testing::ElfBuilder().SetSoname("libheads.so.1").Build());
+          break;
+        case 3:
+          testing::WriteFile(path, {});
+          break;
+        case 4:
+          // Never written.
+          break;
+        case 5:
+          paths_.push_back(directory_);
+          continue;
+      }
+      written_.push_back(path);
+      paths_.push_back(path);
+    }
+  }
+
+  ~MixedFiles() {
+    for (const std::string& path : written_) {
+      std::remove(path.c_str());
+    }
+#if defined(_WIN32)
+    _rmdir(directory_.c_str());
+#else
+    rmdir(directory_.c_str());
+#endif
+  }
+
+  const std::vector<std::string>& paths() const { return paths_; }
+
+ private:
+  std::string directory_;
+  std::vector<std::string> written_;
+  std::vector<std::string> paths_;
+};
+
+std::vector<FileHeadBackend> SupportedBackends() {
+  std::vector<FileHeadBackend> backends;
+  for (FileHeadBackend backend :
+       {FileHeadBackend::kThreadPool, FileHeadBackend::kIoUring}) {
+    if (FileHeadBackendSupported(backend)) {
+      backends.push_back(backend);
+    }
+  }
+  return backends;
+}
+
+}  // namespace
+
+TEST(FileHeadReader, MatchesThePerFileRead) {
+  MixedFiles files;
+  ThreadPool pool(4);
+  for (const MetadataRequest& request :
+       {MetadataRequest::Standard(), MetadataRequest::Only({"sha256"})}) {
+    for (FileHeadBackend backend : SupportedBackends()) {
+      SCOPED_TRACE(FileHeadBackendName(backend));
+      FileHeadReader reader(&pool, backend);
+      EXPECT_EQ(reader.backend(), backend);
+      std::vector<BinaryMetadata> results(files.paths().size());
+      std::vector<int> calls(files.paths().size());
+      reader.Read(files.paths(), [&](size_t i, FileHead* head) {
+        ++calls[i];
+        results[i] = ReadBinaryMetadata(head, request);
+      });
+      for (size_t i = 0; i < files.paths().size(); ++i) {
+        BinaryMetadata expected = ReadBinaryMetadata(files.paths()[i], request);
+        EXPECT_EQ(calls[i], 1);
+        EXPECT_EQ(results[i].error, expected.error) << files.paths()[i];
+        EXPECT_EQ(results[i].fields, expected.fields) << files.paths()[i];
+        EXPECT_EQ(results[i].bytes_read, 0u);
+      }
+    }
+  }
+}
+
+TEST(FileHeadReader, HoldsTheFirstPage) {
+  std::string path = testing::TempPath("head.bin");
+  std::vector<uint8_t> bytes(FileHead::kSize + 100);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 3);
+  }
+  ASSERT_TRUE(testing::WriteFile(path, bytes));
+  ThreadPool pool(2);
+  for (FileHeadBackend backend : SupportedBackends()) {
+    SCOPED_TRACE(FileHeadBackendName(backend));
+    FileHeadReader reader(&pool, backend);
+    reader.Read({path}, [&](size_t, FileHead* head) {
+      ASSERT_EQ(head->error(), PositionedFile::Error::kNone);
+      EXPECT_EQ(head->size(), bytes.size());
+      ASSERT_EQ(head->head().size, FileHead::kSize);
+      EXPECT_EQ(head->head().data[FileHead::kSize - 1],
+                bytes[FileHead::kSize - 1]);
+      // Past the head, reads go to the file.
+      uint8_t tail[200] = {};
+      size_t read = 0;
+      ASSERT_TRUE(head->ReadAt(FileHead::kSize - 100, tail, sizeof(tail),
+                               &read));
+      EXPECT_EQ(read, 200u);
+      EXPECT_EQ(tail[199], bytes.back());
+    });
+  }
+  std::remove(path.c_str());
+}
+
+TEST(FileHeadReader, StopsOpeningOnceCancelled) {
+  MixedFiles files;
+  ThreadPool pool(2);
+  for (FileHeadBackend backend : SupportedBackends()) {
+    SCOPED_TRACE(FileHeadBackendName(backend));
+    FileHeadReader reader(&pool, backend);
+    std::atomic<bool> cancelled{false};
+    std::atomic<size_t> calls{0};
+    reader.Read(
+        files.paths(),
+        [&](size_t, FileHead*) {
+          ++calls;
+          cancelled = true;
+        },
+        &cancelled);
+    // At most the group being read and the one opened behind it.
+    EXPECT_GE(calls.load(), 1u);
+    EXPECT_LE(calls.load(), 2 * FileHeadReader::kGroupSize);
+    EXPECT_LT(calls.load(), files.paths().size());
+  }
+}
+
+}  // namespace test
+}  // namespace flutter_bin
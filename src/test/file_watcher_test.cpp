@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "directory_list.h"
+#include "file_watcher.h"
+#include "testing/pe_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+using testing::VersionInfoBuilder;
+
+std::vector<uint8_t> PeWithVersion(uint16_t minor) {
+  return PeBuilder()
+      .AddVersionResource(VersionInfoBuilder()
+                              .SetFileVersion(1, minor, 0, 0)
+                              .AddStringTable(0x040904B0,
+                                              {{u"ProductName", u"Watched"}})
+                              .AddTranslation(0x040904B0)
+                              .Build())
+      .Build();
+}
+
+void MakeDirectory(const std::string& path) {
+#if defined(_WIN32)
+  _mkdir(path.c_str());
+#else
+  ::mkdir(path.c_str(), 0700);
+#endif
+}
+
+// Collects every event and counts reads.
+class Collector {
+ public:
+  FileWatcher::Reader reader() {
+    return [this](const std::string& path, BinaryFormat) {
+      ++reads_;
+      return ReadBinaryMetadata(path, MetadataRequest::Standard());
+    };
+  }
+
+  FileWatcher::Sink sink() {
+    return [this](std::vector<WatchEvent> events) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (WatchEvent& event : events) {
+        events_.push_back(std::move(event));
+      }
+      changed_.notify_all();
+    };
+  }
+
+  // Waits until |count| events have arrived in total.
+  std::vector<WatchEvent> WaitForEvents(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    EXPECT_TRUE(changed_.wait_for(lock, std::chrono::seconds(10),
+                                  [&] { return events_.size() >= count; }))
+        << "got " << events_.size() << " of " << count << " events";
+    return events_;
+  }
+
+  int reads() const { return reads_; }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::vector<WatchEvent> events_;
+  std::atomic<int> reads_{0};
+};
+
+WatchOptions FastOptions() {
+  WatchOptions options;
+  options.settle_delay = std::chrono::milliseconds(100);
+  return options;
+}
+
+// A fresh directory, removed with what the test left in it.
+class WatchedDirectory {
+ public:
+  WatchedDirectory() : root_(testing::TempPath("watch")) { MakeDirectory(root_); }
+  ~WatchedDirectory() { Remove(root_); }
+
+  const std::string& root() const { return root_; }
+  std::string Path(const std::string& name) const {
+    return JoinPath(root_, name);
+  }
+
+ private:
+  static void Remove(const std::string& path) {
+    std::vector<DirectoryEntry> entries;
+    if (ListDirectory(path, &entries)) {
+      for (const DirectoryEntry& entry : entries) {
+        Remove(JoinPath(path, entry.name));
+      }
+#if defined(_WIN32)
+      _rmdir(path.c_str());
+#else
+      ::rmdir(path.c_str());
+#endif
+      return;
+    }
+    std::remove(path.c_str());
+  }
+
+  std::string root_;
+};
+
+std::string Version(const WatchEvent& event) {
+  auto it = event.metadata.fields.find(kVersionKey);
+  return it != event.metadata.fields.end() ? it->second : "";
+}
+
+}  // namespace
+
+TEST(FileWatcher, ReportsAddedModifiedAndRemovedBinaries) {
+  if (!FileWatcher::Supported()) {
+    GTEST_SKIP() << "No change notifications on this host";
+  }
+  WatchedDirectory dir;
+  Collector collector;
+  FileWatcher watcher(FastOptions(), collector.reader(), collector.sink());
+  std::vector<std::string> failed;
+  ASSERT_TRUE(watcher.Start({dir.root()}, &failed));
+  EXPECT_TRUE(failed.empty());
+
+  std::string path = dir.Path("app.exe");
+  testing::WriteFile(path, PeWithVersion(1));
+  std::vector<WatchEvent> events = collector.WaitForEvents(1);
+  EXPECT_EQ(events[0].path, path);
+  EXPECT_EQ(events[0].change, WatchChange::kAdded);
+  EXPECT_EQ(events[0].format, BinaryFormat::kPe);
+  EXPECT_EQ(Version(events[0]), "1.1.0.0");
+
+  testing::WriteFile(path, PeWithVersion(2));
+  events = collector.WaitForEvents(2);
+  EXPECT_EQ(events[1].change, WatchChange::kModified);
+  EXPECT_EQ(Version(events[1]), "1.2.0.0");
+
+  std::remove(path.c_str());
+  events = collector.WaitForEvents(3);
+  EXPECT_EQ(events[2].path, path);
+  EXPECT_EQ(events[2].change, WatchChange::kRemoved);
+  EXPECT_EQ(events[2].format, BinaryFormat::kPe);
+  EXPECT_EQ(collector.reads(), 2);
+}
+
+TEST(FileWatcher, CoalescesBurstsAndSkipsWhatDidNotChange) {
+  if (!FileWatcher::Supported()) {
+    GTEST_SKIP() << "No change notifications on this host";
+  }
+  WatchedDirectory dir;
+  Collector collector;
+  FileWatcher watcher(FastOptions(), collector.reader(), collector.sink());
+  std::vector<std::string> failed;
+  ASSERT_TRUE(watcher.Start({dir.root()}, &failed));
+
+  // An installer writing in chunks, faster than the settle delay.
+  std::string path = dir.Path("setup.dll");
+  std::vector<uint8_t> bytes = PeWithVersion(3);
+  FILE* file = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  const size_t chunk = bytes.size() / 8 + 1;
+  for (size_t offset = 0; offset < bytes.size(); offset += chunk) {
+    std::fwrite(bytes.data() + offset, 1,
+                std::min(chunk, bytes.size() - offset), file);
+    std::fflush(file);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::fclose(file);
+  // A temporary file that is gone again before it settles, and a file that
+  // is not a binary.
+  std::string temporary = dir.Path("setup.tmp");
+  testing::WriteFile(temporary, PeWithVersion(4));
+  std::remove(temporary.c_str());
+  testing::WriteFile(dir.Path("readme.txt"), {'h', 'i'});
+
+  std::vector<WatchEvent> events = collector.WaitForEvents(1);
+  EXPECT_EQ(events[0].path, path);
+  EXPECT_EQ(events[0].change, WatchChange::kAdded);
+  EXPECT_EQ(Version(events[0]), "1.3.0.0");
+
+  // Only the attributes change, then a second binary marks the end.
+#if !defined(_WIN32)
+  ::chmod(path.c_str(), 0755);
+#endif
+  std::string marker = dir.Path("marker.exe");
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  testing::WriteFile(marker, PeWithVersion(5));
+  events = collector.WaitForEvents(2);
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[1].path, marker);
+  EXPECT_EQ(collector.reads(), 2);
+}
+
+TEST(FileWatcher, FollowsSubdirectories) {
+  if (!FileWatcher::Supported()) {
+    GTEST_SKIP() << "No change notifications on this host";
+  }
+  WatchedDirectory dir;
+  WatchedDirectory elsewhere;
+  Collector collector;
+  FileWatcher watcher(FastOptions(), collector.reader(), collector.sink());
+  std::vector<std::string> failed;
+  ASSERT_TRUE(watcher.Start({dir.root()}, &failed));
+
+  std::string sub = dir.Path("sub");
+  MakeDirectory(sub);
+  MakeDirectory(JoinPath(sub, "bin"));
+  std::string path = JoinPath(JoinPath(sub, "bin"), "tool.exe");
+  testing::WriteFile(path, PeWithVersion(6));
+  std::vector<WatchEvent> events = collector.WaitForEvents(1);
+  EXPECT_EQ(events[0].path, path);
+  EXPECT_EQ(events[0].change, WatchChange::kAdded);
+
+  // Moving the directory out removes what was reported inside it.
+  std::string moved = elsewhere.Path("sub");
+  ASSERT_EQ(std::rename(sub.c_str(), moved.c_str()), 0);
+  events = collector.WaitForEvents(2);
+  EXPECT_EQ(events[1].path, path);
+  EXPECT_EQ(events[1].change, WatchChange::kRemoved);
+}
+
+TEST(FileWatcher, WatchesSingleFiles) {
+  if (!FileWatcher::Supported()) {
+    GTEST_SKIP() << "No change notifications on this host";
+  }
+  WatchedDirectory dir;
+  Collector collector;
+  FileWatcher watcher(FastOptions(), collector.reader(), collector.sink());
+  std::string path = dir.Path("later.exe");
+  std::string missing = JoinPath(dir.Path("missing"), "app.exe");
+  std::vector<std::string> failed;
+  // The file does not exist yet; its parent does.
+  ASSERT_TRUE(watcher.Start({path, missing}, &failed));
+  EXPECT_EQ(failed, std::vector<std::string>{missing});
+
+  testing::WriteFile(dir.Path("other.exe"), PeWithVersion(7));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  testing::WriteFile(path, PeWithVersion(8));
+  std::vector<WatchEvent> events = collector.WaitForEvents(1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  events = collector.WaitForEvents(1);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].path, path);
+  EXPECT_EQ(collector.reads(), 1);
+}
+
+TEST(FileWatcher, StopLeavesARunningReadAndSendsNothingMore) {
+  if (!FileWatcher::Supported()) {
+    GTEST_SKIP() << "No change notifications on this host";
+  }
+  WatchedDirectory dir;
+  Collector collector;
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool reading = false;
+  bool release = false;
+  FileWatcher::Reader blocking_reader = [&](const std::string& path,
+                                            BinaryFormat) {
+    std::unique_lock<std::mutex> lock(mutex);
+    reading = true;
+    changed.notify_all();
+    changed.wait(lock, [&] { return release; });
+    return ReadBinaryMetadata(path, MetadataRequest::Standard());
+  };
+  auto watcher = std::make_unique<FileWatcher>(
+      FastOptions(), blocking_reader, collector.sink());
+  std::vector<std::string> failed;
+  ASSERT_TRUE(watcher->Start({dir.root()}, &failed));
+
+  testing::WriteFile(dir.Path("app.exe"), PeWithVersion(1));
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(changed.wait_for(lock, std::chrono::seconds(10),
+                                 [&] { return reading; }));
+  }
+  // Returns while the read is still blocked.
+  watcher->Stop();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  changed.notify_all();
+  watcher.reset();
+  EXPECT_TRUE(collector.WaitForEvents(0).empty());
+}
+
+TEST(FileWatcher, FailsWithoutAnythingToWatch) {
+  Collector collector;
+  FileWatcher watcher(FastOptions(), collector.reader(), collector.sink());
+  std::string missing = testing::TempPath("missing") + "/app.exe";
+  std::vector<std::string> failed;
+  EXPECT_FALSE(watcher.Start({missing}, &failed));
+  EXPECT_EQ(failed, std::vector<std::string>{missing});
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "byte_view.h"
+#include "flat_metadata.h"
+#include "testing/allocation_counter.h"
+#include "testing/pe_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+using testing::VersionInfoBuilder;
+
+// Decodes a buffer the way the Dart side does, checking every range.
+struct Decoded {
+  std::map<std::string, std::string> fields;
+  std::string error;
+};
+
+bool Decode(const std::vector<uint8_t>& buffer, Decoded* decoded) {
+  ByteView view(buffer.data(), buffer.size());
+  if (!view.Contains(0, kFlatMetadataHeaderSize) ||
+      LoadLe32(view.data) != kFlatMetadataMagic ||
+      LoadLe32(view.data + 4) != buffer.size()) {
+    return false;
+  }
+  auto string_at = [&view](const uint8_t* p, std::string* out) {
+    ByteView bytes = view.Sub(LoadLe32(p), LoadLe32(p + 4));
+    if (bytes.data == nullptr && LoadLe32(p + 4) != 0) {
+      return false;
+    }
+    out->assign(reinterpret_cast<const char*>(bytes.data), bytes.size);
+    return true;
+  };
+  uint32_t count = LoadLe32(view.data + 8);
+  if (!view.Contains(kFlatMetadataHeaderSize,
+                     count * kFlatMetadataEntrySize) ||
+      !string_at(view.data + 12, &decoded->error)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint8_t* entry =
+        view.data + kFlatMetadataHeaderSize + i * kFlatMetadataEntrySize;
+    std::string key;
+    std::string value;
+    if (!string_at(entry, &key) || !string_at(entry + 8, &value)) {
+      return false;
+    }
+    decoded->fields[key] = value;
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(FlatMetadata, WritesFieldsAndGrowsOnRequest) {
+  BinaryMetadata metadata;
+  metadata.fields["version"] = "1.2.3.4";
+  metadata.fields["productName"] = "Example";
+  metadata.fields["legalCopyright"] = "";
+
+  // Too small: nothing is written, the needed size is returned.
+  std::vector<uint8_t> buffer(kFlatMetadataHeaderSize, 0xAA);
+  size_t size = WriteFlatMetadata(metadata, buffer.data(), buffer.size());
+  EXPECT_EQ(size, kFlatMetadataHeaderSize + 3 * kFlatMetadataEntrySize +
+                      7 + 7 + 11 + 7 + 14);
+  EXPECT_EQ(buffer, std::vector<uint8_t>(kFlatMetadataHeaderSize, 0xAA));
+  EXPECT_EQ(WriteFlatMetadata(metadata, nullptr, 0), size);
+
+  buffer.resize(size);
+  ASSERT_EQ(WriteFlatMetadata(metadata, buffer.data(), buffer.size()), size);
+  Decoded decoded;
+  ASSERT_TRUE(Decode(buffer, &decoded));
+  EXPECT_EQ(decoded.fields, metadata.fields);
+  EXPECT_EQ(decoded.error, "");
+}
+
+TEST(FlatMetadata, ReportsTheErrorCode) {
+  BinaryMetadata metadata;
+  metadata.error = MetadataError::kNoVersionInfo;
+  std::vector<uint8_t> buffer(64);
+  buffer.resize(WriteFlatMetadata(metadata, buffer.data(), buffer.size()));
+  Decoded decoded;
+  ASSERT_TRUE(Decode(buffer, &decoded));
+  EXPECT_TRUE(decoded.fields.empty());
+  EXPECT_EQ(decoded.error, "NO_VERSION_INFO");
+}
+
+TEST(FlatMetadata, ReadsFilesThroughTheCAbi) {
+  std::string path = testing::TempPath("flat.exe");
+  ASSERT_TRUE(PeBuilder()
+                  .AddVersionResource(
+                      VersionInfoBuilder()
+                          .SetFileVersion(3, 1, 0, 9)
+                          .AddStringTable(0x040904B0,
+                                          {{u"CompanyName", u"Flat Inc."},
+                                           {u"InternalName", u"flat"}})
+                          .AddTranslation(0x040904B0)
+                          .Build())
+                  .WriteTo(path));
+
+  std::vector<uint8_t> buffer(16);
+  int64_t size = ReadFlatMetadata(path.c_str(), nullptr, 0, buffer.data(),
+                                  buffer.size());
+  ASSERT_GT(size, 16);
+  buffer.resize(static_cast<size_t>(size));
+  ASSERT_EQ(ReadFlatMetadata(path.c_str(), nullptr, 0, buffer.data(),
+                             buffer.size()),
+            size);
+  Decoded all;
+  ASSERT_TRUE(Decode(buffer, &all));
+  EXPECT_EQ(all.fields.size(), 6u);
+  EXPECT_EQ(all.fields["version"], "3.1.0.9");
+  EXPECT_EQ(all.fields["companyName"], "Flat Inc.");
+
+  const char* fields[] = {"version", "InternalName"};
+  buffer.assign(256, 0);
+  size = ReadFlatMetadata(path.c_str(), fields, 2, buffer.data(),
+                          buffer.size());
+  ASSERT_LE(size, 256);
+  buffer.resize(static_cast<size_t>(size));
+  Decoded only;
+  ASSERT_TRUE(Decode(buffer, &only));
+  EXPECT_EQ(only.fields,
+            (std::map<std::string, std::string>{{"InternalName", "flat"},
+                                                {"version", "3.1.0.9"}}));
+  std::remove(path.c_str());
+
+  buffer.assign(256, 0);
+  size = ReadFlatMetadata(path.c_str(), nullptr, 0, buffer.data(),
+                          buffer.size());
+  buffer.resize(static_cast<size_t>(size));
+  Decoded missing;
+  ASSERT_TRUE(Decode(buffer, &missing));
+  EXPECT_EQ(missing.error, "FILE_NOT_FOUND");
+
+  const char* null_field[] = {nullptr};
+  EXPECT_EQ(ReadFlatMetadata(nullptr, nullptr, 0, buffer.data(), 0), -1);
+  EXPECT_EQ(ReadFlatMetadata(path.c_str(), null_field, 1, buffer.data(), 0),
+            -1);
+}
+
+TEST(FlatMetadata, AllocatesNothingOnceWarm) {
+  std::string path = testing::TempPath("flat_warm.exe");
+  ASSERT_TRUE(PeBuilder()
+                  .AddVersionResource(
+                      VersionInfoBuilder()
+                          .SetFileVersion(3, 1, 0, 9)
+                          .AddStringTable(0x040904B0,
+                                          {{u"CompanyName", u"Flat Inc."}})
+                          .AddTranslation(0x040904B0)
+                          .Build())
+                  .WriteTo(path));
+  std::vector<uint8_t> buffer(4096);
+  const char* fields[] = {"version", "companyName"};
+  for (size_t field_count : {size_t{0}, size_t{2}}) {
+    ASSERT_GT(ReadFlatMetadata(path.c_str(), fields, field_count,
+                               buffer.data(), buffer.size()),
+              0);
+    uint64_t allocations = testing::ThreadAllocationCount();
+    for (int i = 0; i < 100; ++i) {
+      ReadFlatMetadata(path.c_str(), fields, field_count, buffer.data(),
+                       buffer.size());
+    }
+    EXPECT_EQ(testing::ThreadAllocationCount() - allocations, 0u)
+        << field_count << " fields";
+  }
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "macho_image.h"
+#include "macho_metadata.h"
+#include "testing/macho_builder.h"
+#include "testing/pe_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::MachOBuilder;
+using testing::MachOFatSlice;
+
+constexpr uint32_t kCommandVersionMinIOS = 0x25;
+
+constexpr uint32_t Version(uint32_t x, uint32_t y, uint32_t z = 0) {
+  return (x << 16) | (y << 8) | z;
+}
+
+std::string ToString(ByteView view) {
+  return std::string(reinterpret_cast<const char*>(view.data), view.size);
+}
+
+const char kInfoPlist[] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<!DOCTYPE plist PUBLIC "-//Apple//DTD PLIST 1.0//EN" "http://www.apple.com/DTDs/PropertyList-1.0.dtd">
+<plist version="1.0">
+<dict>
+  <key>CFBundleDocumentTypes</key>
+  <array>
+    <dict>
+      <key>CFBundleName</key>
+      <string>Nested</string>
+    </dict>
+  </array>
+  <!-- <key>CFBundleName</key><string>Commented</string> -->
+  <key>CFBundleExecutable</key>
+  <string>fixturetool</string>
+  <key>CFBundleIdentifier</key>
+  <string>com.example.fixturetool</string>
+  <key>CFBundleName</key>
+  <string>Fixture &amp; Tool</string>
+  <key>CFBundleShortVersionString</key>
+  <string>2.4.1</string>
+  <key>CFBundleVersion</key>
+  <string>241</string>
+  <key>LSUIElement</key>
+  <true/>
+  <key>NSHumanReadableCopyright</key>
+  <string>&#169; 2024 Example&#x2122;</string>
+</dict>
+</plist>
+)";
+
+MachOBuilder ToolBuilder() {
+  return MachOBuilder()
+      .SetUuid({0x1A, 0x2B, 0x3C, 0x4D, 0x5E, 0x6F, 0x70, 0x81, 0x92, 0xA3,
+                0xB4, 0xC5, 0xD6, 0xE7, 0xF8, 0x09})
+      .SetBuildVersion(MachOImage::kPlatformMacOS, Version(11, 0),
+                       Version(14, 2, 1))
+      .SetInfoPlist(kInfoPlist);
+}
+
+MachOBuilder LibraryBuilder() {
+  return MachOBuilder()
+      .SetFileType(kMachOTypeDylib)
+      .SetDylibId("@rpath/libfixture.3.dylib", Version(3, 1, 4),
+                  Version(3, 0));
+}
+
+BinaryMetadata ReadFields(const std::vector<uint8_t>& bytes,
+                          const std::vector<std::string>& fields) {
+  std::vector<MachOSlice> slices;
+  BinaryMetadata metadata;
+  if (ReadMachOSlices(ByteView(bytes.data(), bytes.size()), &slices)) {
+    ReadMachOMetadata(slices, MetadataRequest::Only(fields), &metadata);
+  } else {
+    metadata.error = MetadataError::kUnsupportedFormat;
+  }
+  return metadata;
+}
+
+}  // namespace
+
+TEST(MachOImage, RejectsNonMachOInput) {
+  std::vector<uint8_t> bytes(64, 0);
+  std::vector<MachOSlice> slices;
+  EXPECT_FALSE(ReadMachOSlices(ByteView(bytes.data(), bytes.size()), &slices));
+
+  // A Java class file shares the universal binary magic.
+  bytes = {0xCA, 0xFE, 0xBA, 0xBE, 0x00, 0x00, 0x00, 0x34};
+  bytes.resize(64);
+  EXPECT_FALSE(ReadMachOSlices(ByteView(bytes.data(), bytes.size()), &slices));
+
+  bytes = ToolBuilder().Build();
+  MachOImage image;
+  EXPECT_FALSE(image.Parse(ByteView(bytes.data(), 20)));
+}
+
+TEST(MachOImage, ReadsEveryWordSizeAndByteOrder) {
+  for (bool is_64bit : {false, true}) {
+    for (bool big_endian : {false, true}) {
+      std::vector<uint8_t> bytes = ToolBuilder()
+                                       .Set64Bit(is_64bit)
+                                       .SetBigEndian(big_endian)
+                                       .SetDylibId("/usr/lib/libx.dylib",
+                                                   Version(1, 2, 3),
+                                                   Version(1, 0))
+                                       .Build();
+      MachOImage image;
+      ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+      EXPECT_EQ(image.is_64bit(), is_64bit);
+      EXPECT_EQ(image.is_big_endian(), big_endian);
+      EXPECT_EQ(image.cpu_type(), kMachOCpuArm64);
+      EXPECT_EQ(image.file_type(), kMachOTypeExecutable);
+      ASSERT_EQ(image.uuid().size, 16u);
+      EXPECT_EQ(image.uuid().data[0], 0x1A);
+
+      MachOBuildVersion version;
+      ASSERT_TRUE(image.GetBuildVersion(&version));
+      EXPECT_EQ(version.platform, MachOImage::kPlatformMacOS);
+      EXPECT_EQ(version.min_os, Version(11, 0));
+      EXPECT_EQ(version.sdk, Version(14, 2, 1));
+
+      MachODylibId id;
+      ASSERT_TRUE(image.GetDylibId(&id));
+      EXPECT_EQ(ToString(id.install_name), "/usr/lib/libx.dylib");
+      EXPECT_EQ(id.current_version, Version(1, 2, 3));
+      EXPECT_EQ(id.compatibility_version, Version(1, 0));
+
+      EXPECT_EQ(ToString(image.info_plist()), kInfoPlist);
+    }
+  }
+}
+
+TEST(MachOImage, ReadsVersionMinCommands) {
+  std::vector<uint8_t> bytes =
+      MachOBuilder()
+          .SetVersionMin(kCommandVersionMinIOS, Version(9, 0), Version(12, 1))
+          .Build();
+  MachOImage image;
+  ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  MachOBuildVersion version;
+  ASSERT_TRUE(image.GetBuildVersion(&version));
+  EXPECT_EQ(version.platform, MachOImage::kPlatformIOS);
+  EXPECT_EQ(FormatMachOVersion(version.min_os), "9.0");
+  EXPECT_EQ(FormatMachOVersion(version.sdk), "12.1");
+  EXPECT_TRUE(image.uuid().empty());
+  EXPECT_TRUE(image.info_plist().empty());
+  MachODylibId id;
+  EXPECT_FALSE(image.GetDylibId(&id));
+}
+
+TEST(MachOImage, SplitsUniversalBinaries) {
+  for (bool fat64 : {false, true}) {
+    std::vector<uint8_t> bytes = testing::BuildUniversal(
+        {{kMachOCpuX86_64, 3, ToolBuilder().SetCpu(kMachOCpuX86_64, 3).Build()},
+         {kMachOCpuArm64, 0, ToolBuilder().Build()}},
+        fat64);
+    std::vector<MachOSlice> slices;
+    ASSERT_TRUE(
+        ReadMachOSlices(ByteView(bytes.data(), bytes.size()), &slices));
+    ASSERT_EQ(slices.size(), 2u);
+    EXPECT_EQ(slices[0].cpu_type, kMachOCpuX86_64);
+    EXPECT_EQ(PreferredMachOSlice(slices).cpu_type, kMachOCpuArm64);
+
+    MachOImage image;
+    ASSERT_TRUE(image.Parse(slices[0].image));
+    EXPECT_EQ(image.cpu_type(), kMachOCpuX86_64);
+    EXPECT_EQ(ToString(image.info_plist()), kInfoPlist);
+  }
+}
+
+TEST(MachOImage, ToleratesTruncatedInput) {
+  std::vector<uint8_t> bytes = testing::BuildUniversal(
+      {{kMachOCpuArm64, 0,
+        ToolBuilder().SetDylibId("libx.dylib", 1, 1).Build()}});
+  for (size_t size = 0; size < bytes.size(); size += 5) {
+    std::vector<MachOSlice> slices;
+    ReadMachOSlices(ByteView(bytes.data(), size), &slices);
+    for (const MachOSlice& slice : slices) {
+      MachOImage image;
+      image.Parse(slice.image);
+    }
+  }
+  std::vector<uint8_t> thin = ToolBuilder().Build();
+  for (size_t size = 0; size < thin.size(); size += 3) {
+    MachOImage image;
+    if (image.Parse(ByteView(thin.data(), size))) {
+      EXPECT_LE(image.info_plist().size, size);
+    }
+  }
+}
+
+TEST(MachOMetadata, MapsStandardAndMachOFields) {
+  BinaryMetadata metadata = ReadFields(
+      ToolBuilder().Build(),
+      {"version", "productName", "fileDescription", "legalCopyright",
+       "originalFilename", "companyName", "uuid", "architectures", "platform",
+       "minOS", "sdk", "CFBundleIdentifier", "LSUIElement", "missingKey"});
+
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  EXPECT_EQ(metadata.fields["version"], "2.4.1");
+  EXPECT_EQ(metadata.fields["productName"], "Fixture & Tool");
+  EXPECT_EQ(metadata.fields["fileDescription"],
+            "Mach-O 64-bit arm64 executable");
+  EXPECT_EQ(metadata.fields["legalCopyright"],
+            "\xC2\xA9 2024 Example\xE2\x84\xA2");
+  EXPECT_EQ(metadata.fields["originalFilename"], "fixturetool");
+  EXPECT_EQ(metadata.fields["companyName"], "");
+  EXPECT_EQ(metadata.fields["uuid"], "1A2B3C4D-5E6F-7081-92A3-B4C5D6E7F809");
+  EXPECT_EQ(metadata.fields["architectures"], "arm64");
+  EXPECT_EQ(metadata.fields["platform"], "macOS");
+  EXPECT_EQ(metadata.fields["minOS"], "11.0");
+  EXPECT_EQ(metadata.fields["sdk"], "14.2.1");
+  EXPECT_EQ(metadata.fields["CFBundleIdentifier"], "com.example.fixturetool");
+  EXPECT_EQ(metadata.fields["LSUIElement"], "true");
+  EXPECT_EQ(metadata.fields["missingKey"], "");
+}
+
+TEST(MachOMetadata, FallsBackToDylibIdentity) {
+  BinaryMetadata metadata = ReadFields(
+      LibraryBuilder().Build(),
+      {"version", "originalFilename", "fileDescription", "installName",
+       "currentVersion", "compatibilityVersion", "productName"});
+  EXPECT_EQ(metadata.fields["version"], "3.1.4");
+  EXPECT_EQ(metadata.fields["originalFilename"], "libfixture.3.dylib");
+  EXPECT_EQ(metadata.fields["fileDescription"],
+            "Mach-O 64-bit arm64 dynamic library");
+  EXPECT_EQ(metadata.fields["installName"], "@rpath/libfixture.3.dylib");
+  EXPECT_EQ(metadata.fields["currentVersion"], "3.1.4");
+  EXPECT_EQ(metadata.fields["compatibilityVersion"], "3.0");
+  EXPECT_EQ(metadata.fields["productName"], "");
+
+  metadata = ReadFields(MachOBuilder().Build(), {"version"});
+  EXPECT_EQ(metadata.fields.count("version"), 0u);
+}
+
+TEST(MachOMetadata, ReadsUniversalFilesFromDisk) {
+  std::string path = testing::TempPath("fixture_universal");
+  ASSERT_TRUE(testing::WriteFile(
+      path, testing::BuildUniversal(
+                {{kMachOCpuX86_64, 3,
+                  LibraryBuilder().SetCpu(kMachOCpuX86_64, 3).Build()},
+                 {kMachOCpuArm64, 2,
+                  LibraryBuilder().SetCpu(kMachOCpuArm64, 2).Build()}})));
+
+  BinaryMetadata metadata =
+      ReadBinaryMetadata(path, MetadataRequest::Standard({"architectures"}));
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  EXPECT_EQ(metadata.fields["version"], "3.1.4");
+  EXPECT_EQ(metadata.fields["fileDescription"],
+            "Mach-O universal binary (x86_64, arm64e)");
+  EXPECT_EQ(metadata.fields["architectures"], "x86_64,arm64e");
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "file_stamp.h"
+#include "metadata_cache.h"
+#include "testing/pe_builder.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+using testing::VersionInfoBuilder;
+
+std::string WriteFixture(const std::string& name, const char16_t* product) {
+  std::string path = testing::TempPath(name);
+  PeBuilder()
+      .AddVersionResource(VersionInfoBuilder()
+                              .SetFileVersion(1, 0, 0, 0)
+                              .AddStringTable(0x040904B0,
+                                              {{u"ProductName", product}})
+                              .AddTranslation(0x040904B0)
+                              .Build())
+      .WriteTo(path);
+  return path;
+}
+
+// Counts how often the cache falls through to the real reader.
+class CountingReader {
+ public:
+  MetadataCache::Reader reader() {
+    return [this](const std::string& path, const MetadataRequest& request) {
+      ++reads;
+      return ReadBinaryMetadata(path, request);
+    };
+  }
+
+  std::atomic<int> reads{0};
+};
+
+}  // namespace
+
+TEST(FileStamp, ReadsRegularFilesOnly) {
+  std::string path = testing::TempPath("stamp.bin");
+  testing::WriteFile(path, {1, 2, 3});
+  FileStamp stamp;
+  ASSERT_TRUE(ReadFileStamp(path, &stamp));
+  EXPECT_EQ(stamp.size, 3u);
+  EXPECT_NE(stamp.file_id, 0u);
+
+  FileStamp again;
+  ASSERT_TRUE(ReadFileStamp(path, &again));
+  EXPECT_EQ(stamp, again);
+  std::remove(path.c_str());
+
+  EXPECT_FALSE(ReadFileStamp(path, &stamp));
+}
+
+TEST(MetadataCache, HitsUntilTheFileChanges) {
+  std::string path = WriteFixture("cached.exe", u"First");
+  MetadataCache cache;
+  CountingReader counter;
+  MetadataRequest request = MetadataRequest::Standard();
+
+  EXPECT_EQ(cache.Get(path, request, counter.reader()).fields["productName"],
+            "First");
+  EXPECT_EQ(cache.Get(path, request, counter.reader()).fields["productName"],
+            "First");
+  EXPECT_EQ(counter.reads, 1);
+  EXPECT_EQ(cache.stats().hits, 1u);
+  EXPECT_EQ(cache.stats().misses, 1u);
+  EXPECT_EQ(cache.stats().entries, 1u);
+
+  // A different size is enough to change the stamp even if the write lands
+  // within the same timestamp tick.
+  std::remove(path.c_str());
+  PeBuilder()
+      .AddVersionResource(VersionInfoBuilder()
+                              .AddStringTable(0x040904B0,
+                                              {{u"ProductName", u"Second"}})
+                              .Build())
+      .SetOverlaySize(512)
+      .WriteTo(path);
+  EXPECT_EQ(cache.Get(path, request, counter.reader()).fields["productName"],
+            "Second");
+  EXPECT_EQ(counter.reads, 2);
+  EXPECT_EQ(cache.stats().entries, 1u);
+  std::remove(path.c_str());
+}
+
+TEST(MetadataCache, KeysOnTheRequest) {
+  std::string path = WriteFixture("requests.exe", u"Product");
+  MetadataCache cache;
+  CountingReader counter;
+
+  cache.Get(path, MetadataRequest::Standard(), counter.reader());
+  BinaryMetadata version =
+      cache.Get(path, MetadataRequest::Only({"version"}), counter.reader());
+  EXPECT_EQ(version.fields.size(), 1u);
+  cache.Get(path, MetadataRequest::Only({"version"}), counter.reader());
+  EXPECT_EQ(counter.reads, 2);
+  std::remove(path.c_str());
+}
+
+TEST(MetadataCache, SkipsFileErrorsButCachesFormatErrors) {
+  MetadataCache cache;
+  CountingReader counter;
+  std::string missing = testing::TempPath("missing.exe");
+  cache.Get(missing, MetadataRequest::Standard(), counter.reader());
+  cache.Get(missing, MetadataRequest::Standard(), counter.reader());
+  EXPECT_EQ(counter.reads, 2);
+
+  std::string text = testing::TempPath("notes.txt");
+  testing::WriteFile(text, {'h', 'i'});
+  cache.Get(text, MetadataRequest::Standard(), counter.reader());
+  EXPECT_EQ(cache.Get(text, MetadataRequest::Standard(), counter.reader()).error,
+            MetadataError::kUnsupportedFormat);
+  EXPECT_EQ(counter.reads, 3);
+  std::remove(text.c_str());
+}
+
+TEST(MetadataCache, EvictsLeastRecentlyUsedWithinBudget) {
+  std::vector<std::string> paths;
+  for (int i = 0; i < 64; ++i) {
+    paths.push_back(WriteFixture("lru" + std::to_string(i) + ".exe", u"P"));
+  }
+  // Room for only a few entries per shard.
+  MetadataCache cache(16 * 2048);
+  CountingReader counter;
+  for (const std::string& path : paths) {
+    cache.Get(path, MetadataRequest::Standard(), counter.reader());
+  }
+  MetadataCacheStats stats = cache.stats();
+  EXPECT_LE(stats.bytes, stats.budget);
+  EXPECT_GT(stats.evictions, 0u);
+  EXPECT_EQ(stats.entries + stats.evictions, paths.size());
+
+  cache.SetBudget(0);
+  EXPECT_EQ(cache.stats().entries, 0u);
+  cache.Get(paths[0], MetadataRequest::Standard(), counter.reader());
+  EXPECT_EQ(cache.stats().entries, 0u);
+  for (const std::string& path : paths) {
+    std::remove(path.c_str());
+  }
+}
+
+TEST(MetadataCache, ClearDropsEntries) {
+  std::string path = WriteFixture("clear.exe", u"Product");
+  MetadataCache cache;
+  CountingReader counter;
+  cache.Get(path, MetadataRequest::Standard(), counter.reader());
+  cache.Clear();
+  EXPECT_EQ(cache.stats().entries, 0u);
+  EXPECT_EQ(cache.stats().bytes, 0u);
+  cache.Get(path, MetadataRequest::Standard(), counter.reader());
+  EXPECT_EQ(counter.reads, 2);
+  std::remove(path.c_str());
+}
+
+TEST(MetadataCache, ReadsOnlyTheMissesOfABatch) {
+  // Every other file is never written, so it has no stamp to cache under.
+  std::vector<std::string> paths;
+  for (int i = 0; i < 16; ++i) {
+    std::string name = "batch" + std::to_string(i) + ".exe";
+    paths.push_back(i % 2 == 0 ? WriteFixture(name, u"Batch")
+                               : testing::TempPath(name));
+  }
+  ThreadPool pool(4);
+  MetadataCache cache;
+  MetadataRequest request = MetadataRequest::Standard();
+  auto read = [&paths, &request](std::vector<size_t>* seen) {
+    return [&paths, &request, seen](const std::vector<size_t>& misses,
+                                    std::vector<BinaryMetadata>* out) {
+      *seen = misses;
+      for (size_t i : misses) {
+        (*out)[i] = ReadBinaryMetadata(paths[i], request);
+      }
+      return true;
+    };
+  };
+  std::vector<size_t> first;
+  std::vector<BinaryMetadata> results;
+  cache.GetBatch(paths, request, &pool, read(&first), &results);
+  EXPECT_EQ(first.size(), paths.size());
+  ASSERT_EQ(results.size(), paths.size());
+  EXPECT_EQ(results[0].fields["productName"], "Batch");
+
+  // Only the files that could not be stamped are read again.
+  std::vector<size_t> second;
+  std::vector<BinaryMetadata> again;
+  cache.GetBatch(paths, request, &pool, read(&second), &again);
+  EXPECT_EQ(second.size(), paths.size() / 2);
+  for (size_t i : second) {
+    EXPECT_EQ(i % 2, 1u);
+  }
+  for (size_t i = 0; i < paths.size(); ++i) {
+    EXPECT_EQ(again[i].error, results[i].error);
+    EXPECT_EQ(again[i].fields, results[i].fields);
+  }
+
+  // A reader that gave up leaves nothing behind.
+  MetadataCache cold;
+  cold.GetBatch(
+      paths, request, &pool,
+      [](const std::vector<size_t>&, std::vector<BinaryMetadata>*) {
+        return false;
+      },
+      &results);
+  EXPECT_EQ(cold.stats().entries, 0u);
+  for (const std::string& path : paths) {
+    std::remove(path.c_str());
+  }
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "file_stamp.h"
+#include "metadata_cache.h"
+#include "metadata_index.h"
+#include "testing/pe_builder.h"
+#include "thread_pool.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+using testing::VersionInfoBuilder;
+
+BinaryMetadata Metadata(const std::string& version) {
+  BinaryMetadata metadata;
+  metadata.fields["version"] = version;
+  return metadata;
+}
+
+// A real file, so that compaction finds it unchanged.
+std::string WriteFile(const std::string& name, FileStamp* stamp) {
+  std::string path = testing::TempPath(name);
+  testing::WriteFile(path, {'M', 'Z'});
+  EXPECT_TRUE(ReadFileStamp(path, stamp));
+  return path;
+}
+
+void RemoveIndex(const std::string& base) {
+  std::remove((base + ".idx").c_str());
+  std::remove((base + ".log").c_str());
+}
+
+}  // namespace
+
+TEST(MetadataIndex, PersistsAcrossReopen) {
+  std::string base = testing::TempPath("reopen");
+  FileStamp stamp;
+  stamp.size = 10;
+  stamp.file_id = 7;
+  {
+    MetadataIndex index;
+    ASSERT_TRUE(index.Open(base, nullptr));
+    index.Append("a", stamp, Metadata("1.0"));
+    index.Append("b", stamp, Metadata("2.0"));
+    index.Append("a", stamp, Metadata("1.1"));
+  }
+
+  MetadataIndex index;
+  ASSERT_TRUE(index.Open(base, nullptr));
+  EXPECT_EQ(index.log_entries(), 2u);
+  BinaryMetadata metadata;
+  ASSERT_TRUE(index.Lookup("a", stamp, &metadata));
+  EXPECT_EQ(metadata.fields["version"], "1.1");
+  EXPECT_FALSE(index.Lookup("c", stamp, &metadata));
+
+  FileStamp changed = stamp;
+  changed.modified = 1;
+  EXPECT_FALSE(index.Lookup("b", changed, &metadata));
+  index.Close();
+  RemoveIndex(base);
+}
+
+TEST(MetadataIndex, DropsTornTail) {
+  std::string base = testing::TempPath("torn");
+  FileStamp stamp;
+  {
+    MetadataIndex index;
+    ASSERT_TRUE(index.Open(base, nullptr));
+    index.Append("kept", stamp, Metadata("1.0"));
+  }
+  std::FILE* log = std::fopen((base + ".log").c_str(), "ab");
+  ASSERT_NE(log, nullptr);
+  std::fputs("\x40\x00\x00\x00garbage", log);
+  std::fclose(log);
+
+  {
+    MetadataIndex index;
+    ASSERT_TRUE(index.Open(base, nullptr));
+    BinaryMetadata metadata;
+    EXPECT_TRUE(index.Lookup("kept", stamp, &metadata));
+    index.Append("after", stamp, Metadata("2.0"));
+  }
+
+  MetadataIndex index;
+  ASSERT_TRUE(index.Open(base, nullptr));
+  BinaryMetadata metadata;
+  EXPECT_TRUE(index.Lookup("kept", stamp, &metadata));
+  ASSERT_TRUE(index.Lookup("after", stamp, &metadata));
+  EXPECT_EQ(metadata.fields["version"], "2.0");
+  index.Close();
+  RemoveIndex(base);
+}
+
+TEST(MetadataIndex, DiscardsForeignFiles) {
+  std::string base = testing::TempPath("foreign");
+  testing::WriteFile(base + ".idx", std::vector<uint8_t>(64, 0xAB));
+  testing::WriteFile(base + ".log", {'F', 'B', 'I', 'N', 'L', 'O', 'G', 0, 99,
+                                     0, 0, 0, 0, 0, 0, 0});
+  MetadataIndex index;
+  ASSERT_TRUE(index.Open(base, nullptr));
+  EXPECT_EQ(index.table_entries(), 0u);
+  EXPECT_EQ(index.log_entries(), 0u);
+  BinaryMetadata metadata;
+  EXPECT_FALSE(index.Lookup("a", FileStamp(), &metadata));
+  index.Close();
+  RemoveIndex(base);
+}
+
+TEST(MetadataIndex, CompactionFoldsTheLogAndDropsStaleFiles) {
+  std::string base = testing::TempPath("compact");
+  FileStamp first_stamp;
+  FileStamp second_stamp;
+  std::string first = WriteFile("first.exe", &first_stamp);
+  std::string second = WriteFile("second.exe", &second_stamp);
+  std::string first_key = first + '\0' + "v";
+  std::string second_key = second + '\0' + "v";
+  std::string gone_key = testing::TempPath("gone.exe") + '\0' + "v";
+
+  MetadataIndex index;
+  ASSERT_TRUE(index.Open(base, nullptr));
+  index.Append(first_key, first_stamp, Metadata("1.0"));
+  index.Append(second_key, second_stamp, Metadata("2.0"));
+  index.Append(gone_key, first_stamp, Metadata("3.0"));
+  ASSERT_TRUE(index.Compact());
+  EXPECT_EQ(index.table_entries(), 2u);
+  EXPECT_EQ(index.log_entries(), 0u);
+
+  // Later appends land in the log and win over the table.
+  index.Append(first_key, first_stamp, Metadata("1.5"));
+  index.Close();
+
+  ASSERT_TRUE(index.Open(base, nullptr));
+  BinaryMetadata metadata;
+  ASSERT_TRUE(index.Lookup(first_key, first_stamp, &metadata));
+  EXPECT_EQ(metadata.fields["version"], "1.5");
+  ASSERT_TRUE(index.Lookup(second_key, second_stamp, &metadata));
+  EXPECT_EQ(metadata.fields["version"], "2.0");
+  EXPECT_FALSE(index.Lookup(gone_key, first_stamp, &metadata));
+
+  index.Clear();
+  EXPECT_FALSE(index.Lookup(second_key, second_stamp, &metadata));
+  index.Close();
+  RemoveIndex(base);
+  std::remove(first.c_str());
+  std::remove(second.c_str());
+}
+
+TEST(MetadataIndex, CompactsInTheBackground) {
+  std::string base = testing::TempPath("background");
+  FileStamp stamp;
+  std::string path = WriteFile("many.exe", &stamp);
+  ThreadPool pool(2);
+  {
+    MetadataIndex index;
+    ASSERT_TRUE(index.Open(base, &pool));
+    for (int i = 0; i < 300; ++i) {
+      index.Append(path + '\0' + std::to_string(i), stamp,
+                   Metadata(std::to_string(i)));
+    }
+  }
+
+  MetadataIndex index;
+  ASSERT_TRUE(index.Open(base, nullptr));
+  EXPECT_GE(index.table_entries(), 256u);
+  EXPECT_EQ(index.table_entries() + index.log_entries(), 300u);
+  BinaryMetadata metadata;
+  ASSERT_TRUE(index.Lookup(path + '\0' + "42", stamp, &metadata));
+  EXPECT_EQ(metadata.fields["version"], "42");
+  index.Close();
+  RemoveIndex(base);
+  std::remove(path.c_str());
+}
+
+TEST(MetadataIndex, BacksTheCacheAcrossRestarts) {
+  std::string base = testing::TempPath("cache");
+  std::string path = testing::TempPath("indexed.exe");
+  PeBuilder()
+      .AddVersionResource(
+          VersionInfoBuilder().SetFileVersion(4, 3, 2, 1).Build())
+      .WriteTo(path);
+  int reads = 0;
+  MetadataCache::Reader reader = [&reads](const std::string& file,
+                                          const MetadataRequest& request) {
+    ++reads;
+    return ReadBinaryMetadata(file, request);
+  };
+
+  {
+    MetadataCache cache;
+    auto index = std::make_shared<MetadataIndex>();
+    ASSERT_TRUE(index->Open(base, nullptr));
+    cache.SetIndex(index);
+    cache.Get(path, MetadataRequest::Standard(), reader);
+  }
+
+  MetadataCache cache;
+  auto index = std::make_shared<MetadataIndex>();
+  ASSERT_TRUE(index->Open(base, nullptr));
+  cache.SetIndex(index);
+  BinaryMetadata metadata = cache.Get(path, MetadataRequest::Standard(), reader);
+  EXPECT_EQ(metadata.fields["version"], "4.3.2.1");
+  EXPECT_EQ(reads, 1);
+  EXPECT_EQ(cache.stats().index_hits, 1u);
+
+  cache.Clear();
+  cache.Get(path, MetadataRequest::Standard(), reader);
+  EXPECT_EQ(reads, 2);
+  index->Close();
+  RemoveIndex(base);
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace flutter_bin
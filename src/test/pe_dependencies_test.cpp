@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "arena.h"
+#include "binary_metadata.h"
+#include "pe_dependencies.h"
+#include "pe_image.h"
+#include "string_pool.h"
+#include "testing/elf_builder.h"
+#include "testing/pe_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+
+std::vector<std::string> Names(const StringPool& pool,
+                               ArenaSpan<uint32_t> ids) {
+  std::vector<std::string> names;
+  for (uint32_t id : ids) {
+    names.emplace_back(pool.Get(id));
+  }
+  return names;
+}
+
+}  // namespace
+
+TEST(PeDependencies, ReadsImportsByNameAndOrdinal) {
+  for (bool pe32_plus : {false, true}) {
+    std::vector<uint8_t> bytes =
+        PeBuilder()
+            .SetPe32Plus(pe32_plus)
+            .AddImport("KERNEL32.dll", {"GetProcAddress", "LoadLibraryW"})
+            .AddImport("WS2_32.dll", {"#23", "#115"})
+            .AddImport("USER32.dll", {"MessageBoxW"}, /*delay_loaded=*/true)
+            .Build();
+    PeImage image;
+    ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+    StringPool pool;
+    Arena arena;
+    PeDependencies dependencies;
+    ReadPeDependencies(image, &pool, &arena, &dependencies);
+
+    ASSERT_EQ(dependencies.imports.size, 3u);
+    EXPECT_EQ(pool.Get(dependencies.imports[0].name), "KERNEL32.dll");
+    EXPECT_EQ(Names(pool, dependencies.imports[0].functions),
+              (std::vector<std::string>{"GetProcAddress", "LoadLibraryW"}));
+    EXPECT_FALSE(dependencies.imports[0].delay_loaded);
+    EXPECT_EQ(Names(pool, dependencies.imports[1].functions),
+              (std::vector<std::string>{"#23", "#115"}));
+    EXPECT_EQ(pool.Get(dependencies.imports[2].name), "USER32.dll");
+    EXPECT_EQ(Names(pool, dependencies.imports[2].functions),
+              (std::vector<std::string>{"MessageBoxW"}));
+    EXPECT_TRUE(dependencies.imports[2].delay_loaded);
+    EXPECT_TRUE(dependencies.exports.empty());
+    EXPECT_EQ(dependencies.export_name, StringPool::kNoString);
+  }
+}
+
+TEST(PeDependencies, ReadsNamedAndOrdinalOnlyExports) {
+  std::vector<uint8_t> bytes =
+      PeBuilder()
+          .SetExports("example.dll", {"Alpha", "Beta"}, /*ordinal_only=*/2,
+                      /*base=*/10)
+          .Build();
+  PeImage image;
+  ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  StringPool pool;
+  Arena arena;
+  PeDependencies dependencies;
+  ReadPeDependencies(image, &pool, &arena, &dependencies);
+
+  EXPECT_EQ(pool.Get(dependencies.export_name), "example.dll");
+  // The trailing unused slot of the address table is not an export.
+  EXPECT_EQ(Names(pool, dependencies.exports),
+            (std::vector<std::string>{"Alpha", "Beta", "#12", "#13"}));
+  EXPECT_TRUE(dependencies.imports.empty());
+}
+
+TEST(PeDependencies, SharesNamesAcrossFilesInOnePool) {
+  std::string first = testing::TempPath("first.dll");
+  std::string second = testing::TempPath("second.dll");
+  ASSERT_TRUE(PeBuilder()
+                  .AddImport("KERNEL32.dll", {"GetProcAddress", "Sleep"})
+                  .SetExports("first.dll", {"Sleep"})
+                  .WriteTo(first));
+  ASSERT_TRUE(PeBuilder()
+                  .AddImport("KERNEL32.dll", {"Sleep", "GetProcAddress"})
+                  .WriteTo(second));
+
+  StringPool pool;
+  Arena first_arena;
+  Arena second_arena;
+  PeDependencies a;
+  PeDependencies b;
+  EXPECT_EQ(ReadBinaryDependencies(first, &pool, &first_arena, &a),
+            MetadataError::kNone);
+  EXPECT_EQ(ReadBinaryDependencies(second, &pool, &second_arena, &b),
+            MetadataError::kNone);
+  std::remove(first.c_str());
+  std::remove(second.c_str());
+
+  // KERNEL32.dll, GetProcAddress, Sleep and first.dll, each stored once.
+  EXPECT_EQ(pool.size(), 4u);
+  EXPECT_EQ(a.imports[0].name, b.imports[0].name);
+  EXPECT_EQ(a.imports[0].functions[0], b.imports[0].functions[1]);
+  EXPECT_EQ(a.exports[0], b.imports[0].functions[0]);
+
+  std::vector<int32_t> flat;
+  FlattenImports(a, /*delay_loaded=*/false, &flat);
+  EXPECT_EQ(flat, (std::vector<int32_t>{
+                      static_cast<int32_t>(a.imports[0].name), 2,
+                      static_cast<int32_t>(a.imports[0].functions[0]),
+                      static_cast<int32_t>(a.imports[0].functions[1])}));
+  flat.clear();
+  FlattenImports(a, /*delay_loaded=*/true, &flat);
+  EXPECT_TRUE(flat.empty());
+}
+
+TEST(PeDependencies, FlattensForTheChannel) {
+  std::string path = testing::TempPath("flat.dll");
+  ASSERT_TRUE(PeBuilder()
+                  .AddImport("KERNEL32.dll", {"Sleep"})
+                  .AddImport("USER32.dll", {"#5"}, /*delay_loaded=*/true)
+                  .SetExports("flat.dll", {"Sleep"})
+                  .WriteTo(path));
+  StringPool pool;
+  FlatDependencies flat = ReadFlatDependencies(path, &pool);
+  // Reusing the thread's arena must not disturb the first result.
+  FlatDependencies again = ReadFlatDependencies(path, &pool);
+  std::remove(path.c_str());
+
+  EXPECT_EQ(flat.error, MetadataError::kNone);
+  // Ids follow first appearance: imports, delay-loaded imports, exports.
+  EXPECT_EQ(flat.imports, (std::vector<int32_t>{0, 1, 1}));
+  EXPECT_EQ(flat.delay_imports, (std::vector<int32_t>{2, 1, 3}));
+  EXPECT_EQ(pool.Get(flat.export_name), "flat.dll");
+  EXPECT_EQ(flat.exports, (std::vector<int32_t>{1}));
+  EXPECT_EQ(again.imports, flat.imports);
+  EXPECT_EQ(pool.size(), 5u);
+}
+
+TEST(PeDependencies, RejectsOtherFormatsAndMissingFiles) {
+  StringPool pool;
+  Arena arena;
+  PeDependencies dependencies;
+  std::string path = testing::TempPath("libexample.so");
+  ASSERT_TRUE(testing::WriteFile(path, testing::ElfBuilder().Build()));
+  EXPECT_EQ(ReadBinaryDependencies(path, &pool, &arena, &dependencies),
+            MetadataError::kUnsupportedFormat);
+  std::remove(path.c_str());
+  EXPECT_EQ(ReadBinaryDependencies(path, &pool, &arena, &dependencies),
+            MetadataError::kFileNotFound);
+  EXPECT_TRUE(dependencies.imports.empty());
+}
+
+TEST(PeDependencies, SurvivesTruncatedImages) {
+  std::vector<uint8_t> bytes =
+      PeBuilder()
+          .SetPe32Plus(true)
+          .AddImport("KERNEL32.dll", {"GetProcAddress", "#7"})
+          .AddImport("USER32.dll", {"MessageBoxW"}, /*delay_loaded=*/true)
+          .SetExports("example.dll", {"Alpha"}, 1)
+          .Build();
+  StringPool pool;
+  // Every prefix that still parses must be walked without reading past its
+  // end; the sanitizer builds check that.
+  for (size_t size = 0; size <= bytes.size(); size += 7) {
+    std::vector<uint8_t> prefix(bytes.begin(), bytes.begin() + size);
+    PeImage image;
+    if (!image.Parse(ByteView(prefix.data(), prefix.size()))) {
+      continue;
+    }
+    Arena arena;
+    PeDependencies dependencies;
+    ReadPeDependencies(image, &pool, &arena, &dependencies);
+  }
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+#include "pe_image.h"
+#include "testing/pe_builder.h"
+#include "version_resource.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PeBuilder;
+using testing::VersionInfoBuilder;
+
+std::vector<uint8_t> SimpleVersionBlob() {
+  return VersionInfoBuilder()
+      .SetFileVersion(1, 2, 3, 4)
+      .AddStringTable(0x040904B0, {{u"ProductName", u"Fixture"}})
+      .AddTranslation(0x040904B0)
+      .Build();
+}
+
+}  // namespace
+
+TEST(PeImage, RejectsNonPeInput) {
+  std::vector<uint8_t> bytes(512, 0);
+  PeImage image;
+  EXPECT_FALSE(image.Parse(ByteView(bytes.data(), bytes.size())));
+
+  bytes[0] = 'M';
+  bytes[1] = 'Z';
+  bytes[0x3C] = 0xF0;  // e_lfanew past the end of the buffer.
+  bytes[0x3D] = 0xFF;
+  EXPECT_FALSE(image.Parse(ByteView(bytes.data(), bytes.size())));
+}
+
+TEST(PeImage, ParsesPe32AndPe32Plus) {
+  for (bool pe32_plus : {false, true}) {
+    std::vector<uint8_t> bytes = PeBuilder()
+                                     .SetPe32Plus(pe32_plus)
+                                     .AddSection(".data", 0x300)
+                                     .AddVersionResource(SimpleVersionBlob())
+                                     .Build();
+    PeImage image;
+    ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+    EXPECT_EQ(image.is_pe32_plus(), pe32_plus);
+    EXPECT_EQ(image.machine(), pe32_plus ? 0x8664 : 0x14C);
+    EXPECT_EQ(image.section_count(), 3u);
+
+    VersionResource resource;
+    ASSERT_TRUE(resource.Parse(image.FindVersionResource()));
+    EXPECT_EQ(FormatFileVersion(resource.fixed_file_info()), "1.2.3.4");
+  }
+}
+
+TEST(PeImage, FindsVersionAmongOtherResourceTypes) {
+  std::vector<uint8_t> bytes = PeBuilder()
+                                   .AddResourceType(3, 0x1000)   // RT_ICON
+                                   .AddResourceType(14, 0x40)    // RT_GROUP_ICON
+                                   .AddResourceType(24, 0x200)   // RT_MANIFEST
+                                   .AddVersionResource(SimpleVersionBlob())
+                                   .Build();
+  PeImage image;
+  ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(image.FindVersionResource()));
+  EXPECT_TRUE(resource.fixed_file_info().valid());
+}
+
+TEST(PeImage, PrefersEnglishVersionResource) {
+  std::vector<uint8_t> german =
+      VersionInfoBuilder().SetFileVersion(9, 9, 9, 9).Build();
+  std::vector<uint8_t> bytes = PeBuilder()
+                                   .AddVersionResource(german, 0x0407)
+                                   .AddVersionResource(SimpleVersionBlob())
+                                   .Build();
+  PeImage image;
+  ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(image.FindVersionResource()));
+  EXPECT_EQ(FormatFileVersion(resource.fixed_file_info()), "1.2.3.4");
+}
+
+TEST(PeImage, ReturnsEmptyViewWithoutVersionResource) {
+  std::vector<uint8_t> bytes = PeBuilder().AddResourceType(3, 0x100).Build();
+  PeImage image;
+  ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  EXPECT_TRUE(image.FindVersionResource().empty());
+
+  bytes = PeBuilder().Build();
+  ASSERT_TRUE(image.Parse(ByteView(bytes.data(), bytes.size())));
+  EXPECT_TRUE(image.FindVersionResource().empty());
+}
+
+TEST(PeImage, SurvivesTruncation) {
+  std::vector<uint8_t> bytes =
+      PeBuilder().AddVersionResource(SimpleVersionBlob()).Build();
+  // Every prefix must either parse or fail cleanly, never read out of bounds.
+  for (size_t size = 0; size < bytes.size(); size += 7) {
+    PeImage image;
+    if (image.Parse(ByteView(bytes.data(), size))) {
+      VersionResource resource;
+      resource.Parse(image.FindVersionResource());
+    }
+  }
+}
+
+TEST(PeImage, ReadsFixtureThroughMapping) {
+  std::string path = testing::TempPath("fixture.dll");
+  ASSERT_TRUE(PeBuilder()
+                  .SetPe32Plus(true)
+                  .AddVersionResource(SimpleVersionBlob())
+                  .SetOverlaySize(0x4000)
+                  .WriteTo(path));
+
+  MappedFile file;
+  ASSERT_TRUE(file.Open(path));
+  PeImage image;
+  ASSERT_TRUE(image.Parse(file.view()));
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(image.FindVersionResource()));
+  EXPECT_EQ(FormatFileVersion(resource.fixed_file_info()), "1.2.3.4");
+
+  std::remove(path.c_str());
+  EXPECT_FALSE(MappedFile().Open(path));
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "perf_stats.h"
+#include "testing/pe_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+const PhaseStats& Stats(const PerfSnapshot& snapshot, PerfPhase phase) {
+  return snapshot.phases[static_cast<size_t>(phase)];
+}
+
+// Turns stats on from a clean slate, and off again at the end of the test.
+class PerfStatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ResetPerfStats();
+    SetPerfStatsEnabled(true);
+  }
+  void TearDown() override {
+    SetPerfStatsEnabled(false);
+    SetPerfTraceEnabled(false);
+    ResetPerfStats();
+  }
+};
+
+}  // namespace
+
+TEST_F(PerfStatsTest, RecordsNothingWhileDisabled) {
+  SetPerfStatsEnabled(false);
+  { ScopedPhaseTimer timer(PerfPhase::kEncode); }
+  PerfSnapshot snapshot = ReadPerfStats();
+  EXPECT_FALSE(snapshot.enabled);
+  EXPECT_EQ(Stats(snapshot, PerfPhase::kEncode).count, 0u);
+}
+
+TEST_F(PerfStatsTest, ReportsPercentilesWithinABucket) {
+  for (int i = 0; i < 98; ++i) {
+    internal::RecordPhase(PerfPhase::kFileOpen, 0, 1000);
+  }
+  internal::RecordPhase(PerfPhase::kFileOpen, 0, 50000);
+  internal::RecordPhase(PerfPhase::kFileOpen, 0, 2000000);
+  internal::RecordPhase(PerfPhase::kHash, 10, 15);
+
+  PerfSnapshot snapshot = ReadPerfStats();
+  EXPECT_TRUE(snapshot.enabled);
+  const PhaseStats& open = Stats(snapshot, PerfPhase::kFileOpen);
+  EXPECT_EQ(open.count, 100u);
+  EXPECT_EQ(open.total_ns, 98u * 1000 + 50000 + 2000000);
+  EXPECT_GE(open.p50_ns, 1000u);
+  EXPECT_LE(open.p50_ns, 1125u);
+  EXPECT_EQ(open.p90_ns, open.p50_ns);
+  EXPECT_GE(open.p99_ns, 50000u);
+  EXPECT_LE(open.p99_ns, 56250u);
+  EXPECT_GE(open.max_ns, 2000000u);
+  EXPECT_LE(open.max_ns, 2250000u);
+
+  // Below 8 ns buckets are exact.
+  EXPECT_EQ(Stats(snapshot, PerfPhase::kHash).max_ns, 5u);
+  EXPECT_EQ(Stats(snapshot, PerfPhase::kEncode).count, 0u);
+}
+
+TEST_F(PerfStatsTest, MergesThreadsAndResets) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([] {
+      for (int i = 0; i < 1000; ++i) {
+        ScopedPhaseTimer timer(PerfPhase::kHeaderParse);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(Stats(ReadPerfStats(), PerfPhase::kHeaderParse).count, 4000u);
+
+  ResetPerfStats();
+  EXPECT_EQ(Stats(ReadPerfStats(), PerfPhase::kHeaderParse).count, 0u);
+  // Blocks of finished threads are reused, counts carry on from the reset.
+  std::thread([] { ScopedPhaseTimer timer(PerfPhase::kHeaderParse); }).join();
+  EXPECT_EQ(Stats(ReadPerfStats(), PerfPhase::kHeaderParse).count, 1u);
+}
+
+TEST_F(PerfStatsTest, WritesChromeTrace) {
+  EXPECT_EQ(PerfTraceJson(), "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}");
+  SetPerfTraceEnabled(true);
+  internal::RecordPhase(PerfPhase::kStringDecode, 1234567, 1236567);
+  std::string json = PerfTraceJson();
+  EXPECT_NE(json.find("{\"name\":\"stringDecode\",\"ph\":\"X\",\"pid\":1,"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"ts\":1234.567,\"dur\":2.000}"), std::string::npos);
+
+  // Only the newest events are kept.
+  for (size_t i = 0; i < kMaxPerfTraceEvents + 10; ++i) {
+    internal::RecordPhase(PerfPhase::kEncode, 0, 1);
+  }
+  json = PerfTraceJson();
+  EXPECT_EQ(json.find("stringDecode"), std::string::npos);
+
+  ResetPerfStats();
+  EXPECT_EQ(PerfTraceJson().find("encode"), std::string::npos);
+}
+
+TEST_F(PerfStatsTest, TimesMetadataReads) {
+  std::string path = testing::TempPath("perf.exe");
+  testing::PeBuilder()
+      .AddVersionResource(testing::VersionInfoBuilder()
+                              .SetFileVersion(1, 2, 3, 4)
+                              .AddStringTable(0x040904B0,
+                                              {{u"ProductName", u"Perf"}})
+                              .AddTranslation(0x040904B0)
+                              .Build())
+      .WriteTo(path);
+  ReadBinaryMetadata(path, MetadataRequest::Standard());
+  std::remove(path.c_str());
+
+  PerfSnapshot snapshot = ReadPerfStats();
+  for (PerfPhase phase : {PerfPhase::kFileOpen, PerfPhase::kHeaderParse,
+                          PerfPhase::kResourceRead, PerfPhase::kStringDecode}) {
+    EXPECT_EQ(Stats(snapshot, phase).count, 1u) << PerfPhaseName(phase);
+  }
+  EXPECT_EQ(Stats(snapshot, PerfPhase::kHash).count, 0u);
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "plist_reader.h"
+#include "testing/pe_builder.h"
+#include "testing/plist_builder.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::PlistNode;
+using Entries = std::vector<std::pair<std::string, PlistNode>>;
+
+// The same plist in both encodings.
+struct Encoded {
+  std::string xml;
+  std::vector<uint8_t> binary;
+};
+
+Encoded Encode(const PlistNode& root) {
+  return {testing::ToXmlPlist(root), testing::ToBinaryPlist(root)};
+}
+
+ByteView View(const std::string& text) {
+  return ByteView(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+ByteView View(const std::vector<uint8_t>& bytes) {
+  return ByteView(bytes.data(), bytes.size());
+}
+
+std::vector<ByteView> Views(const Encoded& encoded) {
+  return {View(encoded.xml), View(encoded.binary)};
+}
+
+}  // namespace
+
+TEST(PlistReader, DetectsFormats) {
+  Encoded encoded = Encode(PlistNode::Dictionary({}));
+  EXPECT_EQ(DetectPlistFormat(View(encoded.xml)), PlistFormat::kXml);
+  EXPECT_EQ(DetectPlistFormat(View(encoded.binary)), PlistFormat::kBinary);
+  EXPECT_EQ(DetectPlistFormat(View(std::string("\xEF\xBB\xBF <plist>"))),
+            PlistFormat::kXml);
+  EXPECT_EQ(DetectPlistFormat(View(std::string("{ json: 1 }"))),
+            PlistFormat::kUnknown);
+}
+
+TEST(PlistReader, ReadsOnlyTopLevelKeys) {
+  Encoded encoded = Encode(testing::LargeInfoPlist(50));
+  for (ByteView plist : Views(encoded)) {
+    std::vector<PlistValue> values;
+    ASSERT_TRUE(ReadPlistValues(
+        plist,
+        {"CFBundleShortVersionString", "NSHumanReadableCopyright",
+         "CFBundleTypeName", "CFBundleURLTypes", "NSHighResolutionCapable",
+         "Missing"},
+        &values));
+    ASSERT_EQ(values.size(), 6u);
+    EXPECT_TRUE(values[0].found);
+    EXPECT_EQ(values[0].type, PlistType::kString);
+    EXPECT_EQ(values[0].text, "5.2.1");
+    EXPECT_EQ(values[1].text, "Copyright \xC2\xA9 2024 Example Inc.");
+    // Only present inside CFBundleDocumentTypes.
+    EXPECT_FALSE(values[2].found);
+    EXPECT_TRUE(values[3].found);
+    EXPECT_EQ(values[3].type, PlistType::kArray);
+    EXPECT_EQ(values[3].text, "");
+    EXPECT_EQ(values[4].type, PlistType::kBoolean);
+    EXPECT_EQ(values[4].text, "true");
+    EXPECT_FALSE(values[5].found);
+  }
+}
+
+TEST(PlistReader, DecodesScalars) {
+  Encoded encoded = Encode(PlistNode::Dictionary(Entries{
+      {"small", PlistNode::Integer(42)},
+      {"wide", PlistNode::Integer(70000)},
+      {"huge", PlistNode::Integer(5000000000)},
+      {"negative", PlistNode::Integer(-7)},
+      {"real", PlistNode::Real(0.1)},
+      {"no", PlistNode::Boolean(false)},
+      {"date", PlistNode::Date(729000000)},
+      {"data", PlistNode::Data({1, 2, 3, 4})},
+      {"dict", PlistNode::Dictionary({})},
+      {"emoji", PlistNode::String("\xF0\x9F\x98\x80 & <tag>")},
+  }));
+  for (ByteView plist : Views(encoded)) {
+    std::vector<PlistValue> values;
+    ASSERT_TRUE(ReadPlistValues(plist,
+                                {"small", "wide", "huge", "negative", "real",
+                                 "no", "date", "data", "dict", "emoji"},
+                                &values));
+    EXPECT_EQ(values[0].text, "42");
+    EXPECT_EQ(values[0].type, PlistType::kInteger);
+    EXPECT_EQ(values[1].text, "70000");
+    EXPECT_EQ(values[2].text, "5000000000");
+    EXPECT_EQ(values[3].text, "-7");
+    EXPECT_EQ(values[4].type, PlistType::kReal);
+    EXPECT_EQ(values[4].text.substr(0, 3), "0.1");
+    EXPECT_EQ(values[5].text, "false");
+    EXPECT_EQ(values[6].type, PlistType::kDate);
+    EXPECT_EQ(values[6].text, "2024-02-07T12:00:00Z");
+    EXPECT_EQ(values[7].type, PlistType::kData);
+    EXPECT_EQ(values[8].type, PlistType::kDictionary);
+    EXPECT_EQ(values[9].text, "\xF0\x9F\x98\x80 & <tag>");
+  }
+}
+
+TEST(PlistReader, MatchesNonAsciiAndRepeatedKeys) {
+  Encoded encoded = Encode(PlistNode::Dictionary(Entries{
+      {"Cl\xC3\xA9", PlistNode::String("unicode key")},
+      {"A&B", PlistNode::String("escaped key")},
+  }));
+  for (ByteView plist : Views(encoded)) {
+    std::vector<PlistValue> values;
+    ASSERT_TRUE(
+        ReadPlistValues(plist, {"Cl\xC3\xA9", "A&B", "A&B"}, &values));
+    EXPECT_EQ(values[0].text, "unicode key");
+    EXPECT_EQ(values[1].text, "escaped key");
+    EXPECT_EQ(values[2].text, "escaped key");
+  }
+}
+
+TEST(PlistReader, RejectsNonDictionaryRoots) {
+  Encoded encoded = Encode(PlistNode::Array({PlistNode::String("x")}));
+  for (ByteView plist : Views(encoded)) {
+    std::vector<PlistValue> values;
+    EXPECT_FALSE(ReadPlistValues(plist, {"x"}, &values));
+    ASSERT_EQ(values.size(), 1u);
+    EXPECT_FALSE(values[0].found);
+  }
+  std::vector<PlistValue> values;
+  EXPECT_FALSE(ReadPlistValues(View(std::string("bplist00")), {"x"}, &values));
+  EXPECT_FALSE(ReadPlistValues(ByteView(), {"x"}, &values));
+}
+
+TEST(PlistReader, ToleratesCorruptInput) {
+  Encoded encoded = Encode(testing::LargeInfoPlist(3));
+  std::vector<std::string> keys = {"CFBundleName", "CFBundleURLTypes",
+                                   "NSHumanReadableCopyright"};
+  std::vector<PlistValue> values;
+  for (size_t size = 0; size < encoded.binary.size(); size += 3) {
+    ReadPlistValues(ByteView(encoded.binary.data(), size), keys, &values);
+  }
+  for (size_t size = 0; size < encoded.xml.size(); size += 11) {
+    ReadPlistValues(ByteView(View(encoded.xml).data, size), keys, &values);
+  }
+  for (size_t i = 0; i < encoded.binary.size(); ++i) {
+    std::vector<uint8_t> corrupt = encoded.binary;
+    corrupt[i] ^= 0xA5;
+    ReadPlistValues(View(corrupt), keys, &values);
+  }
+}
+
+TEST(PlistReader, ReadsBundleInfoPlistFiles) {
+  std::string path = testing::TempPath("Info.plist");
+  ASSERT_TRUE(testing::WriteFile(
+      path, testing::ToBinaryPlist(testing::LargeInfoPlist(10))));
+  BinaryMetadata metadata = ReadInfoPlistFile(
+      path, MetadataRequest::Standard({"CFBundleIdentifier"}));
+  EXPECT_EQ(metadata.error, MetadataError::kNone);
+  EXPECT_EQ(metadata.fields["version"], "5.2.1");
+  EXPECT_EQ(metadata.fields["productName"], "Example");
+  EXPECT_EQ(metadata.fields["originalFilename"], "Example");
+  EXPECT_EQ(metadata.fields["fileDescription"], "");
+  EXPECT_EQ(metadata.fields["CFBundleIdentifier"], "com.example.app");
+  std::remove(path.c_str());
+
+  metadata = ReadInfoPlistFile(path, MetadataRequest::Standard());
+  EXPECT_EQ(metadata.error, MetadataError::kFileNotFound);
+}
+
+}  // namespace test
+}  // namespace flutter_bin
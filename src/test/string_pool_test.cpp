@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena.h"
+#include "string_pool.h"
+
+namespace flutter_bin {
+namespace test {
+
+TEST(Arena, AlignsAndSpillsIntoNewBlocks) {
+  Arena arena(64);
+  auto* byte = arena.AllocateArray<uint8_t>(1);
+  auto* words = arena.AllocateArray<uint64_t>(3);
+  ASSERT_NE(byte, nullptr);
+  ASSERT_NE(words, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(words) % alignof(uint64_t), 0u);
+
+  // Larger than a block: gets a block of its own.
+  auto* big = arena.AllocateArray<uint32_t>(100);
+  ASSERT_NE(big, nullptr);
+  for (uint32_t i = 0; i < 100; ++i) {
+    big[i] = i;
+  }
+  words[2] = 7;
+  EXPECT_EQ(big[99], 99u);
+  EXPECT_EQ(arena.bytes_allocated(), 1 + 3 * 8 + 400u);
+
+  arena.Reset();
+  EXPECT_EQ(arena.bytes_allocated(), 0u);
+  EXPECT_NE(arena.AllocateArray<uint32_t>(4), nullptr);
+  EXPECT_EQ(arena.AllocateArray<uint64_t>(SIZE_MAX / 4), nullptr);
+}
+
+TEST(StringPool, InternsEachStringOnce) {
+  StringPool pool;
+  uint32_t kernel = pool.Intern("KERNEL32.dll");
+  uint32_t proc = pool.Intern("GetProcAddress");
+  EXPECT_EQ(kernel, 0u);
+  EXPECT_EQ(proc, 1u);
+  EXPECT_EQ(pool.Intern(std::string("KERNEL32.dll")), kernel);
+  EXPECT_EQ(pool.Intern(""), 2u);
+  EXPECT_EQ(pool.size(), 3u);
+  EXPECT_EQ(pool.bytes(), 12u + 14u);
+  EXPECT_EQ(pool.Get(kernel), "KERNEL32.dll");
+  EXPECT_EQ(pool.Get(proc), "GetProcAddress");
+  EXPECT_EQ(pool.Get(2), "");
+}
+
+TEST(StringPool, IdsAreDenseAcrossThreads) {
+  constexpr int kThreads = 8;
+  constexpr int kNames = 5000;
+  StringPool pool;
+  std::vector<std::vector<uint32_t>> ids(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&pool, &ids, t] {
+      // Every thread interns the same names, in a different order.
+      for (int i = 0; i < kNames; ++i) {
+        int name = (i * (t + 1)) % kNames;
+        ids[t].push_back(pool.Intern("name" + std::to_string(name)));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(pool.size(), static_cast<size_t>(kNames));
+  std::vector<bool> seen(kNames, false);
+  for (int t = 0; t < kThreads; ++t) {
+    for (int i = 0; i < kNames; ++i) {
+      uint32_t id = ids[t][i];
+      ASSERT_LT(id, static_cast<uint32_t>(kNames));
+      seen[id] = true;
+      EXPECT_EQ(pool.Get(id),
+                "name" + std::to_string((i * (t + 1)) % kNames));
+    }
+  }
+  for (int i = 0; i < kNames; ++i) {
+    EXPECT_TRUE(seen[i]);
+  }
+}
+
+}  // namespace test
+}  // namespace flutter_bin
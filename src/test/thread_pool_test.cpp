@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.h"
+
+namespace flutter_bin {
+namespace test {
+
+TEST(ThreadPool, ParallelForVisitsEveryIndexOnce) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int>> visits(10007);
+  pool.ParallelFor(visits.size(), [&visits](size_t i) { ++visits[i]; });
+  for (const auto& count : visits) {
+    ASSERT_EQ(count.load(), 1);
+  }
+}
+
+TEST(ThreadPool, ParallelForHandlesEmptyAndTinyRanges) {
+  ThreadPool pool(8);
+  int calls = 0;
+  pool.ParallelFor(0, [&calls](size_t) { ++calls; });
+  EXPECT_EQ(calls, 0);
+  pool.ParallelFor(1, [&calls](size_t) { ++calls; });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ThreadPool, IdleWorkersStealFromBusyOnes) {
+  ThreadPool pool(4);
+  // Index 0 blocks its shard for a while; the remaining shards must still be
+  // finished by other workers well before it returns.
+  std::atomic<size_t> done{0};
+  std::atomic<bool> others_finished_first{false};
+  pool.ParallelFor(64, [&](size_t i) {
+    if (i == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      others_finished_first = done.load() >= 60;
+    }
+    ++done;
+  });
+  EXPECT_EQ(done.load(), 64u);
+  EXPECT_TRUE(others_finished_first.load());
+}
+
+TEST(ThreadPool, NestedParallelForDoesNotDeadlock) {
+  ThreadPool pool(2);
+  std::atomic<int> total{0};
+  pool.ParallelFor(8, [&](size_t) {
+    pool.ParallelFor(8, [&](size_t) { ++total; });
+  });
+  EXPECT_EQ(total.load(), 64);
+}
+
+TEST(ThreadPool, PostFrontJumpsTheQueue) {
+  std::vector<int> order;
+  {
+    ThreadPool pool(1);
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool started = false;
+    bool open = false;
+    pool.Post([&] {
+      std::unique_lock<std::mutex> lock(mutex);
+      started = true;
+      changed.notify_all();
+      changed.wait(lock, [&] { return open; });
+    });
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&] { return started; });
+    }
+    // The only worker is busy; everything below waits in the queues.
+    for (int i = 1; i <= 3; ++i) {
+      pool.Post([&order, i] { order.push_back(i); });
+    }
+    pool.PostFront([&order] { order.push_back(0); });
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      open = true;
+    }
+    changed.notify_all();
+  }
+  ASSERT_EQ(order.size(), 4u);
+  EXPECT_EQ(order[0], 0);
+}
+
+TEST(ThreadPool, DestructorRunsPostedTasks) {
+  std::atomic<int> ran{0};
+  {
+    ThreadPool pool(3);
+    for (int i = 0; i < 100; ++i) {
+      pool.Post([&ran] { ++ran; });
+    }
+  }
+  EXPECT_EQ(ran.load(), 100);
+}
+
+}  // namespace test
+}  // namespace flutter_bin
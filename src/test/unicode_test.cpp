@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "unicode.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+std::vector<UnicodeKernel> SupportedKernels() {
+  std::vector<UnicodeKernel> kernels;
+  for (UnicodeKernel kernel : {UnicodeKernel::kScalar, UnicodeKernel::kSse2,
+                               UnicodeKernel::kAvx2}) {
+    if (UnicodeKernelSupported(kernel)) {
+      kernels.push_back(kernel);
+    }
+  }
+  return kernels;
+}
+
+// |text| as UTF-16LE bytes starting |offset| bytes into the buffer, so the
+// code units can be misaligned the way they are in a mapped resource.
+std::vector<uint8_t> Utf16Le(const std::u16string& text, size_t offset) {
+  std::vector<uint8_t> bytes(offset);
+  for (char16_t unit : text) {
+    bytes.push_back(static_cast<uint8_t>(unit));
+    bytes.push_back(static_cast<uint8_t>(unit >> 8));
+  }
+  return bytes;
+}
+
+std::string ToUtf8(const std::u16string& text, size_t offset,
+                   UnicodeKernel kernel) {
+  std::vector<uint8_t> bytes = Utf16Le(text, offset);
+  std::string out(3 * text.size(), '\0');
+  out.resize(Utf16ToUtf8(Utf16View(bytes.data() + offset, text.size()),
+                         &out[0], kernel));
+  return out;
+}
+
+std::u16string ToUtf16(const std::string& text, UnicodeKernel kernel,
+                       bool* valid) {
+  std::u16string out(text.size(), u'\0');
+  out.resize(Utf8ToUtf16(text, &out[0], valid, kernel));
+  return out;
+}
+
+// ASCII runs of every length around the vector widths, broken up by
+// characters of every UTF-8 length.
+std::vector<std::pair<std::u16string, std::string>> MixedSamples() {
+  std::vector<std::pair<std::u16string, std::string>> samples;
+  const std::pair<std::u16string, std::string> breaks[] = {
+      {u"é", "\xC3\xA9"},
+      {u"한", "\xED\x95\x9C"},
+      {u"\U0001F600", "\xF0\x9F\x98\x80"},
+  };
+  for (size_t run = 0; run <= 70; ++run) {
+    for (const auto& [utf16, utf8] : breaks) {
+      std::u16string text16;
+      std::string text8;
+      for (size_t i = 0; i < run; ++i) {
+        text16.push_back(static_cast<char16_t>('a' + i % 26));
+        text8.push_back(static_cast<char>('a' + i % 26));
+      }
+      text16 += utf16 + text16;
+      text8 += utf8 + text8;
+      samples.emplace_back(text16, text8);
+    }
+  }
+  return samples;
+}
+
+}  // namespace
+
+TEST(Unicode, TranscodesMixedTextWithEveryKernel) {
+  for (UnicodeKernel kernel : SupportedKernels()) {
+    SCOPED_TRACE(UnicodeKernelName(kernel));
+    for (const auto& [utf16, utf8] : MixedSamples()) {
+      EXPECT_EQ(ToUtf8(utf16, 0, kernel), utf8);
+      EXPECT_EQ(ToUtf8(utf16, 1, kernel), utf8);
+      bool valid = false;
+      EXPECT_EQ(ToUtf16(utf8, kernel, &valid), utf16);
+      EXPECT_TRUE(valid);
+    }
+  }
+}
+
+TEST(Unicode, ReplacesUnpairedSurrogates) {
+  std::u16string text = u"a";
+  text.push_back(0xD800);
+  text += u"b";
+  text.push_back(0xDC00);
+  text.push_back(0xDBFF);
+  for (UnicodeKernel kernel : SupportedKernels()) {
+    EXPECT_EQ(ToUtf8(text + std::u16string(40, u'x'), 1, kernel),
+              "a\xEF\xBF\xBD" "b\xEF\xBF\xBD\xEF\xBF\xBD" +
+                  std::string(40, 'x'));
+  }
+}
+
+TEST(Unicode, ReplacesEachMaximalInvalidSubsequence) {
+  const std::string replacement = "\xEF\xBF\xBD";
+  struct Case {
+    std::string utf8;
+    std::u16string utf16;
+  };
+  const Case cases[] = {
+      {"\x80", u"�"},                          // Lone continuation.
+      {"\xC0\xAF", u"��"},                // Overlong '/'.
+      {"\xE0\x80\xAF", u"���"},      // Overlong, 3 bytes.
+      {"\xED\xA0\x80", u"���"},      // Encoded surrogate.
+      {"\xF4\x90\x80\x80", u"����"},  // Past U+10FFFF.
+      {"\xE2\x82", u"�"},                      // Truncated at the end.
+      {"\xE2\x82" "a", u"�a"},                 // Truncated before 'a'.
+      {"\xF0\x9F\x98" "\xC3\xA9", u"�é"},
+      {"\xFF" "abc", u"�abc"},
+  };
+  for (UnicodeKernel kernel : SupportedKernels()) {
+    for (const Case& test_case : cases) {
+      // Also behind a long ASCII run, so the SIMD paths stop right at it.
+      const std::string prefix(37, 'p');
+      bool valid = true;
+      EXPECT_EQ(ToUtf16(prefix + test_case.utf8, kernel, &valid),
+                std::u16string(prefix.begin(), prefix.end()) +
+                    test_case.utf16);
+      EXPECT_FALSE(valid);
+    }
+  }
+  EXPECT_EQ(Utf8ToUtf16("ok"), u"ok");
+}
+
+TEST(Unicode, AppendsToExistingStrings) {
+  std::vector<uint8_t> bytes = Utf16Le(u"한국어 text", 1);
+  std::string out = "prefix ";
+  AppendUtf8(Utf16View(bytes.data() + 1, 8), &out);
+  EXPECT_EQ(out, "prefix \xED\x95\x9C\xEA\xB5\xAD\xEC\x96\xB4 text");
+  EXPECT_EQ(Utf16ToUtf8(Utf16View()), "");
+  EXPECT_EQ(Utf8ToUtf16(""), u"");
+}
+
+}  // namespace test
+}  // namespace flutter_bin
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "testing/pe_builder.h"
+#include "unicode.h"
+#include "version_resource.h"
+#include "version_string_index.h"
+
+namespace flutter_bin {
+namespace test {
+
+namespace {
+
+using testing::VersionInfoBuilder;
+
+std::string Lookup(const VersionResource& resource, const char* key) {
+  Utf16View value;
+  if (!resource.FindString(key, &value)) {
+    return "<missing>";
+  }
+  return Utf16ToUtf8(value);
+}
+
+std::string Lookup(const VersionStringIndex& index, const char* key) {
+  Utf16View value;
+  if (!index.Find(key, &value)) {
+    return "<missing>";
+  }
+  return Utf16ToUtf8(value);
+}
+
+}  // namespace
+
+TEST(VersionResource, ReadsFixedFileInfo) {
+  std::vector<uint8_t> blob =
+      VersionInfoBuilder().SetFileVersion(10, 0, 19041, 3636).Build();
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(ByteView(blob.data(), blob.size())));
+  ASSERT_TRUE(resource.fixed_file_info().valid());
+  EXPECT_EQ(FormatFileVersion(resource.fixed_file_info()), "10.0.19041.3636");
+}
+
+TEST(VersionResource, FormatsTheWidestVersion) {
+  std::vector<uint8_t> blob =
+      VersionInfoBuilder().SetFileVersion(65535, 65535, 65535, 65535).Build();
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(ByteView(blob.data(), blob.size())));
+  char version[kMaxFileVersionLength];
+  size_t length = FormatFileVersion(resource.fixed_file_info(), version);
+  EXPECT_EQ(std::string(version, length), "65535.65535.65535.65535");
+  EXPECT_EQ(length, kMaxFileVersionLength);
+}
+
+TEST(VersionResource, MissingFixedFileInfoIsInvalid) {
+  std::vector<uint8_t> blob = VersionInfoBuilder().OmitFixedFileInfo().Build();
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(ByteView(blob.data(), blob.size())));
+  EXPECT_FALSE(resource.fixed_file_info().valid());
+}
+
+TEST(VersionResource, RejectsForeignBlobs) {
+  std::vector<uint8_t> blob(64, 0x41);
+  VersionResource resource;
+  EXPECT_FALSE(resource.Parse(ByteView(blob.data(), blob.size())));
+  EXPECT_FALSE(resource.Parse(ByteView()));
+}
+
+TEST(VersionResource, PrefersDefaultTableThenTranslations) {
+  std::vector<uint8_t> blob =
+      VersionInfoBuilder()
+          .AddStringTable(0x041204B0, {{u"CompanyName", u"Korean Co"},
+                                       {u"ProductName", u"Korean Product"}})
+          .AddStringTable(0x040904B0, {{u"ProductName", u"English Product"}})
+          .AddTranslation(0x041204B0)
+          .Build();
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(ByteView(blob.data(), blob.size())));
+  ASSERT_EQ(resource.translation_count(), 1u);
+  EXPECT_EQ(resource.translation(0), 0x041204B0u);
+
+  EXPECT_EQ(Lookup(resource, "ProductName"), "English Product");
+  EXPECT_EQ(Lookup(resource, "CompanyName"), "Korean Co");
+  EXPECT_EQ(Lookup(resource, "companyname"), "Korean Co");
+  EXPECT_EQ(Lookup(resource, "LegalCopyright"), "<missing>");
+}
+
+TEST(VersionResource, DecodesNonAsciiValues) {
+  std::vector<uint8_t> blob =
+      VersionInfoBuilder()
+          .AddStringTable(0x040904B0,
+                          {{u"LegalCopyright", u"© 2025 한글"},
+                           {u"FileDescription", u"emoji \U0001F600"}})
+          .Build();
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(ByteView(blob.data(), blob.size())));
+  EXPECT_EQ(Lookup(resource, "LegalCopyright"),
+            "\xC2\xA9 2025 \xED\x95\x9C\xEA\xB8\x80");
+  EXPECT_EQ(Lookup(resource, "FileDescription"), "emoji \xF0\x9F\x98\x80");
+}
+
+TEST(VersionResource, ParsesTranslationKeys) {
+  uint32_t translation = 0;
+  const uint8_t key[] = {'0', 0, '4', 0, '0', 0, '9', 0,
+                         '0', 0, '4', 0, 'b', 0, '0', 0};
+  ASSERT_TRUE(ParseTranslationKey(Utf16View(key, 8), &translation));
+  EXPECT_EQ(translation, 0x040904B0u);
+  EXPECT_FALSE(ParseTranslationKey(Utf16View(key, 7), &translation));
+}
+
+TEST(VersionStringIndex, MatchesPerKeyLookups) {
+  std::vector<uint8_t> blob =
+      VersionInfoBuilder()
+          .AddStringTable(0x041204B0, {{u"CompanyName", u"Korean Co"},
+                                       {u"ProductName", u"Korean Product"},
+                                       {u"PrivateBuild", u"nightly"}})
+          .AddStringTable(0x040904B0, {{u"ProductName", u"English Product"},
+                                       {u"CompanyName", u""},
+                                       {u"FileVersion", u"1.0 (beta)"}})
+          .AddTranslation(0x041204B0)
+          .AddTranslation(0x040904B0)
+          .Build();
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(ByteView(blob.data(), blob.size())));
+  VersionStringIndex index;
+  index.Build(resource);
+  EXPECT_EQ(index.size(), 6u);
+
+  for (const char* key : {"ProductName", "CompanyName", "PrivateBuild",
+                          "FileVersion", "InternalName", "productname"}) {
+    EXPECT_EQ(Lookup(index, key), Lookup(resource, key)) << key;
+  }
+
+  Utf16View value;
+  ASSERT_TRUE(index.FindInTable(0x041204B0, "ProductName", &value));
+  EXPECT_EQ(Utf16ToUtf8(value), "Korean Product");
+  EXPECT_FALSE(index.FindInTable(0x040904E4, "ProductName", &value));
+}
+
+TEST(VersionStringIndex, IndexesOnlyTheRequestedKeys) {
+  std::vector<uint8_t> blob =
+      VersionInfoBuilder()
+          .AddStringTable(0x040904B0, {{u"CompanyName", u"Only Co"},
+                                       {u"ProductName", u"Skipped"},
+                                       {u"PrivateBuild", u"nightly"}})
+          .AddTranslation(0x040904B0)
+          .Build();
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(ByteView(blob.data(), blob.size())));
+  const uint32_t hashes[] = {HashVersionKey("companyname"),
+                             HashVersionKey("PrivateBuild")};
+  VersionStringIndex index;
+  index.Build(resource, hashes, 2);
+  EXPECT_EQ(index.size(), 2u);
+  EXPECT_EQ(Lookup(index, "CompanyName"), "Only Co");
+  EXPECT_EQ(Lookup(index, "ProductName"), "<missing>");
+
+  Utf16View value;
+  ASSERT_TRUE(index.Find(hashes[1], "PrivateBuild", &value));
+  EXPECT_EQ(Utf16ToUtf8(value), "nightly");
+}
+
+TEST(VersionStringIndex, FallsBackToUnlistedTables) {
+  std::vector<uint8_t> blob =
+      VersionInfoBuilder()
+          .AddStringTable(0x040704B0, {{u"CompanyName", u"German GmbH"}})
+          .Build();
+  VersionResource resource;
+  ASSERT_TRUE(resource.Parse(ByteView(blob.data(), blob.size())));
+  VersionStringIndex index;
+  index.Build(resource);
+  EXPECT_EQ(Lookup(index, "CompanyName"), "German GmbH");
+
+  index.Clear();
+  EXPECT_EQ(index.size(), 0u);
+  EXPECT_EQ(Lookup(index, "CompanyName"), "<missing>");
+}
+
+}  // namespace test
+}  // namespace flutter_bin
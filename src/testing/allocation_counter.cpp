@@ -0,0 +1,46 @@
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace flutter_bin {
+namespace testing {
+
+namespace {
+
+thread_local uint64_t allocation_count = 0;
+
+void* Allocate(std::size_t size) {
+  ++allocation_count;
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+}  // namespace
+
+uint64_t ThreadAllocationCount() { return allocation_count; }
+
+}  // namespace testing
+}  // namespace flutter_bin
+
+void* operator new(std::size_t size) {
+  void* block = flutter_bin::testing::Allocate(size);
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  return block;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return flutter_bin::testing::Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return flutter_bin::testing::Allocate(size);
+}
+
+void operator delete(void* block) noexcept { std::free(block); }
+void operator delete[](void* block) noexcept { std::free(block); }
+void operator delete(void* block, std::size_t) noexcept { std::free(block); }
+void operator delete[](void* block, std::size_t) noexcept { std::free(block); }
@@ -0,0 +1,17 @@
+#ifndef FLUTTER_BIN_TESTING_ALLOCATION_COUNTER_H_
+#define FLUTTER_BIN_TESTING_ALLOCATION_COUNTER_H_
+
+#include <cstdint>
+
+namespace flutter_bin {
+namespace testing {
+
+// The number of times the calling thread has called operator new. Linking
+// this in replaces the global operator new and delete with counting
+// wrappers over malloc and free for the whole executable.
+uint64_t ThreadAllocationCount();
+
+}  // namespace testing
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_TESTING_ALLOCATION_COUNTER_H_
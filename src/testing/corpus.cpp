@@ -0,0 +1,252 @@
+#include "corpus.h"
+
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include "elf_builder.h"
+#include "macho_builder.h"
+#include "pe_builder.h"
+#include "plist_builder.h"
+
+namespace flutter_bin {
+namespace testing {
+
+namespace {
+
+// SplitMix64, so the corpus does not depend on the standard library's
+// distributions.
+class Random {
+ public:
+  explicit Random(uint64_t seed) : state_(seed) {}
+
+  uint64_t Next() {
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  // Uniform in [low, high].
+  size_t Between(size_t low, size_t high) {
+    return low + static_cast<size_t>(Next() % (high - low + 1));
+  }
+
+  bool OneIn(size_t n) { return Next() % n == 0; }
+
+ private:
+  uint64_t state_;
+};
+
+constexpr uint16_t kLanguages[] = {0x0409, 0x0412, 0x0407,
+                                   0x040C, 0x0411, 0x0804};
+
+std::u16string Widen(const std::string& ascii) {
+  return std::u16string(ascii.begin(), ascii.end());
+}
+
+std::vector<uint8_t> BuildPe(Random* random, size_t index,
+                             CorpusEntry* entry) {
+  uint16_t version[] = {static_cast<uint16_t>(random->Between(1, 30)),
+                        static_cast<uint16_t>(random->Between(0, 9)),
+                        static_cast<uint16_t>(random->Between(0, 20000)),
+                        static_cast<uint16_t>(random->Between(0, 999))};
+  entry->version = std::to_string(version[0]) + "." +
+                   std::to_string(version[1]) + "." +
+                   std::to_string(version[2]) + "." +
+                   std::to_string(version[3]);
+  entry->sections = random->Between(1, 16);
+  entry->resource_types = random->Between(0, 15);
+  entry->translations = random->Between(1, 4);
+
+  std::string company = "Vendor " + std::to_string(random->Between(0, 24));
+  std::string name = "module_" + std::to_string(index);
+  VersionInfoBuilder info;
+  info.SetFileVersion(version[0], version[1], version[2], version[3]);
+  for (size_t i = 0; i < entry->translations; ++i) {
+    uint32_t translation = static_cast<uint32_t>(kLanguages[i]) << 16 | 0x04B0;
+    VersionInfoBuilder::StringTable strings = {
+        {u"CompanyName", Widen(company + " Corporation")},
+        {u"FileDescription", Widen("Component " + name)},
+        {u"FileVersion", Widen(entry->version)},
+        {u"InternalName", Widen(name)},
+        {u"LegalCopyright",
+         Widen("Copyright (c) " + company + ". All rights reserved.")},
+        {u"OriginalFilename", Widen(name + ".dll")},
+        {u"ProductName", Widen(company + " Suite")},
+        {u"ProductVersion", Widen(entry->version)},
+    };
+    // Some vendors add a few keys of their own.
+    for (size_t extra = random->Between(0, 6); extra > 0; --extra) {
+      strings.emplace_back(Widen("Custom" + std::to_string(extra)),
+                           Widen("value " + std::to_string(random->Next())));
+    }
+    info.AddStringTable(translation, std::move(strings));
+    info.AddTranslation(translation);
+  }
+
+  PeBuilder pe;
+  pe.SetPe32Plus(random->OneIn(2));
+  for (size_t i = 0; i < entry->sections; ++i) {
+    pe.AddSection(".s" + std::to_string(i), 512 * random->Between(1, 8));
+  }
+  for (size_t i = 0; i < entry->resource_types; ++i) {
+    // Types 1-15 all sort before RT_VERSION (16).
+    pe.AddResourceType(static_cast<uint16_t>(i + 1),
+                       random->Between(16, 4096));
+  }
+  pe.AddVersionResource(info.Build(), kLanguages[0]);
+  return pe.Build();
+}
+
+std::vector<uint8_t> BuildElf(Random* random, size_t index,
+                              CorpusEntry* entry) {
+  ElfBuilder elf;
+  elf.Set64Bit(!random->OneIn(4));
+  elf.SetBigEndian(random->OneIn(8));
+  std::vector<uint8_t> build_id(20);
+  for (uint8_t& byte : build_id) {
+    byte = static_cast<uint8_t>(random->Next());
+  }
+  elf.SetBuildId(std::move(build_id));
+  for (size_t needed = random->Between(0, 12); needed > 0; --needed) {
+    elf.AddNeeded("libdep" + std::to_string(needed) + ".so.1");
+  }
+  std::string major = std::to_string(random->Between(1, 9));
+  elf.SetSoname("libcorpus" + std::to_string(index) + ".so." + major);
+  // Either packaging metadata or a version script names the version.
+  size_t definitions = random->Between(1, 6);
+  for (size_t i = 0; i < definitions; ++i) {
+    elf.AddVersionDefinition("LIBCORPUS_" + major + "." + std::to_string(i));
+  }
+  entry->version = major + "." + std::to_string(definitions - 1);
+  if (random->OneIn(2)) {
+    entry->version = major + "." + std::to_string(random->Between(0, 99)) +
+                     "." + std::to_string(random->Between(0, 99));
+    elf.SetPackageMetadata("{\"type\":\"rpm\",\"name\":\"corpus\",\"version\":\"" +
+                           entry->version + "\"}");
+  }
+  elf.AddComment("GCC: (GNU) 13.2.1");
+  return elf.Build();
+}
+
+std::vector<uint8_t> BuildMachO(Random* random, CorpusEntry* entry) {
+  entry->version = std::to_string(random->Between(1, 20)) + "." +
+                   std::to_string(random->Between(0, 9)) + "." +
+                   std::to_string(random->Between(0, 9));
+  PlistNode plist = LargeInfoPlist(random->Between(0, 24));
+  for (auto& [key, value] : plist.entries) {
+    if (key == "CFBundleShortVersionString") {
+      value.text = entry->version;
+    }
+  }
+  std::vector<uint8_t> uuid(16);
+  for (uint8_t& byte : uuid) {
+    byte = static_cast<uint8_t>(random->Next());
+  }
+  MachOBuilder macho;
+  macho.SetUuid(uuid)
+      .SetBuildVersion(1, 11 << 16, 14 << 16)
+      .SetInfoPlist(ToXmlPlist(plist));
+  if (!random->OneIn(3)) {
+    return macho.Build();
+  }
+  // A universal binary of an arm64 and an x86_64 slice.
+  std::vector<MachOFatSlice> slices(2);
+  slices[0].cpu_type = 0x0100000C;
+  slices[0].image = macho.Build();
+  slices[1].cpu_type = 0x01000007;
+  slices[1].cpu_subtype = 3;
+  slices[1].image = macho.SetCpu(0x01000007, 3).Build();
+  return BuildUniversal(slices);
+}
+
+const char* Extension(CorpusFormat format) {
+  switch (format) {
+    case CorpusFormat::kPe:
+      return ".dll";
+    case CorpusFormat::kElf:
+      return ".so";
+    case CorpusFormat::kMachO:
+      return ".dylib";
+  }
+  return "";
+}
+
+}  // namespace
+
+const char* CorpusFormatName(CorpusFormat format) {
+  switch (format) {
+    case CorpusFormat::kPe:
+      return "pe";
+    case CorpusFormat::kElf:
+      return "elf";
+    case CorpusFormat::kMachO:
+      return "macho";
+  }
+  return "";
+}
+
+std::vector<uint8_t> BuildCorpusFile(const CorpusOptions& options,
+                                     size_t index, CorpusEntry* entry) {
+  *entry = CorpusEntry();
+  Random random(options.seed * 0x100000001B3ull + index);
+  // Roughly what a Windows application directory looks like from a
+  // cross-platform scanner: mostly PE, some ELF and Mach-O.
+  size_t pick = random.Between(0, 9);
+  std::vector<uint8_t> bytes;
+  if (pick < 6) {
+    entry->format = CorpusFormat::kPe;
+    bytes = BuildPe(&random, index, entry);
+  } else if (pick < 8) {
+    entry->format = CorpusFormat::kElf;
+    bytes = BuildElf(&random, index, entry);
+  } else {
+    entry->format = CorpusFormat::kMachO;
+    bytes = BuildMachO(&random, entry);
+  }
+
+  // Pad with an overlay, which the readers never touch, so file size varies
+  // independently of the headers.
+  size_t tier = random.Between(0, 9);
+  size_t size = tier < 6 ? 16 << 10 : tier < 9 ? 256 << 10 : 4 << 20;
+  if (size > options.max_file_size) {
+    size = options.max_file_size;
+  }
+  if (bytes.size() < size) {
+    size_t start = bytes.size();
+    bytes.resize(size);
+    for (size_t i = start; i < size; i += 8) {
+      bytes[i] = static_cast<uint8_t>(random.Next());
+    }
+  }
+  entry->size = bytes.size();
+  return bytes;
+}
+
+bool WriteCorpus(const std::string& path_prefix, const CorpusOptions& options,
+                 std::vector<CorpusEntry>* entries) {
+  entries->clear();
+  for (size_t i = 0; i < options.files; ++i) {
+    CorpusEntry entry;
+    std::vector<uint8_t> bytes = BuildCorpusFile(options, i, &entry);
+    entry.path =
+        path_prefix + "_" + std::to_string(i) + Extension(entry.format);
+    if (!WriteFile(entry.path, bytes)) {
+      RemoveCorpus(*entries);
+      entries->clear();
+      return false;
+    }
+    entries->push_back(std::move(entry));
+  }
+  return true;
+}
+
+void RemoveCorpus(const std::vector<CorpusEntry>& entries) {
+  for (const CorpusEntry& entry : entries) {
+    std::remove(entry.path.c_str());
+  }
+}
+
+}  // namespace testing
+}  // namespace flutter_bin
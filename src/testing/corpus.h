@@ -0,0 +1,64 @@
+#ifndef FLUTTER_BIN_TESTING_CORPUS_H_
+#define FLUTTER_BIN_TESTING_CORPUS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_bin {
+namespace testing {
+
+enum class CorpusFormat {
+  kPe,
+  kElf,
+  kMachO,
+};
+
+// e.g. "pe", "macho".
+const char* CorpusFormatName(CorpusFormat format);
+
+// Shapes the synthetic binaries of a corpus.
+struct CorpusOptions {
+  // The same seed always yields the same bytes, on every host.
+  uint64_t seed = 1;
+  size_t files = 48;
+  // Files are padded to 16 KiB, 256 KiB or 4 MiB, capped at this size;
+  // images that come out larger are left as they are.
+  size_t max_file_size = 4 << 20;
+};
+
+// How one corpus file was generated.
+struct CorpusEntry {
+  std::string path;
+  CorpusFormat format = CorpusFormat::kPe;
+  size_t size = 0;
+  // Extra PE sections, resource types ahead of RT_VERSION and string table
+  // translations; zero for ELF and Mach-O files.
+  size_t sections = 0;
+  size_t resource_types = 0;
+  size_t translations = 0;
+  // What ReadBinaryMetadata() should report as "version".
+  std::string version;
+};
+
+// The |index|th file of the corpus described by |options|: mostly PE images
+// with 1-16 sections, 0-15 other resource types and 1-4 translations, plus
+// ELF objects of either class and byte order and thin or universal Mach-O
+// images. Fills |entry| apart from its path.
+std::vector<uint8_t> BuildCorpusFile(const CorpusOptions& options,
+                                     size_t index, CorpusEntry* entry);
+
+// Writes every file of the corpus to |path_prefix| followed by its index and
+// extension, e.g. TempPath("corpus") + "_7.dll". Returns false on I/O
+// failure, after removing what it wrote.
+bool WriteCorpus(const std::string& path_prefix, const CorpusOptions& options,
+                 std::vector<CorpusEntry>* entries);
+
+// Deletes the files written by WriteCorpus().
+void RemoveCorpus(const std::vector<CorpusEntry>& entries);
+
+}  // namespace testing
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_TESTING_CORPUS_H_
@@ -0,0 +1,332 @@
+#include "elf_builder.h"
+
+#include <utility>
+
+namespace flutter_bin {
+namespace testing {
+
+namespace {
+
+constexpr uint32_t kSectionTypeProgBits = 1;
+constexpr uint32_t kSectionTypeStringTable = 3;
+constexpr uint32_t kSectionTypeDynamic = 6;
+constexpr uint32_t kSectionTypeNote = 7;
+constexpr uint32_t kSectionTypeVersionDefinitions = 0x6FFFFFFD;
+
+constexpr uint32_t kSegmentTypeLoad = 1;
+constexpr uint32_t kSegmentTypeDynamic = 2;
+constexpr uint32_t kSegmentTypeNote = 4;
+
+// Appends fields in the byte order and word size of the image being built.
+class Writer {
+ public:
+  Writer(bool is_64bit, bool big_endian)
+      : is_64bit_(is_64bit), big_endian_(big_endian) {}
+
+  void Put(std::vector<uint8_t>* out, uint64_t value, size_t size) const {
+    for (size_t i = 0; i < size; ++i) {
+      size_t shift = big_endian_ ? (size - 1 - i) * 8 : i * 8;
+      out->push_back(static_cast<uint8_t>(value >> shift));
+    }
+  }
+  void Put16(std::vector<uint8_t>* out, uint64_t value) const {
+    Put(out, value, 2);
+  }
+  void Put32(std::vector<uint8_t>* out, uint64_t value) const {
+    Put(out, value, 4);
+  }
+  void PutWord(std::vector<uint8_t>* out, uint64_t value) const {
+    Put(out, value, is_64bit_ ? 8 : 4);
+  }
+
+ private:
+  bool is_64bit_;
+  bool big_endian_;
+};
+
+void Pad(std::vector<uint8_t>* out, size_t alignment) {
+  while (out->size() % alignment != 0) {
+    out->push_back(0);
+  }
+}
+
+std::vector<uint8_t> Note(const Writer& writer, const char* owner,
+                          uint32_t type, const std::vector<uint8_t>& desc) {
+  std::vector<uint8_t> note;
+  std::string name(owner);
+  writer.Put32(&note, name.size() + 1);
+  writer.Put32(&note, desc.size());
+  writer.Put32(&note, type);
+  note.insert(note.end(), name.begin(), name.end());
+  note.push_back(0);
+  Pad(&note, 4);
+  note.insert(note.end(), desc.begin(), desc.end());
+  Pad(&note, 4);
+  return note;
+}
+
+// Adds |text| to a string table and returns its offset.
+uint32_t AddString(std::vector<uint8_t>* table, const std::string& text) {
+  uint32_t offset = static_cast<uint32_t>(table->size());
+  table->insert(table->end(), text.begin(), text.end());
+  table->push_back(0);
+  return offset;
+}
+
+struct Blob {
+  std::string name;
+  uint32_t section_type = 0;
+  std::vector<uint8_t> data;
+  uint32_t link = 0;
+  uint64_t offset = 0;
+};
+
+}  // namespace
+
+ElfBuilder& ElfBuilder::Set64Bit(bool is_64bit) {
+  is_64bit_ = is_64bit;
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::SetBigEndian(bool big_endian) {
+  big_endian_ = big_endian;
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::SetType(uint16_t type) {
+  type_ = type;
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::SetMachine(uint16_t machine) {
+  machine_ = machine;
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::SetPie(bool pie) {
+  pie_ = pie;
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::SetBuildId(std::vector<uint8_t> build_id) {
+  build_id_ = std::move(build_id);
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::SetPackageMetadata(std::string json) {
+  package_metadata_ = std::move(json);
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::SetSoname(std::string soname) {
+  soname_ = std::move(soname);
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::AddNeeded(std::string library) {
+  needed_.push_back(std::move(library));
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::AddVersionDefinition(std::string name) {
+  version_definitions_.push_back(std::move(name));
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::AddComment(std::string comment) {
+  comments_.push_back(std::move(comment));
+  return *this;
+}
+
+ElfBuilder& ElfBuilder::StripSectionTable() {
+  strip_section_table_ = true;
+  return *this;
+}
+
+std::vector<uint8_t> ElfBuilder::Build() const {
+  const Writer writer(is_64bit_, big_endian_);
+  const size_t header_size = is_64bit_ ? 64 : 52;
+  const size_t segment_header_size = is_64bit_ ? 56 : 32;
+  const size_t section_header_size = is_64bit_ ? 64 : 40;
+  const bool dynamic = !soname_.empty() || !needed_.empty() ||
+                       !version_definitions_.empty() || pie_;
+  const size_t segment_count = 1 + (dynamic ? 1 : 0) + (build_id_.empty() ? 0 : 1);
+
+  // Blobs are laid out in this order after the program headers.
+  std::vector<Blob> blobs;
+  uint64_t offset = header_size + segment_count * segment_header_size;
+  auto place = [&blobs, &offset](Blob blob) {
+    offset = (offset + 7) & ~static_cast<uint64_t>(7);
+    blob.offset = offset;
+    offset += blob.data.size();
+    blobs.push_back(std::move(blob));
+    return blobs.size() - 1;
+  };
+
+  size_t build_id_blob = 0;
+  if (!build_id_.empty()) {
+    build_id_blob = place({".note.gnu.build-id", kSectionTypeNote,
+                           Note(writer, "GNU", 3, build_id_)});
+  }
+  if (!package_metadata_.empty()) {
+    std::vector<uint8_t> json(package_metadata_.begin(), package_metadata_.end());
+    json.push_back(0);
+    place({".note.package", kSectionTypeNote,
+           Note(writer, "FDO", 0xCAFE1A7E, json)});
+  }
+
+  size_t dynamic_blob = 0;
+  if (dynamic) {
+    std::vector<uint8_t> strings(1, 0);
+    uint32_t soname = soname_.empty() ? 0 : AddString(&strings, soname_);
+    std::vector<uint32_t> needed;
+    for (const std::string& library : needed_) {
+      needed.push_back(AddString(&strings, library));
+    }
+    std::vector<uint32_t> definitions;
+    for (const std::string& name : version_definitions_) {
+      definitions.push_back(AddString(&strings, name));
+    }
+    size_t dynstr_blob = place({".dynstr", kSectionTypeStringTable, strings});
+
+    size_t verdef_blob = 0;
+    if (!definitions.empty()) {
+      // The base definition names the image itself.
+      definitions.insert(definitions.begin(), soname);
+      std::vector<uint8_t> verdef;
+      for (size_t i = 0; i < definitions.size(); ++i) {
+        bool last = i + 1 == definitions.size();
+        writer.Put16(&verdef, 1);           // vd_version
+        writer.Put16(&verdef, i == 0 ? 1 : 0);  // vd_flags, VER_FLG_BASE
+        writer.Put16(&verdef, i + 1);       // vd_ndx
+        writer.Put16(&verdef, 1);           // vd_cnt
+        writer.Put32(&verdef, 0);           // vd_hash
+        writer.Put32(&verdef, 20);          // vd_aux
+        writer.Put32(&verdef, last ? 0 : 28);  // vd_next
+        writer.Put32(&verdef, definitions[i]);  // vda_name
+        writer.Put32(&verdef, 0);               // vda_next
+      }
+      verdef_blob = place({".gnu.version_d", kSectionTypeVersionDefinitions,
+                           verdef, static_cast<uint32_t>(dynstr_blob + 1)});
+    }
+
+    std::vector<uint8_t> entries;
+    auto entry = [&writer, &entries](uint64_t tag, uint64_t value) {
+      writer.PutWord(&entries, tag);
+      writer.PutWord(&entries, value);
+    };
+    for (uint32_t library : needed) {
+      entry(1, library);  // DT_NEEDED
+    }
+    if (!soname_.empty()) {
+      entry(14, soname);  // DT_SONAME
+    }
+    entry(5, kElfBaseAddress + blobs[dynstr_blob].offset);  // DT_STRTAB
+    entry(10, strings.size());                               // DT_STRSZ
+    if (!definitions.empty()) {
+      entry(0x6FFFFFFC, kElfBaseAddress + blobs[verdef_blob].offset);
+      entry(0x6FFFFFFD, definitions.size());
+    }
+    if (pie_) {
+      entry(0x6FFFFFFB, 0x08000000);  // DT_FLAGS_1, DF_1_PIE
+    }
+    entry(0, 0);  // DT_NULL
+    dynamic_blob = place({".dynamic", kSectionTypeDynamic, entries,
+                          static_cast<uint32_t>(dynstr_blob + 1)});
+  }
+
+  if (!comments_.empty()) {
+    std::vector<uint8_t> comment;
+    for (const std::string& text : comments_) {
+      AddString(&comment, text);
+    }
+    place({".comment", kSectionTypeProgBits, comment});
+  }
+
+  std::vector<uint8_t> section_names(1, 0);
+  std::vector<uint32_t> name_offsets;
+  for (const Blob& blob : blobs) {
+    name_offsets.push_back(AddString(&section_names, blob.name));
+  }
+  name_offsets.push_back(AddString(&section_names, ".shstrtab"));
+  place({".shstrtab", kSectionTypeStringTable, section_names});
+  uint64_t section_table_offset = (offset + 7) & ~static_cast<uint64_t>(7);
+  size_t section_count = blobs.size() + 1;
+
+  std::vector<uint8_t> out;
+  out.insert(out.end(), {0x7F, 'E', 'L', 'F'});
+  out.push_back(is_64bit_ ? 2 : 1);
+  out.push_back(big_endian_ ? 2 : 1);
+  out.push_back(1);  // EI_VERSION
+  out.resize(16, 0);
+  writer.Put16(&out, type_);
+  writer.Put16(&out, machine_);
+  writer.Put32(&out, 1);  // e_version
+  writer.PutWord(&out, kElfBaseAddress);  // e_entry
+  writer.PutWord(&out, header_size);      // e_phoff
+  writer.PutWord(&out, strip_section_table_ ? 0 : section_table_offset);
+  writer.Put32(&out, 0);  // e_flags
+  writer.Put16(&out, header_size);
+  writer.Put16(&out, segment_header_size);
+  writer.Put16(&out, segment_count);
+  writer.Put16(&out, strip_section_table_ ? 0 : section_header_size);
+  writer.Put16(&out, strip_section_table_ ? 0 : section_count);
+  writer.Put16(&out, strip_section_table_ ? 0 : section_count - 1);
+
+  uint64_t file_size =
+      strip_section_table_ ? offset
+                           : section_table_offset + section_count * section_header_size;
+  auto segment = [&](uint32_t type, uint64_t segment_offset, uint64_t size,
+                     uint64_t alignment) {
+    writer.Put32(&out, type);
+    if (is_64bit_) {
+      writer.Put32(&out, 4);  // p_flags, PF_R
+    }
+    writer.PutWord(&out, segment_offset);
+    writer.PutWord(&out, kElfBaseAddress + segment_offset);  // p_vaddr
+    writer.PutWord(&out, kElfBaseAddress + segment_offset);  // p_paddr
+    writer.PutWord(&out, size);                              // p_filesz
+    writer.PutWord(&out, size);                              // p_memsz
+    if (!is_64bit_) {
+      writer.Put32(&out, 4);  // p_flags, PF_R
+    }
+    writer.PutWord(&out, alignment);
+  };
+  segment(kSegmentTypeLoad, 0, file_size, 0x1000);
+  if (dynamic) {
+    segment(kSegmentTypeDynamic, blobs[dynamic_blob].offset,
+            blobs[dynamic_blob].data.size(), 8);
+  }
+  if (!build_id_.empty()) {
+    segment(kSegmentTypeNote, blobs[build_id_blob].offset,
+            blobs[build_id_blob].data.size(), 4);
+  }
+
+  for (const Blob& blob : blobs) {
+    out.resize(blob.offset, 0);
+    out.insert(out.end(), blob.data.begin(), blob.data.end());
+  }
+  if (strip_section_table_) {
+    return out;
+  }
+
+  out.resize(section_table_offset, 0);
+  out.resize(out.size() + section_header_size, 0);  // SHN_UNDEF
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    const Blob& blob = blobs[i];
+    writer.Put32(&out, name_offsets[i]);
+    writer.Put32(&out, blob.section_type);
+    writer.PutWord(&out, 0);                                // sh_flags
+    writer.PutWord(&out, kElfBaseAddress + blob.offset);    // sh_addr
+    writer.PutWord(&out, blob.offset);
+    writer.PutWord(&out, blob.data.size());
+    writer.Put32(&out, blob.link);
+    writer.Put32(&out, 0);  // sh_info
+    writer.PutWord(&out, blob.section_type == kSectionTypeNote ? 4 : 8);
+    writer.PutWord(&out, 0);  // sh_entsize
+  }
+  return out;
+}
+
+}  // namespace testing
+}  // namespace flutter_bin
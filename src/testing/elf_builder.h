@@ -0,0 +1,54 @@
+#ifndef FLUTTER_BIN_TESTING_ELF_BUILDER_H_
+#define FLUTTER_BIN_TESTING_ELF_BUILDER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_bin {
+namespace testing {
+
+// Emits a small ELF image with the notes, dynamic section and version
+// definitions a linker would produce, in either class and byte order. The
+// whole file is mapped by one PT_LOAD segment at kElfBaseAddress.
+class ElfBuilder {
+ public:
+  static constexpr uint64_t kElfBaseAddress = 0x400000;
+
+  ElfBuilder& Set64Bit(bool is_64bit);
+  ElfBuilder& SetBigEndian(bool big_endian);
+  ElfBuilder& SetType(uint16_t type);
+  ElfBuilder& SetMachine(uint16_t machine);
+  ElfBuilder& SetPie(bool pie);
+  ElfBuilder& SetBuildId(std::vector<uint8_t> build_id);
+  // Adds a .note.package (FDO packaging metadata) note holding |json|.
+  ElfBuilder& SetPackageMetadata(std::string json);
+  ElfBuilder& SetSoname(std::string soname);
+  ElfBuilder& AddNeeded(std::string library);
+  // Adds a non-base symbol version definition, e.g. "LIBFOO_1.2".
+  ElfBuilder& AddVersionDefinition(std::string name);
+  ElfBuilder& AddComment(std::string comment);
+  // Leaves out the section table, as sstrip does.
+  ElfBuilder& StripSectionTable();
+
+  std::vector<uint8_t> Build() const;
+
+ private:
+  bool is_64bit_ = true;
+  bool big_endian_ = false;
+  uint16_t type_ = 3;      // ET_DYN
+  uint16_t machine_ = 62;  // EM_X86_64
+  bool pie_ = false;
+  std::vector<uint8_t> build_id_;
+  std::string package_metadata_;
+  std::string soname_;
+  std::vector<std::string> needed_;
+  std::vector<std::string> version_definitions_;
+  std::vector<std::string> comments_;
+  bool strip_section_table_ = false;
+};
+
+}  // namespace testing
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_TESTING_ELF_BUILDER_H_
@@ -0,0 +1,289 @@
+#include "macho_builder.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flutter_bin {
+namespace testing {
+
+namespace {
+
+constexpr uint32_t kCommandSegment = 0x1;
+constexpr uint32_t kCommandIdDylib = 0xD;
+constexpr uint32_t kCommandSegment64 = 0x19;
+constexpr uint32_t kCommandUuid = 0x1B;
+constexpr uint32_t kCommandCodeSignature = 0x1D;
+constexpr uint32_t kCommandBuildVersion = 0x32;
+
+constexpr size_t kFatAlignment = 4096;
+
+// Appends fields in the byte order of the image being built.
+class Writer {
+ public:
+  explicit Writer(bool big_endian) : big_endian_(big_endian) {}
+
+  void Put(std::vector<uint8_t>* out, uint64_t value, size_t size) const {
+    for (size_t i = 0; i < size; ++i) {
+      size_t shift = big_endian_ ? (size - 1 - i) * 8 : i * 8;
+      out->push_back(static_cast<uint8_t>(value >> shift));
+    }
+  }
+  void Put32(std::vector<uint8_t>* out, uint64_t value) const {
+    Put(out, value, 4);
+  }
+  void Put64(std::vector<uint8_t>* out, uint64_t value) const {
+    Put(out, value, 8);
+  }
+
+ private:
+  bool big_endian_;
+};
+
+void Pad(std::vector<uint8_t>* out, size_t alignment) {
+  while (out->size() % alignment != 0) {
+    out->push_back(0);
+  }
+}
+
+void PutName(std::vector<uint8_t>* out, const char* name) {
+  std::string padded(name);
+  padded.resize(16, '\0');
+  out->insert(out->end(), padded.begin(), padded.end());
+}
+
+// Patches the cmdsize of the command starting at |start| to match |out|.
+void FinishCommand(const Writer& writer, std::vector<uint8_t>* out,
+                   size_t start) {
+  Pad(out, 8);
+  std::vector<uint8_t> size;
+  writer.Put32(&size, out->size() - start);
+  std::copy(size.begin(), size.end(), out->begin() + start + 4);
+}
+
+}  // namespace
+
+MachOBuilder& MachOBuilder::Set64Bit(bool is_64bit) {
+  is_64bit_ = is_64bit;
+  return *this;
+}
+
+MachOBuilder& MachOBuilder::SetBigEndian(bool big_endian) {
+  big_endian_ = big_endian;
+  return *this;
+}
+
+MachOBuilder& MachOBuilder::SetCpu(uint32_t cpu_type, uint32_t cpu_subtype) {
+  cpu_type_ = cpu_type;
+  cpu_subtype_ = cpu_subtype;
+  return *this;
+}
+
+MachOBuilder& MachOBuilder::SetFileType(uint32_t file_type) {
+  file_type_ = file_type;
+  return *this;
+}
+
+MachOBuilder& MachOBuilder::SetUuid(std::vector<uint8_t> uuid) {
+  uuid_ = std::move(uuid);
+  return *this;
+}
+
+MachOBuilder& MachOBuilder::SetBuildVersion(uint32_t platform,
+                                            uint32_t min_os, uint32_t sdk) {
+  build_version_command_ = kCommandBuildVersion;
+  platform_ = platform;
+  min_os_ = min_os;
+  sdk_ = sdk;
+  return *this;
+}
+
+MachOBuilder& MachOBuilder::SetVersionMin(uint32_t command, uint32_t min_os,
+                                          uint32_t sdk) {
+  build_version_command_ = command;
+  min_os_ = min_os;
+  sdk_ = sdk;
+  return *this;
+}
+
+MachOBuilder& MachOBuilder::SetDylibId(std::string install_name,
+                                       uint32_t current_version,
+                                       uint32_t compatibility_version) {
+  install_name_ = std::move(install_name);
+  current_version_ = current_version;
+  compatibility_version_ = compatibility_version;
+  return *this;
+}
+
+MachOBuilder& MachOBuilder::SetInfoPlist(std::string plist) {
+  info_plist_ = std::move(plist);
+  return *this;
+}
+
+MachOBuilder& MachOBuilder::SetCodeSignature(std::vector<uint8_t> super_blob) {
+  code_signature_ = std::move(super_blob);
+  return *this;
+}
+
+std::vector<uint8_t> MachOBuilder::Build() const {
+  Writer writer(big_endian_);
+  size_t header_size = is_64bit_ ? 32 : 28;
+  std::vector<uint8_t> commands;
+  uint32_t command_count = 0;
+  // Offset of the plist's section offset field, patched once it is placed.
+  size_t plist_offset_field = 0;
+  // Likewise for the code signature's dataoff.
+  size_t signature_offset_field = 0;
+
+  if (!info_plist_.empty()) {
+    size_t start = commands.size();
+    writer.Put32(&commands, is_64bit_ ? kCommandSegment64 : kCommandSegment);
+    writer.Put32(&commands, 0);
+    PutName(&commands, "__TEXT");
+    if (is_64bit_) {
+      writer.Put64(&commands, 0x100000000);  // vmaddr
+      writer.Put64(&commands, 0x4000);       // vmsize
+      writer.Put64(&commands, 0);            // fileoff
+      writer.Put64(&commands, 0x4000);       // filesize
+    } else {
+      writer.Put32(&commands, 0x1000);
+      writer.Put32(&commands, 0x4000);
+      writer.Put32(&commands, 0);
+      writer.Put32(&commands, 0x4000);
+    }
+    writer.Put32(&commands, 5);  // maxprot
+    writer.Put32(&commands, 5);  // initprot
+    writer.Put32(&commands, 2);  // nsects
+    writer.Put32(&commands, 0);  // flags
+    for (const char* name : {"__text", "__info_plist"}) {
+      bool plist = std::string(name) == "__info_plist";
+      PutName(&commands, name);
+      PutName(&commands, "__TEXT");
+      if (is_64bit_) {
+        writer.Put64(&commands, 0);
+        writer.Put64(&commands, plist ? info_plist_.size() : 0);
+      } else {
+        writer.Put32(&commands, 0);
+        writer.Put32(&commands, plist ? info_plist_.size() : 0);
+      }
+      if (plist) {
+        plist_offset_field = commands.size();
+      }
+      writer.Put32(&commands, 0);  // offset
+      for (int i = 0; i < (is_64bit_ ? 7 : 6); ++i) {
+        writer.Put32(&commands, 0);
+      }
+    }
+    FinishCommand(writer, &commands, start);
+    ++command_count;
+  }
+  if (!uuid_.empty()) {
+    size_t start = commands.size();
+    writer.Put32(&commands, kCommandUuid);
+    writer.Put32(&commands, 0);
+    commands.insert(commands.end(), uuid_.begin(), uuid_.end());
+    FinishCommand(writer, &commands, start);
+    ++command_count;
+  }
+  if (build_version_command_ != 0) {
+    size_t start = commands.size();
+    writer.Put32(&commands, build_version_command_);
+    writer.Put32(&commands, 0);
+    if (build_version_command_ == kCommandBuildVersion) {
+      writer.Put32(&commands, platform_);
+    }
+    writer.Put32(&commands, min_os_);
+    writer.Put32(&commands, sdk_);
+    if (build_version_command_ == kCommandBuildVersion) {
+      writer.Put32(&commands, 0);  // ntools
+    }
+    FinishCommand(writer, &commands, start);
+    ++command_count;
+  }
+  if (!install_name_.empty()) {
+    size_t start = commands.size();
+    writer.Put32(&commands, kCommandIdDylib);
+    writer.Put32(&commands, 0);
+    writer.Put32(&commands, 24);  // name offset
+    writer.Put32(&commands, 2);   // timestamp
+    writer.Put32(&commands, current_version_);
+    writer.Put32(&commands, compatibility_version_);
+    commands.insert(commands.end(), install_name_.begin(),
+                    install_name_.end());
+    commands.push_back(0);
+    FinishCommand(writer, &commands, start);
+    ++command_count;
+  }
+  if (!code_signature_.empty()) {
+    size_t start = commands.size();
+    writer.Put32(&commands, kCommandCodeSignature);
+    writer.Put32(&commands, 0);
+    signature_offset_field = commands.size();
+    writer.Put32(&commands, 0);  // dataoff
+    writer.Put32(&commands, code_signature_.size());
+    FinishCommand(writer, &commands, start);
+    ++command_count;
+  }
+
+  std::vector<uint8_t> image;
+  writer.Put32(&image, is_64bit_ ? 0xFEEDFACF : 0xFEEDFACE);
+  writer.Put32(&image, cpu_type_);
+  writer.Put32(&image, cpu_subtype_);
+  writer.Put32(&image, file_type_);
+  writer.Put32(&image, command_count);
+  writer.Put32(&image, commands.size());
+  writer.Put32(&image, 0);  // flags
+  if (is_64bit_) {
+    writer.Put32(&image, 0);  // reserved
+  }
+  image.insert(image.end(), commands.begin(), commands.end());
+  if (!info_plist_.empty()) {
+    Pad(&image, 16);
+    std::vector<uint8_t> offset;
+    writer.Put32(&offset, image.size());
+    std::copy(offset.begin(), offset.end(),
+              image.begin() + header_size + plist_offset_field);
+    image.insert(image.end(), info_plist_.begin(), info_plist_.end());
+  }
+  if (!code_signature_.empty()) {
+    Pad(&image, 16);
+    std::vector<uint8_t> offset;
+    writer.Put32(&offset, image.size());
+    std::copy(offset.begin(), offset.end(),
+              image.begin() + header_size + signature_offset_field);
+    image.insert(image.end(), code_signature_.begin(), code_signature_.end());
+  }
+  return image;
+}
+
+std::vector<uint8_t> BuildUniversal(const std::vector<MachOFatSlice>& slices,
+                                    bool fat64) {
+  Writer writer(true);
+  std::vector<uint8_t> file;
+  writer.Put32(&file, fat64 ? 0xCAFEBABF : 0xCAFEBABE);
+  writer.Put32(&file, slices.size());
+  size_t offset = kFatAlignment;
+  for (const MachOFatSlice& slice : slices) {
+    writer.Put32(&file, slice.cpu_type);
+    writer.Put32(&file, slice.cpu_subtype);
+    if (fat64) {
+      writer.Put64(&file, offset);
+      writer.Put64(&file, slice.image.size());
+      writer.Put32(&file, 12);  // align, as a power of two
+      writer.Put32(&file, 0);   // reserved
+    } else {
+      writer.Put32(&file, offset);
+      writer.Put32(&file, slice.image.size());
+      writer.Put32(&file, 12);
+    }
+    offset += (slice.image.size() + kFatAlignment - 1) / kFatAlignment *
+              kFatAlignment;
+  }
+  for (const MachOFatSlice& slice : slices) {
+    Pad(&file, kFatAlignment);
+    file.insert(file.end(), slice.image.begin(), slice.image.end());
+  }
+  return file;
+}
+
+}  // namespace testing
+}  // namespace flutter_bin
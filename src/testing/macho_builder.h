@@ -0,0 +1,68 @@
+#ifndef FLUTTER_BIN_TESTING_MACHO_BUILDER_H_
+#define FLUTTER_BIN_TESTING_MACHO_BUILDER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_bin {
+namespace testing {
+
+// Emits a thin Mach-O image with the load commands a linker would produce,
+// in either word size and byte order. The Info.plist, when set, is stored
+// after the load commands in a __TEXT,__info_plist section.
+class MachOBuilder {
+ public:
+  MachOBuilder& Set64Bit(bool is_64bit);
+  MachOBuilder& SetBigEndian(bool big_endian);
+  MachOBuilder& SetCpu(uint32_t cpu_type, uint32_t cpu_subtype = 0);
+  MachOBuilder& SetFileType(uint32_t file_type);
+  MachOBuilder& SetUuid(std::vector<uint8_t> uuid);
+  // Adds LC_BUILD_VERSION. Versions are packed X.Y.Z in 16.8.8 bits.
+  MachOBuilder& SetBuildVersion(uint32_t platform, uint32_t min_os,
+                                uint32_t sdk);
+  // Adds an LC_VERSION_MIN_* command of type |command|.
+  MachOBuilder& SetVersionMin(uint32_t command, uint32_t min_os, uint32_t sdk);
+  MachOBuilder& SetDylibId(std::string install_name, uint32_t current_version,
+                           uint32_t compatibility_version);
+  MachOBuilder& SetInfoPlist(std::string plist);
+  // Adds LC_CODE_SIGNATURE pointing at |super_blob|, which is stored last,
+  // e.g. from BuildCodeSignatureSuperBlob().
+  MachOBuilder& SetCodeSignature(std::vector<uint8_t> super_blob);
+
+  std::vector<uint8_t> Build() const;
+
+ private:
+  bool is_64bit_ = true;
+  bool big_endian_ = false;
+  uint32_t cpu_type_ = 0x0100000C;  // CPU_TYPE_ARM64
+  uint32_t cpu_subtype_ = 0;
+  uint32_t file_type_ = 2;  // MH_EXECUTE
+  std::vector<uint8_t> uuid_;
+  uint32_t build_version_command_ = 0;
+  uint32_t platform_ = 0;
+  uint32_t min_os_ = 0;
+  uint32_t sdk_ = 0;
+  std::string install_name_;
+  uint32_t current_version_ = 0;
+  uint32_t compatibility_version_ = 0;
+  std::string info_plist_;
+  std::vector<uint8_t> code_signature_;
+};
+
+// One slice of a universal binary built by BuildUniversal().
+struct MachOFatSlice {
+  uint32_t cpu_type = 0;
+  uint32_t cpu_subtype = 0;
+  std::vector<uint8_t> image;
+};
+
+// Wraps |slices| in a fat header (FAT_MAGIC_64 if |fat64|), aligning each
+// slice to 4 KiB.
+std::vector<uint8_t> BuildUniversal(const std::vector<MachOFatSlice>& slices,
+                                    bool fat64 = false);
+
+}  // namespace testing
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_TESTING_MACHO_BUILDER_H_
@@ -0,0 +1,488 @@
+#include "pe_builder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+
+namespace flutter_bin {
+namespace testing {
+
+namespace {
+
+constexpr uint32_t kFileAlignment = 0x200;
+constexpr uint32_t kSectionAlignment = 0x1000;
+constexpr uint32_t kSizeOfHeaders = 0x400;
+constexpr uint32_t kNtHeaderOffset = 0x80;
+
+void Put16(std::vector<uint8_t>* out, size_t offset, uint32_t value) {
+  (*out)[offset] = static_cast<uint8_t>(value);
+  (*out)[offset + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+void Put32(std::vector<uint8_t>* out, size_t offset, uint32_t value) {
+  Put16(out, offset, value & 0xFFFF);
+  Put16(out, offset + 2, value >> 16);
+}
+
+void Append16(std::vector<uint8_t>* out, uint32_t value) {
+  out->push_back(static_cast<uint8_t>(value));
+  out->push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void Append32(std::vector<uint8_t>* out, uint32_t value) {
+  Append16(out, value & 0xFFFF);
+  Append16(out, value >> 16);
+}
+
+void Pad4(std::vector<uint8_t>* out) {
+  while (out->size() % 4 != 0) {
+    out->push_back(0);
+  }
+}
+
+void AppendString(std::vector<uint8_t>* out, const std::string& value) {
+  out->insert(out->end(), value.begin(), value.end());
+  out->push_back(0);
+}
+
+uint32_t AlignTo(size_t value, uint32_t alignment) {
+  return static_cast<uint32_t>((value + alignment - 1) / alignment * alignment);
+}
+
+// Appends one version node: header, key, value and pre-serialized children.
+void AppendNode(std::vector<uint8_t>* out, const std::u16string& key,
+                const std::vector<uint8_t>& value, uint16_t value_length,
+                uint16_t type, const std::vector<uint8_t>& children) {
+  Pad4(out);
+  size_t start = out->size();
+  Append16(out, 0);  // Patched below.
+  Append16(out, value_length);
+  Append16(out, type);
+  for (char16_t c : key) {
+    Append16(out, c);
+  }
+  Append16(out, 0);
+  Pad4(out);
+  out->insert(out->end(), value.begin(), value.end());
+  if (!children.empty()) {
+    Pad4(out);
+    out->insert(out->end(), children.begin(), children.end());
+  }
+  Put16(out, start, static_cast<uint32_t>(out->size() - start));
+}
+
+std::u16string HexKey(uint32_t translation) {
+  static const char kDigits[] = "0123456789ABCDEF";
+  std::u16string key;
+  for (int shift = 28; shift >= 0; shift -= 4) {
+    key.push_back(static_cast<char16_t>(kDigits[(translation >> shift) & 0xF]));
+  }
+  return key;
+}
+
+}  // namespace
+
+VersionInfoBuilder& VersionInfoBuilder::SetFileVersion(uint16_t major,
+                                                       uint16_t minor,
+                                                       uint16_t build,
+                                                       uint16_t revision) {
+  file_version_ms_ = (static_cast<uint32_t>(major) << 16) | minor;
+  file_version_ls_ = (static_cast<uint32_t>(build) << 16) | revision;
+  return *this;
+}
+
+VersionInfoBuilder& VersionInfoBuilder::AddStringTable(uint32_t translation,
+                                                       StringTable strings) {
+  tables_.emplace_back(translation, std::move(strings));
+  return *this;
+}
+
+VersionInfoBuilder& VersionInfoBuilder::AddTranslation(uint32_t translation) {
+  translations_.push_back(translation);
+  return *this;
+}
+
+VersionInfoBuilder& VersionInfoBuilder::OmitFixedFileInfo() {
+  fixed_file_info_ = false;
+  return *this;
+}
+
+std::vector<uint8_t> VersionInfoBuilder::Build() const {
+  std::vector<uint8_t> fixed;
+  if (fixed_file_info_) {
+    const uint32_t fields[13] = {0xFEEF04BD,       0x00010000,
+                                 file_version_ms_, file_version_ls_,
+                                 file_version_ms_, file_version_ls_,
+                                 0x3F,             0,
+                                 0x40004,          1,
+                                 0,                0,
+                                 0};
+    for (uint32_t field : fields) {
+      Append32(&fixed, field);
+    }
+  }
+
+  std::vector<uint8_t> children;
+  if (!tables_.empty()) {
+    std::vector<uint8_t> tables;
+    for (const auto& table : tables_) {
+      std::vector<uint8_t> strings;
+      for (const auto& entry : table.second) {
+        std::vector<uint8_t> value;
+        for (char16_t c : entry.second) {
+          Append16(&value, c);
+        }
+        Append16(&value, 0);
+        AppendNode(&strings, entry.first, value,
+                   static_cast<uint16_t>(entry.second.size() + 1), 1, {});
+      }
+      AppendNode(&tables, HexKey(table.first), {}, 0, 1, strings);
+    }
+    AppendNode(&children, u"StringFileInfo", {}, 0, 1, tables);
+  }
+  if (!translations_.empty()) {
+    std::vector<uint8_t> value;
+    for (uint32_t translation : translations_) {
+      Append16(&value, translation >> 16);
+      Append16(&value, translation & 0xFFFF);
+    }
+    std::vector<uint8_t> var;
+    AppendNode(&var, u"Translation", value,
+               static_cast<uint16_t>(value.size()), 0, {});
+    AppendNode(&children, u"VarFileInfo", {}, 0, 1, var);
+  }
+
+  std::vector<uint8_t> blob;
+  AppendNode(&blob, u"VS_VERSION_INFO", fixed,
+             static_cast<uint16_t>(fixed.size()), 0, children);
+  return blob;
+}
+
+PeBuilder& PeBuilder::SetPe32Plus(bool pe32_plus) {
+  pe32_plus_ = pe32_plus;
+  return *this;
+}
+
+PeBuilder& PeBuilder::AddVersionResource(std::vector<uint8_t> blob,
+                                         uint16_t language) {
+  resources_.push_back({16, language, std::move(blob)});
+  return *this;
+}
+
+PeBuilder& PeBuilder::AddResourceType(uint16_t type, size_t data_size) {
+  resources_.push_back(
+      {type, 0x0409, std::vector<uint8_t>(data_size, static_cast<uint8_t>(type))});
+  return *this;
+}
+
+PeBuilder& PeBuilder::AddSection(const std::string& name, size_t size) {
+  sections_.push_back({name, std::vector<uint8_t>(size, 0xCC)});
+  return *this;
+}
+
+PeBuilder& PeBuilder::SetOverlaySize(size_t size) {
+  overlay_size_ = size;
+  return *this;
+}
+
+PeBuilder& PeBuilder::SetCertificateTableSize(size_t size) {
+  return SetCertificateTable(std::vector<uint8_t>(size, 0xAB));
+}
+
+PeBuilder& PeBuilder::SetCertificateTable(std::vector<uint8_t> table) {
+  certificate_table_ = std::move(table);
+  return *this;
+}
+
+PeBuilder& PeBuilder::AddImport(const std::string& module,
+                                std::vector<std::string> functions,
+                                bool delay_loaded) {
+  imports_.push_back({module, std::move(functions), delay_loaded});
+  return *this;
+}
+
+PeBuilder& PeBuilder::SetExports(const std::string& module,
+                                 std::vector<std::string> names,
+                                 size_t ordinal_only, uint32_t base) {
+  has_exports_ = true;
+  export_module_ = module;
+  export_names_ = std::move(names);
+  export_ordinal_only_ = ordinal_only;
+  export_base_ = base;
+  return *this;
+}
+
+std::vector<uint8_t> PeBuilder::BuildImportSection(uint32_t rva,
+                                                   size_t* delay_offset) const {
+  size_t regular = 0;
+  for (const Import& import : imports_) {
+    regular += import.delay_loaded ? 0 : 1;
+  }
+  size_t delayed = imports_.size() - regular;
+  *delay_offset = (regular + 1) * 20;
+  // Both descriptor tables end in a zero descriptor.
+  std::vector<uint8_t> out(*delay_offset + (delayed + 1) * 32, 0);
+
+  size_t thunk_size = pe32_plus_ ? 8 : 4;
+  size_t regular_index = 0;
+  size_t delayed_index = 0;
+  for (const Import& import : imports_) {
+    // Lookup table, then an identical address table.
+    size_t table_size = (import.functions.size() + 1) * thunk_size;
+    size_t lookup = out.size();
+    size_t address = lookup + table_size;
+    out.resize(address + table_size, 0);
+    for (size_t i = 0; i < import.functions.size(); ++i) {
+      const std::string& function = import.functions[i];
+      uint64_t thunk = 0;
+      if (!function.empty() && function[0] == '#') {
+        thunk = std::stoul(function.substr(1)) |
+                (pe32_plus_ ? uint64_t{1} << 63 : uint64_t{1} << 31);
+      } else {
+        Pad4(&out);
+        thunk = rva + out.size();
+        Append16(&out, static_cast<uint32_t>(i));  // Hint.
+        AppendString(&out, function);
+      }
+      for (size_t copy : {lookup, address}) {
+        Put32(&out, copy + i * thunk_size, static_cast<uint32_t>(thunk));
+        if (pe32_plus_) {
+          Put32(&out, copy + i * thunk_size + 4,
+                static_cast<uint32_t>(thunk >> 32));
+        }
+      }
+    }
+    uint32_t name_rva = rva + static_cast<uint32_t>(out.size());
+    AppendString(&out, import.module);
+    Pad4(&out);
+
+    if (import.delay_loaded) {
+      size_t descriptor = *delay_offset + 32 * delayed_index++;
+      Put32(&out, descriptor, 1);  // Attributes: RVA based.
+      Put32(&out, descriptor + 4, name_rva);
+      Put32(&out, descriptor + 12, rva + static_cast<uint32_t>(address));
+      Put32(&out, descriptor + 16, rva + static_cast<uint32_t>(lookup));
+    } else {
+      size_t descriptor = 20 * regular_index++;
+      Put32(&out, descriptor, rva + static_cast<uint32_t>(lookup));
+      Put32(&out, descriptor + 12, name_rva);
+      Put32(&out, descriptor + 16, rva + static_cast<uint32_t>(address));
+    }
+  }
+  return out;
+}
+
+std::vector<uint8_t> PeBuilder::BuildExportSection(uint32_t rva) const {
+  size_t name_count = export_names_.size();
+  size_t function_count = name_count + export_ordinal_only_ + 1;
+  size_t functions = 40;
+  size_t names = functions + 4 * function_count;
+  size_t ordinals = names + 4 * name_count;
+  std::vector<uint8_t> out(ordinals + 2 * name_count, 0);
+  Pad4(&out);
+
+  Put32(&out, 12, rva + static_cast<uint32_t>(out.size()));
+  AppendString(&out, export_module_);
+  Put32(&out, 16, export_base_);
+  Put32(&out, 20, static_cast<uint32_t>(function_count));
+  Put32(&out, 24, static_cast<uint32_t>(name_count));
+  Put32(&out, 28, rva + static_cast<uint32_t>(functions));
+  Put32(&out, 32, rva + static_cast<uint32_t>(names));
+  Put32(&out, 36, rva + static_cast<uint32_t>(ordinals));
+  // Every function but the last slot points somewhere into .text.
+  for (size_t i = 0; i + 1 < function_count; ++i) {
+    Put32(&out, functions + 4 * i,
+          kSectionAlignment + static_cast<uint32_t>(i));
+  }
+  for (size_t i = 0; i < name_count; ++i) {
+    Put32(&out, names + 4 * i, rva + static_cast<uint32_t>(out.size()));
+    Put16(&out, ordinals + 2 * i, static_cast<uint32_t>(i));
+    AppendString(&out, export_names_[i]);
+  }
+  return out;
+}
+
+std::vector<uint8_t> PeBuilder::BuildResourceSection(uint32_t rva) const {
+  // type -> language -> resource index
+  std::map<uint16_t, std::map<uint16_t, size_t>> tree;
+  for (size_t i = 0; i < resources_.size(); ++i) {
+    tree[resources_[i].type][resources_[i].language] = i;
+  }
+
+  size_t type_dirs = 16 + 8 * tree.size();
+  size_t name_dirs = type_dirs + tree.size() * (16 + 8);
+  size_t data_entries = name_dirs;
+  for (const auto& type : tree) {
+    data_entries += 16 + 8 * type.second.size();
+  }
+  size_t blobs = data_entries + 16 * resources_.size();
+
+  std::vector<uint8_t> out(blobs, 0);
+  auto put_dir = [&out](size_t offset, size_t id_entries) {
+    Put16(&out, offset + 14, static_cast<uint32_t>(id_entries));
+  };
+
+  put_dir(0, tree.size());
+  size_t type_index = 0;
+  size_t name_dir = name_dirs;
+  size_t data_entry = data_entries;
+  for (const auto& type : tree) {
+    size_t type_dir = type_dirs + type_index * (16 + 8);
+    Put32(&out, 16 + 8 * type_index, type.first);
+    Put32(&out, 16 + 8 * type_index + 4,
+          0x80000000u | static_cast<uint32_t>(type_dir));
+
+    put_dir(type_dir, 1);
+    Put32(&out, type_dir + 16, 1);
+    Put32(&out, type_dir + 20, 0x80000000u | static_cast<uint32_t>(name_dir));
+
+    put_dir(name_dir, type.second.size());
+    size_t lang_index = 0;
+    for (const auto& language : type.second) {
+      Put32(&out, name_dir + 16 + 8 * lang_index, language.first);
+      Put32(&out, name_dir + 16 + 8 * lang_index + 4,
+            static_cast<uint32_t>(data_entry));
+
+      const std::vector<uint8_t>& data = resources_[language.second].data;
+      Pad4(&out);
+      Put32(&out, data_entry, rva + static_cast<uint32_t>(out.size()));
+      Put32(&out, data_entry + 4, static_cast<uint32_t>(data.size()));
+      out.insert(out.end(), data.begin(), data.end());
+
+      data_entry += 16;
+      ++lang_index;
+    }
+    name_dir += 16 + 8 * type.second.size();
+    ++type_index;
+  }
+  return out;
+}
+
+std::vector<uint8_t> PeBuilder::Build() const {
+  std::vector<Section> sections;
+  sections.push_back({".text", std::vector<uint8_t>(0x200, 0xC3)});
+  sections.insert(sections.end(), sections_.begin(), sections_.end());
+
+  uint32_t import_rva = 0;
+  uint32_t import_size = 0;
+  uint32_t delay_rva = 0;
+  uint32_t delay_size = 0;
+  if (!imports_.empty()) {
+    import_rva = kSectionAlignment * static_cast<uint32_t>(sections.size() + 1);
+    size_t delay_offset = 0;
+    std::vector<uint8_t> idata = BuildImportSection(import_rva, &delay_offset);
+    import_size = static_cast<uint32_t>(delay_offset);
+    delay_rva = import_rva + import_size;
+    delay_size = static_cast<uint32_t>(idata.size()) - import_size;
+    sections.push_back({".idata", std::move(idata)});
+  }
+
+  uint32_t export_rva = 0;
+  uint32_t export_size = 0;
+  if (has_exports_) {
+    export_rva = kSectionAlignment * static_cast<uint32_t>(sections.size() + 1);
+    sections.push_back({".edata", BuildExportSection(export_rva)});
+    export_size = static_cast<uint32_t>(sections.back().data.size());
+  }
+
+  uint32_t rsrc_rva = 0;
+  uint32_t rsrc_size = 0;
+  if (!resources_.empty()) {
+    rsrc_rva = kSectionAlignment * static_cast<uint32_t>(sections.size() + 1);
+    sections.push_back({".rsrc", BuildResourceSection(rsrc_rva)});
+    rsrc_size = static_cast<uint32_t>(sections.back().data.size());
+  }
+
+  std::vector<uint8_t> image(kSizeOfHeaders, 0);
+  Put16(&image, 0, 0x5A4D);
+  Put32(&image, 0x3C, kNtHeaderOffset);
+  Put32(&image, kNtHeaderOffset, 0x00004550);
+
+  size_t file_header = kNtHeaderOffset + 4;
+  uint32_t optional_size = pe32_plus_ ? 240 : 224;
+  Put16(&image, file_header, pe32_plus_ ? 0x8664 : 0x14C);
+  Put16(&image, file_header + 2, static_cast<uint32_t>(sections.size()));
+  Put16(&image, file_header + 16, optional_size);
+  Put16(&image, file_header + 18, 0x0102);
+
+  size_t optional = file_header + 20;
+  size_t directories = optional + (pe32_plus_ ? 112 : 96);
+  Put16(&image, optional, pe32_plus_ ? 0x20B : 0x10B);
+  Put32(&image, optional + 32, kSectionAlignment);
+  Put32(&image, optional + 36, kFileAlignment);
+  Put32(&image, optional + 56,
+        kSectionAlignment * static_cast<uint32_t>(sections.size() + 1));
+  Put32(&image, optional + 60, kSizeOfHeaders);
+  Put16(&image, optional + 68, 2);
+  Put32(&image, directories - 4, 16);
+  Put32(&image, directories, export_rva);
+  Put32(&image, directories + 4, export_size);
+  Put32(&image, directories + 8, import_rva);
+  Put32(&image, directories + 8 + 4, import_size);
+  Put32(&image, directories + 2 * 8, rsrc_rva);
+  Put32(&image, directories + 2 * 8 + 4, rsrc_size);
+  Put32(&image, directories + 13 * 8, delay_rva);
+  Put32(&image, directories + 13 * 8 + 4, delay_size);
+
+  size_t section_header = optional + optional_size;
+  for (size_t i = 0; i < sections.size(); ++i) {
+    const Section& section = sections[i];
+    size_t header = section_header + i * 40;
+    for (size_t c = 0; c < section.name.size() && c < 8; ++c) {
+      image[header + c] = static_cast<uint8_t>(section.name[c]);
+    }
+    uint32_t raw_size = AlignTo(section.data.size(), kFileAlignment);
+    Put32(&image, header + 8, static_cast<uint32_t>(section.data.size()));
+    Put32(&image, header + 12, kSectionAlignment * static_cast<uint32_t>(i + 1));
+    Put32(&image, header + 16, raw_size);
+    Put32(&image, header + 20, static_cast<uint32_t>(image.size()));
+    Put32(&image, header + 36, 0x40000040);
+
+    image.insert(image.end(), section.data.begin(), section.data.end());
+    image.resize(image.size() + raw_size - section.data.size(), 0);
+  }
+
+  image.resize(image.size() + overlay_size_, 0xEE);
+  if (!certificate_table_.empty()) {
+    image.resize(AlignTo(image.size(), 8), 0);
+    Put32(&image, directories + 4 * 8, static_cast<uint32_t>(image.size()));
+    Put32(&image, directories + 4 * 8 + 4,
+          static_cast<uint32_t>(certificate_table_.size()));
+    image.insert(image.end(), certificate_table_.begin(),
+                 certificate_table_.end());
+  }
+  return image;
+}
+
+bool PeBuilder::WriteTo(const std::string& path) const {
+  return WriteFile(path, Build());
+}
+
+bool WriteFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(bytes.data()),
+            static_cast<std::streamsize>(bytes.size()));
+  return out.good();
+}
+
+std::string TempPath(const std::string& name) {
+  static std::atomic<int> counter{0};
+  static const unsigned int session = std::random_device()();
+  const char* dir = std::getenv("TMPDIR");
+#if defined(_WIN32)
+  if (dir == nullptr) {
+    dir = std::getenv("TEMP");
+  }
+#endif
+  std::string base = dir != nullptr ? dir : "/tmp";
+  return base + "/flutter_bin_" + std::to_string(session) + "_" +
+         std::to_string(counter++) + "_" + name;
+}
+
+}  // namespace testing
+}  // namespace flutter_bin
@@ -0,0 +1,115 @@
+#ifndef FLUTTER_BIN_TESTING_PE_BUILDER_H_
+#define FLUTTER_BIN_TESTING_PE_BUILDER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flutter_bin {
+namespace testing {
+
+// Serializes a VS_VERSIONINFO blob the way rc.exe lays it out.
+class VersionInfoBuilder {
+ public:
+  using StringTable = std::vector<std::pair<std::u16string, std::u16string>>;
+
+  VersionInfoBuilder& SetFileVersion(uint16_t major, uint16_t minor,
+                                     uint16_t build, uint16_t revision);
+  VersionInfoBuilder& AddStringTable(uint32_t translation, StringTable strings);
+  VersionInfoBuilder& AddTranslation(uint32_t translation);
+  VersionInfoBuilder& OmitFixedFileInfo();
+
+  std::vector<uint8_t> Build() const;
+
+ private:
+  uint32_t file_version_ms_ = 0;
+  uint32_t file_version_ls_ = 0;
+  bool fixed_file_info_ = true;
+  std::vector<std::pair<uint32_t, StringTable>> tables_;
+  std::vector<uint32_t> translations_;
+};
+
+// Emits a minimal but well-formed PE32/PE32+ image on disk or in memory.
+class PeBuilder {
+ public:
+  PeBuilder& SetPe32Plus(bool pe32_plus);
+  // Adds the VS_VERSIONINFO blob as RT_VERSION/1/|language|.
+  PeBuilder& AddVersionResource(std::vector<uint8_t> blob,
+                                uint16_t language = 0x0409);
+  // Adds an unrelated resource type that sorts before RT_VERSION.
+  PeBuilder& AddResourceType(uint16_t type, size_t data_size);
+  // Adds an extra section filled with |size| bytes. Sections are laid out a
+  // page apart, so |size| must be at most 4 KiB.
+  PeBuilder& AddSection(const std::string& name, size_t size);
+  // Appends |size| bytes of overlay after the last section.
+  PeBuilder& SetOverlaySize(size_t size);
+  // Appends a |size|-byte certificate table after the overlay, 8-byte
+  // aligned as signtool does, and points the security directory at it.
+  PeBuilder& SetCertificateTableSize(size_t size);
+  // Same with the given table, e.g. from BuildWinCertificate().
+  PeBuilder& SetCertificateTable(std::vector<uint8_t> table);
+  // Adds an import descriptor for |module| to the import directory, or to
+  // the delay-load directory. Functions named "#<n>" are imported by
+  // ordinal n.
+  PeBuilder& AddImport(const std::string& module,
+                       std::vector<std::string> functions,
+                       bool delay_loaded = false);
+  // Adds an export directory naming the image |module|, exporting |names|
+  // and then |ordinal_only| functions without a name. The address table
+  // ends in one unused (zero) slot.
+  PeBuilder& SetExports(const std::string& module,
+                        std::vector<std::string> names,
+                        size_t ordinal_only = 0, uint32_t base = 1);
+
+  std::vector<uint8_t> Build() const;
+
+  // Writes the image to |path|. Returns false on I/O failure.
+  bool WriteTo(const std::string& path) const;
+
+ private:
+  struct Section {
+    std::string name;
+    std::vector<uint8_t> data;
+  };
+  struct Resource {
+    uint16_t type;
+    uint16_t language;
+    std::vector<uint8_t> data;
+  };
+  struct Import {
+    std::string module;
+    std::vector<std::string> functions;
+    bool delay_loaded;
+  };
+
+  std::vector<uint8_t> BuildResourceSection(uint32_t rva) const;
+  // Lays out both import directories; |*delay_offset| receives the offset
+  // of the delay-load descriptors within the section.
+  std::vector<uint8_t> BuildImportSection(uint32_t rva,
+                                          size_t* delay_offset) const;
+  std::vector<uint8_t> BuildExportSection(uint32_t rva) const;
+
+  bool pe32_plus_ = false;
+  std::vector<Section> sections_;
+  std::vector<Resource> resources_;
+  size_t overlay_size_ = 0;
+  std::vector<uint8_t> certificate_table_;
+  std::vector<Import> imports_;
+  bool has_exports_ = false;
+  std::string export_module_;
+  std::vector<std::string> export_names_;
+  size_t export_ordinal_only_ = 0;
+  uint32_t export_base_ = 1;
+};
+
+// Writes |bytes| to |path|. Returns false on I/O failure.
+bool WriteFile(const std::string& path, const std::vector<uint8_t>& bytes);
+
+// Returns a fresh path inside the system temp directory.
+std::string TempPath(const std::string& name);
+
+}  // namespace testing
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_TESTING_PE_BUILDER_H_
@@ -0,0 +1,438 @@
+#include "plist_builder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace flutter_bin {
+namespace testing {
+
+namespace {
+
+constexpr double kPlistEpoch = 978307200.0;
+
+void AppendXmlEscaped(const std::string& text, std::string* out) {
+  for (char c : text) {
+    switch (c) {
+      case '&':
+        *out += "&amp;";
+        break;
+      case '<':
+        *out += "&lt;";
+        break;
+      case '>':
+        *out += "&gt;";
+        break;
+      default:
+        out->push_back(c);
+        break;
+    }
+  }
+}
+
+void AppendBase64(const std::vector<uint8_t>& bytes, std::string* out) {
+  static const char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  for (size_t i = 0; i < bytes.size(); i += 3) {
+    size_t remaining = bytes.size() - i;
+    uint32_t chunk = static_cast<uint32_t>(bytes[i]) << 16;
+    if (remaining > 1) {
+      chunk |= static_cast<uint32_t>(bytes[i + 1]) << 8;
+    }
+    if (remaining > 2) {
+      chunk |= bytes[i + 2];
+    }
+    out->push_back(kAlphabet[(chunk >> 18) & 0x3F]);
+    out->push_back(kAlphabet[(chunk >> 12) & 0x3F]);
+    out->push_back(remaining > 1 ? kAlphabet[(chunk >> 6) & 0x3F] : '=');
+    out->push_back(remaining > 2 ? kAlphabet[chunk & 0x3F] : '=');
+  }
+}
+
+std::string FormatDate(double seconds) {
+  std::time_t time = static_cast<std::time_t>(seconds + kPlistEpoch);
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ",
+                std::gmtime(&time));
+  return buffer;
+}
+
+void AppendXml(const PlistNode& node, int depth, std::string* out) {
+  std::string indent(static_cast<size_t>(depth), '\t');
+  switch (node.type) {
+    case PlistType::kString:
+      *out += indent + "<string>";
+      AppendXmlEscaped(node.text, out);
+      *out += "</string>\n";
+      break;
+    case PlistType::kInteger:
+      *out += indent + "<integer>" + std::to_string(node.integer) +
+              "</integer>\n";
+      break;
+    case PlistType::kReal: {
+      char buffer[32];
+      std::snprintf(buffer, sizeof(buffer), "%.17g", node.real);
+      *out += indent + "<real>" + buffer + "</real>\n";
+      break;
+    }
+    case PlistType::kBoolean:
+      *out += indent + (node.boolean ? "<true/>\n" : "<false/>\n");
+      break;
+    case PlistType::kDate:
+      *out += indent + "<date>" + FormatDate(node.real) + "</date>\n";
+      break;
+    case PlistType::kData:
+      *out += indent + "<data>";
+      AppendBase64(node.data, out);
+      *out += "</data>\n";
+      break;
+    case PlistType::kArray:
+      *out += indent + "<array>\n";
+      for (const PlistNode& item : node.items) {
+        AppendXml(item, depth + 1, out);
+      }
+      *out += indent + "</array>\n";
+      break;
+    case PlistType::kDictionary:
+      *out += indent + "<dict>\n";
+      for (const auto& entry : node.entries) {
+        *out += indent + "\t<key>";
+        AppendXmlEscaped(entry.first, out);
+        *out += "</key>\n";
+        AppendXml(entry.second, depth + 1, out);
+      }
+      *out += indent + "</dict>\n";
+      break;
+    case PlistType::kOther:
+      break;
+  }
+}
+
+// Decodes UTF-8 into UTF-16 code units.
+std::vector<uint16_t> ToUtf16(const std::string& text) {
+  std::vector<uint16_t> units;
+  for (size_t i = 0; i < text.size();) {
+    uint8_t lead = static_cast<uint8_t>(text[i]);
+    uint32_t code_point;
+    size_t length;
+    if (lead < 0x80) {
+      code_point = lead;
+      length = 1;
+    } else if (lead < 0xE0) {
+      code_point = lead & 0x1F;
+      length = 2;
+    } else if (lead < 0xF0) {
+      code_point = lead & 0x0F;
+      length = 3;
+    } else {
+      code_point = lead & 0x07;
+      length = 4;
+    }
+    for (size_t j = 1; j < length && i + j < text.size(); ++j) {
+      code_point = (code_point << 6) | (text[i + j] & 0x3F);
+    }
+    i += length;
+    if (code_point >= 0x10000) {
+      code_point -= 0x10000;
+      units.push_back(static_cast<uint16_t>(0xD800 + (code_point >> 10)));
+      units.push_back(static_cast<uint16_t>(0xDC00 + (code_point & 0x3FF)));
+    } else {
+      units.push_back(static_cast<uint16_t>(code_point));
+    }
+  }
+  return units;
+}
+
+void PutBe(std::vector<uint8_t>* out, uint64_t value, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    out->push_back(static_cast<uint8_t>(value >> ((size - 1 - i) * 8)));
+  }
+}
+
+size_t BytesFor(uint64_t value) {
+  if (value < 0x100) {
+    return 1;
+  }
+  if (value < 0x10000) {
+    return 2;
+  }
+  return value < 0x100000000 ? 4 : 8;
+}
+
+// Writes bplist00 the way CFBinaryPList.c does: objects depth-first with
+// containers before their contents, then the offset table and trailer.
+class BinaryWriter {
+ public:
+  std::vector<uint8_t> Write(const PlistNode& root) {
+    Flatten(&root, nullptr);
+    ref_size_ = BytesFor(objects_.size());
+
+    std::vector<uint8_t> out = {'b', 'p', 'l', 'i', 's', 't', '0', '0'};
+    std::vector<uint64_t> offsets;
+    for (const Object& object : objects_) {
+      offsets.push_back(out.size());
+      Encode(object, &out);
+    }
+    uint64_t table_offset = out.size();
+    size_t offset_size = BytesFor(table_offset);
+    for (uint64_t offset : offsets) {
+      PutBe(&out, offset, offset_size);
+    }
+    out.insert(out.end(), 6, 0);
+    out.push_back(static_cast<uint8_t>(offset_size));
+    out.push_back(static_cast<uint8_t>(ref_size_));
+    PutBe(&out, objects_.size(), 8);
+    PutBe(&out, 0, 8);  // Top object.
+    PutBe(&out, table_offset, 8);
+    return out;
+  }
+
+ private:
+  struct Object {
+    const PlistNode* node = nullptr;
+    const std::string* key = nullptr;  // Dictionary keys are strings.
+    std::vector<uint64_t> refs;
+  };
+
+  uint64_t Flatten(const PlistNode* node, const std::string* key) {
+    uint64_t index = objects_.size();
+    objects_.emplace_back();
+    objects_[index].node = node;
+    objects_[index].key = key;
+    if (node == nullptr) {
+      return index;
+    }
+    std::vector<uint64_t> refs;
+    if (node->type == PlistType::kArray) {
+      for (const PlistNode& item : node->items) {
+        refs.push_back(Flatten(&item, nullptr));
+      }
+    } else if (node->type == PlistType::kDictionary) {
+      for (const auto& entry : node->entries) {
+        refs.push_back(Flatten(nullptr, &entry.first));
+      }
+      for (const auto& entry : node->entries) {
+        refs.push_back(Flatten(&entry.second, nullptr));
+      }
+    }
+    objects_[index].refs = std::move(refs);
+    return index;
+  }
+
+  static void PutMarker(std::vector<uint8_t>* out, uint8_t type,
+                        uint64_t count) {
+    if (count < 0xF) {
+      out->push_back(static_cast<uint8_t>((type << 4) | count));
+      return;
+    }
+    out->push_back(static_cast<uint8_t>((type << 4) | 0xF));
+    size_t size = BytesFor(count);
+    out->push_back(static_cast<uint8_t>(
+        0x10 | (size == 1 ? 0 : size == 2 ? 1 : size == 4 ? 2 : 3)));
+    PutBe(out, count, size);
+  }
+
+  static void PutString(std::vector<uint8_t>* out, const std::string& text) {
+    bool ascii = std::all_of(text.begin(), text.end(), [](char c) {
+      return static_cast<uint8_t>(c) < 0x80;
+    });
+    if (ascii) {
+      PutMarker(out, 0x5, text.size());
+      out->insert(out->end(), text.begin(), text.end());
+      return;
+    }
+    std::vector<uint16_t> units = ToUtf16(text);
+    PutMarker(out, 0x6, units.size());
+    for (uint16_t unit : units) {
+      PutBe(out, unit, 2);
+    }
+  }
+
+  void Encode(const Object& object, std::vector<uint8_t>* out) const {
+    if (object.key != nullptr) {
+      PutString(out, *object.key);
+      return;
+    }
+    const PlistNode& node = *object.node;
+    switch (node.type) {
+      case PlistType::kString:
+        PutString(out, node.text);
+        break;
+      case PlistType::kInteger:
+        if (node.integer < 0) {
+          out->push_back(0x13);
+          PutBe(out, static_cast<uint64_t>(node.integer), 8);
+        } else {
+          size_t size = BytesFor(static_cast<uint64_t>(node.integer));
+          if (size == 8) {
+            out->push_back(0x13);
+          } else {
+            out->push_back(static_cast<uint8_t>(
+                0x10 | (size == 1 ? 0 : size == 2 ? 1 : 2)));
+          }
+          PutBe(out, static_cast<uint64_t>(node.integer), size);
+        }
+        break;
+      case PlistType::kReal:
+      case PlistType::kDate: {
+        out->push_back(node.type == PlistType::kReal ? 0x23 : 0x33);
+        uint64_t bits;
+        std::memcpy(&bits, &node.real, sizeof(bits));
+        PutBe(out, bits, 8);
+        break;
+      }
+      case PlistType::kBoolean:
+        out->push_back(node.boolean ? 0x09 : 0x08);
+        break;
+      case PlistType::kData:
+        PutMarker(out, 0x4, node.data.size());
+        out->insert(out->end(), node.data.begin(), node.data.end());
+        break;
+      case PlistType::kArray:
+      case PlistType::kDictionary:
+        PutMarker(out, node.type == PlistType::kArray ? 0xA : 0xD,
+                  node.type == PlistType::kArray ? object.refs.size()
+                                                 : object.refs.size() / 2);
+        for (uint64_t ref : object.refs) {
+          PutBe(out, ref, ref_size_);
+        }
+        break;
+      case PlistType::kOther:
+        out->push_back(0x00);
+        break;
+    }
+  }
+
+  std::vector<Object> objects_;
+  size_t ref_size_ = 1;
+};
+
+}  // namespace
+
+PlistNode PlistNode::String(std::string text) {
+  PlistNode node;
+  node.type = PlistType::kString;
+  node.text = std::move(text);
+  return node;
+}
+
+PlistNode PlistNode::Integer(int64_t value) {
+  PlistNode node;
+  node.type = PlistType::kInteger;
+  node.integer = value;
+  return node;
+}
+
+PlistNode PlistNode::Real(double value) {
+  PlistNode node;
+  node.type = PlistType::kReal;
+  node.real = value;
+  return node;
+}
+
+PlistNode PlistNode::Boolean(bool value) {
+  PlistNode node;
+  node.type = PlistType::kBoolean;
+  node.boolean = value;
+  return node;
+}
+
+PlistNode PlistNode::Date(double seconds) {
+  PlistNode node;
+  node.type = PlistType::kDate;
+  node.real = seconds;
+  return node;
+}
+
+PlistNode PlistNode::Data(std::vector<uint8_t> bytes) {
+  PlistNode node;
+  node.type = PlistType::kData;
+  node.data = std::move(bytes);
+  return node;
+}
+
+PlistNode PlistNode::Array(std::vector<PlistNode> items) {
+  PlistNode node;
+  node.type = PlistType::kArray;
+  node.items = std::move(items);
+  return node;
+}
+
+PlistNode PlistNode::Dictionary(
+    std::vector<std::pair<std::string, PlistNode>> entries) {
+  PlistNode node;
+  node.type = PlistType::kDictionary;
+  node.entries = std::move(entries);
+  return node;
+}
+
+std::string ToXmlPlist(const PlistNode& root) {
+  std::string out =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" "
+      "\"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">\n"
+      "<plist version=\"1.0\">\n";
+  AppendXml(root, 0, &out);
+  out += "</plist>\n";
+  return out;
+}
+
+std::vector<uint8_t> ToBinaryPlist(const PlistNode& root) {
+  return BinaryWriter().Write(root);
+}
+
+PlistNode LargeInfoPlist(size_t scale) {
+  using Entries = std::vector<std::pair<std::string, PlistNode>>;
+  std::vector<PlistNode> document_types;
+  std::vector<PlistNode> url_types;
+  std::vector<PlistNode> localizations;
+  for (size_t i = 0; i < scale; ++i) {
+    std::string n = std::to_string(i);
+    document_types.push_back(PlistNode::Dictionary(Entries{
+        {"CFBundleTypeExtensions",
+         PlistNode::Array({PlistNode::String("ext" + n),
+                           PlistNode::String("alt" + n)})},
+        {"CFBundleTypeIconFile", PlistNode::String("Document" + n + ".icns")},
+        {"CFBundleTypeName", PlistNode::String("Example Document " + n)},
+        {"CFBundleTypeRole", PlistNode::String("Editor")},
+        {"LSHandlerRank", PlistNode::String("Owner")},
+        {"LSItemContentTypes",
+         PlistNode::Array({PlistNode::String("com.example.document." + n)})},
+    }));
+    url_types.push_back(PlistNode::Dictionary(Entries{
+        {"CFBundleURLName", PlistNode::String("com.example.url." + n)},
+        {"CFBundleURLSchemes",
+         PlistNode::Array({PlistNode::String("example" + n)})},
+    }));
+    localizations.push_back(PlistNode::String("l10n-" + n));
+  }
+  return PlistNode::Dictionary(Entries{
+      {"BuildMachineOSBuild", PlistNode::String("23C71")},
+      {"CFBundleDevelopmentRegion", PlistNode::String("en")},
+      {"CFBundleDocumentTypes", PlistNode::Array(std::move(document_types))},
+      {"CFBundleExecutable", PlistNode::String("Example")},
+      {"CFBundleIdentifier", PlistNode::String("com.example.app")},
+      {"CFBundleInfoDictionaryVersion", PlistNode::String("6.0")},
+      {"CFBundleLocalizations", PlistNode::Array(std::move(localizations))},
+      {"CFBundleName", PlistNode::String("Example")},
+      {"CFBundlePackageType", PlistNode::String("APPL")},
+      {"CFBundleShortVersionString", PlistNode::String("5.2.1")},
+      {"CFBundleSupportedPlatforms",
+       PlistNode::Array({PlistNode::String("MacOSX")})},
+      {"CFBundleURLTypes", PlistNode::Array(std::move(url_types))},
+      {"CFBundleVersion", PlistNode::String("5210")},
+      {"DTCompiler", PlistNode::String("com.apple.compilers.llvm.clang.1_0")},
+      {"DTXcode", PlistNode::String("1520")},
+      {"LSApplicationCategoryType",
+       PlistNode::String("public.app-category.developer-tools")},
+      {"LSMinimumSystemVersion", PlistNode::String("11.0")},
+      {"NSHighResolutionCapable", PlistNode::Boolean(true)},
+      {"NSHumanReadableCopyright",
+       PlistNode::String("Copyright \xC2\xA9 2024 Example Inc.")},
+      {"NSPrincipalClass", PlistNode::String("NSApplication")},
+  });
+}
+
+}  // namespace testing
+}  // namespace flutter_bin
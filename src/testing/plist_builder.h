@@ -0,0 +1,49 @@
+#ifndef FLUTTER_BIN_TESTING_PLIST_BUILDER_H_
+#define FLUTTER_BIN_TESTING_PLIST_BUILDER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "plist_reader.h"
+
+namespace flutter_bin {
+namespace testing {
+
+// A property list value, built up in tests and written out as XML or
+// bplist00 the way CoreFoundation would.
+struct PlistNode {
+  static PlistNode String(std::string text);
+  static PlistNode Integer(int64_t value);
+  static PlistNode Real(double value);
+  static PlistNode Boolean(bool value);
+  // Seconds since 2001-01-01T00:00:00Z.
+  static PlistNode Date(double seconds);
+  static PlistNode Data(std::vector<uint8_t> bytes);
+  static PlistNode Array(std::vector<PlistNode> items);
+  static PlistNode Dictionary(
+      std::vector<std::pair<std::string, PlistNode>> entries);
+
+  PlistType type = PlistType::kString;
+  std::string text;
+  int64_t integer = 0;
+  double real = 0;
+  bool boolean = false;
+  std::vector<uint8_t> data;
+  std::vector<PlistNode> items;
+  std::vector<std::pair<std::string, PlistNode>> entries;
+};
+
+std::string ToXmlPlist(const PlistNode& root);
+std::vector<uint8_t> ToBinaryPlist(const PlistNode& root);
+
+// An app Info.plist padded the way large real bundles are: |scale| document
+// types, URL schemes and localizations ahead of the standard keys, with the
+// keys sorted as Xcode writes them.
+PlistNode LargeInfoPlist(size_t scale);
+
+}  // namespace testing
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_TESTING_PLIST_BUILDER_H_
@@ -0,0 +1,252 @@
+#include "testing/signature_builder.h"
+
+#include <initializer_list>
+#include <map>
+
+namespace flutter_bin {
+namespace testing {
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+const Bytes kOidSignedData = {0x2A, 0x86, 0x48, 0x86, 0xF7,
+                              0x0D, 0x01, 0x07, 0x02};
+const Bytes kOidSpcIndirectData = {0x2B, 0x06, 0x01, 0x04, 0x01,
+                                   0x82, 0x37, 0x02, 0x01, 0x04};
+const Bytes kOidTstInfo = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D,
+                           0x01, 0x09, 0x10, 0x01, 0x04};
+const Bytes kOidContentType = {0x2A, 0x86, 0x48, 0x86, 0xF7,
+                               0x0D, 0x01, 0x09, 0x03};
+const Bytes kOidSigningTime = {0x2A, 0x86, 0x48, 0x86, 0xF7,
+                               0x0D, 0x01, 0x09, 0x05};
+const Bytes kOidCountersignature = {0x2A, 0x86, 0x48, 0x86, 0xF7,
+                                    0x0D, 0x01, 0x09, 0x06};
+const Bytes kOidTimeStampToken = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D,
+                                  0x01, 0x09, 0x10, 0x02, 0x0E};
+const Bytes kOidMsTimeStampToken = {0x2B, 0x06, 0x01, 0x04, 0x01,
+                                    0x82, 0x37, 0x03, 0x03, 0x01};
+const Bytes kOidSha256 = {0x60, 0x86, 0x48, 0x01, 0x65,
+                          0x03, 0x04, 0x02, 0x01};
+const Bytes kOidRsa = {0x2A, 0x86, 0x48, 0x86, 0xF7,
+                       0x0D, 0x01, 0x01, 0x01};
+
+void Append(Bytes* out, const Bytes& bytes) {
+  out->insert(out->end(), bytes.begin(), bytes.end());
+}
+
+Bytes Der(uint8_t tag, const Bytes& contents) {
+  Bytes out = {tag};
+  size_t size = contents.size();
+  if (size < 0x80) {
+    out.push_back(static_cast<uint8_t>(size));
+  } else {
+    Bytes length;
+    for (; size > 0; size >>= 8) {
+      length.insert(length.begin(), static_cast<uint8_t>(size));
+    }
+    out.push_back(static_cast<uint8_t>(0x80 | length.size()));
+    Append(&out, length);
+  }
+  Append(&out, contents);
+  return out;
+}
+
+Bytes Concat(std::initializer_list<Bytes> parts) {
+  Bytes out;
+  for (const Bytes& part : parts) {
+    Append(&out, part);
+  }
+  return out;
+}
+
+// Encodes the SignedData skeleton, optionally with indefinite lengths.
+class Encoder {
+ public:
+  explicit Encoder(bool indefinite) : indefinite_(indefinite) {}
+
+  Bytes Constructed(uint8_t tag, std::initializer_list<Bytes> children) const {
+    Bytes contents = Concat(children);
+    if (!indefinite_) {
+      return Der(tag, contents);
+    }
+    Bytes out = {tag, 0x80};
+    Append(&out, contents);
+    out.push_back(0);
+    out.push_back(0);
+    return out;
+  }
+
+ private:
+  bool indefinite_;
+};
+
+Bytes Oid(const Bytes& encoded) { return Der(0x06, encoded); }
+Bytes Integer(const Bytes& value) { return Der(0x02, value); }
+Bytes Text(uint8_t tag, const std::string& text) {
+  return Der(tag, Bytes(text.begin(), text.end()));
+}
+Bytes AlgorithmId(const Bytes& oid) {
+  return Der(0x30, Concat({Oid(oid), Der(0x05, {})}));
+}
+
+Bytes Name(const TestName& name) {
+  static const std::map<std::string, uint8_t> kTypes = {
+      {"CN", 0x03}, {"C", 0x06},  {"L", 0x07},
+      {"ST", 0x08}, {"O", 0x0A}, {"OU", 0x0B},
+  };
+  Bytes rdns;
+  for (const auto& attribute : name) {
+    uint8_t type = kTypes.at(attribute.first);
+    Bytes value = Text(type == 0x06 ? 0x13 : 0x0C, attribute.second);
+    Append(&rdns, Der(0x31, Der(0x30, Concat({Oid({0x55, 0x04, type}),
+                                              value}))));
+  }
+  return Der(0x30, rdns);
+}
+
+Bytes Certificate(const Bytes& serial, const TestName& issuer,
+                  const TestName& subject) {
+  Bytes validity = Der(0x30, Concat({Text(0x17, "200101000000Z"),
+                                     Text(0x17, "300101000000Z")}));
+  Bytes key = Der(0x30, Concat({AlgorithmId(kOidRsa),
+                                Der(0x03, {0x00, 0x30, 0x00})}));
+  Bytes tbs = Der(0x30, Concat({Der(0xA0, Integer({0x02})), Integer(serial),
+                                AlgorithmId(kOidSha256), Name(issuer),
+                                validity, Name(subject), key}));
+  return Der(0x30, Concat({tbs, AlgorithmId(kOidSha256),
+                           Der(0x03, {0x00, 0x5A})}));
+}
+
+Bytes Attribute(const Encoder& ber, const Bytes& oid, const Bytes& value) {
+  return ber.Constructed(0x30, {Oid(oid), ber.Constructed(0x31, {value})});
+}
+
+Bytes Countersignature(const SignatureSpec& spec) {
+  Bytes signed_attributes = Der(
+      0xA0, Der(0x30, Concat({Oid(kOidSigningTime),
+                              Der(0x31, Text(0x17, spec.time))})));
+  return Der(0x30, Concat({Integer({0x01}),
+                           Der(0x30, Concat({Name(spec.issuer),
+                                             Integer({0x7F})})),
+                           AlgorithmId(kOidSha256), signed_attributes,
+                           AlgorithmId(kOidRsa), Der(0x04, {0x5A})}));
+}
+
+Bytes TimeStampToken(const Encoder& ber, const SignatureSpec& spec) {
+  Bytes tst_info = Der(
+      0x30, Concat({Integer({0x01}), Oid({0x2A, 0x03, 0x04}),
+                    Der(0x30, Concat({AlgorithmId(kOidSha256),
+                                      Der(0x04, Bytes(32, 0x11))})),
+                    Integer({0x42}), Text(0x18, spec.time)}));
+  Bytes content = ber.Constructed(
+      0x30, {Oid(kOidTstInfo),
+             ber.Constructed(0xA0, {Der(0x04, tst_info)})});
+  Bytes signed_data = ber.Constructed(
+      0x30, {Integer({0x03}), Der(0x31, AlgorithmId(kOidSha256)), content,
+             Der(0x31, {})});
+  return ber.Constructed(
+      0x30, {Oid(kOidSignedData), ber.Constructed(0xA0, {signed_data})});
+}
+
+}  // namespace
+
+std::vector<uint8_t> BuildSignedData(const SignatureSpec& spec) {
+  Encoder ber(spec.indefinite_lengths);
+  Bytes certificates = Concat({Certificate({0x01}, spec.issuer, spec.issuer),
+                               Certificate(spec.serial, spec.issuer,
+                                           spec.subject)});
+
+  Bytes unsigned_attributes;
+  switch (spec.timestamp) {
+    case SignatureSpec::Timestamp::kNone:
+      break;
+    case SignatureSpec::Timestamp::kCountersignature:
+      unsigned_attributes = Attribute(ber, kOidCountersignature,
+                                      Countersignature(spec));
+      break;
+    case SignatureSpec::Timestamp::kAuthenticodeRfc3161:
+      unsigned_attributes = Attribute(ber, kOidMsTimeStampToken,
+                                      TimeStampToken(ber, spec));
+      break;
+    case SignatureSpec::Timestamp::kCmsRfc3161:
+      unsigned_attributes = Attribute(ber, kOidTimeStampToken,
+                                      TimeStampToken(ber, spec));
+      break;
+  }
+
+  Bytes signed_attributes = Der(
+      0xA0, Der(0x30, Concat({Oid(kOidContentType),
+                              Der(0x31, Oid(kOidSpcIndirectData))})));
+  Bytes signer_info = ber.Constructed(
+      0x30, {Integer({0x01}),
+             Der(0x30, Concat({Name(spec.issuer), Integer(spec.serial)})),
+             AlgorithmId(kOidSha256), signed_attributes,
+             AlgorithmId(kOidRsa), Der(0x04, {0x5A}),
+             unsigned_attributes.empty()
+                 ? Bytes()
+                 : ber.Constructed(0xA1, {unsigned_attributes})});
+
+  Bytes content = ber.Constructed(
+      0x30, {Oid(kOidSpcIndirectData),
+             ber.Constructed(0xA0, {Der(0x30, Der(0x04, Bytes(32, 0x22)))})});
+  Bytes signed_data = ber.Constructed(
+      0x30, {Integer({0x01}), Der(0x31, AlgorithmId(kOidSha256)), content,
+             ber.Constructed(0xA0, {certificates}),
+             ber.Constructed(0x31, {signer_info})});
+  return ber.Constructed(
+      0x30, {Oid(kOidSignedData), ber.Constructed(0xA0, {signed_data})});
+}
+
+std::vector<uint8_t> BuildWinCertificate(
+    const std::vector<uint8_t>& signed_data) {
+  size_t length = 8 + signed_data.size();
+  Bytes out = {static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+               static_cast<uint8_t>(length >> 16),
+               static_cast<uint8_t>(length >> 24),
+               0x00, 0x02,   // WIN_CERT_REVISION_2_0
+               0x02, 0x00};  // WIN_CERT_TYPE_PKCS_SIGNED_DATA
+  Append(&out, signed_data);
+  out.resize((out.size() + 7) & ~size_t{7}, 0);
+  return out;
+}
+
+std::vector<uint8_t> BuildCodeSignatureSuperBlob(
+    const std::vector<uint8_t>& signed_data) {
+  auto put_be32 = [](Bytes* out, size_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      out->push_back(static_cast<uint8_t>(value >> shift));
+    }
+  };
+  Bytes code_directory;
+  put_be32(&code_directory, 0xFADE0C02);  // CSMAGIC_CODEDIRECTORY
+  put_be32(&code_directory, 16);
+  put_be32(&code_directory, 0x20400);     // version
+  put_be32(&code_directory, 0);           // flags
+
+  Bytes wrapper;
+  if (!signed_data.empty()) {
+    put_be32(&wrapper, 0xFADE0B01);  // CSMAGIC_BLOBWRAPPER
+    put_be32(&wrapper, 8 + signed_data.size());
+    Append(&wrapper, signed_data);
+  }
+
+  uint32_t count = wrapper.empty() ? 1 : 2;
+  size_t directory_offset = 12 + 8 * count;
+  Bytes out;
+  put_be32(&out, 0xFADE0CC0);  // CSMAGIC_EMBEDDED_SIGNATURE
+  put_be32(&out, directory_offset + code_directory.size() + wrapper.size());
+  put_be32(&out, count);
+  put_be32(&out, 0);  // CSSLOT_CODEDIRECTORY
+  put_be32(&out, directory_offset);
+  if (!wrapper.empty()) {
+    put_be32(&out, 0x10000);  // CSSLOT_SIGNATURESLOT
+    put_be32(&out, directory_offset + code_directory.size());
+  }
+  Append(&out, code_directory);
+  Append(&out, wrapper);
+  return out;
+}
+
+}  // namespace testing
+}  // namespace flutter_bin
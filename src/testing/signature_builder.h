@@ -0,0 +1,61 @@
+#ifndef FLUTTER_BIN_TESTING_SIGNATURE_BUILDER_H_
+#define FLUTTER_BIN_TESTING_SIGNATURE_BUILDER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flutter_bin {
+namespace testing {
+
+// A distinguished name as (short name, value) pairs in encoding order, most
+// general first, e.g. {{"C", "US"}, {"O", "Example"}, {"CN", "Example"}}.
+// Short names are C, ST, L, O, OU and CN; C is a PrintableString and the
+// rest are UTF8Strings.
+using TestName = std::vector<std::pair<std::string, std::string>>;
+
+// Describes the signature BuildSignedData() emits.
+struct SignatureSpec {
+  enum class Timestamp {
+    kNone,
+    // PKCS#9 countersignature with a UTCTime signingTime, as older
+    // Authenticode timestamps have.
+    kCountersignature,
+    // RFC 3161 token under the Authenticode attribute 1.3.6.1.4.1.311.3.3.1.
+    kAuthenticodeRfc3161,
+    // RFC 3161 token under the CMS attribute id-aa-timeStampToken, as
+    // Apple's codesign adds.
+    kCmsRfc3161,
+  };
+
+  TestName subject;
+  TestName issuer;
+  std::vector<uint8_t> serial = {0x01};
+  Timestamp timestamp = Timestamp::kNone;
+  // "YYMMDDHHMMSSZ" for countersignatures, "YYYYMMDDHHMMSS[.f]Z" for RFC
+  // 3161 tokens.
+  std::string time;
+  // Encodes the ContentInfo/SignedData/SignerInfo structure with BER
+  // indefinite lengths, as codesign does; certificates stay DER.
+  bool indefinite_lengths = false;
+};
+
+// Emits a PKCS#7 SignedData ContentInfo with the issuer's certificate and
+// the signer's, in that order, and one SignerInfo. Signatures and keys are
+// placeholders; only the structure is real.
+std::vector<uint8_t> BuildSignedData(const SignatureSpec& spec);
+
+// Wraps |signed_data| in a WIN_CERTIFICATE for a PE certificate table.
+std::vector<uint8_t> BuildWinCertificate(
+    const std::vector<uint8_t>& signed_data);
+
+// Emits an embedded-signature SuperBlob holding a placeholder code
+// directory and, if |signed_data| is not empty, a CMS blob wrapper.
+std::vector<uint8_t> BuildCodeSignatureSuperBlob(
+    const std::vector<uint8_t>& signed_data);
+
+}  // namespace testing
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_TESTING_SIGNATURE_BUILDER_H_
@@ -0,0 +1,28 @@
+#include "testing/throttled_source.h"
+
+#include <thread>
+
+namespace flutter_bin {
+namespace testing {
+
+ThrottledSource::ThrottledSource(RandomAccessSource* source,
+                                 std::chrono::microseconds latency,
+                                 uint64_t bytes_per_second)
+    : source_(source),
+      latency_(latency),
+      bytes_per_second_(bytes_per_second) {}
+
+bool ThrottledSource::ReadAt(uint64_t offset, void* buffer, size_t length,
+                             size_t* read) {
+  std::chrono::microseconds delay = latency_;
+  if (bytes_per_second_ != 0) {
+    delay += std::chrono::microseconds(length * 1000000 / bytes_per_second_);
+  }
+  std::this_thread::sleep_for(delay);
+  ++read_count_;
+  bytes_read_ += length;
+  return source_->ReadAt(offset, buffer, length, read);
+}
+
+}  // namespace testing
+}  // namespace flutter_bin
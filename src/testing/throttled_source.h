@@ -0,0 +1,43 @@
+#ifndef FLUTTER_BIN_TESTING_THROTTLED_SOURCE_H_
+#define FLUTTER_BIN_TESTING_THROTTLED_SOURCE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "positioned_file.h"
+
+namespace flutter_bin {
+namespace testing {
+
+// A stand-in for a slow volume (a network share, a USB stick): forwards
+// reads to another source after sleeping for a fixed latency per request
+// plus the time |bytes_per_second| takes to move the bytes.
+class ThrottledSource : public RandomAccessSource {
+ public:
+  // |bytes_per_second| of 0 means unlimited bandwidth.
+  ThrottledSource(RandomAccessSource* source,
+                  std::chrono::microseconds latency,
+                  uint64_t bytes_per_second = 0);
+
+  uint64_t size() const override { return source_->size(); }
+  bool ReadAt(uint64_t offset, void* buffer, size_t length,
+              size_t* read) override;
+
+  // Requests and bytes passed on so far.
+  uint64_t read_count() const { return read_count_; }
+  uint64_t bytes_read() const { return bytes_read_; }
+
+ private:
+  RandomAccessSource* const source_;
+  const std::chrono::microseconds latency_;
+  const uint64_t bytes_per_second_;
+  std::atomic<uint64_t> read_count_{0};
+  std::atomic<uint64_t> bytes_read_{0};
+};
+
+}  // namespace testing
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_TESTING_THROTTLED_SOURCE_H_
@@ -0,0 +1,186 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace flutter_bin {
+
+namespace {
+
+// Identifies the pool and deque owned by the current worker thread.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+constexpr size_t kNoQueue = static_cast<size_t>(-1);
+
+// Shards per worker in ParallelFor; more shards balance better, fewer cost
+// less bookkeeping.
+constexpr size_t kShardsPerThread = 4;
+
+// File reads block on the disk or the network, so oversubscribe the cores a
+// little, but keep the pool bounded.
+constexpr size_t kMaxThreads = 32;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t thread_count) {
+  thread_count = std::max<size_t>(thread_count, 1);
+  for (size_t i = 0; i < thread_count; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+// static
+size_t ThreadPool::DefaultThreadCount() {
+  size_t cores = std::thread::hardware_concurrency();
+  if (cores == 0) {
+    cores = 4;
+  }
+  return std::min(cores * 2, kMaxThreads);
+}
+
+void ThreadPool::Post(Task task) {
+  size_t index = current_pool == this
+                     ? current_index
+                     : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                           queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    ++pending_;
+  }
+  wake_.notify_one();
+}
+
+void ThreadPool::PostFront(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(urgent_.mutex);
+    urgent_.tasks.push_back(std::move(task));
+    urgent_count_.fetch_add(1, std::memory_order_release);
+  }
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    ++pending_;
+  }
+  wake_.notify_one();
+}
+
+bool ThreadPool::TakeTask(size_t self, Task* task) {
+  bool found = false;
+  if (urgent_count_.load(std::memory_order_acquire) != 0) {
+    std::lock_guard<std::mutex> lock(urgent_.mutex);
+    if (!urgent_.tasks.empty()) {
+      *task = std::move(urgent_.tasks.front());
+      urgent_.tasks.pop_front();
+      urgent_count_.fetch_sub(1, std::memory_order_relaxed);
+      found = true;
+    }
+  }
+  if (!found && self != kNoQueue) {
+    Queue& own = *queues_[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      *task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      found = true;
+    }
+  }
+  for (size_t i = 1; !found && i <= queues_.size(); ++i) {
+    size_t victim = (self == kNoQueue ? i - 1 : self + i) % queues_.size();
+    if (victim == self) {
+      continue;
+    }
+    Queue& other = *queues_[victim];
+    std::lock_guard<std::mutex> lock(other.mutex);
+    if (!other.tasks.empty()) {
+      *task = std::move(other.tasks.front());
+      other.tasks.pop_front();
+      found = true;
+    }
+  }
+  if (found) {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    --pending_;
+  }
+  return found;
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+  current_pool = this;
+  current_index = index;
+  while (true) {
+    Task task;
+    if (TakeTask(index, &task)) {
+      task();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait(lock, [this] { return stopping_ || pending_ > 0; });
+    if (stopping_ && pending_ == 0) {
+      return;
+    }
+  }
+}
+
+void ThreadPool::ParallelFor(size_t count,
+                             const std::function<void(size_t)>& body) {
+  if (count == 0) {
+    return;
+  }
+  size_t shards = std::min(count, thread_count() * kShardsPerThread);
+  size_t remaining = shards;
+  std::mutex done_mutex;
+  std::condition_variable done;
+
+  for (size_t shard = 0; shard < shards; ++shard) {
+    size_t begin = count * shard / shards;
+    size_t end = count * (shard + 1) / shards;
+    Post([&, begin, end] {
+      for (size_t i = begin; i < end; ++i) {
+        body(i);
+      }
+      std::lock_guard<std::mutex> lock(done_mutex);
+      if (--remaining == 0) {
+        done.notify_all();
+      }
+    });
+  }
+
+  // Help out instead of blocking; this also keeps nested calls from a worker
+  // from deadlocking the pool.
+  size_t self = current_pool == this ? current_index : kNoQueue;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(done_mutex);
+      if (remaining == 0) {
+        return;
+      }
+    }
+    Task task;
+    if (TakeTask(self, &task)) {
+      task();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done.wait(lock, [&remaining] { return remaining == 0; });
+    return;
+  }
+}
+
+}  // namespace flutter_bin
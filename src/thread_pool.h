@@ -0,0 +1,79 @@
+#ifndef FLUTTER_BIN_THREAD_POOL_H_
+#define FLUTTER_BIN_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flutter_bin {
+
+// A fixed-size pool of worker threads with one task deque per worker.
+//
+// Workers pop their own deque from the back and, when it runs dry, steal from
+// the front of their siblings' deques, so uneven shards (one slow file on a
+// network share next to hundreds of cached ones) keep every core busy.
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  // Starts |thread_count| workers (at least one).
+  explicit ThreadPool(size_t thread_count);
+
+  // Runs every queued task, then joins the workers.
+  ~ThreadPool();
+
+  // Disallow copy and assign.
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // A worker count suited to I/O-heavy work on this machine.
+  static size_t DefaultThreadCount();
+
+  size_t thread_count() const { return threads_.size(); }
+
+  // Queues |task|. Tasks posted from a worker go to that worker's own deque.
+  void Post(Task task);
+
+  // Queues |task| ahead of everything already queued, including the shards
+  // of running ParallelFor calls: the next worker to look for a task, or a
+  // thread helping out in ParallelFor, takes it.
+  void PostFront(Task task);
+
+  // Calls |body(i)| for every i in [0, count), split into shards across the
+  // workers. The calling thread helps drain the pool and returns once every
+  // index has been processed.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // Takes a task from |self|'s deque or steals one from a sibling.
+  bool TakeTask(size_t self, Task* task);
+  void WorkerLoop(size_t index);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  // Tasks from PostFront(), oldest first, and how many there are, so the
+  // common case of none costs no lock.
+  Queue urgent_;
+  std::atomic<size_t> urgent_count_{0};
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> next_queue_{0};
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  size_t pending_ = 0;  // Guarded by wake_mutex_.
+  bool stopping_ = false;  // Guarded by wake_mutex_.
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_THREAD_POOL_H_
@@ -0,0 +1,372 @@
+#include "unicode.h"
+
+#include <algorithm>
+
+#include "cpu_features.h"
+
+#if defined(FLUTTER_BIN_X86)
+#include <immintrin.h>
+#endif
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr char32_t kReplacementCharacter = 0xFFFD;
+
+// Code units the scalar loops convert after a SIMD run stops at non-ASCII
+// text, before the next run is tried.
+constexpr size_t kScalarStride = 16;
+
+char16_t ToLowerAscii(char16_t c) {
+  return (c >= u'A' && c <= u'Z') ? static_cast<char16_t>(c + 32) : c;
+}
+
+// Writes |code_point| as UTF-8 and returns the number of bytes, 1 to 4.
+size_t EncodeCodePoint(char32_t code_point, uint8_t* out) {
+  if (code_point < 0x80) {
+    out[0] = static_cast<uint8_t>(code_point);
+    return 1;
+  }
+  if (code_point < 0x800) {
+    out[0] = static_cast<uint8_t>(0xC0 | (code_point >> 6));
+    out[1] = static_cast<uint8_t>(0x80 | (code_point & 0x3F));
+    return 2;
+  }
+  if (code_point < 0x10000) {
+    out[0] = static_cast<uint8_t>(0xE0 | (code_point >> 12));
+    out[1] = static_cast<uint8_t>(0x80 | ((code_point >> 6) & 0x3F));
+    out[2] = static_cast<uint8_t>(0x80 | (code_point & 0x3F));
+    return 3;
+  }
+  out[0] = static_cast<uint8_t>(0xF0 | (code_point >> 18));
+  out[1] = static_cast<uint8_t>(0x80 | ((code_point >> 12) & 0x3F));
+  out[2] = static_cast<uint8_t>(0x80 | ((code_point >> 6) & 0x3F));
+  out[3] = static_cast<uint8_t>(0x80 | (code_point & 0x3F));
+  return 4;
+}
+
+// Converts the ASCII prefix of |count| units (UTF-16LE) or bytes (UTF-8) at
+// |in|, a whole vector at a time, and returns how many were converted. The
+// rest is left to the scalar code.
+using AsciiRun = size_t (*)(const uint8_t* in, size_t count, uint8_t* out);
+
+#if defined(FLUTTER_BIN_X86)
+
+FLUTTER_BIN_TARGET("sse2")
+size_t Utf16AsciiRunSse2(const uint8_t* in, size_t count, uint8_t* out) {
+  const __m128i non_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; count - i >= 8; i += 8) {
+    __m128i units =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+    __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(units, non_ascii), zero);
+    if (_mm_movemask_epi8(ascii) != 0xFFFF) {
+      break;
+    }
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i),
+                     _mm_packus_epi16(units, units));
+  }
+  return i;
+}
+
+FLUTTER_BIN_TARGET("avx2")
+size_t Utf16AsciiRunAvx2(const uint8_t* in, size_t count, uint8_t* out) {
+  const __m256i non_ascii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+  size_t i = 0;
+  for (; count - i >= 16; i += 16) {
+    __m256i units =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * i));
+    if (!_mm256_testz_si256(units, non_ascii)) {
+      break;
+    }
+    // packus works per 128-bit lane; gather the two low quadwords.
+    __m256i bytes =
+        _mm256_permute4x64_epi64(_mm256_packus_epi16(units, units), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm256_castsi256_si128(bytes));
+  }
+  return i;
+}
+
+FLUTTER_BIN_TARGET("sse2")
+size_t Utf8AsciiRunSse2(const uint8_t* in, size_t count, uint8_t* out) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; count - i >= 16; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    if (_mm_movemask_epi8(bytes) != 0) {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i),
+                     _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+  return i;
+}
+
+FLUTTER_BIN_TARGET("avx2")
+size_t Utf8AsciiRunAvx2(const uint8_t* in, size_t count, uint8_t* out) {
+  size_t i = 0;
+  for (; count - i >= 32; i += 32) {
+    __m256i bytes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    if (_mm256_movemask_epi8(bytes) != 0) {
+      break;
+    }
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(out + 2 * i),
+        _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(out + 2 * i + 32),
+        _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+  }
+  return i;
+}
+
+#endif  // FLUTTER_BIN_X86
+
+AsciiRun Utf16AsciiRun(UnicodeKernel kernel) {
+#if defined(FLUTTER_BIN_X86)
+  switch (kernel) {
+    case UnicodeKernel::kScalar:
+      return nullptr;
+    case UnicodeKernel::kSse2:
+      return Utf16AsciiRunSse2;
+    case UnicodeKernel::kAvx2:
+      return Utf16AsciiRunAvx2;
+  }
+#else
+  (void)kernel;
+#endif
+  return nullptr;
+}
+
+AsciiRun Utf8AsciiRun(UnicodeKernel kernel) {
+#if defined(FLUTTER_BIN_X86)
+  switch (kernel) {
+    case UnicodeKernel::kScalar:
+      return nullptr;
+    case UnicodeKernel::kSse2:
+      return Utf8AsciiRunSse2;
+    case UnicodeKernel::kAvx2:
+      return Utf8AsciiRunAvx2;
+  }
+#else
+  (void)kernel;
+#endif
+  return nullptr;
+}
+
+// Decodes into char16_t or, on Windows, wchar_t code units.
+template <typename Unit>
+size_t DecodeUtf8(std::string_view utf8, Unit* out, bool* valid,
+                  UnicodeKernel kernel) {
+  static_assert(sizeof(Unit) == 2, "UTF-16 code units");
+  const auto* in = reinterpret_cast<const uint8_t*>(utf8.data());
+  const size_t size = utf8.size();
+  AsciiRun run = Utf8AsciiRun(kernel);
+  bool ok = true;
+  size_t i = 0;
+  size_t written = 0;
+  while (i < size) {
+    if (run != nullptr) {
+      size_t ascii =
+          run(in + i, size - i, reinterpret_cast<uint8_t*>(out + written));
+      i += ascii;
+      written += ascii;
+    }
+    size_t stop = std::min(size, i + kScalarStride);
+    while (i < stop) {
+      uint8_t lead = in[i++];
+      if (lead < 0x80) {
+        out[written++] = static_cast<Unit>(lead);
+        continue;
+      }
+      // Table 3-7 of the Unicode standard: the range of the first
+      // continuation byte excludes overlong forms, surrogates and code
+      // points past U+10FFFF.
+      size_t needed = 0;
+      char32_t code_point = 0;
+      uint8_t low = 0x80;
+      uint8_t high = 0xBF;
+      if (lead >= 0xC2 && lead <= 0xDF) {
+        needed = 1;
+        code_point = lead & 0x1F;
+      } else if (lead >= 0xE0 && lead <= 0xEF) {
+        needed = 2;
+        code_point = lead & 0x0F;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+      } else if (lead >= 0xF0 && lead <= 0xF4) {
+        needed = 3;
+        code_point = lead & 0x07;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+      }
+      size_t taken = 0;
+      for (; taken < needed && i < size; ++taken, ++i) {
+        uint8_t next = in[i];
+        if (next < low || next > high) {
+          break;
+        }
+        code_point = (code_point << 6) | (next & 0x3F);
+        low = 0x80;
+        high = 0xBF;
+      }
+      if (needed == 0 || taken < needed) {
+        // The bytes consumed so far are one maximal invalid subsequence.
+        out[written++] = static_cast<Unit>(kReplacementCharacter);
+        ok = false;
+      } else if (code_point >= 0x10000) {
+        code_point -= 0x10000;
+        out[written++] = static_cast<Unit>(0xD800 + (code_point >> 10));
+        out[written++] = static_cast<Unit>(0xDC00 + (code_point & 0x3FF));
+      } else {
+        out[written++] = static_cast<Unit>(code_point);
+      }
+    }
+  }
+  if (valid != nullptr) {
+    *valid = ok;
+  }
+  return written;
+}
+
+}  // namespace
+
+bool UnicodeKernelSupported(UnicodeKernel kernel) {
+  switch (kernel) {
+    case UnicodeKernel::kScalar:
+      return true;
+    case UnicodeKernel::kSse2:
+      return GetCpuFeatures().sse2;
+    case UnicodeKernel::kAvx2:
+      return GetCpuFeatures().avx2;
+  }
+  return false;
+}
+
+UnicodeKernel DefaultUnicodeKernel() {
+  static const UnicodeKernel kernel =
+      UnicodeKernelSupported(UnicodeKernel::kAvx2)   ? UnicodeKernel::kAvx2
+      : UnicodeKernelSupported(UnicodeKernel::kSse2) ? UnicodeKernel::kSse2
+                                                     : UnicodeKernel::kScalar;
+  return kernel;
+}
+
+const char* UnicodeKernelName(UnicodeKernel kernel) {
+  switch (kernel) {
+    case UnicodeKernel::kScalar:
+      return "scalar";
+    case UnicodeKernel::kSse2:
+      return "sse2";
+    case UnicodeKernel::kAvx2:
+      return "avx2";
+  }
+  return "";
+}
+
+void AppendCodePoint(char32_t code_point, std::string* out) {
+  uint8_t bytes[4];
+  size_t size = EncodeCodePoint(code_point, bytes);
+  out->append(reinterpret_cast<const char*>(bytes), size);
+}
+
+bool EqualsAsciiIgnoreCase(Utf16View text, const char* ascii) {
+  size_t i = 0;
+  for (; i < text.length; ++i) {
+    if (ascii[i] == '\0') {
+      return false;
+    }
+    if (ToLowerAscii(text.at(i)) !=
+        ToLowerAscii(static_cast<char16_t>(static_cast<uint8_t>(ascii[i])))) {
+      return false;
+    }
+  }
+  return ascii[i] == '\0';
+}
+
+size_t Utf16ToUtf8(Utf16View text, char* out, UnicodeKernel kernel) {
+  auto* p = reinterpret_cast<uint8_t*>(out);
+  AsciiRun run = Utf16AsciiRun(kernel);
+  size_t i = 0;
+  while (i < text.length) {
+    if (run != nullptr) {
+      size_t ascii = run(text.data + 2 * i, text.length - i, p);
+      i += ascii;
+      p += ascii;
+    }
+    size_t stop = std::min(text.length, i + kScalarStride);
+    while (i < stop) {
+      char32_t unit = text.at(i++);
+      if (unit < 0x80) {
+        *p++ = static_cast<uint8_t>(unit);
+        continue;
+      }
+      if (unit >= 0xD800 && unit <= 0xDBFF && i < text.length) {
+        char32_t low = text.at(i);
+        if (low >= 0xDC00 && low <= 0xDFFF) {
+          p += EncodeCodePoint(
+              0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00), p);
+          ++i;
+          continue;
+        }
+      }
+      if (unit >= 0xD800 && unit <= 0xDFFF) {
+        unit = kReplacementCharacter;
+      }
+      p += EncodeCodePoint(unit, p);
+    }
+  }
+  return static_cast<size_t>(p - reinterpret_cast<uint8_t*>(out));
+}
+
+void AppendUtf8(Utf16View text, std::string* out) {
+  size_t size = out->size();
+  out->resize(size + 3 * text.length);
+  out->resize(size + Utf16ToUtf8(text, &(*out)[size]));
+}
+
+std::string Utf16ToUtf8(Utf16View text) {
+  std::string result;
+  AppendUtf8(text, &result);
+  return result;
+}
+
+size_t Utf8ToUtf16(std::string_view utf8, char16_t* out, bool* valid,
+                   UnicodeKernel kernel) {
+  return DecodeUtf8(utf8, out, valid, kernel);
+}
+
+std::u16string Utf8ToUtf16(std::string_view utf8, bool* valid) {
+  std::u16string result(utf8.size(), u'\0');
+  result.resize(Utf8ToUtf16(utf8, &result[0], valid));
+  return result;
+}
+
+#if defined(_WIN32)
+
+std::wstring Utf8ToWide(std::string_view utf8) {
+  std::wstring result(utf8.size(), L'\0');
+  result.resize(
+      DecodeUtf8(utf8, &result[0], nullptr, DefaultUnicodeKernel()));
+  return result;
+}
+
+void Utf8ToWide(std::string_view utf8, std::wstring* out) {
+  out->resize(utf8.size());
+  out->resize(DecodeUtf8(utf8, &(*out)[0], nullptr, DefaultUnicodeKernel()));
+}
+
+std::string WideToUtf8(const wchar_t* wide, size_t length) {
+  static_assert(sizeof(wchar_t) == 2, "Windows wide strings are UTF-16");
+  return Utf16ToUtf8(
+      Utf16View(reinterpret_cast<const uint8_t*>(wide), length));
+}
+
+#endif  // _WIN32
+
+}  // namespace flutter_bin
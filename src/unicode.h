@@ -0,0 +1,92 @@
+#ifndef FLUTTER_BIN_UNICODE_H_
+#define FLUTTER_BIN_UNICODE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "byte_view.h"
+
+namespace flutter_bin {
+
+// A view of UTF-16LE code units stored in a byte buffer. The data does not
+// need to be 2-byte aligned, so it can point straight into a file mapping.
+struct Utf16View {
+  const uint8_t* data = nullptr;
+  size_t length = 0;  // In code units.
+
+  Utf16View() = default;
+  Utf16View(const uint8_t* view_data, size_t view_length)
+      : data(view_data), length(view_length) {}
+
+  bool empty() const { return length == 0; }
+  char16_t at(size_t index) const {
+    return static_cast<char16_t>(LoadLe16(data + 2 * index));
+  }
+};
+
+// Implementations of the transcoders, slowest first. The SIMD kernels copy
+// runs of ASCII 8 or 16 code units at a time and hand everything else to
+// the scalar code.
+enum class UnicodeKernel {
+  kScalar,
+  kSse2,
+  kAvx2,
+};
+
+// Whether |kernel| can run on this CPU.
+bool UnicodeKernelSupported(UnicodeKernel kernel);
+
+// The fastest supported kernel; what the conversions below use unless told
+// otherwise.
+UnicodeKernel DefaultUnicodeKernel();
+
+// e.g. "scalar", "avx2".
+const char* UnicodeKernelName(UnicodeKernel kernel);
+
+// Returns true if |text| equals the ASCII string |ascii|, ignoring ASCII case
+// the same way VerQueryValue compares keys.
+bool EqualsAsciiIgnoreCase(Utf16View text, const char* ascii);
+
+// Appends |code_point| to |out| as UTF-8.
+void AppendCodePoint(char32_t code_point, std::string* out);
+
+// Writes |text| to |out|, which must have room for 3 * text.length bytes,
+// as UTF-8 and returns the number of bytes written. Unpaired surrogates
+// become U+FFFD. |kernel| must be supported.
+size_t Utf16ToUtf8(Utf16View text, char* out,
+                   UnicodeKernel kernel = DefaultUnicodeKernel());
+
+// Appends |text| to |out| as UTF-8. Unpaired surrogates become U+FFFD.
+void AppendUtf8(Utf16View text, std::string* out);
+
+// Converts |text| to UTF-8.
+std::string Utf16ToUtf8(Utf16View text);
+
+// Writes |utf8| to |out|, which must have room for utf8.size() code units,
+// as UTF-16 and returns the number of code units written. Each maximal
+// invalid subsequence (overlong forms, surrogates, code points past
+// U+10FFFF, truncated sequences) becomes one U+FFFD, as
+// MultiByteToWideChar does, and clears |*valid| if given. |kernel| must be
+// supported.
+size_t Utf8ToUtf16(std::string_view utf8, char16_t* out, bool* valid = nullptr,
+                   UnicodeKernel kernel = DefaultUnicodeKernel());
+
+// Converts |utf8| to UTF-16 as above.
+std::u16string Utf8ToUtf16(std::string_view utf8, bool* valid = nullptr);
+
+#if defined(_WIN32)
+// Windows wide strings are UTF-16, so these are the conversions above with
+// one allocation each instead of MultiByteToWideChar's size-then-convert
+// round trip.
+std::wstring Utf8ToWide(std::string_view utf8);
+// Converts |utf8| into |out|, reusing its capacity, for paths converted on
+// every call.
+void Utf8ToWide(std::string_view utf8, std::wstring* out);
+std::string WideToUtf8(const wchar_t* wide, size_t length);
+#endif
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_UNICODE_H_
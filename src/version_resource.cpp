@@ -0,0 +1,193 @@
+#include "version_resource.h"
+
+#include <charconv>
+
+namespace flutter_bin {
+
+namespace {
+
+// wLength, wValueLength and wType.
+constexpr size_t kNodeHeaderSize = 6;
+
+}  // namespace
+
+bool ParseVersionNode(ByteView block, VersionNode* node) {
+  if (block.size < kNodeHeaderSize) {
+    return false;
+  }
+  size_t length = LoadLe16(block.data);
+  size_t value_length = LoadLe16(block.data + 2);
+  uint16_t type = LoadLe16(block.data + 4);
+  if (length < kNodeHeaderSize || length > block.size) {
+    return false;
+  }
+  ByteView self = block.Sub(0, length);
+
+  // The key is a NUL-terminated UTF-16 string right after the header.
+  size_t key_end = kNodeHeaderSize;
+  while (key_end + 2 <= self.size && LoadLe16(self.data + key_end) != 0) {
+    key_end += 2;
+  }
+  if (key_end + 2 > self.size) {
+    return false;
+  }
+  node->key = Utf16View(self.data + kNodeHeaderSize,
+                        (key_end - kNodeHeaderSize) / 2);
+
+  // Text values are measured in WCHARs, binary values in bytes. Clamp both to
+  // the node because many resource compilers get the unit wrong.
+  size_t value_offset = AlignUp4(key_end + 2);
+  size_t value_size = type == 1 ? value_length * 2 : value_length;
+  if (value_offset > self.size) {
+    value_offset = self.size;
+  }
+  if (value_size > self.size - value_offset) {
+    value_size = self.size - value_offset;
+  }
+  node->value = self.Sub(value_offset, value_size);
+  node->type = type;
+  node->children = self.From(AlignUp4(value_offset + value_size));
+  return true;
+}
+
+bool VersionNodeIterator::Next(VersionNode* node) {
+  offset_ = AlignUp4(offset_);
+  if (offset_ >= children_.size) {
+    return false;
+  }
+  ByteView rest = children_.From(offset_);
+  if (!ParseVersionNode(rest, node)) {
+    offset_ = children_.size;
+    return false;
+  }
+  offset_ += LoadLe16(rest.data);
+  return true;
+}
+
+Utf16View VersionStringValue(const VersionNode& node) {
+  Utf16View text(node.value.data, node.value.size / 2);
+  // Stop at the first NUL, like the C string VerQueryValue hands back.
+  for (size_t i = 0; i < text.length; ++i) {
+    if (text.at(i) == 0) {
+      text.length = i;
+      break;
+    }
+  }
+  return text;
+}
+
+bool VersionResource::Parse(ByteView blob) {
+  *this = VersionResource();
+
+  VersionNode root;
+  if (!ParseVersionNode(blob, &root) ||
+      !EqualsAsciiIgnoreCase(root.key, "VS_VERSION_INFO")) {
+    return false;
+  }
+  if (root.value.size >= FixedFileInfoView::kSize) {
+    fixed_file_info_ = FixedFileInfoView(root.value.data);
+  }
+
+  VersionNodeIterator it(root.children);
+  VersionNode child;
+  while (it.Next(&child)) {
+    if (EqualsAsciiIgnoreCase(child.key, "StringFileInfo")) {
+      string_file_info_ = child.children;
+    } else if (EqualsAsciiIgnoreCase(child.key, "VarFileInfo")) {
+      VersionNodeIterator vars(child.children);
+      VersionNode var;
+      while (vars.Next(&var)) {
+        if (EqualsAsciiIgnoreCase(var.key, "Translation")) {
+          translations_ = var.value;
+          break;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+uint32_t VersionResource::translation(size_t index) const {
+  const uint8_t* entry = translations_.data + index * 4;
+  return (static_cast<uint32_t>(LoadLe16(entry)) << 16) | LoadLe16(entry + 2);
+}
+
+bool VersionResource::FindStringInTable(uint32_t translation, const char* key,
+                                        Utf16View* value) const {
+  VersionNodeIterator tables(string_file_info_);
+  VersionNode table;
+  while (tables.Next(&table)) {
+    uint32_t table_translation = 0;
+    if (!ParseTranslationKey(table.key, &table_translation) ||
+        table_translation != translation) {
+      continue;
+    }
+    VersionNodeIterator strings(table.children);
+    VersionNode entry;
+    while (strings.Next(&entry)) {
+      if (EqualsAsciiIgnoreCase(entry.key, key)) {
+        *value = VersionStringValue(entry);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool VersionResource::FindString(const char* key, Utf16View* value) const {
+  // An empty value counts as a miss, as it did with VerQueryValueW.
+  if (FindStringInTable(kDefaultTranslation, key, value) && !value->empty()) {
+    return true;
+  }
+  for (size_t i = 0; i < translation_count(); ++i) {
+    if (FindStringInTable(translation(i), key, value) && !value->empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ParseTranslationKey(Utf16View key, uint32_t* translation) {
+  if (key.length != 8) {
+    return false;
+  }
+  uint32_t result = 0;
+  for (size_t i = 0; i < key.length; ++i) {
+    char16_t c = key.at(i);
+    uint32_t digit = 0;
+    if (c >= u'0' && c <= u'9') {
+      digit = static_cast<uint32_t>(c - u'0');
+    } else if (c >= u'a' && c <= u'f') {
+      digit = static_cast<uint32_t>(c - u'a' + 10);
+    } else if (c >= u'A' && c <= u'F') {
+      digit = static_cast<uint32_t>(c - u'A' + 10);
+    } else {
+      return false;
+    }
+    result = (result << 4) | digit;
+  }
+  *translation = result;
+  return true;
+}
+
+std::string FormatFileVersion(const FixedFileInfoView& info) {
+  char version[kMaxFileVersionLength];
+  return std::string(version, FormatFileVersion(info, version));
+}
+
+size_t FormatFileVersion(const FixedFileInfoView& info, char* out) {
+  const uint32_t parts[4] = {
+      info.file_version_ms() >> 16, info.file_version_ms() & 0xFFFF,
+      info.file_version_ls() >> 16, info.file_version_ls() & 0xFFFF};
+  char* end = out + kMaxFileVersionLength;
+  char* cursor = out;
+  for (size_t i = 0; i < 4; ++i) {
+    if (i > 0) {
+      *cursor++ = '.';
+    }
+    cursor = std::to_chars(cursor, end, parts[i]).ptr;
+  }
+  return static_cast<size_t>(cursor - out);
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,117 @@
+#ifndef FLUTTER_BIN_VERSION_RESOURCE_H_
+#define FLUTTER_BIN_VERSION_RESOURCE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "byte_view.h"
+#include "unicode.h"
+
+namespace flutter_bin {
+
+// View of a VS_FIXEDFILEINFO structure inside a version resource.
+class FixedFileInfoView {
+ public:
+  static constexpr uint32_t kSignature = 0xFEEF04BD;
+  static constexpr size_t kSize = 52;
+
+  FixedFileInfoView() = default;
+  explicit FixedFileInfoView(const uint8_t* data) : data_(data) {}
+
+  bool valid() const {
+    return data_ != nullptr && LoadLe32(data_) == kSignature;
+  }
+
+  uint32_t file_version_ms() const { return Field(2); }
+  uint32_t file_version_ls() const { return Field(3); }
+  uint32_t product_version_ms() const { return Field(4); }
+  uint32_t product_version_ls() const { return Field(5); }
+  uint32_t file_flags() const { return Field(7); }
+  uint32_t file_os() const { return Field(8); }
+  uint32_t file_type() const { return Field(9); }
+
+ private:
+  uint32_t Field(size_t index) const { return LoadLe32(data_ + index * 4); }
+
+  const uint8_t* data_ = nullptr;
+};
+
+// One node of the VS_VERSIONINFO tree (VS_VERSIONINFO, StringFileInfo,
+// StringTable, String, VarFileInfo or Var). All members are views.
+struct VersionNode {
+  Utf16View key;
+  ByteView value;
+  uint16_t type = 0;  // 1 for text values, 0 for binary values.
+  ByteView children;
+};
+
+// Parses the node at the start of |block|. Returns false if malformed.
+bool ParseVersionNode(ByteView block, VersionNode* node);
+
+// Iterates the sibling nodes packed into a node's |children| area.
+class VersionNodeIterator {
+ public:
+  explicit VersionNodeIterator(ByteView children) : children_(children) {}
+
+  // Advances to the next child. Returns false at the end or on corruption.
+  bool Next(VersionNode* node);
+
+ private:
+  ByteView children_;
+  size_t offset_ = 0;
+};
+
+// Returns the text of a String node's value without the trailing NULs.
+Utf16View VersionStringValue(const VersionNode& node);
+
+// Zero-copy reader for a raw VS_VERSIONINFO blob, as stored in RT_VERSION.
+class VersionResource {
+ public:
+  // Language/code page pair conventionally tried first by callers.
+  static constexpr uint32_t kDefaultTranslation = 0x040904B0;
+
+  VersionResource() = default;
+
+  // Parses the top-level structure of |blob|, which must outlive this object.
+  bool Parse(ByteView blob);
+
+  const FixedFileInfoView& fixed_file_info() const { return fixed_file_info_; }
+
+  // The StringTable nodes of the StringFileInfo block.
+  ByteView string_file_info() const { return string_file_info_; }
+
+  // The \VarFileInfo\Translation entries, each (language << 16) | code page.
+  size_t translation_count() const { return translations_.size / 4; }
+  uint32_t translation(size_t index) const;
+
+  // Looks up |key| in the StringTable for |translation|.
+  bool FindStringInTable(uint32_t translation, const char* key,
+                         Utf16View* value) const;
+
+  // Looks up |key| the way the plugin always has: the 040904B0 table first,
+  // then every language listed in \VarFileInfo\Translation.
+  bool FindString(const char* key, Utf16View* value) const;
+
+ private:
+  FixedFileInfoView fixed_file_info_;
+  ByteView string_file_info_;
+  ByteView translations_;
+};
+
+// Parses an 8 hex digit StringTable key such as "040904B0".
+bool ParseTranslationKey(Utf16View key, uint32_t* translation);
+
+// Longest "major.minor.build.revision": four 16-bit numbers and three dots.
+constexpr size_t kMaxFileVersionLength = 23;
+
+// Formats the file version as "major.minor.build.revision".
+std::string FormatFileVersion(const FixedFileInfoView& info);
+
+// Writes the file version as above to |out|, which must have room for
+// kMaxFileVersionLength characters, and returns its length.
+size_t FormatFileVersion(const FixedFileInfoView& info, char* out);
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_VERSION_RESOURCE_H_
@@ -0,0 +1,122 @@
+#include "version_string_index.h"
+
+#include <algorithm>
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr uint32_t kFnvOffsetBasis = 2166136261u;
+constexpr uint32_t kFnvPrime = 16777619u;
+
+// Rank of tables that \VarFileInfo\Translation does not mention.
+constexpr uint32_t kUnlistedRank = 0xFFFFFFFFu;
+
+uint32_t FoldAscii(uint32_t c) {
+  return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+}
+
+// HashVersionKey() of a UTF-16 key from the resource.
+uint32_t HashKey(Utf16View key) {
+  uint32_t hash = kFnvOffsetBasis;
+  for (size_t i = 0; i < key.length; ++i) {
+    hash = (hash ^ FoldAscii(key.at(i))) * kFnvPrime;
+  }
+  return hash;
+}
+
+// Position of |translation| in the lookup order used by Find().
+uint32_t RankOf(const VersionResource& resource, uint32_t translation) {
+  if (translation == VersionResource::kDefaultTranslation) {
+    return 0;
+  }
+  for (size_t i = 0; i < resource.translation_count(); ++i) {
+    if (resource.translation(i) == translation) {
+      return static_cast<uint32_t>(i + 1);
+    }
+  }
+  return kUnlistedRank;
+}
+
+}  // namespace
+
+void VersionStringIndex::Build(const VersionResource& resource) {
+  Build(resource, nullptr, 0);
+}
+
+void VersionStringIndex::Build(const VersionResource& resource,
+                               const uint32_t* hashes, size_t hash_count) {
+  Clear();
+
+  VersionNodeIterator tables(resource.string_file_info());
+  VersionNode table;
+  while (tables.Next(&table)) {
+    uint32_t translation = 0;
+    if (!ParseTranslationKey(table.key, &translation)) {
+      continue;
+    }
+    uint32_t rank = RankOf(resource, translation);
+    VersionNodeIterator strings(table.children);
+    VersionNode entry;
+    while (strings.Next(&entry)) {
+      uint32_t hash = HashKey(entry.key);
+      if (hashes != nullptr &&
+          std::find(hashes, hashes + hash_count, hash) == hashes + hash_count) {
+        continue;
+      }
+      entries_.push_back({hash, rank,
+                          static_cast<uint32_t>(entries_.size()), translation,
+                          entry.key, VersionStringValue(entry)});
+    }
+  }
+
+  // Duplicate keys within one table keep their file order, so the first one
+  // wins, as it does with VerQueryValueW. std::stable_sort would do the same
+  // but allocates a buffer on every call.
+  std::sort(entries_.begin(), entries_.end(),
+            [](const Entry& a, const Entry& b) {
+              if (a.hash != b.hash) {
+                return a.hash < b.hash;
+              }
+              return a.rank != b.rank ? a.rank < b.rank
+                                      : a.position < b.position;
+            });
+}
+
+void VersionStringIndex::Clear() { entries_.clear(); }
+
+bool VersionStringIndex::Find(const char* key, Utf16View* value) const {
+  return Find(HashVersionKey(key), key, value);
+}
+
+bool VersionStringIndex::Find(uint32_t hash, const char* key,
+                              Utf16View* value) const {
+  auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), hash,
+      [](const Entry& entry, uint32_t h) { return entry.hash < h; });
+  for (; it != entries_.end() && it->hash == hash; ++it) {
+    if (!it->value.empty() && EqualsAsciiIgnoreCase(it->key, key)) {
+      *value = it->value;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool VersionStringIndex::FindInTable(uint32_t translation, const char* key,
+                                     Utf16View* value) const {
+  uint32_t hash = HashVersionKey(key);
+  auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), hash,
+      [](const Entry& entry, uint32_t h) { return entry.hash < h; });
+  for (; it != entries_.end() && it->hash == hash; ++it) {
+    if (it->translation == translation &&
+        EqualsAsciiIgnoreCase(it->key, key)) {
+      *value = it->value;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,78 @@
+#ifndef FLUTTER_BIN_VERSION_STRING_INDEX_H_
+#define FLUTTER_BIN_VERSION_STRING_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "unicode.h"
+#include "version_resource.h"
+
+namespace flutter_bin {
+
+// FNV-1a over case-folded code units, so a UTF-16 key from the resource and
+// an ASCII key from the caller hash identically. constexpr so fixed keys
+// can be hashed at compile time.
+constexpr uint32_t HashVersionKey(const char* key) {
+  uint32_t hash = 2166136261u;
+  for (; *key != '\0'; ++key) {
+    uint32_t c = static_cast<uint8_t>(*key);
+    hash = (hash ^ ((c >= 'A' && c <= 'Z') ? c + 32 : c)) * 16777619u;
+  }
+  return hash;
+}
+
+// Key -> value index over every StringTable of a version resource.
+//
+// Build() walks the StringFileInfo tree exactly once and records a view of
+// each String node, so any number of lookups (the five standard fields as
+// well as custom keys such as FileVersion or PrivateBuild) cost a hash probe
+// instead of another walk per key and per translation. An index can be
+// rebuilt for the next file without giving its storage back.
+class VersionStringIndex {
+ public:
+  VersionStringIndex() = default;
+
+  // Indexes |resource|, which must outlive this object.
+  void Build(const VersionResource& resource);
+
+  // Build() that only indexes the keys whose HashVersionKey() is one of the
+  // |hash_count| |hashes|, for a caller that knows which keys it will look
+  // up. Other keys are skipped before they are sorted.
+  void Build(const VersionResource& resource, const uint32_t* hashes,
+             size_t hash_count);
+
+  // Drops all entries but keeps the allocated capacity.
+  void Clear();
+
+  // Looks up |key| (ASCII, case-insensitive). Tables are tried in the order
+  // the plugin has always used: 040904B0, then each \VarFileInfo\Translation
+  // entry, then any remaining table. Empty values count as misses.
+  bool Find(const char* key, Utf16View* value) const;
+
+  // Find() with |hash| already computed as HashVersionKey(key).
+  bool Find(uint32_t hash, const char* key, Utf16View* value) const;
+
+  // Looks up |key| in the table for one specific translation only.
+  bool FindInTable(uint32_t translation, const char* key,
+                   Utf16View* value) const;
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    uint32_t hash;
+    uint32_t rank;  // Lower ranks win; see Find().
+    uint32_t position;  // Order in the resource, to break ties.
+    uint32_t translation;
+    Utf16View key;
+    Utf16View value;
+  };
+
+  // Sorted by (hash, rank, position).
+  std::vector<Entry> entries_;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_BIN_VERSION_STRING_INDEX_H_
@@ -0,0 +1,75 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:flutter_bin/flutter_bin_ffi.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+/// Builds a result buffer the way src/flat_metadata.cpp writes it.
+Uint8List flatBuffer(Map<String, String> fields, {String error = ''}) {
+  const headerSize = 24;
+  const entrySize = 16;
+  final strings = BytesBuilder();
+  final stringsStart = headerSize + fields.length * entrySize;
+  final data = ByteData(stringsStart);
+  int add(String value) {
+    final offset = stringsStart + strings.length;
+    strings.add(utf8.encode(value));
+    return offset;
+  }
+
+  var entry = headerSize;
+  for (final field in fields.entries) {
+    data.setUint32(entry, add(field.key), Endian.little);
+    data.setUint32(entry + 4, utf8.encode(field.key).length, Endian.little);
+    data.setUint32(entry + 8, add(field.value), Endian.little);
+    data.setUint32(entry + 12, utf8.encode(field.value).length, Endian.little);
+    entry += entrySize;
+  }
+  data.setUint32(12, add(error), Endian.little);
+  data.setUint32(16, utf8.encode(error).length, Endian.little);
+  final size = stringsStart + strings.length;
+  data.setUint32(0, 0x4D424C46, Endian.little);
+  data.setUint32(4, size, Endian.little);
+  data.setUint32(8, fields.length, Endian.little);
+  return (BytesBuilder()
+        ..add(data.buffer.asUint8List())
+        ..add(strings.takeBytes()))
+      .takeBytes();
+}
+
+void main() {
+  test('decodes a result buffer', () {
+    final metadata = FlutterBinFfi.decode(flatBuffer({
+      'version': '1.2.3.4',
+      'productName': 'Ünïcode Product',
+      'InternalName': 'example',
+      'sha256': 'ab' * 32,
+    }));
+
+    expect(metadata.version, '1.2.3.4');
+    expect(metadata.productName, 'Ünïcode Product');
+    expect(metadata.customFields, {'InternalName': 'example'});
+    expect(metadata.hashes, {'sha256': 'ab' * 32});
+    expect(metadata.error, isNull);
+  });
+
+  test('decodes the error code', () {
+    final metadata =
+        FlutterBinFfi.decode(flatBuffer({}, error: 'FILE_NOT_FOUND'));
+
+    expect(metadata.error, 'FILE_NOT_FOUND');
+    expect(metadata.version, '');
+  });
+
+  test('rejects malformed buffers', () {
+    final bytes = flatBuffer({'version': '1.0'});
+
+    expect(() => FlutterBinFfi.decode(Uint8List(8)), throwsFormatException);
+    expect(() => FlutterBinFfi.decode(Uint8List.sublistView(bytes, 0, 30)),
+        throwsFormatException);
+    // A string offset past the end.
+    final corrupt = Uint8List.fromList(bytes);
+    ByteData.sublistView(corrupt).setUint32(24, 1000, Endian.little);
+    expect(() => FlutterBinFfi.decode(corrupt), throwsFormatException);
+  });
+}
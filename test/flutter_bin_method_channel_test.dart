@@ -1,21 +1,75 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
 import 'package:flutter_bin/flutter_bin_method_channel.dart';
+import 'package:flutter_bin/models/binary_dependencies.dart';
+import 'package:flutter_bin/models/binary_file_metadata.dart';
+import 'package:flutter_bin/models/cancel_token.dart';
+import 'package:flutter_bin/models/columnar_metadata_list.dart';
+import 'package:flutter_bin/models/hash_algorithm.dart';
+import 'package:flutter_bin/models/metadata_field.dart';
+import 'package:flutter_bin/models/request_priority.dart';
+import 'package:flutter_bin/models/scan_result.dart';
+import 'package:flutter_bin/models/watch_event.dart';
 import 'package:flutter_test/flutter_test.dart';
 
+/// Encodes [rows] the way src/columnar_batch.cpp does.
+Uint8List columnarBatch(List<Map<String, String>> rows) {
+  final strings = <String>[];
+  final ids = <String, int>{};
+  int intern(String value) =>
+      ids.putIfAbsent(value, () => (strings..add(value)).length - 1);
+  final keys = <String>[for (final row in rows) ...row.keys].toSet().toList();
+  final keyIds = [for (final key in keys) intern(key)];
+  final columns = [
+    for (final key in keys)
+      [for (final row in rows) row.containsKey(key) ? intern(row[key]!) : -1],
+  ];
+  final encoded = [for (final string in strings) utf8.encode(string)];
+  final words = <int>[
+    0x42434246, 0, rows.length, keys.length, strings.length, 0, //
+    ...keyIds,
+    for (final column in columns) ...column,
+  ];
+  var offset = 0;
+  for (final bytes in encoded) {
+    words.add(offset);
+    offset += bytes.length;
+  }
+  words.add(offset);
+  final builder = BytesBuilder();
+  final header = ByteData(words.length * 4);
+  for (var i = 0; i < words.length; i++) {
+    header.setUint32(i * 4, words[i] & 0xFFFFFFFF, Endian.little);
+  }
+  builder.add(header.buffer.asUint8List());
+  encoded.forEach(builder.add);
+  final bytes = builder.takeBytes();
+  ByteData.sublistView(bytes).setUint32(4, bytes.length, Endian.little);
+  return bytes;
+}
+
 void main() {
   TestWidgetsFlutterBinding.ensureInitialized();
 
   MethodChannelFlutterBin platform = MethodChannelFlutterBin();
   const MethodChannel channel = MethodChannel('flutter_bin');
+  final List<MethodCall> log = [];
 
   setUp(() {
     TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
         .setMockMethodCallHandler(
       channel,
       (MethodCall methodCall) async {
+        log.add(methodCall);
         if (methodCall.method == 'getBinaryFileVersion') {
           return '1.2.3.4';
         } else if (methodCall.method == 'getBinaryFileMetadata') {
+          final customKeys =
+              (methodCall.arguments['customKeys'] as List?)?.cast<String>() ??
+                  const <String>[];
           // Return mock metadata
           return {
             'version': '1.2.3.4',
@@ -24,7 +78,109 @@ void main() {
             'legalCopyright': '© 2025 Test Company',
             'originalFilename': 'test.exe',
             'companyName': 'Test Company',
+            for (final key in customKeys) key: 'Test $key',
+            for (final hash in (methodCall.arguments['hashes'] as List?) ??
+                const [])
+              hash: 'hex-$hash',
+            if (methodCall.arguments['signature'] == true) ...{
+              'signerName': 'Test Signer',
+              'signerIssuer': 'CN=Test CA, C=US',
+              'signerSerial': '9abc',
+              'signingTime': '2024-01-02T03:04:05Z',
+            },
+          };
+        } else if (methodCall.method == 'getBinaryFileMetadataBatch') {
+          final paths = (methodCall.arguments['paths'] as List).cast<String>();
+          if (paths.first.startsWith('columnar')) {
+            return columnarBatch([
+              for (final path in paths)
+                path.startsWith('missing')
+                    ? {'error': 'FILE_NOT_FOUND'}
+                    : {
+                        'version': '1.2.3.4',
+                        'companyName': 'Example Inc.',
+                        'originalFilename': path,
+                      },
+            ]);
+          }
+          return [
+            for (final path in paths)
+              path.startsWith('missing')
+                  ? {'error': 'FILE_NOT_FOUND'}
+                  : {'version': '1.2.3.4', 'originalFilename': path},
+          ];
+        } else if (methodCall.method == 'getBinaryDependencies') {
+          return {
+            'names': ['KERNEL32.dll', 'Sleep', 'USER32.dll', '#5', 'a.dll'],
+            'files': [
+              {
+                'imports': Int32List.fromList([0, 1, 1]),
+                'delayImports': Int32List.fromList([2, 1, 3]),
+                'exports': Int32List.fromList([1]),
+                'exportName': 4,
+              },
+              {
+                'imports': Int32List.fromList([0, 1, 1]),
+                'delayImports': Int32List(0),
+                'exports': Int32List(0),
+              },
+              {
+                'imports': Int32List(0),
+                'delayImports': Int32List(0),
+                'exports': Int32List(0),
+                'error': 'UNSUPPORTED_FORMAT',
+              },
+            ],
+          };
+        } else if (methodCall.method == 'watch') {
+          final paths = (methodCall.arguments['paths'] as List).cast<String>();
+          if (paths.every((path) => path.startsWith('missing'))) {
+            throw PlatformException(
+                code: 'WATCH_FAILED',
+                message: 'None of the paths can be watched');
+          }
+          return [
+            for (final path in paths)
+              if (path.startsWith('missing')) path,
+          ];
+        } else if (methodCall.method == 'unwatch') {
+          return true;
+        } else if (methodCall.method == 'cancelRequest') {
+          return methodCall.arguments['requestId'] == 7;
+        } else if (methodCall.method == 'getCacheStats') {
+          return {
+            'hits': 2,
+            'misses': 5,
+            'indexHits': 3,
+            'entries': 5,
+            'budgetBytes': 1024,
           };
+        } else if (methodCall.method == 'getPerfStats') {
+          return {
+            'enabled': true,
+            'phases': {
+              'methodCall': {
+                'count': 4,
+                'totalNanos': 40000,
+                'p50Nanos': 9215,
+                'p90Nanos': 12287,
+                'p99Nanos': 12287,
+                'maxNanos': 12287,
+              },
+            },
+            'priorities': {
+              'bulk': {'count': 2, 'p50Nanos': 1023, 'maxNanos': 2047},
+              // Classes this version does not know are skipped.
+              'background': {'count': 1},
+            },
+            if (methodCall.arguments['trace'] == true)
+              'trace': '{"displayTimeUnit":"ns","traceEvents":[]}',
+          };
+        } else if (methodCall.method == 'cancelScan' ||
+            methodCall.method == 'acknowledgeScanBatch') {
+          return true;
+        } else if (methodCall.method == 'configure') {
+          return methodCall.arguments['asyncExecution'] ?? true;
         }
         return null;
       },
@@ -32,6 +188,7 @@ void main() {
   });
 
   tearDown(() {
+    log.clear();
     TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
         .setMockMethodCallHandler(channel, null);
   });
@@ -49,5 +206,543 @@ void main() {
     expect(metadata.legalCopyright, '© 2025 Test Company');
     expect(metadata.originalFilename, 'test.exe');
     expect(metadata.companyName, 'Test Company');
+    expect(metadata.customFields, isEmpty);
+  });
+
+  test('getBinaryFileMetadata with custom keys', () async {
+    final metadata = await platform.getBinaryFileMetadata('test.exe',
+        customKeys: ['FileVersion', 'PrivateBuild']);
+
+    expect(metadata.customFields, {
+      'FileVersion': 'Test FileVersion',
+      'PrivateBuild': 'Test PrivateBuild',
+    });
+  });
+
+  test('getBinaryFileMetadata with hashes', () async {
+    final metadata = await platform.getBinaryFileMetadata('test.exe',
+        hashes: [HashAlgorithm.sha256, HashAlgorithm.blake3]);
+
+    expect(log.last.arguments['hashes'], ['sha256', 'blake3']);
+    expect(metadata.hashes, {'sha256': 'hex-sha256', 'blake3': 'hex-blake3'});
+    expect(metadata.customFields, isEmpty);
+  });
+
+  test('getBinaryFileMetadata with fields', () async {
+    await platform.getBinaryFileMetadata('test.exe');
+    expect(log.last.arguments.containsKey('fieldMask'), isFalse);
+
+    await platform.getBinaryFileMetadata('test.exe',
+        fields: {MetadataField.version, MetadataField.companyName});
+    expect(log.last.arguments['fieldMask'], 0x21);
+
+    await platform.getBinaryFileMetadata('test.exe', fields: {
+      ...MetadataField.standard,
+      MetadataField.sha256,
+      MetadataField.signature,
+    });
+    expect(log.last.arguments['fieldMask'], 0x27F);
+  });
+
+  test('getBinaryFileMetadata with the Authenticode digest', () async {
+    final metadata = await platform.getBinaryFileMetadata('test.exe',
+        hashes: [HashAlgorithm.authenticode]);
+
+    expect(log.last.arguments['hashes'], ['authenticode']);
+    expect(metadata.hashes, {'authenticode': 'hex-authenticode'});
+    expect(metadata.customFields, isEmpty);
+  });
+
+  test('getBinaryFileMetadata with the code signature', () async {
+    final unsigned = await platform.getBinaryFileMetadata('test.exe');
+    expect(log.last.arguments.containsKey('signature'), isFalse);
+    expect(unsigned.signature, isNull);
+
+    final metadata =
+        await platform.getBinaryFileMetadata('test.exe', signature: true);
+
+    expect(log.last.arguments['signature'], true);
+    expect(metadata.signature!.signerName, 'Test Signer');
+    expect(metadata.signature!.issuer, 'CN=Test CA, C=US');
+    expect(metadata.signature!.serialNumber, '9abc');
+    expect(metadata.signature!.timestamp,
+        DateTime.utc(2024, 1, 2, 3, 4, 5));
+    expect(metadata.customFields, isEmpty);
+  });
+
+  test('getBinaryFileMetadataBatch', () async {
+    final results = await platform.getBinaryFileMetadataBatch(
+        ['a.exe', 'missing.exe', 'b.exe'],
+        fields: ['version', 'originalFilename']);
+
+    expect(results.length, 3);
+    expect(results[0].originalFilename, 'a.exe');
+    expect(results[0].error, isNull);
+    expect(results[1].error, 'FILE_NOT_FOUND');
+    expect(results[1].customFields, isEmpty);
+    expect(results[2].version, '1.2.3.4');
+    expect(results[2].originalFilename, 'b.exe');
+  });
+
+  test('getBinaryFileMetadataBatch decodes the columnar reply lazily',
+      () async {
+    final results = await platform.getBinaryFileMetadataBatch(
+        ['columnar_a.exe', 'missing.exe', 'columnar_b.exe']);
+
+    expect(log.last.arguments['columnar'], isTrue);
+    expect(results, isA<ColumnarMetadataList>());
+    expect(results.length, 3);
+    final columnar = results as ColumnarMetadataList;
+    expect(columnar.fieldAt(2, 'originalFilename'), 'columnar_b.exe');
+    expect(columnar.fieldAt(1, 'version'), isNull);
+    expect(results[0].version, '1.2.3.4');
+    expect(results[0].error, isNull);
+    expect(results[1].error, 'FILE_NOT_FOUND');
+    expect(results[1].companyName, '');
+    expect(results[2].originalFilename, 'columnar_b.exe');
+    // Rows are decoded once, and repeated values share one String.
+    expect(identical(results[0], results[0]), isTrue);
+    expect(identical(results[0].companyName, results[2].companyName), isTrue);
+    expect(() => results[3], throwsRangeError);
+    expect(() => results[0] = results[1], throwsUnsupportedError);
+  });
+
+  test('ColumnarMetadataList rejects malformed payloads', () {
+    final bytes = columnarBatch([
+      {'version': '1.0'},
+    ]);
+
+    expect(() => ColumnarMetadataList(Uint8List(8)), throwsFormatException);
+    expect(() => ColumnarMetadataList(Uint8List.sublistView(bytes, 0, 30)),
+        throwsFormatException);
+    final corrupt = Uint8List.fromList(bytes);
+    // The value id of the only row.
+    ByteData.sublistView(corrupt).setUint32(28, 99, Endian.little);
+    expect(() => ColumnarMetadataList(corrupt)[0], throwsFormatException);
+  });
+
+  test('getBinaryDependencies', () async {
+    final results = await platform
+        .getBinaryDependencies(['a.dll', 'b.exe', 'libc.so.6']);
+
+    expect(log.last.arguments['paths'], ['a.dll', 'b.exe', 'libc.so.6']);
+    expect(results.length, 3);
+    final a = results[0];
+    expect(a.imports.map((m) => m.name), ['KERNEL32.dll', 'USER32.dll']);
+    expect(a.imports[0].functions, ['Sleep']);
+    expect(a.imports[0].delayLoaded, isFalse);
+    expect(a.imports[1].functions, ['#5']);
+    expect(a.imports[1].delayLoaded, isTrue);
+    expect(a.exportName, 'a.dll');
+    expect(a.exports, ['Sleep']);
+    // Both files refer to the same decoded name.
+    expect(identical(results[1].imports[0].name, a.imports[0].name), isTrue);
+    expect(results[1].exportName, isNull);
+    expect(results[2].error, 'UNSUPPORTED_FORMAT');
+    expect(results[2].imports, isEmpty);
+  });
+
+  test('cancelToken is sent as requestId', () async {
+    final token = CancelToken();
+    await platform.getBinaryFileMetadataBatch(['a.exe'], cancelToken: token);
+    await platform.getBinaryFileVersion('a.exe');
+
+    expect(log[0].arguments['requestId'], token.id);
+    expect((log[1].arguments as Map).containsKey('requestId'), isFalse);
+  });
+
+  test('cancelRequest', () async {
+    expect(await platform.cancelRequest(7), isTrue);
+    expect(await platform.cancelRequest(8), isFalse);
+  });
+
+  test('configure', () async {
+    await platform.configure(asyncExecution: false);
+
+    expect(log.single.method, 'configure');
+    expect(log.single.arguments, {'asyncExecution': false});
+  });
+
+  test('useCache is only sent when bypassing the cache', () async {
+    await platform.getBinaryFileMetadata('a.exe', useCache: false);
+    await platform.getBinaryFileMetadata('a.exe');
+
+    expect(log[0].arguments['useCache'], false);
+    expect((log[1].arguments as Map).containsKey('useCache'), isFalse);
+  });
+
+  test('getCacheStats', () async {
+    final stats = await platform.getCacheStats();
+
+    expect(stats.hits, 2);
+    expect(stats.misses, 5);
+    expect(stats.indexHits, 3);
+    expect(stats.entries, 5);
+    expect(stats.evictions, 0);
+    expect(stats.budgetBytes, 1024);
+  });
+
+  test('getPerfStats', () async {
+    final stats = await platform.getPerfStats();
+
+    expect(log.last.arguments, {'trace': false});
+    expect(stats.enabled, isTrue);
+    expect(stats.phases.keys, ['methodCall']);
+    expect(stats['methodCall'].count, 4);
+    expect(stats['methodCall'].mean, const Duration(microseconds: 10));
+    expect(stats['methodCall'].p50Nanos, 9215);
+    expect(stats['methodCall'].max, const Duration(microseconds: 12));
+    expect(stats.priorities.keys, [RequestPriority.bulk]);
+    expect(stats.priorities[RequestPriority.bulk]!.count, 2);
+    expect(stats.priorities[RequestPriority.bulk]!.p50Nanos, 1023);
+    expect(stats.trace, isNull);
+
+    final traced = await platform.getPerfStats(includeTrace: true);
+    expect(traced.trace, startsWith('{"displayTimeUnit"'));
+  });
+
+  test('configure sends perf switches', () async {
+    await platform.configure(perfStats: true, perfTrace: false);
+    await platform.resetPerfStats();
+
+    expect(log[0].arguments, {'perfStats': true, 'perfTrace': false});
+    expect(log[1].method, 'resetPerfStats');
+  });
+
+  test('configure sends the I/O budget', () async {
+    await platform.configure(
+        ioByteBudget: 65536, ioDeadline: const Duration(seconds: 2));
+
+    expect(log.single.arguments, {'ioByteBudget': 65536, 'ioDeadlineMs': 2000});
+  });
+
+  test('priority is only sent when given', () async {
+    await platform.getBinaryFileMetadata('a.exe',
+        priority: RequestPriority.bulk);
+    await platform.getBinaryFileVersion('a.exe');
+
+    expect(log[0].arguments['priority'], 'bulk');
+    expect((log[1].arguments as Map).containsKey('priority'), isFalse);
+  });
+
+  test('configure sends the scheduling limits', () async {
+    await platform.configure(concurrencyLimits: {
+      RequestPriority.bulk: 2,
+      RequestPriority.normal: 0,
+    }, priorityAging: const Duration(seconds: 1));
+
+    expect(log.single.arguments, {
+      'bulkConcurrency': 2,
+      'normalConcurrency': 0,
+      'priorityAgingMs': 1000,
+    });
+  });
+
+  test('bytesRead is not a custom field', () {
+    final metadata = BinaryFileMetadata.fromJson(
+        {'version': '1.0.0.0', 'bytesRead': 8192, 'error': 'TIMED_OUT'});
+
+    expect(metadata.bytesRead, 8192);
+    expect(metadata.error, 'TIMED_OUT');
+    expect(metadata.customFields, isEmpty);
+  });
+
+  group('scanDirectory', () {
+    const codec = StandardMethodCodec();
+    final messenger =
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger;
+
+    setUp(() {
+      // Answers the event channel's listen and cancel calls.
+      messenger.setMockMethodCallHandler(
+          const MethodChannel('flutter_bin/scan'), (call) async => null);
+    });
+
+    tearDown(() {
+      messenger.setMockMethodCallHandler(
+          const MethodChannel('flutter_bin/scan'), null);
+    });
+
+    Future<void> sendEvent(Map<String, Object?> event) {
+      return messenger.handlePlatformMessage(
+          'flutter_bin/scan', codec.encodeSuccessEnvelope(event), (_) {});
+    }
+
+    int startedScanId() => log
+        .lastWhere((call) => call.method == 'scanDirectory')
+        .arguments['scanId'] as int;
+
+    test('streams batches and acknowledges them', () async {
+      final batches = <List<String>>[];
+      final done = Completer<void>();
+      platform
+          .scanDirectory('C:/apps', extensions: ['exe'], maxDepth: 2)
+          .listen((batch) => batches.add([for (final r in batch) r.path]),
+              onDone: done.complete);
+      await pumpEventQueue();
+
+      final scanId = startedScanId();
+      expect(log.last.arguments, {
+        'scanId': scanId,
+        'root': 'C:/apps',
+        'extensions': ['exe'],
+        'maxDepth': 2,
+      });
+
+      await sendEvent({
+        'scanId': scanId,
+        'done': false,
+        'entries': [
+          {'path': 'C:/apps/a.exe', 'format': 'pe', 'version': '1.0.0.0'},
+        ],
+      });
+      await sendEvent({
+        'scanId': scanId,
+        'done': true,
+        'entries': [
+          {
+            'path': 'C:/apps/b.exe',
+            'format': 'pe',
+            'error': 'NO_VERSION_INFO',
+          },
+        ],
+        'rootFailed': false,
+      });
+      await done.future;
+
+      expect(batches, [
+        ['C:/apps/a.exe'],
+        ['C:/apps/b.exe'],
+      ]);
+      expect(log.where((call) => call.method == 'acknowledgeScanBatch').length,
+          1);
+    });
+
+    test('reports the metadata of each entry', () async {
+      final results = <ScanResult>[];
+      final stream = platform.scanDirectory('C:/apps');
+      final done = Completer<void>();
+      stream.listen(results.addAll, onDone: done.complete);
+      await pumpEventQueue();
+
+      await sendEvent({
+        'scanId': startedScanId(),
+        'done': true,
+        'entries': [
+          {'path': 'C:/apps/a.exe', 'format': 'pe', 'version': '1.0.0.0'},
+        ],
+      });
+      await done.future;
+
+      final result = results.single;
+      expect(result.format, 'pe');
+      expect(result.metadata.version, '1.0.0.0');
+      expect(result.metadata.customFields, isEmpty);
+    });
+
+    test('acknowledges paused batches on resume', () async {
+      final subscription = platform.scanDirectory('C:/apps').listen((_) {});
+      await pumpEventQueue();
+      final scanId = startedScanId();
+      subscription.pause();
+
+      await sendEvent({
+        'scanId': scanId,
+        'done': false,
+        'entries': [
+          {'path': 'C:/apps/a.exe', 'format': 'pe'},
+        ],
+      });
+      expect(log.where((call) => call.method == 'acknowledgeScanBatch'),
+          isEmpty);
+
+      subscription.resume();
+      await pumpEventQueue();
+      expect(log.where((call) => call.method == 'acknowledgeScanBatch').length,
+          1);
+      await subscription.cancel();
+    });
+
+    test('cancelling the subscription cancels the scan', () async {
+      final subscription = platform.scanDirectory('C:/apps').listen((_) {});
+      await pumpEventQueue();
+      final scanId = startedScanId();
+
+      await subscription.cancel();
+
+      expect(log.last.method, 'cancelScan');
+      expect(log.last.arguments, {'scanId': scanId});
+    });
+
+    test('fails when the root cannot be read', () async {
+      final errors = <Object>[];
+      final done = Completer<void>();
+      platform
+          .scanDirectory('C:/missing')
+          .listen((_) {}, onError: errors.add, onDone: done.complete);
+      await pumpEventQueue();
+
+      await sendEvent({
+        'scanId': startedScanId(),
+        'done': true,
+        'entries': [],
+        'rootFailed': true,
+      });
+      await done.future;
+
+      expect((errors.single as PlatformException).code, 'SCAN_FAILED');
+    });
+  });
+
+  group('watch', () {
+    const codec = StandardMethodCodec();
+    final messenger =
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger;
+
+    setUp(() {
+      // Answers the event channel's listen and cancel calls.
+      messenger.setMockMethodCallHandler(
+          const MethodChannel('flutter_bin/watch'), (call) async => null);
+    });
+
+    tearDown(() {
+      messenger.setMockMethodCallHandler(
+          const MethodChannel('flutter_bin/watch'), null);
+    });
+
+    Future<void> sendEvent(Map<String, Object?> event) {
+      return messenger.handlePlatformMessage(
+          'flutter_bin/watch', codec.encodeSuccessEnvelope(event), (_) {});
+    }
+
+    int startedWatchId() => log
+        .lastWhere((call) => call.method == 'watch')
+        .arguments['watchId'] as int;
+
+    test('streams settled changes', () async {
+      final batches = <List<WatchEvent>>[];
+      final subscription = platform
+          .watch(['C:/apps', 'missing.exe'],
+              extensions: ['dll'],
+              settleDelay: const Duration(seconds: 2))
+          .listen(batches.add);
+      await pumpEventQueue();
+
+      final watchId = startedWatchId();
+      expect(log.last.arguments, {
+        'watchId': watchId,
+        'paths': ['C:/apps', 'missing.exe'],
+        'extensions': ['dll'],
+        'settleMs': 2000,
+      });
+
+      await sendEvent({
+        'watchId': watchId,
+        'changes': [
+          {
+            'path': 'C:/apps/a.dll',
+            'change': 'modified',
+            'format': 'pe',
+            'version': '2.0.0.0',
+          },
+          {'path': 'C:/apps/b.dll', 'change': 'removed'},
+        ],
+      });
+      // Another watch's changes are not delivered here.
+      await sendEvent({
+        'watchId': watchId + 100,
+        'changes': [
+          {'path': 'C:/other/c.dll', 'change': 'added', 'format': 'pe'},
+        ],
+      });
+      await pumpEventQueue();
+
+      final changes = batches.single;
+      expect(changes[0].change, WatchChange.modified);
+      expect(changes[0].format, 'pe');
+      expect(changes[0].metadata!.version, '2.0.0.0');
+      expect(changes[1].change, WatchChange.removed);
+      expect(changes[1].format, isNull);
+      expect(changes[1].metadata, isNull);
+      await subscription.cancel();
+    });
+
+    test('cancelling the subscription stops the watch', () async {
+      final subscription = platform.watch(['C:/apps']).listen((_) {});
+      await pumpEventQueue();
+      final watchId = startedWatchId();
+
+      await subscription.cancel();
+
+      expect(log.last.method, 'unwatch');
+      expect(log.last.arguments, {'watchId': watchId});
+    });
+
+    test('fails when nothing can be watched', () async {
+      final errors = <Object>[];
+      final done = Completer<void>();
+      platform
+          .watch(['missing'])
+          .listen((_) {}, onError: errors.add, onDone: done.complete);
+      await done.future;
+
+      expect((errors.single as PlatformException).code, 'WATCH_FAILED');
+      expect(log.last.method, 'watch');
+    });
+  });
+
+  group('on macOS', () {
+    final messenger =
+        TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger;
+
+    setUp(() {
+      // Answers the way macos/Classes/FlutterBinPlugin.swift does for the
+      // methods it does not support.
+      messenger.setMockMethodCallHandler(channel, (call) async {
+        log.add(call);
+        switch (call.method) {
+          case 'scanDirectory':
+          case 'watch':
+            throw PlatformException(code: 'UNAVAILABLE');
+          case 'unwatch':
+          case 'cancelScan':
+            return false;
+          default:
+            throw MissingPluginException();
+        }
+      });
+      messenger.setMockMethodCallHandler(
+          const MethodChannel('flutter_bin/watch'), (call) async => null);
+    });
+
+    tearDown(() {
+      messenger.setMockMethodCallHandler(
+          const MethodChannel('flutter_bin/watch'), null);
+    });
+
+    test('watch fails with UNAVAILABLE', () async {
+      final errors = <Object>[];
+      final done = Completer<void>();
+      platform
+          .watch(['/Applications'])
+          .listen((_) {}, onError: errors.add, onDone: done.complete);
+      await done.future;
+
+      expect((errors.single as PlatformException).code, 'UNAVAILABLE');
+    });
+
+    test('perf stats and dependencies are not implemented', () async {
+      await expectLater(
+          platform.getPerfStats(), throwsA(isA<MissingPluginException>()));
+      await expectLater(
+          platform.resetPerfStats(), throwsA(isA<MissingPluginException>()));
+      await expectLater(platform.getBinaryDependencies(['/bin/ls']),
+          throwsA(isA<MissingPluginException>()));
+      expect(log.map((call) => call.method), [
+        'getPerfStats',
+        'resetPerfStats',
+        'getBinaryDependencies',
+      ]);
+    });
   });
 }
@@ -7,22 +7,186 @@ import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 class MockFlutterBinPlatform
     with MockPlatformInterfaceMixin
     implements FlutterBinPlatform {
+  final List<int> cancelledRequests = [];
+  bool? asyncExecution;
+  int? cacheBudgetBytes;
+  String? indexPath;
+  bool? perfStats;
+  bool? perfTrace;
+  int? ioByteBudget;
+  Duration? ioDeadline;
+  Map<RequestPriority, int>? concurrencyLimits;
+  Duration? priorityAging;
+  final List<RequestPriority?> priorities = [];
+  int cacheClears = 0;
+  int perfResets = 0;
+
   @override
-  Future<String?> getBinaryFileVersion(String filePath) async {
+  Future<String?> getBinaryFileVersion(
+    String filePath, {
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) async {
+    priorities.add(priority);
     return '1.2.3.4';
   }
 
   @override
-  Future<BinaryFileMetadata> getBinaryFileMetadata(String filePath) async {
+  Future<BinaryFileMetadata> getBinaryFileMetadata(
+    String filePath, {
+    List<String> customKeys = const [],
+    List<HashAlgorithm> hashes = const [],
+    bool signature = false,
+    Set<MetadataField>? fields,
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) async {
+    priorities.add(priority);
+    final requested = fields ?? MetadataField.standard;
+    String? mock(MetadataField field, String value) =>
+        requested.contains(field) ? value : null;
     return BinaryFileMetadata(
-      version: '1.2.3.4',
-      productName: 'Mock Product',
-      fileDescription: 'Mock File Description',
-      legalCopyright: '© 2025 Mock Company',
-      originalFilename: 'mock.exe',
-      companyName: 'Mock Company',
+      version: mock(MetadataField.version, '1.2.3.4'),
+      productName: mock(MetadataField.productName, 'Mock Product'),
+      fileDescription:
+          mock(MetadataField.fileDescription, 'Mock File Description'),
+      legalCopyright:
+          mock(MetadataField.legalCopyright, '© 2025 Mock Company'),
+      originalFilename: mock(MetadataField.originalFilename, 'mock.exe'),
+      companyName: mock(MetadataField.companyName, 'Mock Company'),
+      customFields: {for (final key in customKeys) key: 'Mock $key'},
+      hashes: {for (final hash in hashes) hash.key: 'mock-${hash.key}'},
     );
   }
+
+  @override
+  Future<List<BinaryFileMetadata>> getBinaryFileMetadataBatch(
+    List<String> paths, {
+    List<String>? fields,
+    bool useCache = true,
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) async {
+    priorities.add(priority);
+    return [
+      for (final path in paths) BinaryFileMetadata(originalFilename: path),
+    ];
+  }
+
+  @override
+  Future<List<BinaryDependencies>> getBinaryDependencies(
+    List<String> paths, {
+    CancelToken? cancelToken,
+    RequestPriority? priority,
+  }) async {
+    priorities.add(priority);
+    return [
+      for (final path in paths)
+        BinaryDependencies(imports: [
+          ImportedModule(name: 'KERNEL32.dll', functions: ['Sleep']),
+        ], exportName: path),
+    ];
+  }
+
+  @override
+  Stream<List<ScanResult>> scanDirectory(
+    String root, {
+    List<String>? extensions,
+    int? maxDepth,
+    bool followLinks = false,
+    List<String>? fields,
+    bool useCache = true,
+  }) {
+    return Stream.fromIterable([
+      [
+        ScanResult(
+            path: '$root/a.exe',
+            format: 'pe',
+            metadata: BinaryFileMetadata(version: '1.0.0.0')),
+      ],
+      [
+        ScanResult(
+            path: '$root/b.so', format: 'elf', metadata: BinaryFileMetadata()),
+      ],
+    ]);
+  }
+
+  @override
+  Stream<List<WatchEvent>> watch(
+    List<String> paths, {
+    List<String>? extensions,
+    bool recursive = true,
+    Duration? settleDelay,
+    List<String>? fields,
+    bool useCache = true,
+  }) {
+    return Stream.value([
+      WatchEvent(
+          path: '${paths.first}/a.exe',
+          change: WatchChange.modified,
+          format: 'pe',
+          metadata: BinaryFileMetadata(version: '2.0.0.0')),
+      WatchEvent(path: '${paths.first}/b.exe', change: WatchChange.removed),
+    ]);
+  }
+
+  @override
+  Future<bool> cancelRequest(int requestId) async {
+    cancelledRequests.add(requestId);
+    return true;
+  }
+
+  @override
+  Future<void> configure({
+    bool? asyncExecution,
+    int? cacheBudgetBytes,
+    String? indexPath,
+    bool? perfStats,
+    bool? perfTrace,
+    int? ioByteBudget,
+    Duration? ioDeadline,
+    Map<RequestPriority, int>? concurrencyLimits,
+    Duration? priorityAging,
+  }) async {
+    this.asyncExecution = asyncExecution;
+    this.cacheBudgetBytes = cacheBudgetBytes;
+    this.indexPath = indexPath;
+    this.perfStats = perfStats;
+    this.perfTrace = perfTrace;
+    this.ioByteBudget = ioByteBudget;
+    this.ioDeadline = ioDeadline;
+    this.concurrencyLimits = concurrencyLimits;
+    this.priorityAging = priorityAging;
+  }
+
+  @override
+  Future<void> clearCache() async {
+    cacheClears++;
+  }
+
+  @override
+  Future<CacheStats> getCacheStats() async {
+    return CacheStats(hits: 3, misses: 1, entries: 1);
+  }
+
+  @override
+  Future<PerfStats> getPerfStats({bool includeTrace = false}) async {
+    return PerfStats(
+      enabled: true,
+      phases: {'fileOpen': PhaseStats(count: 2, totalNanos: 3000)},
+      priorities: {
+        RequestPriority.interactive: PhaseStats(count: 1, p99Nanos: 5000),
+      },
+      trace: includeTrace ? '{"traceEvents":[]}' : null,
+    );
+  }
+
+  @override
+  Future<void> resetPerfStats() async {
+    perfResets++;
+  }
 }
 
 void main() {
@@ -53,5 +217,183 @@ void main() {
     expect(metadata.legalCopyright, '© 2025 Mock Company');
     expect(metadata.originalFilename, 'mock.exe');
     expect(metadata.companyName, 'Mock Company');
+    expect(metadata.customFields, isEmpty);
+  });
+
+  test('getBinaryFileMetadata with custom keys', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    final metadata = await flutterBinPlugin
+        .getBinaryFileMetadata('test.exe', customKeys: ['FileVersion']);
+
+    expect(metadata.customFields, {'FileVersion': 'Mock FileVersion'});
+  });
+
+  test('getBinaryFileMetadata with hashes', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    final metadata = await flutterBinPlugin
+        .getBinaryFileMetadata('test.exe', hashes: [HashAlgorithm.blake3]);
+
+    expect(metadata.hashes, {'blake3': 'mock-blake3'});
+  });
+
+  test('getBinaryFileMetadata with fields', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    final metadata = await flutterBinPlugin.getBinaryFileMetadata('test.exe',
+        fields: {MetadataField.version, MetadataField.companyName});
+
+    expect(metadata.version, '1.2.3.4');
+    expect(metadata.companyName, 'Mock Company');
+    expect(metadata.productName, isNull);
+  });
+
+  test('getBinaryFileMetadataBatch', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    final results =
+        await flutterBinPlugin.getBinaryFileMetadataBatch(['a.exe', 'b.exe']);
+
+    expect(results.map((m) => m.originalFilename), ['a.exe', 'b.exe']);
+  });
+
+  test('getBinaryDependencies', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    final results = await flutterBinPlugin.getBinaryDependencies(['a.dll']);
+
+    expect(results.single.exportName, 'a.dll');
+    expect(results.single.imports.single.functions, ['Sleep']);
+  });
+
+  test('CancelToken cancels through the platform', () async {
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    final token = CancelToken();
+    expect(token.isCancelled, isFalse);
+    expect(await token.cancel(), isTrue);
+    expect(token.isCancelled, isTrue);
+    expect(fakePlatform.cancelledRequests, [token.id]);
+    expect(CancelToken().id, isNot(token.id));
+  });
+
+  test('configure', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    await flutterBinPlugin.configure(asyncExecution: false);
+
+    expect(fakePlatform.asyncExecution, isFalse);
+  });
+
+  test('cache controls', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    await flutterBinPlugin.configure(
+        cacheBudgetBytes: 0, indexPath: '/data/flutter_bin');
+    await flutterBinPlugin.clearCache();
+    final stats = await flutterBinPlugin.getCacheStats();
+
+    expect(fakePlatform.cacheBudgetBytes, 0);
+    expect(fakePlatform.indexPath, '/data/flutter_bin');
+    expect(fakePlatform.cacheClears, 1);
+    expect(stats.hits, 3);
+    expect(stats.misses, 1);
+  });
+
+  test('I/O budget', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    await flutterBinPlugin.configure(
+        ioByteBudget: 64 * 1024, ioDeadline: const Duration(seconds: 2));
+
+    expect(fakePlatform.ioByteBudget, 64 * 1024);
+    expect(fakePlatform.ioDeadline, const Duration(seconds: 2));
+  });
+
+  test('perf stats', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    await flutterBinPlugin.configure(perfStats: true, perfTrace: true);
+    final stats = await flutterBinPlugin.getPerfStats(includeTrace: true);
+    await flutterBinPlugin.resetPerfStats();
+
+    expect(fakePlatform.perfStats, isTrue);
+    expect(fakePlatform.perfTrace, isTrue);
+    expect(stats['fileOpen'].count, 2);
+    expect(stats['fileOpen'].mean, const Duration(microseconds: 1));
+    expect(stats['encode'].count, 0);
+    expect(stats.trace, isNotNull);
+    expect(fakePlatform.perfResets, 1);
+  });
+
+  test('request priorities', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    await flutterBinPlugin.configure(
+        concurrencyLimits: {RequestPriority.bulk: 1},
+        priorityAging: const Duration(milliseconds: 250));
+    await flutterBinPlugin.getBinaryFileVersion('a.exe');
+    await flutterBinPlugin.getBinaryFileMetadataBatch(['a.exe'],
+        priority: RequestPriority.interactive);
+    await flutterBinPlugin.getBinaryDependencies(['a.dll'],
+        priority: RequestPriority.normal);
+    final stats = await flutterBinPlugin.getPerfStats();
+
+    expect(fakePlatform.concurrencyLimits, {RequestPriority.bulk: 1});
+    expect(fakePlatform.priorityAging, const Duration(milliseconds: 250));
+    expect(fakePlatform.priorities,
+        [null, RequestPriority.interactive, RequestPriority.normal]);
+    expect(stats.priorities[RequestPriority.interactive]!.p99,
+        const Duration(microseconds: 5));
+    expect(stats.priorities.containsKey(RequestPriority.bulk), isFalse);
+  });
+
+  test('scanDirectory', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    final results =
+        await flutterBinPlugin.scanDirectory('/apps').expand((b) => b).toList();
+
+    expect(results.map((r) => r.path), ['/apps/a.exe', '/apps/b.so']);
+    expect(results.map((r) => r.format), ['pe', 'elf']);
+    expect(results.first.metadata.version, '1.0.0.0');
+  });
+
+  test('watch', () async {
+    FlutterBin flutterBinPlugin = FlutterBin();
+    MockFlutterBinPlatform fakePlatform = MockFlutterBinPlatform();
+    FlutterBinPlatform.instance = fakePlatform;
+
+    final changes =
+        await flutterBinPlugin.watch(['/apps']).expand((b) => b).toList();
+
+    expect(changes.map((c) => c.change),
+        [WatchChange.modified, WatchChange.removed]);
+    expect(changes.first.metadata!.version, '2.0.0.0');
+    expect(changes.last.metadata, isNull);
   });
 }
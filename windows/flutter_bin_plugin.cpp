@@ -6,19 +6,243 @@
 // For version info
 #include <winver.h>
 
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "binary_metadata.h"
+#include "columnar_batch.h"
+#include "content_hash.h"
+#include "perf_stats.h"
+#include "string_pool.h"
+#include "unicode.h"
+#include "win32_dispatcher.h"
 
 // Need to link with Version.lib
 #pragma comment(lib, "Version.lib")
 
 namespace flutter_bin {
 
+namespace {
+
+// Turns extensions as Dart passes them (".EXE") into the form the core
+// matches ("exe").
+void NormalizeExtensions(std::vector<std::string>* extensions) {
+  for (std::string& extension : *extensions) {
+    if (!extension.empty() && extension[0] == '.') {
+      extension.erase(0, 1);
+    }
+    for (char& c : extension) {
+      if (c >= 'A' && c <= 'Z') {
+        c = static_cast<char>(c - 'A' + 'a');
+      }
+    }
+  }
+}
+
+// Reads an optional list of strings argument. Returns false if |key| is
+// present but is not a list of strings.
+bool GetStringListArgument(const flutter::EncodableMap& arguments,
+                           const char* key, std::vector<std::string>* out) {
+  auto it = arguments.find(flutter::EncodableValue(key));
+  if (it == arguments.end() || it->second.IsNull()) {
+    return true;
+  }
+  const auto* list = std::get_if<flutter::EncodableList>(&it->second);
+  if (!list) {
+    return false;
+  }
+  for (const auto& item : *list) {
+    const auto* item_string = std::get_if<std::string>(&item);
+    if (!item_string) {
+      return false;
+    }
+    out->push_back(*item_string);
+  }
+  return true;
+}
+
+// Reads the optional integer |key|. Dart ints arrive as 32 or 64-bit values.
+int64_t GetIntArgument(const flutter::EncodableMap& arguments, const char* key,
+                       int64_t default_value) {
+  auto it = arguments.find(flutter::EncodableValue(key));
+  if (it == arguments.end()) {
+    return default_value;
+  }
+  if (const auto* value = std::get_if<int32_t>(&it->second)) {
+    return *value;
+  }
+  if (const auto* value = std::get_if<int64_t>(&it->second)) {
+    return *value;
+  }
+  return default_value;
+}
+
+// Reads the optional "priority" argument, one of the RequestPriorityName()s,
+// into |priority|, which keeps its value if the argument is absent. Returns
+// false if it is present but not a known class.
+bool GetPriorityArgument(const flutter::EncodableMap& arguments,
+                         RequestPriority* priority) {
+  auto it = arguments.find(flutter::EncodableValue("priority"));
+  if (it == arguments.end() || it->second.IsNull()) {
+    return true;
+  }
+  const auto* name = std::get_if<std::string>(&it->second);
+  return name && ParseRequestPriority(*name, priority);
+}
+
+// Reads the optional bool |key|.
+bool GetBoolArgument(const flutter::EncodableMap& arguments, const char* key,
+                     bool default_value) {
+  auto it = arguments.find(flutter::EncodableValue(key));
+  if (it == arguments.end()) {
+    return default_value;
+  }
+  const auto* value = std::get_if<bool>(&it->second);
+  return value ? *value : default_value;
+}
+
+// Builds the request of a getBinaryFileMetadata call: the fields in the
+// optional "fieldMask" argument (the standard ones by default), so fields
+// Dart did not ask for are never decoded, plus |custom_keys|, |hashes| and
+// the signer if "signature" is set. Returns false for an invalid mask.
+bool GetMetadataRequest(const flutter::EncodableMap& arguments,
+                        const std::vector<std::string>& custom_keys,
+                        const std::vector<HashAlgorithm>& hashes,
+                        MetadataRequest* request) {
+  int64_t mask = GetIntArgument(arguments, "fieldMask", kStandardFieldMask);
+  if (mask < 0 || mask > kAllFieldsMask ||
+      !MetadataRequest::FromMask(static_cast<uint32_t>(mask), custom_keys,
+                                 request)) {
+    return false;
+  }
+  for (HashAlgorithm hash : hashes) {
+    if (std::find(request->hashes.begin(), request->hashes.end(), hash) ==
+        request->hashes.end()) {
+      request->hashes.push_back(hash);
+    }
+  }
+  request->signature = request->signature ||
+                       GetBoolArgument(arguments, "signature", false);
+  return true;
+}
+
+flutter::EncodableMap ToEncodableMap(const MetadataCacheStats& stats) {
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("hits"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.hits))},
+      {flutter::EncodableValue("misses"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.misses))},
+      {flutter::EncodableValue("evictions"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.evictions))},
+      {flutter::EncodableValue("indexHits"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.index_hits))},
+      {flutter::EncodableValue("entries"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.entries))},
+      {flutter::EncodableValue("bytes"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.bytes))},
+      {flutter::EncodableValue("budgetBytes"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.budget))},
+  };
+}
+
+flutter::EncodableMap ToEncodableMap(const PhaseStats& stats) {
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("count"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.count))},
+      {flutter::EncodableValue("totalNanos"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.total_ns))},
+      {flutter::EncodableValue("p50Nanos"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.p50_ns))},
+      {flutter::EncodableValue("p90Nanos"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.p90_ns))},
+      {flutter::EncodableValue("p99Nanos"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.p99_ns))},
+      {flutter::EncodableValue("maxNanos"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.max_ns))},
+  };
+}
+
+// Phases with no samples are left out.
+flutter::EncodableMap ToEncodableMap(const PerfSnapshot& snapshot) {
+  flutter::EncodableMap phases;
+  for (size_t i = 0; i < kPerfPhaseCount; ++i) {
+    const PhaseStats& stats = snapshot.phases[i];
+    if (stats.count == 0) {
+      continue;
+    }
+    phases[flutter::EncodableValue(PerfPhaseName(static_cast<PerfPhase>(i)))] =
+        flutter::EncodableValue(ToEncodableMap(stats));
+  }
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("enabled"), flutter::EncodableValue(snapshot.enabled)},
+      {flutter::EncodableValue("phases"), flutter::EncodableValue(std::move(phases))},
+  };
+}
+
+// Convert std::map to flutter::EncodableMap
+flutter::EncodableMap ToEncodableMap(const BinaryMetadata& metadata) {
+  flutter::EncodableMap result_map;
+  for (const auto& pair : metadata.fields) {
+    result_map[flutter::EncodableValue(pair.first)] = flutter::EncodableValue(pair.second);
+  }
+  if (metadata.bytes_read != 0) {
+    result_map[flutter::EncodableValue("bytesRead")] =
+        flutter::EncodableValue(static_cast<int64_t>(metadata.bytes_read));
+  }
+  return result_map;
+}
+
+// Encodes a dependency batch: every interned name once, then each file's
+// imports and exports as Int32Lists of ids into |names|.
+flutter::EncodableMap ToEncodableMap(const StringPool& pool,
+                                     std::vector<FlatDependencies> batch) {
+  flutter::EncodableList names;
+  names.reserve(pool.size());
+  for (size_t id = 0; id < pool.size(); ++id) {
+    names.push_back(flutter::EncodableValue(
+        std::string(pool.Get(static_cast<uint32_t>(id)))));
+  }
+  flutter::EncodableList files;
+  files.reserve(batch.size());
+  for (FlatDependencies& entry : batch) {
+    flutter::EncodableMap file{
+        {flutter::EncodableValue("imports"),
+         flutter::EncodableValue(std::move(entry.imports))},
+        {flutter::EncodableValue("delayImports"),
+         flutter::EncodableValue(std::move(entry.delay_imports))},
+        {flutter::EncodableValue("exports"),
+         flutter::EncodableValue(std::move(entry.exports))},
+    };
+    if (entry.export_name != StringPool::kNoString) {
+      file[flutter::EncodableValue("exportName")] =
+          flutter::EncodableValue(static_cast<int32_t>(entry.export_name));
+    }
+    if (entry.error != MetadataError::kNone) {
+      file[flutter::EncodableValue("error")] =
+          flutter::EncodableValue(MetadataErrorCode(entry.error));
+    }
+    files.push_back(flutter::EncodableValue(std::move(file)));
+  }
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("names"), flutter::EncodableValue(std::move(names))},
+      {flutter::EncodableValue("files"), flutter::EncodableValue(std::move(files))},
+  };
+}
+
+}  // namespace
+
 // static
 void FlutterBinPlugin::RegisterWithRegistrar(
     flutter::PluginRegistrarWindows *registrar) {
@@ -27,190 +251,857 @@ void FlutterBinPlugin::RegisterWithRegistrar(
           registrar->messenger(), "flutter_bin",
           &flutter::StandardMethodCodec::GetInstance());
 
-  auto plugin = std::make_unique<FlutterBinPlugin>();
+  auto scan_channel =
+      std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+          registrar->messenger(), "flutter_bin/scan",
+          &flutter::StandardMethodCodec::GetInstance());
+
+  auto watch_channel =
+      std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+          registrar->messenger(), "flutter_bin/watch",
+          &flutter::StandardMethodCodec::GetInstance());
+
+  auto plugin =
+      std::make_unique<FlutterBinPlugin>(std::make_unique<Win32Dispatcher>());
 
   channel->SetMethodCallHandler(
       [plugin_pointer = plugin.get()](const auto &call, auto result) {
         plugin_pointer->HandleMethodCall(call, std::move(result));
       });
 
+  scan_channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [plugin_pointer = plugin.get()](const flutter::EncodableValue*,
+                                          std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->SetScanEventSink(std::move(events));
+            return nullptr;
+          },
+          [plugin_pointer = plugin.get()](const flutter::EncodableValue*)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->SetScanEventSink(nullptr);
+            return nullptr;
+          }));
+
+  watch_channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [plugin_pointer = plugin.get()](const flutter::EncodableValue*,
+                                          std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->SetWatchEventSink(std::move(events));
+            return nullptr;
+          },
+          [plugin_pointer = plugin.get()](const flutter::EncodableValue*)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            plugin_pointer->SetWatchEventSink(nullptr);
+            return nullptr;
+          }));
+
   registrar->AddPlugin(std::move(plugin));
 }
 
 FlutterBinPlugin::FlutterBinPlugin() {}
 
+FlutterBinPlugin::FlutterBinPlugin(std::unique_ptr<Dispatcher> dispatcher)
+    : dispatcher_(std::move(dispatcher)), async_execution_(true) {}
+
 FlutterBinPlugin::~FlutterBinPlugin() {}
 
 void FlutterBinPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  
+
+  // A single file is usually what the user is looking at; lists of files are
+  // background work unless the caller says otherwise.
+  bool single_file =
+      method_call.method_name().compare("getBinaryFileVersion") == 0 ||
+      method_call.method_name().compare("getBinaryFileMetadata") == 0;
+  RequestPriority priority =
+      single_file ? RequestPriority::kInteractive : RequestPriority::kBulk;
+  const auto* call_arguments =
+      std::get_if<flutter::EncodableMap>(method_call.arguments());
+  if (call_arguments && !GetPriorityArgument(*call_arguments, &priority)) {
+    result->Error("INVALID_ARGUMENT",
+                  "Argument 'priority' must be 'interactive', 'normal' or 'bulk'");
+    return;
+  }
+
   if (method_call.method_name().compare("getBinaryFileVersion") == 0) {
     const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
-    
+
     if (arguments) {
       auto file_path_it = arguments->find(flutter::EncodableValue("filePath"));
       if (file_path_it != arguments->end()) {
-        const std::string& file_path = std::get<std::string>(file_path_it->second);
-        std::string version = GetBinaryFileVersion(file_path);
-        if (!version.empty()) {
-          result->Success(flutter::EncodableValue(version));
-        } else {
-          result->Success(nullptr);
-        }
+        std::string file_path = std::get<std::string>(file_path_it->second);
+        bool use_cache = GetBoolArgument(*arguments, "useCache", true);
+        Run(GetIntArgument(*arguments, "requestId", AsyncExecutor::kNoRequestId),
+            priority,
+            std::move(result),
+            [this, file_path, use_cache](const std::atomic<bool>&) {
+              std::string version = GetBinaryFileVersion(file_path, use_cache);
+              return version.empty() ? flutter::EncodableValue()
+                                     : flutter::EncodableValue(version);
+            });
       } else {
         result->Error("INVALID_ARGUMENT", "Argument 'filePath' not found");
       }
     } else {
       result->Error("INVALID_ARGUMENT", "Arguments must be a map");
     }
-  } 
+  }
   else if (method_call.method_name().compare("getBinaryFileMetadata") == 0) {
     const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
-    
+
     if (arguments) {
       auto file_path_it = arguments->find(flutter::EncodableValue("filePath"));
-      if (file_path_it != arguments->end()) {
-        const std::string& file_path = std::get<std::string>(file_path_it->second);
-        std::map<std::string, std::string> metadata_map = GetBinaryFileMetadata(file_path);
-        
-        // Convert std::map to flutter::EncodableMap
-        flutter::EncodableMap result_map;
-        for (const auto& pair : metadata_map) {
-          result_map[flutter::EncodableValue(pair.first)] = flutter::EncodableValue(pair.second);
+      std::vector<std::string> custom_keys;
+      std::vector<std::string> hash_names;
+      std::vector<HashAlgorithm> hashes;
+      MetadataRequest request;
+      if (file_path_it == arguments->end()) {
+        result->Error("INVALID_ARGUMENT", "Argument 'filePath' not found");
+      } else if (!GetStringListArgument(*arguments, "customKeys", &custom_keys)) {
+        result->Error("INVALID_ARGUMENT", "Argument 'customKeys' must be a list of strings");
+      } else if (!GetStringListArgument(*arguments, "hashes", &hash_names) ||
+                 !ParseHashAlgorithms(hash_names, &hashes)) {
+        result->Error("INVALID_ARGUMENT", "Argument 'hashes' must be a list of hash algorithm names");
+      } else if (!GetMetadataRequest(*arguments, custom_keys, hashes, &request)) {
+        result->Error("INVALID_ARGUMENT", "Argument 'fieldMask' must be a combination of metadata field bits");
+      } else {
+        std::string file_path = std::get<std::string>(file_path_it->second);
+        bool use_cache = GetBoolArgument(*arguments, "useCache", true);
+        Run(GetIntArgument(*arguments, "requestId", AsyncExecutor::kNoRequestId),
+            priority,
+            std::move(result),
+            [this, file_path, request, use_cache](const std::atomic<bool>&) {
+              BinaryMetadata metadata =
+                  GetBinaryFileMetadata(file_path, request, use_cache);
+              ScopedPhaseTimer timer(PerfPhase::kEncode);
+              return flutter::EncodableValue(ToEncodableMap(metadata));
+            });
+      }
+    } else {
+      result->Error("INVALID_ARGUMENT", "Arguments must be a map");
+    }
+  }
+  else if (method_call.method_name().compare("getBinaryFileMetadataBatch") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+
+    if (arguments) {
+      std::vector<std::string> paths;
+      std::vector<std::string> fields;
+      if (arguments->find(flutter::EncodableValue("paths")) == arguments->end() ||
+          !GetStringListArgument(*arguments, "paths", &paths)) {
+        result->Error("INVALID_ARGUMENT", "Argument 'paths' must be a list of strings");
+      } else if (!GetStringListArgument(*arguments, "fields", &fields)) {
+        result->Error("INVALID_ARGUMENT", "Argument 'fields' must be a list of strings");
+      } else {
+        MetadataRequest request = fields.empty()
+                                      ? MetadataRequest::Standard()
+                                      : MetadataRequest::Only(fields);
+        bool use_cache = GetBoolArgument(*arguments, "useCache", true);
+        bool columnar = GetBoolArgument(*arguments, "columnar", false);
+        Run(GetIntArgument(*arguments, "requestId", AsyncExecutor::kNoRequestId),
+            priority,
+            std::move(result),
+            [this, paths, request, use_cache, columnar](const std::atomic<bool>& cancelled) {
+              std::vector<BinaryMetadata> batch = GetBinaryFileMetadataBatch(
+                  paths, request, use_cache, cancelled);
+              ScopedPhaseTimer timer(PerfPhase::kEncode);
+              if (columnar) {
+                // One Uint8List with a shared string table; see columnar_batch.h.
+                return flutter::EncodableValue(EncodeColumnarBatch(batch));
+              }
+
+              // Results keep the order of |paths|; failures carry an error code.
+              flutter::EncodableList result_list;
+              result_list.reserve(batch.size());
+              for (const BinaryMetadata& metadata : batch) {
+                flutter::EncodableMap entry = ToEncodableMap(metadata);
+                if (metadata.error != MetadataError::kNone) {
+                  entry[flutter::EncodableValue("error")] =
+                      flutter::EncodableValue(MetadataErrorCode(metadata.error));
+                }
+                result_list.push_back(flutter::EncodableValue(std::move(entry)));
+              }
+              return flutter::EncodableValue(std::move(result_list));
+            });
+      }
+    } else {
+      result->Error("INVALID_ARGUMENT", "Arguments must be a map");
+    }
+  }
+  else if (method_call.method_name().compare("getBinaryDependencies") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+
+    std::vector<std::string> paths;
+    if (!arguments ||
+        arguments->find(flutter::EncodableValue("paths")) == arguments->end() ||
+        !GetStringListArgument(*arguments, "paths", &paths)) {
+      result->Error("INVALID_ARGUMENT", "Argument 'paths' must be a list of strings");
+    } else {
+      Run(GetIntArgument(*arguments, "requestId", AsyncExecutor::kNoRequestId),
+          priority,
+          std::move(result),
+          [this, paths](const std::atomic<bool>& cancelled) {
+            // One pool for the whole call, so each distinct name crosses
+            // the channel once however many files refer to it.
+            StringPool pool;
+            std::vector<FlatDependencies> batch(paths.size());
+            thread_pool()->ParallelFor(paths.size(), [&](size_t i) {
+              if (!cancelled.load(std::memory_order_relaxed)) {
+                batch[i] = ReadFlatDependencies(paths[i], &pool);
+              }
+            });
+            ScopedPhaseTimer timer(PerfPhase::kEncode);
+            return flutter::EncodableValue(ToEncodableMap(pool, std::move(batch)));
+          });
+    }
+  }
+  else if (method_call.method_name().compare("cancelRequest") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    int64_t request_id = arguments ? GetIntArgument(*arguments, "requestId",
+                                                    AsyncExecutor::kNoRequestId)
+                                   : AsyncExecutor::kNoRequestId;
+    bool cancelled = executor_ && executor_->Cancel(request_id);
+    result->Success(flutter::EncodableValue(cancelled));
+  }
+  else if (method_call.method_name().compare("configure") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+
+    if (arguments) {
+      auto async_it = arguments->find(flutter::EncodableValue("asyncExecution"));
+      if (async_it != arguments->end()) {
+        const auto* async_execution = std::get_if<bool>(&async_it->second);
+        if (!async_execution) {
+          result->Error("INVALID_ARGUMENT", "Argument 'asyncExecution' must be a bool");
+          return;
         }
-        
-        result->Success(flutter::EncodableValue(result_map));
+        // Without a dispatcher there is no way back to the platform thread.
+        async_execution_ = *async_execution && dispatcher_ != nullptr;
+      }
+      auto budget_it = arguments->find(flutter::EncodableValue("cacheBudgetBytes"));
+      if (budget_it != arguments->end()) {
+        int64_t budget = GetIntArgument(*arguments, "cacheBudgetBytes", -1);
+        if (budget < 0) {
+          result->Error("INVALID_ARGUMENT",
+                        "Argument 'cacheBudgetBytes' must be a non-negative int");
+          return;
+        }
+        metadata_cache_.SetBudget(static_cast<size_t>(budget));
+      }
+      auto io_budget_it = arguments->find(flutter::EncodableValue("ioByteBudget"));
+      if (io_budget_it != arguments->end()) {
+        int64_t io_budget = GetIntArgument(*arguments, "ioByteBudget", -1);
+        if (io_budget < 0) {
+          result->Error("INVALID_ARGUMENT",
+                        "Argument 'ioByteBudget' must be a non-negative int");
+          return;
+        }
+        io_byte_budget_ = static_cast<uint64_t>(io_budget);
+      }
+      auto io_deadline_it = arguments->find(flutter::EncodableValue("ioDeadlineMs"));
+      if (io_deadline_it != arguments->end()) {
+        int64_t io_deadline = GetIntArgument(*arguments, "ioDeadlineMs", -1);
+        if (io_deadline < 0) {
+          result->Error("INVALID_ARGUMENT",
+                        "Argument 'ioDeadlineMs' must be a non-negative int");
+          return;
+        }
+        io_deadline_ms_ = io_deadline;
+      }
+      // Swapped in last, once every other argument has been applied.
+      const std::string* index_path = nullptr;
+      auto index_it = arguments->find(flutter::EncodableValue("indexPath"));
+      if (index_it != arguments->end()) {
+        index_path = std::get_if<std::string>(&index_it->second);
+        if (!index_path) {
+          result->Error("INVALID_ARGUMENT", "Argument 'indexPath' must be a string");
+          return;
+        }
+      }
+      for (size_t i = 0; i < kRequestPriorityCount; ++i) {
+        auto request_priority = static_cast<RequestPriority>(i);
+        std::string key =
+            std::string(RequestPriorityName(request_priority)) + "Concurrency";
+        if (arguments->find(flutter::EncodableValue(key)) == arguments->end()) {
+          continue;
+        }
+        int64_t limit = GetIntArgument(*arguments, key.c_str(), -1);
+        if (limit < 0) {
+          result->Error("INVALID_ARGUMENT",
+                        "Argument '" + key + "' must be a non-negative int");
+          return;
+        }
+        // Requests only queue when they run asynchronously.
+        if (dispatcher_) {
+          executor()->SetConcurrencyLimit(request_priority,
+                                          static_cast<size_t>(limit));
+        }
+      }
+      auto aging_it = arguments->find(flutter::EncodableValue("priorityAgingMs"));
+      if (aging_it != arguments->end()) {
+        int64_t aging_ms = GetIntArgument(*arguments, "priorityAgingMs", -1);
+        if (aging_ms < 0) {
+          result->Error("INVALID_ARGUMENT",
+                        "Argument 'priorityAgingMs' must be a non-negative int");
+          return;
+        }
+        if (dispatcher_) {
+          executor()->SetAgingInterval(std::chrono::milliseconds(aging_ms));
+        }
+      }
+      auto perf_stats_it = arguments->find(flutter::EncodableValue("perfStats"));
+      if (perf_stats_it != arguments->end()) {
+        const auto* perf_stats = std::get_if<bool>(&perf_stats_it->second);
+        if (!perf_stats) {
+          result->Error("INVALID_ARGUMENT", "Argument 'perfStats' must be a bool");
+          return;
+        }
+        SetPerfStatsEnabled(*perf_stats);
+      }
+      auto perf_trace_it = arguments->find(flutter::EncodableValue("perfTrace"));
+      if (perf_trace_it != arguments->end()) {
+        const auto* perf_trace = std::get_if<bool>(&perf_trace_it->second);
+        if (!perf_trace) {
+          result->Error("INVALID_ARGUMENT", "Argument 'perfTrace' must be a bool");
+          return;
+        }
+        SetPerfTraceEnabled(*perf_trace);
+      }
+      if (index_path) {
+        ReplaceIndex(*index_path, std::move(result));
+        return;
+      }
+      result->Success(flutter::EncodableValue(async_execution_));
+    } else {
+      result->Error("INVALID_ARGUMENT", "Arguments must be a map");
+    }
+  }
+  else if (method_call.method_name().compare("scanDirectory") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+
+    if (arguments) {
+      StartScan(*arguments, std::move(result));
+    } else {
+      result->Error("INVALID_ARGUMENT", "Arguments must be a map");
+    }
+  }
+  else if (method_call.method_name().compare("acknowledgeScanBatch") == 0 ||
+           method_call.method_name().compare("cancelScan") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    int64_t scan_id = arguments ? GetIntArgument(*arguments, "scanId", 0) : 0;
+    auto scan_it = scans_.find(scan_id);
+    if (scan_it != scans_.end()) {
+      if (method_call.method_name().compare("cancelScan") == 0) {
+        scan_it->second->Cancel();
       } else {
-        result->Error("INVALID_ARGUMENT", "Argument 'filePath' not found");
+        scan_it->second->Acknowledge();
       }
+    }
+    result->Success(flutter::EncodableValue(scan_it != scans_.end()));
+  }
+  else if (method_call.method_name().compare("watch") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+
+    if (arguments) {
+      StartWatch(*arguments, std::move(result));
     } else {
       result->Error("INVALID_ARGUMENT", "Arguments must be a map");
     }
   }
+  else if (method_call.method_name().compare("unwatch") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    int64_t watch_id = arguments ? GetIntArgument(*arguments, "watchId", 0) : 0;
+    auto watch_it = watches_.find(watch_id);
+    bool found = watch_it != watches_.end();
+    if (found) {
+      StopWatch(std::move(watch_it->second));
+      watches_.erase(watch_it);
+    }
+    result->Success(flutter::EncodableValue(found));
+  }
+  else if (method_call.method_name().compare("clearCache") == 0) {
+    metadata_cache_.Clear();
+    result->Success();
+  }
+  else if (method_call.method_name().compare("getCacheStats") == 0) {
+    result->Success(flutter::EncodableValue(ToEncodableMap(metadata_cache_.stats())));
+  }
+  else if (method_call.method_name().compare("getPerfStats") == 0) {
+    const auto* arguments = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    flutter::EncodableMap stats = ToEncodableMap(ReadPerfStats());
+    if (executor_) {
+      flutter::EncodableMap priorities;
+      for (size_t i = 0; i < kRequestPriorityCount; ++i) {
+        auto request_priority = static_cast<RequestPriority>(i);
+        PhaseStats latency = executor_->latency(request_priority);
+        if (latency.count != 0) {
+          priorities[flutter::EncodableValue(
+              RequestPriorityName(request_priority))] =
+              flutter::EncodableValue(ToEncodableMap(latency));
+        }
+      }
+      stats[flutter::EncodableValue("priorities")] =
+          flutter::EncodableValue(std::move(priorities));
+    }
+    if (arguments && GetBoolArgument(*arguments, "trace", false)) {
+      stats[flutter::EncodableValue("trace")] =
+          flutter::EncodableValue(PerfTraceJson());
+    }
+    result->Success(flutter::EncodableValue(std::move(stats)));
+  }
+  else if (method_call.method_name().compare("resetPerfStats") == 0) {
+    ResetPerfStats();
+    if (executor_) {
+      executor_->ResetLatency();
+    }
+    result->Success();
+  }
   else {
     result->NotImplemented();
   }
 }
 
-std::string FlutterBinPlugin::GetBinaryFileVersion(const std::string& file_path) {
-  // Convert from UTF-8 to wide string
-  int size_needed = MultiByteToWideChar(CP_UTF8, 0, file_path.c_str(), -1, NULL, 0);
-  std::wstring wide_path(size_needed, 0);
-  MultiByteToWideChar(CP_UTF8, 0, file_path.c_str(), -1, &wide_path[0], size_needed);
+AsyncExecutor* FlutterBinPlugin::executor() {
+  if (!executor_) {
+    executor_ = std::make_unique<AsyncExecutor>(thread_pool(), dispatcher_.get());
+  }
+  return executor_.get();
+}
 
-  // Check if file exists
-  DWORD file_attributes = GetFileAttributesW(wide_path.c_str());
-  if (file_attributes == INVALID_FILE_ATTRIBUTES) {
-    // File doesn't exist or is inaccessible
-    return "";
+void FlutterBinPlugin::Run(
+    int64_t request_id, RequestPriority priority,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+    Work work) {
+  if (!async_execution_) {
+    std::atomic<bool> never_cancelled{false};
+    flutter::EncodableValue value;
+    {
+      ScopedPhaseTimer timer(PerfPhase::kMethodCall);
+      value = work(never_cancelled);
+    }
+    result->Success(value);
+    return;
   }
+  // MethodResult is only touched on the platform thread, from one of the
+  // completion callbacks below.
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  auto value = std::make_shared<flutter::EncodableValue>();
+  AsyncRequest request;
+  request.work = [work = std::move(work), value](
+                     const std::atomic<bool>& cancelled) {
+    ScopedPhaseTimer timer(PerfPhase::kMethodCall);
+    *value = work(cancelled);
+  };
+  request.complete = [shared_result, value] {
+    shared_result->Success(std::move(*value));
+  };
+  request.cancelled = [shared_result] {
+    shared_result->Error("CANCELLED", "The request was cancelled");
+  };
+  request.priority = priority;
+  executor()->Submit(request_id, std::move(request));
+}
 
-  // Get the size of the version info
-  DWORD dummy;
-  DWORD version_info_size = GetFileVersionInfoSizeW(wide_path.c_str(), &dummy);
-  if (version_info_size == 0) {
-    // Could not get version info size
-    return "";
+void FlutterBinPlugin::ReplaceIndex(
+    const std::string& index_path,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  auto opened = std::make_shared<bool>(false);
+  auto open = [this, index_path, opened] {
+    std::shared_ptr<MetadataIndex> index;
+    if (!index_path.empty()) {
+      index = std::make_shared<MetadataIndex>();
+      if (!index->Open(index_path, thread_pool())) {
+        return;
+      }
+    }
+    // Work still holding the previous index keeps it open until it ends;
+    // otherwise it is closed here.
+    metadata_cache_.SetIndex(std::move(index));
+    *opened = true;
+  };
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  auto respond = [this, index_path, opened, shared_result] {
+    if (*opened) {
+      shared_result->Success(flutter::EncodableValue(async_execution_));
+    } else {
+      shared_result->Error("INDEX_OPEN_FAILED",
+                           "Could not open the metadata index at '" + index_path + "'");
+    }
+  };
+  if (!async_execution_) {
+    open();
+    respond();
+    return;
   }
+  AsyncRequest request;
+  request.work = [open](const std::atomic<bool>&) { open(); };
+  request.complete = respond;
+  request.cancelled = [shared_result] {
+    shared_result->Error("CANCELLED", "The request was cancelled");
+  };
+  request.priority = RequestPriority::kInteractive;
+  executor()->Submit(AsyncExecutor::kNoRequestId, std::move(request));
+}
 
-  // Allocate memory for the version info
-  std::vector<BYTE> version_info(version_info_size);
-  if (!GetFileVersionInfoW(wide_path.c_str(), 0, version_info_size, version_info.data())) {
-    // Could not get version info
-    return "";
+void FlutterBinPlugin::SetScanEventSink(
+    std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> events) {
+  scan_events_ = std::move(events);
+  if (!scan_events_) {
+    // Nobody is left to acknowledge batches.
+    for (auto& scan : scans_) {
+      scan.second->Cancel();
+    }
   }
+}
 
-  // Get the fixed file info
-  VS_FIXEDFILEINFO* fixed_file_info = nullptr;
-  UINT len = 0;
-  if (!VerQueryValueW(version_info.data(), L"\\", (LPVOID*)&fixed_file_info, &len)) {
-    // Could not get fixed file info
-    return "";
+void FlutterBinPlugin::StartScan(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  auto root_it = arguments.find(flutter::EncodableValue("root"));
+  const auto* root = root_it != arguments.end()
+                         ? std::get_if<std::string>(&root_it->second)
+                         : nullptr;
+  int64_t scan_id = GetIntArgument(arguments, "scanId", 0);
+  ScanOptions options;
+  std::vector<std::string> fields;
+  if (!root) {
+    result->Error("INVALID_ARGUMENT", "Argument 'root' must be a string");
+    return;
+  }
+  if (scan_id <= 0 || scans_.count(scan_id) != 0) {
+    result->Error("INVALID_ARGUMENT", "Argument 'scanId' must be a new positive int");
+    return;
+  }
+  if (!GetStringListArgument(arguments, "extensions", &options.extensions) ||
+      !GetStringListArgument(arguments, "fields", &fields)) {
+    result->Error("INVALID_ARGUMENT",
+                  "Arguments 'extensions' and 'fields' must be lists of strings");
+    return;
+  }
+  // Batches are delivered through the dispatcher; there is no synchronous
+  // equivalent.
+  if (!async_execution_) {
+    result->Error("UNAVAILABLE", "Directory scans need asynchronous execution");
+    return;
   }
 
-  // Extract the version
-  DWORD major = HIWORD(fixed_file_info->dwFileVersionMS);
-  DWORD minor = LOWORD(fixed_file_info->dwFileVersionMS);
-  DWORD build = HIWORD(fixed_file_info->dwFileVersionLS);
-  DWORD revision = LOWORD(fixed_file_info->dwFileVersionLS);
+  NormalizeExtensions(&options.extensions);
+  options.max_depth = static_cast<int>(GetIntArgument(arguments, "maxDepth", -1));
+  options.follow_links = GetBoolArgument(arguments, "followLinks", false);
+  MetadataRequest request =
+      fields.empty() ? MetadataRequest::Standard() : MetadataRequest::Only(fields);
+  bool use_cache = GetBoolArgument(arguments, "useCache", true);
 
-  // Format the version string
-  std::ostringstream version_stream;
-  version_stream << major << "." << minor << "." << build << "." << revision;
-  return version_stream.str();
+  auto scan = std::make_unique<DirectoryScan>(
+      thread_pool(), options,
+      [this, request, use_cache](const std::string& path, BinaryFormat) {
+        return GetBinaryFileMetadata(path, request, use_cache);
+      },
+      [this, scan_id](std::vector<ScanEntry> batch, const ScanSummary* summary) {
+        auto shared_batch = std::make_shared<std::vector<ScanEntry>>(std::move(batch));
+        std::shared_ptr<ScanSummary> shared_summary;
+        if (summary) {
+          shared_summary = std::make_shared<ScanSummary>(*summary);
+        }
+        dispatcher_->Post([this, scan_id, shared_batch, shared_summary] {
+          SendScanBatch(scan_id, *shared_batch, shared_summary.get());
+        });
+      });
+  DirectoryScan* scan_pointer = scan.get();
+  scans_[scan_id] = std::move(scan);
+  scan_pointer->Start(*root);
+  result->Success();
 }
 
-// Helper function to convert Wide String to UTF-8
-std::string WideStringToUtf8(const wchar_t* wide_str, int length = -1) {
+void FlutterBinPlugin::SendScanBatch(int64_t scan_id,
+                                     const std::vector<ScanEntry>& batch,
+                                     const ScanSummary* summary) {
+  if (scan_events_) {
+    flutter::EncodableList entries;
+    entries.reserve(batch.size());
+    for (const ScanEntry& entry : batch) {
+      flutter::EncodableMap map = ToEncodableMap(entry.metadata);
+      map[flutter::EncodableValue("path")] = flutter::EncodableValue(entry.path);
+      map[flutter::EncodableValue("format")] =
+          flutter::EncodableValue(BinaryFormatName(entry.format));
+      if (entry.metadata.error != MetadataError::kNone) {
+        map[flutter::EncodableValue("error")] =
+            flutter::EncodableValue(MetadataErrorCode(entry.metadata.error));
+      }
+      entries.push_back(flutter::EncodableValue(std::move(map)));
+    }
+    flutter::EncodableMap event{
+        {flutter::EncodableValue("scanId"), flutter::EncodableValue(scan_id)},
+        {flutter::EncodableValue("entries"), flutter::EncodableValue(std::move(entries))},
+        {flutter::EncodableValue("done"), flutter::EncodableValue(summary != nullptr)},
+    };
+    if (summary) {
+      event[flutter::EncodableValue("directories")] =
+          flutter::EncodableValue(static_cast<int64_t>(summary->directories));
+      event[flutter::EncodableValue("files")] =
+          flutter::EncodableValue(static_cast<int64_t>(summary->files));
+      event[flutter::EncodableValue("binaries")] =
+          flutter::EncodableValue(static_cast<int64_t>(summary->binaries));
+      event[flutter::EncodableValue("errors")] =
+          flutter::EncodableValue(static_cast<int64_t>(summary->errors));
+      event[flutter::EncodableValue("cancelled")] =
+          flutter::EncodableValue(summary->cancelled);
+      event[flutter::EncodableValue("rootFailed")] =
+          flutter::EncodableValue(summary->root_failed);
+    }
+    scan_events_->Success(flutter::EncodableValue(std::move(event)));
+  }
+  if (summary) {
+    // The scan's last task is returning; this waits for it.
+    scans_.erase(scan_id);
+  }
+}
+
+void FlutterBinPlugin::SetWatchEventSink(
+    std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> events) {
+  watch_events_ = std::move(events);
+  if (!watch_events_) {
+    // Nobody is left to receive the changes.
+    for (auto& watch : watches_) {
+      StopWatch(std::move(watch.second));
+    }
+    watches_.clear();
+  }
+}
+
+void FlutterBinPlugin::StartWatch(
+    const flutter::EncodableMap& arguments,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  int64_t watch_id = GetIntArgument(arguments, "watchId", 0);
+  std::vector<std::string> paths;
+  WatchOptions options;
+  std::vector<std::string> fields;
+  if (watch_id <= 0 || watches_.count(watch_id) != 0) {
+    result->Error("INVALID_ARGUMENT", "Argument 'watchId' must be a new positive int");
+    return;
+  }
+  if (!GetStringListArgument(arguments, "paths", &paths) || paths.empty()) {
+    result->Error("INVALID_ARGUMENT", "Argument 'paths' must be a non-empty list of strings");
+    return;
+  }
+  if (!GetStringListArgument(arguments, "extensions", &options.extensions) ||
+      !GetStringListArgument(arguments, "fields", &fields)) {
+    result->Error("INVALID_ARGUMENT",
+                  "Arguments 'extensions' and 'fields' must be lists of strings");
+    return;
+  }
+  // Changes are delivered through the dispatcher, like scan batches.
+  if (!async_execution_) {
+    result->Error("UNAVAILABLE", "Watches need asynchronous execution");
+    return;
+  }
+
+  NormalizeExtensions(&options.extensions);
+  options.recursive = GetBoolArgument(arguments, "recursive", true);
+  int64_t settle_ms = GetIntArgument(arguments, "settleMs", -1);
+  if (settle_ms >= 0) {
+    options.settle_delay = std::chrono::milliseconds(settle_ms);
+  }
+  MetadataRequest request =
+      fields.empty() ? MetadataRequest::Standard() : MetadataRequest::Only(fields);
+  bool use_cache = GetBoolArgument(arguments, "useCache", true);
+
+  auto watcher = std::make_unique<FileWatcher>(
+      options,
+      [this, request, use_cache](const std::string& path, BinaryFormat) {
+        if (!use_cache) {
+          return LoadChangedFileMetadata(path, request);
+        }
+        return metadata_cache_.Get(
+            path, request,
+            [this](const std::string& changed_path,
+                   const MetadataRequest& path_request) {
+              return LoadChangedFileMetadata(changed_path, path_request);
+            });
+      },
+      [this, watch_id](std::vector<WatchEvent> events) {
+        auto shared_events =
+            std::make_shared<std::vector<WatchEvent>>(std::move(events));
+        dispatcher_->Post([this, watch_id, shared_events] {
+          SendWatchEvents(watch_id, *shared_events);
+        });
+      });
+  std::vector<std::string> failed;
+  if (!watcher->Start(paths, &failed)) {
+    result->Error("WATCH_FAILED", "None of the paths can be watched");
+    return;
+  }
+  watches_[watch_id] = std::move(watcher);
+
+  flutter::EncodableList failed_list;
+  for (std::string& path : failed) {
+    failed_list.push_back(flutter::EncodableValue(std::move(path)));
+  }
+  result->Success(flutter::EncodableValue(std::move(failed_list)));
+}
+
+void FlutterBinPlugin::StopWatch(std::unique_ptr<FileWatcher> watcher) {
+  watcher->Stop();
+  AsyncRequest request;
+  request.work = [watcher = std::shared_ptr<FileWatcher>(std::move(watcher))](
+                     const std::atomic<bool>&) mutable {
+    // Joins the watcher thread.
+    watcher.reset();
+  };
+  request.priority = RequestPriority::kBulk;
+  executor()->Submit(AsyncExecutor::kNoRequestId, std::move(request));
+}
+
+void FlutterBinPlugin::SendWatchEvents(int64_t watch_id,
+                                       const std::vector<WatchEvent>& events) {
+  // Changes posted before an unwatch are dropped.
+  if (!watch_events_ || watches_.count(watch_id) == 0) {
+    return;
+  }
+  flutter::EncodableList changes;
+  changes.reserve(events.size());
+  for (const WatchEvent& event : events) {
+    flutter::EncodableMap map;
+    if (event.change == WatchChange::kAdded ||
+        event.change == WatchChange::kModified) {
+      map = ToEncodableMap(event.metadata);
+      if (event.metadata.error != MetadataError::kNone) {
+        map[flutter::EncodableValue("error")] =
+            flutter::EncodableValue(MetadataErrorCode(event.metadata.error));
+      }
+    }
+    map[flutter::EncodableValue("path")] = flutter::EncodableValue(event.path);
+    map[flutter::EncodableValue("change")] =
+        flutter::EncodableValue(WatchChangeName(event.change));
+    if (event.format != BinaryFormat::kUnknown) {
+      map[flutter::EncodableValue("format")] =
+          flutter::EncodableValue(BinaryFormatName(event.format));
+    }
+    changes.push_back(flutter::EncodableValue(std::move(map)));
+  }
+  watch_events_->Success(flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("watchId"), flutter::EncodableValue(watch_id)},
+      {flutter::EncodableValue("changes"), flutter::EncodableValue(std::move(changes))},
+  }));
+}
+
+ThreadPool* FlutterBinPlugin::thread_pool() {
+  if (!thread_pool_) {
+    thread_pool_ = std::make_unique<ThreadPool>(ThreadPool::DefaultThreadCount());
+  }
+  return thread_pool_.get();
+}
+
+std::string FlutterBinPlugin::GetBinaryFileVersion(const std::string& file_path,
+                                                   bool use_cache) {
+  BinaryMetadata metadata = GetBinaryFileMetadata(
+      file_path, MetadataRequest::Only({kVersionKey}), use_cache);
+  auto version_it = metadata.fields.find(kVersionKey);
+  return version_it != metadata.fields.end() ? version_it->second : "";
+}
+
+// Helper function to convert a NUL-terminated wide string to UTF-8
+std::string WideStringToUtf8(const wchar_t* wide_str) {
   if (!wide_str) return "";
-  
-  // Calculate the required buffer size
-  int size_needed = WideCharToMultiByte(CP_UTF8, 0, wide_str, length, NULL, 0, NULL, NULL);
-  if (size_needed <= 0) return "";
-
-  // Allocate the buffer and convert
-  std::string utf8_str(size_needed, 0);
-  WideCharToMultiByte(CP_UTF8, 0, wide_str, length, &utf8_str[0], size_needed, NULL, NULL);
-  
-  // If we got a null-terminated string with explicit length, remove the null terminator from the result
-  if (length == -1 && !utf8_str.empty() && utf8_str.back() == '\0') {
-    utf8_str.pop_back();
-  }
-  
-  return utf8_str;
+  return WideToUtf8(wide_str, wcslen(wide_str));
 }
 
 // Helper to get a string value from version info
 std::string GetVersionInfoString(const std::vector<BYTE>& version_info, const std::wstring& sub_block) {
   UINT size = 0;
   LPVOID buffer = nullptr;
-  
+
   // First try to get string with default language
   std::wstring query = L"\\StringFileInfo\\040904B0\\" + sub_block;
   if (VerQueryValueW(version_info.data(), query.c_str(), &buffer, &size) && size > 0 && buffer != nullptr) {
     return WideStringToUtf8(static_cast<const wchar_t*>(buffer));
   }
-  
+
   // If that fails, try to find any available language
   struct LANGANDCODEPAGE {
     WORD language;
     WORD code_page;
   } *translate;
-  
+
   UINT translate_size = 0;
-  if (!VerQueryValueW(version_info.data(), L"\\VarFileInfo\\Translation", 
+  if (!VerQueryValueW(version_info.data(), L"\\VarFileInfo\\Translation",
                      reinterpret_cast<LPVOID*>(&translate), &translate_size)) {
     return "";
   }
-  
+
   size_t count = translate_size / sizeof(LANGANDCODEPAGE);
   for (size_t i = 0; i < count; ++i) {
     // Format the language and codepage as a string for the query
     wchar_t sub_block_lang[50];
-    swprintf_s(sub_block_lang, L"\\StringFileInfo\\%04x%04x\\%s", 
+    swprintf_s(sub_block_lang, L"\\StringFileInfo\\%04x%04x\\%s",
               translate[i].language, translate[i].code_page, sub_block.c_str());
-    
+
     if (VerQueryValueW(version_info.data(), sub_block_lang, &buffer, &size) && size > 0 && buffer != nullptr) {
       return WideStringToUtf8(static_cast<const wchar_t*>(buffer));
     }
   }
-  
+
   return "";
 }
 
-std::map<std::string, std::string> FlutterBinPlugin::GetBinaryFileMetadata(const std::string& file_path) {
-  std::map<std::string, std::string> metadata;
-  
+BinaryMetadata FlutterBinPlugin::GetBinaryFileMetadata(
+    const std::string& file_path, const MetadataRequest& request,
+    bool use_cache) {
+  if (!use_cache) {
+    return LoadBinaryFileMetadata(file_path, request);
+  }
+  return metadata_cache_.Get(
+      file_path, request,
+      [this](const std::string& path, const MetadataRequest& path_request) {
+        return LoadBinaryFileMetadata(path, path_request);
+      });
+}
+
+BinaryMetadata FlutterBinPlugin::LoadChangedFileMetadata(
+    const std::string& file_path, const MetadataRequest& request) {
+  // Unlike LoadBinaryFileMetadata(), nothing falls back to the version API,
+  // which maps the file.
+  ReadBudget budget;
+  budget.max_bytes = io_byte_budget_;
+  budget.timeout = std::chrono::milliseconds(io_deadline_ms_.load());
+  return ReadBinaryMetadataUnmapped(file_path, request, budget);
+}
+
+BinaryMetadata FlutterBinPlugin::LoadBinaryFileMetadata(
+    const std::string& file_path, const MetadataRequest& request) {
+  // Fast path: parse the PE image straight out of a file mapping, or with a
+  // few bounded reads when configured for slow volumes.
+  ReadBudget budget;
+  budget.max_bytes = io_byte_budget_;
+  budget.timeout = std::chrono::milliseconds(io_deadline_ms_.load());
+  BinaryMetadata metadata =
+      budget.max_bytes != 0 || budget.timeout.count() != 0
+          ? ReadBinaryMetadataBounded(file_path, request, budget)
+          : ReadBinaryMetadata(file_path, request);
+  if (metadata.error != MetadataError::kUnsupportedFormat &&
+      metadata.error != MetadataError::kReadFailed) {
+    return metadata;
+  }
+
+  // Not a PE image (e.g. a 16-bit NE file) or the mapping failed: let the
+  // version API have a go.
+
   // Convert from UTF-8 to wide string
-  int size_needed = MultiByteToWideChar(CP_UTF8, 0, file_path.c_str(), -1, NULL, 0);
-  std::wstring wide_path(size_needed, 0);
-  MultiByteToWideChar(CP_UTF8, 0, file_path.c_str(), -1, &wide_path[0], size_needed);
+  std::wstring wide_path;
+  {
+    ScopedPhaseTimer timer(PerfPhase::kPathConversion);
+    wide_path = Utf8ToWide(file_path);
+  }
 
   // Check if file exists
   DWORD file_attributes = GetFileAttributesW(wide_path.c_str());
   if (file_attributes == INVALID_FILE_ATTRIBUTES) {
     // File doesn't exist or is inaccessible
+    metadata.error = MetadataError::kFileNotFound;
     return metadata;
   }
 
@@ -228,11 +1119,13 @@ std::map<std::string, std::string> FlutterBinPlugin::GetBinaryFileMetadata(const
     // Could not get version info
     return metadata;
   }
+  metadata.error = MetadataError::kNone;
 
   // Get the fixed file info for version
   VS_FIXEDFILEINFO* fixed_file_info = nullptr;
   UINT len = 0;
-  if (VerQueryValueW(version_info.data(), L"\\", (LPVOID*)&fixed_file_info, &len)) {
+  if (request.version &&
+      VerQueryValueW(version_info.data(), L"\\", (LPVOID*)&fixed_file_info, &len)) {
     // Extract the version
     DWORD major = HIWORD(fixed_file_info->dwFileVersionMS);
     DWORD minor = LOWORD(fixed_file_info->dwFileVersionMS);
@@ -242,17 +1135,29 @@ std::map<std::string, std::string> FlutterBinPlugin::GetBinaryFileMetadata(const
     // Format the version string
     std::ostringstream version_stream;
     version_stream << major << "." << minor << "." << build << "." << revision;
-    metadata["version"] = version_stream.str();
+    metadata.fields[kVersionKey] = version_stream.str();
   }
 
-  // Get string values from version info
-  metadata["productName"] = GetVersionInfoString(version_info, L"ProductName");
-  metadata["fileDescription"] = GetVersionInfoString(version_info, L"FileDescription");
-  metadata["legalCopyright"] = GetVersionInfoString(version_info, L"LegalCopyright");
-  metadata["originalFilename"] = GetVersionInfoString(version_info, L"OriginalFilename");
-  metadata["companyName"] = GetVersionInfoString(version_info, L"CompanyName");
+  // Get string values from version info. Resource keys are plain ASCII.
+  for (const auto& field : request.strings) {
+    const std::string& key = field.second;
+    metadata.fields[field.first] =
+        GetVersionInfoString(version_info, std::wstring(key.begin(), key.end()));
+  }
 
   return metadata;
 }
 
-}  // namespace flutter_bin
\ No newline at end of file
+std::vector<BinaryMetadata> FlutterBinPlugin::GetBinaryFileMetadataBatch(
+    const std::vector<std::string>& file_paths, const MetadataRequest& request,
+    bool use_cache, const std::atomic<bool>& cancelled) {
+  std::vector<BinaryMetadata> results(file_paths.size());
+  thread_pool()->ParallelFor(file_paths.size(), [&](size_t i) {
+    if (!cancelled.load(std::memory_order_relaxed)) {
+      results[i] = GetBinaryFileMetadata(file_paths[i], request, use_cache);
+    }
+  });
+  return results;
+}
+
+}  // namespace flutter_bin
@@ -1,22 +1,39 @@
 #ifndef FLUTTER_PLUGIN_FLUTTER_BIN_PLUGIN_H_
 #define FLUTTER_PLUGIN_FLUTTER_BIN_PLUGIN_H_
 
+#include <flutter/event_channel.h>
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "async_executor.h"
+#include "binary_metadata.h"
+#include "directory_scan.h"
+#include "file_watcher.h"
+#include "metadata_cache.h"
+#include "thread_pool.h"
+
 namespace flutter_bin {
 
 class FlutterBinPlugin : public flutter::Plugin {
  public:
   static void RegisterWithRegistrar(flutter::PluginRegistrarWindows *registrar);
 
+  // Handles every call synchronously on the calling thread.
   FlutterBinPlugin();
 
+  // Runs calls on a background executor and completes their results through
+  // |dispatcher|, which must post to the platform thread.
+  explicit FlutterBinPlugin(std::unique_ptr<Dispatcher> dispatcher);
+
   virtual ~FlutterBinPlugin();
 
   // Disallow copy and assign.
@@ -27,13 +44,115 @@ class FlutterBinPlugin : public flutter::Plugin {
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Where directory scan batches are sent; null while Dart is not listening.
+  void SetScanEventSink(
+      std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> events);
+
+  // Where watch events are sent; null while Dart is not listening.
+  void SetWatchEventSink(
+      std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> events);
       
  private:
-  // Methods to handle specific platform calls
-  std::string GetBinaryFileVersion(const std::string& file_path);
+  using Work =
+      std::function<flutter::EncodableValue(const std::atomic<bool>& cancelled)>;
+
+  // Runs |work| in the background when asynchronous execution is on, or
+  // inline otherwise, and reports its value through |result|.
+  void Run(int64_t request_id, RequestPriority priority,
+           std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+           Work work);
+
+  // Opens the index at |index_path|, or none if it is empty, swaps it into
+  // |metadata_cache_| and then answers configure through |result|. Opening
+  // reads the whole log and closing the old index waits for its compaction,
+  // so both run on the executor when execution is asynchronous.
+  void ReplaceIndex(
+      const std::string& index_path,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Creates the executor on first use. Needs a dispatcher.
+  AsyncExecutor* executor();
+
+  ThreadPool* thread_pool();
+
+  // Starts a DirectoryScan that streams to the scan event sink.
+  void StartScan(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Sends one scan batch to Dart. Runs on the platform thread.
+  void SendScanBatch(int64_t scan_id, const std::vector<ScanEntry>& batch,
+                     const ScanSummary* summary);
+
+  // Starts a FileWatcher that streams to the watch event sink.
+  void StartWatch(
+      const flutter::EncodableMap& arguments,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Sends the changes that settled together to Dart. Runs on the platform
+  // thread.
+  void SendWatchEvents(int64_t watch_id, const std::vector<WatchEvent>& events);
+
+  // Stops |watcher| and destroys it on the executor: its thread may be in
+  // the middle of a read, which the platform thread must not wait for.
+  void StopWatch(std::unique_ptr<FileWatcher> watcher);
+
+  // Methods to handle specific platform calls. |use_cache| = false always
+  // reads the file.
+  std::string GetBinaryFileVersion(const std::string& file_path, bool use_cache);
   
-  // Get comprehensive metadata about a binary file
-  std::map<std::string, std::string> GetBinaryFileMetadata(const std::string& file_path);
+  // Get the metadata fields selected by |request| from a binary file
+  BinaryMetadata GetBinaryFileMetadata(const std::string& file_path,
+                                       const MetadataRequest& request,
+                                       bool use_cache);
+
+  // Read many files in parallel; results are in the order of |file_paths|.
+  // Files not yet started when |cancelled| is set are skipped.
+  std::vector<BinaryMetadata> GetBinaryFileMetadataBatch(
+      const std::vector<std::string>& file_paths, const MetadataRequest& request,
+      bool use_cache, const std::atomic<bool>& cancelled);
+
+  // Reads |file_path| itself, bypassing the cache
+  BinaryMetadata LoadBinaryFileMetadata(const std::string& file_path,
+                                        const MetadataRequest& request);
+
+  // LoadBinaryFileMetadata() for a file a watch reported, which may still be
+  // written to: read without mapping it, so truncation cannot fault
+  BinaryMetadata LoadChangedFileMetadata(const std::string& file_path,
+                                         const MetadataRequest& request);
+
+  // Workers for batch and asynchronous requests, created on first use
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // Results of earlier reads, valid while the file is unchanged. Its index
+  // compacts on |thread_pool_|, so it is declared after it.
+  MetadataCache metadata_cache_;
+
+  // Null when the plugin only runs synchronously
+  std::unique_ptr<Dispatcher> dispatcher_;
+
+  // Declared after the pool, cache and dispatcher so in-flight work finishes
+  // before they go away. The scans and watches below are torn down before
+  // it, as their tasks run on the pool and post to the dispatcher
+  std::unique_ptr<AsyncExecutor> executor_;
+
+  // Running directory scans by id; only touched on the platform thread.
+  // Destroyed first, as their batches are posted through |dispatcher_|.
+  std::map<int64_t, std::unique_ptr<DirectoryScan>> scans_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> scan_events_;
+
+  // Running watches by id; only touched on the platform thread. Their
+  // threads read through |metadata_cache_| and post to |dispatcher_|.
+  std::map<int64_t, std::unique_ptr<FileWatcher>> watches_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> watch_events_;
+
+  bool async_execution_ = false;
+
+  // Limits of one file's reads, 0 for none; set by configure and read by
+  // the workers. Either one switches PE reads to ReadBinaryMetadataBounded.
+  std::atomic<uint64_t> io_byte_budget_{0};
+  std::atomic<int64_t> io_deadline_ms_{0};
 };
 
 }  // namespace flutter_bin
@@ -2,6 +2,7 @@
 
 #include <flutter/plugin_registrar_windows.h>
 
+#include "flat_metadata.h"
 #include "flutter_bin_plugin.h"
 
 void FlutterBinPluginCApiRegisterWithRegistrar(
@@ -10,3 +11,10 @@ void FlutterBinPluginCApiRegisterWithRegistrar(
       flutter::PluginRegistrarManager::GetInstance()
           ->GetRegistrar<flutter::PluginRegistrarWindows>(registrar));
 }
+
+int64_t FlutterBinReadMetadata(const char* utf8_path,
+                               const char* const* fields, size_t field_count,
+                               uint8_t* buffer, size_t capacity) {
+  return flutter_bin::ReadFlatMetadata(utf8_path, fields, field_count, buffer,
+                                       capacity);
+}
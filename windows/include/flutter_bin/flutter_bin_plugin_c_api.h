@@ -2,6 +2,8 @@
 #define FLUTTER_PLUGIN_FLUTTER_BIN_PLUGIN_C_API_H_
 
 #include <flutter_plugin_registrar.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef FLUTTER_PLUGIN_IMPL
 #define FLUTTER_PLUGIN_EXPORT __declspec(dllexport)
@@ -16,6 +18,17 @@ extern "C" {
 FLUTTER_PLUGIN_EXPORT void FlutterBinPluginCApiRegisterWithRegistrar(
     FlutterDesktopPluginRegistrarRef registrar);
 
+// Reads the binary at |utf8_path| synchronously, for dart:ffi callers on
+// any thread or isolate. The result is written to |buffer| as a flat
+// header, offset table and string table (see src/flat_metadata.h). With
+// |field_count| zero the standard fields are read, otherwise exactly
+// |fields|. Returns the size of the result; when that is larger than
+// |capacity| nothing was written and the call can be repeated with a
+// bigger buffer. Returns -1 for a null path or field.
+FLUTTER_PLUGIN_EXPORT int64_t FlutterBinReadMetadata(
+    const char* utf8_path, const char* const* fields, size_t field_count,
+    uint8_t* buffer, size_t capacity);
+
 #if defined(__cplusplus)
 }  // extern "C"
 #endif
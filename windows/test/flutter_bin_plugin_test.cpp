@@ -4,39 +4,194 @@
 #include <gtest/gtest.h>
 #include <windows.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <variant>
 
+#include "binary_metadata.h"
 #include "flutter_bin_plugin.h"
+#include "unicode.h"
 
 namespace flutter_bin {
 namespace test {
 
 namespace {
 
+using flutter::EncodableList;
 using flutter::EncodableMap;
 using flutter::EncodableValue;
 using flutter::MethodCall;
 using flutter::MethodResultFunctions;
 
-}  // namespace
+// What a call completed with; the plugin runs every call inline when it is
+// constructed without a dispatcher.
+struct Reply {
+  bool succeeded = false;
+  bool not_implemented = false;
+  std::string error_code;
+  EncodableValue value;
+};
 
-TEST(FlutterBinPlugin, GetPlatformVersion) {
-  FlutterBinPlugin plugin;
-  // Save the reply value from the success callback.
-  std::string result_string;
-  plugin.HandleMethodCall(
-      MethodCall("getPlatformVersion", std::make_unique<EncodableValue>()),
+Reply Call(FlutterBinPlugin* plugin, const std::string& method,
+           EncodableMap arguments) {
+  Reply reply;
+  plugin->HandleMethodCall(
+      MethodCall(method, std::make_unique<EncodableValue>(std::move(arguments))),
       std::make_unique<MethodResultFunctions<>>(
-          [&result_string](const EncodableValue* result) {
-            result_string = std::get<std::string>(*result);
+          [&reply](const EncodableValue* result) {
+            reply.succeeded = true;
+            if (result != nullptr) {
+              reply.value = *result;
+            }
           },
-          nullptr, nullptr));
+          [&reply](const std::string& code, const std::string&,
+                   const EncodableValue*) { reply.error_code = code; },
+          [&reply]() { reply.not_implemented = true; }));
+  return reply;
+}
+
+// kernel32.dll carries a version resource on every Windows host.
+std::string Kernel32Path() {
+  wchar_t directory[MAX_PATH];
+  UINT length = GetSystemDirectoryW(directory, MAX_PATH);
+  return WideToUtf8(directory, length) + "\\kernel32.dll";
+}
+
+std::string MissingPath() {
+  wchar_t directory[MAX_PATH];
+  DWORD length = GetTempPathW(MAX_PATH, directory);
+  return WideToUtf8(directory, length) + "flutter_bin_missing_file.dll";
+}
+
+}  // namespace
+
+TEST(FlutterBinPlugin, GetBinaryFileVersion) {
+  FlutterBinPlugin plugin;
+  Reply reply = Call(&plugin, "getBinaryFileVersion",
+                     {{EncodableValue("filePath"), EncodableValue(Kernel32Path())}});
+  ASSERT_TRUE(reply.succeeded);
+  const auto* version = std::get_if<std::string>(&reply.value);
+  ASSERT_NE(version, nullptr);
+  // e.g. "10.0.22621.2506".
+  EXPECT_EQ(std::count(version->begin(), version->end(), '.'), 3);
+}
+
+TEST(FlutterBinPlugin, GetBinaryFileVersionOfMissingFile) {
+  FlutterBinPlugin plugin;
+  Reply reply = Call(&plugin, "getBinaryFileVersion",
+                     {{EncodableValue("filePath"), EncodableValue(MissingPath())}});
+  EXPECT_TRUE(reply.succeeded);
+  EXPECT_TRUE(std::holds_alternative<std::monostate>(reply.value));
+
+  reply = Call(&plugin, "getBinaryFileVersion", {});
+  EXPECT_FALSE(reply.succeeded);
+  EXPECT_EQ(reply.error_code, "INVALID_ARGUMENT");
+}
+
+TEST(FlutterBinPlugin, GetBinaryFileMetadataBatch) {
+  FlutterBinPlugin plugin;
+  Reply reply = Call(
+      &plugin, "getBinaryFileMetadataBatch",
+      {{EncodableValue("paths"),
+        EncodableValue(EncodableList{EncodableValue(Kernel32Path()),
+                                     EncodableValue(MissingPath())})},
+       {EncodableValue("useCache"), EncodableValue(false)}});
+  ASSERT_TRUE(reply.succeeded);
+  const auto* files = std::get_if<EncodableList>(&reply.value);
+  ASSERT_NE(files, nullptr);
+  ASSERT_EQ(files->size(), 2u);
 
-  // Since the exact string varies by host, just ensure that it's a string
-  // with the expected format.
-  EXPECT_TRUE(result_string.rfind("Windows ", 0) == 0);
+  const auto& found = std::get<EncodableMap>((*files)[0]);
+  EXPECT_EQ(found.count(EncodableValue("error")), 0u);
+  EXPECT_EQ(found.count(EncodableValue("version")), 1u);
+
+  const auto& missing = std::get<EncodableMap>((*files)[1]);
+  EXPECT_EQ(missing.at(EncodableValue("error")),
+            EncodableValue("FILE_NOT_FOUND"));
+}
+
+TEST(FlutterBinPlugin, WatchNeedsAsynchronousExecution) {
+  FlutterBinPlugin plugin;
+  Reply reply = Call(&plugin, "watch",
+                     {{EncodableValue("watchId"), EncodableValue(1)},
+                      {EncodableValue("paths"),
+                       EncodableValue(EncodableList{EncodableValue(MissingPath())})}});
+  EXPECT_EQ(reply.error_code, "UNAVAILABLE");
+
+  reply = Call(&plugin, "watch", {{EncodableValue("watchId"), EncodableValue(1)}});
+  EXPECT_EQ(reply.error_code, "INVALID_ARGUMENT");
+}
+
+TEST(FlutterBinPlugin, BoundedReadsReportBytesRead) {
+  FlutterBinPlugin plugin;
+  EXPECT_EQ(Call(&plugin, "configure",
+                 {{EncodableValue("ioByteBudget"), EncodableValue(-1)}})
+                .error_code,
+            "INVALID_ARGUMENT");
+  ASSERT_TRUE(Call(&plugin, "configure",
+                   {{EncodableValue("ioByteBudget"), EncodableValue(1 << 20)},
+                    {EncodableValue("ioDeadlineMs"), EncodableValue(5000)}})
+                  .succeeded);
+
+  Reply reply = Call(&plugin, "getBinaryFileMetadata",
+                     {{EncodableValue("filePath"), EncodableValue(Kernel32Path())},
+                      {EncodableValue("useCache"), EncodableValue(false)}});
+  ASSERT_TRUE(reply.succeeded);
+  const auto& metadata = std::get<EncodableMap>(reply.value);
+  EXPECT_EQ(metadata.count(EncodableValue("version")), 1u);
+  const auto* bytes_read = std::get_if<int64_t>(&metadata.at(EncodableValue("bytesRead")));
+  ASSERT_NE(bytes_read, nullptr);
+  EXPECT_GT(*bytes_read, 0);
+  EXPECT_LE(*bytes_read, 1 << 20);
+}
+
+TEST(FlutterBinPlugin, ReadsOnlyTheFieldsInTheMask) {
+  FlutterBinPlugin plugin;
+  Reply reply = Call(&plugin, "getBinaryFileMetadata",
+                     {{EncodableValue("filePath"), EncodableValue(Kernel32Path())},
+                      {EncodableValue("fieldMask"),
+                       EncodableValue(static_cast<int32_t>(
+                           kVersionFieldBit | StandardStringFieldBit(4)))},
+                      {EncodableValue("useCache"), EncodableValue(false)}});
+  ASSERT_TRUE(reply.succeeded);
+  const auto& metadata = std::get<EncodableMap>(reply.value);
+  EXPECT_EQ(metadata.count(EncodableValue("version")), 1u);
+  EXPECT_EQ(metadata.count(EncodableValue("companyName")), 1u);
+  EXPECT_EQ(metadata.count(EncodableValue("productName")), 0u);
+
+  reply = Call(&plugin, "getBinaryFileMetadata",
+               {{EncodableValue("filePath"), EncodableValue(Kernel32Path())},
+                {EncodableValue("fieldMask"),
+                 EncodableValue(static_cast<int32_t>(kAllFieldsMask + 1))}});
+  EXPECT_EQ(reply.error_code, "INVALID_ARGUMENT");
+}
+
+TEST(FlutterBinPlugin, ValidatesPriorities) {
+  FlutterBinPlugin plugin;
+  Reply reply = Call(&plugin, "getBinaryFileVersion",
+                     {{EncodableValue("filePath"), EncodableValue(Kernel32Path())},
+                      {EncodableValue("priority"), EncodableValue("bulk")}});
+  EXPECT_TRUE(reply.succeeded);
+
+  reply = Call(&plugin, "getBinaryFileVersion",
+               {{EncodableValue("filePath"), EncodableValue(Kernel32Path())},
+                {EncodableValue("priority"), EncodableValue("urgent")}});
+  EXPECT_EQ(reply.error_code, "INVALID_ARGUMENT");
+
+  EXPECT_EQ(Call(&plugin, "configure",
+                 {{EncodableValue("bulkConcurrency"), EncodableValue(-1)}})
+                .error_code,
+            "INVALID_ARGUMENT");
+  EXPECT_TRUE(Call(&plugin, "configure",
+                   {{EncodableValue("bulkConcurrency"), EncodableValue(1)},
+                    {EncodableValue("priorityAgingMs"), EncodableValue(250)}})
+                  .succeeded);
+}
+
+TEST(FlutterBinPlugin, RejectsUnknownMethods) {
+  FlutterBinPlugin plugin;
+  EXPECT_TRUE(Call(&plugin, "getPlatformVersion", {}).not_implemented);
 }
 
 }  // namespace test
@@ -0,0 +1,87 @@
+#include "win32_dispatcher.h"
+
+#include <utility>
+
+namespace flutter_bin {
+
+namespace {
+
+constexpr wchar_t kWindowClassName[] = L"FLUTTER_BIN_DISPATCHER";
+
+// Posted to the message-only window when tasks are queued.
+constexpr UINT kRunTasksMessage = WM_APP + 1;
+
+HINSTANCE ModuleInstance() {
+  HMODULE module = nullptr;
+  GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                         GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                     reinterpret_cast<LPCWSTR>(&ModuleInstance), &module);
+  return module;
+}
+
+}  // namespace
+
+Win32Dispatcher::Win32Dispatcher() {
+  HINSTANCE instance = ModuleInstance();
+  WNDCLASSW window_class = {};
+  window_class.lpfnWndProc = &Win32Dispatcher::WindowProc;
+  window_class.hInstance = instance;
+  window_class.lpszClassName = kWindowClassName;
+  // Fails harmlessly if another instance already registered the class.
+  RegisterClassW(&window_class);
+
+  window_ = CreateWindowExW(0, kWindowClassName, L"", 0, 0, 0, 0, 0,
+                            HWND_MESSAGE, nullptr, instance, nullptr);
+  if (window_) {
+    SetWindowLongPtrW(window_, GWLP_USERDATA,
+                      reinterpret_cast<LONG_PTR>(this));
+  }
+}
+
+Win32Dispatcher::~Win32Dispatcher() {
+  if (window_) {
+    SetWindowLongPtrW(window_, GWLP_USERDATA, 0);
+    DestroyWindow(window_);
+  }
+}
+
+void Win32Dispatcher::Post(std::function<void()> task) {
+  bool wake = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+    wake = !wake_pending_;
+    wake_pending_ = true;
+  }
+  if (wake && window_) {
+    PostMessageW(window_, kRunTasksMessage, 0, 0);
+  }
+}
+
+void Win32Dispatcher::RunTasks() {
+  std::deque<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks.swap(tasks_);
+    wake_pending_ = false;
+  }
+  for (auto& task : tasks) {
+    task();
+  }
+}
+
+// static
+LRESULT CALLBACK Win32Dispatcher::WindowProc(HWND window, UINT message,
+                                             WPARAM wparam, LPARAM lparam) {
+  if (message == kRunTasksMessage) {
+    auto* dispatcher = reinterpret_cast<Win32Dispatcher*>(
+        GetWindowLongPtrW(window, GWLP_USERDATA));
+    if (dispatcher) {
+      dispatcher->RunTasks();
+    }
+    return 0;
+  }
+  return DefWindowProcW(window, message, wparam, lparam);
+}
+
+}  // namespace flutter_bin
@@ -0,0 +1,49 @@
+#ifndef FLUTTER_PLUGIN_WIN32_DISPATCHER_H_
+#define FLUTTER_PLUGIN_WIN32_DISPATCHER_H_
+
+#include <windows.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "async_executor.h"
+
+namespace flutter_bin {
+
+// Runs tasks on the thread that created it through a message-only window,
+// so they are picked up by the runner's ordinary message loop.
+//
+// Must be created and destroyed on the platform thread.
+class Win32Dispatcher : public Dispatcher {
+ public:
+  Win32Dispatcher();
+
+  // Drops tasks that have not run yet.
+  ~Win32Dispatcher() override;
+
+  // Disallow copy and assign.
+  Win32Dispatcher(const Win32Dispatcher&) = delete;
+  Win32Dispatcher& operator=(const Win32Dispatcher&) = delete;
+
+  // Safe to call from any thread.
+  void Post(std::function<void()> task) override;
+
+ private:
+  static LRESULT CALLBACK WindowProc(HWND window, UINT message, WPARAM wparam,
+                                     LPARAM lparam);
+
+  // Runs every queued task on the platform thread.
+  void RunTasks();
+
+  HWND window_ = nullptr;
+
+  std::mutex mutex_;
+  std::deque<std::function<void()>> tasks_;
+  // True while a wake-up message is in the window's queue; guarded by mutex_.
+  bool wake_pending_ = false;
+};
+
+}  // namespace flutter_bin
+
+#endif  // FLUTTER_PLUGIN_WIN32_DISPATCHER_H_